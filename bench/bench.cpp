@@ -0,0 +1,229 @@
+#include "bench.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace OpenNero
+{
+    namespace bench
+    {
+#ifdef __linux__
+        namespace
+        {
+            /// A group of hardware counters read around the timed batches:
+            /// cycles, instructions, cache misses, branch misses. Opening
+            /// the group needs perf_event_paranoid to allow self-profiling
+            /// (or CAP_PERFMON); when the kernel refuses, the benchmarks
+            /// report wall time only. The counters validate data-layout
+            /// work directly: a change that claims better cache behavior
+            /// should move cache-miss/op, not just the end-to-end time.
+            class PerfCounters
+            {
+            public:
+                /// number of events in the group
+                static const size_t kNumEvents = 4;
+
+                PerfCounters()
+                {
+                    for (size_t i = 0; i < kNumEvents; ++i)
+                        mFds[i] = -1;
+                    mFds[0] = Open(PERF_COUNT_HW_CPU_CYCLES, -1);
+                    if (mFds[0] < 0)
+                        return;
+                    mFds[1] = Open(PERF_COUNT_HW_INSTRUCTIONS, mFds[0]);
+                    mFds[2] = Open(PERF_COUNT_HW_CACHE_MISSES, mFds[0]);
+                    mFds[3] = Open(PERF_COUNT_HW_BRANCH_MISSES, mFds[0]);
+                }
+
+                ~PerfCounters()
+                {
+                    for (size_t i = 0; i < kNumEvents; ++i)
+                        if (mFds[i] >= 0)
+                            close(mFds[i]);
+                }
+
+                /// true iff the whole group opened
+                bool IsOpen() const
+                {
+                    for (size_t i = 0; i < kNumEvents; ++i)
+                        if (mFds[i] < 0)
+                            return false;
+                    return true;
+                }
+
+                /// zero the group (counting starts at the next Resume)
+                void Reset()
+                {
+                    ioctl(mFds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                }
+
+                /// start (or continue) counting
+                void Resume()
+                {
+                    ioctl(mFds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+                }
+
+                /// stop counting, keeping the accumulated values
+                void Pause()
+                {
+                    ioctl(mFds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                }
+
+                /// read the accumulated group values (in creation order)
+                bool Read(uint64_t& cycles, uint64_t& instructions,
+                          uint64_t& cacheMisses, uint64_t& branchMisses)
+                {
+                    // PERF_FORMAT_GROUP layout: nr followed by one value
+                    // per event, in the order the group was built
+                    uint64_t buffer[1 + kNumEvents];
+                    if (read(mFds[0], buffer, sizeof(buffer)) != sizeof(buffer))
+                        return false;
+                    if (buffer[0] != kNumEvents)
+                        return false;
+                    cycles = buffer[1];
+                    instructions = buffer[2];
+                    cacheMisses = buffer[3];
+                    branchMisses = buffer[4];
+                    return true;
+                }
+
+            private:
+                /// open one hardware event, grouped under the leader
+                /// (groupFd of -1 makes this event the leader)
+                int Open(uint64_t config, int groupFd)
+                {
+                    struct perf_event_attr attr;
+                    std::memset(&attr, 0, sizeof(attr));
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.size = sizeof(attr);
+                    attr.config = config;
+                    attr.disabled = (groupFd < 0) ? 1 : 0;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    attr.read_format = PERF_FORMAT_GROUP;
+                    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+                }
+
+                int mFds[kNumEvents]; ///< one fd per event; [0] is the leader
+            };
+        }
+#endif // __linux__
+
+        void Run(const std::string& name,
+                 size_t batch,
+                 size_t repetitions,
+                 const boost::function<void()>& op)
+        {
+            using std::chrono::steady_clock;
+            using std::chrono::duration_cast;
+            using std::chrono::nanoseconds;
+
+            // one untimed batch to warm caches and lazy initialization
+            for (size_t i = 0; i < batch; ++i)
+                op();
+
+#ifdef __linux__
+            // count only inside the timed batches; the values accumulate
+            // across repetitions, so one read at the end covers them all
+            PerfCounters counters;
+            static bool warned = false;
+            if (!counters.IsOpen() && !warned)
+            {
+                std::cout << "(perf counters unavailable; reporting wall time only)"
+                          << std::endl;
+                warned = true;
+            }
+            if (counters.IsOpen())
+                counters.Reset();
+#endif
+
+            std::vector<double> ns_per_op(repetitions);
+            for (size_t rep = 0; rep < repetitions; ++rep)
+            {
+#ifdef __linux__
+                if (counters.IsOpen())
+                    counters.Resume();
+#endif
+                steady_clock::time_point start = steady_clock::now();
+                for (size_t i = 0; i < batch; ++i)
+                    op();
+                steady_clock::time_point stop = steady_clock::now();
+#ifdef __linux__
+                if (counters.IsOpen())
+                    counters.Pause();
+#endif
+                double elapsed = (double)duration_cast<nanoseconds>(stop - start).count();
+                ns_per_op[rep] = elapsed / batch;
+            }
+
+            double mean = 0;
+            double best = ns_per_op[0];
+            for (size_t rep = 0; rep < repetitions; ++rep)
+            {
+                mean += ns_per_op[rep];
+                if (ns_per_op[rep] < best)
+                    best = ns_per_op[rep];
+            }
+            mean /= repetitions;
+
+            double variance = 0;
+            for (size_t rep = 0; rep < repetitions; ++rep)
+            {
+                double delta = ns_per_op[rep] - mean;
+                variance += delta * delta;
+            }
+            variance /= repetitions;
+
+            std::cout << std::left << std::setw(48) << name
+                      << std::right << std::fixed << std::setprecision(1)
+                      << " mean " << std::setw(12) << mean << " ns/op"
+                      << "  sd " << std::setw(10) << std::sqrt(variance)
+                      << "  min " << std::setw(12) << best
+                      << "  (" << repetitions << " x " << batch << " ops)"
+                      << std::endl;
+
+#ifdef __linux__
+            uint64_t cycles, instructions, cacheMisses, branchMisses;
+            if (counters.IsOpen() &&
+                counters.Read(cycles, instructions, cacheMisses, branchMisses) &&
+                cycles > 0)
+            {
+                const double ops = (double)batch * (double)repetitions;
+                std::cout << std::setw(48) << " "
+                          << std::setprecision(2)
+                          << " ipc  " << std::setw(11)
+                          << (double)instructions / (double)cycles
+                          << std::setprecision(1)
+                          << "  instr/op " << std::setw(12) << instructions / ops
+                          << std::setprecision(3)
+                          << "  cache-miss/op " << cacheMisses / ops
+                          << "  branch-miss/op " << branchMisses / ops
+                          << std::endl;
+            }
+#endif
+        }
+    }
+}
+
+int main()
+{
+    using namespace OpenNero::bench;
+
+    std::cout << "OpenNERO micro-benchmarks" << std::endl;
+    BenchNEAT();
+    BenchSinglePrecision();
+    BenchEntityState();
+    return 0;
+}
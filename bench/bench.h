@@ -0,0 +1,43 @@
+/**
+@file
+
+\brief OpenNERO micro-benchmarks
+
+Timed micro-benchmarks for the NEAT and simulation hot loops. Each
+benchmark runs its operation in batches and repeats the batch several
+times, reporting the mean, standard deviation, and best ns/op across
+repetitions, so a regression shows up as a shifted mean rather than a
+one-off noisy number. On Linux, each benchmark also reports hardware
+counters captured around the timed batches (IPC, instructions, cache
+misses, and branch mispredicts per op, via perf_event_open) when the
+kernel allows self-profiling. Build with the `benchmarks` target (not
+part of the default build) and run the resulting binary directly.
+*/
+
+#ifndef _OPENNERO_BENCH_BENCH_H_
+#define _OPENNERO_BENCH_BENCH_H_
+
+#include <string>
+#include <boost/function.hpp>
+
+namespace OpenNero
+{
+    namespace bench
+    {
+        /// Time op: run it batch times per repetition, for the given number
+        /// of repetitions, and print mean/stddev/min ns per operation
+        void Run(const std::string& name,
+                 size_t batch,
+                 size_t repetitions,
+                 const boost::function<void()>& op);
+
+        /// benchmark suites
+        /// @{
+        void BenchNEAT();            ///< Network::activate, Genome::compatibility, Population::epoch
+        void BenchEntityState();     ///< per-tick entity state pipeline with synthetic entities
+        void BenchSinglePrecision(); ///< F32 phenotype mode: equivalence check against F64, plus timing
+        /// @}
+    }
+}
+
+#endif // _OPENNERO_BENCH_BENCH_H_
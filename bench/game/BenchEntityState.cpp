@@ -0,0 +1,69 @@
+#include "core/Common.h"
+#include "../bench.h"
+
+#include "game/SimEntityData.h"
+
+#include <vector>
+#include <boost/bind.hpp>
+
+using namespace OpenNero;
+
+namespace
+{
+    /// One simulated tick over a population of synthetic entities: mutate
+    /// the hot transform fields (marking them dirty), publish the render
+    /// snapshots, then consume them the way SceneObject::ProcessTick does.
+    /// This is the per-entity state pipeline Simulation::ProcessTick runs
+    /// every frame, without needing a scene graph or object templates.
+    void tick_once(std::vector<SimEntityData>* entities, float32_t* t)
+    {
+        *t += 0.01f;
+
+        std::vector<SimEntityData>::iterator ent;
+        for (ent = entities->begin(); ent != entities->end(); ++ent)
+        {
+            ent->SetPosition(Vector3f(*t, *t * 2, 0));
+            ent->SetRotation(Vector3f(0, 0, *t));
+        }
+
+        for (ent = entities->begin(); ent != entities->end(); ++ent)
+        {
+            ent->PublishSnapshot();
+        }
+
+        // the render-side read: gated field reads, then mark consumed
+        for (ent = entities->begin(); ent != entities->end(); ++ent)
+        {
+            if (ent->GetSnapshotDirtyBits() == 0)
+                continue;
+            const SimEntityData::SimEntityInternals& snapshot = ent->GetSnapshot();
+            volatile float32_t sink = snapshot.mPosition.X + snapshot.mRotation.Z;
+            (void)sink;
+            ent->ClearSnapshotDirtyBits();
+        }
+    }
+}
+
+namespace OpenNero
+{
+    namespace bench
+    {
+        void BenchEntityState()
+        {
+            const size_t entity_count = 1000;
+
+            std::vector<SimEntityData> entities;
+            entities.reserve(entity_count);
+            for (size_t i = 0; i < entity_count; ++i)
+            {
+                entities.push_back(SimEntityData(
+                    Vector3f(0, 0, 0), Vector3f(0, 0, 0), Vector3f(1, 1, 1),
+                    std::string(), 0, 0, SimId(i + 1)));
+            }
+
+            float32_t t = 0;
+            Run("entity state tick [1000 entities]", 200, 20,
+                boost::bind(&tick_once, &entities, &t));
+        }
+    }
+}
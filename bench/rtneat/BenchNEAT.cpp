@@ -0,0 +1,171 @@
+#include "core/Common.h"
+#include "../bench.h"
+
+#include "rtneat/neat.h"
+#include "rtneat/genome.h"
+#include "rtneat/network.h"
+#include "rtneat/organism.h"
+#include "rtneat/population.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// the NEAT globals default to zero; give them the values from the
+    /// shipped NERO parameter file so the benchmarks exercise realistic
+    /// mutation and speciation behavior without loading mod resources
+    void set_benchmark_params()
+    {
+        NEAT::trait_param_mut_prob = 0.5;
+        NEAT::trait_mutation_power = 1.0;
+        NEAT::linktrait_mut_sig = 1.0;
+        NEAT::nodetrait_mut_sig = 0.5;
+        NEAT::weight_mut_power = 0.5;
+        NEAT::recur_prob = 0.0;
+        NEAT::disjoint_coeff = 1.0;
+        NEAT::excess_coeff = 1.0;
+        NEAT::mutdiff_coeff = 0.4;
+        NEAT::compat_threshold = 4.0;
+        NEAT::age_significance = 1.0;
+        NEAT::survival_thresh = 1.0;
+        NEAT::mutate_only_prob = 0.25;
+        NEAT::mutate_random_trait_prob = 0.1;
+        NEAT::mutate_link_trait_prob = 0.1;
+        NEAT::mutate_node_trait_prob = 0.1;
+        NEAT::mutate_link_weights_prob = 0.9;
+        NEAT::mutate_toggle_enable_prob = 0.0;
+        NEAT::mutate_gene_reenable_prob = 0.0;
+        NEAT::mutate_add_node_prob = 0.03;
+        NEAT::mutate_add_link_prob = 0.05;
+        NEAT::interspecies_mate_rate = 0.001;
+        NEAT::mate_multipoint_prob = 0.6;
+        NEAT::mate_multipoint_avg_prob = 0.4;
+        NEAT::mate_singlepoint_prob = 0.0;
+        NEAT::mate_only_prob = 0.2;
+        NEAT::recur_only_prob = 0.15;
+        NEAT::pop_size = 50;
+        NEAT::dropoff_age = 15;
+        NEAT::newlink_tries = 20;
+        NEAT::print_every = 30;
+        NEAT::babies_stolen = 0;
+    }
+
+    void activate_once(NetworkPtr net, const std::vector<F64>* sensors)
+    {
+        net->load_sensors(*sensors);
+        net->activate();
+    }
+
+    void compatibility_once(GenomePtr a, GenomePtr b, F64* sink)
+    {
+        *sink += a->compatibility(b);
+    }
+
+    void epoch_once(PopulationPtr pop, S32* generation)
+    {
+        // epoch culls by fitness, so every organism needs a fresh positive
+        // score each generation
+        std::vector<OrganismPtr>::iterator curorg;
+        for (curorg = pop->organisms.begin(); curorg != pop->organisms.end(); ++curorg)
+        {
+            (*curorg)->fitness = 1.0 + randfloat();
+        }
+        pop->epoch(++(*generation));
+    }
+}
+
+namespace OpenNero
+{
+    namespace bench
+    {
+        void BenchNEAT()
+        {
+            set_benchmark_params();
+            NEAT::seed_random(12345);
+
+            // a NERO-sized starting network: 18 sensors, 4 outputs
+            GenomePtr genome(new Genome(18, 4, 0, 0));
+
+            NetworkPtr net = genome->genesis(1);
+            std::vector<F64> sensors(18);
+            for (size_t i = 0; i < sensors.size(); ++i)
+                sensors[i] = randfloat();
+            Run("Network::activate [18 in, 4 out]", 10000, 20,
+                boost::bind(&activate_once, net, &sensors));
+
+            // compatibility between two independently mutated descendants
+            GenomePtr left = genome->duplicate(2);
+            GenomePtr right = genome->duplicate(3);
+            left->mutate_link_weights(1.0, 1.0, GAUSSIAN);
+            right->mutate_link_weights(1.0, 1.0, GAUSSIAN);
+            F64 sink = 0;
+            Run("Genome::compatibility", 10000, 20,
+                boost::bind(&compatibility_once, left, right, &sink));
+
+            // a full generational turnover of a 50-organism population
+            PopulationPtr pop(new Population(genome, NEAT::pop_size));
+            S32 generation = 0;
+            Run("Population::epoch [50 organisms]", 5, 10,
+                boost::bind(&epoch_once, pop, &generation));
+        }
+
+        void BenchSinglePrecision()
+        {
+            set_benchmark_params();
+            NEAT::seed_random(54321);
+
+            // a NERO-sized controller with a hidden layer and recurrent
+            // links, so the sweep has hidden rows and needs to settle
+            GenomePtr genome(new Genome(18, 4, 8, 2));
+            genome->mutate_link_weights(1.0, 1.0, GAUSSIAN);
+            GenomePtr twin = genome->duplicate(2);
+
+            // one phenotype per precision; the mode is read at compile
+            // time, which happens on the first activation
+            NetworkPtr net64 = genome->genesis(1);
+            NetworkPtr net32 = twin->genesis(2);
+
+            // behavioral equivalence: drive both phenotypes with the same
+            // random sensor stream and track the worst output divergence
+            std::vector<F64> sensors(18);
+            F64 maxdiff = 0;
+            const size_t steps = 1000;
+            for (size_t step = 0; step < steps; ++step)
+            {
+                for (size_t i = 0; i < sensors.size(); ++i)
+                    sensors[i] = randfloat();
+
+                NEAT::single_precision_nets = 0;
+                net64->load_sensors(sensors);
+                net64->activate();
+
+                NEAT::single_precision_nets = 1;
+                net32->load_sensors(sensors);
+                net32->activate();
+
+                for (size_t i = 0; i < net64->outputs.size(); ++i)
+                {
+                    F64 diff = std::fabs(net64->outputs[i]->activation
+                                         - net32->outputs[i]->activation);
+                    if (diff > maxdiff)
+                        maxdiff = diff;
+                }
+            }
+            std::cout << "  F32 phenotype equivalence [18 in, 8 hidden, 4 out]: "
+                      << "max |output delta| " << maxdiff
+                      << " over " << steps << " activations "
+                      << (maxdiff < 1e-3 ? "(ok)" : "(DIVERGED)") << std::endl;
+
+            // the F64 twin of this timing is in BenchNEAT
+            Run("Network::activate [F32 mode]", 10000, 20,
+                boost::bind(&activate_once, net32, &sensors));
+
+            NEAT::single_precision_nets = 0;
+        }
+    }
+}
@@ -136,8 +136,16 @@ class NeroEnvironment(OpenNero.Environment):
                 rtneat.set_weight(constants.FITNESS_INDEX[key], value)
 
     def remove_all_agents(self, team):
-        for agent in list(self.teams[team]):
-            self.remove_agent(agent)
+        # despawn the whole team in one call
+        agents = list(self.teams[team])
+        common.removeObjects([agent.state.id for agent in agents])
+        for agent in agents:
+            try:
+                self.teams[agent.get_team()].discard(agent)
+                if agent in self.states:
+                    self.states.pop(agent)
+            except:
+                pass
 
     def remove_agent(self, agent):
         common.removeObject(agent.state.id)
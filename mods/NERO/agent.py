@@ -276,8 +276,10 @@ class RTNEATAgent(NeroAgent, OpenNero.AgentBrain):
             for idx in constants.SENSOR_INDEX_FRIEND_RADAR:
                 sensors[idx] = 0
         
+        # clamp and normalize the sensor vector in place (one pass, no copy)
+        self.sensors.normalize_in_place(sensors)
         org.net.load_sensors(
-            list(self.sensors.normalize(sensors)) + [constants.NEAT_BIAS])
+            list(sensors) + [constants.NEAT_BIAS])
         org.net.activate()
         outputs = org.net.get_outputs()
 
@@ -286,7 +288,8 @@ class RTNEATAgent(NeroAgent, OpenNero.AgentBrain):
              actions[i] = outputs[i]
         #disabling firing for testing...
         #actions[constants.ACTION_INDEX_FIRE] = 0
-        denormalized_actions = self.actions.denormalize(actions)
+        self.actions.denormalize_in_place(actions)
+        denormalized_actions = actions
 
         if denormalized_actions[constants.ACTION_INDEX_ZERO_FRIEND_SENSORS] > 0.5:
             self.omit_friend_sensors = True
@@ -170,8 +170,13 @@ class NeroModule:
         if ai == 'rtneat':
             OpenNero.set_ai('rtneat-%s' % team, None)
         self.environment.remove_all_agents(team)
-        for _ in range(constants.pop_size):
-            self.spawnAgent(ai=ai, team=team)
+        if ai == 'rtneat' and not OpenNero.get_ai('rtneat-%s' % team):
+            self.start_rtneat(team)
+        self.curr_team = team
+        # spawn the whole wave in one call so the collision selectors are
+        # only rebuilt once instead of once per agent
+        common.addObjects([self.agent_spawn_spec(team=team, ai=ai)
+                           for _ in range(constants.pop_size)])
         OpenNero.enable_ai()
 
     #The following is run when the Save button is pressed
@@ -357,14 +362,17 @@ class NeroModule:
             self.start_rtneat(team)
 
         self.curr_team = team
-        color = constants.TEAM_LABELS[team]
+        return common.addObjects([self.agent_spawn_spec(team=team, ai=ai)])[0]
 
+    def agent_spawn_spec(self, team=constants.OBJECT_TYPE_TEAM_0, ai=None):
+        """ addObject argument tuple for one new agent at a jittered spawn point """
+        color = constants.TEAM_LABELS[team]
         dx = random.randrange(constants.XDIM / 20) - constants.XDIM / 40
         dy = random.randrange(constants.XDIM / 20) - constants.XDIM / 40
-        return common.addObject(
+        return (
             "data/shapes/character/steve_%s_%s.xml" % (color, ai),
             OpenNero.Vector3f(self.spawn_x[team] + dx, self.spawn_y[team] + dy, 2),
-            type=team)
+            None, None, None, team)
     
     def setAdvice(self, advice, team=constants.OBJECT_TYPE_TEAM_0):
         """ advice for rtneat agents """
@@ -0,0 +1,156 @@
+#!/usr/bin/env python
+__help__ = """
+Macro benchmark scenarios for OpenNERO.
+
+Each scenario boots a mod headless with a fixed random seed, sets up a
+scripted workload, runs it for a fixed number of ticks and reports
+throughput (ticks/sec), per-tick latency percentiles and peak RSS. The
+numbers come from OpenNero.run_ticks_timed, which times every tick
+inside the engine.
+
+Run from the directory that contains the OpenNERO binary and the mods:
+
+  python benchmark.py             # run every scenario
+  python benchmark.py nero_30     # run selected scenarios
+
+This file plays both roles: the driver above launches one OpenNERO
+process per scenario, and inside each process the --command startup hook
+executes this same file to set the scenario up and print the result.
+"""
+
+import os
+import subprocess
+import sys
+import time
+
+# marker prefixing the one JSON result line each scenario prints
+RESULT_MARKER = 'BENCHMARK_RESULT '
+
+# seed passed to --random so runs are comparable between builds
+RANDOM_SEED = 12345
+
+# wall-clock cap per scenario, in seconds
+SCENARIO_TIMEOUT = 1800
+
+# scenario table: the mod to boot, how to populate it, and how long to run.
+# NERO scenarios train an rtNEAT team of the given size around the flag;
+# the Maze scenario runs the mod's Sarsa learner and Roomba sweeps scripted
+# vacuum bots across the crumb field.
+SCENARIOS = {
+    'nero_30':    dict(mod='NERO',   modpath='NERO:common',   agents=30,  ticks=2000, dt=0.1),
+    'nero_90':    dict(mod='NERO',   modpath='NERO:common',   agents=90,  ticks=2000, dt=0.1),
+    'nero_300':   dict(mod='NERO',   modpath='NERO:common',   agents=300, ticks=1000, dt=0.1),
+    'maze_sarsa': dict(mod='Maze',   modpath='Maze:common',   agents=1,   ticks=5000, dt=0.1),
+    'roomba_30':  dict(mod='Roomba', modpath='Roomba:common', agents=30,  ticks=3000, dt=0.1),
+}
+
+# the order the full suite runs in
+SCENARIO_ORDER = ['nero_30', 'nero_90', 'nero_300', 'maze_sarsa', 'roomba_30']
+
+
+# ------------------------------------------------------------------
+# in-engine side: executed via --command inside a booted OpenNERO
+# ------------------------------------------------------------------
+
+def _setup_nero(agents):
+    import NERO.constants
+    import NERO.module
+    NERO.constants.pop_size = agents
+    mod = NERO.module.getMod()
+    mod.set_speedup(1.0)
+    mod.deploy('rtneat')
+
+def _setup_maze(agents):
+    from Maze.module import getMod
+    getMod().set_speedup(1.0)
+    getMod().start_sarsa()
+
+def _setup_roomba(agents):
+    from Roomba.module import getMod
+    getMod().add_bots('Script', agents)
+
+SETUP = {
+    'NERO': _setup_nero,
+    'Maze': _setup_maze,
+    'Roomba': _setup_roomba,
+}
+
+def run_scenario(name):
+    """set up the named scenario in this process, run it, print the result"""
+    import json
+    import OpenNero
+    spec = SCENARIOS[name]
+    SETUP[spec['mod']](spec['agents'])
+    stats = OpenNero.run_ticks_timed(spec['ticks'], spec['dt'])
+    stats['scenario'] = name
+    print RESULT_MARKER + json.dumps(stats)
+    sys.stdout.flush()
+
+
+# ------------------------------------------------------------------
+# driver side: launches one OpenNERO process per scenario
+# ------------------------------------------------------------------
+
+def launch_scenario(name):
+    """run one scenario in a fresh headless OpenNERO and return its stats"""
+    import json
+    spec = SCENARIOS[name]
+    command = "execfile('benchmark.py'); run_scenario('%s')" % name
+    argv = ['./OpenNERO',
+            '--headless',
+            '--mod', spec['mod'],
+            '--modpath', spec['modpath'],
+            '--random', str(RANDOM_SEED),
+            '--log', 'benchmark_%s.log' % name,
+            '--command', command]
+    process = subprocess.Popen(argv, stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT)
+    stats = None
+    deadline = time.time() + SCENARIO_TIMEOUT
+    try:
+        while time.time() < deadline:
+            line = process.stdout.readline()
+            if not line:
+                break
+            if line.startswith(RESULT_MARKER):
+                stats = json.loads(line[len(RESULT_MARKER):])
+                break
+    finally:
+        # the engine keeps running its main loop after the command; the
+        # result is out, so bring the process down like condor_run does
+        try:
+            process.kill()
+        except OSError:
+            pass
+        process.wait()
+    return stats
+
+def main(args):
+    names = args or SCENARIO_ORDER
+    unknown = [n for n in names if n not in SCENARIOS]
+    if unknown:
+        print 'unknown scenarios:', ' '.join(unknown)
+        print 'available:', ' '.join(SCENARIO_ORDER)
+        return 1
+    if not os.path.exists('./OpenNERO'):
+        print 'OpenNERO binary not found; run from the directory that contains it'
+        return 1
+
+    header = '%-12s %10s %9s %9s %9s %9s %12s' % (
+        'scenario', 'ticks/sec', 'mean_ms', 'p50_ms', 'p99_ms', 'max_ms', 'peak_rss_kb')
+    print header
+    print '-' * len(header)
+    failed = False
+    for name in names:
+        stats = launch_scenario(name)
+        if not stats:
+            print '%-12s %s' % (name, 'FAILED (no result; see benchmark_%s.log)' % name)
+            failed = True
+            continue
+        print '%-12s %10.1f %9.2f %9.2f %9.2f %9.2f %12d' % (
+            name, stats['ticks_per_sec'], stats['mean_ms'], stats['p50_ms'],
+            stats['p99_ms'], stats['max_ms'], stats['peak_rss_kb'])
+    return 1 if failed else 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -14,6 +14,25 @@ def removeObject(ID):
     """ remove an object from the simulation """
     OpenNero.getSimContext().removeObject(ID)
 
+def addObjects(specs):
+    """ add a batch of objects in one call; each spec is a tuple of
+    addObject arguments (templateFile, position, rotation, scale, label,
+    type, collision), with missing entries or None taking the default """
+    records = []
+    for spec in specs:
+        templateFile, position = spec[0], spec[1]
+        rotation = spec[2] if len(spec) > 2 else None
+        scale = spec[3] if len(spec) > 3 else None
+        label = spec[4] if len(spec) > 4 else None
+        type = spec[5] if len(spec) > 5 else None
+        collision = spec[6] if len(spec) > 6 else None
+        records.append((templateFile, position, rotation, scale, label, collision, type))
+    return list(OpenNero.getSimContext().addObjects(records))
+
+def removeObjects(IDs):
+    """ remove a batch of objects from the simulation in one call """
+    OpenNero.getSimContext().removeObjects(list(IDs))
+
 def addSkyBox(prefix, extension = None):
     """ add a skybox starting with the prefix and ending with the extension """
     if extension:
@@ -0,0 +1,97 @@
+"""Reader for the binary trajectory files exported by OpenNERO.
+
+TrajectoryLog (source/ai/TrajectoryLog.cpp) appends one packed record
+per agent step to prefix.NNN.trj segments, so loading a training
+dataset is a sequence of struct.unpack calls over the raw bytes
+instead of scraping multi-gigabyte text logs.
+
+Segment layout (all fields little-endian):
+
+    4 bytes magic 'ONTJ'
+    uint8   format version (currently 1)
+    uint8   float width in bytes (currently 8)
+
+followed by step records:
+
+    uint8   tag (STEP_TAG)
+    uint32  agent id
+    uint32  episode
+    uint32  step
+    uint32  observation dimensions, followed by that many float64 values
+    uint32  action dimensions, followed by that many float64 values
+    uint32  reward dimensions, followed by that many float64 values
+"""
+
+import glob
+import struct
+
+MAGIC = b'ONTJ'
+VERSION = 1
+
+# record tag for one agent step (keep in sync with kTrajectoryStepTag
+# in source/ai/TrajectoryLog.cpp)
+STEP_TAG = 0xB1
+
+# fixed-width head of a step record: tag, id, episode, step
+_STEP_HEAD = struct.Struct('<BIII')
+# element count in front of each float64 vector
+_COUNT = struct.Struct('<I')
+
+class StepRecord:
+    """ One decoded agent step """
+
+    def __init__(self, id, episode, step, observations, actions, reward):
+        self.id = id                        # id of the agent
+        self.episode = episode              # episode number
+        self.step = step                    # step within the episode
+        self.observations = observations    # list of observation values
+        self.actions = actions              # list of action values
+        self.reward = reward                # list of reward components
+
+    def __str__(self):
+        return 'StepRecord(id = %d, episode = %d, step = %d)' % \
+            (self.id, self.episode, self.step)
+
+def _read_vector(data, offset):
+    """ decode one count-prefixed float64 vector, returning (values, offset) """
+    (count,) = _COUNT.unpack_from(data, offset)
+    offset += _COUNT.size
+    values = list(struct.unpack_from('<%dd' % count, data, offset))
+    return values, offset + 8 * count
+
+def read_segment(filename):
+    """ load every step record from one .trj segment """
+    with open(filename, 'rb') as f:
+        data = f.read()
+    if data[:4] != MAGIC:
+        raise ValueError('%s is not an OpenNERO trajectory file' % filename)
+    version = data[4]
+    if version != VERSION:
+        raise ValueError('%s has unsupported version %d' % (filename, version))
+    records = []
+    offset = 6  # past magic, version and float width
+    while offset < len(data):
+        (tag, id, episode, step) = _STEP_HEAD.unpack_from(data, offset)
+        if tag != STEP_TAG:
+            raise ValueError('%s: bad record tag 0x%02x at offset %d' %
+                             (filename, tag, offset))
+        offset += _STEP_HEAD.size
+        observations, offset = _read_vector(data, offset)
+        actions, offset = _read_vector(data, offset)
+        reward, offset = _read_vector(data, offset)
+        records.append(StepRecord(id, episode, step, observations, actions, reward))
+    return records
+
+def read_trajectories(prefix):
+    """ load every segment written under a prefix, in rotation order """
+    records = []
+    for filename in sorted(glob.glob('%s.*.trj' % prefix)):
+        records.extend(read_segment(filename))
+    return records
+
+def group_by_agent(records):
+    """ split a record list into {agent id: [records in step order]} """
+    agents = {}
+    for record in records:
+        agents.setdefault(record.id, []).append(record)
+    return agents
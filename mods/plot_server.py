@@ -28,6 +28,7 @@ from matplotlib.backends.backend_wxagg import FigureCanvasWxAgg as FigCanvas
 __author__ = "Igor Karpov (ikarpov@cs.utexas.edu)"
 
 from plot_client import HOST, PORT
+from plot_telemetry import TelemetryDecoder
 
 ADDR = (HOST, PORT)
 BUFSIZE = 4086
@@ -154,6 +155,14 @@ class LearningCurve:
             for id in self.histories:
                 self.histories[id].plot(axes, self.total.xmin)
 
+    def process_record(self, record):
+        """
+        Record the information from a decoded binary telemetry record
+        """
+        reward = record.reward[0] if record.reward else 0.0 # for now only plot [0]
+        fitness = record.fitness[0] if record.fitness else 0.0 # for now plot only [0]
+        self.append( record.id, record.time, record.episode, record.step, reward, fitness )
+
     def process_line(self, line):
         """
         Process a line of the log file and record the information in it in the LearningCurve
@@ -339,7 +348,14 @@ class PlotTCPHandler(SocketServer.StreamRequestHandler):
         lc = LearningCurve()
         if app:
             app.frame.learning_curve = lc
-        lc.process_file(self.rfile)
+        # the live stream is binary telemetry records (see plot_telemetry);
+        # saved log files still go through the text parser in process_file
+        decoder = TelemetryDecoder()
+        data = self.request.recv(BUFSIZE)
+        while data:
+            for record in decoder.feed(data):
+                lc.process_record(record)
+            data = self.request.recv(BUFSIZE)
 
 def main():
     global app
@@ -0,0 +1,172 @@
+#!/usr/bin/env python
+"""Decoder for the binary telemetry records streamed by OpenNERO.
+
+AIManager::Log writes one tagged fixed-width record per agent step
+through the Bitstream class (source/core/Bitstream.h) and sends it over
+the plot_client/plot_server socket. Decoding a record is a handful of
+struct.unpack calls instead of a regular expression match and float
+parsing per line, which is what makes the live plot cheap at 90 agents
+times per-step rewards.
+
+Record layout (all fields little-endian, matching the x86 memory layout
+Bitstream writes):
+
+    uint8   tag (TICK_TAG)
+    float64 seconds since the start of the simulation
+    uint32  agent id
+    uint32  episode
+    uint32  step
+    uint32  reward dimensions, followed by that many float64 values
+    uint32  fitness dimensions, followed by that many float64 values
+
+With set_telemetry_window(seconds) the engine reduces the per-step
+samples at the source and streams one summary record per agent (and one
+per team) per window instead:
+
+    uint8   tag (AGENT_WINDOW_TAG or TEAM_WINDOW_TAG)
+    float64 window end, seconds since the start of the simulation
+    uint32  agent id (or team id)
+    uint32  number of samples reduced into the window
+    uint32  reward dimensions, followed by (min, mean, max) float64
+            triples, one per dimension
+    uint32  fitness dimensions, followed by (min, mean, max) float64
+            triples, one per dimension
+"""
+
+import struct
+
+__author__ = "Igor Karpov (ikarpov@cs.utexas.edu)"
+
+# record tags (keep in sync with the kTelemetry* constants in
+# source/ai/AIManager.cpp)
+TICK_TAG = 0xA1          # one per-step sample
+AGENT_WINDOW_TAG = 0xA2  # one agent's aggregation window summary
+TEAM_WINDOW_TAG = 0xA3   # one team's aggregation window summary
+
+# fixed-width head of a tick record: tag, time, id, episode, step
+_TICK_HEAD = struct.Struct('<BdIII')
+# fixed-width head of a window record: tag, window end, id, sample count
+_WINDOW_HEAD = struct.Struct('<BdII')
+# element count in front of each float64 vector
+_COUNT = struct.Struct('<I')
+
+class TickRecord:
+    """ One decoded per-step telemetry record """
+
+    def __init__(self, time, id, episode, step, reward, fitness):
+        self.time = time        # seconds since the start of the simulation
+        self.id = id            # id of the agent
+        self.episode = episode  # episode number
+        self.step = step        # step within the episode
+        self.reward = reward    # list of reward components
+        self.fitness = fitness  # list of fitness components
+
+    def __str__(self):
+        return 'TickRecord(t = %f, id = %d, episode = %d, step = %d)' % \
+            (self.time, self.id, self.episode, self.step)
+
+class WindowRecord:
+    """ One decoded aggregation window summary (per agent or per team) """
+
+    def __init__(self, team, time, id, count, reward, fitness):
+        self.team = team        # True for a team summary, False for an agent
+        self.time = time        # window end, seconds since the start
+        self.id = id            # agent id (or team id)
+        self.count = count      # samples reduced into the window
+        self.reward = reward    # list of (min, mean, max) per dimension
+        self.fitness = fitness  # list of (min, mean, max) per dimension
+
+    def __str__(self):
+        return 'WindowRecord(t = %f, %s = %d, count = %d)' % \
+            (self.time, 'team' if self.team else 'id', self.id, self.count)
+
+class TelemetryDecoder:
+    """ Incremental decoder over a byte stream: feed it whatever arrived
+        on the socket and it returns the records that are complete,
+        buffering any trailing partial record for the next call. """
+
+    def __init__(self):
+        self.buffer = ''
+
+    def feed(self, data):
+        """ buffer incoming bytes and return a list of complete records """
+        self.buffer += data
+        records = []
+        while True:
+            record, consumed = self._decode_one()
+            if record is None:
+                break
+            self.buffer = self.buffer[consumed:]
+            records.append(record)
+        return records
+
+    def _decode_one(self):
+        """ try to decode a single record from the front of the buffer;
+            returns (record, bytes consumed) or (None, 0) """
+        if len(self.buffer) < 1:
+            return None, 0
+        tag = ord(self.buffer[0])
+        if tag == TICK_TAG:
+            if len(self.buffer) < _TICK_HEAD.size:
+                return None, 0
+            tag, time, id, episode, step = _TICK_HEAD.unpack_from(self.buffer)
+            offset = _TICK_HEAD.size
+            reward, offset = self._decode_vector(offset)
+            if offset is None:
+                return None, 0
+            fitness, offset = self._decode_vector(offset)
+            if offset is None:
+                return None, 0
+            return TickRecord(time, id, episode, step, reward, fitness), offset
+        elif tag == AGENT_WINDOW_TAG or tag == TEAM_WINDOW_TAG:
+            if len(self.buffer) < _WINDOW_HEAD.size:
+                return None, 0
+            tag, time, id, count = _WINDOW_HEAD.unpack_from(self.buffer)
+            offset = _WINDOW_HEAD.size
+            reward, offset = self._decode_triples(offset)
+            if offset is None:
+                return None, 0
+            fitness, offset = self._decode_triples(offset)
+            if offset is None:
+                return None, 0
+            return WindowRecord(tag == TEAM_WINDOW_TAG, time, id, count,
+                                reward, fitness), offset
+        else:
+            # the stream is out of sync (or from an older OpenNERO);
+            # skip ahead to the next possible record boundary
+            self._resync()
+            return None, 0
+
+    def _decode_vector(self, offset):
+        """ decode a count-prefixed float64 vector at offset; returns
+            (values, offset past the vector) or (None, None) if the
+            buffer does not hold the whole vector yet """
+        if len(self.buffer) < offset + _COUNT.size:
+            return None, None
+        (count,) = _COUNT.unpack_from(self.buffer, offset)
+        offset += _COUNT.size
+        end = offset + 8 * count
+        if len(self.buffer) < end:
+            return None, None
+        return list(struct.unpack_from('<%dd' % count, self.buffer, offset)), end
+
+    def _decode_triples(self, offset):
+        """ decode a count-prefixed vector of (min, mean, max) float64
+            triples at offset; returns (triples, offset past them) or
+            (None, None) if the buffer does not hold them all yet """
+        if len(self.buffer) < offset + _COUNT.size:
+            return None, None
+        (count,) = _COUNT.unpack_from(self.buffer, offset)
+        offset += _COUNT.size
+        end = offset + 24 * count
+        if len(self.buffer) < end:
+            return None, None
+        flat = struct.unpack_from('<%dd' % (3 * count), self.buffer, offset)
+        return [tuple(flat[3 * i:3 * i + 3]) for i in range(count)], end
+
+    def _resync(self):
+        """ skip ahead to the next possible record tag """
+        candidates = [self.buffer.find(chr(tag), 1)
+                      for tag in (TICK_TAG, AGENT_WINDOW_TAG, TEAM_WINDOW_TAG)]
+        candidates = [c for c in candidates if c >= 0]
+        self.buffer = '' if not candidates else self.buffer[min(candidates):]
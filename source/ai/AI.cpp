@@ -4,6 +4,7 @@
 #include "math/Random.h"
 #include <vector>
 #include <list>
+#include <map>
 
 namespace OpenNero
 {
@@ -29,6 +30,7 @@ namespace OpenNero
         lower[i] = min;
         upper[i] = max;
         discreteness[i] = false;
+        invRange[i] = (max - min != 1) ? 1.0 / (max - min) : 0;
     }
 
     size_t FeatureVectorInfo::addContinuous(double min, double max)
@@ -37,6 +39,7 @@ namespace OpenNero
         lower.push_back(min);
         upper.push_back(max);
         discreteness.push_back(false);
+        invRange.push_back((max - min != 1) ? 1.0 / (max - min) : 0);
         return size() - 1;
     }
 
@@ -46,6 +49,7 @@ namespace OpenNero
         lower[i] = min;
         upper[i] = max;
         discreteness[i] = true;
+        invRange[i] = (max - min != 1) ? 1.0 / (double)(max - min) : 0;
     }
 
     size_t FeatureVectorInfo::addDiscrete(int min, int max)
@@ -54,6 +58,7 @@ namespace OpenNero
         lower.push_back(min);
         upper.push_back(max);
         discreteness.push_back(true);
+        invRange.push_back((max - min != 1) ? 1.0 / (double)(max - min) : 0);
         return size() - 1;
     }
 
@@ -73,16 +78,9 @@ namespace OpenNero
     /// normalize the feature vector to the range 0-1
     FeatureVector FeatureVectorInfo::normalize(const FeatureVector& array) const
     {
-        AssertMsg(validate(array), "the feature vector " << array << " is invalid in normalize()");
         FeatureVector result(array);
-        for (size_t i = 0; i < size(); ++i)
-        {
-            double d = upper[i] - lower[i];
-            if (d > 0 && d != 1)
-            {
-                result[i] = (array[i] - lower[i]) / d;
-            }
-        }
+        const bool valid = normalizeInPlace(result);
+        AssertMsg(valid, "the feature vector " << array << " is invalid in normalize()");
         return result;
     }
 
@@ -90,15 +88,53 @@ namespace OpenNero
     FeatureVector FeatureVectorInfo::denormalize(const FeatureVector& array) const
 	{
     	FeatureVector result(array);
-    	for (size_t i = 0; i < size(); ++i)
-    	{
-    		// 0 will be = lower, 1 will be = upper
-    		double d = upper[i] - lower[i];
-    		result[i] = array[i] * d + lower[i];
-    	}
+    	denormalizeInPlace(result);
     	return result;
 	}
 
+    /// clamp into bounds and normalize to 0-1 in one in-place pass
+    bool FeatureVectorInfo::normalizeInPlace(FeatureVector& array) const
+    {
+        if (array.size() != size()) return false;
+        bool valid = true;
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            double x = array[i];
+            if (x < lower[i]) { x = lower[i]; valid = false; }
+            else if (x > upper[i]) { x = upper[i]; valid = false; }
+            // a zero cached reciprocal means the element needs no rescale
+            const double inv = invRange[i];
+            if (inv != 0)
+            {
+                x = (x - lower[i]) * inv;
+            }
+            array[i] = x;
+        }
+        return valid;
+    }
+
+    /// apply the constraints to a 0-1 feature vector in place
+    void FeatureVectorInfo::denormalizeInPlace(FeatureVector& array) const
+    {
+        const size_t n = array.size() < size() ? array.size() : size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            // 0 will be = lower, 1 will be = upper
+            array[i] = array[i] * (upper[i] - lower[i]) + lower[i];
+        }
+    }
+
+    /// recompute the reciprocal range cache from the bounds
+    void FeatureVectorInfo::rebuildInvRange()
+    {
+        invRange.resize(size());
+        for (size_t i = 0; i < size(); ++i)
+        {
+            const double d = upper[i] - lower[i];
+            invRange[i] = (d > 0 && d != 1) ? 1.0 / d : 0;
+        }
+    }
+
     /// validate a vector of values against these bounds
     bool FeatureVectorInfo::validate(const FeatureVector& array) const
     {
@@ -118,19 +154,25 @@ namespace OpenNero
     FeatureVector FeatureVectorInfo::getInstance() const
     {
         FeatureVector result;
-        FeatureVector::const_iterator iter;
+        getInstance(result);
+        return result;
+    }
+
+    /// fill an existing feature vector based on this FeatureVectorInfo
+    void FeatureVectorInfo::getInstance(FeatureVector& result) const
+    {
+        result.resize(size());
         for (size_t i = 0; i < size(); ++i)
         {
             // if 0 is an in-bounds value, use it
             if (lower[i] <= 0 && 0 <= upper[i]) {
-                result.push_back(0);
+                result[i] = 0;
             }
             else // otherwise, use the lower bound
             {
-                result.push_back(lower[i]);
+                result[i] = lower[i];
             }
         }
-        return result;
     }
     
     FeatureVector FeatureVectorInfo::getRandom() const
@@ -150,6 +192,58 @@ namespace OpenNero
         return result;
     }
     
+    /// Enumerate every discrete combination of these bounds, with
+    /// continuous dimensions split into bins equally spaced values that
+    /// keep the original range (e.g. a continuous [-1, 1] dimension with
+    /// 5 bins contributes {-1, -.5, 0, .5, 1}). The tables are interned
+    /// by bounds and bin count, so greedy sweeps over a shared action
+    /// space iterate one contiguous table instead of each agent
+    /// materializing its own enumeration.
+    FeatureVectorTablePtr FeatureVectorInfo::getDiscreteTable(int bins) const
+    {
+        // the cache key pins down the bounds and the bin count exactly
+        std::ostringstream key;
+        key << bins;
+        for (size_t i = 0; i < size(); ++i)
+        {
+            key << '|' << (discreteness[i] ? 'd' : 'c') << lower[i] << ',' << upper[i];
+        }
+
+        typedef std::map<std::string, FeatureVectorTablePtr> TableCache;
+        static TableCache cache;
+        TableCache::const_iterator found = cache.find(key.str());
+        if (found != cache.end())
+        {
+            return found->second;
+        }
+
+        // cross each dimension's values with the combinations of the
+        // dimensions before it
+        boost::shared_ptr<std::vector<FeatureVector> > table(new std::vector<FeatureVector>());
+        table->push_back(getInstance());
+        for (size_t i = 0; i < size(); ++i)
+        {
+            const double lo = getMin(i), hi = getMax(i);
+            const double inc = isDiscrete(i) ? 1.0 : (hi - lo) / (bins - 1);
+            std::vector<FeatureVector> crossed;
+            std::vector<FeatureVector>::const_iterator iter;
+            for (iter = table->begin(); iter != table->end(); ++iter)
+            {
+                for (double a = lo; a <= hi; a += inc)
+                {
+                    FeatureVector v = *iter;
+                    v[i] = a;
+                    crossed.push_back(v);
+                }
+            }
+            table->swap(crossed);
+        }
+
+        FeatureVectorTablePtr shared(table);
+        cache[key.str()] = shared;
+        return shared;
+    }
+
     /// get a bounded array info from a string
     bool FeatureVectorInfo::Converter::operator()(FeatureVectorInfo& result, const std::string& typeString)
     {
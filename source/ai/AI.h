@@ -18,6 +18,7 @@
 #include <boost/serialization/vector.hpp>
 
 #include "core/Common.h"
+#include "core/SmallVector.h"
 #include "game/objects/TemplatedObject.h"
 
 namespace OpenNero {
@@ -34,8 +35,27 @@ namespace OpenNero {
     BOOST_SHARED_DECL(SimEntityData);
     /// @endcond
 
-    /// A fixed dimension vector of real numbers
-    typedef std::vector<double> FeatureVector;
+    /// A fixed dimension vector of real numbers. Observation, action and
+    /// reward vectors are almost always a handful of elements, so the
+    /// first 16 live in inline storage and never touch the heap.
+    typedef SmallVector<double, 16> FeatureVector;
+
+    /// serialize a small vector to/from a Boost serialization archive
+    template <class Archive, typename T, size_t N>
+    void serialize(Archive& ar, SmallVector<T, N>& v, const unsigned int /*version*/)
+    {
+        size_t count = v.size();
+        ar & boost::serialization::make_nvp("count", count);
+        v.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ar & boost::serialization::make_nvp("item", v[i]);
+        }
+    }
+
+    /// a shared immutable table of feature vectors (see
+    /// FeatureVectorInfo::getDiscreteTable)
+    typedef boost::shared_ptr<const std::vector<FeatureVector> > FeatureVectorTablePtr;
 
     /// bound for discrete or continuous values
     struct Bound
@@ -62,6 +82,14 @@ namespace OpenNero {
         std::vector<double> upper; ///< upper bounds
         std::vector<bool> discreteness; ///< discreteness
 
+        /// cached reciprocal ranges: 1/(upper-lower) when normalizing
+        /// needs to rescale the element, 0 when it does not; maintained
+        /// by the bound mutators so the per-tick passes never divide
+        std::vector<double> invRange;
+
+        /// recompute the reciprocal range cache from the bounds
+        void rebuildInvRange();
+
         /// serialize this object to/from a Boost serialization archive
         template<class Archive>
         void serialize(Archive & ar, const unsigned int version)
@@ -69,12 +97,16 @@ namespace OpenNero {
             ar & BOOST_SERIALIZATION_NVP(lower);
             ar & BOOST_SERIALIZATION_NVP(upper);
             ar & BOOST_SERIALIZATION_NVP(discreteness);
+            // the reciprocal cache is derived state; recompute after a
+            // load (harmless on a save)
+            rebuildInvRange();
         }
     public:
-        FeatureVectorInfo() : lower(), upper(), discreteness() { }
+        FeatureVectorInfo() : lower(), upper(), discreteness(), invRange() { }
 
         /// constructor
-        explicit FeatureVectorInfo(int size) : lower(size), upper(size), discreteness(size) { }
+        explicit FeatureVectorInfo(int size)
+            : lower(size), upper(size), discreteness(size), invRange(size) { }
 
         /// number of elements
         size_t size() const { return lower.size(); }
@@ -112,12 +144,36 @@ namespace OpenNero {
         /// given a feature vector in the range 0-1, make a feature vector with these constraints
 		FeatureVector denormalize(const FeatureVector& array) const;
 
+        /// Clamp a vector into these bounds and normalize it to the 0-1
+        /// range in place: one pass over the bounds, no allocation, and
+        /// the validation that brains used to do as a separate walk comes
+        /// back as the return value.
+        /// @param array the vector to transform, overwritten in place
+        /// @return true iff the vector was already within bounds
+        bool normalizeInPlace(FeatureVector& array) const;
+
+        /// given a feature vector in the range 0-1, apply these
+        /// constraints to it in place (single pass, no allocation)
+        void denormalizeInPlace(FeatureVector& array) const;
+
         /// create a vector of the appropriate size
         FeatureVector getInstance() const;
 
+        /// fill an existing vector with the default values, reusing its storage
+        void getInstance(FeatureVector& result) const;
+
         /// create a feature vector initialized randomly
         FeatureVector getRandom() const;
 
+        /// Enumerate every discrete combination of these bounds, with
+        /// continuous dimensions split into bins equally spaced values.
+        /// The tables are interned: the first request for a given
+        /// (bounds, bins) pair builds the table and later requests -
+        /// typically every other agent sharing the action space - get
+        /// the same immutable instance.
+        /// @param bins number of values a continuous dimension is split into
+        FeatureVectorTablePtr getDiscreteTable(int bins) const;
+
         /// get the bounds on a particular element
         Bound getBound(size_t i);
 
@@ -1,123 +1,472 @@
-#include "core/Common.h"
-#include <vector>
-#include <map>
-#include "ai/AIManager.h"
-#include "ai/AI.h"
-#include "ai/AgentBrain.h"
-#include "ai/Environment.h"
-#include "core/Log.h"
-#include "scripting/scriptIncludes.h"
-
-using namespace std;
-
-namespace OpenNero
-{
-
-    AIManager& AIManager::instance()
-    {
-        static AIManager me;
-        return me;
-    }
-
-    const AIManager& AIManager::const_instance()
-    {
-        return instance();
-    }
-
-    void AIManager::SetEnabled(bool state)
-    {
-        if (state)
-        {
-            LOG_F_MSG("ai", "AI Engine enabled");
-        }
-        else
-        {
-            LOG_F_MSG("ai", "AI Engine disabled");
-        }
-        mEnabled = state;
-    }
-
-    /// get the currently selected AI Environment
-    EnvironmentPtr AIManager::GetEnvironment() const { return mEnvironment; }
-
-    /// set the currently selected AI Environment
-    void AIManager::SetEnvironment(EnvironmentPtr env) { 
-        if (mEnvironment) {
-            mEnvironment->cleanup();
-            mEnvironment.reset();
-        }
-        mEnvironment = env;
-    }
-
-    /// Shutdown and clean-up the AI subsystem
-    void AIManager::destroy()
-    {
-        SetEnabled(false);
-        if (mEnvironment) {
-            mEnvironment->cleanup();
-            mEnvironment.reset();
-        }
-        mAIs.clear();
-    }
-
-    AIPtr AIManager::GetAI(const std::string& name) const
-    {
-        map<string, AIPtr>::const_iterator iter = mAIs.find(name);
-        if (iter != mAIs.end()) 
-        {
-            return iter->second;
-        }
-        else
-        {
-            return AIPtr();
-        }
-    }
-
-    void AIManager::Log(SimId id, 
-                        size_t episode, 
-                        size_t step, 
-                        Reward reward, 
-                        Reward fitness)
-    {
-        //stringstream ss;
-        //GetStaticTimer().stamp(ss);
-        //ss << " (M) [ai.tick] " << id <<
-        //    "\t" << episode <<
-        //    "\t" << step <<
-        //    "\t" << reward <<
-        //    "\t" << fitness << endl;
-        //ScriptingEngine::instance().NetworkWrite(ss.str());
-        LOG_F_DEBUG("ai.tick", id <<
-            "\t" << episode <<
-            "\t" << step <<
-            "\t" << reward <<
-            "\t" << fitness);
-    }
-
-    void AIManager::SetAI(const std::string& name, AIPtr ai)
-    {
-        mAIs[name] = ai;
-    }
-    
-    /// tick the AIs
-    void AIManager::ProcessTick( float32_t incAmt )
-    {
-        if (mEnabled) {
-            map<string, AIPtr>::iterator iter;
-            map<string, AIPtr>::iterator iend = mAIs.end();
-            for (iter = mAIs.begin(); iter != iend; ++iter)
-            {
-                iter->second->ProcessTick(incAmt);
-            }
-        }
-    }
-    
-    /// reset the ai (remove the ai systems)
-    void AIManager::Reset()
-    {
-        if (mEnvironment) {
-            mEnvironment->cleanup();
-        }
-        mAIs.clear();
-    }
-}
+#include "core/Common.h"
+#include <vector>
+#include <map>
+#include "ai/AIManager.h"
+
+#include <mutex>
+#include "ai/AI.h"
+#include "ai/AgentBrain.h"
+#include "ai/Autosave.h"
+#include "ai/Environment.h"
+#include "ai/TrajectoryLog.h"
+#include "ai/rtneat/rtNEAT.h"
+#include "ai/rtneat/ScoreHelper.h"
+#include "game/CombatService.h"
+#include "rtneat/neat.h"
+#include "core/Bitstream.h"
+#include "core/Log.h"
+#include "core/ONTime.h"
+#include "scripting/scripting.h"
+#include "scripting/scriptIncludes.h"
+
+using namespace std;
+
+namespace OpenNero
+{
+
+    namespace
+    {
+        /// record tag for a per-step tick in the binary telemetry stream
+        /// (the Python side of the format lives in mods/plot_telemetry.py)
+        const uint8_t kTelemetryTickTag = 0xA1;
+
+        /// record tags for per-agent and per-team aggregation window
+        /// summaries (see SetTelemetryWindow)
+        const uint8_t kTelemetryAgentWindowTag = 0xA2;
+        const uint8_t kTelemetryTeamWindowTag = 0xA3;
+
+        /// The stats batch: fixed-width tick records accumulate here and
+        /// are handed to the network writer in one large message instead
+        /// of one message per agent step, so the per-step cost of Log is
+        /// appending a few dozen bytes to an already-allocated buffer.
+        /// Guarded by sStatsMutex (entities ticking on the worker pool
+        /// log through here as well).
+        std::mutex sStatsMutex;
+        Bitstream sStatsBatch;
+
+        /// ship the batch once it grows past this many bytes; ProcessTick
+        /// also flushes once per frame so records never sit here stale
+        const uint32_t kStatsFlushBytes = 8 * 1024;
+
+        /// hand the accumulated batch to the background network writer
+        /// (the caller holds sStatsMutex)
+        void FlushStatsBatch()
+        {
+            if (sStatsBatch.ByteLength() == 0)
+                return;
+            ScriptingEngine::instance().NetworkWrite(
+                std::string((const char*)sStatsBatch.Stream(), sStatsBatch.ByteLength()));
+            sStatsBatch.Clear(); // keeps its capacity; no per-batch allocation
+        }
+
+        /// one aggregation window: the reward and fitness samples an
+        /// agent (or a whole team) produced since the window opened,
+        /// reduced to min/mean/max/count
+        struct TelemetryWindow
+        {
+            ScoreHelper reward;  ///< per-step reward reductions
+            ScoreHelper fitness; ///< cumulative fitness reductions
+        };
+
+        /// per-agent windows being accumulated (guarded by sStatsMutex)
+        std::map<SimId, TelemetryWindow> sWindows;
+
+        /// when the current aggregation window opened, in seconds
+        float64_t sWindowStart = 0;
+
+        /// append one window summary record to the stats batch: a tag,
+        /// the window end time, the agent or team id, the sample count
+        /// and per-dimension min/mean/max for reward and fitness
+        /// (the caller holds sStatsMutex)
+        void AppendWindowRecord(uint8_t tag, uint32_t key, float64_t now,
+                                const TelemetryWindow& window)
+        {
+            sStatsBatch << tag
+                        << now
+                        << key
+                        << (uint32_t)window.reward.getSampleSize();
+            sStatsBatch << (uint32_t)window.reward.getMin().size();
+            for (size_t i = 0; i < window.reward.getMin().size(); ++i)
+            {
+                sStatsBatch << (float64_t)window.reward.getMin()[i]
+                            << (float64_t)window.reward.getAverage()[i]
+                            << (float64_t)window.reward.getMax()[i];
+            }
+            sStatsBatch << (uint32_t)window.fitness.getMin().size();
+            for (size_t i = 0; i < window.fitness.getMin().size(); ++i)
+            {
+                sStatsBatch << (float64_t)window.fitness.getMin()[i]
+                            << (float64_t)window.fitness.getAverage()[i]
+                            << (float64_t)window.fitness.getMax()[i];
+            }
+        }
+
+        /// close the current aggregation window: emit one summary record
+        /// per agent, fold the agent windows into per-team windows and
+        /// emit those too, then start the next window
+        /// (the caller holds sStatsMutex)
+        void FlushTelemetryWindows(float64_t now)
+        {
+            if (!sWindows.empty())
+            {
+                std::map<uint32_t, TelemetryWindow> teams;
+                std::map<SimId, TelemetryWindow>::const_iterator iter;
+                for (iter = sWindows.begin(); iter != sWindows.end(); ++iter)
+                {
+                    AppendWindowRecord(kTelemetryAgentWindowTag,
+                                       (uint32_t)iter->first, now, iter->second);
+                    TelemetryWindow& team =
+                        teams[CombatService::instance().GetTeam(iter->first)];
+                    team.reward.merge(iter->second.reward);
+                    team.fitness.merge(iter->second.fitness);
+                }
+                std::map<uint32_t, TelemetryWindow>::const_iterator team;
+                for (team = teams.begin(); team != teams.end(); ++team)
+                {
+                    AppendWindowRecord(kTelemetryTeamWindowTag,
+                                       team->first, now, team->second);
+                }
+                sWindows.clear();
+            }
+            sWindowStart = now;
+        }
+    }
+
+    AIManager& AIManager::instance()
+    {
+        static AIManager me;
+        return me;
+    }
+
+    const AIManager& AIManager::const_instance()
+    {
+        return instance();
+    }
+
+    void AIManager::SetEnabled(bool state)
+    {
+        if (state)
+        {
+            LOG_F_MSG("ai", "AI Engine enabled");
+        }
+        else
+        {
+            LOG_F_MSG("ai", "AI Engine disabled");
+        }
+        mEnabled = state;
+    }
+
+    /// set the per-tick time budget for a single brain in microseconds
+    void AIManager::SetTickBudget(uint32_t microseconds)
+    {
+        if (microseconds > 0)
+        {
+            LOG_F_MSG("ai", "AI tick budget set to " << microseconds << " us per brain");
+        }
+        else
+        {
+            LOG_F_MSG("ai", "AI tick budget disabled");
+        }
+        mTickBudgetMicroseconds = microseconds;
+    }
+
+    /// configure the AI level of detail
+    void AIManager::SetLOD(float32_t distance, uint32_t period, uint32_t types)
+    {
+        if (distance > 0 && period > 1 && types != 0)
+        {
+            LOG_F_MSG("ai", "AI LOD enabled: agents more than " << distance
+                << " units from the action decide every " << period << " ticks");
+        }
+        else
+        {
+            distance = 0;
+            period = 1;
+            LOG_F_MSG("ai", "AI LOD disabled");
+        }
+        mLODDistance = distance;
+        mLODPeriod = period;
+        mLODTypes = types;
+    }
+
+    /// get the currently selected AI Environment
+    EnvironmentPtr AIManager::GetEnvironment() const { return mEnvironment; }
+
+    /// set the currently selected AI Environment
+    void AIManager::SetEnvironment(EnvironmentPtr env) { 
+        if (mEnvironment) {
+            mEnvironment->cleanup();
+            mEnvironment.reset();
+        }
+        mEnvironment = env;
+        mAgentInfoCache.clear();
+    }
+
+    /// look up (or fetch and cache) the init info for an agent type
+    AgentInitInfo AIManager::GetAgentInitInfo(const std::string& agentType, AgentBrainPtr brain)
+    {
+        std::map<std::string, AgentInitInfo>::const_iterator found =
+            mAgentInfoCache.find(agentType);
+        if (found != mAgentInfoCache.end()) {
+            return found->second;
+        }
+        AssertMsg(mEnvironment, "Requesting agent init info without an environment!");
+        AgentInitInfo info = mEnvironment->get_agent_info(brain);
+        mAgentInfoCache[agentType] = info;
+        return info;
+    }
+
+    /// move the current AI state out into saved, leaving the manager
+    /// empty and disabled for the next mod; unlike destroy(), nothing is
+    /// cleaned up, so a later RestoreState picks up where we left off
+    void AIManager::SaveState(SavedState& saved)
+    {
+        saved.enabled = mEnabled;
+        saved.environment = mEnvironment;
+        saved.ais = mAIs;
+        mEnabled = false;
+        mEnvironment.reset();
+        mAIs.clear();
+        mAgentInfoCache.clear();
+    }
+
+    /// replace the current AI state with a previously saved one
+    void AIManager::RestoreState(const SavedState& saved)
+    {
+        mEnabled = saved.enabled;
+        mEnvironment = saved.environment;
+        mAIs = saved.ais;
+        mAgentInfoCache.clear();
+    }
+
+    /// Append the AI section of a world snapshot to an open binary
+    /// stream: a small header (the NEAT random seed and the names of the
+    /// AIs captured) followed by one population archive per name.
+    void AIManager::SaveSnapshot(std::ostream& out) const
+    {
+        std::vector<std::string> names;
+        std::vector<RTNEATPtr> neats;
+        std::map<std::string, AIPtr>::const_iterator iter;
+        for (iter = mAIs.begin(); iter != mAIs.end(); ++iter) {
+            RTNEATPtr rtneat = boost::dynamic_pointer_cast<RTNEAT>(iter->second);
+            if (rtneat) {
+                names.push_back(iter->first);
+                neats.push_back(rtneat);
+            } else {
+                LOG_F_WARNING("ai", "world snapshot cannot capture AI '" << iter->first << "'; skipping it");
+            }
+        }
+
+        Bitstream head;
+        head << (uint32_t)NEAT::get_random_seed() << (uint32_t)names.size();
+        for (size_t i = 0; i < names.size(); ++i) {
+            head << names[i];
+        }
+
+        const uint32_t headBytes = head.ByteLength();
+        out.write((const char*)&headBytes, sizeof(headBytes));
+        out.write((const char*)head.Stream(), headBytes);
+
+        for (size_t i = 0; i < neats.size(); ++i) {
+            neats[i]->SaveSnapshot(out);
+        }
+    }
+
+    /// Restore the AI section of a world snapshot written by SaveSnapshot
+    /// @return true if every recorded AI was found and restored
+    bool AIManager::RestoreSnapshot(std::istream& in)
+    {
+        uint32_t headBytes = 0;
+        in.read((char*)&headBytes, sizeof(headBytes));
+        if (!in || headBytes == 0) {
+            LOG_F_ERROR("ai", "world snapshot has no AI section");
+            return false;
+        }
+
+        std::vector<uint8_t> bytes(headBytes);
+        in.read((char*)&bytes[0], headBytes);
+        if (!in) {
+            LOG_F_ERROR("ai", "world snapshot AI section is truncated");
+            return false;
+        }
+
+        BitstreamView head(&bytes[0], headBytes);
+        uint32_t seed = 0, count = 0;
+        head >> seed >> count;
+        NEAT::seed_random(seed);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string name;
+            head >> name;
+            std::map<std::string, AIPtr>::const_iterator found = mAIs.find(name);
+            RTNEATPtr rtneat;
+            if (found != mAIs.end()) {
+                rtneat = boost::dynamic_pointer_cast<RTNEAT>(found->second);
+            }
+            if (!rtneat) {
+                // the archives are not skippable, so a missing AI ends the restore
+                LOG_F_ERROR("ai", "world snapshot records AI '" << name << "' which is not registered; aborting restore");
+                return false;
+            }
+            if (!rtneat->RestoreSnapshot(in)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Shutdown and clean-up the AI subsystem
+    void AIManager::destroy()
+    {
+        SetEnabled(false);
+        {
+            // don't strand buffered telemetry on shutdown
+            std::lock_guard<std::mutex> stats_guard(sStatsMutex);
+            FlushTelemetryWindows(GetStaticTimer().getMilliseconds() / 1000.0);
+            FlushStatsBatch();
+        }
+        // close the trajectory stream (flushes everything buffered)
+        TrajectoryLog::instance().Disable();
+        // write a final checkpoint while the AIs are still registered
+        Autosave::instance().Disable();
+        if (mEnvironment) {
+            mEnvironment->cleanup();
+            mEnvironment.reset();
+        }
+        mAIs.clear();
+        mAgentInfoCache.clear();
+    }
+
+    AIPtr AIManager::GetAI(const std::string& name) const
+    {
+        map<string, AIPtr>::const_iterator iter = mAIs.find(name);
+        if (iter != mAIs.end()) 
+        {
+            return iter->second;
+        }
+        else
+        {
+            return AIPtr();
+        }
+    }
+
+    void AIManager::Log(SimId id,
+                        size_t episode,
+                        size_t step,
+                        Reward reward,
+                        Reward fitness)
+    {
+        std::lock_guard<std::mutex> stats_guard(sStatsMutex);
+
+        if (mTelemetryWindow > 0)
+        {
+            // aggregation is on: reduce the sample into the agent's
+            // window instead of shipping it; ProcessTick emits one
+            // summary record per agent when the window closes
+            TelemetryWindow& window = sWindows[id];
+            window.reward.addSample(reward);
+            window.fitness.addSample(fitness);
+        }
+        else
+        {
+            // append a compact tagged binary record to the stats batch:
+            // fixed-width fields are much cheaper to assemble here and to
+            // decode in Python than printing and regex matching floating
+            // point text per agent per step
+            sStatsBatch << kTelemetryTickTag
+                        << (float64_t)(GetStaticTimer().getMilliseconds() / 1000.0)
+                        << (uint32_t)id
+                        << (uint32_t)episode
+                        << (uint32_t)step;
+            sStatsBatch << (uint32_t)reward.size();
+            for (size_t i = 0; i < reward.size(); ++i)
+                sStatsBatch << (float64_t)reward[i];
+            sStatsBatch << (uint32_t)fitness.size();
+            for (size_t i = 0; i < fitness.size(); ++i)
+                sStatsBatch << (float64_t)fitness[i];
+            if (sStatsBatch.ByteLength() >= kStatsFlushBytes)
+                FlushStatsBatch();
+        }
+
+        // the human-readable line is optional: it feeds the file-based
+        // plotting workflow but costs a stringstream per step
+        if (mTextLog)
+        {
+            LOG_F_DEBUG("ai.tick", id <<
+                "\t" << episode <<
+                "\t" << step <<
+                "\t" << reward <<
+                "\t" << fitness);
+        }
+    }
+
+    void AIManager::SetAI(const std::string& name, AIPtr ai)
+    {
+        mAIs[name] = ai;
+    }
+    
+    /// set the telemetry aggregation window in seconds (0 = per-step)
+    void AIManager::SetTelemetryWindow(float32_t seconds)
+    {
+        std::lock_guard<std::mutex> stats_guard(sStatsMutex);
+        // close the current window under the old setting so no samples
+        // are stranded (or shipped twice) across the change
+        FlushTelemetryWindows(GetStaticTimer().getMilliseconds() / 1000.0);
+        if (seconds > 0)
+        {
+            LOG_F_MSG("ai", "telemetry aggregation window set to " << seconds << " s");
+            mTelemetryWindow = seconds;
+        }
+        else
+        {
+            LOG_F_MSG("ai", "telemetry aggregation disabled; streaming per-step records");
+            mTelemetryWindow = 0;
+        }
+    }
+
+    /// enable or disable the per-step ai.tick text log line
+    void AIManager::SetTextLog(bool enable)
+    {
+        LOG_F_MSG("ai", "AI text tick log " << (enable ? "enabled" : "disabled"));
+        mTextLog = enable;
+    }
+
+    /// tick the AIs
+    void AIManager::ProcessTick( float32_t incAmt )
+    {
+        if (mEnabled) {
+            map<string, AIPtr>::iterator iter;
+            map<string, AIPtr>::iterator iend = mAIs.end();
+            for (iter = mAIs.begin(); iter != iend; ++iter)
+            {
+                iter->second->ProcessTick(incAmt);
+            }
+        }
+
+        // ship whatever telemetry this frame produced in one large write
+        {
+            std::lock_guard<std::mutex> stats_guard(sStatsMutex);
+            if (mTelemetryWindow > 0)
+            {
+                const float64_t now = GetStaticTimer().getMilliseconds() / 1000.0;
+                if (now - sWindowStart >= mTelemetryWindow)
+                    FlushTelemetryWindows(now);
+            }
+            FlushStatsBatch();
+        }
+        // same per-frame cadence for the trajectory exporter
+        TrajectoryLog::instance().Flush();
+        // stage a crash-resilient checkpoint if one is due
+        Autosave::instance().ProcessTick();
+    }
+    
+    /// reset the ai (remove the ai systems)
+    void AIManager::Reset()
+    {
+        if (mEnvironment) {
+            mEnvironment->cleanup();
+        }
+        mAIs.clear();
+        mAgentInfoCache.clear();
+    }
+}
@@ -2,6 +2,7 @@
 #define _OPENNERO_AI_AIMANAGER_H_
 
 #include <set>
+#include <iosfwd>
 #include "ai/AI.h"
 
 namespace OpenNero
@@ -18,9 +19,22 @@ namespace OpenNero
     class AIManager
     {
         // private constructor
-        AIManager() : mEnabled(false), mEnvironment() {}
+        AIManager() : mEnabled(false), mEnvironment(), mTickBudgetMicroseconds(0), mTextLog(true),
+                      mTelemetryWindow(0), mLODDistance(0), mLODPeriod(1), mLODTypes(0),
+                      mDecisionStretch(1) {}
 
     public:
+        /// the detachable AI state of one mod, saved and restored around
+        /// suspend/resume mod switches
+        struct SavedState
+        {
+            bool enabled; ///< was AI ticking when the mod was suspended?
+            EnvironmentPtr environment; ///< the mod's environment
+            std::map<std::string, AIPtr> ais; ///< the mod's named AI instances
+
+            SavedState() : enabled(false) {}
+        };
+
         /// singleton instance of class
         static AIManager& instance();
 
@@ -43,15 +57,99 @@ namespace OpenNero
         /// set the currently selected AI Environment
         void SetEnvironment(EnvironmentPtr env);
 
+        /// Get the AgentInitInfo for an agent type from the current
+        /// environment, caching the answer by type. get_agent_info is
+        /// usually a Python crossing that rebuilds the same sensor and
+        /// action bound arrays for every agent, so a round-start spawn of
+        /// dozens of identical agents pays for one crossing instead of
+        /// one per agent. The cache is dropped whenever the environment
+        /// changes.
+        /// @param agentType key identifying the agent blueprint (the
+        ///                  template's brain expression)
+        /// @param brain the brain the info is requested for, passed
+        ///              through to get_agent_info on a cache miss
+        AgentInitInfo GetAgentInitInfo(const std::string& agentType, AgentBrainPtr brain);
+
         /// get the named AI instance if available
         AIPtr GetAI(const std::string& name) const;
 
         /// set the named AI instance
         void SetAI(const std::string& name, AIPtr ai);
 
+        /// set the per-tick time budget for a single brain in microseconds
+        /// (0 disables budget enforcement)
+        void SetTickBudget(uint32_t microseconds);
+
+        /// get the per-tick brain time budget in microseconds (0 = disabled)
+        uint32_t GetTickBudget() const { return mTickBudgetMicroseconds; }
+
+        /// Configure the AI level of detail: an agent farther than
+        /// distance from every entity matching the type mask decides
+        /// (and senses) only every period ticks, repeating its actions
+        /// in between, and is promoted back to full rate as soon as a
+        /// decision finds the action within range again.
+        /// @param distance demotion distance in world units (0 disables)
+        /// @param period decision period of demoted agents (>= 2)
+        /// @param types bitmask of entity types that count as action
+        void SetLOD(float32_t distance, uint32_t period, uint32_t types);
+
+        /// demotion distance of the AI level of detail (0 = disabled)
+        float32_t GetLODDistance() const { return mLODDistance; }
+
+        /// decision period of demoted agents
+        uint32_t GetLODPeriod() const { return mLODPeriod; }
+
+        /// entity types that count as action for the level of detail
+        uint32_t GetLODTypes() const { return mLODTypes; }
+
+        /// Globally stretch every agent's decision period by the given
+        /// factor (the tick governor raises this to shed AI load; 1 = none)
+        void SetDecisionStretch(uint32_t factor) { mDecisionStretch = factor > 0 ? factor : 1; }
+
+        /// the global decision period stretch factor (1 = none)
+        uint32_t GetDecisionStretch() const { return mDecisionStretch; }
+
+        /// enable or disable the per-step ai.tick text log line (the
+        /// binary telemetry stream to the plot server is unaffected)
+        void SetTextLog(bool enable);
+
+        /// return true iff the per-step ai.tick text log line is on
+        bool IsTextLogEnabled() const { return mTextLog; }
+
+        /// Aggregate telemetry at the source instead of streaming every
+        /// per-step sample: reward and fitness samples are reduced into
+        /// per-agent (and per-team) min/mean/max/count windows and only
+        /// one summary record per agent per window is sent to the plot
+        /// server. 0 restores the per-step records.
+        /// @param seconds length of the aggregation window
+        void SetTelemetryWindow(float32_t seconds);
+
+        /// the telemetry aggregation window in seconds (0 = per-step)
+        float32_t GetTelemetryWindow() const { return mTelemetryWindow; }
+
         /// log the performance of AI agents
         void Log(SimId id, size_t episode, size_t step, Reward reward, Reward fitness);
         
+        /// move the current AI state out into saved, leaving the manager
+        /// empty and disabled for the next mod
+        void SaveState(SavedState& saved);
+
+        /// replace the current AI state with a previously saved one
+        void RestoreState(const SavedState& saved);
+
+        /// Append the AI section of a world snapshot to an open binary
+        /// stream: the NEAT random seed and the population of every named
+        /// rtNEAT instance. AIs with no snapshot support (e.g. Python
+        /// brains) are skipped with a warning.
+        void SaveSnapshot(std::ostream& out) const;
+
+        /// Restore the AI section of a world snapshot written by
+        /// SaveSnapshot. Every recorded AI must be registered under the
+        /// same name (the usual flow restores into the world that took
+        /// the snapshot).
+        /// @return true if every recorded AI was found and restored
+        bool RestoreSnapshot(std::istream& in);
+
         /// reset the ai (remove the ai systems)
         void Reset();
 
@@ -61,7 +159,15 @@ namespace OpenNero
     private:
         bool mEnabled; ///< global "disable AI" switch
         EnvironmentPtr mEnvironment; ///< current environment
+        uint32_t mTickBudgetMicroseconds; ///< per-brain tick budget (0 = off)
+        bool mTextLog; ///< emit the per-step ai.tick text log line?
+        float32_t mTelemetryWindow; ///< telemetry aggregation window in seconds (0 = per-step)
+        float32_t mLODDistance; ///< AI LOD demotion distance (0 = off)
+        uint32_t mLODPeriod; ///< decision period of demoted agents
+        uint32_t mLODTypes; ///< entity types that count as action
+        uint32_t mDecisionStretch; ///< global decision period multiplier (shedding)
         std::map<std::string, AIPtr> mAIs; ///< AIs currently used
+        std::map<std::string, AgentInitInfo> mAgentInfoCache; ///< get_agent_info results by agent type
     };
 
 }
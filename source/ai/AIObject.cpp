@@ -2,17 +2,130 @@
 #include "ai/AI.h"
 #include "ai/AIObject.h"
 #include "ai/AIManager.h"
+#include "ai/TrajectoryLog.h"
 #include "ai/Environment.h"
 #include "ai/AgentBrain.h"
 #include "ai/PythonAI.h"
 #include "ai/random/RandomAI.h"
 #include "core/IrrUtil.h"
+#include "game/Kernel.h"
+#include "game/SimContext.h"
 #include "game/SimEntityData.h"
+#include "game/Simulation.h"
 #include "math/Random.h"
 #include "scripting/scriptIncludes.h"
+#include "scripting/scripting.h"
+
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace OpenNero
 {
+    /// one pipelined brain consultation handed to the worker thread
+    struct AsyncBrainJob
+    {
+        AgentBrainPtr brain;         ///< the brain to consult
+        float32_t dt;                ///< tick length handed to act()
+        Observations observations;   ///< snapshot of the sensed state
+        Reward reward;               ///< reward at submission time
+        Actions result;              ///< actions chosen by the brain
+        bool done;                   ///< has the worker finished this job?
+        std::mutex mutex;            ///< guards done
+        std::condition_variable ready; ///< signaled when the job finishes
+
+        AsyncBrainJob() : dt(0), done(false) {}
+    };
+
+    namespace
+    {
+        typedef boost::shared_ptr<AsyncBrainJob> AsyncBrainJobPtr;
+
+        /**
+         * A single background thread that runs queued Python brain
+         * consultations. Each job acquires the GIL on its own, so the
+         * consultations overlap with the C++ phases of the main loop
+         * (which release the GIL) and time-slice with main-thread Python
+         * through the interpreter's normal thread switching.
+         */
+        class BrainWorker
+        {
+        public:
+            static BrainWorker& instance()
+            {
+                static BrainWorker worker;
+                return worker;
+            }
+
+            /// queue a job for the worker thread
+            void Submit(const AsyncBrainJobPtr& job)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(mMutex);
+                    mJobs.push_back(job);
+                }
+                mJobReady.notify_one();
+            }
+
+        private:
+            BrainWorker() : mShutdown(false)
+            {
+                mThread = std::thread(&BrainWorker::Loop, this);
+            }
+
+            ~BrainWorker()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(mMutex);
+                    mShutdown = true;
+                }
+                mJobReady.notify_all();
+                mThread.join();
+            }
+
+            void Loop()
+            {
+                for (;;)
+                {
+                    AsyncBrainJobPtr job;
+                    {
+                        std::unique_lock<std::mutex> guard(mMutex);
+                        while (mJobs.empty() && !mShutdown)
+                            mJobReady.wait(guard);
+                        if (mShutdown && mJobs.empty())
+                            return;
+                        job = mJobs.front();
+                        mJobs.pop_front();
+                    }
+
+                    // brain consultations run Python, so take the GIL per
+                    // job; during interpreter shutdown fall back to the
+                    // previous actions instead of calling into Python
+                    if (Py_IsInitialized())
+                    {
+                        PyGILState_STATE gil = PyGILState_Ensure();
+                        job->result = job->brain->act(job->dt, job->observations, job->reward);
+                        PyGILState_Release(gil);
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> guard(job->mutex);
+                        job->done = true;
+                    }
+                    job->ready.notify_all();
+                }
+            }
+
+            std::thread mThread;               ///< the worker thread
+            std::deque<AsyncBrainJobPtr> mJobs; ///< jobs waiting to run
+            std::mutex mMutex;                 ///< guards the queue
+            std::condition_variable mJobReady; ///< signaled on submit or shutdown
+            bool mShutdown;                    ///< set when the worker is being destroyed
+        };
+    }
+
     /**
     * Factory method to create the appropriate type of AIObjectTemplate depending on the XML data provided
     * @param factory SimFactory used to grab resources
@@ -40,7 +153,16 @@ namespace OpenNero
         , mAgentBrain()
         , mWorld(world)
         , mReward()
+        , mObservations()
         , mSensors(parent)
+        , mLastTickMicroseconds(0)
+        , mTotalTickMicroseconds(0)
+        , mTickCount(0)
+        , mThrottleSkipsRemaining(0)
+        , mTicksSinceDecision(0)
+        , mLODPeriod(1)
+        , mStepFullCached(false)
+        , mCachedEpisodeOver(false)
     {
     }
     
@@ -49,38 +171,188 @@ namespace OpenNero
         // nada
     }
     
+    bool AIObject::IsTickThreadSafe() const
+    {
+        EnvironmentPtr world = getWorld();
+        AgentBrainPtr brain = getBrain();
+        return world && brain && world->threadSafe() && brain->threadSafe();
+    }
+
+    /// Re-evaluate this agent's level of detail: far from every entity
+    /// matching the configured interaction mask, the agent decides (and
+    /// senses) only every LOD-period ticks and repeats its actions in
+    /// between. Called when the agent decides, so a demoted agent
+    /// re-checks its relevance at most one reduced period later.
+    void AIObject::UpdateLOD()
+    {
+        const AIManager& manager = AIManager::const_instance();
+        const float32_t distance = manager.GetLODDistance();
+        if (distance <= 0)
+        {
+            mLODPeriod = 1;
+            return;
+        }
+        SimContextPtr context = Kernel::GetSimContext();
+        if (!context || !context->getSimulation())
+        {
+            mLODPeriod = 1;
+            return;
+        }
+
+        // any relevant entity other than the agent itself within range
+        // keeps the agent at full rate
+        SimEntityList nearby;
+        context->getSimulation()->QueryRadius(
+            GetSharedState()->GetPosition(), distance, manager.GetLODTypes(), nearby);
+        bool relevant = false;
+        SimEntityList::const_iterator itr;
+        for (itr = nearby.begin(); itr != nearby.end(); ++itr)
+        {
+            if ((*itr)->GetSimId() != GetSharedState()->GetId())
+            {
+                relevant = true;
+                break;
+            }
+        }
+        mLODPeriod = relevant ? 1 : manager.GetLODPeriod();
+    }
+
+    /// the brain's decision period, stretched by the LOD demotion
+    uint32_t AIObject::EffectiveDecisionPeriod() const
+    {
+        uint32_t period = getBrain()->decision_period;
+        if (mLODPeriod > period)
+            period = mLODPeriod;
+        return period * AIManager::const_instance().GetDecisionStretch();
+    }
+
     /// get the AI move and apply it to the shared data
     void AIObject::ProcessTick(float32_t dt)
     {
         Assert(getBrain());
 
-        if (getBrain()->step == 0) // if first step
+        const uint32_t budget = AIManager::const_instance().GetTickBudget();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if (budget > 0 && mThrottleSkipsRemaining > 0 && getBrain()->step > 0
+            && !EpisodeOver())
+        {
+            // throttled: repeat the previous actions without sensing or
+            // consulting the brain, so one pathological agent cannot tank
+            // the whole arena
+            --mThrottleSkipsRemaining;
+            StepWorld();
+        }
+        else if (getBrain()->step == 0) // if first step
         {
-            Observations observations = sense();
+            const Observations& observations = sense();
             setActions(getBrain()->start(dt, observations));
-            setReward(getWorld()->step(getBrain(), getActions()));
-            getBrain()->step++;
+            StepWorld();
+            mTicksSinceDecision = 0;
+            UpdateLOD();
         }
         else
         {
             Assert(getWorld());
-            if (getWorld()->is_episode_over(getBrain())) {
+            if (EpisodeOver()) {
+                if (mAsyncJob) // the episode the pending decision belongs to is over
+                    WaitAsyncDecision();
                 getBrain()->end(dt, getReward());
                 getWorld()->reset(getBrain());
                 getBrain()->episode++;
                 getBrain()->step = 0;
                 getBrain()->fitness = getInitInfo().reward.getInstance();
+                mTicksSinceDecision = 0;
+                // the cached observations belong to the finished episode
+                mStepFullCached = false;
+            } else if (EffectiveDecisionPeriod() > 1
+                       && mTicksSinceDecision + 1 < EffectiveDecisionPeriod()) {
+                // intermediate tick of the brain's decision interval
+                // (possibly stretched by the LOD demotion): repeat the
+                // previous actions without sensing or consulting the brain
+                ++mTicksSinceDecision;
+                StepWorld();
             } else {
-                Observations observations = sense();
-                if (!getBrain()->GetSkip()) // only generate new actions when not skipping
-                    setActions(getBrain()->act(dt, observations, getReward()));
-                setReward(getWorld()->step(getBrain(), getActions()));
-                getBrain()->step++;
+                if (getBrain()->asynchronous) {
+                    // pipelined: apply the actions decided from last tick's
+                    // observations, then hand this tick's observations to
+                    // the worker to produce the actions for the next tick
+                    if (mAsyncJob) {
+                        Actions pending = WaitAsyncDecision();
+                        if (!pending.empty())
+                            setActions(pending);
+                    }
+                    const Observations& observations =
+                        mStepFullCached ? mObservations : sense();
+                    if (!getBrain()->GetSkip())
+                        SubmitAsyncDecision(dt, observations, getReward());
+                } else {
+                    // a pending step_full result already holds this
+                    // tick's observations; no sensing crossing needed
+                    const Observations& observations =
+                        mStepFullCached ? mObservations : sense();
+                    if (!getBrain()->GetSkip()) // only generate new actions when not skipping
+                        setActions(getBrain()->act(dt, observations, getReward()));
+                }
+                StepWorld();
+                mTicksSinceDecision = 0;
+                UpdateLOD();
+            }
+        }
+
+        const uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        mLastTickMicroseconds = micros;
+        mTotalTickMicroseconds += micros;
+        ++mTickCount;
+
+        if (budget > 0 && micros > budget && mThrottleSkipsRemaining == 0)
+        {
+            // owe one skipped brain consultation per budget multiple blown,
+            // capped so a single stall cannot freeze the agent for long
+            static const uint32_t kMaxThrottleSkips = 10;
+            uint32_t skips = (uint32_t)(micros / budget) - 1;
+            if (skips > kMaxThrottleSkips)
+                skips = kMaxThrottleSkips;
+            if (skips > 0)
+            {
+                mThrottleSkipsRemaining = skips;
+                LOG_F_WARNING("ai", "agent " << GetSharedState()->GetId()
+                    << " took " << micros << " us (budget " << budget
+                    << " us), throttling for " << skips << " ticks");
             }
         }
     }
     
-    void AIObject::setReward(Reward reward)
+    /// hand this tick's observations and reward to the brain worker
+    void AIObject::SubmitAsyncDecision(float32_t dt, const Observations& observations, const Reward& reward)
+    {
+        AsyncBrainJobPtr job(new AsyncBrainJob());
+        job->brain = getBrain();
+        job->dt = dt;
+        job->observations = observations;
+        job->reward = reward;
+        mAsyncJob = job;
+        BrainWorker::instance().Submit(job);
+    }
+
+    /// block until the in-flight decision finishes, clear it, and return
+    /// the actions it produced; the GIL is released while waiting so the
+    /// worker (which needs it to run Python) can finish the job
+    Actions AIObject::WaitAsyncDecision()
+    {
+        AsyncBrainJobPtr job = mAsyncJob;
+        mAsyncJob.reset();
+        Assert(job);
+
+        ScopedGILRelease gil;
+        std::unique_lock<std::mutex> guard(job->mutex);
+        while (!job->done)
+            job->ready.wait(guard);
+        return job->result;
+    }
+
+    void AIObject::setReward(const Reward& reward)
     {
         Assert(getBrain());
         AssertMsg(getBrain()->fitness.size() == reward.size(), "AgentBrain fitness and reward dimensions must match");
@@ -95,18 +367,175 @@ namespace OpenNero
              getBrain()->step,
              getReward(),
              getBrain()->fitness);
+        if (TrajectoryLog::instance().IsEnabled())
+        {
+            // export the full training tuple for this step: the latest
+            // observations and actions are still current here
+            TrajectoryLog::instance().Record
+                (GetSharedState()->GetId(),
+                 getBrain()->episode,
+                 getBrain()->step,
+                 mObservations,
+                 getActions(),
+                 getReward());
+        }
+    }
+
+    /// Apply the current actions to the environment. With an environment
+    /// that implements the combined protocol this is the tick's single
+    /// scripting crossing: the built-in sensors pre-fill the observation
+    /// buffer, step_full performs the actions and returns the reward
+    /// together with the observations the next decision acts on and the
+    /// episode flag, and both are cached for the next tick. Otherwise
+    /// this is the classic step-only call and the next tick senses and
+    /// checks termination separately.
+    void AIObject::StepWorld()
+    {
+        if (getWorld()->supports_step_full())
+        {
+            senseLocal();
+            bool done = false;
+            setReward(getWorld()->step_full(
+                getBrain(), getActions(), mObservations, done));
+            mCachedEpisodeOver = done;
+            mStepFullCached = true;
+        }
+        else
+        {
+            setReward(getWorld()->step(getBrain(), getActions()));
+        }
+        getBrain()->step++;
+    }
+
+    /// is the current episode over? answered from the step_full cache
+    /// when one is pending, avoiding a scripting crossing
+    bool AIObject::EpisodeOver()
+    {
+        if (mStepFullCached)
+            return mCachedEpisodeOver;
+        return getWorld()->is_episode_over(getBrain());
     }
 
     /// sense the agent's environment
-    Observations AIObject::sense()
+    const Observations& AIObject::sense()
     {
-        // create a new observation vector
-        Observations o = getInitInfo().sensors.getInstance();
-        // first, pass it along to the built-in sensors so that they can set some of the values
-        mSensors.getObservations(o);
+        senseLocal();
         // then, pass it to the environment and let it compute the final sensor vector
-        Observations observations = getWorld()->sense(getBrain(), o);
-        return observations;
+        mObservations = getWorld()->sense(getBrain(), mObservations);
+        return mObservations;
+    }
+
+    /// fill the observation buffer with the built-in sensor values only
+    const Observations& AIObject::senseLocal()
+    {
+        // reset the per-agent observation vector, reusing its storage
+        getInitInfo().sensors.getInstance(mObservations);
+        // pass it along to the built-in sensors so that they can set some of the values
+        mSensors.getObservations(mObservations);
+        return mObservations;
+    }
+
+    /// tick a batch of agents against a batched environment
+    void AIObject::ProcessTickBatch(const std::vector<AIObjectPtr>& agents, float32_t dt, BatchEnvironment& batch)
+    {
+        if (agents.empty())
+            return;
+
+        AgentBrainList brains(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            Assert(agents[i]->getBrain());
+            brains[i] = agents[i]->getBrain();
+        }
+
+        // one crossing answers episode termination for the whole batch
+        std::vector<bool> over(agents.size(), false);
+        batch.is_episode_over_all(brains, over);
+
+        // agents whose episode ended wrap up and reset individually (rare)
+        // and sit out the rest of the tick, like the per-agent path does
+        std::vector<AIObjectPtr> stepping;
+        stepping.reserve(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            AgentBrainPtr brain = brains[i];
+            if (brain->step > 0 && over[i])
+            {
+                brain->end(dt, agents[i]->getReward());
+                agents[i]->getWorld()->reset(brain);
+                brain->episode++;
+                brain->step = 0;
+                brain->fitness = agents[i]->getInitInfo().reward.getInstance();
+            }
+            else
+            {
+                stepping.push_back(agents[i]);
+            }
+        }
+        if (stepping.empty())
+            return;
+
+        // agents on an intermediate tick of their decision interval keep
+        // their previous actions and skip sensing entirely; only the
+        // deciding agents pay for sense_all and a brain consultation
+        std::vector<AIObjectPtr> deciding;
+        deciding.reserve(stepping.size());
+        for (size_t i = 0; i < stepping.size(); ++i)
+        {
+            AgentBrainPtr brain = stepping[i]->getBrain();
+            if (brain->step > 0 && stepping[i]->EffectiveDecisionPeriod() > 1
+                && stepping[i]->mTicksSinceDecision + 1 < stepping[i]->EffectiveDecisionPeriod())
+            {
+                ++stepping[i]->mTicksSinceDecision;
+            }
+            else
+            {
+                deciding.push_back(stepping[i]);
+            }
+        }
+
+        if (!deciding.empty())
+        {
+            // the built-in sensors run in C++ per agent; one crossing then
+            // computes all the final observation vectors
+            AgentBrainList decidingBrains(deciding.size());
+            ObservationsList observations(deciding.size());
+            for (size_t i = 0; i < deciding.size(); ++i)
+            {
+                decidingBrains[i] = deciding[i]->getBrain();
+                observations[i] = deciding[i]->senseLocal();
+            }
+            batch.sense_all(decidingBrains, observations);
+
+            // the brains still decide one by one (they are separate objects)
+            for (size_t i = 0; i < deciding.size(); ++i)
+            {
+                AgentBrainPtr brain = decidingBrains[i];
+                if (brain->step == 0)
+                    deciding[i]->setActions(brain->start(dt, observations[i]));
+                else if (!brain->GetSkip())
+                    deciding[i]->setActions(brain->act(dt, observations[i], deciding[i]->getReward()));
+                deciding[i]->mTicksSinceDecision = 0;
+                deciding[i]->UpdateLOD();
+            }
+        }
+
+        // one crossing performs every action (fresh or repeated) and
+        // returns all the rewards
+        AgentBrainList steppingBrains(stepping.size());
+        ActionsList actions(stepping.size());
+        for (size_t i = 0; i < stepping.size(); ++i)
+        {
+            steppingBrains[i] = stepping[i]->getBrain();
+            actions[i] = stepping[i]->getActions();
+        }
+        RewardList rewards(stepping.size());
+        batch.step_all(steppingBrains, actions, rewards);
+        for (size_t i = 0; i < stepping.size(); ++i)
+        {
+            stepping[i]->setReward(rewards[i]);
+            steppingBrains[i]->step++;
+        }
     }
 
     inline std::ostream& operator<<(std::ostream& out, AIObject& obj)
@@ -19,6 +19,9 @@ namespace OpenNero
     /// @endcond
 
     class SimEntityData;
+    class RayBatch;
+    class BatchEnvironment;
+    struct AsyncBrainJob;
 
     /// interface for objects connecting an AgentBrain to a SimEntity body
     class AIObject : public BOOST_SHARED_THIS(AIObject),
@@ -37,20 +40,39 @@ namespace OpenNero
         /// get the AI move and apply it to the shared data
         virtual void ProcessTick(float32_t dt);
 
-        /// sense the agent's environment
-        virtual Observations sense();
+        /// true iff both the brain and the environment can tick off the main thread
+        bool IsTickThreadSafe() const;
+
+        /// sense the agent's environment, reusing the per-agent observation buffer
+        virtual const Observations& sense();
+
+        /// fill the observation buffer with the built-in sensor values only,
+        /// leaving the environment's contribution to the caller
+        const Observations& senseLocal();
+
+        /// tick a batch of agents against an environment that implements the
+        /// batched stepping interface, crossing into it three times for the
+        /// whole batch instead of several times per agent; the per-brain tick
+        /// budget and timing counters do not apply on this path
+        static void ProcessTickBatch(const std::vector<AIObjectPtr>& agents, float32_t dt, BatchEnvironment& batch);
+
+        /// get the most recent observations sensed by this AIObject
+        const Observations& getObservations() const { return mObservations; }
 
         /// add a new sensor to the built-in sensor collection for this AIObject
         size_t add_sensor(SensorPtr sensor) { return mSensors.addSensor(sensor); }
 
+        /// queue this tick's sensor ray casts into the batch
+        void QueueRays(RayBatch& batch) { mSensors.queueRays(batch); }
+
         /// display this AI object as a string
         virtual std::ostream& stream(std::ostream& out) const = 0;
 
         /// set the currently selected actions for this AI object
-        void setActions(Actions actions) { mActions = actions; }
+        void setActions(const Actions& actions) { mActions = actions; }
 
         /// get the most recently set actions
-        Actions getActions() const { return mActions; }
+        const Actions& getActions() const { return mActions; }
 
         /// set the brain of this AIObject
         void setBrain(AgentBrainPtr brain) { mAgentBrain = brain; }
@@ -62,10 +84,10 @@ namespace OpenNero
         EnvironmentPtr getWorld() const { return mWorld.lock(); }
 
         /// set the most recent reward for this AIObject
-        void setReward(Reward reward);
+        void setReward(const Reward& reward);
 
         /// get the most recent reward for this AIObject
-        Reward getReward() const { return mReward; }
+        const Reward& getReward() const { return mReward; }
 
         /// set the AgentInitInfo of the agent describing its state and action space
         void setInitInfo(const AgentInitInfo& init_info) { mInitInfo = init_info; }
@@ -73,14 +95,63 @@ namespace OpenNero
         /// get the AgentInitInfo of the agent describing its state and action space
         const AgentInitInfo& getInitInfo() const { return mInitInfo; }
 
+        /// how long the most recent brain tick took, in microseconds
+        uint64_t GetLastTickMicroseconds() const { return mLastTickMicroseconds; }
+
+        /// total time spent ticking this brain, in microseconds
+        uint64_t GetTotalTickMicroseconds() const { return mTotalTickMicroseconds; }
+
+        /// number of ticks this brain has run
+        uint64_t GetTickCount() const { return mTickCount; }
+
+        /// average brain tick time over the object's lifetime, in microseconds
+        float64_t GetAverageTickMicroseconds() const
+        {
+            return mTickCount > 0 ? (float64_t)mTotalTickMicroseconds / (float64_t)mTickCount : 0;
+        }
+
     private:
 
+        /// re-evaluate this agent's level of detail against the nearest
+        /// relevant entity (see AIManager::SetLOD)
+        void UpdateLOD();
+
+        /// the brain's decision period, stretched by the LOD demotion
+        uint32_t EffectiveDecisionPeriod() const;
+
+        /// apply the current actions to the environment; uses the
+        /// combined single-crossing step_full call when the environment
+        /// supports it, caching the returned observations and episode
+        /// flag for the next tick
+        void StepWorld();
+
+        /// is the current episode over? answered from the step_full
+        /// cache when one is pending, avoiding a scripting crossing
+        bool EpisodeOver();
+
+        /// hand this tick's observations and reward to the brain worker
+        void SubmitAsyncDecision(float32_t dt, const Observations& observations, const Reward& reward);
+
+        /// block (with the GIL released) until the in-flight decision
+        /// finishes, clear it, and return the actions it produced
+        Actions WaitAsyncDecision();
+
         Actions mActions; ///< last performed action
         AgentBrainPtr mAgentBrain; ///< the brain whose actions we are applying
         EnvironmentWPtr mWorld; ///< world we are acting in
         Reward mReward; ///< the reward received by the agent after performing the previous action
+        Observations mObservations; ///< per-agent observation buffer reused every tick
         SensorArray mSensors; ///< Built-in sensors for this agent
         AgentInitInfo mInitInfo; ///< the init info for the agent
+        uint64_t mLastTickMicroseconds; ///< duration of the most recent tick
+        uint64_t mTotalTickMicroseconds; ///< cumulative tick time
+        uint64_t mTickCount; ///< number of ticks run
+        uint32_t mThrottleSkipsRemaining; ///< brain consultations still owed for blowing the budget
+        uint32_t mTicksSinceDecision; ///< ticks since the brain last chose actions
+        uint32_t mLODPeriod; ///< this agent's current LOD decision period (1 = full rate)
+        bool mStepFullCached; ///< mObservations and mCachedEpisodeOver hold step_full results
+        bool mCachedEpisodeOver; ///< episode flag returned by the last step_full call
+        boost::shared_ptr<AsyncBrainJob> mAsyncJob; ///< in-flight pipelined decision (NULL when none)
     };
 
     /// print an AI object to stream
@@ -40,9 +40,19 @@ namespace OpenNero
 
             mutable bool skip_flag; ///< causes the next call to act to be skipped
 
+            /// act() is consulted every this many ticks; on intermediate
+            /// ticks the body repeats the last actions without sensing
+            /// (1 = decide every tick)
+            uint32_t decision_period;
+
+            /// consult act() on a background worker thread instead of
+            /// blocking the simulation: observations handed over at tick T
+            /// produce the actions applied at tick T+1
+            bool asynchronous;
+
         public:
             /// constructor
-            AgentBrain() : mBody(), name(), episode(0), step(0), fitness(0), skip_flag(false) {}
+            AgentBrain() : mBody(), name(), episode(0), step(0), fitness(0), skip_flag(false), decision_period(1), asynchronous(false) {}
 
             /// destructor
             virtual ~AgentBrain() {}
@@ -62,6 +72,10 @@ namespace OpenNero
             /// called right before the agent dies
             virtual bool destroy() = 0;
 
+            /// can act() run off the main thread? Brains that call into
+            /// Python must say no (the default)
+            virtual bool threadSafe() const { return false; }
+
             /// get the current fitness of the agent
             Reward get_fitness() { return fitness; }
 
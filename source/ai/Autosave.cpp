@@ -0,0 +1,348 @@
+#include "core/Common.h"
+#include "ai/Autosave.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if NERO_PLATFORM_WINDOWS
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+#include "ai/AIManager.h"
+#include "core/Bitstream.h"
+#include "core/Log.h"
+#include "core/ONTime.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// magic number identifying an AI checkpoint ('ONAC')
+        const uint32_t kCheckpointMagic = 0x4F4E4143;
+
+        /// version of the checkpoint format
+        const uint32_t kCheckpointVersion = 1;
+
+        /// The background writer: at most one staged checkpoint waits
+        /// here at a time -- a newer one simply replaces an older one
+        /// that has not reached the disk yet, since only the latest
+        /// state matters.
+        struct WriterState
+        {
+            std::mutex mutex;             ///< guards everything below
+            std::condition_variable wake; ///< signals the writer thread
+            std::string pending;          ///< the staged checkpoint waiting to be written
+            bool has_pending;             ///< is pending a real checkpoint?
+            std::thread writer;           ///< the background writer thread
+            bool running;                 ///< cleared to ask the writer to drain and exit
+
+            std::string fileName;         ///< the checkpoint file to maintain
+
+            WriterState() : has_pending(false), running(false) {}
+        };
+
+        WriterState* sWriter = NULL;
+
+        /// guards the enable state, the timer, and sWriter
+        std::mutex sStateMutex;
+        bool sEnabled = false;
+        uint64_t sPeriodNanos = 0;
+        uint64_t sLastStageNanos = 0;
+
+        /// The two staging buffers for the fatal-signal hook. Staging
+        /// fills the buffer the atomic index does not point at, then
+        /// publishes it by storing its index, so the hook always finds
+        /// one complete checkpoint no matter when the crash lands.
+        std::string sStage[2];
+        std::atomic<int> sCrashBuffer(-1);
+
+        /// where the hook dumps the staged checkpoint; a flat buffer so
+        /// the handler does not have to touch a std::string
+        char sCrashPath[512] = { 0 };
+        bool sHooksInstalled = false;
+
+        /// Write a complete buffer to path and flush it to disk. Only
+        /// async-signal-safe calls, because the fatal-signal hook runs
+        /// this too.
+        bool WriteFileDurable(const char* path, const char* data, size_t size)
+        {
+#if NERO_PLATFORM_WINDOWS
+            int fd = _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+            if (fd < 0)
+                return false;
+            bool ok = true;
+            size_t written = 0;
+            while (written < size)
+            {
+                const int n = _write(fd, data + written, (unsigned)(size - written));
+                if (n <= 0)
+                {
+                    ok = false;
+                    break;
+                }
+                written += (size_t)n;
+            }
+            if (ok && _commit(fd) != 0)
+                ok = false;
+            _close(fd);
+            return ok;
+#else
+            int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                return false;
+            bool ok = true;
+            size_t written = 0;
+            while (written < size)
+            {
+                const ssize_t n = write(fd, data + written, size - written);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                {
+                    ok = false;
+                    break;
+                }
+                written += (size_t)n;
+            }
+            if (ok && fsync(fd) != 0)
+                ok = false;
+            close(fd);
+            return ok;
+#endif
+        }
+
+        /// The fatal-signal hook: dump the newest complete staged
+        /// checkpoint to <file>.crash, then re-raise the signal with its
+        /// default action. The regular checkpoint file is left alone --
+        /// a handler racing the staging code is best effort and must
+        /// never replace a checkpoint that is known to be good.
+        extern "C" void CrashHandler(int sig)
+        {
+            const int current = sCrashBuffer.load(std::memory_order_acquire);
+            if (current >= 0 && sCrashPath[0] != 0)
+            {
+                WriteFileDurable(sCrashPath, sStage[current].data(), sStage[current].size());
+            }
+            std::signal(sig, SIG_DFL);
+            std::raise(sig);
+        }
+
+        /// hook the fatal signals once per process; the hooks stay in
+        /// place after Disable() so the last staged state can still be
+        /// recovered from a late crash
+        void InstallCrashHooks()
+        {
+            if (sHooksInstalled)
+                return;
+            sHooksInstalled = true;
+            std::signal(SIGSEGV, CrashHandler);
+            std::signal(SIGABRT, CrashHandler);
+            std::signal(SIGFPE, CrashHandler);
+            std::signal(SIGILL, CrashHandler);
+            std::signal(SIGTERM, CrashHandler);
+#if !NERO_PLATFORM_WINDOWS
+            std::signal(SIGBUS, CrashHandler);
+#endif
+        }
+
+        /// the writer thread: write each staged checkpoint to the temp
+        /// file, flush it to disk, and atomically rename it into place
+        void WriterLoop(WriterState* state)
+        {
+            const std::string tempName = state->fileName + ".tmp";
+            for (;;)
+            {
+                std::string buffer;
+                {
+                    std::unique_lock<std::mutex> guard(state->mutex);
+                    while (!state->has_pending && state->running)
+                    {
+                        state->wake.wait(guard);
+                    }
+                    if (!state->has_pending)
+                    {
+                        break; // asked to exit and fully drained
+                    }
+                    buffer.swap(state->pending);
+                    state->has_pending = false;
+                }
+                if (!WriteFileDurable(tempName.c_str(), buffer.data(), buffer.size()))
+                {
+                    LOG_F_ERROR("ai", "could not write autosave checkpoint " << tempName);
+                    continue;
+                }
+#if NERO_PLATFORM_WINDOWS
+                // rename does not replace an existing file here
+                std::remove(state->fileName.c_str());
+#endif
+                if (std::rename(tempName.c_str(), state->fileName.c_str()) != 0)
+                {
+                    LOG_F_ERROR("ai", "could not move autosave checkpoint into place: "
+                        << state->fileName);
+                }
+            }
+        }
+
+        /// Serialize the AI state into memory and hand it off: the
+        /// buffer is published for the fatal-signal hook and a copy is
+        /// queued for the background writer. This is the only blocking
+        /// work the tick thread does -- a few milliseconds for a large
+        /// population. The caller holds sStateMutex.
+        void StageCheckpoint()
+        {
+            std::ostringstream out(std::ios::out | std::ios::binary);
+            Bitstream header;
+            header << kCheckpointMagic << kCheckpointVersion;
+            out.write((const char*)header.Stream(), header.ByteLength());
+            AIManager::const_instance().SaveSnapshot(out);
+            std::string bytes = out.str();
+
+            // publish for the crash hook: fill the buffer the hook is
+            // not reading, then flip the index to it
+            const int next = sCrashBuffer.load(std::memory_order_relaxed) == 0 ? 1 : 0;
+            sStage[next] = bytes;
+            sCrashBuffer.store(next, std::memory_order_release);
+
+            // latest wins: an older checkpoint still waiting here is
+            // superseded, never queued behind
+            {
+                std::lock_guard<std::mutex> guard(sWriter->mutex);
+                sWriter->pending.swap(bytes);
+                sWriter->has_pending = true;
+            }
+            sWriter->wake.notify_one();
+        }
+    }
+
+    Autosave::Autosave()
+    {
+    }
+
+    Autosave& Autosave::instance()
+    {
+        static Autosave me;
+        return me;
+    }
+
+    /// start periodic checkpointing and install the fatal-signal hooks
+    bool Autosave::Enable(const std::string& fileName, float32_t periodSeconds)
+    {
+        Disable(); // stop any autosave already running
+        std::lock_guard<std::mutex> guard(sStateMutex);
+        if (fileName.empty() || periodSeconds <= 0)
+        {
+            LOG_F_ERROR("ai", "autosave needs a file name and a positive period");
+            return false;
+        }
+        const std::string crashName = fileName + ".crash";
+        if (crashName.size() >= sizeof(sCrashPath))
+        {
+            LOG_F_ERROR("ai", "autosave path is too long: " << fileName);
+            return false;
+        }
+        memcpy(sCrashPath, crashName.c_str(), crashName.size() + 1);
+        sWriter = new WriterState();
+        sWriter->fileName = fileName;
+        sWriter->running = true;
+        sWriter->writer = std::thread(WriterLoop, sWriter);
+        sPeriodNanos = (uint64_t)(periodSeconds * 1e9);
+        sLastStageNanos = HighResClock::GetNanoseconds();
+        sEnabled = true;
+        InstallCrashHooks();
+        LOG_F_MSG("ai", "autosave started: " << fileName
+            << " every " << periodSeconds << " s");
+        return true;
+    }
+
+    /// write one final checkpoint and stop the background writer
+    void Autosave::Disable()
+    {
+        WriterState* writer = NULL;
+        {
+            std::lock_guard<std::mutex> guard(sStateMutex);
+            if (!sEnabled)
+                return;
+            // one final checkpoint so stopping never discards progress
+            StageCheckpoint();
+            writer = sWriter;
+            sWriter = NULL;
+            sEnabled = false;
+        }
+        {
+            std::lock_guard<std::mutex> guard(writer->mutex);
+            writer->running = false;
+        }
+        writer->wake.notify_one();
+        writer->writer.join(); // drains the final checkpoint
+        delete writer;
+        LOG_F_MSG("ai", "autosave stopped");
+    }
+
+    /// return true iff checkpoints are being written
+    bool Autosave::IsEnabled() const
+    {
+        return sEnabled;
+    }
+
+    /// stage a checkpoint when the period has elapsed
+    void Autosave::ProcessTick()
+    {
+        std::lock_guard<std::mutex> guard(sStateMutex);
+        if (!sEnabled)
+            return;
+        const uint64_t now = HighResClock::GetNanoseconds();
+        if (now - sLastStageNanos < sPeriodNanos)
+            return;
+        sLastStageNanos = now;
+        StageCheckpoint();
+    }
+
+    /// stage and write a checkpoint now, regardless of the timer
+    void Autosave::SaveNow()
+    {
+        std::lock_guard<std::mutex> guard(sStateMutex);
+        if (!sEnabled)
+            return;
+        sLastStageNanos = HighResClock::GetNanoseconds();
+        StageCheckpoint();
+    }
+
+    /// restore the AI state from a checkpoint written by the autosaver
+    bool Autosave::Restore(const std::string& fileName)
+    {
+        std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            LOG_F_ERROR("ai", "could not open autosave checkpoint " << fileName);
+            return false;
+        }
+        uint32_t magic = 0, version = 0;
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&version, sizeof(version));
+        if (!file || magic != kCheckpointMagic || version != kCheckpointVersion)
+        {
+            LOG_F_ERROR("ai", "autosave checkpoint " << fileName
+                << " has an unknown format");
+            return false;
+        }
+        if (!AIManager::instance().RestoreSnapshot(file))
+        {
+            return false;
+        }
+        LOG_F_MSG("ai", "restored AI state from autosave checkpoint " << fileName);
+        return true;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef _OPENNERO_AI_AUTOSAVE_H_
+#define _OPENNERO_AI_AUTOSAVE_H_
+
+#include <string>
+#include "core/Common.h"
+
+namespace OpenNero
+{
+    /// Crash-resilient autosave of the AI state (the populations of
+    /// every named rtNEAT instance, as written by
+    /// AIManager::SaveSnapshot). On a timer, the tick thread serializes
+    /// the state into a memory buffer -- a brief pause -- and a
+    /// background thread writes it to <file>.tmp, fsyncs, and renames it
+    /// over <file>, so the checkpoint on disk is always a complete one.
+    /// The staged buffers are double-buffered and published through an
+    /// atomic index, so a fatal-signal hook can dump the newest complete
+    /// checkpoint to <file>.crash even if the crash lands mid-staging.
+    class Autosave
+    {
+        // private constructor
+        Autosave();
+
+    public:
+        /// singleton instance of class
+        static Autosave& instance();
+
+        /// start periodic checkpointing and install the fatal-signal hooks
+        /// @param fileName path of the checkpoint file to maintain
+        /// @param periodSeconds seconds between checkpoints
+        /// @return true iff autosave was started
+        bool Enable(const std::string& fileName, float32_t periodSeconds);
+
+        /// write one final checkpoint and stop the background writer
+        void Disable();
+
+        /// return true iff checkpoints are being written
+        bool IsEnabled() const;
+
+        /// called once per frame from AIManager::ProcessTick; stages a
+        /// checkpoint when the period has elapsed
+        void ProcessTick();
+
+        /// stage and write a checkpoint now, regardless of the timer
+        void SaveNow();
+
+        /// restore the AI state from a checkpoint written by the
+        /// autosaver (including a <file>.crash one)
+        /// @return true iff the checkpoint was read and applied
+        bool Restore(const std::string& fileName);
+    };
+}
+
+#endif // _OPENNERO_AI_AUTOSAVE_H_
@@ -13,6 +13,33 @@ namespace OpenNero
         // do nothing here
     }
 
+    /// combined step for environments that do not implement it: the
+    /// classic three calls in sequence, so callers can use step_full
+    /// unconditionally
+    Reward Environment::step_full(AgentBrainPtr agent, Actions action,
+                                  Observations& observations, bool& done)
+    {
+        Reward reward = step(agent, action);
+        observations = sense(agent, observations);
+        done = is_episode_over(agent);
+        return reward;
+    }
+
+    /// Destructor
+    BatchEnvironment::~BatchEnvironment()
+    {
+        // do nothing here
+    }
+
+    /// Constructor
+    PyEnvironment::PyEnvironment()
+        : mBatchChecked(false)
+        , mBatchSupported(false)
+        , mStepFullChecked(false)
+        , mStepFullSupported(false)
+    {
+    }
+
     /// get the information needed to create an agent suitable for this world
     AgentInitInfo PyEnvironment::get_agent_info(AgentBrainPtr agent)
     {
@@ -58,6 +85,130 @@ namespace OpenNero
         TryOverride("reset", result, agent);
         // ignore result
     }
+
+    /// true iff the Python class defines step_full
+    bool PyEnvironment::supports_step_full() const
+    {
+        if (!mStepFullChecked)
+        {
+            // the overrides are static per instance, so resolve them once
+            mStepFullSupported =
+                this->get_override("step_full").ptr() != Py_None;
+            mStepFullChecked = true;
+        }
+        return mStepFullSupported;
+    }
+
+    /// combined step as one Python call returning (reward, observations,
+    /// done); falls back to the three-call form (and so to the step,
+    /// sense and is_episode_over overrides) when step_full is not defined
+    Reward PyEnvironment::step_full(AgentBrainPtr agent, Actions action,
+                                    Observations& observations, bool& done)
+    {
+        if (!supports_step_full())
+        {
+            return Environment::step_full(agent, action, observations, done);
+        }
+        Reward reward(0);
+        try
+        {
+            python::object res =
+                this->get_override("step_full")(agent, action, observations);
+            reward = python::extract<Reward>(res[0]);
+            observations = python::extract<Observations>(res[1]);
+            done = python::extract<bool>(res[2]);
+        }
+        catch (python::error_already_set const &)
+        {
+            ScriptingEngine::instance().LogError();
+        }
+        return reward;
+    }
+
+    /// true iff the Python class defines the batched stepping methods
+    bool PyEnvironment::supports_batch() const
+    {
+        if (!mBatchChecked)
+        {
+            // the overrides are static per instance, so resolve them once
+            mBatchSupported =
+                this->get_override("is_episode_over_all").ptr() != Py_None &&
+                this->get_override("sense_all").ptr() != Py_None &&
+                this->get_override("step_all").ptr() != Py_None;
+            mBatchChecked = true;
+        }
+        return mBatchSupported;
+    }
+
+    /// check episode termination for every agent in one call
+    void PyEnvironment::is_episode_over_all(const AgentBrainList& agents, std::vector<bool>& over)
+    {
+        try
+        {
+            python::list pyAgents;
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                pyAgents.append(agents[i]);
+            }
+            python::object res = this->get_override("is_episode_over_all")(pyAgents);
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                over[i] = python::extract<bool>(res[i]);
+            }
+        }
+        catch (python::error_already_set const &)
+        {
+            ScriptingEngine::instance().LogError();
+        }
+    }
+
+    /// compute the final observation vector of every agent in one call
+    void PyEnvironment::sense_all(const AgentBrainList& agents, ObservationsList& observations)
+    {
+        try
+        {
+            python::list pyAgents;
+            python::list pyObservations;
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                pyAgents.append(agents[i]);
+                pyObservations.append(observations[i]);
+            }
+            python::object res = this->get_override("sense_all")(pyAgents, pyObservations);
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                observations[i] = python::extract<Observations>(res[i]);
+            }
+        }
+        catch (python::error_already_set const &)
+        {
+            ScriptingEngine::instance().LogError();
+        }
+    }
+
+    /// perform every agent's actions in one call and collect the rewards
+    void PyEnvironment::step_all(const AgentBrainList& agents, const ActionsList& actions, RewardList& rewards)
+    {
+        try
+        {
+            python::list pyAgents;
+            python::list pyActions;
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                pyAgents.append(agents[i]);
+                pyActions.append(actions[i]);
+            }
+            python::object res = this->get_override("step_all")(pyAgents, pyActions);
+            for (size_t i = 0; i < agents.size(); ++i)
+            {
+                rewards[i] = python::extract<Reward>(res[i]);
+            }
+        }
+        catch (python::error_already_set const &)
+        {
+            ScriptingEngine::instance().LogError();
+        }
+    }
 }
 
 
@@ -19,6 +19,15 @@ namespace OpenNero
 	BOOST_PTR_DECL(PyEnvironment);
 	/// @endcond
 
+    /// a list of agent brains handled by one batched environment call
+    typedef std::vector<AgentBrainPtr> AgentBrainList;
+    /// per-agent observation vectors for the batched calls
+    typedef std::vector<Observations> ObservationsList;
+    /// per-agent action vectors for the batched calls
+    typedef std::vector<Actions> ActionsList;
+    /// per-agent rewards for the batched calls
+    typedef std::vector<Reward> RewardList;
+
     /// An abstract interface that represents the simulated world
     /// A world can have objects, (human) players, (embodied) agents and AIs
     class Environment
@@ -42,6 +51,28 @@ namespace OpenNero
         /// @param observations the observations vector already initialized with pre-defined sensor values (added via add_sensor)
         virtual Observations sense(AgentBrainPtr agent, Observations& observations) = 0;
 
+        /// does the environment implement the combined step_full call?
+        virtual bool supports_step_full() const { return false; }
+
+        /// @brief combined single-crossing step: perform the agent's actions,
+        /// then sense and check episode termination in the same call. The
+        /// engine uses this instead of the step/sense/is_episode_over triple
+        /// when supports_step_full says so, cutting the per-agent scripting
+        /// boundary crossings from three to one.
+        /// @param agent the agent acting in the environment
+        /// @param action the actions to perform
+        /// @param observations arrives pre-filled with the built-in sensor
+        ///        values and is overwritten with the observations the agent's
+        ///        next decision acts on
+        /// @param done receives whether the episode ended on this step
+        /// @return the reward for the step
+        virtual Reward step_full(AgentBrainPtr agent, Actions action,
+                                 Observations& observations, bool& done);
+
+        /// can sense/step/act run off the main thread? Environments that
+        /// call into Python must say no (the default)
+        virtual bool threadSafe() const { return false; }
+
         /// cleanup the world on close
         virtual void cleanup() = 0;
 
@@ -49,17 +80,49 @@ namespace OpenNero
         virtual void reset(AgentBrainPtr agent) = 0;
     };
 
+    /**
+     * @brief An optional batched stepping interface for environments.
+     * The simulation normally crosses into a scripted environment several
+     * times per agent per tick through the per-agent Environment methods.
+     * An environment that also implements this interface (and reports
+     * supports_batch) is instead asked about all of its agents in three
+     * calls per tick, which is what keeps large scripted arenas affordable.
+     * The output vectors are pre-sized by the caller to one entry per agent.
+     */
+    class BatchEnvironment
+    {
+    public:
+        /// virtual destructor
+        virtual ~BatchEnvironment();
+
+        /// does the concrete environment actually implement the batched calls?
+        virtual bool supports_batch() const = 0;
+
+        /// check episode termination for every agent in one call; results
+        /// for agents that have not taken their first step yet are ignored
+        virtual void is_episode_over_all(const AgentBrainList& agents, std::vector<bool>& over) = 0;
+
+        /// compute the final observation vector of every agent in one call;
+        /// observations arrives pre-filled with the built-in sensor values
+        virtual void sense_all(const AgentBrainList& agents, ObservationsList& observations) = 0;
+
+        /// perform every agent's actions in one call and collect the rewards
+        virtual void step_all(const AgentBrainList& agents, const ActionsList& actions, RewardList& rewards) = 0;
+    };
+
     /**
      * @brief A concrete wrapper for the Python implementations of the World interface
      * This wrapper is needed because we need a concrete C++ class to be able to call the
      * Python implementation from the C++ side. It simply calls through to its overriding methods.
      * This is only necessary for virtual interfaces overridden from Python.
      */
-    class PyEnvironment : public Environment, public TryWrapper<Environment>
+    class PyEnvironment : public Environment, public BatchEnvironment, public TryWrapper<Environment>
     {
     public:
+        PyEnvironment();
+
         virtual ~PyEnvironment() { }
-    
+
         /// get the information needed to create an agent suitable for this world
         virtual AgentInitInfo get_agent_info(AgentBrainPtr agent);
 
@@ -72,11 +135,39 @@ namespace OpenNero
         /// is the episode over for the specified agent?
         virtual bool is_episode_over(AgentBrainPtr agent);
 
+        /// true iff the Python class defines step_full
+        virtual bool supports_step_full() const;
+
+        /// combined step as one Python call returning (reward,
+        /// observations, done); falls back to the three-call form for
+        /// environments that do not define step_full
+        virtual Reward step_full(AgentBrainPtr agent, Actions action,
+                                 Observations& observations, bool& done);
+
         /// cleanup the world on close
         virtual void cleanup();
 
         /// reset the environment to its initial state
         virtual void reset(AgentBrainPtr agent);
+
+        /// true iff the Python class defines the batched stepping methods
+        virtual bool supports_batch() const;
+
+        /// check episode termination for every agent in one call
+        virtual void is_episode_over_all(const AgentBrainList& agents, std::vector<bool>& over);
+
+        /// compute the final observation vector of every agent in one call
+        virtual void sense_all(const AgentBrainList& agents, ObservationsList& observations);
+
+        /// perform every agent's actions in one call and collect the rewards
+        virtual void step_all(const AgentBrainList& agents, const ActionsList& actions, RewardList& rewards);
+
+    private:
+
+        mutable bool mBatchChecked;   ///< the batch override lookup already ran
+        mutable bool mBatchSupported; ///< the Python class defines the batched methods
+        mutable bool mStepFullChecked;   ///< the step_full override lookup already ran
+        mutable bool mStepFullSupported; ///< the Python class defines step_full
     };
 
 }
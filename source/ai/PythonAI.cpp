@@ -45,7 +45,9 @@ namespace OpenNero
             return false;
         } else {
             brain->SetBody(shared_from_this());
-            setInitInfo(getWorld()->get_agent_info(brain));
+            // identical agents share one cached get_agent_info answer, so
+            // spawning a whole team costs a single Python crossing
+            setInitInfo(AIManager::instance().GetAgentInitInfo(py_agent_expression, brain));
             brain->initialize(getInitInfo());
             return true;
         }
@@ -0,0 +1,236 @@
+#include "core/Common.h"
+#include "ai/TrajectoryLog.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "core/Bitstream.h"
+#include "core/Log.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// magic bytes at the start of every trajectory segment,
+        /// followed by the format version and the float width
+        /// (the Python reader is mods/common/trajectory_log.py)
+        const char kTrajectoryMagic[4] = { 'O', 'N', 'T', 'J' };
+        const uint8_t kTrajectoryVersion = 1;
+        const uint8_t kTrajectoryFloatBytes = 8;
+
+        /// record tag for one agent step
+        const uint8_t kTrajectoryStepTag = 0xB1;
+
+        /// hand a batch to the writer thread once it grows past this size;
+        /// Flush() also runs once per frame so records never sit here stale
+        const uint32_t kBatchFlushBytes = 64 * 1024;
+
+        /// The background writer: batches of packed records arrive on a
+        /// queue and a dedicated thread appends them to the current
+        /// segment, rotating to the next file when the size cap is hit.
+        /// Unlike the telemetry stream, nothing is ever dropped here --
+        /// a training dataset with holes is worthless, so a stalled disk
+        /// backs the queue up instead.
+        struct WriterState
+        {
+            std::mutex mutex;                 ///< guards everything below
+            std::condition_variable wake;     ///< signals the writer thread
+            std::deque<std::string> pending;  ///< batches waiting to be written
+            std::thread writer;               ///< the background writer thread
+            bool running;                     ///< cleared to ask the writer to drain and exit
+
+            std::string prefix;               ///< path prefix of the segments
+            uint64_t rotate_bytes;            ///< segment size cap (0 = single file)
+            uint32_t segment;                 ///< index of the current segment
+
+            WriterState() : running(false), rotate_bytes(0), segment(0) {}
+        };
+
+        WriterState* sWriter = NULL;
+
+        /// guards the record batch below
+        std::mutex sBatchMutex;
+        Bitstream sBatch;
+        bool sEnabled = false;
+
+        /// the file name of a segment: prefix.NNN.trj
+        std::string SegmentName(const std::string& prefix, uint32_t segment)
+        {
+            std::ostringstream name;
+            name << prefix << '.';
+            name.fill('0');
+            name.width(3);
+            name << segment;
+            name << ".trj";
+            return name.str();
+        }
+
+        /// open a segment and write the schema header
+        bool OpenSegment(std::ofstream& file, const std::string& prefix, uint32_t segment)
+        {
+            const std::string name = SegmentName(prefix, segment);
+            file.open(name.c_str(), std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                LOG_F_ERROR("ai", "unable to open trajectory segment: " << name);
+                return false;
+            }
+            file.write(kTrajectoryMagic, sizeof(kTrajectoryMagic));
+            file.put((char)kTrajectoryVersion);
+            file.put((char)kTrajectoryFloatBytes);
+            return true;
+        }
+
+        /// the writer thread: append queued batches to the current
+        /// segment, rotating when the size cap is reached
+        void WriterLoop(WriterState* state)
+        {
+            std::ofstream file;
+            if (!OpenSegment(file, state->prefix, state->segment))
+            {
+                return;
+            }
+            uint64_t written = 0;
+            for (;;)
+            {
+                std::string batch;
+                {
+                    std::unique_lock<std::mutex> guard(state->mutex);
+                    while (state->pending.empty() && state->running)
+                    {
+                        state->wake.wait(guard);
+                    }
+                    if (state->pending.empty())
+                    {
+                        break; // asked to exit and fully drained
+                    }
+                    batch.swap(state->pending.front());
+                    state->pending.pop_front();
+                }
+                if (state->rotate_bytes > 0 && written + batch.size() > state->rotate_bytes)
+                {
+                    file.close();
+                    ++state->segment;
+                    if (!OpenSegment(file, state->prefix, state->segment))
+                    {
+                        return;
+                    }
+                    written = 0;
+                }
+                file.write(batch.data(), (std::streamsize)batch.size());
+                written += batch.size();
+            }
+            file.close();
+        }
+
+        /// hand the accumulated batch to the writer thread
+        /// (the caller holds sBatchMutex)
+        void EnqueueBatch()
+        {
+            if (sBatch.ByteLength() == 0 || !sWriter)
+                return;
+            std::string batch((const char*)sBatch.Stream(), sBatch.ByteLength());
+            sBatch.Clear(); // keeps its capacity; no per-batch allocation
+            {
+                std::lock_guard<std::mutex> guard(sWriter->mutex);
+                sWriter->pending.push_back(std::string());
+                sWriter->pending.back().swap(batch);
+            }
+            sWriter->wake.notify_one();
+        }
+    }
+
+    TrajectoryLog::TrajectoryLog()
+    {
+    }
+
+    TrajectoryLog& TrajectoryLog::instance()
+    {
+        static TrajectoryLog me;
+        return me;
+    }
+
+    /// start recording trajectories
+    bool TrajectoryLog::Enable(const std::string& prefix, uint32_t rotate_megabytes)
+    {
+        Disable(); // close any stream already running
+        std::lock_guard<std::mutex> batch_guard(sBatchMutex);
+        sWriter = new WriterState();
+        sWriter->prefix = prefix;
+        sWriter->rotate_bytes = (uint64_t)rotate_megabytes * 1024 * 1024;
+        sWriter->running = true;
+        sWriter->writer = std::thread(WriterLoop, sWriter);
+        sEnabled = true;
+        LOG_F_MSG("ai", "trajectory log started: " << SegmentName(prefix, 0)
+            << (rotate_megabytes > 0 ? " (rotating)" : ""));
+        return true;
+    }
+
+    /// stop recording, flush everything buffered, and close the file
+    void TrajectoryLog::Disable()
+    {
+        WriterState* writer = NULL;
+        {
+            std::lock_guard<std::mutex> batch_guard(sBatchMutex);
+            if (!sEnabled)
+                return;
+            EnqueueBatch();
+            writer = sWriter;
+            sWriter = NULL;
+            sEnabled = false;
+        }
+        {
+            std::lock_guard<std::mutex> guard(writer->mutex);
+            writer->running = false;
+        }
+        writer->wake.notify_one();
+        writer->writer.join();
+        delete writer;
+        LOG_F_MSG("ai", "trajectory log stopped");
+    }
+
+    /// return true iff trajectories are being recorded
+    bool TrajectoryLog::IsEnabled() const
+    {
+        return sEnabled;
+    }
+
+    /// append one agent step to the trajectory stream
+    void TrajectoryLog::Record(SimId id, size_t episode, size_t step,
+                               const Observations& observations,
+                               const Actions& actions,
+                               const Reward& reward)
+    {
+        std::lock_guard<std::mutex> batch_guard(sBatchMutex);
+        if (!sEnabled)
+            return;
+        sBatch << kTrajectoryStepTag
+               << (uint32_t)id
+               << (uint32_t)episode
+               << (uint32_t)step;
+        sBatch << (uint32_t)observations.size();
+        for (size_t i = 0; i < observations.size(); ++i)
+            sBatch << (float64_t)observations[i];
+        sBatch << (uint32_t)actions.size();
+        for (size_t i = 0; i < actions.size(); ++i)
+            sBatch << (float64_t)actions[i];
+        sBatch << (uint32_t)reward.size();
+        for (size_t i = 0; i < reward.size(); ++i)
+            sBatch << (float64_t)reward[i];
+        if (sBatch.ByteLength() >= kBatchFlushBytes)
+            EnqueueBatch();
+    }
+
+    /// hand whatever this frame buffered to the background writer
+    void TrajectoryLog::Flush()
+    {
+        std::lock_guard<std::mutex> batch_guard(sBatchMutex);
+        if (!sEnabled)
+            return;
+        EnqueueBatch();
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef _OPENNERO_AI_TRAJECTORYLOG_H_
+#define _OPENNERO_AI_TRAJECTORYLOG_H_
+
+#include <string>
+#include "core/Common.h"
+#include "ai/AI.h"
+
+namespace OpenNero
+{
+    /// A binary trajectory exporter for offline analysis and training.
+    /// While enabled, every agent step is appended as one packed record
+    /// of (agent id, episode, step, observations, actions, reward) to a
+    /// rotating set of data files. Records accumulate in a memory batch
+    /// and a background thread owns the file, so the simulation tick
+    /// never waits on disk. The matching Python reader lives in
+    /// mods/common/trajectory_log.py.
+    class TrajectoryLog
+    {
+        // private constructor
+        TrajectoryLog();
+
+    public:
+        /// singleton instance of class
+        static TrajectoryLog& instance();
+
+        /// start recording trajectories
+        /// @param prefix path prefix of the data files; segments are
+        ///        named prefix.000.trj, prefix.001.trj, ...
+        /// @param rotate_megabytes start a new segment once the current
+        ///        one grows past this size (0 keeps a single file)
+        /// @return true iff the first segment could be opened
+        bool Enable(const std::string& prefix, uint32_t rotate_megabytes);
+
+        /// stop recording, flush everything buffered, and close the file
+        void Disable();
+
+        /// return true iff trajectories are being recorded
+        bool IsEnabled() const;
+
+        /// append one agent step to the trajectory stream
+        void Record(SimId id, size_t episode, size_t step,
+                    const Observations& observations,
+                    const Actions& actions,
+                    const Reward& reward);
+
+        /// hand whatever this frame buffered to the background writer
+        void Flush();
+    };
+}
+
+#endif // _OPENNERO_AI_TRAJECTORYLOG_H_
@@ -0,0 +1,294 @@
+#include <cmath>
+#include <algorithm>
+
+#include "core/Common.h"
+#include "math/Random.h"
+#include "ai/AgentBrain.h"
+#include "ai/env/MazeEnvironment.h"
+#include "game/SimEntityData.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// the four moves an agent can make, in action order
+        const S32 kMoves[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+
+        /// action index of the "do nothing" move
+        const S32 kNullMove = 4;
+
+        /// reward for a regular or null move (shorter routes score higher)
+        const double kMoveReward = -1;
+
+        /// reward for walking into a wall or out of bounds
+        const double kWallReward = -100;
+
+        /// reward for reaching the goal corner
+        const double kGoalReward = 100;
+
+        /// union-find over the maze cells for Kruskal's algorithm
+        struct CellSets
+        {
+            std::vector<U32> parent;
+            explicit CellSets(U32 n) : parent(n)
+            {
+                for (U32 i = 0; i < n; ++i)
+                    parent[i] = i;
+            }
+            U32 find(U32 x)
+            {
+                while (parent[x] != x)
+                {
+                    parent[x] = parent[parent[x]]; // path halving
+                    x = parent[x];
+                }
+                return x;
+            }
+            bool join(U32 a, U32 b)
+            {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                    return false;
+                parent[a] = b;
+                return true;
+            }
+        };
+    }
+
+    MazeEnvironment::MazeEnvironment(U32 rows, U32 cols, F32 grid_dx, F32 grid_dy, U32 max_steps)
+        : mRows(rows)
+        , mCols(cols)
+        , mGridDX(grid_dx)
+        , mGridDY(grid_dy)
+        , mMaxSteps(max_steps)
+        , mInitDist(0)
+        , mStartRow(0)
+        , mStartCol(0)
+    {
+        Assert(rows > 0 && cols > 0);
+        Assert(grid_dx > 0 && grid_dy > 0);
+        generate();
+        generate_init_pos();
+
+        // the same blueprint the scripted maze hands out: one discrete
+        // move action, then row, col and four obstacle flags
+        FeatureVectorInfo actions;
+        actions.addDiscrete(0, 4);
+        FeatureVectorInfo sensors;
+        sensors.addDiscrete(0, (int)rows - 1);
+        sensors.addDiscrete(0, (int)cols - 1);
+        for (size_t i = 0; i < 4; ++i)
+            sensors.addDiscrete(0, 1);
+        FeatureVectorInfo reward;
+        reward.addContinuous(kWallReward, kGoalReward);
+        mAgentInfo = AgentInitInfo(sensors, actions, reward);
+
+        LOG_F_MSG("ai", "generated " << rows << "x" << cols << " native maze");
+    }
+
+    MazeEnvironment::~MazeEnvironment()
+    {
+    }
+
+    /// generate the maze walls with randomized Kruskal's algorithm
+    void MazeEnvironment::generate()
+    {
+        // every cell starts fully walled in
+        mWalls.assign(mRows * mCols, 0x0F);
+
+        // all walls between orthogonally adjacent cells, as (cell, move) pairs
+        std::vector< std::pair<U32, U8> > edges;
+        edges.reserve(2 * mRows * mCols);
+        for (U32 r = 0; r < mRows; ++r)
+        {
+            for (U32 c = 0; c < mCols; ++c)
+            {
+                if (r + 1 < mRows)
+                    edges.push_back(std::make_pair(r * mCols + c, (U8)0)); // wall toward +r
+                if (c + 1 < mCols)
+                    edges.push_back(std::make_pair(r * mCols + c, (U8)2)); // wall toward +c
+            }
+        }
+
+        // visit the walls in random order, knocking down the ones that
+        // connect cells not yet reachable from each other
+        for (size_t i = edges.size(); i > 1; --i)
+        {
+            std::swap(edges[i - 1], edges[RANDOM.randI((uint32_t)i)]);
+        }
+        CellSets cells(mRows * mCols);
+        for (size_t i = 0; i < edges.size(); ++i)
+        {
+            const U32 cell = edges[i].first;
+            const U8 move = edges[i].second;
+            const U32 r = cell / mCols, c = cell % mCols;
+            const U32 nr = r + kMoves[move][0], nc = c + kMoves[move][1];
+            if (cells.join(cell, nr * mCols + nc))
+            {
+                walls(r, c) &= ~(U8)(1 << move);
+                walls(nr, nc) &= ~(U8)(1 << (move ^ 1)); // the opposite direction
+            }
+        }
+    }
+
+    /// pick a random start cell on the mInitDist anti-diagonal
+    void MazeEnvironment::generate_init_pos()
+    {
+        S32 r = (S32)mInitDist;
+        S32 c = 0;
+        if (r > (S32)mRows - 1)
+        {
+            r = (S32)mRows - 1;
+            c = (S32)mInitDist - ((S32)mRows - 1);
+        }
+        std::vector< std::pair<S32, S32> > candidates;
+        while (r >= 0 && r <= (S32)mRows - 1 && c >= 0 && c <= (S32)mCols - 1)
+        {
+            candidates.push_back(std::make_pair(r, c));
+            --r;
+            ++c;
+        }
+        Assert(!candidates.empty());
+        const size_t pick = RANDOM.randI((uint32_t)candidates.size());
+        mStartRow = (U32)candidates[pick].first;
+        mStartCol = (U32)candidates[pick].second;
+    }
+
+    /// convert a world position to the containing cell
+    void MazeEnvironment::xy2rc(const Vector3f& pos, S32& r, S32& c) const
+    {
+        r = (S32)floor(pos.X / mGridDX + 0.5) - 1;
+        c = (S32)floor(pos.Y / mGridDY + 0.5) - 1;
+    }
+
+    /// convert a cell to its world position
+    Vector3f MazeEnvironment::rc2xy(U32 r, U32 c) const
+    {
+        return Vector3f((r + 1) * mGridDX, (c + 1) * mGridDY, 0);
+    }
+
+    /// true iff there is a wall between (r,c) and (r+dr,c+dc)
+    bool MazeEnvironment::is_wall(S32 r, S32 c, S32 dr, S32 dc) const
+    {
+        if (r < 0 || c < 0 || r >= (S32)mRows || c >= (S32)mCols)
+            return true;
+        for (S32 move = 0; move < 4; ++move)
+        {
+            if (kMoves[move][0] == dr && kMoves[move][1] == dc)
+                return (mWalls[r * mCols + c] & (1 << move)) != 0;
+        }
+        return true; // not an orthogonal unit move
+    }
+
+    /// get the information needed to create an agent for this maze
+    AgentInitInfo MazeEnvironment::get_agent_info(AgentBrainPtr agent)
+    {
+        return mAgentInfo;
+    }
+
+    /// perform the agent's move and return the reward
+    Reward MazeEnvironment::step(AgentBrainPtr agent, Actions action)
+    {
+        Reward reward = mAgentInfo.reward.getInstance();
+        SimEntityData* state = agent->GetSharedState();
+        S32 r, c;
+        xy2rc(state->GetPosition(), r, c);
+
+        // already at the goal corner?
+        if (r == (S32)mRows - 1 && c == (S32)mCols - 1)
+        {
+            reward[0] = kGoalReward;
+            return reward;
+        }
+        // out of time?
+        if (mMaxSteps != 0 && agent->step >= mMaxSteps - 1)
+        {
+            reward[0] = kMoveReward;
+            return reward;
+        }
+
+        const S32 a = (S32)floor(action[0] + 0.5);
+        if (a < 0 || a >= kNullMove || !mAgentInfo.actions.validate(action))
+        {
+            reward[0] = kMoveReward; // null move
+            return reward;
+        }
+
+        const S32 dr = kMoves[a][0], dc = kMoves[a][1];
+        const S32 new_r = r + dr, new_c = c + dc;
+        if (new_r < 0 || new_c < 0 || new_r >= (S32)mRows || new_c >= (S32)mCols)
+        {
+            reward[0] = kWallReward; // out of bounds
+            return reward;
+        }
+        if (is_wall(r, c, dr, dc))
+        {
+            reward[0] = kWallReward;
+            return reward;
+        }
+
+        // make the move, facing the direction of travel
+        state->SetPosition(rc2xy(new_r, new_c));
+        state->SetRotation(Vector3f(0, 0, (F32)(RAD_2_DEG * atan2((double)dc, (double)dr))));
+
+        if (new_r == (S32)mRows - 1 && new_c == (S32)mCols - 1)
+        {
+            LOG_F_DEBUG("ai", "native maze goal reached");
+            reward[0] = kGoalReward;
+        }
+        else
+        {
+            reward[0] = kMoveReward;
+        }
+        return reward;
+    }
+
+    /// the episode ends at the goal corner or at the step limit
+    bool MazeEnvironment::is_episode_over(AgentBrainPtr agent)
+    {
+        if (mMaxSteps != 0 && agent->step >= mMaxSteps)
+            return true;
+        S32 r, c;
+        xy2rc(agent->GetSharedState()->GetPosition(), r, c);
+        return r == (S32)mRows - 1 && c == (S32)mCols - 1;
+    }
+
+    /// row, col, and the wall flags of the agent's cell
+    Observations MazeEnvironment::sense(AgentBrainPtr agent, Observations& observations)
+    {
+        S32 r, c;
+        xy2rc(agent->GetSharedState()->GetPosition(), r, c);
+        Assert(observations.size() >= 6);
+        observations[0] = r;
+        observations[1] = c;
+        // the wall layout is known here, so obstacle sensing is a mask
+        // lookup instead of the scripted version's four ray casts
+        for (size_t i = 0; i < 4; ++i)
+        {
+            observations[2 + i] = is_wall(r, c, kMoves[i][0], kMoves[i][1]) ? 1 : 0;
+        }
+        return observations;
+    }
+
+    /// cleanup the world on close
+    void MazeEnvironment::cleanup()
+    {
+    }
+
+    /// move the agent back to the episode start cell
+    void MazeEnvironment::reset(AgentBrainPtr agent)
+    {
+        generate_init_pos();
+        SimEntityData* state = agent->GetSharedState();
+        state->SetPosition(rc2xy(mStartRow, mStartCol));
+        state->SetRotation(Vector3f(0, 0, 0));
+    }
+
+    /// regenerate the maze walls (a new random layout)
+    void MazeEnvironment::regenerate()
+    {
+        generate();
+        generate_init_pos();
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef _OPENNERO_AI_ENV_MAZEENVIRONMENT_H_
+#define _OPENNERO_AI_ENV_MAZEENVIRONMENT_H_
+
+#include <vector>
+#include "core/Common.h"
+#include "ai/AI.h"
+#include "ai/Environment.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL(MazeEnvironment);
+    /// @endcond
+
+    /// A native implementation of the discrete maze task from mods/Maze.
+    /// The maze is a rows x cols grid generated with randomized Kruskal's
+    /// algorithm; an agent moves from cell to cell toward the far corner.
+    /// Because the wall layout is known here, sensing is a table lookup
+    /// instead of ray casts, and a step is pure grid math with no
+    /// Boost.Python dispatch -- this is the reference high-throughput
+    /// environment for Q-learning sweeps.
+    ///
+    /// Actions (1 discrete action): 0 move +r, 1 move -r, 2 move +c,
+    /// 3 move -c, 4 do nothing.
+    /// Observations (6 discrete): current row, current col, and one
+    /// obstacle flag per move direction.
+    class MazeEnvironment : public Environment
+    {
+    private:
+        U32 mRows;       ///< rows in the maze
+        U32 mCols;       ///< columns in the maze
+        F32 mGridDX;     ///< x-extent of one cell in world units
+        F32 mGridDY;     ///< y-extent of one cell in world units
+        U32 mMaxSteps;   ///< episode step limit (0 = unlimited)
+        U32 mInitDist;   ///< starting anti-diagonal (0 starts at cell 0,0)
+        U32 mStartRow;   ///< row of the current episode start cell
+        U32 mStartCol;   ///< col of the current episode start cell
+        std::vector<U8> mWalls; ///< per-cell wall bitmask, one bit per move direction
+        AgentInitInfo mAgentInfo; ///< blueprint for agents in this maze
+
+        /// the wall bitmask of a cell
+        U8& walls(U32 r, U32 c) { return mWalls[r * mCols + c]; }
+
+        /// generate the maze walls with randomized Kruskal's algorithm
+        void generate();
+
+        /// pick a random start cell on the mInitDist anti-diagonal
+        void generate_init_pos();
+
+        /// convert a world position to the containing cell
+        void xy2rc(const Vector3f& pos, S32& r, S32& c) const;
+
+        /// convert a cell to its world position
+        Vector3f rc2xy(U32 r, U32 c) const;
+
+    public:
+        /// create a maze task
+        /// @param rows rows in the maze
+        /// @param cols columns in the maze
+        /// @param grid_dx x-extent of one cell in world units
+        /// @param grid_dy y-extent of one cell in world units
+        /// @param max_steps episode step limit (0 = unlimited)
+        MazeEnvironment(U32 rows, U32 cols, F32 grid_dx, F32 grid_dy, U32 max_steps);
+
+        ~MazeEnvironment();
+
+        /// get the information needed to create an agent for this maze
+        AgentInitInfo get_agent_info(AgentBrainPtr agent);
+
+        /// perform the agent's move and return the reward
+        Reward step(AgentBrainPtr agent, Actions action);
+
+        /// the episode ends at the goal corner or at the step limit
+        bool is_episode_over(AgentBrainPtr agent);
+
+        /// row, col, and the wall flags of the agent's cell
+        Observations sense(AgentBrainPtr agent, Observations& observations);
+
+        /// pure grid math; safe to run off the main thread
+        bool threadSafe() const { return true; }
+
+        /// cleanup the world on close
+        void cleanup();
+
+        /// move the agent back to the episode start cell
+        void reset(AgentBrainPtr agent);
+
+        /// regenerate the maze walls (a new random layout)
+        void regenerate();
+
+        /// true iff there is a wall between (r,c) and (r+dr,c+dc)
+        bool is_wall(S32 r, S32 c, S32 dr, S32 dc) const;
+
+        /// set the episode step limit (0 = unlimited)
+        void setMaxSteps(U32 steps) { mMaxSteps = steps; }
+        /// get the episode step limit (0 = unlimited)
+        U32 getMaxSteps() const { return mMaxSteps; }
+
+        /// set the anti-diagonal the start cell is drawn from
+        void setInitDist(U32 dist) { mInitDist = dist; }
+        /// get the anti-diagonal the start cell is drawn from
+        U32 getInitDist() const { return mInitDist; }
+
+        /// rows in the maze
+        U32 getRows() const { return mRows; }
+        /// columns in the maze
+        U32 getCols() const { return mCols; }
+    };
+}
+
+#endif // _OPENNERO_AI_ENV_MAZEENVIRONMENT_H_
@@ -0,0 +1,222 @@
+#include <cmath>
+
+#include "core/Common.h"
+#include "ai/AgentBrain.h"
+#include "ai/env/RoombaEnvironment.h"
+#include "game/SimEntityData.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// distance covered per step, as in mods/Roomba/constants.py
+        const F32 kDefaultSpeed = 1;
+
+        /// vacuuming radius, as in mods/Roomba/constants.py (ROOMBA_RAD)
+        const F32 kDefaultVacuumRadius = 6;
+
+        /// lock an angle in degrees to [-180, 180]
+        double WrapDegrees(double a)
+        {
+            while (a > 180) a -= 360;
+            while (a < -180) a += 360;
+            return a;
+        }
+    }
+
+    RoombaEnvironment::RoombaEnvironment(F32 xdim, F32 ydim, U32 max_steps)
+        : mXDim(xdim)
+        , mYDim(ydim)
+        , mMaxSteps(max_steps)
+        , mSpeed(kDefaultSpeed)
+        , mVacuumRadius(kDefaultVacuumRadius)
+    {
+        Assert(xdim > 0 && ydim > 0);
+
+        // the same blueprint the scripted Roomba hands out: one turn
+        // angle action, then bump, own x/y and the closest crumb's x/y
+        FeatureVectorInfo actions;
+        actions.addContinuous(-M_PI, M_PI);
+        FeatureVectorInfo sensors;
+        sensors.addDiscrete(0, 1);
+        sensors.addContinuous(0, xdim);
+        sensors.addContinuous(0, ydim);
+        sensors.addContinuous(0, xdim);
+        sensors.addContinuous(0, ydim);
+        FeatureVectorInfo reward;
+        reward.addContinuous(-100, 100);
+        mAgentInfo = AgentInitInfo(sensors, actions, reward);
+
+        LOG_F_MSG("ai", "created " << xdim << "x" << ydim << " native roomba room");
+    }
+
+    RoombaEnvironment::~RoombaEnvironment()
+    {
+    }
+
+    /// the remembered state of an agent, created on first use
+    /// (the caller holds mMutex)
+    RoombaEnvironment::AgentState& RoombaEnvironment::agent_state(AgentBrainPtr agent)
+    {
+        const U32 id = (U32)agent->GetSharedState()->GetId();
+        std::map<U32, AgentState>::iterator found = mAgentStates.find(id);
+        if (found == mAgentStates.end())
+        {
+            AgentState& state = mAgentStates[id];
+            state.init_pos = agent->GetSharedState()->GetPosition();
+            state.init_rot = agent->GetSharedState()->GetRotation();
+            return state;
+        }
+        return found->second;
+    }
+
+    /// get the information needed to create an agent for this room
+    AgentInitInfo RoombaEnvironment::get_agent_info(AgentBrainPtr agent)
+    {
+        return mAgentInfo;
+    }
+
+    /// turn, advance, bounce off walls, and vacuum nearby crumbs
+    Reward RoombaEnvironment::step(AgentBrainPtr agent, Actions action)
+    {
+        Reward reward = mAgentInfo.reward.getInstance();
+        std::lock_guard<std::mutex> guard(mMutex);
+        AgentState& state = agent_state(agent);
+
+        SimEntityData* data = agent->GetSharedState();
+        Vector3f pos = data->GetPosition();
+        Vector3f rot = data->GetRotation();
+
+        // the action is the absolute heading to turn toward, in radians
+        rot.Z = (F32)WrapDegrees(RAD_2_DEG * action[0]);
+        const double heading = DEG_2_RAD * rot.Z;
+        const F32 dx = (F32)(mSpeed * cos(heading));
+        const F32 dy = (F32)(mSpeed * sin(heading));
+        pos.X += dx;
+        pos.Y += dy;
+
+        // posteriori collision detection: back out of the wall and
+        // remember the bump for the next sense
+        if (pos.X < 0 || pos.X > mXDim || pos.Y < 0 || pos.Y > mYDim)
+        {
+            if (pos.X < 0 || pos.X > mXDim)
+                pos.X -= 2 * dx;
+            if (pos.Y < 0 || pos.Y > mYDim)
+                pos.Y -= 2 * dy;
+            state.bumped = true;
+        }
+
+        data->SetPosition(pos);
+        data->SetRotation(rot);
+
+        // vacuum every remaining crumb within reach
+        double vacuumed = 0;
+        const F32 radius2 = mVacuumRadius * mVacuumRadius;
+        for (size_t i = 0; i < mCrumbs.size(); ++i)
+        {
+            Crumb& crumb = mCrumbs[i];
+            if (!crumb.active)
+                continue;
+            const F32 cx = crumb.x - pos.X, cy = crumb.y - pos.Y;
+            if (cx * cx + cy * cy < radius2)
+            {
+                crumb.active = false;
+                vacuumed += crumb.reward;
+            }
+        }
+        reward[0] = vacuumed;
+        return reward;
+    }
+
+    /// the episode ends at the step limit
+    bool RoombaEnvironment::is_episode_over(AgentBrainPtr agent)
+    {
+        return mMaxSteps != 0 && agent->step >= mMaxSteps;
+    }
+
+    /// bump flag, own position, and the closest remaining crumb
+    Observations RoombaEnvironment::sense(AgentBrainPtr agent, Observations& observations)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        AgentState& state = agent_state(agent);
+
+        const Vector3f pos = agent->GetSharedState()->GetPosition();
+        Assert(observations.size() >= 5);
+        observations[0] = state.bumped ? 1 : 0;
+        state.bumped = false;
+        observations[1] = pos.X;
+        observations[2] = pos.Y;
+
+        // find the closest crumb still on the floor; no crumbs left
+        // reads as the agent's own position (zero distance to work)
+        F32 best2 = -1;
+        F32 best_x = pos.X, best_y = pos.Y;
+        for (size_t i = 0; i < mCrumbs.size(); ++i)
+        {
+            const Crumb& crumb = mCrumbs[i];
+            if (!crumb.active)
+                continue;
+            const F32 cx = crumb.x - pos.X, cy = crumb.y - pos.Y;
+            const F32 d2 = cx * cx + cy * cy;
+            if (best2 < 0 || d2 < best2)
+            {
+                best2 = d2;
+                best_x = crumb.x;
+                best_y = crumb.y;
+            }
+        }
+        observations[3] = best_x;
+        observations[4] = best_y;
+        return observations;
+    }
+
+    /// cleanup the world on close
+    void RoombaEnvironment::cleanup()
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mAgentStates.clear();
+    }
+
+    /// restore the agent's initial pose and restock the crumbs
+    void RoombaEnvironment::reset(AgentBrainPtr agent)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        AgentState& state = agent_state(agent);
+        SimEntityData* data = agent->GetSharedState();
+        data->SetPosition(state.init_pos);
+        data->SetRotation(state.init_rot);
+        state.bumped = false;
+        for (size_t i = 0; i < mCrumbs.size(); ++i)
+            mCrumbs[i].active = true;
+    }
+
+    /// place a crumb worth the given reward at (x, y)
+    void RoombaEnvironment::add_crumb(F32 x, F32 y, double reward)
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        Crumb crumb;
+        crumb.x = x;
+        crumb.y = y;
+        crumb.reward = reward;
+        crumb.active = true;
+        mCrumbs.push_back(crumb);
+    }
+
+    /// remove all crumbs from the room
+    void RoombaEnvironment::clear_crumbs()
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mCrumbs.clear();
+    }
+
+    /// number of crumbs not yet vacuumed
+    U32 RoombaEnvironment::crumbs_left()
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        U32 count = 0;
+        for (size_t i = 0; i < mCrumbs.size(); ++i)
+            if (mCrumbs[i].active)
+                ++count;
+        return count;
+    }
+}
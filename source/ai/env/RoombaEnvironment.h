@@ -0,0 +1,122 @@
+#ifndef _OPENNERO_AI_ENV_ROOMBAENVIRONMENT_H_
+#define _OPENNERO_AI_ENV_ROOMBAENVIRONMENT_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "core/Common.h"
+#include "ai/AI.h"
+#include "ai/Environment.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL(RoombaEnvironment);
+    /// @endcond
+
+    /// A native implementation of the vacuuming task from mods/Roomba.
+    /// The world is an xdim x ydim rectangle seeded with crumbs through
+    /// add_crumb(); an agent turns by its action angle, advances at a
+    /// constant speed, bounces back off the walls, and vacuums every
+    /// crumb within its radius. The room decoration (markers, furniture)
+    /// stays in Python -- this class is the compute-bound task core, so
+    /// stepping an agent costs no Boost.Python dispatch.
+    ///
+    /// Actions (1 continuous action): amount to turn by in [-pi, pi].
+    /// Observations (5): wall bump flag, self x, self y, and the x and y
+    /// of the closest remaining crumb.
+    class RoombaEnvironment : public Environment
+    {
+    private:
+        /// one thing to vacuum
+        struct Crumb
+        {
+            F32 x;        ///< x position in world units
+            F32 y;        ///< y position in world units
+            double reward; ///< reward for vacuuming this crumb
+            bool active;  ///< false once vacuumed (until the next reset)
+        };
+
+        /// what we remember about each agent between calls
+        struct AgentState
+        {
+            Vector3f init_pos; ///< position to return to on reset
+            Vector3f init_rot; ///< rotation to return to on reset
+            bool bumped;       ///< hit a wall since the last sense
+            AgentState() : bumped(false) {}
+        };
+
+        F32 mXDim;          ///< x-extent of the room in world units
+        F32 mYDim;          ///< y-extent of the room in world units
+        U32 mMaxSteps;      ///< episode step limit (0 = unlimited)
+        F32 mSpeed;         ///< distance covered per step
+        F32 mVacuumRadius;  ///< crumbs closer than this get vacuumed
+        std::vector<Crumb> mCrumbs; ///< everything placed with add_crumb
+        std::map<U32, AgentState> mAgentStates; ///< per-agent state by sim id
+        AgentInitInfo mAgentInfo; ///< blueprint for agents in this room
+
+        /// crumbs and agent states are shared between agents, which may
+        /// step concurrently on the worker pool
+        std::mutex mMutex;
+
+        /// the remembered state of an agent, created on first use
+        /// (the caller holds mMutex)
+        AgentState& agent_state(AgentBrainPtr agent);
+
+    public:
+        /// create a vacuuming task
+        /// @param xdim x-extent of the room in world units
+        /// @param ydim y-extent of the room in world units
+        /// @param max_steps episode step limit (0 = unlimited)
+        RoombaEnvironment(F32 xdim, F32 ydim, U32 max_steps);
+
+        ~RoombaEnvironment();
+
+        /// get the information needed to create an agent for this room
+        AgentInitInfo get_agent_info(AgentBrainPtr agent);
+
+        /// turn, advance, bounce off walls, and vacuum nearby crumbs
+        Reward step(AgentBrainPtr agent, Actions action);
+
+        /// the episode ends at the step limit
+        bool is_episode_over(AgentBrainPtr agent);
+
+        /// bump flag, own position, and the closest remaining crumb
+        Observations sense(AgentBrainPtr agent, Observations& observations);
+
+        /// shared state is mutex-guarded; safe to run off the main thread
+        bool threadSafe() const { return true; }
+
+        /// cleanup the world on close
+        void cleanup();
+
+        /// restore the agent's initial pose and restock the crumbs
+        void reset(AgentBrainPtr agent);
+
+        /// place a crumb worth the given reward at (x, y)
+        void add_crumb(F32 x, F32 y, double reward);
+
+        /// remove all crumbs from the room
+        void clear_crumbs();
+
+        /// number of crumbs not yet vacuumed
+        U32 crumbs_left();
+
+        /// set the distance covered per step
+        void setSpeed(F32 speed) { mSpeed = speed; }
+        /// get the distance covered per step
+        F32 getSpeed() const { return mSpeed; }
+
+        /// set the vacuuming radius
+        void setVacuumRadius(F32 radius) { mVacuumRadius = radius; }
+        /// get the vacuuming radius
+        F32 getVacuumRadius() const { return mVacuumRadius; }
+
+        /// set the episode step limit (0 = unlimited)
+        void setMaxSteps(U32 steps) { mMaxSteps = steps; }
+        /// get the episode step limit (0 = unlimited)
+        U32 getMaxSteps() const { return mMaxSteps; }
+    };
+}
+
+#endif // _OPENNERO_AI_ENV_ROOMBAENVIRONMENT_H_
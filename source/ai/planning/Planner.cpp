@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <limits>
+
+#include "core/Common.h"
+#include "ai/planning/Planner.h"
+
+namespace OpenNero
+{
+    PlanningProblem::PlanningProblem()
+        : mNodesExpanded(0)
+        , mNodesPruned(0)
+    {
+    }
+
+    size_t PlanningProblem::AddVariable( int domainSize )
+    {
+        AssertMsg( domainSize > 0 && domainSize <= 256,
+                   "variable domain size must be between 1 and 256" );
+        mDomainSizes.push_back( static_cast<U8>(domainSize - 1) );
+        mStart.push_back(0);
+        return mDomainSizes.size() - 1;
+    }
+
+    size_t PlanningProblem::AddAction( const std::string& name )
+    {
+        mActions.push_back( Action() );
+        mActions.back().name = name;
+        return mActions.size() - 1;
+    }
+
+    void PlanningProblem::AddPrecondition( size_t action, size_t variable, int value )
+    {
+        Assert( action < mActions.size() && variable < mStart.size() );
+        mActions[action].pre.push_back(
+            Assignment( variable, static_cast<U8>(value) ) );
+    }
+
+    void PlanningProblem::AddEffect( size_t action, size_t variable, int value )
+    {
+        Assert( action < mActions.size() && variable < mStart.size() );
+        mActions[action].eff.push_back(
+            Assignment( variable, static_cast<U8>(value) ) );
+    }
+
+    void PlanningProblem::SetStart( size_t variable, int value )
+    {
+        Assert( variable < mStart.size() );
+        mStart[variable] = static_cast<U8>(value);
+    }
+
+    void PlanningProblem::AddGoal( size_t variable, int value )
+    {
+        Assert( variable < mStart.size() );
+        mGoal.push_back( Assignment( variable, static_cast<U8>(value) ) );
+    }
+
+    const std::string& PlanningProblem::GetPlanAction( size_t i ) const
+    {
+        Assert( i < mPlan.size() );
+        return mActions[ mPlan[i] ].name;
+    }
+
+    bool PlanningProblem::Applicable( const Action& action, const State& state ) const
+    {
+        for( size_t i = 0; i < action.pre.size(); ++i )
+        {
+            if( state[ action.pre[i].first ] != action.pre[i].second )
+                return false;
+        }
+        return true;
+    }
+
+    bool PlanningProblem::Satisfied( const State& state ) const
+    {
+        for( size_t i = 0; i < mGoal.size(); ++i )
+        {
+            if( state[ mGoal[i].first ] != mGoal[i].second )
+                return false;
+        }
+        return true;
+    }
+
+    size_t PlanningProblem::GoalMismatches( const State& state ) const
+    {
+        size_t mismatches = 0;
+        for( size_t i = 0; i < mGoal.size(); ++i )
+        {
+            if( state[ mGoal[i].first ] != mGoal[i].second )
+                ++mismatches;
+        }
+        return mismatches;
+    }
+
+    void PlanningProblem::ExtractPlan( const std::vector<Node>& arena, U32 goalNode )
+    {
+        mPlan.clear();
+        for( S32 i = static_cast<S32>(goalNode); arena[i].action >= 0; i = arena[i].parent )
+        {
+            mPlan.push_back( arena[i].action );
+        }
+        std::reverse( mPlan.begin(), mPlan.end() );
+    }
+
+    /**
+     * Uniform-cost breadth-first search. The arena doubles as the FIFO
+     * frontier: nodes are appended as they are generated and expanded
+     * in arena order, so a plan extracted from the first goal node hit
+     * is shortest. The transposition table maps every reached state to
+     * its arena node and turns the exponential duplicate re-expansion
+     * of tree search into a single hash probe.
+     */
+    bool PlanningProblem::SolveBFS( size_t maxNodes )
+    {
+        mPlan.clear();
+        mNodesExpanded = 0;
+        mNodesPruned = 0;
+
+        std::vector<Node> arena;
+        TranspositionTable seen;
+
+        arena.push_back( Node() );
+        arena.back().state = mStart;
+        arena.back().parent = -1;
+        arena.back().action = -1;
+        seen[mStart] = 0;
+
+        if( Satisfied(mStart) )
+            return true;
+
+        for( size_t head = 0; head < arena.size(); ++head )
+        {
+            if( maxNodes > 0 && mNodesExpanded >= maxNodes )
+                return false;
+            ++mNodesExpanded;
+
+            // arena can reallocate while we expand, so copy the state
+            const State state = arena[head].state;
+            for( size_t a = 0; a < mActions.size(); ++a )
+            {
+                if( !Applicable( mActions[a], state ) )
+                    continue;
+
+                State successor = state;
+                const std::vector<Assignment>& eff = mActions[a].eff;
+                for( size_t e = 0; e < eff.size(); ++e )
+                    successor[ eff[e].first ] = eff[e].second;
+
+                if( seen.find(successor) != seen.end() )
+                {
+                    ++mNodesPruned;
+                    continue;
+                }
+
+                arena.push_back( Node() );
+                arena.back().state = successor;
+                arena.back().parent = static_cast<S32>(head);
+                arena.back().action = static_cast<S32>(a);
+                seen[successor] = static_cast<U32>(arena.size() - 1);
+
+                if( Satisfied(successor) )
+                {
+                    ExtractPlan( arena, static_cast<U32>(arena.size() - 1) );
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * One depth-first probe of an IDA* iteration: follow paths whose
+     * f = depth + heuristic stays within the bound, reporting back the
+     * smallest f that exceeded it to seed the next iteration. The
+     * transposition table remembers the shallowest depth each state was
+     * reached at within this iteration; reaching it again no shallower
+     * cannot improve on the earlier probe and is pruned. The plan is
+     * accumulated in mPlan as the recursion pushes and backtracks.
+     * @return 0 on success, the next bound otherwise (SIZE_MAX if none)
+     */
+    size_t PlanningProblem::DepthFirst( State& state, size_t depth, size_t bound,
+                                        size_t maxNodes, TranspositionTable& visited )
+    {
+        const size_t f = depth + GoalMismatches(state);
+        if( f > bound )
+            return f;
+        if( Satisfied(state) )
+            return 0;
+        if( maxNodes > 0 && mNodesExpanded >= maxNodes )
+            return std::numeric_limits<size_t>::max();
+
+        TranspositionTable::iterator found = visited.find(state);
+        if( found != visited.end() && found->second <= depth )
+        {
+            ++mNodesPruned;
+            return std::numeric_limits<size_t>::max();
+        }
+        visited[state] = static_cast<U32>(depth);
+
+        ++mNodesExpanded;
+        size_t nextBound = std::numeric_limits<size_t>::max();
+
+        for( size_t a = 0; a < mActions.size(); ++a )
+        {
+            if( !Applicable( mActions[a], state ) )
+                continue;
+
+            // apply the effects in place, saving the old values so the
+            // state can be restored on backtrack without a copy
+            const std::vector<Assignment>& eff = mActions[a].eff;
+            std::vector<Assignment> undo;
+            undo.reserve( eff.size() );
+            for( size_t e = 0; e < eff.size(); ++e )
+            {
+                undo.push_back( Assignment( eff[e].first, state[ eff[e].first ] ) );
+                state[ eff[e].first ] = eff[e].second;
+            }
+
+            mPlan.push_back( static_cast<S32>(a) );
+            const size_t result = DepthFirst( state, depth + 1, bound, maxNodes, visited );
+            if( result == 0 )
+                return 0;
+            mPlan.pop_back();
+            if( result < nextBound )
+                nextBound = result;
+
+            for( size_t e = undo.size(); e > 0; --e )
+                state[ undo[e - 1].first ] = undo[e - 1].second;
+        }
+        return nextBound;
+    }
+
+    bool PlanningProblem::SolveIDAStar( size_t maxDepth, size_t maxNodes )
+    {
+        mPlan.clear();
+        mNodesExpanded = 0;
+        mNodesPruned = 0;
+
+        size_t bound = GoalMismatches(mStart);
+        for( ;; )
+        {
+            if( maxDepth > 0 && bound > maxDepth )
+                return false;
+            if( maxNodes > 0 && mNodesExpanded >= maxNodes )
+                return false;
+
+            State state = mStart;
+            TranspositionTable visited;
+            const size_t result = DepthFirst( state, 0, bound, maxNodes, visited );
+            if( result == 0 )
+                return true;
+            if( result == std::numeric_limits<size_t>::max() )
+                return false;
+            bound = result;
+        }
+    }
+
+} // namespace OpenNero
@@ -0,0 +1,151 @@
+//---------------------------------------------------
+// Name: OpenNero : Planner
+// Desc: Native state-space search over scripted
+//       state-transition definitions
+//---------------------------------------------------
+
+#ifndef _OPENNERO_AI_PLANNING_PLANNER_H_
+#define _OPENNERO_AI_PLANNING_PLANNER_H_
+
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+#include "core/Common.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_PTR_DECL(PlanningProblem);
+    /// @endcond
+
+    /**
+     * A grounded planning problem over finite-domain state variables,
+     * searched natively. Scripts (the BlocksTower and TowerofHanoi
+     * planning mods) describe the problem once - variables with their
+     * domain sizes, ground actions as precondition/effect assignment
+     * lists, a start state and a goal - and then call one of the solve
+     * methods. The search itself never calls back into Python: states
+     * are packed value vectors, search nodes live in a contiguous arena
+     * addressed by index, and a hashed transposition table prunes
+     * states that were already reached, so instance sizes that take
+     * minutes in the interpreted planners solve in milliseconds.
+     */
+    class PlanningProblem
+    {
+    public:
+
+        PlanningProblem();
+
+        // ******* Problem definition *******
+
+        /// add a state variable with values 0 .. domainSize-1
+        /// @return the index of the new variable
+        size_t AddVariable( int domainSize );
+
+        /// add a ground action
+        /// @return the index of the new action
+        size_t AddAction( const std::string& name );
+
+        /// the action is applicable only when the variable has this value
+        void AddPrecondition( size_t action, size_t variable, int value );
+
+        /// applying the action assigns this value to the variable
+        void AddEffect( size_t action, size_t variable, int value );
+
+        /// set a variable's value in the start state (defaults to 0)
+        void SetStart( size_t variable, int value );
+
+        /// require a variable to have this value in the goal state
+        void AddGoal( size_t variable, int value );
+
+        // ******* Search *******
+
+        /// breadth-first search to a shortest plan
+        /// @param maxNodes give up after expanding this many nodes (0 for no limit)
+        /// @return true iff a plan was found
+        bool SolveBFS( size_t maxNodes );
+
+        /// iterative-deepening A* with the goal-mismatch-count heuristic
+        /// (admissible whenever no action assigns two goal variables at
+        /// once, as in the tower mods); finds a shortest plan in a
+        /// fraction of the memory BFS needs
+        /// @param maxDepth give up beyond this plan length (0 for no limit)
+        /// @param maxNodes give up after expanding this many nodes (0 for no limit)
+        /// @return true iff a plan was found
+        bool SolveIDAStar( size_t maxDepth, size_t maxNodes );
+
+        // ******* Results *******
+
+        /// number of actions in the plan found by the last solve
+        size_t GetPlanLength() const { return mPlan.size(); }
+
+        /// name of the ith action of the plan found by the last solve
+        const std::string& GetPlanAction( size_t i ) const;
+
+        /// nodes expanded by the last solve
+        size_t GetNodesExpanded() const { return mNodesExpanded; }
+
+        /// states pruned by the transposition table during the last solve
+        size_t GetNodesPruned() const { return mNodesPruned; }
+
+    private:
+
+        /// a state is the packed vector of variable values
+        typedef std::vector<U8> State;
+
+        /// a (variable, value) assignment used for preconditions,
+        /// effects and the goal
+        typedef std::pair<size_t, U8> Assignment;
+
+        /// a ground action: name, preconditions and effects
+        struct Action
+        {
+            std::string name;                   ///< name reported in the plan
+            std::vector<Assignment> pre;        ///< required assignments
+            std::vector<Assignment> eff;        ///< assignments applied
+        };
+
+        /// a search node in the arena: the state it reached and how
+        struct Node
+        {
+            State  state;   ///< state this node reached
+            S32    parent;  ///< arena index of the predecessor (-1 at the root)
+            S32    action;  ///< action that produced this state (-1 at the root)
+        };
+
+        /// hashed transposition table from a state to its arena node
+        typedef boost::unordered_map<State, U32, boost::hash<State> > TranspositionTable;
+
+        /// true iff every precondition of the action holds in the state
+        bool Applicable( const Action& action, const State& state ) const;
+
+        /// true iff every goal assignment holds in the state
+        bool Satisfied( const State& state ) const;
+
+        /// number of goal assignments that do not hold in the state
+        size_t GoalMismatches( const State& state ) const;
+
+        /// walk the parent chain of a goal node into mPlan
+        void ExtractPlan( const std::vector<Node>& arena, U32 goalNode );
+
+        /// depth-first stage of one IDA* iteration
+        /// @return the smallest f-value that exceeded the bound, or 0 on success
+        size_t DepthFirst( State& state, size_t depth, size_t bound,
+                           size_t maxNodes, TranspositionTable& visited );
+
+        std::vector<U8>     mDomainSizes;   ///< domain size per variable
+        std::vector<Action> mActions;       ///< the ground actions
+        State               mStart;         ///< the start state
+        std::vector<Assignment> mGoal;      ///< the goal as a partial assignment
+
+        std::vector<S32>    mPlan;          ///< action indices of the last plan found
+        size_t              mNodesExpanded; ///< nodes expanded by the last solve
+        size_t              mNodesPruned;   ///< transposition-table hits in the last solve
+    };
+
+} // namespace OpenNero
+
+#endif // _OPENNERO_AI_PLANNING_PLANNER_H_
@@ -1,4 +1,6 @@
 #include <boost/serialization/export.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 
 #include "core/Common.h"
 #include "math/Random.h"
@@ -7,12 +9,44 @@
 
 namespace OpenNero
 {
+    namespace
+    {
+        /// initial number of slots in a sparse weight table (power of two)
+        const size_t kSparseInitialCapacity = 64;
+
+        /// eligibility traces smaller than this are dropped during decay
+        const double kMinTrace = 0.01;
+
+        /// scatter a tile index across the table (Knuth multiplicative hash)
+        inline size_t tile_hash(int key)
+        {
+            return static_cast<size_t>(static_cast<U32>(key) * 2654435761u);
+        }
+    }
+
+    /// predict the values of many candidate actions for a shared state
+    /// @param sensors shared observation vector
+    /// @param actions candidate action vectors
+    /// @param out_values resulting value estimates, one per action
+    void Approximator::predictAll(const FeatureVector& sensors,
+                                  const std::vector<FeatureVector>& actions,
+                                  std::vector<double>& out_values)
+    {
+        out_values.resize(actions.size());
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            out_values[i] = predict(sensors, actions[i]);
+        }
+    }
+
     /// @param info information about the agent for which this approximator is to be used
     TableApproximator::TableApproximator(const AgentInitInfo& info, const int actions, const int states) :
         Approximator(info)
         , table()
+        , traces()
         , action_bins(actions)
         , state_bins(states)
+        , writes(0)
     {
     }
 
@@ -20,8 +54,10 @@ namespace OpenNero
     TableApproximator::TableApproximator(const TableApproximator& a) :
         Approximator(a)
         , table(a.table)
+        , traces()
         , action_bins(a.action_bins)
         , state_bins(a.state_bins)
+        , writes(0)
     {
     }
 
@@ -58,6 +94,25 @@ namespace OpenNero
         const FeatureVector& s = quantize_state(observation);
         const FeatureVector& a = quantize_action(action);
         table[StateActionPair(s, a)] = target;
+        ++writes;
+    }
+
+    /// predict the values of many candidate actions, quantizing the state only once
+    /// @param observation shared observation vector
+    /// @param actions candidate action vectors
+    /// @param out_values resulting value estimates, one per action
+    void TableApproximator::predictAll(const FeatureVector& observation,
+                                       const std::vector<FeatureVector>& actions,
+                                       std::vector<double>& out_values)
+    {
+        const FeatureVector& s = quantize_state(observation);
+        out_values.resize(actions.size());
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            const FeatureVector& a = quantize_action(actions[i]);
+            StateActionDoubleMap::iterator found = table.find(StateActionPair(s, a));
+            out_values[i] = (found == table.end()) ? 0 : found->second;
+        }
     }
 
     /// given a feature vector from a continuous space, quantize each component
@@ -110,6 +165,51 @@ namespace OpenNero
         return discrete;
     }
 
+    /// decay all eligibility traces by gamma * lambda, dropping tiny ones
+    void TableApproximator::decay_traces(double decay)
+    {
+        StateActionDoubleMap::iterator iter = traces.begin();
+        while (iter != traces.end())
+        {
+            iter->second *= decay;
+            if (iter->second < kMinTrace)
+            {
+                iter = traces.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+
+    /// mark a state/action pair eligible, either accumulating or replacing
+    void TableApproximator::add_trace(const FeatureVector& observation, const FeatureVector& action, bool replacing)
+    {
+        const FeatureVector& s = quantize_state(observation);
+        const FeatureVector& a = quantize_action(action);
+        double& e = traces[StateActionPair(s, a)];
+        if (replacing)
+        {
+            e = 1.0;
+        }
+        else
+        {
+            e += 1.0;
+        }
+    }
+
+    /// move every traced table entry by alpha_delta weighted by its trace
+    void TableApproximator::apply_trace_update(double alpha_delta)
+    {
+        StateActionDoubleMap::const_iterator iter;
+        for (iter = traces.begin(); iter != traces.end(); ++iter)
+        {
+            table[iter->first] += alpha_delta * iter->second;
+        }
+        ++writes;
+    }
+
     /// quantize a continuous action vector
     FeatureVector TableApproximator::quantize_action(const FeatureVector& action) const
     {
@@ -122,6 +222,80 @@ namespace OpenNero
         return quantize(state, mInfo.sensors, state_bins);
     }
 
+    SparseWeightTable::SparseWeightTable()
+        : keys(kSparseInitialCapacity)
+        , values(kSparseInitialCapacity)
+        , occupied(kSparseInitialCapacity)
+        , count(0)
+    {
+    }
+
+    /// find the slot for a key, or the empty slot where it would go
+    size_t SparseWeightTable::find_slot(int key) const
+    {
+        const size_t mask = keys.size() - 1;
+        size_t slot = tile_hash(key) & mask;
+        while (occupied[slot] && keys[slot] != key)
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    /// double the capacity and rehash all occupied slots
+    void SparseWeightTable::grow()
+    {
+        std::vector<int> old_keys;
+        std::vector<float> old_values;
+        std::vector<U8> old_occupied;
+        old_keys.swap(keys);
+        old_values.swap(values);
+        old_occupied.swap(occupied);
+        keys.resize(old_keys.size() * 2);
+        values.resize(old_values.size() * 2);
+        occupied.resize(old_occupied.size() * 2);
+        for (size_t i = 0; i < old_keys.size(); ++i)
+        {
+            if (old_occupied[i])
+            {
+                size_t slot = find_slot(old_keys[i]);
+                keys[slot] = old_keys[i];
+                values[slot] = old_values[i];
+                occupied[slot] = 1;
+            }
+        }
+    }
+
+    /// @param key tile index to look up
+    /// @return pointer to the stored weight, or NULL for an unvisited tile
+    const float* SparseWeightTable::find(int key) const
+    {
+        size_t slot = find_slot(key);
+        return occupied[slot] ? &values[slot] : NULL;
+    }
+
+    /// @param key tile index to look up
+    /// @param init_value weight to store if this tile has never been visited
+    /// @return reference to the stored weight of the tile
+    float& SparseWeightTable::weight(int key, float init_value)
+    {
+        size_t slot = find_slot(key);
+        if (!occupied[slot])
+        {
+            // keep the load factor below 0.7 so probe chains stay short
+            if (10 * (count + 1) > 7 * keys.size())
+            {
+                grow();
+                slot = find_slot(key);
+            }
+            keys[slot] = key;
+            values[slot] = init_value;
+            occupied[slot] = 1;
+            ++count;
+        }
+        return values[slot];
+    }
+
     /// Create a new tiles approximator based on the agent description provided
     /// @param info agent interface description
     TilesApproximator::TilesApproximator(const AgentInitInfo& info, const int num_tiles, const int num_weights)
@@ -132,7 +306,10 @@ namespace OpenNero
         , ints()
         , floats()
         , tiles()
-        , weights()
+        , num_weights(num_weights)
+        , weights(new SparseWeightTable())
+        , trace()
+        , writes(0)
     {
         LOG_F_DEBUG("ai", "TilesApproximator( "  << info << " )");
         size_t num_sensors = info.sensors.size();
@@ -163,11 +340,8 @@ namespace OpenNero
         ints.resize(ints_index.size());
         floats.resize(floats_index.size());
         tiles.resize(num_tiles);
-        weights.resize(num_weights);
-        for (size_t i = 0; i < weights.size(); ++i)
-        {
-            weights[i] = RANDOM.normalF(0,1);
-        }
+        // weights are allocated lazily as tiles are visited and initialized
+        // randomly on first touch (see TilesApproximator::weight)
     }
 
     TilesApproximator::TilesApproximator(const TilesApproximator& a)
@@ -178,7 +352,12 @@ namespace OpenNero
         , ints(a.ints)
         , floats(a.floats)
         , tiles(a.tiles)
+        , num_weights(a.num_weights)
+        // share the weight table with the source; own_weights() clones it
+        // on the first write, so read-only clones never pay for a copy
         , weights(a.weights)
+        , trace()
+        , writes(0)
     {
     }
 
@@ -186,24 +365,17 @@ namespace OpenNero
     {
     }
 
-    /// convert feature vector into tiles
-    void TilesApproximator::to_tiles(const FeatureVector& observation, const FeatureVector& action)
+    /// shuffle the state portion of a feature vector into the tile arrays
+    void TilesApproximator::state_to_arrays(const FeatureVector& observation)
     {
         size_t num_sensors = mInfo.sensors.size();
-        size_t num_actions = mInfo.actions.size();
         Assert(num_sensors == observation.size());
-        Assert(num_actions == action.size());
-        // shuffle feature vector into the arrays
         for (size_t i = 0; i < ints_index.size(); ++i)
         {
             if (ints_index[i] < num_sensors)
             {
                 ints[i] = (int)observation[ints_index[i]];
             }
-            else
-            {
-                ints[i] = (int)action[ints_index[i] - num_sensors];
-            }
         }
         for (size_t i = 0; i < floats_index.size(); ++i)
         {
@@ -211,28 +383,151 @@ namespace OpenNero
             {
                 floats[i] = (float)observation[floats_index[i]];
             }
-            else
+        }
+    }
+
+    /// shuffle the action portion of a feature vector into the tile arrays
+    void TilesApproximator::action_to_arrays(const FeatureVector& action)
+    {
+        size_t num_sensors = mInfo.sensors.size();
+        Assert(mInfo.actions.size() == action.size());
+        for (size_t i = 0; i < ints_index.size(); ++i)
+        {
+            if (ints_index[i] >= num_sensors)
+            {
+                ints[i] = (int)action[ints_index[i] - num_sensors];
+            }
+        }
+        for (size_t i = 0; i < floats_index.size(); ++i)
+        {
+            if (floats_index[i] >= num_sensors)
             {
                 floats[i] = (float)action[floats_index[i] - num_sensors];
             }
         }
+    }
+
+    /// convert feature vector into tiles
+    void TilesApproximator::to_tiles(const FeatureVector& observation, const FeatureVector& action)
+    {
+        // shuffle feature vector into the arrays
+        state_to_arrays(observation);
+        action_to_arrays(action);
         // convert the input values to tiles
-        GetTiles(tiles, weights.size(), floats, ints);
+        GetTiles(tiles, num_weights, floats, ints);
     }
-    
+
+    /// sum the weights of the currently computed tiles
+    double TilesApproximator::sum_tile_weights()
+    {
+        double result=0.0;
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            // read path: only an unvisited tile, whose random initial
+            // weight has to be stored, forces a private copy of a table
+            // shared with other clones
+            const float* w = weights->find(tiles[i]);
+            result += w ? *w : weight(tiles[i]);
+        }
+        return result;
+    }
+
+    /// look up the weight of a tile, initializing it randomly on first visit
+    float& TilesApproximator::weight(int tile)
+    {
+        ++writes;
+        return own_weights().weight(tile, RANDOM.normalF(0,1));
+    }
+
+    /// get a privately owned weight table, cloning a shared one first
+    SparseWeightTable& TilesApproximator::own_weights()
+    {
+        if (!weights.unique())
+        {
+            weights.reset(new SparseWeightTable(*weights));
+        }
+        return *weights;
+    }
+
     /// @param observation sensor vector
     /// @param action action vector
     double TilesApproximator::predict(const FeatureVector& observation, const FeatureVector& action)
     {
         to_tiles(observation, action);
-        double result=0.0;
-        for (size_t i = 0; i < tiles.size(); ++i) 
+        return sum_tile_weights();
+    }
+
+    /// predict the values of many candidate actions for a shared state,
+    /// converting the state portion to the tile arrays only once
+    /// @param observation shared observation vector
+    /// @param actions candidate action vectors
+    /// @param out_values resulting value estimates, one per action
+    void TilesApproximator::predictAll(const FeatureVector& observation,
+                                       const std::vector<FeatureVector>& actions,
+                                       std::vector<double>& out_values)
+    {
+        state_to_arrays(observation);
+        out_values.resize(actions.size());
+        for (size_t i = 0; i < actions.size(); ++i)
         {
-            result += weights[tiles[i]];
+            action_to_arrays(actions[i]);
+            GetTiles(tiles, num_weights, floats, ints);
+            out_values[i] = sum_tile_weights();
         }
-        return result;
     }
     
+    /// decay all eligibility traces by gamma * lambda, dropping tiny ones
+    void TilesApproximator::decay_traces(double decay)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            float e = trace[i].second * (float)decay;
+            if (e >= kMinTrace)
+            {
+                trace[kept].first = trace[i].first;
+                trace[kept].second = e;
+                ++kept;
+            }
+        }
+        trace.resize(kept);
+    }
+
+    /// mark the tiles of a state/action pair eligible
+    void TilesApproximator::add_trace(const FeatureVector& observation, const FeatureVector& action, bool replacing)
+    {
+        to_tiles(observation, action);
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            size_t j = 0;
+            while (j < trace.size() && trace[j].first != tiles[i])
+            {
+                ++j;
+            }
+            if (j == trace.size())
+            {
+                trace.push_back(std::make_pair(tiles[i], 1.0f));
+            }
+            else if (replacing)
+            {
+                trace[j].second = 1.0f;
+            }
+            else
+            {
+                trace[j].second += 1.0f;
+            }
+        }
+    }
+
+    /// move every traced tile weight by alpha_delta weighted by its trace
+    void TilesApproximator::apply_trace_update(double alpha_delta)
+    {
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            weight(trace[i].first) += (float)(alpha_delta * trace[i].second);
+        }
+    }
+
     /// Adapt the tile weights for the tiles that are triggered by the given example
     /// @param observation sensor vector
     /// @param action action vector
@@ -241,9 +536,9 @@ namespace OpenNero
     {
         double x = predict(observation, action);
         // then, adapt weights towards the prediction
-        for (size_t i = 0; i < tiles.size(); ++i) 
+        for (size_t i = 0; i < tiles.size(); ++i)
         {
-            weights[tiles[i]] += (float)(mAlpha / tiles.size() * (target - x));
+            weight(tiles[i]) += (float)(mAlpha / tiles.size() * (target - x));
         }
     }
 }
@@ -16,72 +16,8 @@
 #include "ai/AI.h"
 #include "core/HashMap.h"
 
-/////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////8
-// serialization/map.hpp:
-// serialization for stl map templates
-
-// (C) Copyright 2002 Robert Ramey - http://www.rrsd.com .
-// Use, modification and distribution is subject to the Boost Software
-// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
-// http://www.boost.org/LICENSE_1_0.txt)
-
-// See http://www.boost.org for updates, documentation, and revision history.
-
-#include <boost/unordered_map.hpp>
-
-#include <boost/config.hpp>
-
-#include <boost/serialization/utility.hpp>
-#include <boost/serialization/collections_save_imp.hpp>
-#include <boost/serialization/collections_load_imp.hpp>
-#include <boost/serialization/split_free.hpp>
-
-namespace boost {
-    namespace serialization {
-
-        template<class Archive, class Type, class Key, class Hash, class Compare, class Allocator >
-            inline void save(
-                             Archive & ar,
-                             const boost::unordered_map<Key, Type, Hash, Compare, Allocator> &t,
-                             const unsigned int /* file_version */
-                             ){
-            boost::serialization::stl::save_collection<
-                Archive,
-                boost::unordered_map<Key, Type, Hash, Compare, Allocator>
-                >(ar, t);
-        }
-
-        template<class Archive, class Type, class Key, class Hash, class Compare, class Allocator >
-            inline void load(
-                             Archive & ar,
-                             boost::unordered_map<Key, Type, Hash, Compare, Allocator> &t,
-                             const unsigned int /* file_version */
-                             ){
-            boost::serialization::stl::load_collection<
-                Archive,
-                boost::unordered_map<Key, Type, Hash, Compare, Allocator>,
-                boost::serialization::stl::archive_input_map<
-                Archive, boost::unordered_map<Key, Type, Hash, Compare, Allocator> >,
-                boost::serialization::stl::no_reserve_imp<boost::unordered_map<
-                Key, Type, Hash, Compare, Allocator
-                >
-                >
-                >(ar, t);
-        }
-
-        // split non-intrusive serialization function member into separate
-        // non intrusive save/load member functions
-        template<class Archive, class Type, class Key, class Hash, class Compare, class Allocator >
-            inline void serialize(
-                                  Archive & ar,
-                                  boost::unordered_map<Key, Type, Hash, Compare, Allocator> &t,
-                                  const unsigned int file_version
-                                  ){
-            boost::serialization::split_free(ar, t, file_version);
-        }
-
-    } // serialization
-} // namespace boost
+// boost::unordered_map serialization is provided by Boost itself these days
+#include <boost/serialization/boost_unordered_map.hpp>
 
 namespace OpenNero
 {
@@ -112,6 +48,34 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         virtual void update(const FeatureVector& sensors, const FeatureVector& actions, double target) = 0;
 
+        /// predict the values of many candidate actions for a shared state,
+        /// filling out_values with one value per action; the default
+        /// implementation just calls predict once per action, but derived
+        /// approximators can factor out the state-dependent work
+        virtual void predictAll(const FeatureVector& sensors,
+                                const std::vector<FeatureVector>& actions,
+                                std::vector<double>& out_values);
+
+        /// true iff this approximator maintains eligibility traces; learners
+        /// fall back to one-step updates when traces are not supported
+        virtual bool supports_traces() const { return false; }
+
+        /// decay all eligibility traces by gamma * lambda, dropping tiny ones
+        virtual void decay_traces(double decay) {}
+
+        /// mark a state/action pair eligible, either accumulating or replacing
+        virtual void add_trace(const FeatureVector& sensors, const FeatureVector& actions, bool replacing) {}
+
+        /// move every traced value by alpha_delta weighted by its trace
+        virtual void apply_trace_update(double alpha_delta) {}
+
+        /// clear all eligibility traces at an episode boundary
+        virtual void reset_traces() {}
+
+        /// monotonic count of writes to the learned state; checkpointing
+        /// code uses it to skip saving brains that have not changed
+        virtual uint64_t change_count() const { return 0; }
+
         /// serialize this object to/from a Boost serialization archive
         template<class Archive>
         void serialize(Archive & ar, const unsigned int version)
@@ -128,11 +92,13 @@ namespace OpenNero
     private:
         friend class boost::serialization::access;
         StateActionDoubleMap table;
+        StateActionDoubleMap traces; ///< eligibility traces for the visited entries (transient)
         int action_bins;
         int state_bins;
+        uint64_t writes; ///< count of updates to the table (transient)
     public:
         /// constructor
-        TableApproximator() {}
+        TableApproximator() : writes(0) {}
         explicit TableApproximator(const AgentInitInfo& info, const int action_bins, const int state_bins);
         explicit TableApproximator(const AgentInitInfo& info)
         {
@@ -157,6 +123,21 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
 
+        /// predict the values of many candidate actions, quantizing the state only once
+        void predictAll(const FeatureVector& sensors,
+                        const std::vector<FeatureVector>& actions,
+                        std::vector<double>& out_values);
+
+        /// eligibility traces over the visited table entries
+        bool supports_traces() const { return true; }
+        void decay_traces(double decay);
+        void add_trace(const FeatureVector& sensors, const FeatureVector& actions, bool replacing);
+        void apply_trace_update(double alpha_delta);
+        void reset_traces() { traces.clear(); }
+
+        /// count of updates to the learned table
+        uint64_t change_count() const { return writes; }
+
         /// quantize continuous state or action vectors
         FeatureVector quantize_action(const FeatureVector& continuous) const;
         FeatureVector quantize_state(const FeatureVector& continuous) const;
@@ -174,6 +155,52 @@ namespace OpenNero
         }
     };
 
+    /// A sparse open-addressing table of tile weights. The tile indices
+    /// produced by GetTiles can range over a huge hash space, but only the
+    /// tiles actually visited get a slot here, so memory tracks visited
+    /// states instead of the full range. Lookups probe linearly from the
+    /// hashed slot, so collisions stay within adjacent cache lines.
+    class SparseWeightTable
+    {
+    private:
+        friend class boost::serialization::access;
+
+        std::vector<int> keys; ///< tile index stored in each slot
+        std::vector<float> values; ///< weight stored in each slot
+        std::vector<U8> occupied; ///< occupancy flag for each slot
+        size_t count; ///< number of occupied slots
+
+        /// find the slot for a key, or the empty slot where it would go
+        size_t find_slot(int key) const;
+
+        /// double the capacity and rehash all occupied slots
+        void grow();
+    public:
+        /// constructor
+        SparseWeightTable();
+
+        /// get a reference to the weight of a tile, inserting init_value
+        /// if this tile has never been visited before
+        float& weight(int key, float init_value);
+
+        /// read-only lookup: the stored weight of a tile, or NULL if this
+        /// tile has never been visited
+        const float* find(int key) const;
+
+        /// number of distinct tiles with a stored weight
+        size_t size() const { return count; }
+
+        /// serialize this object to/from a Boost serialization archive
+        template<class Archive>
+        void serialize(Archive & ar, const unsigned int version)
+        {
+            ar & BOOST_SERIALIZATION_NVP(keys);
+            ar & BOOST_SERIALIZATION_NVP(values);
+            ar & BOOST_SERIALIZATION_NVP(occupied);
+            ar & BOOST_SERIALIZATION_NVP(count);
+        }
+    };
+
     /// A CMAC tile coding function approximator
     class TilesApproximator : public Approximator
     {
@@ -186,13 +213,33 @@ namespace OpenNero
         std::vector<int> ints; ///< integer feature array
         std::vector<float> floats; ///< real feature array
         std::vector<int> tiles; ///< tiles array
-        std::vector<float> weights; ///< weight array
+        int num_weights; ///< size of the tile hash range
+        boost::shared_ptr<SparseWeightTable> weights; ///< weight table, shared copy-on-write between clones
+        std::vector< std::pair<int, float> > trace; ///< sparse eligibility traces over active tiles (transient)
+        uint64_t writes; ///< count of writes to the weight table (transient)
 
         /// convert feature vector into tiles
         void to_tiles(const FeatureVector& sensors, const FeatureVector& actions);
+
+        /// shuffle the state portion of a feature vector into the tile arrays
+        void state_to_arrays(const FeatureVector& sensors);
+
+        /// shuffle the action portion of a feature vector into the tile arrays
+        void action_to_arrays(const FeatureVector& actions);
+
+        /// look up the weight of a tile, initializing it randomly on first visit
+        float& weight(int tile);
+
+        /// get a privately owned weight table, cloning a shared one first
+        /// (copy-on-write: cloned approximators share the table until one
+        /// of them writes to it)
+        SparseWeightTable& own_weights();
+
+        /// sum the weights of the currently computed tiles
+        double sum_tile_weights();
     public:
         /// constructors
-        TilesApproximator() {}
+        TilesApproximator() : writes(0) {}
         explicit TilesApproximator(const AgentInitInfo& info, const int num_tiles, const int num_weights);
         explicit TilesApproximator(const AgentInitInfo& info)
         {
@@ -214,6 +261,22 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
 
+        /// predict the values of many candidate actions, converting the state
+        /// portion of the feature vector to the tile arrays only once
+        void predictAll(const FeatureVector& sensors,
+                        const std::vector<FeatureVector>& actions,
+                        std::vector<double>& out_values);
+
+        /// sparse eligibility traces over the tiles visited this episode
+        bool supports_traces() const { return true; }
+        void decay_traces(double decay);
+        void add_trace(const FeatureVector& sensors, const FeatureVector& actions, bool replacing);
+        void apply_trace_update(double alpha_delta);
+        void reset_traces() { trace.clear(); }
+
+        /// count of writes to the weight table
+        uint64_t change_count() const { return writes; }
+
         /// serialize this object to/from a Boost serialization archive
         template<class Archive>
         void serialize(Archive & ar, const unsigned int version)
@@ -225,7 +288,14 @@ namespace OpenNero
             ar & BOOST_SERIALIZATION_NVP(ints);
             ar & BOOST_SERIALIZATION_NVP(floats);
             ar & BOOST_SERIALIZATION_NVP(tiles);
-            ar & BOOST_SERIALIZATION_NVP(weights);
+            ar & BOOST_SERIALIZATION_NVP(num_weights);
+            // the weight table is shared copy-on-write between clones, so
+            // (de)serialize the table itself and detach on load
+            if (Archive::is_loading::value || !weights)
+            {
+                weights.reset(new SparseWeightTable());
+            }
+            ar & boost::serialization::make_nvp("weights", *weights);
         }
     };
 
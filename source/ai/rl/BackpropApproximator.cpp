@@ -0,0 +1,248 @@
+#include <boost/serialization/export.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+
+#include <cmath>
+
+#include "core/Common.h"
+#include "math/Random.h"
+#include "BackpropApproximator.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// number of sigmoid hidden units
+        const size_t kHiddenUnits = 16;
+
+        /// learning rate for the momentum weight update
+        const float kAlpha = 0.1f;
+
+        /// momentum coefficient for the weight update
+        const float kMomentum = 0.9f;
+
+        /// logistic activation of the hidden units
+        inline float sigmoid(float x)
+        {
+            return 1.0f / (1.0f + expf(-x));
+        }
+    }
+
+    /// @param info information about the agent for which this approximator is to be used
+    BackpropApproximator::BackpropApproximator(const AgentInitInfo& info)
+        : Approximator(info)
+        , num_inputs(info.sensors.size() + info.actions.size())
+        , num_hidden(kHiddenUnits)
+        , mAlpha(kAlpha)
+        , mMomentum(kMomentum)
+        , writes(0)
+    {
+        // small random weights scaled by the fan-in of each unit
+        hidden_weights.resize(num_hidden * (num_inputs + 1));
+        const float hidden_scale = 1.0f / sqrtf((float)(num_inputs + 1));
+        for (size_t i = 0; i < hidden_weights.size(); ++i)
+        {
+            hidden_weights[i] = RANDOM.normalF(0, 1) * hidden_scale;
+        }
+        output_weights.resize(num_hidden + 1);
+        const float output_scale = 1.0f / sqrtf((float)(num_hidden + 1));
+        for (size_t i = 0; i < output_weights.size(); ++i)
+        {
+            output_weights[i] = RANDOM.normalF(0, 1) * output_scale;
+        }
+        init_transient();
+    }
+
+    /// copy constructor
+    BackpropApproximator::BackpropApproximator(const BackpropApproximator& a)
+        : Approximator(a)
+        , num_inputs(a.num_inputs)
+        , num_hidden(a.num_hidden)
+        , mAlpha(a.mAlpha)
+        , mMomentum(a.mMomentum)
+        , hidden_weights(a.hidden_weights)
+        , output_weights(a.output_weights)
+        , writes(0)
+    {
+        init_transient();
+    }
+
+    /// destructor
+    BackpropApproximator::~BackpropApproximator()
+    {
+    }
+
+    /// size the momentum and gradient buffers to match the weights
+    void BackpropApproximator::init_transient()
+    {
+        hidden_velocity.assign(hidden_weights.size(), 0);
+        output_velocity.assign(output_weights.size(), 0);
+        hidden_gradient.assign(hidden_weights.size(), 0);
+        output_gradient.assign(output_weights.size(), 0);
+        single_target.resize(1);
+    }
+
+    /// make sure the minibatch scratch rows can hold count samples
+    void BackpropApproximator::reserve_batch(size_t count)
+    {
+        if (batch_inputs.size() < count * num_inputs)
+        {
+            batch_inputs.resize(count * num_inputs);
+            batch_hidden.resize(count * num_hidden);
+            batch_outputs.resize(count);
+        }
+    }
+
+    /// pack a state/action pair into the given row of batch_inputs
+    void BackpropApproximator::pack_input(size_t row, const FeatureVector& sensors, const FeatureVector& actions)
+    {
+        Assert(sensors.size() + actions.size() == num_inputs);
+        float* x = &batch_inputs[row * num_inputs];
+        for (size_t i = 0; i < sensors.size(); ++i)
+        {
+            x[i] = (float)sensors[i];
+        }
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            x[sensors.size() + i] = (float)actions[i];
+        }
+    }
+
+    /// forward pass over the first count rows of batch_inputs
+    void BackpropApproximator::forward(size_t count)
+    {
+        for (size_t s = 0; s < count; ++s)
+        {
+            const float* x = &batch_inputs[s * num_inputs];
+            float* h = &batch_hidden[s * num_hidden];
+            // hidden layer: one dense dot product per unit over the
+            // contiguous input row (GEMV with the bias folded in)
+            for (size_t j = 0; j < num_hidden; ++j)
+            {
+                const float* w = &hidden_weights[j * (num_inputs + 1)];
+                float sum = w[num_inputs]; // bias
+                for (size_t i = 0; i < num_inputs; ++i)
+                {
+                    sum += w[i] * x[i];
+                }
+                h[j] = sigmoid(sum);
+            }
+            // linear output unit
+            float out = output_weights[num_hidden]; // bias
+            for (size_t j = 0; j < num_hidden; ++j)
+            {
+                out += output_weights[j] * h[j];
+            }
+            batch_outputs[s] = out;
+        }
+    }
+
+    /// backward pass over the first count rows given their targets
+    void BackpropApproximator::backward(size_t count, const std::vector<double>& targets)
+    {
+        Assert(count > 0 && targets.size() >= count);
+        std::fill(hidden_gradient.begin(), hidden_gradient.end(), 0.0f);
+        std::fill(output_gradient.begin(), output_gradient.end(), 0.0f);
+
+        // accumulate the mean-squared-error gradient over the whole batch
+        for (size_t s = 0; s < count; ++s)
+        {
+            const float* x = &batch_inputs[s * num_inputs];
+            const float* h = &batch_hidden[s * num_hidden];
+            const float delta_out = (float)(batch_outputs[s] - targets[s]);
+            for (size_t j = 0; j < num_hidden; ++j)
+            {
+                output_gradient[j] += delta_out * h[j];
+                // backpropagate through the sigmoid of hidden unit j
+                const float delta_h = delta_out * output_weights[j] * h[j] * (1.0f - h[j]);
+                float* g = &hidden_gradient[j * (num_inputs + 1)];
+                for (size_t i = 0; i < num_inputs; ++i)
+                {
+                    g[i] += delta_h * x[i];
+                }
+                g[num_inputs] += delta_h;
+            }
+            output_gradient[num_hidden] += delta_out;
+        }
+
+        // one momentum step per batch over the contiguous weight arrays
+        const float step = mAlpha / (float)count;
+        for (size_t i = 0; i < hidden_weights.size(); ++i)
+        {
+            hidden_velocity[i] = mMomentum * hidden_velocity[i] - step * hidden_gradient[i];
+            hidden_weights[i] += hidden_velocity[i];
+        }
+        for (size_t i = 0; i < output_weights.size(); ++i)
+        {
+            output_velocity[i] = mMomentum * output_velocity[i] - step * output_gradient[i];
+            output_weights[i] += output_velocity[i];
+        }
+        ++writes;
+    }
+
+    /// @param sensors sensor vector
+    /// @param actions action vector
+    double BackpropApproximator::predict(const FeatureVector& sensors, const FeatureVector& actions)
+    {
+        reserve_batch(1);
+        pack_input(0, sensors, actions);
+        forward(1);
+        return batch_outputs[0];
+    }
+
+    /// @param sensors sensor vector
+    /// @param actions action vector
+    /// @param target new value for this state/action pair
+    void BackpropApproximator::update(const FeatureVector& sensors, const FeatureVector& actions, double target)
+    {
+        reserve_batch(1);
+        pack_input(0, sensors, actions);
+        forward(1);
+        single_target[0] = target;
+        backward(1, single_target);
+    }
+
+    /// predict the values of many candidate actions for a shared state
+    /// @param sensors shared observation vector
+    /// @param actions candidate action vectors
+    /// @param out_values resulting value estimates, one per action
+    void BackpropApproximator::predictAll(const FeatureVector& sensors,
+                                          const std::vector<FeatureVector>& actions,
+                                          std::vector<double>& out_values)
+    {
+        reserve_batch(actions.size());
+        for (size_t s = 0; s < actions.size(); ++s)
+        {
+            pack_input(s, sensors, actions[s]);
+        }
+        forward(actions.size());
+        out_values.resize(actions.size());
+        for (size_t s = 0; s < actions.size(); ++s)
+        {
+            out_values[s] = batch_outputs[s];
+        }
+    }
+
+    /// @param sensors observation vectors, one per sample
+    /// @param actions action vectors, one per sample
+    /// @param targets new values, one per sample
+    void BackpropApproximator::update_batch(const std::vector<FeatureVector>& sensors,
+                                            const std::vector<FeatureVector>& actions,
+                                            const std::vector<double>& targets)
+    {
+        Assert(sensors.size() == actions.size() && sensors.size() == targets.size());
+        if (sensors.empty())
+        {
+            return;
+        }
+        reserve_batch(sensors.size());
+        for (size_t s = 0; s < sensors.size(); ++s)
+        {
+            pack_input(s, sensors[s], actions[s]);
+        }
+        forward(sensors.size());
+        backward(sensors.size(), targets);
+    }
+}
+
+BOOST_CLASS_EXPORT(OpenNero::BackpropApproximator)
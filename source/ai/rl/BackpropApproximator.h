@@ -3,17 +3,60 @@
 
 #include "core/Common.h"
 #include "ai/AI.h"
+#include "ai/rl/Approximator.h"
 
 namespace OpenNero
 {
 
-    /// A CMAC tile coding function approximator
+    /// A feed-forward neural network function approximator trained with
+    /// backpropagation. Each layer's weights live in one contiguous
+    /// row-major array and the forward/backward kernels walk whole
+    /// minibatches, so the inner loops are dense GEMV-style code the
+    /// compiler can vectorize instead of per-sample pointer chasing.
     class BackpropApproximator : public Approximator
     {
-            SNetwork network;
+        private:
+            friend class boost::serialization::access;
+
+            size_t num_inputs; ///< number of input features (sensors + actions)
+            size_t num_hidden; ///< number of sigmoid hidden units
+            float mAlpha;      ///< learning rate
+            float mMomentum;   ///< momentum coefficient
+
+            std::vector<float> hidden_weights; ///< num_hidden rows of (num_inputs + 1) weights, bias last
+            std::vector<float> output_weights; ///< (num_hidden + 1) weights of the linear output unit, bias last
+
+            std::vector<float> hidden_velocity; ///< momentum term per hidden weight (transient)
+            std::vector<float> output_velocity; ///< momentum term per output weight (transient)
+            std::vector<float> hidden_gradient; ///< accumulated hidden-layer gradient (transient)
+            std::vector<float> output_gradient; ///< accumulated output-layer gradient (transient)
+            std::vector<float> batch_inputs;    ///< packed minibatch inputs, one row per sample (transient)
+            std::vector<float> batch_hidden;    ///< hidden activations, one row per sample (transient)
+            std::vector<float> batch_outputs;   ///< network outputs, one per sample (transient)
+            std::vector<double> single_target;  ///< one-element target buffer for update() (transient)
+            uint64_t writes; ///< count of weight updates (transient)
+
+            /// size the momentum and gradient buffers to match the weights
+            void init_transient();
+
+            /// make sure the minibatch scratch rows can hold count samples
+            void reserve_batch(size_t count);
+
+            /// pack a state/action pair into the given row of batch_inputs
+            void pack_input(size_t row, const FeatureVector& sensors, const FeatureVector& actions);
+
+            /// forward pass over the first count rows of batch_inputs
+            void forward(size_t count);
+
+            /// backward pass over the first count rows given their targets;
+            /// accumulates the layer gradients across the batch and applies
+            /// them once with momentum
+            void backward(size_t count, const std::vector<double>& targets);
 
         public:
             /// constructor
+            BackpropApproximator()
+                : num_inputs(0), num_hidden(0), mAlpha(0), mMomentum(0), writes(0) {}
             explicit BackpropApproximator(const AgentInitInfo& info);
 
             /// copy constructor
@@ -30,6 +73,38 @@ namespace OpenNero
 
             /// update the value associated with a particular feature vector
             void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
+
+            /// predict the values of many candidate actions in one batched
+            /// forward pass over the packed minibatch rows
+            void predictAll(const FeatureVector& sensors,
+                            const std::vector<FeatureVector>& actions,
+                            std::vector<double>& out_values);
+
+            /// train on a whole minibatch: one batched forward pass, one
+            /// gradient accumulation over the batch, one momentum update
+            void update_batch(const std::vector<FeatureVector>& sensors,
+                              const std::vector<FeatureVector>& actions,
+                              const std::vector<double>& targets);
+
+            /// count of weight updates
+            uint64_t change_count() const { return writes; }
+
+            /// serialize this object to/from a Boost serialization archive
+            template<class Archive>
+            void serialize(Archive & ar, const unsigned int version)
+            {
+                ar & boost::serialization::base_object<Approximator>(*this);
+                ar & BOOST_SERIALIZATION_NVP(num_inputs);
+                ar & BOOST_SERIALIZATION_NVP(num_hidden);
+                ar & BOOST_SERIALIZATION_NVP(mAlpha);
+                ar & BOOST_SERIALIZATION_NVP(mMomentum);
+                ar & BOOST_SERIALIZATION_NVP(hidden_weights);
+                ar & BOOST_SERIALIZATION_NVP(output_weights);
+                if (Archive::is_loading::value)
+                {
+                    init_transient();
+                }
+            }
     };
 }
 
@@ -0,0 +1,116 @@
+#include "core/Common.h"
+#include "math/Random.h"
+#include "ReplayBuffer.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// smallest priority a record can have, so no stored transition
+        /// ever becomes impossible to sample
+        const double kMinPriority = 1e-6;
+
+        /// round up to the next power of two for the sum tree leaves
+        size_t next_power_of_two(size_t n)
+        {
+            size_t p = 1;
+            while (p < n)
+                p <<= 1;
+            return p;
+        }
+    }
+
+    /// @param capacity minimum number of transitions to hold
+    ReplayBuffer::ReplayBuffer(size_t capacity)
+        : mCapacity(next_power_of_two(capacity > 0 ? capacity : 1))
+        , mNext(0)
+        , mSize(0)
+        , mMaxPriority(1.0)
+    {
+        mRecords.resize(mCapacity);
+        mPriorities.assign(2 * mCapacity, 0);
+    }
+
+    /// write a leaf priority and propagate the sums up the tree
+    void ReplayBuffer::update_tree(size_t slot, double priority)
+    {
+        size_t node = mCapacity + slot;
+        mPriorities[node] = priority;
+        for (node >>= 1; node >= 1; node >>= 1)
+        {
+            mPriorities[node] = mPriorities[2 * node] + mPriorities[2 * node + 1];
+        }
+    }
+
+    void ReplayBuffer::add(const Observations& state, const Actions& action,
+                           double reward, const Observations& next_state,
+                           const Actions& next_action, bool terminal)
+    {
+        Experience& record = mRecords[mNext];
+        record.state = state;
+        record.action = action;
+        record.reward = reward;
+        record.next_state = next_state;
+        record.next_action = next_action;
+        record.terminal = terminal;
+        update_tree(mNext, mMaxPriority);
+        mNext = (mNext + 1) % mCapacity;
+        if (mSize < mCapacity)
+        {
+            ++mSize;
+        }
+    }
+
+    /// @return the slot of the sampled record
+    size_t ReplayBuffer::sample_uniform() const
+    {
+        Assert(mSize > 0);
+        return (size_t)RANDOM.randI((uint32_t)mSize);
+    }
+
+    /// @return the slot of the sampled record
+    size_t ReplayBuffer::sample_prioritized() const
+    {
+        Assert(mSize > 0);
+        // walk down the sum tree, descending into the child whose subtree
+        // contains the sampled mass
+        double r = RANDOM.randD(mPriorities[1]);
+        size_t node = 1;
+        while (node < mCapacity)
+        {
+            const double left = mPriorities[2 * node];
+            if (r < left)
+            {
+                node = 2 * node;
+            }
+            else
+            {
+                r -= left;
+                node = 2 * node + 1;
+            }
+        }
+        size_t slot = node - mCapacity;
+        // guard against floating point drift walking past the valid records
+        if (slot >= mSize)
+        {
+            slot = mSize - 1;
+        }
+        return slot;
+    }
+
+    /// @param slot the slot returned by one of the sample methods
+    /// @param priority the new priority (typically |TD error|)
+    void ReplayBuffer::set_priority(size_t slot, double priority)
+    {
+        Assert(slot < mSize);
+        if (priority < kMinPriority)
+        {
+            priority = kMinPriority;
+        }
+        if (priority > mMaxPriority)
+        {
+            mMaxPriority = priority;
+        }
+        update_tree(slot, priority);
+    }
+}
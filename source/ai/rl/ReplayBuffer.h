@@ -0,0 +1,83 @@
+#ifndef _OPENNERO_AI_RL_REPLAYBUFFER_H_
+#define _OPENNERO_AI_RL_REPLAYBUFFER_H_
+
+#include <vector>
+
+#include "core/Common.h"
+#include "ai/AI.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL(ReplayBuffer);
+    /// @endcond
+
+    /// One stored transition: the agent saw state, took action, received
+    /// reward, and ended up in next_state where it chose next_action
+    struct Experience
+    {
+        Observations state;      ///< observation before the action
+        Actions action;          ///< action taken
+        double reward;           ///< reward received for the action
+        Observations next_state; ///< observation after the action
+        Actions next_action;     ///< action chosen in the next state
+        bool terminal;           ///< true iff this was the last step of an episode
+
+        Experience() : reward(0), terminal(false) {}
+    };
+
+    /// A preallocated ring buffer of past transitions for experience
+    /// replay. The oldest record is overwritten once the buffer is full.
+    /// Records can be drawn uniformly or proportionally to a per-record
+    /// priority (typically the last TD error), which is kept in a binary
+    /// sum tree so prioritized draws stay O(log capacity).
+    class ReplayBuffer
+    {
+    private:
+        std::vector<Experience> mRecords; ///< the ring of stored transitions
+        std::vector<double> mPriorities;  ///< binary sum tree; leaves start at mCapacity
+        size_t mCapacity;     ///< number of slots (rounded up to a power of two)
+        size_t mNext;         ///< next slot to overwrite
+        size_t mSize;         ///< number of valid records
+        double mMaxPriority;  ///< priority assigned to freshly added records
+
+        /// write a leaf priority and propagate the sums up the tree
+        void update_tree(size_t slot, double priority);
+    public:
+        /// create a buffer with room for at least capacity transitions
+        explicit ReplayBuffer(size_t capacity);
+
+        /// number of stored transitions
+        size_t size() const { return mSize; }
+
+        /// number of slots in the ring
+        size_t capacity() const { return mCapacity; }
+
+        /// store a transition, overwriting the oldest record when full;
+        /// fresh records get the highest priority seen so far so every
+        /// transition is replayed at least once before decaying
+        void add(const Observations& state, const Actions& action,
+                 double reward, const Observations& next_state,
+                 const Actions& next_action, bool terminal);
+
+        /// draw a record uniformly at random
+        /// @return the slot of the sampled record
+        size_t sample_uniform() const;
+
+        /// draw a record with probability proportional to its priority
+        /// @return the slot of the sampled record
+        size_t sample_prioritized() const;
+
+        /// the record stored in a slot
+        const Experience& get(size_t slot) const
+        {
+            Assert(slot < mSize);
+            return mRecords[slot];
+        }
+
+        /// set the priority of a replayed record (typically |TD error|)
+        void set_priority(size_t slot, double priority);
+    };
+}
+
+#endif // _OPENNERO_AI_RL_REPLAYBUFFER_H_
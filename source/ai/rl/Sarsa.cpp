@@ -35,4 +35,9 @@ namespace OpenNero
     double SarsaBrain::predict(const Observations& new_state) {
     	return mApproximator->predict(new_state, new_action);
     }
+
+    /// value of the stored next state/action pair of a replayed transition
+    double SarsaBrain::replay_predict(const Observations& next_state, const Actions& next_action) {
+    	return mApproximator->predict(next_state, next_action);
+    }
 }
@@ -13,12 +13,15 @@ namespace OpenNero
     /// A SARSA reinforcement learning agent
     class SarsaBrain : public TDBrain
     {
-            double mLambda;                 ///< parameter for the SARSA(lambda) learning algorithm
             double cumulative_reward;       ///< cumulative reward
             size_t n_episodes;              ///< number of episodes
 		protected:
 			// predicts reinforcement for current round
 			virtual double predict(const Observations& new_state);
+
+			/// SARSA is on-policy: replayed targets use the action that was
+			/// actually chosen in the stored successor state
+			virtual double replay_predict(const Observations& next_state, const Actions& next_action);
         public:
             /// constructor
             /// @param gamma reward discount factor (between 0 and 1)
@@ -29,10 +32,11 @@ namespace OpenNero
             /// @param states number of bins for quantizing continuous state space dimensions
             SarsaBrain(double gamma, double alpha, double epsilon, double lambda, int actions, int states, int tiles, int weights)
             : TDBrain(gamma, alpha, epsilon, actions, states, tiles, weights)
-            , mLambda(lambda)
 			, cumulative_reward(0)
 			, n_episodes(0)
-            {}
+            {
+                setLambda(lambda);
+            }
 
             /// constructor
             /// @param gamma reward discount factor (between 0 and 1)
@@ -41,15 +45,15 @@ namespace OpenNero
         	/// @param lambda parameter for the SARSA(lambda) learning algorith
             SarsaBrain(double gamma, double alpha, double epsilon, double lambda)
             : TDBrain(gamma, alpha, epsilon)
-            , mLambda(lambda)
 			, cumulative_reward(0)
 			, n_episodes(0)
-            {}
+            {
+                setLambda(lambda);
+            }
 
             /// copy constructor
             SarsaBrain(const SarsaBrain& agent)
             : TDBrain(agent)
-			, mLambda(agent.mLambda)
 			, cumulative_reward(agent.cumulative_reward)
 			, n_episodes(agent.n_episodes)
 			{}
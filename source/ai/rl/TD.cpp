@@ -1,13 +1,18 @@
 #include <cfloat>
+#include <cmath>
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <fstream>
 
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
 #include <boost/serialization/export.hpp>
 
 #include "core/Common.h"
+#include "core/File.h"
 #include "math/Random.h"
 #include "Approximator.h"
 #include "ai/AI.h"
@@ -40,41 +45,13 @@ namespace OpenNero
                 new TableApproximator(mInfo, action_bins, state_bins));
         }
 
-        // Similar to FeatureVectorInfo::enumerate (from AI.cpp).
-        //
-        // We want to enumerate all possible actions in a discrete way, so that
-        // we can store them in a policy table somehow. So, for each action
-        // dimension, if it's discrete we just enumerate the integral values for
-        // that dimension, and if it's continuous, we split it into "bins"
-        // different values.
-        //
-        // An example: Suppose some action dimension is continuous and spans the
-        // closed interval [-1, 1]. Additionally suppose we want to split
-        // continuous action dimensions into 5 bins. We'd like to preserve the
-        // actual range of action values, but only store the 5 discrete values
-        // that equally partition this space, i.e., {-1, -.5, 0, .5, 1}. So we
-        // traverse the action dimension from -1 to 1 (inclusive), adding
-        // (hi - lo) / (bins - 1) == (1 - -1) / 4 == 0.5 each time.
-        const FeatureVectorInfo& info = init.actions;
-        action_list.clear();
-        action_list.push_back(info.getInstance());
-        for (size_t i = 0; i < info.size(); ++i)
-        {
-            const double lo = info.getMin(i), hi = info.getMax(i);
-            const double inc = info.isDiscrete(i) ? 1.0f : (hi - lo) / (bins - 1);
-            std::vector< Actions > new_action_list;
-            std::vector< Actions >::const_iterator iter;
-            for (iter = action_list.begin(); iter != action_list.end(); ++iter)
-            {
-                for (double a = lo; a <= hi; a += inc)
-                {
-                    FeatureVector v = *iter;
-                    v[i] = a;
-                    new_action_list.push_back(v);
-                }
-            }
-            action_list = new_action_list;
-        }
+        // Enumerate all possible actions in a discrete way so that they
+        // can be stored in a policy table, with continuous dimensions
+        // split into "bins" values. The table is built (and interned)
+        // once per action space: every agent sharing the space sweeps
+        // the same immutable table instead of materializing its own
+        // enumeration.
+        action_list = init.actions.getDiscreteTable(bins);
 
         return true;
     }
@@ -82,6 +59,7 @@ namespace OpenNero
     /// called for agent to take its first step
     Actions TDBrain::start(const TimeType& time, const Observations& new_state)
     {
+        mApproximator->reset_traces();
         epsilon_greedy(new_state);
         action = new_action;
         state = new_state;
@@ -96,7 +74,24 @@ namespace OpenNero
         double new_Q = epsilon_greedy(new_state);
         double old_Q = mApproximator->predict(state, action);
         // Q(s_t, a_t) <- Q(s_t, a_t) + \alpha [r_{t+1} + \gamma Q(s_{t+1}, a_{t+1}) - Q(s_t, a_t)
-        mApproximator->update(state, action, old_Q + mAlpha * (reward[0] + mGamma * new_Q - old_Q));
+        double delta = reward[0] + mGamma * new_Q - old_Q;
+        if (mLambda > 0 && mApproximator->supports_traces())
+        {
+            // TD(lambda): decay the traces, mark (s_t, a_t) eligible, and
+            // propagate the error to every state/action pair still on the trace
+            mApproximator->decay_traces(mGamma * mLambda);
+            mApproximator->add_trace(state, action, mReplacingTraces);
+            mApproximator->apply_trace_update(mAlpha * delta);
+        }
+        else
+        {
+            mApproximator->update(state, action, old_Q + mAlpha * delta);
+        }
+        if (mReplay)
+        {
+            mReplay->add(state, action, reward[0], new_state, new_action, false);
+            replay_updates();
+        }
         action = new_action;
         state = new_state;
         return action;
@@ -109,10 +104,64 @@ namespace OpenNero
 		// Q(s_t, a_t) <- Q(s_t, a_t) + \alpha [r_{t+1} - Q(s_t, a_t)]
         // LOG_F_DEBUG("ai", "TD FINAL UPDATE s1: " << state << ", a1: " << action << ", r: " << reward);
         double old_Q = mApproximator->predict(state, action);
-        mApproximator->update(state, action, old_Q + mAlpha * (reward[0] - old_Q));
+        if (mLambda > 0 && mApproximator->supports_traces())
+        {
+            mApproximator->decay_traces(mGamma * mLambda);
+            mApproximator->add_trace(state, action, mReplacingTraces);
+            mApproximator->apply_trace_update(mAlpha * (reward[0] - old_Q));
+            mApproximator->reset_traces();
+        }
+        else
+        {
+            mApproximator->update(state, action, old_Q + mAlpha * (reward[0] - old_Q));
+        }
+        if (mReplay)
+        {
+            // terminal transition: the successor value never enters the target
+            mReplay->add(state, action, reward[0], state, action, true);
+            replay_updates();
+        }
         return true;
     }
 
+    /// enable experience replay over a preallocated ring of transitions
+    void TDBrain::enableReplay(size_t capacity, U32 updates_per_step, bool prioritized)
+    {
+        mReplay.reset(new ReplayBuffer(capacity));
+        mReplayUpdates = updates_per_step;
+        mPrioritizedReplay = prioritized;
+    }
+
+    /// disable experience replay and free the buffer
+    void TDBrain::disableReplay()
+    {
+        mReplay.reset();
+        mReplayUpdates = 0;
+    }
+
+    /// run the configured number of replayed value updates, turning stored
+    /// transitions into extra learning steps that cost memory reads instead
+    /// of simulation time
+    void TDBrain::replay_updates()
+    {
+        for (U32 k = 0; k < mReplayUpdates; ++k)
+        {
+            const size_t slot = mPrioritizedReplay ?
+                mReplay->sample_prioritized() : mReplay->sample_uniform();
+            const Experience& e = mReplay->get(slot);
+            const double value = e.terminal ? 0 : replay_predict(e.next_state, e.next_action);
+            const double old_Q = mApproximator->predict(e.state, e.action);
+            const double delta = e.reward + mGamma * value - old_Q;
+            // replayed transitions are off the current trajectory, so they
+            // always get one-step updates rather than trace updates
+            mApproximator->update(e.state, e.action, old_Q + mAlpha * delta);
+            if (mPrioritizedReplay)
+            {
+                mReplay->set_priority(slot, fabs(delta));
+            }
+        }
+    }
+
     /// select action according to the epsilon-greedy policy
     double TDBrain::epsilon_greedy(const Observations& new_state)
     {
@@ -123,19 +172,31 @@ namespace OpenNero
             double value = predict(new_state);
             return value;
         }
-        // enumerate all possible actions (actions must be discrete!)
+        // all possible actions, pre-enumerated (actions must be discrete!)
         new_action = mInfo.actions.getInstance();
-        // select the greedy action in random order
-        std::random_shuffle(action_list.begin(), action_list.end());
+        const std::vector< Actions >& actions = *action_list;
+        // sweep the values of all candidate actions in one batch call
+        mApproximator->predictAll(new_state, actions, action_values);
         double max_value = -DBL_MAX;
-        std::vector< Actions >::const_iterator iter;
-        for (iter = action_list.begin(); iter != action_list.end(); ++iter)
+        size_t ties = 0;
+        for (size_t i = 0; i < actions.size(); ++i)
         {
-            double value = mApproximator->predict(new_state, *iter);
-            if (value > max_value)
+            if (action_values[i] > max_value)
+            {
+                max_value = action_values[i];
+                new_action = actions[i];
+                ties = 1;
+            }
+            else if (action_values[i] == max_value)
             {
-                max_value = value;
-                new_action = *iter;
+                // the table is shared and immutable, so instead of
+                // shuffling it, break ties for the maximum by sampling
+                // uniformly among the tied actions
+                ++ties;
+                if (RANDOM.randF() < 1.0f / ties)
+                {
+                    new_action = actions[i];
+                }
             }
         }
         // Assuming if you choose max value, you will want to update with that as your prediction
@@ -168,6 +229,54 @@ namespace OpenNero
             LOG_F_ERROR("ai.rl", "unable to load agent because of error, " << e.what());
         }
     }
+
+    /// write this brain to a binary snapshot file
+    bool TDBrain::save_snapshot(const std::string& filename) const
+    {
+        const uint64_t version = mApproximator ? mApproximator->change_count() : 0;
+        // skip the write when nothing was learned since the last snapshot
+        if (filename == mSnapshotPath && version == mSnapshotVersion && FileExists(filename))
+        {
+            return true;
+        }
+        std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            LOG_F_ERROR("ai.rl", "unable to open snapshot file for writing: " << filename);
+            return false;
+        }
+        try {
+            boost::archive::binary_oarchive oa(file);
+            oa << *this;
+        } catch (boost::archive::archive_exception const& e) {
+            LOG_F_ERROR("ai.rl", "unable to save agent because of error, " << e.what());
+            return false;
+        }
+        mSnapshotPath = filename;
+        mSnapshotVersion = version;
+        return true;
+    }
+
+    /// read this brain back from a binary snapshot file
+    bool TDBrain::load_snapshot(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        if (!file)
+        {
+            LOG_F_ERROR("ai.rl", "unable to open snapshot file for reading: " << filename);
+            return false;
+        }
+        try {
+            boost::archive::binary_iarchive ia(file);
+            ia >> *this;
+        } catch (boost::archive::archive_exception const& e) {
+            LOG_F_ERROR("ai.rl", "unable to load agent because of error, " << e.what());
+            return false;
+        }
+        mSnapshotPath = filename;
+        mSnapshotVersion = mApproximator ? mApproximator->change_count() : 0;
+        return true;
+    }
 }
 
 BOOST_CLASS_EXPORT(OpenNero::TDBrain)
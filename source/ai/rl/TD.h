@@ -8,11 +8,13 @@
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
 #include <boost/serialization/vector.hpp>
 
 #include "core/Common.h"
 #include "ai/AgentBrain.h"
 #include "Approximator.h"
+#include "ReplayBuffer.h"
 
 namespace OpenNero
 {
@@ -30,8 +32,11 @@ namespace OpenNero
         double mGamma;   ///< reward discount factor (between 0 and 1)
         double mAlpha;   ///< learning rate (between 0 and 1)
         double mEpsilon; ///< parameter for the epsilon-greedy policy (between 0 and 1)
+        double mLambda;  ///< eligibility trace decay parameter (0 gives one-step updates)
+        bool mReplacingTraces; ///< replace traces on revisit instead of accumulating them
         AgentInitInfo mInfo; ///< initialization info
-        std::vector< Actions > action_list; ///< list of possible actions
+        FeatureVectorTablePtr action_list; ///< immutable table of possible actions, shared across agents with the same action space
+        std::vector<double> action_values; ///< scratch buffer for batch value predictions
         ApproximatorPtr mApproximator; ///< function approximator we are using
         Actions action;      ///< previous action taken
         Observations state;  ///< previous state
@@ -40,9 +45,23 @@ namespace OpenNero
         int state_bins; ///< number of discrete bins for state space.
         int num_tiles; ///< number of discrete bins for action space.
         int num_weights; ///< number of discrete bins for state space.
+        mutable std::string mSnapshotPath; ///< file the last snapshot was written to (transient)
+        mutable uint64_t mSnapshotVersion; ///< approximator change count at the last snapshot (transient)
+        ReplayBufferPtr mReplay; ///< experience replay store (transient)
+        U32 mReplayUpdates; ///< replayed value updates after each on-policy step
+        bool mPrioritizedReplay; ///< sample replayed transitions by |TD error|
 
     	// predicts reinforcement for current round
     	virtual double predict(const Observations& new_state) = 0;
+
+        /// value of the successor state of a replayed transition; the
+        /// default (the greedy estimate) is right for off-policy learners,
+        /// on-policy learners use the stored next action instead
+        virtual double replay_predict(const Observations& next_state, const Actions& next_action)
+            { return predict(next_state); }
+
+        /// run the configured number of replayed value updates
+        void replay_updates();
     public:
         /// constructor
         /// @param gamma reward discount factor (between 0 and 1)
@@ -55,7 +74,10 @@ namespace OpenNero
         , mGamma(gamma)
         , mAlpha(alpha)
         , mEpsilon(epsilon)
+        , mLambda(0)
+        , mReplacingTraces(true)
         , mInfo()
+        , action_values()
         , mApproximator()
         , action()
         , state()
@@ -64,6 +86,9 @@ namespace OpenNero
         , state_bins(states)
         , num_tiles(tiles)
         , num_weights(weights)
+        , mSnapshotVersion(0)
+        , mReplayUpdates(0)
+        , mPrioritizedReplay(false)
         {}
 
         /// constructor
@@ -75,7 +100,10 @@ namespace OpenNero
         , mGamma(gamma)
         , mAlpha(alpha)
         , mEpsilon(epsilon)
+        , mLambda(0)
+        , mReplacingTraces(true)
         , mInfo()
+        , action_values()
         , mApproximator()
         , action()
         , state()
@@ -84,6 +112,9 @@ namespace OpenNero
         , state_bins(5)
         , num_tiles(0)
         , num_weights(0)
+        , mSnapshotVersion(0)
+        , mReplayUpdates(0)
+        , mPrioritizedReplay(false)
         {}
 
         /// copy constructor
@@ -92,7 +123,11 @@ namespace OpenNero
         , mGamma(agent.mGamma)
         , mAlpha(agent.mAlpha)
         , mEpsilon(agent.mEpsilon)
+        , mLambda(agent.mLambda)
+        , mReplacingTraces(agent.mReplacingTraces)
         , mInfo(agent.mInfo)
+        , action_list(agent.action_list)
+        , action_values()
         , mApproximator(agent.mApproximator->copy())
         , action(agent.action)
         , state(agent.state)
@@ -101,6 +136,10 @@ namespace OpenNero
         , state_bins(agent.state_bins)
         , num_tiles(agent.num_tiles)
         , num_weights(agent.num_weights)
+        , mSnapshotVersion(0)
+        , mReplay(agent.mReplay ? ReplayBufferPtr(new ReplayBuffer(agent.mReplay->capacity())) : ReplayBufferPtr())
+        , mReplayUpdates(agent.mReplayUpdates)
+        , mPrioritizedReplay(agent.mPrioritizedReplay)
         {}
 
         /// destructor
@@ -145,6 +184,31 @@ namespace OpenNero
         /// @return prob. of selecting a random action instead of the greedy one
         double getEpsilon() { return mEpsilon; }
 
+        /// Set the eligibility trace decay parameter
+        /// @param lambda trace decay (between 0 and 1, 0 gives one-step updates)
+        void setLambda(double lambda) { mLambda = lambda; }
+
+        /// Get the eligibility trace decay parameter
+        /// @return trace decay (between 0 and 1)
+        double getLambda() { return mLambda; }
+
+        /// Use replacing traces instead of accumulating traces
+        /// @param replacing true to reset a trace to 1 when a tile is revisited
+        void setReplacingTraces(bool replacing) { mReplacingTraces = replacing; }
+
+        /// Are replacing traces in use?
+        /// @return true iff traces are replaced on revisit
+        bool getReplacingTraces() { return mReplacingTraces; }
+
+        /// Enable experience replay over a preallocated ring of transitions
+        /// @param capacity number of past transitions to retain
+        /// @param updates_per_step replayed value updates after each on-policy step
+        /// @param prioritized sample transitions by |TD error| instead of uniformly
+        void enableReplay(size_t capacity, U32 updates_per_step, bool prioritized);
+
+        /// Disable experience replay and free the buffer
+        void disableReplay();
+
         /// select action according to policy
         double epsilon_greedy(const Observations& new_state);
 
@@ -155,21 +219,60 @@ namespace OpenNero
         std::string to_string() const;
         void from_string(const std::string& s);
 
-        /// serialize this object to/from a Boost serialization archive
+        /// write this brain to a binary snapshot file; the write is skipped
+        /// when the approximator has not changed since the last snapshot to
+        /// the same file
+        /// @return true iff the file is up to date
+        bool save_snapshot(const std::string& filename) const;
+
+        /// read this brain back from a binary snapshot file
+        /// @return true iff the file was read successfully
+        bool load_snapshot(const std::string& filename);
+
+        /// write this object to a Boost serialization archive; the
+        /// enumerated action table is shared between brains, so it is
+        /// written out flat to keep the archive format unchanged
+        template<class Archive>
+        void save(Archive & ar, const unsigned int version) const
+        {
+            ar & BOOST_SERIALIZATION_NVP(mGamma);
+            ar & BOOST_SERIALIZATION_NVP(mAlpha);
+            ar & BOOST_SERIALIZATION_NVP(mEpsilon);
+            ar & BOOST_SERIALIZATION_NVP(mLambda);
+            ar & BOOST_SERIALIZATION_NVP(mReplacingTraces);
+            ar & BOOST_SERIALIZATION_NVP(action_bins);
+            ar & BOOST_SERIALIZATION_NVP(state_bins);
+            ar & BOOST_SERIALIZATION_NVP(num_tiles);
+            ar & BOOST_SERIALIZATION_NVP(num_weights);
+            ar & BOOST_SERIALIZATION_NVP(mInfo);
+            std::vector< Actions > actions(action_list ? *action_list : std::vector< Actions >());
+            ar & boost::serialization::make_nvp("action_list", actions);
+            ar & BOOST_SERIALIZATION_NVP(mApproximator);
+        }
+
+        /// read this object back from a Boost serialization archive,
+        /// re-interning the action table so the restored brain shares it
+        /// with its peers
         template<class Archive>
-        void serialize(Archive & ar, const unsigned int version)
+        void load(Archive & ar, const unsigned int version)
         {
             ar & BOOST_SERIALIZATION_NVP(mGamma);
             ar & BOOST_SERIALIZATION_NVP(mAlpha);
             ar & BOOST_SERIALIZATION_NVP(mEpsilon);
+            ar & BOOST_SERIALIZATION_NVP(mLambda);
+            ar & BOOST_SERIALIZATION_NVP(mReplacingTraces);
             ar & BOOST_SERIALIZATION_NVP(action_bins);
             ar & BOOST_SERIALIZATION_NVP(state_bins);
             ar & BOOST_SERIALIZATION_NVP(num_tiles);
             ar & BOOST_SERIALIZATION_NVP(num_weights);
             ar & BOOST_SERIALIZATION_NVP(mInfo);
-            ar & BOOST_SERIALIZATION_NVP(action_list);
+            std::vector< Actions > actions;
+            ar & boost::serialization::make_nvp("action_list", actions);
+            action_list = mInfo.actions.getDiscreteTable(num_tiles > 0 ? 7 : action_bins);
             ar & BOOST_SERIALIZATION_NVP(mApproximator);
         }
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 } // namespace OpenNero
 
@@ -32,87 +32,92 @@ random integers, of which we use only the low-order bytes.
 /// n mod k
 int mod(int n, int k) {return (n >= 0) ? n%k : k-1-((-n-1)%k);}
 
+namespace
+{
+    /* table of random bytes used by the UNH mixing function; a local
+       static so the one-time initialization is safe even when several
+       threads hash tiles concurrently */
+    struct RandomTable
+    {
+        unsigned int seq[2048];
+        RandomTable()
+        {
+            for (int k = 0; k < 2048; k++)
+            {
+                seq[k] = 0;
+                for (int i = 0; i < (int)sizeof(int); ++i)
+                    seq[k] = (seq[k] << 8) | (rand() & 0xff);
+            }
+        }
+    };
+
+    const unsigned int* random_table()
+    {
+        static RandomTable table;
+        return table.seq;
+    }
+
+    /* mix one coordinate at one position into a table index; the table
+       size is a power of two, so wrapping a (possibly negative) index is
+       an unsigned mask instead of the old %-then-fix-up loop */
+    inline unsigned int mix(int coordinate, int position, int increment)
+    {
+        return (unsigned int)(coordinate + increment * position) & 2047u;
+    }
+}
+
 void GetTiles(
     std::vector<int>& tiles,          ///< provided array contains returned tiles (tile indices)
     int memory_size,                  ///< total number of possible tiles
     const std::vector<float>& floats, ///< array of floating point variables
     const std::vector<int>& ints)     ///< array of integer variables
 {
-    int i,j;
+    const unsigned int* rndseq = random_table();
+    const int num_tilings = (int)tiles.size();
+    const int num_floats = (int)floats.size();
     int qstate[MAX_NUM_VARS];
-    int base[MAX_NUM_VARS];
-    std::vector<int> coordinates;
-    coordinates.resize(floats.size() + ints.size() + 1);
-
-    for (int i=0; i<ints.size(); i++)
-        coordinates[floats.size()+1+i] = ints[i];
 
     /* quantize state to integers (henceforth, tile widths == tiles.size()) */
-    for (i = 0; i < floats.size(); i++)
-    {
-        qstate[i] = (int) floor(floats[i] * tiles.size());
-        base[i] = 0;
-    }
+    for (int i = 0; i < num_floats; i++)
+        qstate[i] = (int) floor(floats[i] * num_tilings);
+
+    /* the integer variables and their coordinate positions are the same
+       in every tiling, so their part of the hash sum is mixed once */
+    unsigned long ints_sum = 0;
+    for (int i = 0; i < (int)ints.size(); i++)
+        ints_sum += rndseq[mix(ints[i], num_floats + 1 + i, 449)];
 
     /*compute the tile numbers */
-    for (j = 0; j < tiles.size(); j++)
+    for (int j = 0; j < num_tilings; j++)
     {
-
-        /* loop over each relevant dimension */
-        for (i = 0; i < floats.size(); i++)
+        /* the tiling index hashes into the position after the floats so
+           the tilings land in different parts of the table */
+        unsigned long sum = ints_sum + rndseq[mix(j, num_floats, 449)];
+
+        /* the old per-tiling displacement base accumulated to j*(1+2i),
+           so the coordinate of the activated tile depends only on (i,j)
+           and the loop carries no state between iterations */
+        for (int i = 0; i < num_floats; i++)
         {
-
-            /* find coordinates of activated tile in tiling space */
-            coordinates[i] = qstate[i] - mod(qstate[i]-base[i], tiles.size());
-
-            /* compute displacement of next tiling in quantized space */
-            base[i] += 1 + (2 * i);
+            int coordinate = qstate[i] - mod(qstate[i] - j * (1 + 2 * i), num_tilings);
+            sum += rndseq[mix(coordinate, i, 449)];
         }
-        /* add additional indices for tiling and hashing_set so they hash differently */
-        coordinates[i] = j;
-
-        tiles[j] = hash_UNH(coordinates, memory_size, 449);
+        tiles[j] = (int)(sum % (unsigned long)memory_size);
     }
     return;
 }
 
 
-/// Takes an array of integers and returns the corresponding tile after hashing 
+/// Takes an array of integers and returns the corresponding tile after hashing
 int hash_UNH(const std::vector<int>& ints, long m, int increment)
 {
-    static unsigned int rndseq[2048];
-    static int first_call =  1;
-    int i,k;
-    long index;
-    long sum = 0;
+    const unsigned int* rndseq = random_table();
+    unsigned long sum = 0;
 
-    /* if first call to hashing, initialize table of random numbers */
-    if (first_call)
+    for (int i = 0; i < (int)ints.size(); i++)
     {
-        for (k = 0; k < 2048; k++)
-        {
-            rndseq[k] = 0;
-            for (i=0; i < (int)sizeof(int); ++i)
-                rndseq[k] = (rndseq[k] << 8) | (rand() & 0xff);
-        }
-        first_call = 0;
-    }
-
-    for (i = 0; i < ints.size(); i++)
-    {
-        /* add random table offset for this dimension and wrap around */
-        index = ints[i];
-        index += (increment * i);
-        index %= 2048;
-        while (index < 0)
-            index += 2048;
-
-        /* add selected random number to sum */
-        sum += (long)rndseq[(int)index];
+        /* add the random table entry for this coordinate to the sum */
+        sum += (unsigned long)rndseq[mix(ints[i], i, increment)];
     }
-    index = (int)(sum % m);
-    while (index < 0)
-        index += m;
-
-    return(index);
+    return (int)(sum % (unsigned long)m);
 }
@@ -9,9 +9,8 @@ namespace OpenNero {
     ScoreHelper::ScoreHelper(const RewardInfo& reward_info)
         : m_SampleSize(0)
         , m_Zero(reward_info.getInstance())
-        , m_Total(m_Zero)
-        , m_SumOfSquares(m_Zero)
         , m_Average(m_Zero)
+        , m_M2(m_Zero)
         , m_StandardDeviation(m_Zero)
         , m_Min(m_Zero)
         , m_Max(m_Zero)
@@ -23,6 +22,11 @@ namespace OpenNero {
         }
     }
     
+    ScoreHelper::ScoreHelper()
+        : m_SampleSize(0)
+    {
+    }
+
     ScoreHelper::~ScoreHelper()
     {
     }
@@ -30,10 +34,9 @@ namespace OpenNero {
     void ScoreHelper::reset()
     {
         m_SampleSize = 0;
-        m_Total = m_Zero;
-        m_SumOfSquares = m_Zero;
         m_Average = m_Zero;
-        m_StandardDeviation = m_Zero;    
+        m_M2 = m_Zero;
+        m_StandardDeviation = m_Zero;
         for (size_t i = 0; i < m_Min.size(); ++i)
         {
             m_Min[i] = FLT_MAX;
@@ -49,38 +52,84 @@ namespace OpenNero {
     
     void ScoreHelper::calculateAverages()
     {
-        if (m_SampleSize > 0) {
-            m_Average = m_Total / (double)m_SampleSize;
-        } else {
+        // the running mean is maintained by addSample; nothing to recompute
+        if (m_SampleSize == 0) {
             m_Average = m_Zero;
         }
     }
-    
+
     void ScoreHelper::calculateStandardDeviations()
     {
         if (m_SampleSize > 0) {
             for (size_t i = 0; i < m_StandardDeviation.size(); ++i) {
-                m_StandardDeviation[i] = sqrt( m_SumOfSquares[i] / m_SampleSize - m_Average[i] * m_Average[i]);
+                m_StandardDeviation[i] = sqrt( m_M2[i] / m_SampleSize );
             }
         } else {
             m_StandardDeviation = m_Zero;
         }
     }
-    
-    /// add a reward sample
+
+    /// add a reward sample, streaming the mean and the squared deviations
+    /// (Welford's update, which is O(1) per sample and does not suffer the
+    /// cancellation of the sum-of-squares formula)
     void ScoreHelper::addSample(Reward sample)
     {
-        m_Total += sample;
+        // an unsized helper adopts the dimensionality of its first sample
+        if (m_Zero.size() == 0 && sample.size() > 0)
+        {
+            m_Zero.resize(sample.size());
+            m_Average = m_Zero;
+            m_M2 = m_Zero;
+            m_StandardDeviation = m_Zero;
+            m_Min = m_Zero;
+            m_Max = m_Zero;
+            for (size_t i = 0; i < m_Min.size(); ++i)
+            {
+                m_Min[i] = FLT_MAX;
+                m_Max[i] = -FLT_MAX;
+            }
+        }
+        ++m_SampleSize;
         for (size_t i = 0; i < sample.size(); ++i)
         {
-            m_SumOfSquares[i] += (sample[i] * sample[i]);
+            const double delta = sample[i] - m_Average[i];
+            m_Average[i] += delta / m_SampleSize;
+            m_M2[i] += delta * (sample[i] - m_Average[i]);
             if (m_Min[i] > sample[i])
                 m_Min[i] = sample[i];
             if (m_Max[i] < sample[i])
                 m_Max[i] = sample[i];
         }
-        
-        ++m_SampleSize;
+    }
+
+    /// fold another helper's samples into this one (Chan et al.'s
+    /// parallel variant of the Welford update: the merged mean and M2
+    /// are exact, not a re-accumulation, so team summaries cost one
+    /// merge per agent per window instead of one update per step)
+    void ScoreHelper::merge(const ScoreHelper& other)
+    {
+        if (other.m_SampleSize == 0)
+            return;
+        if (m_SampleSize == 0)
+        {
+            *this = other;
+            return;
+        }
+        AssertMsg(m_Zero.size() == other.m_Zero.size(),
+                  "cannot merge score helpers of different dimensionality");
+        const size_t total = m_SampleSize + other.m_SampleSize;
+        for (size_t i = 0; i < m_Average.size(); ++i)
+        {
+            const double delta = other.m_Average[i] - m_Average[i];
+            m_Average[i] += delta * other.m_SampleSize / total;
+            m_M2[i] += other.m_M2[i] +
+                delta * delta * m_SampleSize * other.m_SampleSize / total;
+            if (m_Min[i] > other.m_Min[i])
+                m_Min[i] = other.m_Min[i];
+            if (m_Max[i] < other.m_Max[i])
+                m_Max[i] = other.m_Max[i];
+        }
+        m_SampleSize = total;
     }
 
     /// preferred generic method
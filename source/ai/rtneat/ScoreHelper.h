@@ -15,16 +15,21 @@ namespace OpenNero
 
         size_t m_SampleSize;
         Reward m_Zero;
-        Reward m_Total;
-        Reward m_SumOfSquares;
         Reward m_Average;
+        Reward m_M2; ///< running sum of squared deviations from the mean (Welford)
         Reward m_StandardDeviation;
         Reward m_Min;
         Reward m_Max;
 
     public:
-    
+
         ScoreHelper(const RewardInfo& zero);
+
+        /// construct an unsized helper that adopts the dimensionality of
+        /// its first sample (used by the telemetry aggregation windows,
+        /// which see the reward vector before any RewardInfo)
+        ScoreHelper();
+
         ~ScoreHelper();
 
         void reset();
@@ -35,6 +40,11 @@ namespace OpenNero
         /// add a reward sample
         void addSample(Reward sample);
 
+        /// fold another helper's samples into this one as if its samples
+        /// had been added here (parallel Welford merge); used to build
+        /// per-team summaries out of per-agent aggregation windows
+        void merge(const ScoreHelper& other);
+
         /// average scores in all dimensions
         const Reward& getAverage() const { return m_Average; }
         
@@ -1,528 +1,1103 @@
-#include "core/Common.h"
-#include "game/SimEntity.h"
-#include "game/SimContext.h"
-#include "game/Kernel.h"
-#include "ai/AIObject.h"
-#include "ai/AgentBrain.h"
-#include "ai/rtneat/rtNEAT.h"
-#include "rtneat/population.h"
-#include "rtneat/network.h"
-#include "scripting/scriptIncludes.h"
-#include "math/Random.h"
-#include <ostream>
-#include <fstream>
-
-namespace OpenNero
-{
-
-    /// @cond
-    BOOST_SHARED_DECL(SimEntity);
-    /// @endcond
-
-    const F32 FRACTION_POPULATION_INELIGIBLE_ALLOWED = 0.5;
-
-    using namespace NEAT;
-
-    namespace {
-        const size_t kNumSpeciesTarget = 5; ///< target number of species in the population
-        const double kCompatMod = 0.1; ///< compatibility threshold modifier
-        const double kMinCompatThreshold = 0.3; // minimum species compatibility threshold
-
-        /// compare two organisms by fitness
-        bool fitness_less(OrganismPtr a, OrganismPtr b)
-        {
-            return a->fitness < b->fitness;
-        }
-    }
-
-    /// Constructor
-    /// @param filename name of the file with the initial population genomes
-    /// @param param_file file with RTNEAT parameters to load
-    /// @param population_size size of the population to construct
-    /// @param reward_info the specifications for the multidimensional reward
-    /// @param generational if true then run generational NEAT; otherwise run realtime NEAT
-    RTNEAT::RTNEAT(const std::string& filename,
-                   const std::string& param_file,
-                   size_t population_size,
-                   const RewardInfo& reward_info,
-                   bool generational)
-        : mPopulation()
-        , mWaitingBrainList()
-        , mBrainList()
-        , mBrainBodyMap()
-        , mOffspringCount(population_size)
-        , mSpawnTickCount(0)
-        , mEvolutionTickCount(0)
-        , mTotalUnitsDeleted(0)
-        , mUnitsToDeleteBeforeFirstJudgment(population_size)
-        , mTimeBetweenEvolutions(NEAT::time_alive_minimum)
-        , mRewardInfo(reward_info)
-        , mFitnessWeights(reward_info.size())
-        , mEvolutionEnabled(true)
-        , mChampionId(-1)
-        , mGenerational(generational)
-    {
-        NEAT::load_neat_params(Kernel::findResource(param_file));
-        NEAT::pop_size = population_size;
-        std::string pop_fname = Kernel::findResource(filename);
-        mPopulation.reset(new Population(pop_fname, population_size));
-        AssertMsg(mPopulation, "initial population creation failed");
-        mOffspringCount = mPopulation->organisms.size();
-        AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
-        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
-        {
-            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
-            mWaitingBrainList.push(brain);
-            mBrainList.push_back(brain);
-        }
-    }
-
-    /// Constructor
-    /// @param param_file RTNEAT parameter file
-    /// @param inputs number of inputs
-    /// @param outputs number of outputs
-    /// @param population_size size of the population to construct
-    /// @param noise variance of the Gaussian used to assign initial weights
-    /// @param reward_info the specifications for the multidimensional reward
-    /// @param generational if true then run generational NEAT; otherwise run realtime NEAT
-    RTNEAT::RTNEAT(const std::string& param_file,
-                   size_t inputs,
-                   size_t outputs,
-                   size_t population_size,
-                   F32 noise,
-                   const RewardInfo& reward_info,
-                   bool generational)
-        : mPopulation()
-        , mWaitingBrainList()
-        , mBrainList()
-        , mBrainBodyMap()
-        , mOffspringCount(0)
-        , mSpawnTickCount(0)
-        , mEvolutionTickCount(0)
-        , mTotalUnitsDeleted(0)
-        , mUnitsToDeleteBeforeFirstJudgment(population_size)
-        , mTimeBetweenEvolutions(NEAT::time_alive_minimum)
-        , mRewardInfo(reward_info)
-        , mFitnessWeights(reward_info.size())
-        , mEvolutionEnabled(true)
-        , mGenerational(generational)
-    {
-        NEAT::load_neat_params(Kernel::findResource(param_file));
-        NEAT::pop_size = population_size;
-        GenomePtr genome(new Genome(inputs, outputs, 0, 0));
-        mPopulation.reset(new Population(genome, population_size, noise));
-        AssertMsg(mPopulation, "initial population creation failed");
-        mOffspringCount = mPopulation->organisms.size();
-        AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
-        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
-        {
-            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
-            mWaitingBrainList.push(brain);
-            mBrainList.push_back(brain);
-        }
-    }
-
-    /// Destructor
-    RTNEAT::~RTNEAT()
-    {
-    }
-
-
-    /// load sensor values into the network
-    void PyNetwork::load_sensors(py::list l)
-    {
-        std::vector<double> sensors;
-        for (py::ssize_t i = 0; i < py::len(l); ++i)
-            {
-                sensors.push_back(py::extract<double>(l[i]));
-            }
-        mNetwork->load_sensors(sensors);
-    }
-
-    /// load error values into the network
-    void PyNetwork::load_errors(py::list l)
-    {
-        std::vector<double> errors;
-        for (py::ssize_t i = 0; i < py::len(l); ++i)
-            {
-                errors.push_back(py::extract<double>(l[i]));
-            }
-        mNetwork->load_errors(errors);
-    }
-
-    /// get output values from the network
-    py::list PyNetwork::get_outputs()
-    {
-        py::list l;
-        std::vector<NNodePtr>::const_iterator iter;
-        for (iter = mNetwork->outputs.begin(); iter != mNetwork->outputs.end(); ++iter)
-            {
-                l.append((*iter)->get_active_out());
-            }
-        return l;
-    }
-
-    std::ostream& operator<<(std::ostream& output, const PyNetwork& net)
-    {
-        output << net.mNetwork;
-        return output;
-    }
-
-    std::ostream& operator<<(std::ostream& output, const PyOrganism& org)
-    {
-        output << org.mOrganism;
-        return output;
-    }
-
-    /// load the population from a file
-    bool RTNEAT::load_population(const std::string& pop_file)
-    {
-        std::string fname = Kernel::findResource(pop_file, false);
-        mPopulation.reset(new Population(fname));
-        return true;
-    }
-
-    /// are we ready to spawn a new organism?
-    bool RTNEAT::ready()
-    {
-        return !mWaitingBrainList.empty();
-    }
-
-    /// have we been deleted?
-    bool RTNEAT::has_organism(AgentBrainPtr agent)
-    {
-        BrainBodyMap::left_map::const_iterator found;
-        found = mBrainBodyMap.left.find(agent->GetBody());
-        return (found != mBrainBodyMap.left.end());
-    }
-
-    /// get the organism currently assigned to the agent
-    PyOrganismPtr RTNEAT::get_organism(AgentBrainPtr agent)
-    {
-        BrainBodyMap::left_map::const_iterator found;
-        found = mBrainBodyMap.left.find(agent->GetBody());
-        PyOrganismPtr result;
-        if (found != mBrainBodyMap.left.end())
-        {
-            result = found->second;
-        }
-        else
-        {
-            AssertMsg(ready(), "an agent requested an rtNEAT network, but all networks are already in use!");
-            PyOrganismPtr brain = mWaitingBrainList.front();
-            mWaitingBrainList.pop();
-            mBrainBodyMap.insert(BrainBodyMap::value_type(agent->GetBody(), brain));
-            LOG_F_DEBUG("ai.rtneat",
-                        "new brain: " << brain->GetId() <<
-                        " for body: " << agent->GetBody()->GetId());
-
-            result = brain;
-        }
-        return result;
-    }
-
-    /// release the organism that was being used by the agent
-    void RTNEAT::release_organism(AgentBrainPtr agent)
-    {
-        BrainBodyMap::left_map::const_iterator found;
-        found = mBrainBodyMap.left.find(agent->GetBody());
-        if (found != mBrainBodyMap.left.end()) {
-            PyOrganismPtr brain = found->second;
-            deleteUnit(brain); // TODO: pass in the body instead
-            LOG_F_DEBUG("ai.rtneat", "release_organism brain: " << brain->GetId() << " from body: " << agent->GetBody()->GetId());
-        }
-    }
-
-    /// save a population to a file
-    std::string RTNEAT::save_population(const std::string& pop_file)
-    {
-        // try looking for the filename as is
-        std::string fname = pop_file;
-        std::ofstream output(fname.c_str());
-        if (!output) {
-            // try again with our findResource method
-           std::string fname = Kernel::findResource(pop_file, false);
-           output.open(fname.c_str());
-        }
-        if (!output) {
-            LOG_ERROR("Could not open file: " << fname);
-            return "";
-        }
-        else
-        {
-            LOG_F_MSG("ai.rtneat", "Saving population to file: " << fname);
-            //output << mPopulation;
-            mPopulation->print_to_file(output);
-            output.close();
-            return fname;
-        }
-    }
-
-    void RTNEAT::deleteUnit(PyOrganismPtr brain)
-    {
-        if (mEvolutionEnabled) {
-            // Push the brain onto the back of the waiting brain queue
-            mWaitingBrainList.push(brain);
-        }
-
-        // get the body that belongs to this brain
-        BrainBodyMap::right_map::const_iterator found = mBrainBodyMap.right.find(brain);
-
-        if (found != mBrainBodyMap.right.end()) {
-            SimId body_id = found->second->GetId();
-            U32 brain_id = brain->GetId();
-            LOG_F_DEBUG("ai.rtneat",
-                        "remove brain: " << brain_id << " from body: " << body_id);
-
-            // disconnect brain from body
-            mBrainBodyMap.right.erase(brain);
-
-            // Increment the deletion counter
-            ++mTotalUnitsDeleted;
-        }
-    }
-
-    void RTNEAT::tallyAll() {
-        // tally the rewards of all the fielded agents
-        typedef BrainBodyMap::left_map::const_iterator const_iterator;
-        for( const_iterator
-                 iter = mBrainBodyMap.left.begin(),
-                 iend = mBrainBodyMap.left.end();
-             iter != iend;
-             ++iter ) {
-            AIObjectPtr body = iter->first;
-            PyOrganismPtr brain = iter->second;
-            brain->mStats.tally(body->getReward());
-        }
-    }
-
-    void RTNEAT::ProcessTick( float32_t incAmt )
-    {
-        // Increment the spawn tick and evolution tick counters
-        ++mSpawnTickCount;
-        ++mEvolutionTickCount;
-
-        if (mEvolutionEnabled) {
-            tallyAll();
-            // Evaluate all brains' scores
-            evaluateAll();
-        }
-
-        // If the total number of units spawned so far exceeds the threshold value AND enough
-        // ticks have passed since the last evolution, then a new evolution may commence.
-        if (mEvolutionEnabled
-            && mTotalUnitsDeleted >= mUnitsToDeleteBeforeFirstJudgment
-            && mEvolutionTickCount >= mTimeBetweenEvolutions)
-        {
-            //Judgment day!
-            evolveAll();
-            mEvolutionTickCount = 0;
-        }
-    }
-
-    void RTNEAT::evaluateAll()
-    {
-        // Calculate the Z-score
-        ScoreHelper scoreHelper(mRewardInfo);
-
-
-        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter)
-        {
-            PyOrganismPtr brain = *iter;
-            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
-                size_t time_alive = brain->GetOrganism()->time_alive;
-                if ( time_alive % NEAT::time_alive_minimum == 0 && time_alive > 0 )
-                {
-                    stringstream ss;
-                    ss << "NEW TRIAL: brain: " << brain->GetId();
-                    ss << " stats: " << brain->mStats;
-                    ss << " time_alive: " << time_alive << "/" << NEAT::time_alive_minimum;
-                    brain->mStats.startNextTrial();
-                    ss << " new stats: " << brain->mStats;
-                    LOG_F_DEBUG("ai.rtneat", ss.str());
-                }
-                Reward stats = brain->mStats.getStats();
-                scoreHelper.addSample(stats);
-            }
-        }
-
-        scoreHelper.doCalculations();
-
-        F32 minAbsoluteScore = 0; // min of 0, min abs score
-        F32 maxAbsoluteScore = -FLT_MAX; // max raw score
-
-        size_t evaluated = 0;
-
-        PyOrganismPtr champ;
-
-        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
-            PyOrganismPtr brain = *iter;
-            // reset champion flag
-            brain->champion = false;
-            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
-                brain->mAbsoluteScore = 0;
-                ++evaluated;
-                Reward stats = brain->mStats.getStats();
-                Reward relative_score = scoreHelper.getRelativeScore(stats);
-                for (size_t i = 0; i < relative_score.size(); ++i)
-                {
-                    brain->mAbsoluteScore += relative_score[i] * mFitnessWeights[i];
-                }
-                if (brain->mAbsoluteScore < minAbsoluteScore)
-                    minAbsoluteScore = brain->mAbsoluteScore;
-                if (brain->mAbsoluteScore > maxAbsoluteScore) {
-                    maxAbsoluteScore = brain->mAbsoluteScore;
-                    champ = brain;
-                }
-            }
-        }
-
-        if (champ) {
-            champ->champion = true;
-            if (mChampionId != champ->GetId()) {
-                // if we found a new champion, print it out
-                mChampionId = champ->GetId();
-                LOG_F_DEBUG("ai.rtneat",
-                            " NEW CHAMP: " << champ->GetId() <<
-                            " fitness: " << champ->GetFitness() <<
-                            " stats: " << champ->mStats <<
-                            " time_alive: " << champ->GetTimeAlive());
-            }
-        }
-
-        //if (scoreHelper.getSampleSize() > 0 && evaluated > 0)
-        //{
-        //    LOG_F_DEBUG("ai.rtneat", "brains: " << mBrainList.size() << " active: " << mBrainBodyMap.size() << " waiting: " << mWaitingBrainList.size() << " evaluated: " << evaluated);
-        //    if (minAbsoluteScore != maxAbsoluteScore) {
-        //        LOG_F_DEBUG("ai.rtneat",
-        //                    "z-min: " << minAbsoluteScore <<
-        //                    " z-max: " << maxAbsoluteScore <<
-        //                    " r-min: " << scoreHelper.getMin() <<
-        //                    " r-max: " << scoreHelper.getMax() <<
-        //                    " w: " << mFitnessWeights <<
-        //                    " mean: " << scoreHelper.getAverage() <<
-        //                    " stdev: " << scoreHelper.getStandardDeviation());
-        //    }
-        //}
-
-        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
-            if ((*iter)->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
-                F32 modifiedFitness = (*iter)->mAbsoluteScore - (minAbsoluteScore < 0 ? minAbsoluteScore : 0);
-
-                if (!((*iter)->GetOrganism()->smited)) {
-                    (*iter)->GetOrganism()->fitness = modifiedFitness;
-                } else {
-                    (*iter)->GetOrganism()->fitness = 0.01 * modifiedFitness;
-                }
-            }
-        }
-    }
-
-    void RTNEAT::evolveAll()
-    {
-        // Remove the worst organism
-        OrganismPtr deadorg = mPopulation->remove_worst();
-
-        if (deadorg)
-            LOG_F_DEBUG("ai.rtneat.evolve", "deadorg: " << deadorg->gnome->genome_id);
-
-        //We can try to keep the number of species constant at this number
-        U32 num_species_target=4;
-        U32 compat_adjust_frequency = mBrainList.size()/10;
-        if (compat_adjust_frequency < 1)
-            compat_adjust_frequency = 1;
-
-        SpeciesPtr new_species;
-
-        // Sometimes, if all organisms are beneath the minimum "time alive" threshold, no organism will be removed
-        // If an organism *was* actually removed, then we can proceed with replacing it via the evolutionary process
-        if (deadorg) {
-            NEAT::OrganismPtr new_org;
-
-            // Estimate all species' fitnesses
-            for (vector<SpeciesPtr>::iterator curspec = (mPopulation->species).begin(); curspec != (mPopulation->species).end(); ++curspec) {
-                (*curspec)->estimate_average();
-            }
-
-            // TODO: milestoning is not implemented for now
-            //m_Population->memory_pool->isEmpty();
-            //if(RANDOM.randD()<=s_MilestoneProbability && !m_Population->memory_pool->isEmpty())// && meets probability requirement)
-            //{
-            // // Reproduce an organism with the same traits as the "memory pool".
-            //    new_org.reset(mPopulation->memory_pool)->reproduce_one(mOffspringCount, mPopulation, mPopulation->species);
-            //}
-            //else
-            //{
-
-            // Reproduce a single new organism to replace the one killed off.
-            new_org = (mPopulation->choose_parent_species())->reproduce_one(mOffspringCount, mPopulation, mPopulation->species, 0,0);
-            //}
-            ++mOffspringCount;
-
-            //Every compat_adjust_frequency reproductions, reassign the population to new species
-            if (mOffspringCount % compat_adjust_frequency == 0) {
-
-                U32 num_species = mPopulation->species.size();
-                F64 compat_mod=0.1;  //Modify compat thresh to control speciation
-
-                // This tinkers with the compatibility threshold, which normally would be held constant
-                if (num_species < num_species_target)
-                    NEAT::compat_threshold -= compat_mod;
-                else if (num_species > num_species_target)
-                    NEAT::compat_threshold += compat_mod;
-
-                if (NEAT::compat_threshold < 0.3)
-                    NEAT::compat_threshold = 0.3;
-
-                //Go through entire population, reassigning organisms to new species
-                vector<OrganismPtr>::iterator curorg = mPopulation->organisms.begin();
-                vector<OrganismPtr>::iterator orgend = mPopulation->organisms.end();
-                for (; curorg != orgend; ++curorg) {
-                    mPopulation->reassign_species(*curorg);
-                }
-            }
-
-            // Iterate through all of the Brains
-            //   - find the one whose Organism was killed off
-            //   - link that Brain to the newly created Organism, effectively
-            //     doing a "hot swap" of the Organisms in that Brain.
-            LOG_F_DEBUG("ai.rtneat", "print out population after evolveAll");
-            for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
-                PyOrganismPtr brain = *iter;
-                if (brain->GetOrganism() == deadorg) {
-                    LOG_F_DEBUG("ai.rtneat", "  DELETING Organims #"<< brain->GetId() << " Fitness: " << brain->GetFitness() << " Time: "<< brain->GetTimeAlive());
-                    brain->SetOrganism(new_org);
-                    brain->mStats.resetAll();
-                    deleteUnit(brain);
-                    //break;
-                } else {
-                    LOG_F_DEBUG("ai.rtneat", "  Organims #"<< brain->GetId() << " Fitness: " << brain->GetFitness() << " Time: "<< brain->GetTimeAlive());
-                }
-            }
-        }
-    }
-
-    /// set the lifetime so that we can ensure that the units have been alive
-    /// at least that long before evaluating them
-    void RTNEAT::set_lifetime(size_t lifetime)
-    {
-        // TODO: currently this will make it impossible to have more than one
-        //       rtNEAT with different lifetimes at the same time, but changing it
-        //       to a local value requires making changes to the code in source/rtneat
-        //       as well.
-        if (lifetime > 0) {
-            NEAT::time_alive_minimum = lifetime;
-            mTimeBetweenEvolutions = (F32)lifetime / FRACTION_POPULATION_INELIGIBLE_ALLOWED / (F32)(mPopulation->organisms.size());
-            LOG_F_DEBUG("ai.rtneat",
-                "time_alive_minimum: " << NEAT::time_alive_minimum <<
-                " mTimeBetweenEvolutions: " << mTimeBetweenEvolutions);
-        }
-    }
-
-    /// the id of the species of the organism
-    int PyOrganism::GetSpeciesId() const
-    {
-        return mOrganism->species.lock()->id;
-    }
-
-}
+#include "core/Common.h"
+#include "game/SimEntity.h"
+#include "game/SimContext.h"
+#include "game/Kernel.h"
+#include "ai/AIObject.h"
+#include "ai/AgentBrain.h"
+#include "ai/rtneat/rtNEAT.h"
+#include "rtneat/population.h"
+#include "rtneat/network.h"
+#include "rtneat/factor.h"
+#include "rtneat/island.h"
+#include "scripting/scriptIncludes.h"
+#include "math/Random.h"
+#include "core/TaskPool.h"
+#include "core/Algorithm.h"
+#include "rtneat/streamwriter.h"
+#include <ostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/weak_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+#include "core/File.h"
+
+namespace OpenNero
+{
+
+    /// @cond
+    BOOST_SHARED_DECL(SimEntity);
+    /// @endcond
+
+    const F32 FRACTION_POPULATION_INELIGIBLE_ALLOWED = 0.5;
+
+    using namespace NEAT;
+
+    namespace {
+        const size_t kNumSpeciesTarget = 5; ///< target number of species in the population
+        const double kCompatMod = 0.1; ///< compatibility threshold modifier
+        const double kMinCompatThreshold = 0.3; // minimum species compatibility threshold
+
+        /// compare two organisms by fitness
+        bool fitness_less(OrganismPtr a, OrganismPtr b)
+        {
+            return a->fitness < b->fitness;
+        }
+
+        /// Wrap a contiguous C++ array in a read-only Python memoryview
+        /// without copying it. The view is plain bytes; the caller's
+        /// docstring states the element type.
+        py::object make_memory_view(const void* data, size_t size_bytes)
+        {
+            static char empty = 0;
+            void* ptr = size_bytes ? const_cast<void*>(data) : &empty;
+            Py_buffer info;
+            if (PyBuffer_FillInfo(&info, NULL, ptr,
+                                  static_cast<Py_ssize_t>(size_bytes),
+                                  1, PyBUF_CONTIG_RO) != 0)
+            {
+                py::throw_error_already_set();
+            }
+            PyObject* view = PyMemoryView_FromBuffer(&info);
+            if (!view)
+            {
+                py::throw_error_already_set();
+            }
+            return py::object(py::handle<>(view));
+        }
+
+        /// memoryview over the elements of a vector
+        template <typename T>
+        py::object vector_view(const std::vector<T>& v)
+        {
+            return make_memory_view(v.empty() ? NULL : &v[0],
+                                    v.size() * sizeof(T));
+        }
+
+        /// does the population file name select the binary checkpoint format?
+        bool is_binary_checkpoint(const std::string& fname)
+        {
+            static const std::string ext(".bin");
+            return fname.size() > ext.size()
+                && fname.compare(fname.size() - ext.size(), ext.size(), ext) == 0;
+        }
+
+        /// Deserialize a binary population checkpoint straight out of a
+        /// read-only view of the file, so the pages stream in on demand
+        /// instead of being copied through read() first. Returns an empty
+        /// pointer if the file could not be opened or parsed.
+        PopulationPtr load_mapped_checkpoint(const std::string& fname)
+        {
+            PopulationPtr population;
+            ReadOnlyFileView view(fname);
+            if (!view.IsOpen() || view.Size() == 0) return population;
+            FileViewInStream input(view);
+            boost::archive::binary_iarchive archive(input);
+            archive >> population;
+            return population;
+        }
+
+        /// does the population file name select the delta checkpoint format?
+        bool is_delta_checkpoint(const std::string& fname)
+        {
+            static const std::string ext(".dpop");
+            return fname.size() > ext.size()
+                && fname.compare(fname.size() - ext.size(), ext.size(), ext) == 0;
+        }
+
+        /// how many delta segments may follow a base before the next save
+        /// rewrites the whole file from scratch
+        const uint32_t kDeltaRebaseEvery = 10;
+
+        /// magic bytes at the start of a delta checkpoint file
+        const char kDeltaMagic[4] = { 'N', 'D', 'C', '1' };
+
+        /// FNV-1a 64-bit hash of a byte buffer
+        uint64_t HashBytes(const std::string& bytes)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < bytes.size(); ++i)
+            {
+                hash ^= (unsigned char)bytes[i];
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /// one serialized organism and its content hash
+        struct DeltaRecord
+        {
+            uint64_t hash;     ///< FNV-1a hash of the payload
+            std::string bytes; ///< binary archive of the organism
+        };
+
+        /// serialized organism records of a population, by genome id
+        typedef std::map<S32, DeltaRecord> DeltaRecordMap;
+
+        /// serialize every organism of the population and hash the records
+        void BuildDeltaRecords(PopulationPtr population, DeltaRecordMap& records)
+        {
+            for (size_t i = 0; i < population->organisms.size(); ++i)
+            {
+                OrganismPtr org = population->organisms[i];
+                std::ostringstream payload(std::ios::out | std::ios::binary);
+                boost::archive::binary_oarchive archive(payload);
+                archive << org;
+                DeltaRecord& record = records[org->gnome->genome_id];
+                record.bytes = payload.str();
+                record.hash = HashBytes(record.bytes);
+            }
+        }
+
+        /// write one organism record (size 0 marks a tombstone)
+        void WriteDeltaRecord(std::ostream& out, S32 id, uint64_t hash,
+                              const std::string& bytes)
+        {
+            const int32_t genome_id = (int32_t)id;
+            const uint32_t size = (uint32_t)bytes.size();
+            out.write((const char*)&genome_id, sizeof(genome_id));
+            out.write((const char*)&hash, sizeof(hash));
+            out.write((const char*)&size, sizeof(size));
+            if (size > 0)
+            {
+                out.write(bytes.data(), size);
+            }
+        }
+    }
+
+    /// Constructor
+    /// @param filename name of the file with the initial population genomes
+    /// @param param_file file with RTNEAT parameters to load
+    /// @param population_size size of the population to construct
+    /// @param reward_info the specifications for the multidimensional reward
+    /// @param generational if true then run generational NEAT; otherwise run realtime NEAT
+    RTNEAT::RTNEAT(const std::string& filename,
+                   const std::string& param_file,
+                   size_t population_size,
+                   const RewardInfo& reward_info,
+                   bool generational)
+        : mPopulation()
+        , mWaitingBrainList()
+        , mBrainList()
+        , mBrainBodyMap()
+        , mOffspringCount(population_size)
+        , mSpawnTickCount(0)
+        , mEvolutionTickCount(0)
+        , mTotalUnitsDeleted(0)
+        , mUnitsDeletedSinceJudgment(0)
+        , mUnitsToDeleteBeforeFirstJudgment(population_size)
+        , mTimeBetweenEvolutions(NEAT::time_alive_minimum)
+        , mRewardInfo(reward_info)
+        , mFitnessWeights(reward_info.size())
+        , mEvolutionEnabled(true)
+        , mChampionId(-1)
+        , mGenerational(generational)
+        , mDeltaSegments(0)
+    {
+        NEAT::load_neat_params(Kernel::findResource(param_file));
+        NEAT::pop_size = population_size;
+        std::string pop_fname = Kernel::findResource(filename);
+        mPopulation.reset(new Population(pop_fname, population_size));
+        AssertMsg(mPopulation, "initial population creation failed");
+        mOffspringCount = mPopulation->organisms.size();
+        AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
+        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
+        {
+            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
+            mWaitingBrainList.push(brain);
+            mBrainList.push_back(brain);
+        }
+    }
+
+    /// Constructor
+    /// @param param_file RTNEAT parameter file
+    /// @param inputs number of inputs
+    /// @param outputs number of outputs
+    /// @param population_size size of the population to construct
+    /// @param noise variance of the Gaussian used to assign initial weights
+    /// @param reward_info the specifications for the multidimensional reward
+    /// @param generational if true then run generational NEAT; otherwise run realtime NEAT
+    RTNEAT::RTNEAT(const std::string& param_file,
+                   size_t inputs,
+                   size_t outputs,
+                   size_t population_size,
+                   F32 noise,
+                   const RewardInfo& reward_info,
+                   bool generational)
+        : mPopulation()
+        , mWaitingBrainList()
+        , mBrainList()
+        , mBrainBodyMap()
+        , mOffspringCount(0)
+        , mSpawnTickCount(0)
+        , mEvolutionTickCount(0)
+        , mTotalUnitsDeleted(0)
+        , mUnitsDeletedSinceJudgment(0)
+        , mUnitsToDeleteBeforeFirstJudgment(population_size)
+        , mTimeBetweenEvolutions(NEAT::time_alive_minimum)
+        , mRewardInfo(reward_info)
+        , mFitnessWeights(reward_info.size())
+        , mEvolutionEnabled(true)
+        , mGenerational(generational)
+        , mDeltaSegments(0)
+    {
+        NEAT::load_neat_params(Kernel::findResource(param_file));
+        NEAT::pop_size = population_size;
+        GenomePtr genome(new Genome(inputs, outputs, 0, 0));
+        mPopulation.reset(new Population(genome, population_size, noise));
+        AssertMsg(mPopulation, "initial population creation failed");
+        mOffspringCount = mPopulation->organisms.size();
+        AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
+        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
+        {
+            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
+            mWaitingBrainList.push(brain);
+            mBrainList.push_back(brain);
+        }
+    }
+
+    /// Destructor
+    RTNEAT::~RTNEAT()
+    {
+    }
+
+
+    /// load sensor values into the network
+    void PyNetwork::load_sensors(py::list l)
+    {
+        std::vector<double> sensors;
+        for (py::ssize_t i = 0; i < py::len(l); ++i)
+            {
+                sensors.push_back(py::extract<double>(l[i]));
+            }
+        mNetwork->load_sensors(sensors);
+    }
+
+    /// load error values into the network
+    void PyNetwork::load_errors(py::list l)
+    {
+        std::vector<double> errors;
+        for (py::ssize_t i = 0; i < py::len(l); ++i)
+            {
+                errors.push_back(py::extract<double>(l[i]));
+            }
+        mNetwork->load_errors(errors);
+    }
+
+    namespace
+    {
+        /// ParallelFor body for activate_networks: each index activates
+        /// one network; distinct networks share no mutable state
+        struct ActivateNetworksBody
+        {
+            std::vector<NetworkPtr>* nets; ///< the unpacked batch
+
+            void operator()(size_t i)
+            {
+                (*nets)[i]->activate();
+            }
+        };
+    }
+
+    py::list activate_networks(py::list nets, py::list sensor_rows)
+    {
+        const py::ssize_t count = py::len(nets);
+        AssertMsg( py::len(sensor_rows) == count,
+                   "activate_networks expects one sensor row per network" );
+
+        // unpack the batch and load the sensors while we still hold the GIL
+        std::vector<NetworkPtr> networks;
+        networks.reserve(count);
+        std::vector<double> sensors;
+        for (py::ssize_t i = 0; i < count; ++i)
+        {
+            PyNetworkPtr net = py::extract<PyNetworkPtr>(nets[i]);
+            py::list row = py::extract<py::list>(sensor_rows[i]);
+            sensors.clear();
+            for (py::ssize_t j = 0; j < py::len(row); ++j)
+            {
+                sensors.push_back(py::extract<double>(row[j]));
+            }
+            net->GetNetwork()->load_sensors(sensors);
+            networks.push_back(net->GetNetwork());
+        }
+
+        // the activation sweeps are pure C++; run them across all cores
+        {
+            ScopedGILRelease gil;
+            ActivateNetworksBody body;
+            body.nets = &networks;
+            ParallelFor(GetSharedTaskPool(), 0, networks.size(), 1, body);
+        }
+
+        // gather the outputs back into per-network lists
+        py::list results;
+        for (size_t i = 0; i < networks.size(); ++i)
+        {
+            py::list outputs;
+            std::vector<NNodePtr>::const_iterator iter;
+            for (iter = networks[i]->outputs.begin(); iter != networks[i]->outputs.end(); ++iter)
+            {
+                outputs.append((*iter)->get_active_out());
+            }
+            results.append(outputs);
+        }
+        return results;
+    }
+
+    /// get output values from the network
+    py::list PyNetwork::get_outputs()
+    {
+        py::list l;
+        std::vector<NNodePtr>::const_iterator iter;
+        for (iter = mNetwork->outputs.begin(); iter != mNetwork->outputs.end(); ++iter)
+            {
+                l.append((*iter)->get_active_out());
+            }
+        return l;
+    }
+
+    py::object PyNetwork::get_weight_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_weights());
+    }
+
+    py::object PyNetwork::get_link_source_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_link_sources());
+    }
+
+    py::object PyNetwork::get_link_start_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_link_starts());
+    }
+
+    py::object PyNetwork::get_node_id_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_node_ids());
+    }
+
+    py::object PyNetwork::get_node_place_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_node_places());
+    }
+
+    py::object PyNetwork::get_activation_view()
+    {
+        if (!mNetwork->ensure_compiled())
+            return py::object();
+        return vector_view(mNetwork->compiled_activations());
+    }
+
+    std::ostream& operator<<(std::ostream& output, const PyNetwork& net)
+    {
+        output << net.mNetwork;
+        return output;
+    }
+
+    std::ostream& operator<<(std::ostream& output, const PyOrganism& org)
+    {
+        output << org.mOrganism;
+        return output;
+    }
+
+    /// load the population from a file
+    bool RTNEAT::load_population(const std::string& pop_file)
+    {
+        std::string fname = Kernel::findResource(pop_file, false);
+        if (is_delta_checkpoint(fname)) {
+            return load_population_delta(fname);
+        }
+        if (is_binary_checkpoint(fname)) {
+            // map the checkpoint instead of reading it where we can
+            PopulationPtr population = load_mapped_checkpoint(fname);
+            if (!population) {
+                std::ifstream input(fname.c_str(), std::ios::in | std::ios::binary);
+                if (!input) {
+                    LOG_ERROR("Could not open file: " << fname);
+                    return false;
+                }
+                boost::archive::binary_iarchive archive(input);
+                archive >> population;
+            }
+            mPopulation = population;
+        } else {
+            mPopulation.reset(new Population(fname));
+        }
+        return true;
+    }
+
+    /// Append the population to an open binary world snapshot stream.
+    /// The archive is self-delimiting, so several AIs can follow each
+    /// other on the same stream.
+    bool RTNEAT::SaveSnapshot(std::ostream& out)
+    {
+        try {
+            boost::archive::binary_oarchive archive(out);
+            archive << mPopulation;
+        } catch (const boost::archive::archive_exception& e) {
+            LOG_F_ERROR("ai.rtneat", "could not snapshot population: " << e.what());
+            return false;
+        }
+        return true;
+    }
+
+    /// Replace the population from a snapshot written by SaveSnapshot.
+    /// Like load_population, this swaps in the restored organisms; agents
+    /// pick up the new brains the next time they are (re)spawned.
+    bool RTNEAT::RestoreSnapshot(std::istream& in)
+    {
+        PopulationPtr population;
+        try {
+            boost::archive::binary_iarchive archive(in);
+            archive >> population;
+        } catch (const boost::archive::archive_exception& e) {
+            LOG_F_ERROR("ai.rtneat", "could not restore population snapshot: " << e.what());
+            return false;
+        }
+        if (!population) {
+            return false;
+        }
+        mPopulation = population;
+        return true;
+    }
+
+    /// are we ready to spawn a new organism?
+    bool RTNEAT::ready()
+    {
+        return !mWaitingBrainList.empty();
+    }
+
+    /// have we been deleted?
+    bool RTNEAT::has_organism(AgentBrainPtr agent)
+    {
+        BrainBodyMap::left_map::const_iterator found;
+        found = mBrainBodyMap.left.find(agent->GetBody());
+        return (found != mBrainBodyMap.left.end());
+    }
+
+    /// get the organism currently assigned to the agent
+    PyOrganismPtr RTNEAT::get_organism(AgentBrainPtr agent)
+    {
+        BrainBodyMap::left_map::const_iterator found;
+        found = mBrainBodyMap.left.find(agent->GetBody());
+        PyOrganismPtr result;
+        if (found != mBrainBodyMap.left.end())
+        {
+            result = found->second;
+        }
+        else
+        {
+            AssertMsg(ready(), "an agent requested an rtNEAT network, but all networks are already in use!");
+            PyOrganismPtr brain = mWaitingBrainList.front();
+            mWaitingBrainList.pop();
+            mBrainBodyMap.insert(BrainBodyMap::value_type(agent->GetBody(), brain));
+            LOG_F_DEBUG("ai.rtneat",
+                        "new brain: " << brain->GetId() <<
+                        " for body: " << agent->GetBody()->GetId());
+
+            result = brain;
+        }
+        return result;
+    }
+
+    /// release the organism that was being used by the agent
+    void RTNEAT::release_organism(AgentBrainPtr agent)
+    {
+        BrainBodyMap::left_map::const_iterator found;
+        found = mBrainBodyMap.left.find(agent->GetBody());
+        if (found != mBrainBodyMap.left.end()) {
+            PyOrganismPtr brain = found->second;
+            deleteUnit(brain); // TODO: pass in the body instead
+            LOG_F_DEBUG("ai.rtneat", "release_organism brain: " << brain->GetId() << " from body: " << agent->GetBody()->GetId());
+        }
+    }
+
+    /// save a population to a file
+    std::string RTNEAT::save_population(const std::string& pop_file)
+    {
+        // delta checkpoints only append the organisms that changed since
+        // the last save, which is what makes per-generation durability on
+        // slow filesystems affordable
+        if (is_delta_checkpoint(pop_file)) {
+            return save_population_delta(pop_file);
+        }
+        // binary checkpoints use fixed-width records instead of the text
+        // genome format, so saving them does not stall the simulation tick
+        bool binary = is_binary_checkpoint(pop_file);
+        // try looking for the filename as is
+        std::string fname = pop_file;
+        NEAT::StreamWriter output(fname,
+                                  binary ? (std::ios::out | std::ios::binary) : std::ios::out);
+        if (!output) {
+            // try again with our findResource method
+           std::string fname = Kernel::findResource(pop_file, false);
+           output.open(fname.c_str(),
+                       binary ? (std::ios::out | std::ios::binary) : std::ios::out);
+        }
+        if (!output) {
+            LOG_ERROR("Could not open file: " << fname);
+            return "";
+        }
+        else
+        {
+            LOG_F_MSG("ai.rtneat", "Saving population to file: " << fname);
+            if (binary) {
+                boost::archive::binary_oarchive archive(output);
+                archive << mPopulation;
+            } else {
+                //output << mPopulation;
+                mPopulation->print_to_file(output);
+            }
+            output.close();
+            return fname;
+        }
+    }
+
+    /// save the population as a base-plus-deltas checkpoint
+    std::string RTNEAT::save_population_delta(const std::string& pop_file)
+    {
+        DeltaRecordMap records;
+        BuildDeltaRecords(mPopulation, records);
+
+        // rewrite the whole file when the target changes and periodically
+        // thereafter, so the chain of deltas never grows without bound
+        const bool rebase = pop_file != mDeltaFile
+            || mDeltaSegments >= kDeltaRebaseEvery;
+
+        std::ofstream output(pop_file.c_str(), rebase
+            ? (std::ios::out | std::ios::trunc | std::ios::binary)
+            : (std::ios::out | std::ios::app | std::ios::binary));
+        if (!output) {
+            LOG_ERROR("Could not open file: " << pop_file);
+            return "";
+        }
+
+        DeltaRecordMap::const_iterator iter;
+        if (rebase) {
+            // a full base segment holding every organism
+            output.write(kDeltaMagic, sizeof(kDeltaMagic));
+            const uint8_t type = 0;
+            const uint32_t count = (uint32_t)records.size();
+            output.write((const char*)&type, sizeof(type));
+            output.write((const char*)&count, sizeof(count));
+            for (iter = records.begin(); iter != records.end(); ++iter) {
+                WriteDeltaRecord(output, iter->first, iter->second.hash,
+                                 iter->second.bytes);
+            }
+            mDeltaSegments = 0;
+            LOG_F_MSG("ai.rtneat", "Saving population base checkpoint to file: "
+                      << pop_file << " (" << records.size() << " organisms)");
+        } else {
+            // only the organisms whose record changed, plus tombstones for
+            // the ones that are gone
+            uint32_t count = 0;
+            for (iter = records.begin(); iter != records.end(); ++iter) {
+                std::map<S32, uint64_t>::const_iterator last =
+                    mDeltaHashes.find(iter->first);
+                if (last == mDeltaHashes.end() || last->second != iter->second.hash) {
+                    ++count;
+                }
+            }
+            std::map<S32, uint64_t>::const_iterator last;
+            for (last = mDeltaHashes.begin(); last != mDeltaHashes.end(); ++last) {
+                if (records.find(last->first) == records.end()) {
+                    ++count;
+                }
+            }
+            if (count == 0) {
+                // nothing changed since the last save; leave the file alone
+                return pop_file;
+            }
+            const uint8_t type = 1;
+            output.write((const char*)&type, sizeof(type));
+            output.write((const char*)&count, sizeof(count));
+            for (iter = records.begin(); iter != records.end(); ++iter) {
+                std::map<S32, uint64_t>::const_iterator seen =
+                    mDeltaHashes.find(iter->first);
+                if (seen == mDeltaHashes.end() || seen->second != iter->second.hash) {
+                    WriteDeltaRecord(output, iter->first, iter->second.hash,
+                                     iter->second.bytes);
+                }
+            }
+            for (last = mDeltaHashes.begin(); last != mDeltaHashes.end(); ++last) {
+                if (records.find(last->first) == records.end()) {
+                    WriteDeltaRecord(output, last->first, 0, std::string());
+                }
+            }
+            mDeltaSegments += 1;
+            LOG_F_MSG("ai.rtneat", "Saving population delta to file: " << pop_file
+                      << " (" << count << " of " << records.size()
+                      << " organism records)");
+        }
+        output.close();
+
+        mDeltaFile = pop_file;
+        mDeltaHashes.clear();
+        for (iter = records.begin(); iter != records.end(); ++iter) {
+            mDeltaHashes[iter->first] = iter->second.hash;
+        }
+        return pop_file;
+    }
+
+    /// load a population from a base-plus-deltas checkpoint
+    bool RTNEAT::load_population_delta(const std::string& fname)
+    {
+        std::ifstream input(fname.c_str(), std::ios::in | std::ios::binary);
+        if (!input) {
+            LOG_ERROR("Could not open file: " << fname);
+            return false;
+        }
+        char magic[4];
+        input.read(magic, sizeof(magic));
+        if (!input || memcmp(magic, kDeltaMagic, sizeof(magic)) != 0) {
+            LOG_ERROR("Not a delta checkpoint file: " << fname);
+            return false;
+        }
+
+        // replay the segments in order; later records shadow earlier ones
+        DeltaRecordMap latest;
+        uint32_t delta_segments = 0;
+        while (input.peek() != EOF) {
+            uint8_t type = 0;
+            uint32_t count = 0;
+            input.read((char*)&type, sizeof(type));
+            input.read((char*)&count, sizeof(count));
+            if (!input) break;
+            if (type != 0) ++delta_segments;
+            for (uint32_t i = 0; i < count && input; ++i) {
+                int32_t genome_id = 0;
+                uint64_t hash = 0;
+                uint32_t size = 0;
+                input.read((char*)&genome_id, sizeof(genome_id));
+                input.read((char*)&hash, sizeof(hash));
+                input.read((char*)&size, sizeof(size));
+                if (!input) break;
+                if (size == 0) {
+                    latest.erase(genome_id);
+                } else {
+                    DeltaRecord& record = latest[genome_id];
+                    record.hash = hash;
+                    record.bytes.resize(size);
+                    input.read(&record.bytes[0], size);
+                }
+            }
+        }
+        if (latest.empty()) {
+            LOG_ERROR("Delta checkpoint holds no organisms: " << fname);
+            return false;
+        }
+
+        std::vector<OrganismPtr> organisms;
+        organisms.reserve(latest.size());
+        DeltaRecordMap::const_iterator iter;
+        try {
+            for (iter = latest.begin(); iter != latest.end(); ++iter) {
+                std::istringstream payload(iter->second.bytes,
+                                           std::ios::in | std::ios::binary);
+                boost::archive::binary_iarchive archive(payload);
+                OrganismPtr org;
+                archive >> org;
+                organisms.push_back(org);
+            }
+        } catch (const boost::archive::archive_exception& e) {
+            LOG_F_ERROR("ai.rtneat", "could not restore delta checkpoint: " << e.what());
+            return false;
+        }
+
+        mPopulation = Population::assemble(organisms);
+
+        // resuming saves to the same file continue the delta chain
+        mDeltaFile = fname;
+        mDeltaSegments = delta_segments;
+        mDeltaHashes.clear();
+        for (iter = latest.begin(); iter != latest.end(); ++iter) {
+            mDeltaHashes[iter->first] = iter->second.hash;
+        }
+        return true;
+    }
+
+    void RTNEAT::deleteUnit(PyOrganismPtr brain)
+    {
+        if (mEvolutionEnabled) {
+            // Push the brain onto the back of the waiting brain queue
+            mWaitingBrainList.push(brain);
+        }
+
+        // get the body that belongs to this brain
+        BrainBodyMap::right_map::const_iterator found = mBrainBodyMap.right.find(brain);
+
+        if (found != mBrainBodyMap.right.end()) {
+            SimId body_id = found->second->GetId();
+            U32 brain_id = brain->GetId();
+            LOG_F_DEBUG("ai.rtneat",
+                        "remove brain: " << brain_id << " from body: " << body_id);
+
+            // disconnect brain from body
+            mBrainBodyMap.right.erase(brain);
+
+            // Increment the deletion counters
+            ++mTotalUnitsDeleted;
+            ++mUnitsDeletedSinceJudgment;
+        }
+    }
+
+    void RTNEAT::tallyAll() {
+        // tally the rewards of all the fielded agents
+        typedef BrainBodyMap::left_map::const_iterator const_iterator;
+        for( const_iterator
+                 iter = mBrainBodyMap.left.begin(),
+                 iend = mBrainBodyMap.left.end();
+             iter != iend;
+             ++iter ) {
+            AIObjectPtr body = iter->first;
+            PyOrganismPtr brain = iter->second;
+            brain->mStats.tally(body->getReward());
+        }
+    }
+
+    void RTNEAT::ProcessTick( float32_t incAmt )
+    {
+        // Increment the spawn tick and evolution tick counters
+        ++mSpawnTickCount;
+        ++mEvolutionTickCount;
+
+        if (mEvolutionEnabled) {
+            tallyAll();
+            // Evaluate all brains' scores
+            evaluateAll();
+        }
+
+        // If the total number of units spawned so far exceeds the threshold value AND enough
+        // ticks have passed since the last evolution, then a new evolution may commence.
+        if (mEvolutionEnabled
+            && mTotalUnitsDeleted >= mUnitsToDeleteBeforeFirstJudgment
+            && mEvolutionTickCount >= mTimeBetweenEvolutions)
+        {
+            //Judgment day! Replace as many organisms as have died since the
+            //last judgment in one batch, so a burst of deaths costs one
+            //round of species bookkeeping instead of one per organism.
+            size_t batch = mUnitsDeletedSinceJudgment > 0 ? mUnitsDeletedSinceJudgment : 1;
+            evolveBatch(batch);
+            mEvolutionTickCount = 0;
+        }
+    }
+
+    size_t RTNEAT::evaluateBatch(const std::vector<FeatureVector>& inputs,
+                                 std::vector<FeatureVector>& outputs)
+    {
+        AssertMsg(inputs.size() == mBrainList.size(),
+                  "evaluateBatch needs one row of inputs per organism");
+
+        outputs.resize(mBrainList.size());
+        if (mBrainList.empty()) return 0;
+
+        if (!mEvalTaskPool) {
+            mEvalTaskPool.reset(new TaskPool());
+        }
+
+        size_t workers = mEvalTaskPool->GetWorkerCount();
+        if (workers > 1 && mBrainList.size() > 1) {
+            // one contiguous chunk of organisms per worker
+            size_t chunk = (mBrainList.size() + workers - 1) / workers;
+            std::vector<size_t> chunk_activated((mBrainList.size() + chunk - 1) / chunk, 0);
+            size_t c = 0;
+            for (size_t begin = 0; begin < mBrainList.size(); begin += chunk, ++c) {
+                size_t end = std::min(begin + chunk, mBrainList.size());
+                mEvalTaskPool->Submit(boost::bind(&RTNEAT::evaluateRange, this,
+                                                  &inputs, &outputs, begin, end,
+                                                  &chunk_activated[c]));
+            }
+            mEvalTaskPool->WaitAll();
+            size_t num_activated = 0;
+            for (c = 0; c < chunk_activated.size(); ++c) {
+                num_activated += chunk_activated[c];
+            }
+            return num_activated;
+        } else {
+            size_t num_activated = 0;
+            evaluateRange(&inputs, &outputs, 0, mBrainList.size(), &num_activated);
+            return num_activated;
+        }
+    }
+
+    void RTNEAT::evaluateRange(const std::vector<FeatureVector>* inputs,
+                               std::vector<FeatureVector>* outputs,
+                               size_t begin, size_t end, size_t* num_activated)
+    {
+        for (size_t i = begin; i < end; ++i) {
+            NetworkPtr net = mBrainList[i]->GetOrganism()->net;
+            const FeatureVector& row_in = (*inputs)[i];
+            net->load_sensors(row_in.begin());
+            if (net->activate()) {
+                ++(*num_activated);
+            }
+            FeatureVector& row = (*outputs)[i];
+            row.clear();
+            std::vector<NNodePtr>::const_iterator iter;
+            for (iter = net->outputs.begin(); iter != net->outputs.end(); ++iter) {
+                row.push_back((*iter)->get_active_out());
+            }
+        }
+    }
+
+    void RTNEAT::evaluateAll()
+    {
+        // Calculate the Z-score
+        ScoreHelper scoreHelper(mRewardInfo);
+
+
+        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter)
+        {
+            PyOrganismPtr brain = *iter;
+            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
+                size_t time_alive = brain->GetOrganism()->time_alive;
+                if ( time_alive % NEAT::time_alive_minimum == 0 && time_alive > 0 )
+                {
+                    stringstream ss;
+                    ss << "NEW TRIAL: brain: " << brain->GetId();
+                    ss << " stats: " << brain->mStats;
+                    ss << " time_alive: " << time_alive << "/" << NEAT::time_alive_minimum;
+                    brain->mStats.startNextTrial();
+                    ss << " new stats: " << brain->mStats;
+                    LOG_F_DEBUG("ai.rtneat", ss.str());
+                }
+                Reward stats = brain->mStats.getStats();
+                scoreHelper.addSample(stats);
+            }
+        }
+
+        scoreHelper.doCalculations();
+
+        F32 minAbsoluteScore = 0; // min of 0, min abs score
+        F32 maxAbsoluteScore = -FLT_MAX; // max raw score
+
+        size_t evaluated = 0;
+
+        PyOrganismPtr champ;
+
+        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
+            PyOrganismPtr brain = *iter;
+            // reset champion flag
+            brain->champion = false;
+            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
+                brain->mAbsoluteScore = 0;
+                ++evaluated;
+                Reward stats = brain->mStats.getStats();
+                Reward relative_score = scoreHelper.getRelativeScore(stats);
+                for (size_t i = 0; i < relative_score.size(); ++i)
+                {
+                    brain->mAbsoluteScore += relative_score[i] * mFitnessWeights[i];
+                }
+                if (brain->mAbsoluteScore < minAbsoluteScore)
+                    minAbsoluteScore = brain->mAbsoluteScore;
+                if (brain->mAbsoluteScore > maxAbsoluteScore) {
+                    maxAbsoluteScore = brain->mAbsoluteScore;
+                    champ = brain;
+                }
+            }
+        }
+
+        if (champ) {
+            champ->champion = true;
+            if (mChampionId != champ->GetId()) {
+                // if we found a new champion, print it out
+                mChampionId = champ->GetId();
+                LOG_F_DEBUG("ai.rtneat",
+                            " NEW CHAMP: " << champ->GetId() <<
+                            " fitness: " << champ->GetFitness() <<
+                            " stats: " << champ->mStats <<
+                            " time_alive: " << champ->GetTimeAlive());
+            }
+        }
+
+        //if (scoreHelper.getSampleSize() > 0 && evaluated > 0)
+        //{
+        //    LOG_F_DEBUG("ai.rtneat", "brains: " << mBrainList.size() << " active: " << mBrainBodyMap.size() << " waiting: " << mWaitingBrainList.size() << " evaluated: " << evaluated);
+        //    if (minAbsoluteScore != maxAbsoluteScore) {
+        //        LOG_F_DEBUG("ai.rtneat",
+        //                    "z-min: " << minAbsoluteScore <<
+        //                    " z-max: " << maxAbsoluteScore <<
+        //                    " r-min: " << scoreHelper.getMin() <<
+        //                    " r-max: " << scoreHelper.getMax() <<
+        //                    " w: " << mFitnessWeights <<
+        //                    " mean: " << scoreHelper.getAverage() <<
+        //                    " stdev: " << scoreHelper.getStandardDeviation());
+        //    }
+        //}
+
+        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
+            if ((*iter)->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
+                F32 modifiedFitness = (*iter)->mAbsoluteScore - (minAbsoluteScore < 0 ? minAbsoluteScore : 0);
+
+                if (!((*iter)->GetOrganism()->smited)) {
+                    (*iter)->GetOrganism()->fitness = modifiedFitness;
+                } else {
+                    (*iter)->GetOrganism()->fitness = 0.01 * modifiedFitness;
+                }
+            }
+        }
+    }
+
+    void RTNEAT::evolveAll()
+    {
+        evolveBatch(1);
+    }
+
+    void RTNEAT::evolveBatch(size_t count)
+    {
+        //We can try to keep the number of species constant at this number
+        U32 num_species_target=4;
+        U32 compat_adjust_frequency = mBrainList.size()/10;
+        if (compat_adjust_frequency < 1)
+            compat_adjust_frequency = 1;
+
+        // Remove up to count worst organisms first, so every replacement
+        // in the batch reproduces from the same survivor pool; the batch
+        // primitive partial-selects them in a single population scan.
+        // Sometimes, if all organisms are beneath the minimum "time alive"
+        // threshold, no organism will be removed
+        vector<OrganismPtr> deadorgs = mPopulation->remove_worst_n(count);
+        for (size_t k = 0; k < deadorgs.size(); ++k) {
+            LOG_F_DEBUG("ai.rtneat.evolve", "deadorg: " << deadorgs[k]->gnome->genome_id);
+        }
+
+        if (deadorgs.empty()) {
+            mUnitsDeletedSinceJudgment = 0;
+            return;
+        }
+
+        // Estimate all species' fitnesses once for the whole batch
+        for (vector<SpeciesPtr>::iterator curspec = (mPopulation->species).begin(); curspec != (mPopulation->species).end(); ++curspec) {
+            (*curspec)->estimate_average();
+        }
+
+        // TODO: milestoning is not implemented for now
+        //m_Population->memory_pool->isEmpty();
+        //if(RANDOM.randD()<=s_MilestoneProbability && !m_Population->memory_pool->isEmpty())// && meets probability requirement)
+        //{
+        // // Reproduce an organism with the same traits as the "memory pool".
+        //    new_org.reset(mPopulation->memory_pool)->reproduce_one(mOffspringCount, mPopulation, mPopulation->species);
+        //}
+
+        // Reproduce one new organism per removal; replacement slots are
+        // filled from the island migration inbox first, so champions that
+        // arrived from peer islands enter the population like offspring
+        vector<OrganismPtr> neworgs;
+        bool adjust_species = false;
+        for (size_t k = 0; k < deadorgs.size(); ++k) {
+            NEAT::OrganismPtr new_org;
+            NEAT::GenomePtr immigrant;
+            if (IslandMigration::instance().is_enabled())
+                immigrant = IslandMigration::instance().take_immigrant();
+            if (immigrant) {
+                LOG_F_DEBUG("ai.rtneat.evolve", "immigrant genome: " << immigrant->genome_id);
+                new_org.reset(new NEAT::Organism(0.0, immigrant, 1));
+                mPopulation->add_organism(new_org);
+            } else {
+                new_org = (mPopulation->choose_parent_species())->reproduce_one(mOffspringCount, mPopulation, mPopulation->species, 0,0);
+            }
+            // tiered genome verification: every offspring in debug builds,
+            // every NERO_VERIFY_SAMPLE_RATE-th in optimized builds
+            VerifyMsg( new_org->gnome->verify(), "offspring genome failed verification" );
+            ++mOffspringCount;
+            //Every compat_adjust_frequency reproductions, reassign the population to new species
+            if (mOffspringCount % compat_adjust_frequency == 0)
+                adjust_species = true;
+            neworgs.push_back(new_org);
+        }
+
+        // A single speciation sweep covers every reproduction in the batch
+        if (adjust_species) {
+
+            U32 num_species = mPopulation->species.size();
+            F64 compat_mod=0.1;  //Modify compat thresh to control speciation
+
+            // This tinkers with the compatibility threshold, which normally would be held constant
+            if (num_species < num_species_target)
+                NEAT::compat_threshold -= compat_mod;
+            else if (num_species > num_species_target)
+                NEAT::compat_threshold += compat_mod;
+
+            if (NEAT::compat_threshold < 0.3)
+                NEAT::compat_threshold = 0.3;
+
+            //Go through entire population, reassigning organisms to new species
+            vector<OrganismPtr>::iterator curorg = mPopulation->organisms.begin();
+            vector<OrganismPtr>::iterator orgend = mPopulation->organisms.end();
+            for (; curorg != orgend; ++curorg) {
+                mPopulation->reassign_species(*curorg);
+            }
+        }
+
+        // Iterate through all of the Brains once
+        //   - find the ones whose Organisms were killed off
+        //   - link those Brains to the newly created Organisms, effectively
+        //     doing a "hot swap" of the Organisms in those Brains.
+        LOG_F_DEBUG("ai.rtneat", "print out population after evolveBatch");
+        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
+            PyOrganismPtr brain = *iter;
+            bool swapped = false;
+            for (size_t k = 0; k < deadorgs.size(); ++k) {
+                if (brain->GetOrganism() == deadorgs[k]) {
+                    LOG_F_DEBUG("ai.rtneat", "  DELETING Organims #"<< brain->GetId() << " Fitness: " << brain->GetFitness() << " Time: "<< brain->GetTimeAlive());
+                    brain->SetOrganism(neworgs[k]);
+                    brain->mStats.resetAll();
+                    deleteUnit(brain);
+                    swapped = true;
+                    break;
+                }
+            }
+            if (!swapped) {
+                LOG_F_DEBUG("ai.rtneat", "  Organims #"<< brain->GetId() << " Fitness: " << brain->GetFitness() << " Time: "<< brain->GetTimeAlive());
+            }
+        }
+
+        // deletions caused by the hot swaps above are part of this batch
+        mUnitsDeletedSinceJudgment = 0;
+
+        // after each judgment, fire our current champion at the peer
+        // islands; migration is fully asynchronous, so this never blocks
+        // the evolution loop
+        if (IslandMigration::instance().is_enabled())
+            IslandMigration::instance().send_champion(mPopulation);
+    }
+
+    /// set the lifetime so that we can ensure that the units have been alive
+    /// at least that long before evaluating them
+    void RTNEAT::set_lifetime(size_t lifetime)
+    {
+        // TODO: currently this will make it impossible to have more than one
+        //       rtNEAT with different lifetimes at the same time, but changing it
+        //       to a local value requires making changes to the code in source/rtneat
+        //       as well.
+        if (lifetime > 0) {
+            NEAT::time_alive_minimum = lifetime;
+            mTimeBetweenEvolutions = (F32)lifetime / FRACTION_POPULATION_INELIGIBLE_ALLOWED / (F32)(mPopulation->organisms.size());
+            LOG_F_DEBUG("ai.rtneat",
+                "time_alive_minimum: " << NEAT::time_alive_minimum <<
+                " mTimeBetweenEvolutions: " << mTimeBetweenEvolutions);
+        }
+    }
+
+    /// the id of the species of the organism
+    int PyOrganism::GetSpeciesId() const
+    {
+        return mOrganism->species.lock()->id;
+    }
+
+}
@@ -30,6 +30,8 @@ namespace OpenNero
     BOOST_SHARED_DECL(AIObject);
     /// @endcond
 
+    class TaskPool;
+
     /// A bi-directional map associating AIObjects (bodies) with PyOrganisms (rtNEAT brains)
     typedef boost::bimap<AIObjectPtr, PyOrganismPtr> BrainBodyMap;
 
@@ -43,6 +45,7 @@ namespace OpenNero
 		size_t mSpawnTickCount;           ///< number of spawn ticks
 		size_t mEvolutionTickCount;       ///< number of evolution ticks
         size_t mTotalUnitsDeleted;        ///< total units deleted
+        size_t mUnitsDeletedSinceJudgment;///< units deleted since the last round of evolution
         size_t mUnitsToDeleteBeforeFirstJudgment; ///< number of units to delete before judging
         size_t mTimeBetweenEvolutions;    ///< time (in ticks) between rounds of evolution
         RewardInfo mRewardInfo; ///< the constraints that describe the per-step rewards
@@ -52,6 +55,18 @@ namespace OpenNero
         S32 mChampionId; ///< the id of the last champion of the population
 
         bool mGenerational;               ///< whether to run NEAT in generational or realtime mode
+
+        boost::shared_ptr<TaskPool> mEvalTaskPool; ///< worker pool for evaluateBatch, created on demand
+
+        /// Delta checkpoint state: which file the last save went to, the
+        /// content hash of every organism record as of that save, and how
+        /// many delta segments have been appended since the last full base
+        /// segment (a rebase rewrites the file from scratch).
+        /// @{
+        std::string mDeltaFile;              ///< target of the last delta save
+        std::map<S32, uint64_t> mDeltaHashes;///< organism record hashes by genome id
+        uint32_t mDeltaSegments;             ///< delta segments since the last base
+        /// @}
     public:
         /// Constructor
         /// @param filename name of the file with the initial population genomes
@@ -104,6 +119,18 @@ namespace OpenNero
         /// Called every step by the OpenNERO system
         virtual void ProcessTick( float32_t incAmt );
 
+        /// Evaluate the networks of all organisms in one batched pass. Row i
+        /// of inputs is loaded into the sensors of the i'th organism in the
+        /// brain list and its network is activated; row i of outputs receives
+        /// the resulting output activations. The organisms are split into
+        /// contiguous chunks across a worker pool; the networks share no
+        /// state, so the chunks run without locking.
+        /// @param inputs one row of sensor values per organism
+        /// @param outputs resized and filled with one row of output values per organism
+        /// @return the number of networks that activated successfully
+        size_t evaluateBatch(const std::vector<FeatureVector>& inputs,
+                             std::vector<FeatureVector>& outputs);
+
         /// save the current population to a file
 		/// return the name of the file the population was saved to
 		std::string save_population(const std::string& population_file);
@@ -111,6 +138,12 @@ namespace OpenNero
         /// load a population from a file
         bool load_population(const std::string& population_file);
 
+        /// append the population to an open binary world snapshot stream
+        bool SaveSnapshot(std::ostream& out);
+
+        /// replace the population from a snapshot written by SaveSnapshot
+        bool RestoreSnapshot(std::istream& in);
+
         /// get the weight vector
         const FeatureVector& get_weights() const { return mFitnessWeights; }
 
@@ -133,6 +166,10 @@ namespace OpenNero
         /// @return the current population
         PopulationPtr get_population() { return mPopulation; }
 
+        /// renumber the innovations still in use densely (long realtime
+        /// runs leave the numbering sparse); returns how many are in use
+        size_t compact_innovations() { return mPopulation ? mPopulation->compact_innovations() : 0; }
+
         /// load info about this AI from the object template
         bool LoadFromTemplate( ObjectTemplatePtr objTemplate, const SimEntityData& data) { return true; }
 
@@ -148,9 +185,31 @@ namespace OpenNero
 		/// offspring
 		void evolveAll();
 
+		/// batched evolution step: replace up to count organisms in one
+		/// pass, with a single species fitness estimate and at most one
+		/// speciation sweep for the whole batch
+		void evolveBatch(size_t count);
+
 		/// Delete the unit which is currently associated with the specified
 		/// brain and move the brain back to waiting list.
 		void deleteUnit(PyOrganismPtr brain);
+
+        /// evaluate the organisms in rows [begin, end) for evaluateBatch
+        void evaluateRange(const std::vector<FeatureVector>* inputs,
+                           std::vector<FeatureVector>* outputs,
+                           size_t begin, size_t end, size_t* num_activated);
+
+        /// Save the population as a delta checkpoint: a full base segment
+        /// on the first save (and on periodic rebases), then per-save
+        /// segments holding only the organisms whose serialized record
+        /// changed since the last save, plus tombstones for removed ones.
+        /// Consecutive generational checkpoints share most of their genome
+        /// content, so the appended segments are a fraction of a full save.
+        std::string save_population_delta(const std::string& population_file);
+
+        /// load a population from a delta checkpoint file (base segment
+        /// plus any appended deltas)
+        bool load_population_delta(const std::string& population_file);
     };
 
     /// A Python wrapper for the Network class with a simple interface for forward prop
@@ -191,10 +250,44 @@ namespace OpenNero
         /// get output values from the network
         py::list get_outputs();
 
+        /// Zero-copy views of the compiled network, as read-only
+        /// memoryviews over the C++ arrays (no serialization or copying).
+        /// Rows follow the network's node order; the incoming links of
+        /// row i occupy [starts[i], starts[i+1]) of the link arrays.
+        /// Each view is raw bytes -- reinterpret it on the Python side
+        /// (e.g. numpy.frombuffer) with the documented dtype. Views stay
+        /// valid only until the network is next rebuilt or its organism
+        /// replaced, so copy them before evolving further. All return
+        /// None for nets the flat representation cannot handle
+        /// (adaptable nets and nets with time-delayed connections).
+        /// @{
+        py::object get_weight_view();      ///< float64 weight per link
+        py::object get_link_source_view(); ///< uintp source row per link
+        py::object get_link_start_view();  ///< uintp CSR offsets, one per node plus one
+        py::object get_node_id_view();     ///< int32 genome node id per row
+        py::object get_node_place_view();  ///< int32 place per row: 0=hidden 1=input 2=output 3=bias
+        py::object get_activation_view();  ///< float64 current activation per row
+        /// @}
+
+        /// the wrapped NEAT network
+        NetworkPtr GetNetwork() const { return mNetwork; }
+
         /// operator to push to an output stream
         friend std::ostream& operator<<(std::ostream& output, const PyNetwork& net);
     };
 
+    /// Batched inference over a whole population of networks in one call:
+    /// load each row of sensor values into the matching network, activate
+    /// every network in parallel on the shared task pool, and return one
+    /// list of output values per network. One Python crossing replaces the
+    /// per-agent load_sensors/activate/get_outputs round trips, and the
+    /// activation sweeps — the dominant CPU cost at population scale — run
+    /// across all cores instead of one.
+    /// @param nets list of Network objects
+    /// @param sensor_rows one list of sensor values per network
+    /// @return one list of output activations per network
+    py::list activate_networks(py::list nets, py::list sensor_rows);
+
 
     /// A Python wrapper for the Organism class with a simple interface for fitness and network
     class PyOrganism
@@ -34,39 +34,49 @@ namespace OpenNero
     //! Decide if this sensor is interested in a particular object
     bool RadarSensor::process(SimEntityPtr source, SimEntityPtr target)
     {
-        if (observed)
-        {
-            observed = false;
-            value = 0;
-        }
         // the position of the source of the sensor
         Vector3f sourcePos = source->GetPosition();
-        
+
         // the position of the target
         Vector3f targetPos = target->GetPosition();
-        
-        // the vector from the 
+
+        // the vector from the
         Vector3f vecToTarget = targetPos - sourcePos;
         double distToTarget = vecToTarget.getLength();
         double myHeading = source->GetRotation().Z;
         double tgtAngle = RAD_2_DEG * atan2(vecToTarget.Y, vecToTarget.X); // [-180, 180]
         double yawToTarget = LockDegreesTo180(tgtAngle - myHeading);
+
+        accumulate(sourcePos, myHeading, distToTarget, yawToTarget);
+        return true;
+    }
+
+    //! Accumulate a candidate whose distance and relative yaw were already
+    //! computed (once per entity for all of the agent's radar sectors)
+    void RadarSensor::accumulate(const Vector3f& sourcePos, double myHeading,
+                                 double distToTarget, double yawToTarget)
+    {
+        if (observed)
+        {
+            observed = false;
+            value = 0;
+        }
         double pitchToTarget = 0; // TODO: for now
 
         // within radius
         bool within_range = (distToTarget <= radius);
-        
+
         // yaw within R-L angle bounds
         bool within_yaw = (leftbound >= yawToTarget && yawToTarget >= rightbound);
-        
+
         // yaw is within L-R angle bounds
-        bool within_reverse_yaw = 
-            (leftbound < rightbound && 
+        bool within_reverse_yaw =
+            (leftbound < rightbound &&
             (leftbound >= yawToTarget || rightbound <= yawToTarget));
-        
+
         // pitch is within B-T bounds
         bool within_pitch = (bottombound <= pitchToTarget && pitchToTarget <= topbound);
-        
+
         if (within_range && (within_yaw || within_reverse_yaw) && within_pitch)
         {
             if (distToTarget > 0) {
@@ -75,7 +85,6 @@ namespace OpenNero
                 value = 1;
             }
             if (vis) {
-                Vector3f r = source->GetRotation();
                 double h = DEG_2_RAD * myHeading;
                 double y = DEG_2_RAD * yawToTarget;
                 double lb = DEG_2_RAD * leftbound;
@@ -91,9 +100,8 @@ namespace OpenNero
                 LineSet::instance().AddSegment(sourcePos, rp, SColor(255,255,255,255));
             }
         }
-        return true;
     }
-    
+
     //! get the minimal possible observation
     double RadarSensor::getMin()
     {
@@ -68,9 +68,18 @@ namespace OpenNero
         //! get the maximum possible observation
         double getMax();
 
+        //! the radar only needs entities within its sector radius
+        double getRadius() const { return radius; }
+
         //! Process an object of interest
         bool process(SimEntityPtr source, SimEntityPtr target);
-        
+
+        //! Accumulate a candidate whose agent-frame transform (distance and
+        //! relative yaw in degrees) was already computed; SensorArray uses
+        //! this to share one transform pass between all of an agent's radars
+        void accumulate(const Vector3f& sourcePos, double myHeading,
+                        double distToTarget, double yawToTarget);
+
         //! Get the value computed for this sensor
         double getObservation(SimEntityPtr source);
 
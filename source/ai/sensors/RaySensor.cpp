@@ -1,12 +1,36 @@
 #include "ai/sensors/RaySensor.h"
 #include "core/IrrSerialize.h"
 #include "game/SimContext.h"
+#include "game/RayBatch.h"
+#include "render/LineSet.h"
 
 namespace OpenNero {
     RaySensor::RaySensor(double x, double y, double z, double radius, U32 types, bool vis) :
-        Sensor(1, types), x(x), y(y), z(z), radius(radius), vis(vis)
+        Sensor(1, types), x(x), y(y), z(z), radius(radius), vis(vis),
+        batch(NULL), batchIndex(0)
     {
     }
+
+    void RaySensor::getRayEndpoints(SimEntityPtr source, Vector3f& sourcePos, Vector3f& targetPos)
+    {
+        sourcePos = source->GetPosition();
+        Vector3f toTarget(x,y,z);
+        toTarget = ConvertNeroToIrrlichtPosition(toTarget);
+        Matrix4 rotation;
+        rotation.setRotationDegrees(ConvertNeroToIrrlichtRotation(source->GetRotation()));
+        rotation.rotateVect(toTarget);
+        toTarget = ConvertIrrlichtToNeroPosition(toTarget);
+        toTarget.setLength(radius);
+        targetPos = sourcePos + toTarget;
+    }
+
+    void RaySensor::queueRay(RayBatch& b, SimEntityPtr source)
+    {
+        Vector3f sourcePos, targetPos;
+        getRayEndpoints(source, sourcePos, targetPos);
+        batch = &b;
+        batchIndex = b.AddRequest(sourcePos, targetPos, getTypes());
+    }
     
     RaySensor::~RaySensor() {}
 
@@ -19,18 +43,37 @@ namespace OpenNero {
     //! Get the value computed for this sensor given the filtered objects
     double RaySensor::getObservation(SimEntityPtr source)
     {
-        SimEntityData hitEntity;
+        Vector3f sourcePos, targetPos;
+        getRayEndpoints(source, sourcePos, targetPos);
+
+        bool found = false;
         Vector3f hitPos;
-        Vector3f sourcePos(source->GetPosition());
-        Vector3f toTarget(x,y,z);
-        toTarget = ConvertNeroToIrrlichtPosition(toTarget);
-        Matrix4 rotation;
-        rotation.setRotationDegrees(ConvertNeroToIrrlichtRotation(source->GetRotation()));
-        rotation.rotateVect(toTarget);
-        toTarget = ConvertIrrlichtToNeroPosition(toTarget);
-        toTarget.setLength(radius);
-        Vector3f targetPos = sourcePos + toTarget;
-        if (Kernel::GetSimContext()->FindInRay(hitEntity, hitPos, sourcePos, targetPos, getTypes(), vis))
+        if (batch)
+        {
+            // consume the result cast for us before the AI phase
+            const RayBatch::Result& result = batch->GetResult(batchIndex);
+            batch = NULL;
+            if (result.mHit && result.mNodeId >= kFirstSimId
+                && Kernel::GetSimContext()->getSimulation()->FindBySceneObjectId(result.mNodeId))
+            {
+                found = true;
+                hitPos = result.mHitPos;
+            }
+            if (vis)
+            {
+                if (found)
+                    LineSet::instance().AddSegment(sourcePos, hitPos, SColor(255,255,0,0));
+                else
+                    LineSet::instance().AddSegment(sourcePos, targetPos, SColor(255,255,255,0));
+            }
+        }
+        else
+        {
+            // no batched cast was queued; fall back to an individual query
+            SimEntityData hitEntity;
+            found = Kernel::GetSimContext()->FindInRay(hitEntity, hitPos, sourcePos, targetPos, getTypes(), vis);
+        }
+        if (found)
         {
             Vector3f toHit = hitPos - sourcePos;
             //return toHit.getLength()/radius;
@@ -25,9 +25,18 @@ namespace OpenNero
 
         //! whether or not the sensor is displayed on screen
         bool vis;
-        
+
+        //! the batch holding this tick's queued cast (NULL if none queued)
+        RayBatch* batch;
+
+        //! the index of this tick's queued cast in the batch
+        size_t batchIndex;
+
+        //! compute the endpoints of the cast for the current source pose
+        void getRayEndpoints(SimEntityPtr source, Vector3f& sourcePos, Vector3f& targetPos);
+
     public:
-        RaySensor() : Sensor(1,0), x(0), y(0), z(0), radius(0), vis(false) {}
+        RaySensor() : Sensor(1,0), x(0), y(0), z(0), radius(0), vis(false), batch(NULL), batchIndex(0) {}
     
         //! Create a new RaySensor
         //! @param x x-direction of the ray
@@ -46,6 +55,9 @@ namespace OpenNero
         //! get the maximum possible observation
         double getMax() { return radius; }
 
+        //! Queue this sensor's cast into the tick's ray batch
+        void queueRay(RayBatch& batch, SimEntityPtr source);
+
         //! Process an object of interest
         bool process(SimEntityPtr source, SimEntityPtr target);
         
@@ -10,7 +10,8 @@
 
 namespace OpenNero
 {
-    
+    class RayBatch;
+
     /// @cond
     BOOST_SHARED_DECL(Sensor);
     BOOST_SHARED_DECL(PySensor);
@@ -48,12 +49,21 @@ namespace OpenNero
         //! Get the types of objects this sensor needs to look at
         U32 getTypes() const { return types; }
 
+        //! The region of interest of this sensor, as a radius around its
+        //! source; sensors that return a positive radius are fed from the
+        //! simulation's spatial index instead of a scan over all entities
+        virtual double getRadius() const { return 0; }
+
         //! get the minimal possible observation
         virtual double getMin() = 0;
         
         //! get the maximum possible observation
         virtual double getMax() = 0;
 
+        //! Queue any ray casts this sensor needs for the coming tick; the
+        //! batched results are delivered before getObservation is called
+        virtual void queueRay(RayBatch& batch, SimEntityPtr source) {}
+
         //! Process an object of interest
         virtual bool process(SimEntityPtr source, SimEntityPtr target) = 0;
         
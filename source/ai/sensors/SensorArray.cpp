@@ -1,31 +1,161 @@
 #include "core/Common.h"
 #include "game/Kernel.h"
 #include "ai/sensors/SensorArray.h"
+#include "ai/sensors/RadarSensor.h"
 #include "game/SimContext.h"
 
 namespace OpenNero
 {
+    namespace
+    {
+        /// entity visitor that feeds each visited entity to every unbounded
+        /// sensor that is due for a refresh and whose type mask matches it
+        struct UnboundedSensorFeed
+        {
+            std::vector<SensorPtr>& sensors;    ///< the sensors to feed
+            const std::vector<U8>& due;         ///< which sensors refresh this tick
+            SimEntityPtr source;                ///< the sensing entity
+
+            UnboundedSensorFeed(std::vector<SensorPtr>& sensors, const std::vector<U8>& due, SimEntityPtr source)
+                : sensors(sensors), due(due), source(source) {}
+
+            /// process one visited entity
+            void operator()(SimEntityPtr ent)
+            {
+                const uint32_t entTypes = ent->GetType();
+                for (size_t i = 0; i < sensors.size(); ++i)
+                {
+                    if (due[i] && sensors[i]->getRadius() <= 0 && (sensors[i]->getTypes() & entTypes))
+                    {
+                        sensors[i]->process(source, ent);
+                    }
+                }
+            }
+        };
+    }
+
     size_t SensorArray::addSensor(SensorPtr sensor)
     {
         sensors.push_back(sensor);
+        mCachedValues.push_back(0);
+        // start the counter at the refresh period so the first
+        // getObservations computes a real value instead of the cache
+        mTicksSinceUpdate.push_back(sensor->getTicks());
+        mDue.push_back(1);
+        mIsRadar.push_back(dynamic_cast<RadarSensor*>(sensor.get()) != NULL);
         return sensors.size() - 1;
     }
 
     void SensorArray::getObservations(Observations& observations)
     {
-        std::vector<SensorPtr>::iterator sensIter;
-        size_t i = 0;
-        for (sensIter = sensors.begin(); sensIter != sensors.end(); ++sensIter) 
+        SimulationPtr sim = Kernel::instance().GetSimContext()->getSimulation();
+
+        // advance the staleness counters and decide which sensors refresh
+        // this tick; a sensor with getTicks() = n recomputes every n-th
+        // call and serves its cached value in between
+        const size_t count = sensors.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++mTicksSinceUpdate[i];
+            U32 period = sensors[i]->getTicks();
+            if (period < 1)
+                period = 1;
+            mDue[i] = mTicksSinceUpdate[i] >= period;
+        }
+
+        // union the type masks of the due unbounded sensors so the entity
+        // scan happens once per agent per tick instead of once per sensor
+        uint32_t combinedTypes = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (mDue[i] && sensors[i]->getRadius() <= 0)
+            {
+                combinedTypes |= sensors[i]->getTypes();
+            }
+        }
+        if (combinedTypes != 0)
+        {
+            UnboundedSensorFeed feed(sensors, mDue, GetEntity());
+            sim->ForEachEntity(combinedTypes, feed);
+        }
+
+        // all of this agent's due radar sectors share one pass over the
+        // nearby entities: the agent-frame transform (distance and relative
+        // yaw) is computed once per candidate and binned into every sector,
+        // instead of redoing the trig once per sector per candidate
+        mDueRadars.clear();
+        double radarRadius = 0;
+        uint32_t radarTypes = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (mDue[i] && mIsRadar[i] && sensors[i]->getRadius() > 0)
+            {
+                mDueRadars.push_back(static_cast<RadarSensor*>(sensors[i].get()));
+                radarRadius = std::max(radarRadius, sensors[i]->getRadius());
+                radarTypes |= sensors[i]->getTypes();
+            }
+        }
+        if (!mDueRadars.empty())
+        {
+            const Vector3f sourcePos = GetEntity()->GetPosition();
+            const double myHeading = GetEntity()->GetRotation().Z;
+            mQueryResults.clear();
+            sim->QueryRadius(sourcePos, static_cast<float32_t>(radarRadius),
+                             radarTypes, mQueryResults);
+            SimEntityList::const_iterator entIter;
+            for (entIter = mQueryResults.begin(); entIter != mQueryResults.end(); ++entIter)
+            {
+                const uint32_t entTypes = (*entIter)->GetType();
+                Vector3f vecToTarget = (*entIter)->GetPosition() - sourcePos;
+                double distToTarget = vecToTarget.getLength();
+                double tgtAngle = RAD_2_DEG * atan2(vecToTarget.Y, vecToTarget.X); // [-180, 180]
+                double yawToTarget = LockDegreesTo180(tgtAngle - myHeading);
+                for (size_t r = 0; r < mDueRadars.size(); ++r)
+                {
+                    if (mDueRadars[r]->getTypes() & entTypes)
+                    {
+                        mDueRadars[r]->accumulate(sourcePos, myHeading, distToTarget, yawToTarget);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i)
         {
             AssertMsg(i < observations.size(), "There are more built-in sensors than observations in AgentInitInfo");
-            SimEntitySet::const_iterator entIter;
-            const SimEntitySet entSet = Kernel::instance().GetSimContext()->getSimulation()->GetEntities((*sensIter)->getTypes());
-            for (entIter = entSet.begin(); entIter != entSet.end(); ++entIter) 
+            if (!mDue[i])
+            {
+                observations[i] = mCachedValues[i];
+                continue;
+            }
+            double radius = sensors[i]->getRadius();
+            if (radius > 0 && !mIsRadar[i]) // radars were fed by the shared pass above
             {
-                (*sensIter)->process(GetEntity(), (*entIter));
+                // bounded sensors only look at the entities near them
+                mQueryResults.clear();
+                sim->QueryRadius(GetEntity()->GetPosition(), static_cast<float32_t>(radius),
+                                 sensors[i]->getTypes(), mQueryResults);
+                SimEntityList::const_iterator entIter;
+                for (entIter = mQueryResults.begin(); entIter != mQueryResults.end(); ++entIter)
+                {
+                    sensors[i]->process(GetEntity(), (*entIter));
+                }
             }
-            observations[i] = (*sensIter)->getObservation(GetEntity());
-            i++;
+            mCachedValues[i] = sensors[i]->getObservation(GetEntity());
+            mTicksSinceUpdate[i] = 0;
+            observations[i] = mCachedValues[i];
+        }
+    }
+
+    void SensorArray::queueRays(RayBatch& batch)
+    {
+        for (size_t i = 0; i < sensors.size(); ++i)
+        {
+            // skip the ray work of sensors that will serve a cached value
+            U32 period = sensors[i]->getTicks();
+            if (period > 1 && mTicksSinceUpdate[i] + 1 < period)
+                continue;
+            sensors[i]->queueRay(batch, GetEntity());
         }
     }
 
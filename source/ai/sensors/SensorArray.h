@@ -9,17 +9,32 @@
 
 namespace OpenNero {
 
+    class RayBatch;
+    class RadarSensor;
+
     BOOST_SHARED_DECL(SensorArray);
     
     class SensorArray 
         : public SimEntityComponent
     {
         std::vector<SensorPtr> sensors;
+        SimEntityList mQueryResults; ///< reused buffer for spatial index queries
+        std::vector<double> mCachedValues; ///< last computed observation per sensor
+        std::vector<U32> mTicksSinceUpdate; ///< ticks since each sensor was recomputed
+        std::vector<U8> mDue; ///< per-sensor "refresh this tick" flags (reused buffer)
+        std::vector<U8> mIsRadar; ///< which sensors are radar sectors (decided at addSensor)
+        std::vector<RadarSensor*> mDueRadars; ///< radars sharing this tick's transform pass (reused buffer)
     public:
         explicit SensorArray(SimEntityPtr parent) : SimEntityComponent(parent) {}
         size_t getNumSensors() { return sensors.size(); }
         size_t addSensor(SensorPtr sensor);
         void getObservations(Observations& observations);
+        /// queue this tick's ray casts for all sensors that need them
+        void queueRays(RayBatch& batch);
+        /// ticks since each sensor's value was last recomputed (0 = fresh
+        /// this tick); sensors with getTicks() > 1 serve cached values on
+        /// the ticks in between
+        const std::vector<U32>& getStaleness() const { return mTicksSinceUpdate; }
         friend std::ostream& operator<<(std::ostream& out, const SensorArray& sa);
     };
 
@@ -7,6 +7,10 @@
 #define _CORE_ALGORITHM_H_
 
 #include <algorithm>
+#include <vector>
+#include <cstddef>
+
+#include "core/TaskPool.h"
 
 namespace OpenNero
 {
@@ -52,6 +56,131 @@ namespace OpenNero
         return true;
     }
 
+    namespace detail
+    {
+        /// one contiguous chunk of a ParallelFor range, packaged as the
+        /// nullary task the pool expects
+        template <typename Body>
+        struct ParallelForChunk
+        {
+            Body* body;       ///< the per-index callable (owned by the caller)
+            size_t lo;        ///< first index of the chunk
+            size_t hi;        ///< one past the last index of the chunk
+
+            ParallelForChunk( Body& b, size_t l, size_t h )
+                : body(&b), lo(l), hi(h) {}
+
+            void operator()() const
+            {
+                for( size_t i = lo; i < hi; ++i )
+                    (*body)(i);
+            }
+        };
+    }
+
+    /// Run body(i) for every index in [begin, end) on the given task pool.
+    /// The range is split into contiguous chunks of at least grain indices,
+    /// so tiny per-index bodies amortize the dispatch cost and neighbouring
+    /// indices stay on one core. Blocks until the whole range is done; runs
+    /// inline on the caller when the range is not worth dispatching. The
+    /// body must be safe to run off the main thread (in particular, it must
+    /// not touch the Python interpreter) and outlive the call.
+    /// @param pool the worker pool to dispatch on
+    /// @param begin first index of the range
+    /// @param end one past the last index of the range
+    /// @param grain smallest number of indices worth a task of its own
+    /// @param body a callable taking a size_t index
+    template <typename Body>
+    void ParallelFor( TaskPool& pool, size_t begin, size_t end, size_t grain, Body& body )
+    {
+        if( end <= begin )
+            return;
+        if( grain == 0 )
+            grain = 1;
+        const size_t count = end - begin;
+        if( pool.GetWorkerCount() == 0 || count <= grain )
+        {
+            for( size_t i = begin; i < end; ++i )
+                body(i);
+            return;
+        }
+        for( size_t lo = begin; lo < end; lo += grain )
+        {
+            const size_t hi = std::min(end, lo + grain);
+            pool.Submit(detail::ParallelForChunk<Body>(body, lo, hi));
+        }
+        pool.WaitAll();
+    }
+
+    /**
+     * A per-thread bump allocator for short-lived scratch storage inside
+     * parallel bodies. Memory is carved sequentially out of blocks that
+     * persist for the life of the thread, so repeated uses stop hitting
+     * the global heap, and Reset releases everything in one step while
+     * keeping the largest block for the next use. Nothing is constructed
+     * or destructed — plain-old-data only.
+     */
+    class ScratchArena
+    {
+    public:
+        /// default size of a freshly grown block
+        static const size_t kDefaultBlockBytes = 64 * 1024;
+
+        ScratchArena() : mUsed(0) {}
+
+        /// the calling thread's arena
+        static ScratchArena& OfThread()
+        {
+            static thread_local ScratchArena arena;
+            return arena;
+        }
+
+        /// reserve bytes of uninitialized storage; the pointer stays valid
+        /// until the next Reset
+        void* Allocate( size_t bytes )
+        {
+            // keep every allocation 16-byte aligned
+            bytes = (bytes + 15) & ~(size_t)15;
+            if( mBlocks.empty() || mUsed + bytes > mBlocks.back().size() )
+            {
+                mBlocks.push_back(std::vector<unsigned char>());
+                mBlocks.back().resize(bytes > kDefaultBlockBytes ? bytes : (size_t)kDefaultBlockBytes);
+                mUsed = 0;
+            }
+            void* result = &mBlocks.back()[mUsed];
+            mUsed += bytes;
+            return result;
+        }
+
+        /// typed form of Allocate for arrays of plain-old-data
+        template <typename T>
+        T* AllocateArray( size_t count )
+        {
+            return static_cast<T*>(Allocate(count * sizeof(T)));
+        }
+
+        /// release everything, keeping only the largest block
+        void Reset()
+        {
+            if( mBlocks.size() > 1 )
+            {
+                std::vector<unsigned char> largest;
+                for( size_t i = 0; i < mBlocks.size(); ++i )
+                {
+                    if( mBlocks[i].size() > largest.size() )
+                        largest.swap(mBlocks[i]);
+                }
+                mBlocks.clear();
+                mBlocks.push_back(std::vector<unsigned char>());
+                mBlocks.back().swap(largest);
+            }
+            mUsed = 0;
+        }
+
+    private:
+        std::vector< std::vector<unsigned char> > mBlocks; ///< the backing blocks
+        size_t mUsed;                                      ///< bytes used in the last block
+    };
 
 } // end OpenNero
 
@@ -6,6 +6,66 @@
 #include "core/Common.h"
 #include "BitVector.h"
 
+namespace
+{
+	using namespace OpenNero;
+
+	/// count the set bits of a 64-bit word (hardware popcount where available)
+	uint32_t PopCount64( uint64_t word )
+	{
+#if defined( __GNUC__ )
+		return (uint32_t)__builtin_popcountll( word );
+#else
+		uint32_t count = 0;
+		while( word )
+		{
+			word &= word - 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	/// index of the lowest set bit of a non-zero byte
+	uint32_t FirstSetInByte( uint8_t byte )
+	{
+#if defined( __GNUC__ )
+		return (uint32_t)__builtin_ctz( byte );
+#else
+		uint32_t slot = 0;
+		while( !(byte & 0x01) )
+		{
+			byte >>= 1;
+			++slot;
+		}
+		return slot;
+#endif
+	}
+
+	struct AndOp { uint64_t operator()( uint64_t a, uint64_t b ) const { return a & b; } };
+	struct OrOp  { uint64_t operator()( uint64_t a, uint64_t b ) const { return a | b; } };
+	struct XorOp { uint64_t operator()( uint64_t a, uint64_t b ) const { return a ^ b; } };
+
+	/// apply a binary operation to count bytes of dst, eight bytes per step
+	template <typename Op>
+	void ApplyWordOp( uint8_t* dst, const uint8_t* src, size_t count, Op op )
+	{
+		size_t i = 0;
+		for( ; i + 8 <= count; i += 8 )
+		{
+			uint64_t a, b;
+			memcpy( &a, dst + i, 8 );
+			memcpy( &b, src + i, 8 );
+			a = op( a, b );
+			memcpy( dst + i, &a, 8 );
+		}
+		for( ; i < count; ++i )
+		{
+			dst[i] = (uint8_t)op( dst[i], src[i] );
+		}
+	}
+}
+
 namespace OpenNero
 {
 	/// bit masks
@@ -123,6 +183,136 @@ namespace OpenNero
 		return ( (mBitString[kBitWord] & skMasks[kBitSlot]) != 0 );		
 	}
 
+	/**
+	 * Bitwise-and this vector with another. Any of our bits past the end
+	 * of v are cleared, as if v were zero-extended to our length.
+	 * @param v the vector to and with
+	 * @return reference to this vector
+    */
+	BitVector& BitVector::operator&=( const BitVector& v )
+	{
+		const size_t kCommon = std::min( mBitString.size(), v.mBitString.size() );
+		if( kCommon > 0 )
+		{
+			ApplyWordOp( &mBitString[0], &v.mBitString[0], kCommon, AndOp() );
+		}
+		if( kCommon < mBitString.size() )
+		{
+			memset( &mBitString[kCommon], 0, mBitString.size() - kCommon );
+		}
+		return *this;
+	}
+
+	/**
+	 * Bitwise-or this vector with another, growing to fit it if needed.
+	 * @param v the vector to or with
+	 * @return reference to this vector
+    */
+	BitVector& BitVector::operator|=( const BitVector& v )
+	{
+		if( v.mBitString.size() > mBitString.size() )
+			Resize( (uint32_t)v.mBitString.size() );
+
+		if( v.mBitString.size() > 0 )
+		{
+			ApplyWordOp( &mBitString[0], &v.mBitString[0], v.mBitString.size(), OrOp() );
+		}
+		return *this;
+	}
+
+	/**
+	 * Bitwise-xor this vector with another, growing to fit it if needed.
+	 * @param v the vector to xor with
+	 * @return reference to this vector
+    */
+	BitVector& BitVector::operator^=( const BitVector& v )
+	{
+		if( v.mBitString.size() > mBitString.size() )
+			Resize( (uint32_t)v.mBitString.size() );
+
+		if( v.mBitString.size() > 0 )
+		{
+			ApplyWordOp( &mBitString[0], &v.mBitString[0], v.mBitString.size(), XorOp() );
+		}
+		return *this;
+	}
+
+	/**
+	 * Count the set bits in the whole vector, a word at a time.
+	 * @return the number of bits that are on
+    */
+	uint32_t BitVector::CountSetBits() const
+	{
+		uint32_t count = 0;
+		size_t i = 0;
+		for( ; i + 8 <= mBitString.size(); i += 8 )
+		{
+			uint64_t word;
+			memcpy( &word, &mBitString[i], 8 );
+			count += PopCount64( word );
+		}
+		for( ; i < mBitString.size(); ++i )
+		{
+			count += PopCount64( mBitString[i] );
+		}
+		return count;
+	}
+
+	/**
+	 * Find the lowest set bit in the vector.
+	 * @return the index of the first set bit, or -1 if all bits are off
+    */
+	int32_t BitVector::FindFirstSet() const
+	{
+		return FindFirstSetFromByte(0);
+	}
+
+	/**
+	 * Find the lowest set bit at or after a given position. Iterating the
+	 * set bits is FindFirstSet followed by FindNextSet(prev+1) until -1.
+	 * @param fromBit the first bit index to consider
+	 * @return the index of the next set bit, or -1 if none remain
+    */
+	int32_t BitVector::FindNextSet( uint32_t fromBit ) const
+	{
+		const uint32_t kBitWord = fromBit >> 3;
+		const uint32_t kBitSlot = fromBit & 0x7;
+
+		if( kBitWord >= mBitString.size() )
+			return -1;
+
+		// the first byte may be only partially in range
+		const uint8_t masked = (uint8_t)( mBitString[kBitWord] & (0xFF << kBitSlot) );
+		if( masked )
+			return (int32_t)( (kBitWord << 3) + FirstSetInByte(masked) );
+
+		return FindFirstSetFromByte( kBitWord + 1 );
+	}
+
+	/**
+	 * Find the lowest set bit in the bytes from byteIndex on, scanning a
+	 * word at a time for a non-zero chunk.
+	 * @param byteIndex the first byte to consider
+	 * @return the index of the first set bit, or -1 if none remain
+    */
+	int32_t BitVector::FindFirstSetFromByte( uint32_t byteIndex ) const
+	{
+		size_t i = byteIndex;
+		for( ; i + 8 <= mBitString.size(); i += 8 )
+		{
+			uint64_t word;
+			memcpy( &word, &mBitString[i], 8 );
+			if( word )
+				break;
+		}
+		for( ; i < mBitString.size(); ++i )
+		{
+			if( mBitString[i] )
+				return (int32_t)( (i << 3) + FirstSetInByte(mBitString[i]) );
+		}
+		return -1;
+	}
+
 	/*
 	 * Returns a stream of bytes that represents the bit vector
 	 * @return byte stream
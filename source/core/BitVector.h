@@ -49,6 +49,25 @@ namespace OpenNero
 		/// get the value of a given bit
 		bool Get( uint32_t bitIndex ) const;
 
+		/// bitwise-and with another vector; bits past the end of v read as zero
+		BitVector& operator&=( const BitVector& v );
+
+		/// bitwise-or with another vector, growing to fit it
+		BitVector& operator|=( const BitVector& v );
+
+		/// bitwise-xor with another vector, growing to fit it
+		BitVector& operator^=( const BitVector& v );
+
+		/// count the set bits in the whole vector
+		uint32_t CountSetBits() const;
+
+		/// get the index of the first set bit, or -1 if no bit is set
+		int32_t FindFirstSet() const;
+
+		/// get the index of the first set bit at or after fromBit, or -1;
+		/// combine with FindFirstSet to iterate over the set bits
+		int32_t FindNextSet( uint32_t fromBit ) const;
+
 		// get the stream of bits
 		// const std::vector<uint8_t> GetBitstream() const;
 
@@ -60,6 +79,9 @@ namespace OpenNero
 		// set a given bit with a val (0/1)
 		void SetVal( uint32_t bitIndex, bool val );
 
+		// get the index of the first set bit in bytes [byteIndex, size), or -1
+		int32_t FindFirstSetFromByte( uint32_t byteIndex ) const;
+
 		/// resize the vector to a new size
 		void Resize( uint32_t newSize );
 
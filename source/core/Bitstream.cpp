@@ -7,6 +7,8 @@
 #include "Bitstream.h"
 #include "Error.h"
 
+#include <atomic>
+
 namespace OpenNero
 {
     using namespace std;
@@ -117,6 +119,69 @@ namespace OpenNero
 	{
 		mStream.push_back(b);
 		Assert( !IsEmpty() );
+		TrackPeak();
+	}
+
+	/**
+	 * Push a run of bytes into our stream with a single append rather
+	 * than one PushByte per byte
+	 * @param bytes the first byte of the run
+	 * @param count the number of bytes to push
+	*/
+	void Bitstream::PushBytes( const uint8_t* bytes, uint32_t count )
+	{
+		if( count > 0 )
+		{
+			Assert( bytes );
+			mStream.insert( mStream.end(), bytes, bytes + count );
+			TrackPeak();
+		}
+	}
+
+	/**
+	 * Gather-write several byte runs into our stream, reserving the total
+	 * size up front so the whole batch costs at most one allocation
+	 * @param spans the runs to push, in order
+	 * @param count the number of runs
+	*/
+	void Bitstream::PushSpans( const ByteSpan* spans, uint32_t count )
+	{
+		size_t total = 0;
+		for( uint32_t i = 0; i < count; ++i )
+			total += spans[i].size;
+
+		mStream.reserve( mStream.size() + total );
+
+		for( uint32_t i = 0; i < count; ++i )
+			PushBytes( spans[i].data, spans[i].size );
+	}
+
+	namespace
+	{
+		// process-wide high-water mark of Bitstream byte lengths; streams
+		// are built on several threads (recording, log flushing), so the
+		// counter is atomic
+		std::atomic<uint32_t> sPeakBytes(0);
+	}
+
+	/**
+	 * The largest byte length any Bitstream has reached in this process;
+	 * a proxy for the biggest payload the streaming layer has to buffer
+	 * @return the high-water mark in bytes
+	*/
+	uint32_t Bitstream::PeakBytes()
+	{
+		return sPeakBytes.load();
+	}
+
+	/// bump the process-wide high-water mark after a push
+	void Bitstream::TrackPeak()
+	{
+		uint32_t size = (uint32_t)mStream.size();
+		uint32_t peak = sPeakBytes.load();
+		while( size > peak && !sPeakBytes.compare_exchange_weak( peak, size ) )
+		{
+		}
 	}
 
     ostream& operator<<( ostream& os, const Bitstream& bitstream)
@@ -191,12 +256,11 @@ namespace OpenNero
 	/// move a stream into the stream
     Bitstream& operator<<( Bitstream& stream, const Bitstream& rhs )
     {
-        std::vector<uint8_t>::const_iterator itr     = rhs.mStream.begin();
-        std::vector<uint8_t>::const_iterator end     = rhs.mStream.end();
+        if( rhs.mStream.size() > 0 )
+        {
+            stream.PushBytes( &rhs.mStream[0], (uint32_t)rhs.mStream.size() );
+        }
 
-        for( ; itr != end; ++itr )
-            stream << *itr;
-        
         return stream;
     }
 
@@ -323,4 +387,188 @@ namespace OpenNero
         return stream;
     }
 
+	//-------------- NON-OWNING VIEWS ------------------
+
+	/// Default constructor - an empty view
+	BitstreamView::BitstreamView() : mData(0), mSize(0), mFront(0) {}
+
+	/// View an existing buffer without copying it
+	BitstreamView::BitstreamView( const uint8_t* stream, uint32_t streamSize ) :
+		mData(stream),
+		mSize(streamSize),
+		mFront(0)
+	{}
+
+	/// View the unread bytes of an owning stream
+	BitstreamView::BitstreamView( const Bitstream& stream ) :
+		mData( stream.ByteLength() > 0 ? stream.Stream() : 0 ),
+		mSize( stream.ByteLength() ),
+		mFront(0)
+	{}
+
+	/**
+	 * Tells us if we have any bytes left to read
+	 * @return false if we have anything left in the view
+    */
+	bool BitstreamView::IsEmpty() const
+	{
+		return mFront >= mSize;
+	}
+
+	/// Returns the number of unread bytes in the view
+	uint32_t BitstreamView::ByteLength() const
+	{
+		return mSize - mFront;
+	}
+
+    /// Move the view back to the beginning
+    void BitstreamView::Rewind( uint32_t offset )
+    {
+        mFront = offset;
+        if( mFront > mSize )
+            mFront = mSize;
+    }
+
+	/// Returns a ptr to the first unread byte
+	const uint8_t* BitstreamView::Stream() const
+	{
+		return mData + mFront;
+	}
+
+	/**
+	 * Pop a byte off of the front of the view
+	 * @return the popped byte
+    */
+	uint8_t BitstreamView::PopByte()
+	{
+		Assert( !IsEmpty() );
+		return mData[mFront++];
+	}
+
+	/**
+	 * Copy a run of bytes out of the view with a single read
+	 * @param dest where to copy the bytes to
+	 * @param count the number of bytes to copy
+    */
+	void BitstreamView::PopBytes( uint8_t* dest, uint32_t count )
+	{
+		Assert( count <= ByteLength() );
+		if( count > 0 )
+		{
+			memcpy( dest, mData + mFront, count );
+			mFront += count;
+		}
+	}
+
+	/**
+	 * Borrow the next count bytes of the view without copying them;
+	 * the span stays valid as long as the viewed buffer does
+	 * @param count the number of bytes to borrow
+	 * @return a span over the borrowed bytes
+    */
+	ByteSpan BitstreamView::PopSpan( uint32_t count )
+	{
+		Assert( count <= ByteLength() );
+		ByteSpan span( mData + mFront, count );
+		mFront += count;
+		return span;
+	}
+
+	/// move a uint8_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, uint8_t& val)
+	{
+		Assert( !view.IsEmpty() );
+
+		val = view.PopByte();
+		return view;
+	}
+
+	/// move a uint16_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, uint16_t& val)
+	{
+		Assert( !view.IsEmpty() );
+
+		val = ( view.PopByte() << 8 ) +
+			  ( view.PopByte() << 0 );
+		return view;
+	}
+
+	/// move a uint32_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, uint32_t& val)
+	{
+		Assert( !view.IsEmpty() );
+
+		val = ( view.PopByte() << 24 ) +
+			  ( view.PopByte() << 16 ) +
+			  ( view.PopByte() <<  8 ) +
+			  ( view.PopByte() <<  0 );
+		return view;
+	}
+
+	/// move a int8_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, int8_t& val)
+	{
+		uint8_t uval;
+		view >> uval;
+		val = (uint8_t)uval;
+		return view;
+	}
+
+	/// move a int16_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, int16_t& val)
+	{
+		uint16_t uval;
+		view >> uval;
+		val = (uint16_t)uval;
+		return view;
+	}
+
+	/// move a int32_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, int32_t& val)
+	{
+		uint32_t uval;
+		view >> uval;
+		val = (uint32_t)uval;
+		return view;
+	}
+
+	/// move a float32_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, float32_t& val)
+	{
+		Assert( !view.IsEmpty() );
+
+		uint32_t uVal;
+		view >> uVal;
+		val = *(float32_t*)&uVal;
+
+		return view;
+	}
+
+	/// move a float64_t out of the view
+	BitstreamView& operator>>( BitstreamView& view, float64_t& val)
+	{
+		Assert( !view.IsEmpty() );
+
+		uint32_t uVals[2];
+		view >> uVals[0];
+		view >> uVals[1];
+
+		val = *(float64_t*)uVals;
+		return view;
+	}
+
+    // TODO: STL strings don't have to terminate on 0 character. ours do.
+    /// move a string out of a view
+    BitstreamView& operator>>( BitstreamView& view, std::string& val)
+    {
+        val.clear();
+        char c = static_cast<char>(view.PopByte());
+        while (c != '\0' && !view.IsEmpty())
+        {
+            val += c;
+            c = static_cast<char>(view.PopByte());
+        }
+        return view;
+    }
+
 } //end OpenNero
@@ -11,6 +11,17 @@
 
 namespace OpenNero
 {
+    /// a borrowed run of bytes for gather-writes into a Bitstream
+    struct ByteSpan
+    {
+        const uint8_t* data;    ///< first byte of the run (not owned)
+        uint32_t       size;    ///< number of bytes in the run
+
+        ByteSpan() : data(0), size(0) {}
+        /// make a span over an existing buffer
+        ByteSpan( const uint8_t* d, uint32_t s ) : data(d), size(s) {}
+    };
+
 	// TODO: Implement endianess for talking cross platform
     /// A stream that can be accessed at bit level
 	class Bitstream
@@ -56,8 +67,20 @@ namespace OpenNero
 		// push a byte into the front of the stream
 		inline void PushByte( uint8_t b );
 
+		// push a run of bytes into the stream in one append
+		void PushBytes( const uint8_t* bytes, uint32_t count );
+
+		// gather-write several byte runs into the stream with one allocation
+		void PushSpans( const ByteSpan* spans, uint32_t count );
+
+		// the largest byte length any Bitstream has reached in this process
+		static uint32_t PeakBytes();
+
 	private:
 
+		// bump the process-wide high-water mark after a push
+		void TrackPeak();
+
 		// we need access to the array stream, hence we did
 		// not used std::queue, but simulated with vector
 
@@ -66,6 +89,49 @@ namespace OpenNero
 
 	}; // end Bitstream
 
+    /// A non-owning read cursor over an existing byte buffer. Decoding
+    /// through a view touches the source bytes in place, so unpacking a
+    /// recorded or received payload does not copy it into a Bitstream
+    /// first. The viewed buffer must outlive the view.
+    class BitstreamView
+    {
+
+    public:
+
+        BitstreamView();
+        BitstreamView( const uint8_t* stream, uint32_t streamSize );
+        /// view the bytes remaining in an owning stream
+        explicit BitstreamView( const Bitstream& stream );
+
+        // do we have anything left to read?
+        bool IsEmpty() const;
+
+        // returns the number of unread bytes
+        uint32_t ByteLength() const;
+
+        // rewind the view back to the beginning
+        void Rewind( uint32_t offset = 0 );
+
+        // returns a ptr to the first unread byte
+        const uint8_t* Stream() const;
+
+        // remove the byte at the front of the view
+        uint8_t PopByte();
+
+        // copy a run of bytes out of the view in one read
+        void PopBytes( uint8_t* dest, uint32_t count );
+
+        // borrow the next count bytes without copying them
+        ByteSpan PopSpan( uint32_t count );
+
+    private:
+
+        const uint8_t*  mData;  ///< the viewed buffer (not owned)
+        uint32_t        mSize;  ///< size of the viewed buffer in bytes
+        uint32_t        mFront; ///< the index of the front entry
+
+    }; // end BitstreamView
+
 	// convenience operators
 	Bitstream& operator<<( Bitstream& stream, const uint8_t& val);
 	Bitstream& operator<<( Bitstream& stream, const uint16_t& val);
@@ -88,6 +154,17 @@ namespace OpenNero
 	Bitstream& operator>>( Bitstream& stream, float64_t& val);
     Bitstream& operator>>( Bitstream& stream, std::string& val);
 
+	// decoding operators over a non-owning view
+	BitstreamView& operator>>( BitstreamView& view, uint8_t& val);
+	BitstreamView& operator>>( BitstreamView& view, uint16_t& val);
+	BitstreamView& operator>>( BitstreamView& view, uint32_t& val);
+	BitstreamView& operator>>( BitstreamView& view, int8_t& val);
+	BitstreamView& operator>>( BitstreamView& view, int16_t& val);
+	BitstreamView& operator>>( BitstreamView& view, int32_t& val);
+	BitstreamView& operator>>( BitstreamView& view, float32_t& val);
+	BitstreamView& operator>>( BitstreamView& view, float64_t& val);
+    BitstreamView& operator>>( BitstreamView& view, std::string& val);
+
     /// represent a stream on standard output
     std::ostream& operator<< (std::ostream& os, const Bitstream& bitstream);
 
@@ -135,6 +212,30 @@ namespace OpenNero
         return stream;
     }
 
+    /**
+     * Output the contents of a vector from a view, mirroring the Bitstream
+     * overload; the vector must have been written with << on a Bitstream
+     * @param view the view to move data out of
+     * @param buffer the vector to put the data in
+     * @return the resultant view
+    */
+    template <typename T>
+	BitstreamView& operator>>( BitstreamView& view, std::vector<T>& buffer )
+    {
+        uint32_t size;
+		view >> size;
+
+		if( size )
+		{
+			buffer.resize(size);
+
+			for( uint32_t i = 0; i < (uint32_t)buffer.size(); ++i )
+				view >> buffer[i];
+		}
+
+        return view;
+    }
+
     // utiltity functions for packing a stream of 1-6 parameters
 
     /// create a stream from 1 parameter
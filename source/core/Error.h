@@ -11,13 +11,28 @@
 #include "core/Preprocessor.h"
 #include "core/AssertExt.h"
 
-namespace OpenNero 
+namespace OpenNero
 {
-	namespace Log 
+	namespace Log
 	{
 		extern void LogWarning( const char* type,  const char* connectionName, const char* msg );
         extern void LogError( const char* type,  const char* connectionName, const char* msg );
 	}
+
+    /// decide whether this occurrence of a tiered verification check runs:
+    /// all of them at the full level, every NERO_VERIFY_SAMPLE_RATE-th one
+    /// at the sampled level, none at all when verification is off
+    inline bool ShouldVerify()
+    {
+#if NERO_VERIFY_LEVEL >= 2
+        return true;
+#elif NERO_VERIFY_LEVEL == 1
+        static unsigned long occurrence = 0;
+        return ( ++occurrence % NERO_VERIFY_SAMPLE_RATE ) == 0;
+#else
+        return false;
+#endif
+    }
 }
 
 // Assertions
@@ -46,4 +61,16 @@ namespace OpenNero
 
 #define AssertWarn( exp ) AssertWarnMsg( exp, "" )
 
+// Tiered verification for expensive invariants (see NERO_VERIFY_LEVEL in
+// Preprocessor.h). The expression is only evaluated when this occurrence
+// is selected, so sampled builds skip the cost of the check itself. A
+// failure is always logged; in debug builds it also raises an assert.
+#if NERO_VERIFY_LEVEL == 0
+    #define VerifyMsg( exp, msg ) do { } while(0)
+#else
+    #define VerifyMsg( exp, msg ) do { if( OpenNero::ShouldVerify() && !(exp) ) { std::stringstream str; str << "Verification Failure! [ " << __FILE__ << ":" << __LINE__ << " ] -> " << #exp << " - " << msg; OpenNero::Log::LogError(NULL,NULL,str.str().c_str()); AssertMsg( false, msg ); } } while(0)
+#endif
+
+#define Verify( exp ) VerifyMsg( exp, "" )
+
 #endif //end _OPENNERO_CORE_ERROR_H_
@@ -10,8 +10,103 @@
 #include <boost/filesystem.hpp>   // includes all needed Boost.Filesystem declarations
 namespace fs = boost::filesystem;
 
-namespace OpenNero 
-{   
+#if !NERO_PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OpenNero
+{
+    ReadOnlyFileView::ReadOnlyFileView( const std::string& filePathName, AccessPattern pattern )
+        : mData(NULL)
+        , mSize(0)
+        , mOpen(false)
+        , mMapped(false)
+    {
+#if !NERO_PLATFORM_WINDOWS
+        int fd = open(filePathName.c_str(), O_RDONLY);
+        if( fd >= 0 )
+        {
+            struct stat st;
+            if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) )
+            {
+                mOpen = true;
+                if( st.st_size == 0 )
+                {
+                    close(fd);
+                    return;
+                }
+                void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                close(fd); // the mapping keeps its own reference
+                if( data != MAP_FAILED )
+                {
+                    madvise(data, st.st_size,
+                            pattern == ACCESS_RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+                    mData = static_cast<const char*>(data);
+                    mSize = static_cast<size_t>(st.st_size);
+                    mMapped = true;
+                    return;
+                }
+                // mapping failed; fall through to the buffered read
+                mOpen = false;
+            }
+            else
+            {
+                close(fd);
+            }
+        }
+#endif
+        // platforms (or files) we cannot map still get a working view
+        std::ifstream inFile( filePathName.c_str(), std::ios::in | std::ios::binary );
+        if( !inFile )
+            return;
+        inFile.seekg(0, std::ios::end);
+        std::streampos size = inFile.tellg();
+        inFile.seekg(0, std::ios::beg);
+        if( size < 0 )
+            return;
+        mOpen = true;
+        if( size == std::streampos(0) )
+            return;
+        mBuffer.resize(static_cast<size_t>(size));
+        if( !inFile.read(&mBuffer[0], size) )
+        {
+            mOpen = false;
+            mBuffer.clear();
+            return;
+        }
+        mData = &mBuffer[0];
+        mSize = mBuffer.size();
+    }
+
+    ReadOnlyFileView::~ReadOnlyFileView()
+    {
+#if !NERO_PLATFORM_WINDOWS
+        if( mMapped )
+        {
+            munmap(const_cast<char*>(mData), mSize);
+        }
+#endif
+    }
+
+    FileViewInStream::ViewBuf::ViewBuf( const char* data, size_t size )
+    {
+        // the get area is read-only by construction, so the cast is safe
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+    FileViewInStream::FileViewInStream( const ReadOnlyFileView& view )
+        : std::istream(NULL)
+        , mBuf(view.Data(), view.Size())
+    {
+        rdbuf(&mBuf);
+        if( !view.IsOpen() )
+            setstate(std::ios::failbit);
+    }
+
     /**
      * Read the contents of a file into a string
      * @param filePath the absolute path to the file
@@ -19,26 +114,24 @@ namespace OpenNero
     */
     std::string ReadFileToString( const std::string& filePath )
     {
-        // try to open the file
-        std::ifstream inFile( filePath.c_str() );        
+        ReadOnlyFileView view( filePath );
 
         // did it work?
-        if( !inFile )
-            return "";		 
-
-        // read file into a stream
-        std::stringstream file;
-		char ch;
-        while (inFile.get(ch)) {
-			if (ch != '\r') { // fix a mac problem
-				file << ch;
-			}
-        }
+        if( !view.IsOpen() )
+            return "";
 
-        // close the file
-        inFile.close();
+        // copy out of the mapping, dropping '\r' (fix a mac problem)
+        std::string contents;
+        contents.reserve( view.Size() );
+        const char* itr = view.Data();
+        const char* end = itr + view.Size();
+        for( ; itr != end; ++itr )
+        {
+            if( *itr != '\r' )
+                contents += *itr;
+        }
 
-        return file.str();
+        return contents;
     }
 
     std::string ConvertNeroToSystemPath( const std::string& pathName )
@@ -59,6 +152,17 @@ namespace OpenNero
         return fs::exists(fs::path(filePathName));
     }
 
+    /// Check whether the first file was written at least as recently as
+    /// the second (both files must exist)
+    /// @param filePathName the file whose freshness is checked
+    /// @param otherPathName the file compared against
+    /// @return true if the first file is at least as new as the second
+    bool FileNewerThan( const std::string& filePathName, const std::string& otherPathName )
+    {
+        return fs::last_write_time(fs::path(filePathName))
+            >= fs::last_write_time(fs::path(otherPathName));
+    }
+
     /// Join two path elements
     std::string FilePathJoin( const std::string& p1, const std::string& p2 )
     {
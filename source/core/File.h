@@ -7,15 +7,83 @@
 #define _CORE_FILE_H_
 
 #include "Common.h"
+#include <istream>
+#include <vector>
 
-namespace OpenNero 
+namespace OpenNero
 {
+    /// A read-only view of a whole file's contents. On POSIX platforms the
+    /// file is memory-mapped, so pages stream straight from the page cache
+    /// on demand instead of being copied through buffered reads first; on
+    /// other platforms the contents are read into an internal buffer. The
+    /// pointer returned by Data() is valid for the lifetime of the view.
+    class ReadOnlyFileView
+    {
+    public:
+        /// how the caller intends to walk the contents (kernel readahead hint)
+        enum AccessPattern
+        {
+            ACCESS_SEQUENTIAL,  ///< one front-to-back pass (parsers, archives)
+            ACCESS_RANDOM       ///< scattered lookups and seeks
+        };
+
+        /// open a view of the file's contents (empty view on failure)
+        /// @param filePathName path of the file to view
+        /// @param pattern expected access pattern for readahead
+        explicit ReadOnlyFileView( const std::string& filePathName,
+                                   AccessPattern pattern = ACCESS_SEQUENTIAL );
+        ~ReadOnlyFileView();
+
+        /// could the file be opened? (an existing empty file counts as open)
+        bool IsOpen() const { return mOpen; }
+
+        /// first byte of the contents (NULL if not open or the file is empty)
+        const char* Data() const { return mData; }
+
+        /// size of the contents in bytes
+        size_t Size() const { return mSize; }
+
+    private:
+        // the view owns an OS mapping, so it cannot be copied
+        ReadOnlyFileView( const ReadOnlyFileView& );
+        ReadOnlyFileView& operator=( const ReadOnlyFileView& );
+
+        const char*         mData;      ///< start of the file contents
+        size_t              mSize;      ///< byte size of the contents
+        bool                mOpen;      ///< whether the file could be opened
+        bool                mMapped;    ///< whether mData is a memory mapping
+        std::vector<char>   mBuffer;    ///< fallback storage when not mapped
+    };
+
+    /// An input stream whose get area is a ReadOnlyFileView's contents, so
+    /// stream extraction reads the mapping directly with no intermediate
+    /// copy. The view must outlive the stream.
+    class FileViewInStream : public std::istream
+    {
+    public:
+        /// @param view the file view to read from
+        explicit FileViewInStream( const ReadOnlyFileView& view );
+
+    private:
+        /// a read-only stream buffer over an existing memory range
+        class ViewBuf : public std::streambuf
+        {
+        public:
+            ViewBuf( const char* data, size_t size );
+        };
+
+        ViewBuf mBuf;   ///< buffer pointing into the view
+    };
+
     /// Read the contents of a file into a string
     std::string ReadFileToString( const std::string& filePath );	
 
     /// Check for the existence of a file
     bool FileExists( const std::string& filePathName );
 
+    /// Check whether the first file is at least as new as the second
+    bool FileNewerThan( const std::string& filePathName, const std::string& otherPathName );
+
     /// Convert internal path to system-specific path
     std::string ConvertNeroToSystemPath( const std::string& pathName );
 
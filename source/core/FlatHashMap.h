@@ -0,0 +1,374 @@
+//---------------------------------------------------
+// Name: OpenNero : FlatHashMap
+// Desc:  cache-friendly open-addressing hash map
+//---------------------------------------------------
+
+#ifndef _CORE_FLAT_HASH_MAP_H_
+#define _CORE_FLAT_HASH_MAP_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/Error.h"
+
+namespace OpenNero
+{
+    /// default hash for FlatHashMap keys: a strong avalanching mix of the
+    /// integral value of the key, so sequential SimIds and type masks do
+    /// not cluster in the probe sequence
+    template <typename Key> struct FlatHash
+    {
+        /// hash an integral key
+        size_t operator()(const Key& key) const
+        {
+            uint64_t x = (uint64_t)key;
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ULL;
+            x ^= x >> 33;
+            return (size_t)x;
+        }
+    };
+
+    /// string keys use FNV-1a over the characters
+    template <> struct FlatHash<std::string>
+    {
+        /// hash a string key
+        size_t operator()(const std::string& key) const
+        {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (size_t i = 0; i < key.size(); ++i)
+            {
+                hash ^= (uint8_t)key[i];
+                hash *= 0x100000001b3ULL;
+            }
+            return (size_t)hash;
+        }
+    };
+
+    /**
+     * An open-addressing hash map with robin-hood probing that keeps its
+     * entries in one flat array, so the hot Find(SimId) lookups touch a
+     * single cache line instead of chasing the per-node pointers of the
+     * legacy hash_map. The interface is the subset of the standard map
+     * interface the engine actually uses: operator[], find, erase by
+     * iterator or key, iteration, size and clear.
+     *
+     * Like any open-addressing table, insertion and erasure invalidate
+     * every iterator; the exposed pair has a non-const key which callers
+     * must treat as read-only.
+     */
+    template <typename Key, typename Value, typename Hash = FlatHash<Key> >
+    class FlatHashMap
+    {
+    public:
+
+        /// the entry type iterators expose; do not modify first
+        typedef std::pair<Key, Value> value_type;
+
+    private:
+
+        /// one slot of the flat table; probe_length 0 marks an empty slot,
+        /// otherwise it is 1 + the distance from the key's home slot
+        struct Slot
+        {
+            uint8_t probe_length;   ///< 0 = empty, else probe distance + 1
+            value_type kv;          ///< the stored key and value
+
+            Slot() : probe_length(0), kv() {}
+        };
+
+        typedef std::vector<Slot> SlotVector;
+
+    public:
+
+        /// forward iterator over the occupied slots
+        template <typename SlotPtr, typename ValueRef, typename ValuePtr>
+        class iterator_base
+        {
+        public:
+            iterator_base() : mSlot(0), mEnd(0) {}
+
+            /// iterators to const content convert from mutable ones
+            template <typename SP, typename VR, typename VP>
+            iterator_base(const iterator_base<SP, VR, VP>& other)
+                : mSlot(other.raw_slot()), mEnd(other.raw_end()) {}
+
+            /// the stored key/value pair
+            ValueRef operator*() const { return mSlot->kv; }
+            /// member access to the stored key/value pair
+            ValuePtr operator->() const { return &mSlot->kv; }
+
+            /// advance to the next occupied slot
+            iterator_base& operator++()
+            {
+                ++mSlot;
+                skip_empty();
+                return *this;
+            }
+
+            /// iterators are equal when they point at the same slot
+            template <typename SP, typename VR, typename VP>
+            bool operator==(const iterator_base<SP, VR, VP>& other) const
+            {
+                return mSlot == other.raw_slot();
+            }
+
+            /// iterators differ when they point at different slots
+            template <typename SP, typename VR, typename VP>
+            bool operator!=(const iterator_base<SP, VR, VP>& other) const
+            {
+                return mSlot != other.raw_slot();
+            }
+
+            /// the raw slot pointer (for conversions and comparisons)
+            SlotPtr raw_slot() const { return mSlot; }
+            /// the raw end pointer (for conversions)
+            SlotPtr raw_end() const { return mEnd; }
+
+        private:
+
+            friend class FlatHashMap;
+
+            iterator_base(SlotPtr slot, SlotPtr end) : mSlot(slot), mEnd(end)
+            {
+                skip_empty();
+            }
+
+            void skip_empty()
+            {
+                while (mSlot != mEnd && mSlot->probe_length == 0)
+                    ++mSlot;
+            }
+
+            SlotPtr mSlot;  ///< current slot
+            SlotPtr mEnd;   ///< one past the last slot
+        };
+
+        /// mutable iterator
+        typedef iterator_base<Slot*, value_type&, value_type*> iterator;
+        /// const iterator
+        typedef iterator_base<const Slot*, const value_type&, const value_type*> const_iterator;
+
+        FlatHashMap() : mSize(0) {}
+
+        /// number of stored entries
+        size_t size() const { return mSize; }
+
+        /// true iff the map holds no entries
+        bool empty() const { return mSize == 0; }
+
+        /// drop every entry but keep the table storage for reuse
+        void clear()
+        {
+            for (size_t i = 0; i < mSlots.size(); ++i)
+            {
+                if (mSlots[i].probe_length != 0)
+                {
+                    mSlots[i].kv = value_type();
+                    mSlots[i].probe_length = 0;
+                }
+            }
+            mSize = 0;
+        }
+
+        /// first occupied entry
+        iterator begin() { return iterator(slots_begin(), slots_end()); }
+        /// one past the last entry
+        iterator end() { return iterator(slots_end(), slots_end()); }
+        /// first occupied entry
+        const_iterator begin() const { return const_iterator(slots_begin(), slots_end()); }
+        /// one past the last entry
+        const_iterator end() const { return const_iterator(slots_end(), slots_end()); }
+
+        /// find the entry with the given key (end() when absent)
+        iterator find(const Key& key)
+        {
+            Slot* slot = find_slot(key);
+            return slot ? iterator(slot, slots_end()) : end();
+        }
+
+        /// find the entry with the given key (end() when absent)
+        const_iterator find(const Key& key) const
+        {
+            const Slot* slot = find_slot(key);
+            return slot ? const_iterator(slot, slots_end()) : end();
+        }
+
+        /// the number of entries with the given key (0 or 1)
+        size_t count(const Key& key) const
+        {
+            return find_slot(key) ? 1 : 0;
+        }
+
+        /// the value mapped to the key, default-constructing it if absent
+        Value& operator[](const Key& key)
+        {
+            Slot* slot = find_slot(key);
+            if (!slot)
+            {
+                insert_slot(key, Value());
+                slot = find_slot(key);
+            }
+            return slot->kv.second;
+        }
+
+        /// insert the pair unless its key is already present
+        /// @return the entry and whether it was inserted
+        std::pair<iterator, bool> insert(const value_type& kv)
+        {
+            Slot* slot = find_slot(kv.first);
+            if (slot)
+                return std::make_pair(iterator(slot, slots_end()), false);
+            insert_slot(kv.first, kv.second);
+            return std::make_pair(iterator(find_slot(kv.first), slots_end()), true);
+        }
+
+        /// erase the entry the iterator points at
+        void erase(iterator pos)
+        {
+            Assert(pos != end());
+            erase_slot(pos.raw_slot());
+        }
+
+        /// erase the entry with the given key
+        /// @return the number of entries erased (0 or 1)
+        size_t erase(const Key& key)
+        {
+            Slot* slot = find_slot(key);
+            if (!slot)
+                return 0;
+            erase_slot(slot);
+            return 1;
+        }
+
+    private:
+
+        /// the table stays at most three-quarters full
+        bool over_load_factor() const
+        {
+            return (mSize + 1) * 4 > mSlots.size() * 3;
+        }
+
+        Slot* slots_begin() { return mSlots.empty() ? 0 : &mSlots[0]; }
+        Slot* slots_end() { return mSlots.empty() ? 0 : &mSlots[0] + mSlots.size(); }
+        const Slot* slots_begin() const { return mSlots.empty() ? 0 : &mSlots[0]; }
+        const Slot* slots_end() const { return mSlots.empty() ? 0 : &mSlots[0] + mSlots.size(); }
+
+        /// the home slot index of a key (capacity is a power of two)
+        size_t home_index(const Key& key) const
+        {
+            return mHash(key) & (mSlots.size() - 1);
+        }
+
+        /// locate the slot holding the key, NULL when absent
+        const Slot* find_slot(const Key& key) const
+        {
+            if (mSlots.empty())
+                return 0;
+            size_t index = home_index(key);
+            uint8_t distance = 1;
+            for (;;)
+            {
+                const Slot& slot = mSlots[index];
+                // an empty slot, or one closer to its home than we are to
+                // ours, would have been taken over during insertion
+                if (slot.probe_length < distance)
+                    return 0;
+                if (slot.probe_length == distance && slot.kv.first == key)
+                    return &slot;
+                index = (index + 1) & (mSlots.size() - 1);
+                ++distance;
+            }
+        }
+
+        /// mutable variant of find_slot
+        Slot* find_slot(const Key& key)
+        {
+            return const_cast<Slot*>(
+                static_cast<const FlatHashMap*>(this)->find_slot(key));
+        }
+
+        /// insert a key/value pair known to be absent; callers re-find the
+        /// slot afterwards because a rehash may move it
+        void insert_slot(const Key& key, const Value& value)
+        {
+            if (mSlots.empty() || over_load_factor())
+                rehash(mSlots.empty() ? 16 : mSlots.size() * 2);
+
+            value_type kv(key, value);
+            uint8_t distance = 1;
+            size_t index = home_index(key);
+            for (;;)
+            {
+                Slot& slot = mSlots[index];
+                if (slot.probe_length == 0)
+                {
+                    slot.kv = kv;
+                    slot.probe_length = distance;
+                    ++mSize;
+                    return;
+                }
+                // robin hood: a rich entry (closer to home) yields its slot
+                // to the poorer incoming one, bounding probe length variance
+                if (slot.probe_length < distance)
+                {
+                    std::swap(slot.kv, kv);
+                    std::swap(slot.probe_length, distance);
+                }
+                index = (index + 1) & (mSlots.size() - 1);
+                ++distance;
+                // probe lengths are stored in a byte; a table this unlucky
+                // is too full, so grow it and start over
+                if (distance == 255)
+                {
+                    rehash(mSlots.size() * 2);
+                    insert_slot(kv.first, kv.second);
+                    return;
+                }
+            }
+        }
+
+        /// remove an occupied slot, shifting the cluster behind it back
+        void erase_slot(Slot* slot)
+        {
+            size_t index = (size_t)(slot - &mSlots[0]);
+            for (;;)
+            {
+                size_t next = (index + 1) & (mSlots.size() - 1);
+                // the cluster ends at an empty slot or one already home
+                if (mSlots[next].probe_length <= 1)
+                    break;
+                mSlots[index].kv = mSlots[next].kv;
+                mSlots[index].probe_length = mSlots[next].probe_length - 1;
+                index = next;
+            }
+            mSlots[index].kv = value_type();
+            mSlots[index].probe_length = 0;
+            --mSize;
+        }
+
+        /// grow the table to the given power-of-two capacity and reinsert
+        void rehash(size_t capacity)
+        {
+            SlotVector old;
+            old.swap(mSlots);
+            mSlots.resize(capacity);
+            mSize = 0;
+            for (size_t i = 0; i < old.size(); ++i)
+            {
+                if (old[i].probe_length != 0)
+                    insert_slot(old[i].kv.first, old[i].kv.second);
+            }
+        }
+
+        SlotVector mSlots;  ///< the flat slot array (power-of-two size)
+        size_t mSize;       ///< number of occupied slots
+        Hash mHash;         ///< the hash functor
+    };
+
+} //end OpenNero
+
+#endif //end _CORE_FLAT_HASH_MAP_H_
@@ -1,103 +1,86 @@
 //---------------------------------------------------
-// Name: OpenNero : IdNameMap
-// Desc:  A template container of objects that is indexed by a name and a unique id
+// Name: OpenNero : IdNameRegistry
+// Desc:  interns object names into integer handles with O(1) lookup both ways
 //---------------------------------------------------
 
 #ifndef _CORE_IDNAMEMAP_H_
 #define _CORE_IDNAMEMAP_H_
 
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/member.hpp>
 #include <string>
 #include <vector>
-#include <iostream>
+#include <mutex>
 
 #include "core/ONTypes.h"
+#include "core/FlatHashMap.h"
 
 namespace OpenNero
 {
-
-    using namespace boost::multi_index;
-
-    /// A helper structure to hold things with their names and ids
-    template<class T>
-    struct IdNameWrapper
-    {
-            U32 id; ///< id
-            std::string name; ///< name
-            T payload; ///< a useful payload
-
-            /// create a new id-name object
-            /// @param id_ a numeric id
-            /// @param name_ a string name
-            /// @param payload_ a useful payload
-            IdNameWrapper(U32 id_, const std::string& name_, T payload_) :
-                id(id_), name(name_), payload(payload_)
-            {
-            }
-
-            /// human-readable output
-            std::ostream& operator<<(std::ostream& os)
-            {
-                os << id << " "<< name << " "<< std::endl;
-                return os;
-            }
-    };
-
-    /// used to tag the payload index
-    struct seq {};
-
-    /// used to tag the name index
-    struct name {};
-
-    /// used to tag the id index
-    struct id {};
-
-    /// IdNameRegistry is just a trick to allow us to use templates for typedefs
-    /// we can now make a IdNameRegistry<Foo>::Set of Foo that is accessible by name and id.
-    template<class T>
-    struct IdNameRegistry
+    /// Interns names into dense integer handles. A distinct string pays
+    /// for hashing exactly once, when it is first resolved; after that,
+    /// equal names always yield equal handles, so handles can be compared
+    /// and used as map keys everywhere downstream, and a handle maps back
+    /// to its name with a plain array index. Handles are process-wide and
+    /// never invalidated, so they may be cached in static locals.
+    class StringInterner
     {
-            typedef IdNameWrapper<T> Wrapper; ///< type of wrapper
-
-            /// Now we define a multi-index for the various payloads
-            /// It is accessible as a collection of its payload type, by
-            /// its unique name, or by its unique ID
-            typedef multi_index_container <
-            Wrapper,
-            indexed_by <
-                // This is just a list of payloads
-                sequenced< tag<seq> >,
-                // but it can also be accessed by hashed name
-                hashed_non_unique< tag<name>, BOOST_MULTI_INDEX_MEMBER(Wrapper, std::string, name) >,
-                // or by hashed unique id
-                hashed_unique< tag<id>, BOOST_MULTI_INDEX_MEMBER(Wrapper, U32, id) >
-                >
-            > Set;
-
-            /// this is what a list of these objects might look like to the world
-            typedef std::vector<T> ListInterface;
-
+    public:
+
+        /// the handle Find returns for names that were never interned
+        static const U32 kInvalidHandle = (U32)-1;
+
+        /// the process-wide intern table
+        static StringInterner& instance()
+        {
+            static StringInterner interner;
+            return interner;
+        }
+
+        /// resolve a name to its handle, interning it first if it is new
+        U32 Intern( const std::string& name )
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            HandleMap::const_iterator itr = mHandles.find(name);
+            if( itr != mHandles.end() )
+                return itr->second;
+            U32 handle = (U32)mNames.size();
+            mNames.push_back(name);
+            mHandles[name] = handle;
+            return handle;
+        }
+
+        /// look a name up without interning it (so probing for names that
+        /// may not exist does not grow the table)
+        U32 Find( const std::string& name ) const
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            HandleMap::const_iterator itr = mHandles.find(name);
+            return ( itr != mHandles.end() ) ? itr->second : kInvalidHandle;
+        }
+
+        /// the name a handle was interned from (O(1) array lookup; returned
+        /// by value because interning may grow the table concurrently)
+        std::string GetName( U32 handle ) const
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            Assert( handle < mNames.size() );
+            return mNames[handle];
+        }
+
+        /// number of distinct names interned so far
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            return mNames.size();
+        }
+
+    private:
+
+        typedef FlatHashMap<std::string, U32> HandleMap;
+
+        mutable std::mutex          mMutex;     ///< interning can race scripting and sim
+        HandleMap                   mHandles;   ///< name to handle (hashes once per distinct name)
+        std::vector<std::string>    mNames;     ///< handle to name (index is the handle)
     };
-
-    template<typename Tag, typename MultiIndexContainer>
-    void print_out_by(const MultiIndexContainer& s,
-                      Tag* =0 /* fixes a MSVC++ 6.0 bug with implicit template function parms */)
-    {
-        /* obtain a reference to the index tagged by Tag */
-
-        const typename boost::multi_index::index<MultiIndexContainer,Tag>::type
-            & i=get<Tag>(s);
-
-        typedef typename MultiIndexContainer::value_type value_type;
-
-        /* dump the elements of the index to cout */
-
-        std::copy(i.begin(), i.end(), std::ostream_iterator<value_type>(std::cout));
-    }
-
 }
 
 #endif // #ifndef _CORE_IDNAMEMAP_H_
@@ -1,44 +1,199 @@
-//---------------------------------------------------
-// Name: OpenNero : IrrSerialize
-//  Serialization functions for Irr things
-//---------------------------------------------------
-
-#include "core/Common.h"
-#include "core/ONTypes.h"
-#include "IrrSerialize.h"
-#include <algorithm>
-#include <sstream>
-
-namespace irr
-{
-    namespace core
-    {
-        std::ostream& operator<<( std::ostream& stream, const quaternion& q)
-        {
-            stream << q.X << " " << q.Y << " " << q.Z << " " << q.W;
-            return stream;
-        }
-    
-    }
-
-    namespace video
-    {
-        std::istream& operator>>( std::istream& stream, SColor& obj )
-        {
-            stream.setf( std::ios_base::skipws );
-            OpenNero::uint32_t col[4] = { 0, 0, 0, 0 };
-            stream >> col[0] >> col[1] >> col[2];
-            if( !stream.eof() )
-                stream >> col[3];
-
-            obj.set( col[3], col[0], col[1], col[2] );
-            return stream;
-        }
-
-        std::ostream& operator<<( std::ostream& stream, const SColor& obj )
-        {
-            stream << obj.getRed() << " " << obj.getGreen() << " " << obj.getBlue() << " " << obj.getAlpha();    
-            return stream;
-        }
-    }
-}
+//---------------------------------------------------
+// Name: OpenNero : IrrSerialize
+//  Serialization functions for Irr things
+//---------------------------------------------------
+
+#include "core/Common.h"
+#include "core/ONTypes.h"
+#include "IrrSerialize.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+namespace irr
+{
+    namespace serial
+    {
+        namespace
+        {
+            /// skip whitespace on the buffer; returns the next character
+            /// without consuming it, or EOF
+            int SkipSpace( std::streambuf* buf )
+            {
+                int c = buf->sgetc();
+                while( c != EOF && std::isspace(c) )
+                    c = buf->snextc();
+                return c;
+            }
+
+            /// parse an optional sign; returns -1 or +1
+            int ParseSign( std::streambuf* buf, int& c )
+            {
+                int sign = 1;
+                if( c == '-' || c == '+' )
+                {
+                    if( c == '-' )
+                        sign = -1;
+                    c = buf->snextc();
+                }
+                return sign;
+            }
+
+            /// parse [sign] digits [. digits] [e [sign] digits] straight
+            /// off the stream buffer; false (and failbit) if no digits
+            bool ParseDouble( std::istream& stream, double& out )
+            {
+                std::streambuf* buf = stream.rdbuf();
+                int c = SkipSpace(buf);
+                const int sign = ParseSign(buf, c);
+
+                double value = 0;
+                bool any_digits = false;
+                while( c != EOF && c >= '0' && c <= '9' )
+                {
+                    value = value * 10.0 + (c - '0');
+                    any_digits = true;
+                    c = buf->snextc();
+                }
+
+                if( c == '.' )
+                {
+                    c = buf->snextc();
+                    double scale = 0.1;
+                    while( c != EOF && c >= '0' && c <= '9' )
+                    {
+                        value += (c - '0') * scale;
+                        scale *= 0.1;
+                        any_digits = true;
+                        c = buf->snextc();
+                    }
+                }
+
+                if( !any_digits )
+                {
+                    stream.setstate(std::ios_base::failbit);
+                    return false;
+                }
+
+                if( c == 'e' || c == 'E' )
+                {
+                    c = buf->snextc();
+                    const int exp_sign = ParseSign(buf, c);
+                    int exponent = 0;
+                    while( c != EOF && c >= '0' && c <= '9' )
+                    {
+                        exponent = exponent * 10 + (c - '0');
+                        c = buf->snextc();
+                    }
+                    value *= std::pow(10.0, exp_sign * exponent);
+                }
+
+                if( c == EOF )
+                    stream.setstate(std::ios_base::eofbit);
+
+                out = sign * value;
+                return true;
+            }
+
+            /// parse [sign] digits; false (and failbit) if no digits
+            bool ParseLong( std::istream& stream, long& out )
+            {
+                std::streambuf* buf = stream.rdbuf();
+                int c = SkipSpace(buf);
+                const int sign = ParseSign(buf, c);
+
+                long value = 0;
+                bool any_digits = false;
+                while( c != EOF && c >= '0' && c <= '9' )
+                {
+                    value = value * 10 + (c - '0');
+                    any_digits = true;
+                    c = buf->snextc();
+                }
+
+                if( !any_digits )
+                {
+                    stream.setstate(std::ios_base::failbit);
+                    return false;
+                }
+
+                if( c == EOF )
+                    stream.setstate(std::ios_base::eofbit);
+
+                out = sign * value;
+                return true;
+            }
+        }
+
+        bool ReadNumber( std::istream& stream, float& out )
+        {
+            double value;
+            if( !ParseDouble(stream, value) )
+                return false;
+            out = (float)value;
+            return true;
+        }
+
+        bool ReadNumber( std::istream& stream, double& out )
+        {
+            return ParseDouble(stream, out);
+        }
+
+        bool ReadNumber( std::istream& stream, irr::s32& out )
+        {
+            long value;
+            if( !ParseLong(stream, value) )
+                return false;
+            out = (irr::s32)value;
+            return true;
+        }
+
+        bool ReadNumber( std::istream& stream, irr::u32& out )
+        {
+            long value;
+            if( !ParseLong(stream, value) )
+                return false;
+            out = (irr::u32)value;
+            return true;
+        }
+    }
+
+    namespace core
+    {
+        std::ostream& operator<<( std::ostream& stream, const quaternion& q)
+        {
+            stream << q.X << " " << q.Y << " " << q.Z << " " << q.W;
+            return stream;
+        }
+
+    }
+
+    namespace video
+    {
+        std::istream& operator>>( std::istream& stream, SColor& obj )
+        {
+            OpenNero::uint32_t col[4] = { 0, 0, 0, 0 };
+            serial::ReadNumber( stream, col[0] );
+            serial::ReadNumber( stream, col[1] );
+            serial::ReadNumber( stream, col[2] );
+            // the alpha component is optional; only parse it if something
+            // other than trailing whitespace is left
+            std::streambuf* buf = stream.rdbuf();
+            int c = buf->sgetc();
+            while( c != EOF && std::isspace(c) )
+                c = buf->snextc();
+            if( stream && c != EOF )
+                serial::ReadNumber( stream, col[3] );
+
+            obj.set( col[3], col[0], col[1], col[2] );
+            return stream;
+        }
+
+        std::ostream& operator<<( std::ostream& stream, const SColor& obj )
+        {
+            stream << obj.getRed() << " " << obj.getGreen() << " " << obj.getBlue() << " " << obj.getAlpha();
+            return stream;
+        }
+    }
+}
@@ -1,107 +1,135 @@
-//---------------------------------------------------
-// Name: OpenNero : IrrSerialize
-//  Serialization functions for Irr things
-//---------------------------------------------------
-
-#ifndef _CORE_IRRLICHT_SERIALIZE_H_
-#define _CORE_IRRLICHT_SERIALIZE_H_
-
-#include <tinyxml.h>    // keeps TinyXML from complaining about isspace()
-
-#include <iostream>
-#include <irrlicht.h>
-
-namespace irr
-{
-    namespace core
-    {
-
-        /// input a 2D vector from a stream
-        template< typename T >
-        std::istream& operator>>( std::istream& stream, vector2d<T>& obj )
-        {
-            stream.setf( std::ios_base::skipws );
-            stream >> obj.X >> obj.Y;
-            return stream;
-        }
-        
-        /// input a 3d vector from a stream
-        template< typename T >
-        std::istream& operator>>( std::istream& stream, vector3d<T>& obj )
-        {
-            stream.setf( std::ios_base::skipws );
-            stream >> obj.X >> obj.Y >> obj.Z;
-            return stream;
-        }
-        
-        /// input a 2d dimension from a stream
-        template< typename T >
-        std::istream& operator>>( std::istream& stream, dimension2d<T>& obj )
-        {
-            stream.setf( std::ios_base::skipws );
-            stream >> obj.Width >> obj.Height;
-            return stream;
-        }
-        
-        /// input a bounding box from a stream
-        template< typename T >
-        std::istream& operator>>( std::istream& stream, aabbox3d<T>& obj )
-        {
-            stream.setf( std::ios_base::skipws );
-            stream >> obj.MinEdge.X >> obj.MinEdge.Y >> obj.MinEdge.Z
-                   >> obj.MaxEdge.X >> obj.MaxEdge.Y >> obj.MaxEdge.Z;
-            return stream;
-        } 
-                
-        /// output a 2D vector to a stream
-        template< typename T >
-        std::ostream& operator<<( std::ostream& stream, const vector2d<T>& obj )
-        {
-            stream << obj.X << " " << obj.Y;
-            return stream;
-        }
-        
-        /// output a 3D vector to a stream
-        template< typename T >
-        std::ostream& operator<<( std::ostream& stream, const vector3d<T>& obj )
-        {
-            stream << obj.X << " " << obj.Y << " " << obj.Z;
-            return stream;
-        }
-        
-        /// output a dimension to a stream
-        template< typename T >
-        std::ostream& operator<<( std::ostream& stream, const dimension2d<T>& obj )
-        {
-            stream << obj.Width << " " << obj.Height;
-            return stream;
-        }
-        
-        /// output a bounding box to a stream
-        template< typename T >
-        std::ostream& operator<<( std::ostream& stream, const aabbox3d<T>& obj )
-        {
-            stream << obj.MinEdge.X << " " << obj.MinEdge.Y << " " << obj.MinEdge.Z << " " 
-                   << obj.MaxEdge.X << " " << obj.MaxEdge.Y << " " << obj.MaxEdge.Z;
-            return stream;
-        }
-
-        /// output a quaternion to a stream
-        std::ostream& operator<<( std::ostream& stream, const quaternion& q);
-
-
-    } // namespace core
-
-    namespace video
-    {
-        /// input a color from a stream
-        std::istream& operator>>( std::istream& stream, SColor& obj );
-
-        /// output a color to a stream
-        std::ostream& operator<<( std::ostream& stream, const SColor& obj );
-
-    } // namespace video
-} // namespace irr
-
-
-#endif //end _CORE_IRRLICHT_UTIL_H_
+//---------------------------------------------------
+// Name: OpenNero : IrrSerialize
+//  Serialization functions for Irr things
+//---------------------------------------------------
+
+#ifndef _CORE_IRRLICHT_SERIALIZE_H_
+#define _CORE_IRRLICHT_SERIALIZE_H_
+
+#include <tinyxml.h>    // keeps TinyXML from complaining about isspace()
+
+#include <iostream>
+#include <irrlicht.h>
+
+namespace irr
+{
+    namespace serial
+    {
+        /// @{
+        /// Hand-rolled numeric extraction for the operators below: reads
+        /// the characters straight off the stream buffer instead of going
+        /// through the locale-aware num_get machinery, which profiling of
+        /// mod load showed dominating template property parsing. Skips
+        /// leading whitespace like the stream extractors it replaces and
+        /// sets failbit when no number is found.
+        bool ReadNumber( std::istream& stream, float& out );
+        bool ReadNumber( std::istream& stream, double& out );
+        bool ReadNumber( std::istream& stream, irr::s32& out );
+        bool ReadNumber( std::istream& stream, irr::u32& out );
+        /// @}
+
+        /// fallback for element types without a hand-rolled parser
+        template< typename T >
+        bool ReadNumber( std::istream& stream, T& out )
+        {
+            stream >> out;
+            return !stream.fail();
+        }
+    }
+
+    namespace core
+    {
+
+        /// input a 2D vector from a stream
+        template< typename T >
+        std::istream& operator>>( std::istream& stream, vector2d<T>& obj )
+        {
+            serial::ReadNumber( stream, obj.X );
+            serial::ReadNumber( stream, obj.Y );
+            return stream;
+        }
+
+        /// input a 3d vector from a stream
+        template< typename T >
+        std::istream& operator>>( std::istream& stream, vector3d<T>& obj )
+        {
+            serial::ReadNumber( stream, obj.X );
+            serial::ReadNumber( stream, obj.Y );
+            serial::ReadNumber( stream, obj.Z );
+            return stream;
+        }
+
+        /// input a 2d dimension from a stream
+        template< typename T >
+        std::istream& operator>>( std::istream& stream, dimension2d<T>& obj )
+        {
+            serial::ReadNumber( stream, obj.Width );
+            serial::ReadNumber( stream, obj.Height );
+            return stream;
+        }
+
+        /// input a bounding box from a stream
+        template< typename T >
+        std::istream& operator>>( std::istream& stream, aabbox3d<T>& obj )
+        {
+            serial::ReadNumber( stream, obj.MinEdge.X );
+            serial::ReadNumber( stream, obj.MinEdge.Y );
+            serial::ReadNumber( stream, obj.MinEdge.Z );
+            serial::ReadNumber( stream, obj.MaxEdge.X );
+            serial::ReadNumber( stream, obj.MaxEdge.Y );
+            serial::ReadNumber( stream, obj.MaxEdge.Z );
+            return stream;
+        }
+
+        /// output a 2D vector to a stream
+        template< typename T >
+        std::ostream& operator<<( std::ostream& stream, const vector2d<T>& obj )
+        {
+            stream << obj.X << " " << obj.Y;
+            return stream;
+        }
+
+        /// output a 3D vector to a stream
+        template< typename T >
+        std::ostream& operator<<( std::ostream& stream, const vector3d<T>& obj )
+        {
+            stream << obj.X << " " << obj.Y << " " << obj.Z;
+            return stream;
+        }
+
+        /// output a dimension to a stream
+        template< typename T >
+        std::ostream& operator<<( std::ostream& stream, const dimension2d<T>& obj )
+        {
+            stream << obj.Width << " " << obj.Height;
+            return stream;
+        }
+
+        /// output a bounding box to a stream
+        template< typename T >
+        std::ostream& operator<<( std::ostream& stream, const aabbox3d<T>& obj )
+        {
+            stream << obj.MinEdge.X << " " << obj.MinEdge.Y << " " << obj.MinEdge.Z << " "
+                   << obj.MaxEdge.X << " " << obj.MaxEdge.Y << " " << obj.MaxEdge.Z;
+            return stream;
+        }
+
+        /// output a quaternion to a stream
+        std::ostream& operator<<( std::ostream& stream, const quaternion& q);
+
+
+    } // namespace core
+
+    namespace video
+    {
+        /// input a color from a stream
+        std::istream& operator>>( std::istream& stream, SColor& obj );
+
+        /// output a color to a stream
+        std::ostream& operator<<( std::ostream& stream, const SColor& obj );
+
+    } // namespace video
+} // namespace irr
+
+
+#endif //end _CORE_IRRLICHT_UTIL_H_
@@ -46,6 +46,9 @@ namespace irr
 }
 
 namespace OpenNero {
+    /// disambiguate the unqualified core:: uses from boost::core
+    namespace core = irr::core;
+
     /// typedefs for irrlicht types in case we ever decide to move away
     /// @{
     /// 2d integer rectangle
@@ -230,6 +233,22 @@ namespace OpenNero {
             col.set( tmp[0], tmp[1], tmp[2], tmp[3] );
             return stream;
         }
+
+        /// convenience method for extracting an irr vector from a view
+        template< class T > inline BitstreamView&
+        operator>>( BitstreamView& view, irr::core::vector3d<T>& vec )
+        {
+            return view >> vec.X >> vec.Y >> vec.Z;
+        }
+
+        /// convenience method for extracting an irr color from a view
+        inline BitstreamView& operator>>( BitstreamView& view, irr::video::SColor& col )
+        {
+            uint32_t tmp[4] = { 0, 0, 0, 0 };
+            view >> tmp[0] >> tmp[1] >> tmp[2] >> tmp[3];
+            col.set( tmp[0], tmp[1], tmp[2], tmp[3] );
+            return view;
+        }
         
         /// convert NERO right-handed position (x-y-z) to Irrlicht left-handed (x-z-y)
         template< typename T >
@@ -0,0 +1,121 @@
+//--------------------------------------------------------
+// OpenNero : LockFreeRing
+//  bounded lock-free ring buffer
+//--------------------------------------------------------
+
+#ifndef _CORE_LOCKFREERING_H_
+#define _CORE_LOCKFREERING_H_
+
+#include <atomic>
+#include <cstddef>
+#include "core/Error.h"
+
+namespace OpenNero
+{
+    /// Bounded multi-producer/multi-consumer ring buffer (Vyukov's
+    /// scheme): each cell carries a sequence number that tickets
+    /// producers and consumers, so push and pop are a single
+    /// compare-and-swap plus a store in the uncontended case. Both
+    /// operations are non-blocking: push fails when the ring is full and
+    /// pop fails when it is empty, leaving the backpressure policy (back
+    /// off, drop, etc.) to the caller. Used by the asynchronous log
+    /// flusher and the plot/telemetry writer.
+    template <typename T>
+    class LockFreeRing
+    {
+    public:
+        /// create a ring holding up to capacity items (a power of two)
+        explicit LockFreeRing( size_t capacity )
+            : cells(new Cell[capacity])
+            , mask(capacity - 1)
+            , enqueue_pos(0)
+            , dequeue_pos(0)
+        {
+            AssertMsg( (capacity & mask) == 0, "ring capacity must be a power of two" );
+            for( size_t i = 0; i < capacity; ++i )
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~LockFreeRing()
+        {
+            delete [] cells;
+        }
+
+        /// append an item; returns false if the ring is full
+        bool push( const T& item )
+        {
+            Cell* cell;
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            for( ;; )
+            {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+                if( dif == 0 )
+                {
+                    if( enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                        break;
+                }
+                else if( dif < 0 )
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->item = item;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// remove the oldest item; returns false if the ring is empty
+        bool pop( T& item )
+        {
+            Cell* cell;
+            size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            for( ;; )
+            {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+                if( dif == 0 )
+                {
+                    if( dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                        break;
+                }
+                else if( dif < 0 )
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            item = cell->item;
+            cell->item = T();
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence; ///< ticket for this cell
+            T item;                       ///< payload
+        };
+
+        Cell* cells;                     ///< cell storage (capacity entries)
+        size_t mask;                     ///< capacity - 1
+        std::atomic<size_t> enqueue_pos; ///< next producer ticket
+        std::atomic<size_t> dequeue_pos; ///< next consumer ticket
+
+        LockFreeRing( const LockFreeRing& );            // not copyable
+        LockFreeRing& operator=( const LockFreeRing& ); // not copyable
+    };
+
+} // namespace OpenNero
+
+#endif // _CORE_LOCKFREERING_H_
@@ -4,12 +4,17 @@
 //---------------------------------------------------
 
 #include "core/Common.h"
+#include "core/HashMap.h"
+#include "core/LockFreeRing.h"
 #include "Log.h"
 #include "LogConnections.h"
 #include "scripting/scriptIncludes.h"
 #include "game/Kernel.h"
 #include <vector>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 namespace OpenNero
 {
@@ -18,6 +23,11 @@ namespace OpenNero
 		static ILogConnectionVector sLogConnections;
         static FilterList           sFilterList;
 
+        /// minimum severity per filter type, consulted before any formatting
+        typedef hash_map<std::string, int> TypeLevelMap;
+        static TypeLevelMap         sTypeLevels;
+        static int                  sDefaultLevel = kLevelDebug;
+
         /// helper utility functions
         namespace LogUtil
         {
@@ -39,23 +49,12 @@ namespace OpenNero
             /// define a pointer to member method of ILogConnection
             typedef void (ILogConnection::*MemberLogFunc)( const char* msg );
 
-            /// output a message to a member method of ILogConnection on an instance of ILogConnection
+            /// deliver a message to the appropriate connections (no filtering)
             /// @param func the member function to call
-            /// @param msgType the type of message
-            /// @param connectionName the name of the connection
+            /// @param connectionName the name of the connection, NULL to broadcast
             /// @param msg the message to output
-            void OutputToLogFunc( MemberLogFunc func, const char* msgType, const char* connectionName, const char* msg )
+            void DeliverToConnections( MemberLogFunc func, const char* connectionName, const char* msg )
             {
-                if( msgType )
-                {
-                    // if the message type is in the filter list, then ignore it
-                    // if we do not contain the 'all' receiver or the msgType receiver, exit
-                    if( std::find( sFilterList.begin(), sFilterList.end(), msgType )   != sFilterList.end() )
-                    {
-                        return;
-                    }
-                }
-
                 // if the connectionName is null, broadcast to all
                 if( !connectionName )
                 {
@@ -85,6 +84,107 @@ namespace OpenNero
             }
         }
 
+        /// The asynchronous log pipeline. When enabled, producers append
+        /// records to a bounded lock-free ring and return without touching
+        /// the connections; a background thread drains the ring and performs
+        /// the actual (possibly slow) file and console writes.
+        namespace AsyncLog
+        {
+            /// one filtered log message on its way to the connections
+            struct Record
+            {
+                LogUtil::MemberLogFunc func; ///< level-specific member to call
+                bool broadcast;              ///< deliver to all connections?
+                std::string connection;      ///< target connection if not broadcasting
+                std::string msg;             ///< preformatted message text
+            };
+
+            /// number of records the ring can hold before producers back off
+            static const size_t kRingCapacity = 4096;
+
+            /// everything owned by the flusher thread
+            struct State
+            {
+                State() : ring(kRingCapacity), running(false) {}
+                LockFreeRing<Record> ring; ///< pending records
+                std::thread flusher;       ///< background delivery thread
+                std::atomic<bool> running; ///< cleared to ask the flusher to drain and exit
+            };
+
+            static State* sState = NULL;
+
+            /// drain the ring until asked to stop, then drain whatever is left
+            void FlushLoop( State* state )
+            {
+                Record record;
+                for( ;; )
+                {
+                    if( state->ring.pop(record) )
+                    {
+                        LogUtil::DeliverToConnections( record.func,
+                                                       record.broadcast ? NULL : record.connection.c_str(),
+                                                       record.msg.c_str() );
+                    }
+                    else if( state->running.load(std::memory_order_acquire) )
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+            }
+
+            /// append a record, backing off if the flusher has fallen behind
+            void Enqueue( State* state, LogUtil::MemberLogFunc func, const char* connectionName, const char* msg )
+            {
+                Record record;
+                record.func = func;
+                record.broadcast = (connectionName == NULL);
+                if( connectionName )
+                    record.connection = connectionName;
+                record.msg = msg;
+                while( !state->ring.push(record) )
+                {
+                    // the ring is full - yield to let the flusher catch up
+                    // rather than drop the record
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        namespace LogUtil
+        {
+            /// output a message to a member method of ILogConnection on an instance of ILogConnection
+            /// @param func the member function to call
+            /// @param msgType the type of message
+            /// @param connectionName the name of the connection
+            /// @param msg the message to output
+            void OutputToLogFunc( MemberLogFunc func, const char* msgType, const char* connectionName, const char* msg )
+            {
+                if( msgType )
+                {
+                    // if the message type is in the filter list, then ignore it
+                    // if we do not contain the 'all' receiver or the msgType receiver, exit
+                    if( std::find( sFilterList.begin(), sFilterList.end(), msgType )   != sFilterList.end() )
+                    {
+                        return;
+                    }
+                }
+
+                // in async mode, hand the record to the flusher thread instead
+                // of walking the connections on the caller's thread
+                if( AsyncLog::State* state = AsyncLog::sState )
+                {
+                    AsyncLog::Enqueue( state, func, connectionName, msg );
+                    return;
+                }
+
+                DeliverToConnections( func, connectionName, msg );
+            }
+        }
+
 		/**
 		 * Add a connection to our manager. Increment the ref count on conn
 		 * @param conn a log connection to add
@@ -161,9 +261,67 @@ namespace OpenNero
             sFilterList = flist;
         }
 
+        /// Set the minimum severity for messages of a given filter type
+        void LogSystemSetTypeLevel( const std::string& type, int level )
+        {
+            sTypeLevels[type] = level;
+        }
+
+        /// Set the minimum severity for messages without a per-type threshold
+        void LogSystemSetDefaultLevel( int level )
+        {
+            sDefaultLevel = level;
+        }
+
+        /// Cheap pre-format check consulted by the LOG_* macros: is a message
+        /// of this type and severity going to be dispatched at all?
+        bool IsLogEnabled( const char* type, int level )
+        {
+            if( type )
+            {
+                // messages of a filtered-out type are never logged
+                if( std::find( sFilterList.begin(), sFilterList.end(), type ) != sFilterList.end() )
+                {
+                    return false;
+                }
+                TypeLevelMap::const_iterator found = sTypeLevels.find(type);
+                if( found != sTypeLevels.end() )
+                {
+                    return level >= found->second;
+                }
+            }
+            return level >= sDefaultLevel;
+        }
+
+        /// route log messages through a background flusher thread
+        void LogSystemEnableAsync()
+        {
+            if( AsyncLog::sState )
+                return;
+            AsyncLog::State* state = new AsyncLog::State();
+            state->running.store(true, std::memory_order_release);
+            state->flusher = std::thread(&AsyncLog::FlushLoop, state);
+            AsyncLog::sState = state;
+        }
+
+        /// flush all pending records and return to synchronous dispatch
+        void LogSystemDisableAsync()
+        {
+            if( !AsyncLog::sState )
+                return;
+            // new records go back to synchronous dispatch while the flusher
+            // drains what is already in the ring
+            AsyncLog::State* state = AsyncLog::sState;
+            AsyncLog::sState = NULL;
+            state->running.store(false, std::memory_order_release);
+            state->flusher.join();
+            delete state;
+        }
+
         /// clear all the log connections
 		void LogSystemShutdown()
 		{
+            LogSystemDisableAsync();
 			sLogConnections.clear();
 		}
 
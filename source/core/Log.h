@@ -15,6 +15,13 @@
 // only possibly turn off logs in the final release
 #define NERO_ENABLE_LOGS (!NERO_FINAL_RELEASE)
 
+// Compile-time maximum verbosity: LOG_* macros below this level expand to
+// nothing, so they cost literally nothing at the call site. Override on the
+// compiler command line (e.g. -DNERO_LOG_LEVEL=2 for warnings and errors only).
+#ifndef NERO_LOG_LEVEL
+    #define NERO_LOG_LEVEL 0
+#endif
+
 namespace OpenNero
 {
     namespace Log
@@ -49,7 +56,16 @@ namespace OpenNero
         
         typedef boost::shared_ptr<ILogConnection> ILogConnectionPtr;
         typedef std::vector<ILogConnectionPtr> ILogConnectionVector;
-        typedef std::vector< std::string > FilterList;        
+        typedef std::vector< std::string > FilterList;
+
+        /// severity levels, in increasing order of importance
+        enum LogLevel
+        {
+            kLevelDebug = 0,
+            kLevelMsg,
+            kLevelWarning,
+            kLevelError
+        };
 
         /// add a log connection to our system
         extern void AddLogConnection( ILogConnectionPtr conn );
@@ -68,6 +84,28 @@ namespace OpenNero
         extern void LogSystemSpecifyFilters( const FilterList& flist );
         extern void LogSystemShutdown();
 
+        /// Route log messages through a background flusher thread. Producers
+        /// append records to a lock-free ring and return immediately, so the
+        /// simulation thread never waits on file or console writes. All log
+        /// connections should be added before enabling async mode.
+        extern void LogSystemEnableAsync();
+
+        /// Flush all pending records, stop the flusher thread, and return to
+        /// synchronous dispatch. Called automatically by LogSystemShutdown.
+        extern void LogSystemDisableAsync();
+
+        /// Set the minimum severity that messages of a given filter type must
+        /// have to be logged; anything below is dropped before formatting.
+        extern void LogSystemSetTypeLevel( const std::string& type, int level );
+
+        /// Set the minimum severity for messages without a per-type threshold.
+        extern void LogSystemSetDefaultLevel( int level );
+
+        /// Cheap pre-format check: should a message of this type and severity
+        /// be formatted and dispatched at all? The type may be NULL for
+        /// messages without a filter type.
+        extern bool IsLogEnabled( const char* type, int level );
+
         /// Allow ALL messages of any type to come through the logger
         extern const std::string kLogFilterAcceptAll;
 
@@ -77,40 +115,72 @@ namespace OpenNero
 
 #if NERO_ENABLE_LOGS
 
-    // default broadcasting logger macros - sends the message to every log connection regardless of target or type
-    #define LOG_DEBUG_EVERY(t, msg) do { static int counter = 0; if (++counter % t == 0) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug( NULL, NULL, cmsg.str().c_str() ); } } while (0)
-    #define LOG_DEBUG( msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug  ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_ERROR( msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_MSG( msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_WARNING( msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, NULL, cmsg.str().c_str() ); } while(0)
-
-    // destination based logs - send the message to a certain connection
-    // Example: LOG_D_DEBUG( "texture_loader_connection", "A texture load as failed" )
-    #define LOG_D_DEBUG( name, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogDebug  ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_ERROR( name, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_MSG( name, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_WARNING( name, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, (name), cmsg.str().c_str() ); } while(0)
-
-    // filter based logs - send the message only to receivers of certain types
-    
     #define LOG_FILTER_TOKEN(type) "[" << (type) << "] "
-    
-    // The basis behind this is that a user or developer should be able to filter out the log messages that are relevant.
+
+    // The basis behind the filter based (LOG_F_*) logs is that a user or developer
+    // should be able to filter out the log messages that are relevant.
     // If I am only concerned with messages from a given system, don't show me messages from these other ones.
     // Example: LOG_F_MSG( "render", "Rendering a complex object" )
     //   This message only gets sent to developers that have the "render" type enabled in their filter list
     //   as setup by the LogSystemSpecifyFilters method
-
-    #define LOG_F_DEBUG( type, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_ERROR( type, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_MSG( type, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_WARNING( type, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), NULL, cmsg.str().c_str() ); } while(0)
-
-    // filter and destination based logs - send the message only to the given connection only to receivers of certain types
-    #define LOG_FD_DEBUG( type, target, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_ERROR( type, target, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_MSG( type, target, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_WARNING( type, target, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), (target), cmsg.str().c_str() ); } while(0)
+    //
+    // Every macro asks IsLogEnabled before building the stringstream, so a
+    // message suppressed by the filter list or a severity threshold never pays
+    // for formatting. Macros below NERO_LOG_LEVEL compile away entirely.
+
+    // debug priority messages (level 0)
+    #if NERO_LOG_LEVEL <= 0
+        #define LOG_DEBUG_EVERY(t, msg) do { static int counter = 0; if (++counter % t == 0 && OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelDebug )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug( NULL, NULL, cmsg.str().c_str() ); } } while (0)
+        #define LOG_DEBUG( msg )   do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelDebug )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug  ( NULL, NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_D_DEBUG( name, msg )   do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelDebug )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogDebug  ( NULL, (name), cmsg.str().c_str() ); } } while(0)
+        #define LOG_F_DEBUG( type, msg )   do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelDebug )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_FD_DEBUG( type, target, msg )   do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelDebug )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), (target), cmsg.str().c_str() ); } } while(0)
+    #else
+        #define LOG_DEBUG_EVERY(t, msg)
+        #define LOG_DEBUG( msg )
+        #define LOG_D_DEBUG( name, msg )
+        #define LOG_F_DEBUG( type, msg )
+        #define LOG_FD_DEBUG( type, target, msg )
+    #endif
+
+    // normal priority messages (level 1)
+    #if NERO_LOG_LEVEL <= 1
+        #define LOG_MSG( msg )     do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelMsg )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_D_MSG( name, msg )     do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelMsg )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, (name), cmsg.str().c_str() ); } } while(0)
+        #define LOG_F_MSG( type, msg )     do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelMsg )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_FD_MSG( type, target, msg )     do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelMsg )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), (target), cmsg.str().c_str() ); } } while(0)
+    #else
+        #define LOG_MSG( msg )
+        #define LOG_D_MSG( name, msg )
+        #define LOG_F_MSG( type, msg )
+        #define LOG_FD_MSG( type, target, msg )
+    #endif
+
+    // warning priority messages (level 2)
+    #if NERO_LOG_LEVEL <= 2
+        #define LOG_WARNING( msg ) do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelWarning )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_D_WARNING( name, msg ) do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelWarning )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, (name), cmsg.str().c_str() ); } } while(0)
+        #define LOG_F_WARNING( type, msg ) do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelWarning )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_FD_WARNING( type, target, msg ) do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelWarning )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), (target), cmsg.str().c_str() ); } } while(0)
+    #else
+        #define LOG_WARNING( msg )
+        #define LOG_D_WARNING( name, msg )
+        #define LOG_F_WARNING( type, msg )
+        #define LOG_FD_WARNING( type, target, msg )
+    #endif
+
+    // error priority messages (level 3)
+    #if NERO_LOG_LEVEL <= 3
+        #define LOG_ERROR( msg )   do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelError )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_D_ERROR( name, msg )   do { if (OpenNero::Log::IsLogEnabled( NULL, OpenNero::Log::kLevelError )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, (name), cmsg.str().c_str() ); } } while(0)
+        #define LOG_F_ERROR( type, msg )   do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelError )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), NULL, cmsg.str().c_str() ); } } while(0)
+        #define LOG_FD_ERROR( type, target, msg )   do { if (OpenNero::Log::IsLogEnabled( (type), OpenNero::Log::kLevelError )) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), (target), cmsg.str().c_str() ); } } while(0)
+    #else
+        #define LOG_ERROR( msg )
+        #define LOG_D_ERROR( name, msg )
+        #define LOG_F_ERROR( type, msg )
+        #define LOG_FD_ERROR( type, target, msg )
+    #endif
 
 #else
 
@@ -7,7 +7,7 @@
 #define _CORE_LOOKUPTABLE_H_
 
 #include "Common.h"
-#include "HashMap.h"
+#include "FlatHashMap.h"
 
 namespace OpenNero 
 {   
@@ -30,10 +30,7 @@ namespace OpenNero
 	 *  Map is the mapping container that maps Keys to IndexTypes
 	 */
 	 
-	// 5/10/07 - __gnu_cxx is a little wonky, hashmap won't work with std::string. Until we resolve this, go with std::map
-    //template <typename Key, typename Value, typename IndexType = int32_t, typename Map = hash_map<Key,IndexType> >
-    
-    template <typename Key, typename Value, typename IndexType = int32_t, typename Map = std::map<Key,IndexType> >
+    template <typename Key, typename Value, typename IndexType = int32_t, typename Map = FlatHashMap<Key,IndexType> >
     class LookupTable
     {
 
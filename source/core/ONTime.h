@@ -27,21 +27,75 @@ namespace OpenNero
         /// @return time since last reset/constructor
         virtual uint64_t resetMicroseconds() = 0;
 
+        /// @return time since last reset/constructor in nanoseconds
+        virtual uint64_t getNanoseconds() = 0;
+
         /// @return time since last reset/constructor in microseconds
         virtual uint64_t getMicroseconds() = 0;
 
         /// @return time since last reset/constructor in milliseconds
         virtual uint64_t getMilliseconds() = 0;
-        
+
         /// print timestamp to output stream
         virtual void stamp(std::ostream& out) = 0;
     };
-        
+
     /// @return a new timer instance
     TimerPtr GetTimer();
 
     /// @return a static timer created only one
-    Timer& GetStaticTimer();    
+    Timer& GetStaticTimer();
+
+    /**
+     * A monotonic high-resolution clock for profiling and frame pacing.
+     * On x86 reads go through the cycle counter after a short one-time
+     * calibration against the steady clock, so a stamp costs little more
+     * than an rdtsc; everywhere else (and while calibrating) the steady
+     * clock is used directly. Unlike the wall-clock timers above, values
+     * from this clock never jump when the system time is adjusted.
+     */
+    namespace HighResClock
+    {
+        /// @return monotonic nanoseconds since the first call in the process
+        uint64_t GetNanoseconds();
+
+        /// @return monotonic microseconds since the first call in the process
+        uint64_t GetMicroseconds();
+    }
+
+    /**
+     * Charges the nanoseconds between its construction and destruction to
+     * an accumulator, for timing 50-microsecond subsystem slices in place:
+     * @code
+     *   uint64_t sense_ns = 0;
+     *   { ScopeTimer t(sense_ns); sense(); }
+     * @endcode
+     */
+    class ScopeTimer
+    {
+    public:
+
+        /// start timing into the given nanosecond accumulator
+        explicit ScopeTimer( uint64_t& accumulatorNs )
+            : mAccumulatorNs(accumulatorNs)
+            , mStartNs(HighResClock::GetNanoseconds())
+        {}
+
+        /// charge the elapsed nanoseconds to the accumulator
+        ~ScopeTimer()
+        {
+            mAccumulatorNs += HighResClock::GetNanoseconds() - mStartNs;
+        }
+
+    private:
+
+        // not copyable; a copy would double-charge the accumulator
+        ScopeTimer( const ScopeTimer& );
+        ScopeTimer& operator=( const ScopeTimer& );
+
+        uint64_t&   mAccumulatorNs; ///< where the elapsed time is charged
+        uint64_t    mStartNs;       ///< clock value at construction
+    };
 
 }//end OpenNero
 
@@ -54,10 +54,6 @@ namespace OpenNero
     /// 64 bit floating point type
     typedef double             float64_t;
 
-    /// 8 bit char type
-    typedef char        char8_t;
-    /// 16 bit char type
-    typedef wchar_t     char16_t;
 
 } // end OpenNero
 
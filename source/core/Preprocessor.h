@@ -73,6 +73,22 @@
 #define NERO_ENABLE_ASSERTS (NERO_DEBUG && !NERO_TEST)
 #define NERO_ENABLE_ASSERT_WARNINGS NERO_ENABLE_ASSERTS
 
+// tiered invariant verification: expensive consistency checks (e.g.
+// Genome::verify, redundant lookups in the simulation tables) run on
+// every occurrence in debug builds, on every
+// NERO_VERIFY_SAMPLE_RATE-th occurrence in optimized builds, and are
+// compiled out entirely in final releases
+#if NERO_FINAL_RELEASE
+    #define NERO_VERIFY_LEVEL 0
+#elif NERO_DEBUG
+    #define NERO_VERIFY_LEVEL 2
+#else
+    #define NERO_VERIFY_LEVEL 1
+#endif
+
+// how many occurrences one sampled verification covers
+#define NERO_VERIFY_SAMPLE_RATE 16
+
 // unit tests
 #define NERO_ENABLE_UNIT_TESTS NERO_TEST
 
@@ -0,0 +1,84 @@
+//---------------------------------------------------
+// Name: OpenNero : RefCounted
+// Desc: Intrusive reference count bases for
+//       boost::intrusive_ptr
+//---------------------------------------------------
+
+#ifndef _CORE_REF_COUNTED_H_
+#define _CORE_REF_COUNTED_H_
+
+#include <boost/intrusive_ptr.hpp>
+#include <boost/smart_ptr/intrusive_ref_counter.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_free.hpp>
+
+namespace OpenNero
+{
+    /**
+     * CRTP base for objects held by boost::intrusive_ptr. The count
+     * lives inside the object, so a ref-counted object is one
+     * allocation instead of the object plus a shared_ptr control
+     * block, and taking or dropping a reference touches memory that is
+     * already hot. Use as
+     *
+     *     class Thing : public RefCounted<Thing> { ... };
+     *     typedef boost::intrusive_ptr<Thing> ThingPtr;
+     *
+     * The count is atomic; for types that live and die on one thread
+     * (or whose cross-thread handovers are already serialized by a
+     * mutex, which orders the count like everything else it protects)
+     * use RefCountedUnsafe, which replaces the atomic ops with plain
+     * increments. Neither base supports weak pointers - types that
+     * need them stay on shared_ptr.
+     */
+    template <class Derived>
+    class RefCounted :
+        public boost::intrusive_ref_counter<Derived, boost::thread_safe_counter>
+    {
+    };
+
+    /// the non-atomic variant of RefCounted for single-threaded domains
+    template <class Derived>
+    class RefCountedUnsafe :
+        public boost::intrusive_ref_counter<Derived, boost::thread_unsafe_counter>
+    {
+    };
+
+} // namespace OpenNero
+
+namespace boost
+{
+    namespace serialization
+    {
+        /// Serialize an intrusive_ptr the way a tracked raw pointer is
+        /// serialized: the archive allocates the object and resolves
+        /// aliases, and every intrusive_ptr loaded for the same object
+        /// takes its own reference on the shared instance. This keeps
+        /// containers of intrusive_ptr serializable just like the
+        /// shared_ptr containers they replace.
+        template<class Archive, class T>
+        void save(Archive& ar, const boost::intrusive_ptr<T>& ptr, const unsigned int)
+        {
+            T* raw = const_cast<T*>(ptr.get());
+            ar << boost::serialization::make_nvp("px", raw);
+        }
+
+        /// load an intrusive_ptr written by save above
+        template<class Archive, class T>
+        void load(Archive& ar, boost::intrusive_ptr<T>& ptr, const unsigned int)
+        {
+            T* raw = NULL;
+            ar >> boost::serialization::make_nvp("px", raw);
+            ptr = boost::intrusive_ptr<T>(raw);
+        }
+
+        /// split serialization of boost::intrusive_ptr into save/load
+        template<class Archive, class T>
+        void serialize(Archive& ar, boost::intrusive_ptr<T>& ptr, const unsigned int version)
+        {
+            boost::serialization::split_free(ar, ptr, version);
+        }
+    }
+}
+
+#endif // _CORE_REF_COUNTED_H_
@@ -0,0 +1,350 @@
+//---------------------------------------------------
+// Name: OpenNero : SmallVector
+// Desc:  contiguous vector with inline small-buffer storage
+//---------------------------------------------------
+
+#ifndef _CORE_SMALL_VECTOR_H_
+#define _CORE_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include "core/Error.h"
+
+namespace OpenNero
+{
+    /**
+     * A contiguous dynamic array that stores its first N elements inline,
+     * built for the AI data plane where nearly every observation, action
+     * and reward vector is a handful of doubles: vectors that fit the
+     * inline buffer never touch the heap, and moving a spilled vector
+     * steals its heap buffer instead of copying it. The interface is the
+     * subset of std::vector the engine (and the Python indexing suite)
+     * actually uses; element types must be copyable and
+     * default-constructible, which the arithmetic element types used here
+     * trivially are.
+     */
+    template <typename T, size_t N>
+    class SmallVector
+    {
+    public:
+
+        typedef T value_type;               ///< the element type
+        typedef size_t size_type;           ///< the size type
+        typedef ptrdiff_t difference_type;  ///< iterator difference type
+        typedef T& reference;               ///< reference to an element
+        typedef const T& const_reference;   ///< const reference to an element
+        typedef T* iterator;                ///< elements are contiguous
+        typedef const T* const_iterator;    ///< const iterator
+
+        SmallVector() : mData(mInline), mSize(0), mCapacity(N) {}
+
+        /// a vector of count value-initialized elements
+        explicit SmallVector(size_type count)
+            : mData(mInline), mSize(0), mCapacity(N)
+        {
+            resize(count);
+        }
+
+        /// a vector of count copies of value
+        SmallVector(size_type count, const T& value)
+            : mData(mInline), mSize(0), mCapacity(N)
+        {
+            assign(count, value);
+        }
+
+        /// a vector holding a copy of the range [first, last)
+        template <typename InputIterator>
+        SmallVector(InputIterator first, InputIterator last,
+                    typename std::enable_if<!std::is_integral<InputIterator>::value>::type* = 0)
+            : mData(mInline), mSize(0), mCapacity(N)
+        {
+            assign(first, last);
+        }
+
+        SmallVector(const SmallVector& other)
+            : mData(mInline), mSize(0), mCapacity(N)
+        {
+            assign(other.begin(), other.end());
+        }
+
+        /// moving steals the heap buffer of a spilled vector and copies the
+        /// elements of an inline one; the source is left empty either way
+        SmallVector(SmallVector&& other)
+            : mData(mInline), mSize(0), mCapacity(N)
+        {
+            take(other);
+        }
+
+        ~SmallVector()
+        {
+            if (!is_inline())
+                delete[] mData;
+        }
+
+        SmallVector& operator=(const SmallVector& other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        /// move assignment, with the same buffer stealing as the move constructor
+        SmallVector& operator=(SmallVector&& other)
+        {
+            if (this != &other)
+            {
+                if (!is_inline())
+                {
+                    delete[] mData;
+                    mData = mInline;
+                    mCapacity = N;
+                }
+                mSize = 0;
+                take(other);
+            }
+            return *this;
+        }
+
+        /// replace the contents with count copies of value
+        void assign(size_type count, const T& value)
+        {
+            clear();
+            reserve(count);
+            for (size_type i = 0; i < count; ++i)
+                mData[i] = value;
+            mSize = count;
+        }
+
+        /// replace the contents with a copy of the range [first, last)
+        template <typename InputIterator>
+        typename std::enable_if<!std::is_integral<InputIterator>::value>::type
+        assign(InputIterator first, InputIterator last)
+        {
+            clear();
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        /// number of stored elements
+        size_type size() const { return mSize; }
+
+        /// elements the current buffer can hold without reallocating
+        size_type capacity() const { return mCapacity; }
+
+        /// true iff the vector holds no elements
+        bool empty() const { return mSize == 0; }
+
+        /// drop every element, keeping the current buffer
+        void clear() { mSize = 0; }
+
+        /// make sure the buffer can hold at least count elements
+        void reserve(size_type count)
+        {
+            if (count > mCapacity)
+                grow(count);
+        }
+
+        /// grow or shrink to count elements, value-initializing new ones
+        void resize(size_type count)
+        {
+            resize(count, T());
+        }
+
+        /// grow or shrink to count elements, filling new ones with value
+        void resize(size_type count, const T& value)
+        {
+            reserve(count);
+            for (size_type i = mSize; i < count; ++i)
+                mData[i] = value;
+            mSize = count;
+        }
+
+        iterator begin() { return mData; }                  ///< first element
+        iterator end() { return mData + mSize; }            ///< one past the last element
+        const_iterator begin() const { return mData; }      ///< first element
+        const_iterator end() const { return mData + mSize; }///< one past the last element
+
+        reference operator[](size_type i) { Assert(i < mSize); return mData[i]; }              ///< indexed access
+        const_reference operator[](size_type i) const { Assert(i < mSize); return mData[i]; }  ///< indexed access
+
+        reference front() { Assert(mSize > 0); return mData[0]; }                 ///< first element
+        const_reference front() const { Assert(mSize > 0); return mData[0]; }     ///< first element
+        reference back() { Assert(mSize > 0); return mData[mSize - 1]; }          ///< last element
+        const_reference back() const { Assert(mSize > 0); return mData[mSize - 1]; } ///< last element
+
+        /// append an element, growing the buffer geometrically when full
+        void push_back(const T& value)
+        {
+            if (mSize == mCapacity)
+                grow(mCapacity * 2);
+            mData[mSize++] = value;
+        }
+
+        /// drop the last element
+        void pop_back()
+        {
+            Assert(mSize > 0);
+            --mSize;
+        }
+
+        /// insert an element before pos
+        iterator insert(iterator pos, const T& value)
+        {
+            const size_type index = (size_type)(pos - mData);
+            if (mSize == mCapacity)
+                grow(mCapacity * 2);
+            for (size_type i = mSize; i > index; --i)
+                mData[i] = mData[i - 1];
+            mData[index] = value;
+            ++mSize;
+            return mData + index;
+        }
+
+        /// insert a copy of the range [first, last) before pos
+        template <typename ForwardIterator>
+        typename std::enable_if<!std::is_integral<ForwardIterator>::value>::type
+        insert(iterator pos, ForwardIterator first, ForwardIterator last)
+        {
+            const size_type index = (size_type)(pos - mData);
+            const size_type count = (size_type)std::distance(first, last);
+            if (mSize + count > mCapacity)
+                grow(std::max(mSize + count, mCapacity * 2));
+            for (size_type i = mSize; i > index; --i)
+                mData[i + count - 1] = mData[i - 1];
+            for (size_type i = index; first != last; ++first, ++i)
+                mData[i] = *first;
+            mSize += count;
+        }
+
+        /// remove the element at pos
+        iterator erase(iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        /// remove the range [first, last)
+        iterator erase(iterator first, iterator last)
+        {
+            const size_type index = (size_type)(first - mData);
+            const size_type count = (size_type)(last - first);
+            for (size_type i = index; i + count < mSize; ++i)
+                mData[i] = mData[i + count];
+            mSize -= count;
+            return mData + index;
+        }
+
+        /// exchange contents with another vector
+        void swap(SmallVector& other)
+        {
+            SmallVector tmp(std::move(*this));
+            *this = std::move(other);
+            other = std::move(tmp);
+        }
+
+    private:
+
+        /// true iff the elements live in the inline buffer
+        bool is_inline() const { return mData == mInline; }
+
+        /// move the contents out of other into this (assumed empty) vector
+        void take(SmallVector& other)
+        {
+            if (other.is_inline())
+            {
+                for (size_type i = 0; i < other.mSize; ++i)
+                    mData[i] = other.mData[i];
+                mSize = other.mSize;
+            }
+            else
+            {
+                if (!is_inline())
+                    delete[] mData;
+                mData = other.mData;
+                mSize = other.mSize;
+                mCapacity = other.mCapacity;
+                other.mData = other.mInline;
+                other.mCapacity = N;
+            }
+            other.mSize = 0;
+        }
+
+        /// spill to a heap buffer of at least count elements
+        void grow(size_type count)
+        {
+            const size_type newCapacity = std::max(count, (size_type)N);
+            T* newData = new T[newCapacity];
+            for (size_type i = 0; i < mSize; ++i)
+                newData[i] = mData[i];
+            if (!is_inline())
+                delete[] mData;
+            mData = newData;
+            mCapacity = newCapacity;
+        }
+
+        T* mData;           ///< the element buffer (inline or heap)
+        size_type mSize;    ///< number of stored elements
+        size_type mCapacity;///< elements the buffer can hold
+        T mInline[N];       ///< the inline small-buffer storage
+    };
+
+    /// element-wise equality
+    template <typename T, size_t N>
+    bool operator==(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return left.size() == right.size()
+            && std::equal(left.begin(), left.end(), right.begin());
+    }
+
+    /// element-wise inequality
+    template <typename T, size_t N>
+    bool operator!=(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return !(left == right);
+    }
+
+    /// lexicographic order
+    template <typename T, size_t N>
+    bool operator<(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return std::lexicographical_compare(left.begin(), left.end(),
+                                            right.begin(), right.end());
+    }
+
+    /// lexicographic order
+    template <typename T, size_t N>
+    bool operator>(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return right < left;
+    }
+
+    /// lexicographic order
+    template <typename T, size_t N>
+    bool operator<=(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return !(right < left);
+    }
+
+    /// lexicographic order
+    template <typename T, size_t N>
+    bool operator>=(const SmallVector<T, N>& left, const SmallVector<T, N>& right)
+    {
+        return !(left < right);
+    }
+
+    /// output in the same format as the std::vector printer in Common.h
+    template <typename T, size_t N>
+    std::ostream& operator<<(std::ostream& out, const SmallVector<T, N>& v)
+    {
+        out << "[ ";
+        std::copy(v.begin(), v.end(), std::ostream_iterator<T>(out, " "));
+        out << "]";
+        return out;
+    }
+
+} //end OpenNero
+
+#endif //end _CORE_SMALL_VECTOR_H_
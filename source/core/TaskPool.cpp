@@ -0,0 +1,91 @@
+#include "core/Common.h"
+
+#include "core/TaskPool.h"
+
+namespace OpenNero
+{
+    TaskPool::TaskPool( size_t workers )
+        : mBusyCount(0)
+        , mShutdown(false)
+    {
+        if (workers == 0)
+        {
+            unsigned int cores = std::thread::hardware_concurrency();
+            workers = (cores > 1) ? cores - 1 : 1;
+        }
+        for (size_t i = 0; i < workers; ++i)
+        {
+            mWorkers.push_back(std::thread(&TaskPool::WorkerLoop, this));
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mShutdown = true;
+        }
+        mTaskReady.notify_all();
+        for (size_t i = 0; i < mWorkers.size(); ++i)
+        {
+            mWorkers[i].join();
+        }
+    }
+
+    void TaskPool::Submit( const Task& task )
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTasks.push_back(task);
+        }
+        mTaskReady.notify_one();
+    }
+
+    void TaskPool::WaitAll()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mTasks.empty() || mBusyCount > 0)
+        {
+            mAllDone.wait(lock);
+        }
+    }
+
+    void TaskPool::WorkerLoop()
+    {
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (mTasks.empty() && !mShutdown)
+                {
+                    mTaskReady.wait(lock);
+                }
+                if (mTasks.empty())
+                {
+                    // shutting down and nothing left to do
+                    return;
+                }
+                task = mTasks.front();
+                mTasks.pop_front();
+                ++mBusyCount;
+            }
+            task();
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                --mBusyCount;
+                if (mTasks.empty() && mBusyCount == 0)
+                {
+                    mAllDone.notify_all();
+                }
+            }
+        }
+    }
+
+    TaskPool& GetSharedTaskPool()
+    {
+        static TaskPool pool;
+        return pool;
+    }
+
+} // namespace OpenNero
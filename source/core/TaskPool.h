@@ -0,0 +1,75 @@
+//---------------------------------------------------
+// Name: OpenNero : TaskPool
+// Desc:  a persistent pool of worker threads
+//---------------------------------------------------
+
+#ifndef _CORE_TASKPOOL_H_
+#define _CORE_TASKPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/function.hpp>
+
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * A fixed set of worker threads that pull queued tasks until the pool is
+     * destroyed. The workers persist across frames, so dispatching a batch of
+     * per-tick jobs does not pay thread creation costs. Submitted tasks must
+     * be safe to run off the main thread (in particular, they must not touch
+     * the Python interpreter).
+     */
+    class TaskPool
+    {
+    public:
+        /// a unit of work to run on a worker thread
+        typedef boost::function<void()> Task;
+
+        /// create the pool
+        /// @param workers number of worker threads; 0 picks one per available
+        ///        core, leaving one core for the main thread
+        explicit TaskPool( size_t workers = 0 );
+
+        /// stop the workers and join them
+        ~TaskPool();
+
+        /// queue a task for execution on some worker
+        void Submit( const Task& task );
+
+        /// block until every queued and running task has finished
+        void WaitAll();
+
+        /// number of worker threads in the pool
+        size_t GetWorkerCount() const { return mWorkers.size(); }
+
+    private:
+
+        /// the loop run by each worker thread
+        void WorkerLoop();
+
+    private:
+
+        std::vector<std::thread> mWorkers;    ///< the persistent worker threads
+        std::deque<Task>         mTasks;      ///< tasks waiting to be picked up
+        std::mutex               mMutex;      ///< guards the queue and counters
+        std::condition_variable  mTaskReady;  ///< signaled when work is queued or the pool shuts down
+        std::condition_variable  mAllDone;    ///< signaled when the last task finishes
+        size_t                   mBusyCount;  ///< tasks currently being executed
+        bool                     mShutdown;   ///< set when the pool is being destroyed
+    };
+
+    /// The process-wide shared pool, sized to the available cores and
+    /// created on first use. Subsystems that parallelize a synchronous
+    /// phase (AI ticking, epoch evaluation, sensors) should dispatch on
+    /// this instead of keeping private worker threads, so the machine is
+    /// not oversubscribed when several of them run in one frame.
+    TaskPool& GetSharedTaskPool();
+
+} // namespace OpenNero
+
+#endif // _CORE_TASKPOOL_H_
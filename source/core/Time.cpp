@@ -1,27 +1,112 @@
-//--------------------------------------------------------
-// OpenNero : Time
-//  time operations
-//--------------------------------------------------------
-
-#include "core/Common.h"
-#include "core/ONTime.h"
-#include "core/TimeImpl.h"
-
-namespace OpenNero 
-{      
-    TimerPtr GetTimer()
-    {
-        TimerPtr result(new BoostTimer());
-        return result;
-    }
-
-    /// @return a static timer created only one
-    Timer& GetStaticTimer()
-    {
-        static BoostTimer sTimer;
-        return sTimer;
-    }
-
-    Timer::~Timer() {}        
-
-}//end OpenNero
+//--------------------------------------------------------
+// OpenNero : Time
+//  time operations
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/ONTime.h"
+#include "core/TimeImpl.h"
+
+#include <atomic>
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define NERO_HIGHRES_TSC 1
+#else
+#define NERO_HIGHRES_TSC 0
+#endif
+
+namespace OpenNero
+{
+    TimerPtr GetTimer()
+    {
+        TimerPtr result(new HighResTimer());
+        return result;
+    }
+
+    /// @return a static timer created only one
+    Timer& GetStaticTimer()
+    {
+        static HighResTimer sTimer;
+        return sTimer;
+    }
+
+    Timer::~Timer() {}
+
+    namespace HighResClock
+    {
+        namespace
+        {
+            /// monotonic nanoseconds from the standard steady clock
+            inline uint64_t SteadyNanos()
+            {
+                return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+#if NERO_HIGHRES_TSC
+            /// how long to calibrate the cycle counter against the steady
+            /// clock before trusting it (longer window, better frequency)
+            const uint64_t kCalibrationWindowNs = 20 * 1000 * 1000;
+
+            /// the locked-in conversion from cycle counts to nanoseconds.
+            /// nsBase/tscBase are sampled at the moment the scale locks, so
+            /// the handoff from steady-clock readings is continuous.
+            struct TscScale
+            {
+                uint64_t tscBase;    ///< cycle count when the scale locked
+                uint64_t nsBase;     ///< clock value when the scale locked
+                float64_t nsPerTick; ///< calibrated nanoseconds per cycle
+            };
+#endif
+        }
+
+        uint64_t GetNanoseconds()
+        {
+#if NERO_HIGHRES_TSC
+            // epochs are sampled on the first call ever
+            static const uint64_t tsc0 = __rdtsc();
+            static const uint64_t ns0 = SteadyNanos();
+            static std::atomic<const TscScale*> scale(NULL);
+
+            const TscScale* locked = scale.load(std::memory_order_acquire);
+            if (locked)
+            {
+                return locked->nsBase +
+                    (uint64_t)((__rdtsc() - locked->tscBase) * locked->nsPerTick);
+            }
+
+            // still calibrating: serve steady-clock time and lock in the
+            // cycle-counter frequency once the window is long enough
+            const uint64_t tsc = __rdtsc();
+            const uint64_t ns = SteadyNanos() - ns0;
+            if (ns >= kCalibrationWindowNs && tsc > tsc0)
+            {
+                TscScale* fresh = new TscScale;
+                fresh->tscBase = tsc;
+                fresh->nsBase = ns;
+                fresh->nsPerTick = (float64_t)ns / (float64_t)(tsc - tsc0);
+
+                const TscScale* expected = NULL;
+                if (!scale.compare_exchange_strong(expected, fresh,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed))
+                {
+                    delete fresh; // another thread locked the scale first
+                }
+            }
+            return ns;
+#else
+            static const uint64_t ns0 = SteadyNanos();
+            return SteadyNanos() - ns0;
+#endif
+        }
+
+        uint64_t GetMicroseconds()
+        {
+            return GetNanoseconds() / 1000;
+        }
+    }
+
+}//end OpenNero
@@ -42,6 +42,12 @@ namespace OpenNero
                 return (uint64_t)(microsec_clock::local_time() - mStartingTime).total_microseconds();
             }
 
+            /// @return time since last reset/constructor in nanoseconds
+            uint64_t getNanoseconds()
+            {
+                return getMicroseconds() * 1000;
+            }
+
             /// @return time since last reset/constructor in milliseconds
             uint64_t getMilliseconds()
             {
@@ -55,6 +61,60 @@ namespace OpenNero
                 out << to_simple_string(pt);
             }
     };
+
+    /// a Timer implementation on the monotonic high-resolution clock.
+    /// Unlike BoostTimer it can never jump when the wall clock is adjusted,
+    /// which makes it the right source for frame pacing and scheduling.
+    class HighResTimer : public Timer
+    {
+        private:
+            uint64_t mStartNs; ///< clock value at construction/reset
+        public:
+            HighResTimer()
+                : mStartNs(HighResClock::GetNanoseconds())
+            {
+                // nothing
+            }
+
+            ~HighResTimer()
+            {
+                // nothing
+            }
+
+            /// reset timer to 0
+            /// @return time since last reset/constructor
+            uint64_t resetMicroseconds()
+            {
+                uint64_t answer = getMicroseconds();
+                mStartNs = HighResClock::GetNanoseconds();
+                return answer;
+            }
+
+            /// @return time since last reset/constructor in nanoseconds
+            uint64_t getNanoseconds()
+            {
+                return HighResClock::GetNanoseconds() - mStartNs;
+            }
+
+            /// @return time since last reset/constructor in microseconds
+            uint64_t getMicroseconds()
+            {
+                return getNanoseconds() / 1000;
+            }
+
+            /// @return time since last reset/constructor in milliseconds
+            uint64_t getMilliseconds()
+            {
+                return getMicroseconds() / 1000;
+            }
+
+            /// print time stamp to output stream (wall clock, for log lines)
+            void stamp(std::ostream& out)
+            {
+                ptime pt(microsec_clock::local_time());
+                out << to_simple_string(pt);
+            }
+    };
 }
 
 #endif /*TIMEIMPL_H_*/
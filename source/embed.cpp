@@ -0,0 +1,28 @@
+//--------------------------------------------------------
+// OpenNero : embed
+//  stable C entry points for driving OpenNero in-process
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "game/Kernel.h"
+#include "embed.h"
+
+extern "C"
+{
+
+    int opennero_init( int argc, char** argv )
+    {
+        return OpenNero::Kernel::instance().InitializeEmbedded( argc, argv ) ? 0 : 1;
+    }
+
+    int opennero_step( float dt )
+    {
+        return OpenNero::Kernel::instance().StepEmbedded( dt ) ? 1 : 0;
+    }
+
+    void opennero_shutdown( void )
+    {
+        OpenNero::Kernel::instance().ShutdownEmbedded();
+    }
+
+} // extern "C"
@@ -0,0 +1,39 @@
+//--------------------------------------------------------
+// OpenNero : embed
+//  stable C entry points for driving OpenNero in-process
+//--------------------------------------------------------
+
+#ifndef _OPENNERO_EMBED_H_
+#define _OPENNERO_EMBED_H_
+
+/**
+ * Embedded library mode. An external orchestrator links against the
+ * OpenNEROLib target, calls opennero_init once, drives opennero_step
+ * from its own loop, and finishes with opennero_shutdown, avoiding the
+ * subprocess-and-sockets setup otherwise needed to control the engine.
+ * The functions are thin wrappers around Kernel::InitializeEmbedded,
+ * StepEmbedded and ShutdownEmbedded.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /// start the engine with the usual OpenNero command line
+    /// @return 0 on success, nonzero on failure
+    int opennero_init( int argc, char** argv );
+
+    /// advance the engine by one frame; dt is the fixed simulation step in
+    /// seconds, or a value <= 0 for the standalone wall-clock pacing
+    /// @return nonzero while the engine keeps running, 0 once it has stopped
+    int opennero_step( float dt );
+
+    /// tear the engine down; the inverse of opennero_init
+    void opennero_shutdown( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _OPENNERO_EMBED_H_
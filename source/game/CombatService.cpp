@@ -0,0 +1,209 @@
+#include <cmath>
+#include <algorithm>
+
+#include "core/Common.h"
+#include "math/Random.h"
+#include "game/CombatService.h"
+#include "game/Kernel.h"
+#include "game/SimContext.h"
+#include "game/SimEntity.h"
+#include "game/Simulation.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// lock an angle in degrees to [-180, 180]
+        double WrapDegrees(double a)
+        {
+            while (a > 180) a -= 360;
+            while (a < -180) a += 360;
+            return a;
+        }
+
+        /// candidate enemy sorted by distance to the shooter
+        struct Candidate
+        {
+            F32 dist;
+            SimId id;
+            Vector3f pos;
+            bool operator<(const Candidate& other) const { return dist < other.dist; }
+        };
+    }
+
+    CombatService& CombatService::instance()
+    {
+        static CombatService me;
+        return me;
+    }
+
+    CombatService::CombatService()
+        : mMaxFireRadius(300)   // MAX_FIRE_ACTION_RADIUS in mods/NERO/constants.py
+        , mMaxShotRadius(200)   // MAX_SHOT_RADIUS
+        , mAimTolerance(2)
+        , mEyeHeight(5)
+        , mObstacleTypes(1)     // OBJECT_TYPE_OBSTACLE
+    {
+    }
+
+    /// set the combat tuning parameters
+    void CombatService::SetParameters(F32 max_fire_radius,
+                                      F32 max_shot_radius,
+                                      F32 aim_tolerance,
+                                      F32 eye_height,
+                                      U32 obstacle_types)
+    {
+        Assert(max_fire_radius > 0 && max_shot_radius > 0);
+        mMaxFireRadius = max_fire_radius;
+        mMaxShotRadius = max_shot_radius;
+        mAimTolerance = aim_tolerance;
+        mEyeHeight = eye_height;
+        mObstacleTypes = obstacle_types;
+    }
+
+    /// register a fighter on the given team
+    void CombatService::AddCombatant(SimId id, U32 team)
+    {
+        mCombatants[id].team = team;
+    }
+
+    /// remove a fighter (killed or despawned)
+    void CombatService::RemoveCombatant(SimId id)
+    {
+        mCombatants.erase(id);
+    }
+
+    /// remove all fighters and their damage records
+    void CombatService::ClearCombatants()
+    {
+        mCombatants.clear();
+    }
+
+    /// true iff no obstacle blocks the segment between the two points
+    bool CombatService::LineOfSight(const Vector3f& from, const Vector3f& to) const
+    {
+        const Vector3f eye(0, 0, mEyeHeight);
+        SimEntityData hitEntity;
+        Vector3f hitPos;
+        return !Kernel::GetSimContext()->FindInRay(
+            hitEntity, hitPos, from + eye, to + eye, mObstacleTypes, false);
+    }
+
+    /// the closest enemy of the team with a clear line of sight
+    SimId CombatService::ClosestVisibleEnemy(U32 team, const Vector3f& pos, F32& dist) const
+    {
+        // gather everyone in range, then test sight lines closest-first so
+        // we usually pay for a single ray cast instead of one per enemy
+        std::vector<Candidate> candidates;
+        SimulationPtr sim = Kernel::GetSimContext()->getSimulation();
+        std::map<SimId, Combatant>::const_iterator iter;
+        for (iter = mCombatants.begin(); iter != mCombatants.end(); ++iter)
+        {
+            if (iter->second.team == team)
+                continue;
+            SimEntityPtr foe = sim->Find(iter->first);
+            if (!foe)
+                continue;
+            Candidate candidate;
+            candidate.pos = foe->GetPosition();
+            candidate.dist = candidate.pos.getDistanceFrom(pos);
+            candidate.id = iter->first;
+            if (candidate.dist < mMaxFireRadius)
+                candidates.push_back(candidate);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (LineOfSight(pos, candidates[i].pos))
+            {
+                dist = candidates[i].dist;
+                return candidates[i].id;
+            }
+        }
+        return 0;
+    }
+
+    /// resolve every firing shooter for this tick in one call
+    void CombatService::ResolveFire(const std::vector<SimId>& shooters,
+                                    std::vector<FireResult>& results)
+    {
+        results.clear();
+        results.resize(shooters.size());
+        SimulationPtr sim = Kernel::GetSimContext()->getSimulation();
+        for (size_t i = 0; i < shooters.size(); ++i)
+        {
+            FireResult& result = results[i];
+            result.shooter = shooters[i];
+            std::map<SimId, Combatant>::iterator me = mCombatants.find(shooters[i]);
+            SimEntityPtr self = sim->Find(shooters[i]);
+            if (me == mCombatants.end() || !self)
+                continue;
+
+            F32 dist = 0;
+            const Vector3f pos = self->GetPosition();
+            result.target = ClosestVisibleEnemy(me->second.team, pos, dist);
+            if (result.target == 0)
+                continue;
+
+            // how far off the target heading the shooter is aiming
+            SimEntityPtr target = sim->Find(result.target);
+            const Vector3f target_pos = target->GetPosition();
+            const double heading = RAD_2_DEG *
+                atan2(target_pos.Y - pos.Y, target_pos.X - pos.X);
+            result.aim_angle = (F32)WrapDegrees(heading - self->GetRotation().Z);
+            if (fabs(result.aim_angle) > mAimTolerance)
+                continue;
+
+            // attempt a shot with probability falling off with distance;
+            // line of sight was already established picking the target
+            const F32 d = (mMaxShotRadius - dist) / mMaxShotRadius;
+            if (RANDOM.randF() < d / 2)
+            {
+                Combatant& victim = mCombatants[result.target];
+                victim.curr_damage += 1;
+                result.hit = true;
+            }
+        }
+    }
+
+    /// damage taken since the last PopDamage, folded into the total
+    U32 CombatService::PopDamage(SimId id)
+    {
+        std::map<SimId, Combatant>::iterator found = mCombatants.find(id);
+        if (found == mCombatants.end())
+            return 0;
+        const U32 damage = found->second.curr_damage;
+        found->second.total_damage += damage;
+        found->second.curr_damage = 0;
+        return damage;
+    }
+
+    /// damage accumulated over the fighter's lifetime
+    U32 CombatService::GetTotalDamage(SimId id) const
+    {
+        std::map<SimId, Combatant>::const_iterator found = mCombatants.find(id);
+        if (found == mCombatants.end())
+            return 0;
+        return found->second.total_damage + found->second.curr_damage;
+    }
+
+    /// the team a fighter was registered on (0 if not registered)
+    U32 CombatService::GetTeam(SimId id) const
+    {
+        std::map<SimId, Combatant>::const_iterator found = mCombatants.find(id);
+        if (found == mCombatants.end())
+            return 0;
+        return found->second.team;
+    }
+
+    /// forget a fighter's damage (e.g. on respawn)
+    void CombatService::ResetDamage(SimId id)
+    {
+        std::map<SimId, Combatant>::iterator found = mCombatants.find(id);
+        if (found != mCombatants.end())
+        {
+            found->second.curr_damage = 0;
+            found->second.total_damage = 0;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef _GAME_COMBATSERVICE_H_
+#define _GAME_COMBATSERVICE_H_
+
+#include <map>
+#include <vector>
+#include "core/Common.h"
+#include "game/SimEntityData.h"
+
+namespace OpenNero
+{
+    /// the outcome of one shooter's firing attempt in a combat tick
+    struct FireResult
+    {
+        SimId shooter;  ///< who fired
+        SimId target;   ///< the closest visible enemy (0 = none in range)
+        F32 aim_angle;  ///< degrees the shooter is off the target heading
+        bool hit;       ///< true iff the shot landed and damage was recorded
+
+        FireResult() : shooter(0), target(0), aim_angle(0), hit(false) {}
+    };
+
+    /**
+     * Combat resolution for the NERO battle games. Python registers each
+     * fighter with its team and hands over the ids of everyone firing this
+     * tick in one ResolveFire call; target selection, line-of-sight tests
+     * against the collision world and damage bookkeeping all run here, so
+     * per-shooter ray casts cost no Boost.Python dispatch.
+     */
+    class CombatService
+    {
+    public:
+        /// singleton accessor
+        static CombatService& instance();
+
+        /// set the combat tuning parameters
+        /// @param max_fire_radius targets beyond this are ignored
+        /// @param max_shot_radius shot success probability falls to 0 here
+        /// @param aim_tolerance max degrees off the target heading that still fires
+        /// @param eye_height z-offset added to both ends of sight lines
+        /// @param obstacle_types object type mask that blocks line of sight
+        void SetParameters(F32 max_fire_radius,
+                           F32 max_shot_radius,
+                           F32 aim_tolerance,
+                           F32 eye_height,
+                           U32 obstacle_types);
+
+        /// register a fighter on the given team
+        void AddCombatant(SimId id, U32 team);
+
+        /// remove a fighter (killed or despawned)
+        void RemoveCombatant(SimId id);
+
+        /// remove all fighters and their damage records
+        void ClearCombatants();
+
+        /// resolve every firing shooter for this tick in one call
+        /// @param shooters ids of the fighters whose fire action is on
+        /// @param results one entry per shooter, in the same order
+        void ResolveFire(const std::vector<SimId>& shooters,
+                         std::vector<FireResult>& results);
+
+        /// damage taken since the last PopDamage, folded into the total
+        U32 PopDamage(SimId id);
+
+        /// damage accumulated over the fighter's lifetime
+        U32 GetTotalDamage(SimId id) const;
+
+        /// the team a fighter was registered on (0 if not registered)
+        U32 GetTeam(SimId id) const;
+
+        /// forget a fighter's damage (e.g. on respawn)
+        void ResetDamage(SimId id);
+
+    private:
+        /// what we track per registered fighter
+        struct Combatant
+        {
+            U32 team;          ///< team the fighter is on
+            U32 curr_damage;   ///< hits since the last PopDamage
+            U32 total_damage;  ///< hits over the fighter's lifetime
+            Combatant() : team(0), curr_damage(0), total_damage(0) {}
+        };
+
+        CombatService();
+
+        /// true iff no obstacle blocks the segment between the two points
+        bool LineOfSight(const Vector3f& from, const Vector3f& to) const;
+
+        /// the closest enemy of the team with a clear line of sight
+        /// @return the enemy id, or 0 if none is visible in range
+        SimId ClosestVisibleEnemy(U32 team, const Vector3f& pos, F32& dist) const;
+
+        F32 mMaxFireRadius;   ///< targets beyond this are ignored
+        F32 mMaxShotRadius;   ///< shot success probability falls to 0 here
+        F32 mAimTolerance;    ///< max degrees off target that still fires
+        F32 mEyeHeight;       ///< z-offset for sight lines
+        U32 mObstacleTypes;   ///< object type mask that blocks sight
+
+        std::map<SimId, Combatant> mCombatants; ///< everyone registered
+    };
+}
+
+#endif // _GAME_COMBATSERVICE_H_
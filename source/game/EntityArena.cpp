@@ -0,0 +1,107 @@
+#include "core/Common.h"
+
+#include "game/EntityArena.h"
+
+namespace OpenNero
+{
+    EntityArena::EntityArena()
+        : mSize(0)
+        , mIterationDepth(0)
+    {
+    }
+
+    ArenaHandle EntityArena::Add( SimEntityPtr ent )
+    {
+        AssertMsg( ent, "Adding a null entity to the entity arena!" );
+        if (mIterationDepth > 0) {
+            // cannot touch the slots mid-walk; the handle is issued when the
+            // queued add is applied, so callers that need it should look it
+            // up through the simulation after the tick
+            mPendingAdds.push_back(ent);
+            return ArenaHandle();
+        }
+        return PlaceNow(ent);
+    }
+
+    void EntityArena::Remove( const ArenaHandle& handle )
+    {
+        if (!IsValid(handle)) return;
+        if (mIterationDepth > 0) {
+            mPendingRemoves.push_back(handle);
+        } else {
+            VacateNow(handle);
+        }
+    }
+
+    SimEntityPtr EntityArena::Get( const ArenaHandle& handle ) const
+    {
+        if (!IsValid(handle)) return SimEntityPtr();
+        return mSlots[handle.mIndex].mEntity;
+    }
+
+    bool EntityArena::IsValid( const ArenaHandle& handle ) const
+    {
+        return handle.mIndex < mSlots.size()
+            && mSlots[handle.mIndex].mGeneration == handle.mGeneration
+            && mSlots[handle.mIndex].mEntity;
+    }
+
+    void EntityArena::BeginIteration()
+    {
+        ++mIterationDepth;
+    }
+
+    void EntityArena::EndIteration()
+    {
+        AssertMsg( mIterationDepth > 0, "Unbalanced EntityArena::EndIteration" );
+        if (--mIterationDepth == 0) {
+            // apply the operations queued while the walk was in progress
+            for (size_t i = 0; i < mPendingRemoves.size(); ++i) {
+                if (IsValid(mPendingRemoves[i])) {
+                    VacateNow(mPendingRemoves[i]);
+                }
+            }
+            mPendingRemoves.clear();
+            for (size_t i = 0; i < mPendingAdds.size(); ++i) {
+                PlaceNow(mPendingAdds[i]);
+            }
+            mPendingAdds.clear();
+        }
+    }
+
+    void EntityArena::clear()
+    {
+        AssertMsg( mIterationDepth == 0, "Clearing the entity arena during an iteration" );
+        mSlots.clear();
+        mFreeSlots.clear();
+        mPendingAdds.clear();
+        mPendingRemoves.clear();
+        mSize = 0;
+    }
+
+    ArenaHandle EntityArena::PlaceNow( SimEntityPtr ent )
+    {
+        uint32_t index;
+        if (!mFreeSlots.empty()) {
+            index = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(mSlots.size());
+            mSlots.push_back(Slot());
+        }
+        mSlots[index].mEntity = ent;
+        ++mSize;
+        return ArenaHandle(index, mSlots[index].mGeneration);
+    }
+
+    void EntityArena::VacateNow( const ArenaHandle& handle )
+    {
+        Slot& slot = mSlots[handle.mIndex];
+        slot.mEntity.reset();
+        // stamp the slot so outstanding handles to the old occupant go stale
+        ++slot.mGeneration;
+        mFreeSlots.push_back(handle.mIndex);
+        --mSize;
+    }
+
+} //end OpenNero
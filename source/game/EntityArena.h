@@ -0,0 +1,117 @@
+//--------------------------------------------------------
+// OpenNero : EntityArena
+//  a stable-iteration slot store for simulation entities
+//--------------------------------------------------------
+
+#ifndef _GAME_ENTITYARENA_H_
+#define _GAME_ENTITYARENA_H_
+
+#include <vector>
+#include "core/ONTypes.h"
+#include "game/SimEntity.h"
+
+namespace OpenNero
+{
+    /// A handle into the EntityArena. The handle remembers the generation of
+    /// the slot it was issued for, so a handle to an entity that has since
+    /// been removed (and whose slot has been reused) can be detected as stale.
+    struct ArenaHandle
+    {
+        uint32_t mIndex;        ///< index of the slot in the arena
+        uint32_t mGeneration;   ///< generation stamp of the slot at issue time
+
+        /// construct an invalid handle
+        ArenaHandle() : mIndex(0), mGeneration(0) {}
+
+        /// construct a handle for a particular slot and generation
+        ArenaHandle( uint32_t index, uint32_t generation )
+            : mIndex(index), mGeneration(generation) {}
+    };
+
+    /**
+     * A slot-based entity store that supports stable iteration: entities can
+     * be added and removed while the arena is being walked, without
+     * invalidating the walk and without copying the container first. Adds and
+     * removes that arrive while an iteration is in progress are queued and
+     * applied when the outermost iteration ends, so per-tick iteration over
+     * the arena does not allocate.
+     */
+    class EntityArena
+    {
+    public:
+
+        EntityArena();
+
+        /// Add an entity to the arena (deferred if an iteration is in progress)
+        /// @param ent the entity to add
+        /// @return a generation-stamped handle for the entity's slot
+        ArenaHandle Add( SimEntityPtr ent );
+
+        /// Remove the entity behind a handle (deferred if an iteration is in
+        /// progress); stale handles are ignored
+        void Remove( const ArenaHandle& handle );
+
+        /// Look up an entity by handle
+        /// @return the entity, or a null pointer if the handle is stale
+        SimEntityPtr Get( const ArenaHandle& handle ) const;
+
+        /// is this handle still attached to a live entity?
+        bool IsValid( const ArenaHandle& handle ) const;
+
+        /// number of live entities (not counting queued adds or removes)
+        size_t size() const { return mSize; }
+
+        /// number of slots to walk when iterating (some may be empty)
+        size_t GetSlotCount() const { return mSlots.size(); }
+
+        /// the entity in slot i, or a null pointer if the slot is free
+        /// @param i the slot index, in [0, GetSlotCount())
+        const SimEntityPtr& At( size_t i ) const { return mSlots[i].mEntity; }
+
+        /// the current handle for slot i (only meaningful if the slot is occupied)
+        ArenaHandle HandleAt( size_t i ) const
+        {
+            return ArenaHandle( static_cast<uint32_t>(i), mSlots[i].mGeneration );
+        }
+
+        /// mark the start of an iteration over the slots; adds and removes
+        /// will be queued until the matching EndIteration
+        void BeginIteration();
+
+        /// mark the end of an iteration; when the outermost iteration ends,
+        /// queued adds and removes are applied
+        void EndIteration();
+
+        /// remove all entities and queued operations, releasing slot storage
+        void clear();
+
+    private:
+
+        /// a slot holds one (possibly empty) entity and its generation stamp
+        struct Slot
+        {
+            SimEntityPtr mEntity;       ///< the entity, null if the slot is free
+            uint32_t     mGeneration;   ///< bumped every time the slot is vacated
+
+            Slot() : mGeneration(0) {}
+        };
+
+        /// place an entity into a slot right away
+        ArenaHandle PlaceNow( SimEntityPtr ent );
+
+        /// vacate a slot right away
+        void VacateNow( const ArenaHandle& handle );
+
+    private:
+
+        std::vector<Slot>        mSlots;          ///< the slots, iterated in order
+        std::vector<uint32_t>    mFreeSlots;      ///< indices of vacated slots to reuse
+        std::vector<SimEntityPtr>mPendingAdds;    ///< adds queued during iteration
+        std::vector<ArenaHandle> mPendingRemoves; ///< removes queued during iteration
+        size_t                   mSize;           ///< number of live entities
+        uint32_t                 mIterationDepth; ///< nesting depth of in-progress iterations
+    };
+
+} //end OpenNero
+
+#endif // _GAME_ENTITYARENA_H_
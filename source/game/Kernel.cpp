@@ -7,14 +7,149 @@
 #include "game/Kernel.h"
 #include "game/SimContext.h"
 #include "game/Mod.h"
+#include "game/factories/ResourceCache.h"
 #include "scripting/scriptIncludes.h"
 #include "gui/GuiEditBox.h"
 #include "gui/GuiManager.h"
 #include "core/Preprocessor.h"
+#include "core/AssertExt.h"
+#include "utils/Profiler.h"
+#include "math/Random.h"
+#include "rtneat/neat.h"
+#include "utils/MemoryMonitor.h"
+#include "utils/StartupReport.h"
+#include "core/ONTime.h"
+
+#include <chrono>
+#include <thread>
 
 namespace OpenNero
 {
+    /// most fixed-dt ticks a single main-loop frame will run in turbo mode
+    static const uint32_t kMaxTicksPerFrame = 1000;
+
+    namespace
+    {
+        /**
+         * Paces the main loop against the frame delay instead of letting it
+         * poll flat out. Between simulation ticks the governor sleeps until
+         * the next tick deadline (coarsely with the OS sleep, then spinning
+         * the final stretch on the high-resolution clock, since OS sleeps
+         * routinely overshoot by a scheduling quantum), tracks the jitter of
+         * the achieved tick interval against the target, and periodically
+         * logs the numbers. Rendered runs never sleep past the next display
+         * frame so animation stays smooth; catching up after a stall is the
+         * tick loop's job, the governor just stops sleeping.
+         */
+        class FramePacer
+        {
+        public:
+
+            FramePacer()
+                : mDeadlineNs(0), mLastTickNs(0), mTickCount(0)
+                , mJitterSumNs(0), mJitterMaxNs(0), mLateTicks(0)
+            {}
+
+            /// a simulation tick just ran; advance the deadline and record jitter
+            void TickRan( uint64_t targetNs )
+            {
+                const uint64_t now = HighResClock::GetNanoseconds();
+
+                if( mLastTickNs != 0 )
+                {
+                    const uint64_t interval = now - mLastTickNs;
+                    const uint64_t jitter = interval > targetNs ?
+                        interval - targetNs : targetNs - interval;
+                    ++mTickCount;
+                    mJitterSumNs += jitter;
+                    if( jitter > mJitterMaxNs )
+                        mJitterMaxNs = jitter;
+                    if( interval > targetNs + targetNs / 4 )
+                        ++mLateTicks;
+
+                    if( mTickCount >= kReportEveryTicks )
+                        Report( targetNs );
+                }
+                mLastTickNs = now;
+
+                // keep the cadence anchored to the previous deadline so
+                // small errors do not accumulate; after a stall re-anchor
+                // to now rather than scheduling a burst of instant ticks
+                mDeadlineNs = ( mDeadlineNs == 0 || mDeadlineNs + targetNs < now ) ?
+                    now + targetNs : mDeadlineNs + targetNs;
+            }
+
+            /// sleep until the next tick is due (or the next display frame,
+            /// whichever comes first for rendered runs)
+            void Pace( bool headless )
+            {
+                if( mDeadlineNs == 0 )
+                    return;
+
+                uint64_t wake = mDeadlineNs;
+                const uint64_t now = HighResClock::GetNanoseconds();
+                if( !headless && wake > now + kDisplayFrameNs )
+                    wake = now + kDisplayFrameNs;
+
+                SleepUntil( wake );
+            }
+
+        private:
+
+            /// sleep off all but the last stretch of the wait, then spin it
+            static void SleepUntil( uint64_t deadlineNs )
+            {
+                const uint64_t now = HighResClock::GetNanoseconds();
+                if( deadlineNs <= now )
+                    return;
+
+                const uint64_t remaining = deadlineNs - now;
+                if( remaining > kSpinWindowNs )
+                {
+                    std::this_thread::sleep_for(
+                        std::chrono::nanoseconds( remaining - kSpinWindowNs ) );
+                }
+
+                while( HighResClock::GetNanoseconds() < deadlineNs )
+                {
+                    // spin the final microseconds for a precise release
+                }
+            }
+
+            /// log the pacing stats for the last batch of ticks and reset
+            void Report( uint64_t targetNs )
+            {
+                LOG_F_DEBUG( "kernel", "frame pacing: target "
+                             << targetNs / 1000 << " us, mean jitter "
+                             << mJitterSumNs / mTickCount / 1000 << " us, max jitter "
+                             << mJitterMaxNs / 1000 << " us, late ticks "
+                             << mLateTicks << "/" << mTickCount );
+                mTickCount = 0;
+                mJitterSumNs = 0;
+                mJitterMaxNs = 0;
+                mLateTicks = 0;
+            }
+
+            /// how many microseconds of the wait to spin rather than sleep
+            static const uint64_t kSpinWindowNs = 200 * 1000;
 
+            /// display frame budget rendered runs never sleep past (~60 Hz)
+            static const uint64_t kDisplayFrameNs = 16 * 1000 * 1000;
+
+            /// ticks per jitter report (~10 s at the default 30 Hz)
+            static const uint64_t kReportEveryTicks = 300;
+
+            uint64_t mDeadlineNs;   ///< when the next tick is due (0 = not yet anchored)
+            uint64_t mLastTickNs;   ///< when the previous tick ran
+            uint64_t mTickCount;    ///< ticks since the last report
+            uint64_t mJitterSumNs;  ///< summed |interval - target| since the last report
+            uint64_t mJitterMaxNs;  ///< worst jitter since the last report
+            uint64_t mLateTicks;    ///< ticks that ran >25% past their target interval
+        };
+
+        /// the main loop governor (main thread only)
+        FramePacer sFramePacer;
+    }
 
 	/// singleton accessor
 	Kernel& Kernel::instance()
@@ -86,7 +221,10 @@ namespace OpenNero
 	Kernel::Kernel()
         : mIrrDevice()
         , mCurMod(new Mod())
+        , mSuspendedMods()
+        , mModRetention(false)
         , mTransitionInfo()
+        , mTimeScale(1.0f)
         , mAppConfig()
     {}
 
@@ -94,6 +232,19 @@ namespace OpenNero
 	Kernel::~Kernel()
 	{
 		flushCurrentMod();
+
+        // release any mods still parked in the retention cache
+        std::map<std::string, ModPtr>::iterator itr;
+        for( itr = mSuspendedMods.begin(); itr != mSuspendedMods.end(); ++itr )
+        {
+            if( itr->second->context )
+            {
+                itr->second->context->onPop();
+                itr->second->context.reset();
+            }
+        }
+        mSuspendedMods.clear();
+
         ScriptingEngine::instance().destroy();
 	}
 
@@ -144,6 +295,12 @@ namespace OpenNero
         {
             Assert( mIrrDevice );
 
+            // the first tick closes the measured startup window
+            StartupReport::MarkFirstTick();
+
+            // frame boundary for the hierarchical profiler
+            Profiler::instance().BeginFrame();
+
             // get the current time
             static uint32_t prevTime = GetStaticTimer().getMilliseconds();
             static uint32_t prevFullFrameTime = GetStaticTimer().getMilliseconds();
@@ -151,16 +308,217 @@ namespace OpenNero
             float32_t dt = (curTime - prevTime)/1000.0f; // frame length in seconds
             float32_t fullDT = (curTime - prevFullFrameTime)/1000.0f; // full frame length
             float32_t frameDelay = mCurMod->context->GetFrameDelay(); // expected frame delay
-            
+
+            // scale elapsed simulation time relative to wall-clock time
+            dt *= mTimeScale;
+            fullDT *= mTimeScale;
+
+            bool ranTick = false;
             if (fullDT >= frameDelay) {
-                mCurMod->context->ProcessTick(dt);
+                // a frame that fell a whole tick (or more) behind is caught
+                // up the same way turbo mode catches up with the scaled
+                // clock: fixed-dt ticks back to back, capped so one slow
+                // frame cannot snowball into an ever-growing backlog
+                bool behind = frameDelay > 0 && fullDT >= 2 * frameDelay;
+                if ((mTimeScale > 1.0f || behind) && frameDelay > 0) {
+                    uint32_t ticks = static_cast<uint32_t>(fullDT / frameDelay);
+                    if (ticks > kMaxTicksPerFrame) ticks = kMaxTicksPerFrame;
+                    for (uint32_t i = 0; i < ticks; ++i) {
+                        mCurMod->context->ProcessTick(frameDelay);
+                    }
+                } else {
+                    mCurMod->context->ProcessTick(dt);
+                }
+                ranTick = true;
                 prevFullFrameTime = curTime;
             } else {
                 mCurMod->context->ProcessAnimationTick(dt, fullDT/frameDelay);
             }
             prevTime = curTime;
+
+            Profiler::instance().EndFrame();
+
+            // periodic per-subsystem memory log, if enabled
+            MemoryMonitor::instance().ProcessTick();
+
+            // pace the loop against the frame delay instead of polling flat
+            // out; with no delay configured the loop stays uncapped
+            if (frameDelay > 0) {
+                const uint64_t targetNs =
+                    (uint64_t)(frameDelay / mTimeScale * 1e9f);
+                if (ranTick)
+                    sFramePacer.TickRan(targetNs);
+                sFramePacer.Pace(mCurMod->context->IsHeadless());
+            }
+        }
+
+    }
+
+    /**
+     * Bring the engine up without owning the process loop. Runs the same
+     * startup sequence as OpenNeroMain — command line, logging, render
+     * device, start mod and start command — and then returns, leaving the
+     * caller to drive StepEmbedded from its own loop.
+     * @return true if the engine is ready to step
+     */
+    bool Kernel::InitializeEmbedded( int argc, char** argv )
+    {
+        using namespace irr;
+        using namespace irr::core;
+
+        AppConfig appConfig;
+        if( !appConfig.ParseCommandLine(argc, argv) )
+            return false;
+
+        OpenNero::Log::LogSystemInit(appConfig.LogFile);
+
+        // configure our log receivers
+        LogSpecifyReceivers( argc, argv, appConfig.LogConfigFile );
+
+        LOG_MSG( "Starting OpenNero" );
+
+        // create our video device
+        video::E_DRIVER_TYPE driverType = ( appConfig.RenderType == "null" ) ? video::EDT_NULL : video::EDT_OPENGL;
+
+        IrrlichtDevice_IPtr irrDevice( createDevice( driverType, dimension2d<u32>( appConfig.Width, appConfig.Height),
+                                                     appConfig.BPP, appConfig.FullScreen, appConfig.StencilBuffer, appConfig.VSync ), false );
+        if( !irrDevice )
+        {
+            LOG_ERROR( "Could not create the render device" );
+            return false;
+        }
+
+    #if NERO_DEBUG
+        AssertExt::SetDevice( irrDevice.get() );
+    #endif
+
+        StartupReport::MarkStage("render device");
+
+        // set the window title
+        std::wstring wWindowName = boost::lexical_cast<std::wstring>( appConfig.Title.c_str() );
+        irrDevice->setWindowCaption(wWindowName.c_str());
+        irrDevice->setResizable(true);
+
+        // initialize the kernel and start the first mod
+        Initialize(irrDevice, appConfig, argc, argv);
+        switchMod( irrDevice, appConfig.StartMod, appConfig.StartModMode, appConfig.StartModDir );
+        if (!appConfig.StartCommand.empty())
+        {
+            ScriptingEngine::instance().Exec(appConfig.StartCommand);
+        }
+
+        return true;
+    }
+
+    /// run one frame of the embedded engine; with dt > 0 the simulation
+    /// advances by exactly one fixed tick of dt seconds, so an external
+    /// driver controls simulation time directly
+    bool Kernel::StepEmbedded( float32_t dt )
+    {
+        if( !mIrrDevice || !mIrrDevice->run() )
+            return false;
+
+        if( dt > 0 )
+            RunTicks( 1, dt );
+        else
+            ProcessTick();
+
+        return true;
+    }
+
+    /// tear the embedded engine down; the inverse of InitializeEmbedded
+    void Kernel::ShutdownEmbedded()
+    {
+        flushCurrentMod();
+
+        LOG_MSG( "Killing OpenNero" );
+
+    #if NERO_DEBUG
+        AssertExt::ReleaseDevice();
+    #endif
+
+        // drop the kernel's reference so the device shuts down now rather
+        // than at static destruction time in the host process
+        setIrrDevice( IrrlichtDevice_IPtr() );
+
+        OpenNero::Log::LogSystemShutdown();
+    }
+
+    /// immediately run n fixed-timestep ticks of dt seconds of simulation
+    /// time each; wall-clock time is irrelevant, so this runs as fast as the
+    /// CPU allows
+    void Kernel::RunTicks( uint32_t n, float32_t dt )
+    {
+        if( !mCurMod->context )
+        {
+            LOG_ERROR( "Could not RunTicks, no mod loaded!" );
+            return;
+        }
+        for( uint32_t i = 0; i < n; ++i )
+        {
+            mCurMod->context->ProcessTick(dt);
         }
+    }
 
+    void Kernel::QueueExperiment( const ExperimentSpec& spec )
+    {
+        mExperimentQueue.push_back(spec);
+    }
+
+    /**
+     * Run the queued experiments sequentially in this process. Each run
+     * reseeds the random generators, loads its mod from scratch (mod
+     * retention is disabled for the duration of the batch so every run
+     * starts from a fresh SimContext), executes its start command and then
+     * runs its tick budget flat out, mirroring what a standalone
+     * --mod/--command/RunTicks invocation would do without paying process
+     * startup per evaluation.
+     * @return the number of experiments run
+     */
+    size_t Kernel::RunExperimentQueue()
+    {
+        // swap the queue out so commands run by the experiments can queue
+        // a follow-up batch without mutating the one we are iterating
+        std::vector<ExperimentSpec> batch;
+        batch.swap(mExperimentQueue);
+
+        if( batch.empty() )
+            return 0;
+
+        // force full teardown between runs; a suspended mod resumed in
+        // place would leak state from one experiment into the next
+        const bool retention = mModRetention;
+        mModRetention = false;
+
+        for( size_t i = 0; i < batch.size(); ++i )
+        {
+            const ExperimentSpec& spec = batch[i];
+
+            LOG_F_MSG( "game", "Experiment " << (i + 1) << "/" << batch.size()
+                       << ": mod " << spec.mod << ", seed " << spec.seed
+                       << ", " << spec.ticks << " ticks" );
+
+            // reseed before the mod loads so its setup scripts already
+            // draw from the per-run stream
+            NEAT::seed_random( spec.seed );
+            RANDOM.seed( spec.seed );
+
+            switchMod( spec.mod, "", spec.modPath );
+            if( !spec.command.empty() )
+            {
+                ScriptingEngine::instance().Exec( spec.command );
+            }
+            if( spec.ticks > 0 )
+            {
+                RunTicks( spec.ticks, spec.dt );
+            }
+        }
+
+        mModRetention = retention;
+
+        LOG_F_MSG( "game", "Experiment batch done: " << batch.size() << " runs" );
+
+        return batch.size();
     }
 
     /// @param caption the part of the window title after OpenNero - ModName
@@ -173,7 +531,7 @@ namespace OpenNero
             } else {
                 full_caption = GetAppConfig().Title + " - " + mCurMod->name + " - " + caption;
             }
-            mIrrDevice->setWindowCaption(core::stringw(full_caption.c_str()).c_str());
+            mIrrDevice->setWindowCaption(irr::core::stringw(full_caption.c_str()).c_str());
         } else {
             LOG_ERROR("Could not SetWindowCaption, no mod loaded!");
         }
@@ -193,6 +551,35 @@ namespace OpenNero
 		mCurMod->SetPath("");
 	}
 
+    /**
+     * Create an additional headless context for batched environment
+     * stepping. The worker shares the kernel's device but runs on its own
+     * scene manager, so its entities and collision queries never mix with
+     * the visible context's scene graph.
+     * @return a ptr to the new worker context (NULL on failure)
+    */
+    SimContextPtr Kernel::createWorkerContext()
+    {
+        Assert( mIrrDevice );
+
+        // a fresh scene manager gives the worker a private scene graph;
+        // the intrusive ptr adopts the reference createNewSceneManager adds
+        ISceneManager_IPtr sceneManager(
+            mIrrDevice->getSceneManager()->createNewSceneManager(false), false );
+
+        SimContextPtr context( new SimContext );
+        if( !context->Initialize( mIrrDevice, sceneManager ) )
+        {
+            context.reset();
+            return context;
+        }
+
+        // workers are never drawn
+        context->SetHeadless(true);
+        context->onPushWorker();
+        return context;
+    }
+
     /// Switch to a new context
     SimContextPtr Kernel::switchMod( const std::string& name, const std::string& mode, const std::string& path )
     {
@@ -212,8 +599,39 @@ namespace OpenNero
         // save the device
         setIrrDevice(device);
 
-		// kill the old mod if loaded
-		flushCurrentMod();
+        if( mModRetention && mCurMod->context )
+        {
+            // freeze the outgoing mod in place instead of tearing it down
+            LOG_F_MSG( "game", "Suspending mod " << mCurMod->name );
+            mCurMod->context->onSuspend();
+            mSuspendedMods[mCurMod->name] = mCurMod;
+            mCurMod.reset(new Mod());
+        }
+        else
+        {
+            // kill the old mod if loaded
+            flushCurrentMod();
+        }
+
+        // resume the target mod in place when we have it parked
+        std::map<std::string, ModPtr>::iterator suspended = mSuspendedMods.find(name);
+        if( suspended != mSuspendedMods.end() )
+        {
+            LOG_F_MSG( "game", "Resuming mod " << name );
+            mCurMod = suspended->second;
+            mSuspendedMods.erase(suspended);
+            mCurMod->mode = mode;
+            if( mCurMod->GetPath() != path )
+                mCurMod->SetPath(path);
+            mCurMod->context->onResume();
+            SetWindowCaption("");
+            return mCurMod->context;
+        }
+
+        // mod-switch boundary for the device-lifetime resource cache: the
+        // old scene is gone, so over-budget textures can be evicted safely
+        // (suspended scenes still hold references, so theirs survive)
+        ResourceCache::instance().BeginEpoch( device->getVideoDriver() );
 
         if( mCurMod->context )
         {
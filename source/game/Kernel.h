@@ -6,6 +6,7 @@
 #ifndef _GAME_KERNEL_H_
 #define _GAME_KERNEL_H_
 
+#include <map>
 #include <vector>
 #include "core/Common.h"
 #include "core/IrrUtil.h"
@@ -78,9 +79,43 @@ namespace OpenNero
         /// main processing method, makes things step forward
         void ProcessTick();
 
+        /// immediately run n fixed-timestep simulation ticks of length dt
+        /// seconds each, without waiting for wall-clock time to pass
+        void RunTicks( uint32_t n, float32_t dt );
+
+        /// scale simulation time relative to wall-clock time; with k > 1 the
+        /// main loop runs as many fixed-dt ticks per frame as the scaled
+        /// elapsed time allows
+        void SetTimeScale( float32_t k ) { mTimeScale = k; }
+
+        /// get the current simulation time scale
+        float32_t GetTimeScale() const { return mTimeScale; }
+
+        // ******* Embedded library mode *******
+
+        /// bring the engine up without owning the process loop: parses the
+        /// command line, starts logging, creates the render device and loads
+        /// the start mod, exactly as the standalone app does before entering
+        /// its main loop. The caller then drives StepEmbedded itself.
+        bool InitializeEmbedded( int argc, char** argv );
+
+        /// run one frame of the embedded engine: pumps the device event loop
+        /// and advances the simulation by dt seconds (dt <= 0 uses the
+        /// standalone wall-clock pacing instead of a fixed step)
+        /// @return false once the device has been closed
+        bool StepEmbedded( float32_t dt );
+
+        /// tear the embedded engine down; the inverse of InitializeEmbedded
+        void ShutdownEmbedded();
+
 		/// dispose of the currently loaded Mod's resources
 		void flushCurrentMod();
 
+        /// create an additional headless SimContext sharing the kernel's
+        /// device but with its own simulation and scene graph; used by
+        /// SimContextPool for batched environment stepping
+        SimContextPtr   createWorkerContext();
+
 		/// switch to a new Mod
         SimContextPtr	switchMod( const std::string& name, const std::string& mode, const std::string& path );
 
@@ -98,7 +133,39 @@ namespace OpenNero
 
         /// request a mod switch next frame
         void RequestModSwitch( IrrlichtDevice_IPtr device, const std::string& name, const std::string& mode, const std::string& path );
-        
+
+        /// retain suspended mods on switch instead of destroying them, so
+        /// switching back resumes the old context in place
+        void SetModRetention( bool enable ) { mModRetention = enable; }
+
+        /// true iff mod switches suspend/resume instead of teardown/rebuild
+        bool GetModRetention() const { return mModRetention; }
+
+        // ******* Sequential experiment batches *******
+
+        /// one entry in the kernel's experiment queue: a mod to load, a
+        /// command to start it, a random seed and a tick budget
+        struct ExperimentSpec
+        {
+            std::string mod;     ///< name of the mod to load
+            std::string modPath; ///< resource search path ( separated by ':' )
+            std::string command; ///< Python command run once the mod is loaded
+            uint32_t    ticks;   ///< number of fixed simulation ticks to run
+            float32_t   dt;      ///< length of each tick in seconds
+            uint32_t    seed;    ///< random seed for the run
+
+            ExperimentSpec() : ticks(0), dt(0), seed(0) {}
+        };
+
+        /// append an experiment to the batch queue
+        void QueueExperiment( const ExperimentSpec& spec );
+
+        /// run the queued experiments back to back in this process, with a
+        /// full mod teardown and freshly seeded random generators between
+        /// runs, so one process startup is amortized over the whole batch
+        /// @return the number of experiments run
+        size_t RunExperimentQueue();
+
         /// Sets the part of the window title after OpenNero - ModName
         void SetWindowCaption(const std::string& caption);
 
@@ -115,6 +182,11 @@ namespace OpenNero
 		IrrlichtDevice_IPtr			mIrrDevice;	///< Irrlicht Rendering device
 		ModPtr						mCurMod;	///< Current loaded mod
 
+        /// mods suspended in place by a retention switch, keyed by name
+        std::map<std::string, ModPtr> mSuspendedMods;
+
+        bool            mModRetention;   ///< suspend/resume mods on switch instead of rebuilding them
+
         struct TransitionInfo
         {
             IrrlichtDevice_IPtr     mDevice;
@@ -128,9 +200,14 @@ namespace OpenNero
 
         TransitionInfo mTransitionInfo; ///< The transition information
 
+        /// experiments waiting for RunExperimentQueue
+        std::vector<ExperimentSpec> mExperimentQueue;
+
         int             mArgc;           /// number of command line arguments
         char**          mArgv;           /// argv
 
+        float32_t       mTimeScale;      ///< simulation-to-wall-clock time ratio
+
         AppConfig mAppConfig;
 	};
 
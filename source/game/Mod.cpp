@@ -1,6 +1,7 @@
 #include "core/Common.h"
 #include "core/File.h"
 #include "game/Mod.h"
+#include "game/ModBundle.h"
 #include <sstream>
 #define BOOST_FILESYSTEM_VERSION 3
 #include <boost/filesystem.hpp>
@@ -59,8 +60,26 @@ namespace OpenNero
     /// @return true iff the resource is found and path is set
     bool Mod::FindResource(const string& name, string& path)
     {
+        // spawning waves resolve the same meshes and textures over and over;
+        // only the first lookup of a name probes the filesystem
+        ResourceCache::const_iterator needle = mResourceCache.find(name);
+        if (needle != mResourceCache.end()) {
+            path = needle->second;
+            return true;
+        }
+
+        // the directory index built at SetPath time answers mod-relative
+        // names in one map hit instead of a stat() per path element
+        needle = mResourceIndex.find(name);
+        if (needle != mResourceIndex.end()) {
+            path = needle->second;
+            mResourceCache[name] = path;
+            return true;
+        }
+
 		if (FileExists(name)) {
 			path = name;
+            mResourceCache[name] = path;
 			return true;
 		}
         vector<string>::const_iterator path_elts;
@@ -72,9 +91,55 @@ namespace OpenNero
             if (FileExists(location))
             {
                 path = FilePathJoin(path_element, name);
+                mResourceCache[name] = path;
                 return true;
             }
         }
+        // a packed bundle backs the disk: a name nothing on the search
+        // path provides resolves to itself, and bundle-aware loaders
+        // fetch the contents with FindResourceBytes under the same name
+        const char* data;
+        size_t size;
+        if (FindResourceBytes(name, data, size)) {
+            path = name;
+            mResourceCache[name] = path;
+            return true;
+        }
+
+        // misses are not cached - the file may yet be created (e.g. saved
+        // by the user) and be expected to resolve on a later call
+        return false;
+    }
+
+    /// attach a packed bundle; bundled names resolve after the disk
+    bool Mod::AddBundle(const std::string& bundleFile)
+    {
+        ModBundlePtr bundle(new ModBundle(bundleFile));
+        if (!bundle->IsOpen()) {
+            return false;
+        }
+        mBundles.push_back(bundle);
+        // names that missed before may now resolve through the bundle
+        ClearResourceCache();
+        return true;
+    }
+
+    /// detach all bundles
+    void Mod::ClearBundles()
+    {
+        mBundles.clear();
+        ClearResourceCache();
+    }
+
+    /// look up a resource's contents in the attached bundles
+    bool Mod::FindResourceBytes(const std::string& name, const char*& data, size_t& size)
+    {
+        vector<ModBundlePtr>::const_iterator bundle;
+        for (bundle = mBundles.begin(); bundle != mBundles.end(); ++bundle)
+        {
+            if ((*bundle)->Find(name, data, size))
+                return true;
+        }
         return false;
     }
 
@@ -100,6 +165,9 @@ namespace OpenNero
     void Mod::SetPath(string path)
     {
         mPath.clear();
+        ClearResourceCache();
+        // a new search path means a new mod; its bundles are attached anew
+        mBundles.clear();
         string element;
         istringstream iss(path);
         while ( getline(iss, element, ':') )
@@ -110,8 +178,50 @@ namespace OpenNero
 #endif // NERO_DEBUG
             mPath.push_back(element);
         }
+        RefreshResourceIndex();
     }
-    
+
+    /// walk every directory on the search path once and index its files by
+    /// their path relative to the search root; the first path element that
+    /// provides a name wins, matching the probing order of FindResource
+    void Mod::RefreshResourceIndex()
+    {
+        mResourceIndex.clear();
+        vector<string>::const_iterator path_elts;
+        for (path_elts = mPath.begin(); path_elts != mPath.end(); ++path_elts)
+        {
+            fs::path root(*path_elts);
+            try
+            {
+                if (!fs::is_directory(root))
+                    continue;
+                string prefix = root.generic_string();
+                fs::recursive_directory_iterator itr(root), end;
+                for (; itr != end; ++itr)
+                {
+                    if (!fs::is_regular_file(itr->status()))
+                        continue;
+                    string rel = itr->path().generic_string().substr(prefix.size());
+                    while (!rel.empty() && rel[0] == '/')
+                        rel.erase(0, 1);
+                    if (mResourceIndex.find(rel) == mResourceIndex.end())
+                        mResourceIndex[rel] = itr->path().string();
+                }
+            }
+            catch (const fs::filesystem_error&)
+            {
+                // an unreadable path element just falls back to probing
+                continue;
+            }
+        }
+    }
+
+    /// forget the resolved resource locations
+    void Mod::ClearResourceCache()
+    {
+        mResourceCache.clear();
+    }
+
     /// get the path of this mod (separated by ':')
     std::string Mod::GetPath()
     {
@@ -1,18 +1,27 @@
 #ifndef _GAME_MOD_H
 #define _GAME_MOD_H
 
+#include "core/HashMap.h"
+
 namespace OpenNero
 {
 
     /// @cond
     BOOST_PTR_DECL(SimContext);
+    BOOST_PTR_DECL(ModBundle);
     /// @endcond
-    
+
     /// description structure for a game mod
     class Mod
     {
+        /// resolved resource locations by mod-relative name
+        typedef hash_map<std::string, std::string> ResourceCache;
+
         std::vector<std::string>     mPath;     ///< Base Directory for the Mod
 		std::string                  mUserPrefix; ///< directory with write access for storing user files
+        ResourceCache                mResourceCache; ///< names resolved to paths, so repeat loads skip the filesystem probes
+        ResourceCache                mResourceIndex; ///< every file under the search path, indexed once at SetPath time
+        std::vector<ModBundlePtr>    mBundles;  ///< attached packed bundles, searched after the disk
 
     public:
         SimContextPtr                context;  ///< Context for this mod
@@ -24,12 +33,39 @@ namespace OpenNero
 
         /// find resource by name (normally relative path)
         bool FindResource(const std::string& name, std::string& path);
+
+        /// Attach a packed bundle (see ModBundle). Bundled names resolve
+        /// after the files on disk, so a file present in both keeps
+        /// loading from the disk as before.
+        /// @param bundleFile path of the .onb file to map
+        /// @return true iff the bundle was mapped and indexed
+        bool AddBundle(const std::string& bundleFile);
+
+        /// detach all bundles (SetPath does this too)
+        void ClearBundles();
+
+        /// Look up a resource's contents in the attached bundles. The
+        /// returned pointer aims into the bundle mapping and stays valid
+        /// until the bundle is detached.
+        /// @param name mod-relative name of the resource
+        /// @param data set to the first byte of the contents on a hit
+        /// @param size set to the byte size of the contents on a hit
+        /// @return true iff a bundle serves the name
+        bool FindResourceBytes(const std::string& name, const char*& data, size_t& size);
         
         /// Get the location of the existing resource or a location where it can be saved
         bool FindUserResource(const std::string& name, std::string& path);
         
         /// set the path of this mod by parsing a colon-separated string
         void SetPath(std::string path);
+
+        /// forget the resolved resource locations (call after the search
+        /// path or the files on disk change)
+        void ClearResourceCache();
+
+        /// rebuild the directory index of the current search path (called by
+        /// SetPath; call again if files are added under the path at runtime)
+        void RefreshResourceIndex();
         
         /// get the path of this mod (separated by ':')
         std::string GetPath();
@@ -0,0 +1,198 @@
+#include "core/Common.h"
+#include "game/ModBundle.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#define BOOST_FILESYSTEM_VERSION 3
+#include <boost/filesystem.hpp>
+
+#include "core/Bitstream.h"
+#include "core/Log.h"
+
+namespace OpenNero
+{
+    namespace fs = boost::filesystem;
+
+    namespace
+    {
+        /// magic number identifying a mod bundle ('ONMB')
+        const uint32_t kBundleMagic = 0x4F4E4D42;
+
+        /// version of the bundle format
+        const uint32_t kBundleVersion = 1;
+
+        /// the raw header before the index: magic, version, index bytes
+        const size_t kHeaderBytes = 3 * sizeof(uint32_t);
+
+        /// should Bake() leave this file out of the bundle?
+        bool SkipWhenBaking( const fs::path& file )
+        {
+            const std::string ext = file.extension().string();
+            // the interpreter imports Python sources from real files,
+            // and a bundle inside the tree must not nest itself
+            return ext == ".py" || ext == ".pyc" || ext == ".onb";
+        }
+
+        /// Serialize the index: one record per file, offsets measured
+        /// from the start of the bundle. The records are fixed-width
+        /// apart from the names, so the index size does not depend on
+        /// the offset values and one sizing pass with zeros is exact.
+        void BuildIndex( Bitstream& index,
+                         const std::vector<std::string>& names,
+                         const std::vector<uint32_t>& offsets,
+                         const std::vector<uint32_t>& sizes )
+        {
+            index.Clear();
+            index << (uint32_t)names.size();
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                index << names[i] << offsets[i] << sizes[i];
+            }
+        }
+    }
+
+    /// map and index a baked bundle file
+    ModBundle::ModBundle( const std::string& bundleFile )
+        : mView( bundleFile, ReadOnlyFileView::ACCESS_RANDOM )
+        , mFileName( bundleFile )
+        , mOpen( false )
+    {
+        if( !mView.IsOpen() || mView.Size() < kHeaderBytes )
+        {
+            LOG_F_ERROR( "game", "could not open mod bundle " << bundleFile );
+            return;
+        }
+
+        uint32_t magic = 0, version = 0, indexBytes = 0;
+        memcpy( &magic, mView.Data(), sizeof(magic) );
+        memcpy( &version, mView.Data() + sizeof(uint32_t), sizeof(version) );
+        memcpy( &indexBytes, mView.Data() + 2 * sizeof(uint32_t), sizeof(indexBytes) );
+        if( magic != kBundleMagic || version != kBundleVersion
+            || kHeaderBytes + indexBytes > mView.Size() )
+        {
+            LOG_F_ERROR( "game", "mod bundle " << bundleFile << " has an unknown format" );
+            return;
+        }
+
+        BitstreamView index( (const uint8_t*)mView.Data() + kHeaderBytes, indexBytes );
+        uint32_t count = 0;
+        index >> count;
+        for( uint32_t i = 0; i < count; ++i )
+        {
+            std::string name;
+            uint32_t offset = 0, size = 0;
+            index >> name >> offset >> size;
+            if( (size_t)offset + size > mView.Size() )
+            {
+                LOG_F_ERROR( "game", "mod bundle " << bundleFile << " is truncated" );
+                mEntries.clear();
+                return;
+            }
+            Entry entry;
+            entry.data = mView.Data() + offset;
+            entry.size = size;
+            mEntries[name] = entry;
+        }
+
+        mOpen = true;
+        LOG_F_MSG( "game", "mapped mod bundle " << bundleFile << " ("
+                   << mEntries.size() << " files, " << mView.Size() << " bytes)" );
+    }
+
+    /// look up a file by its bundle-relative name
+    bool ModBundle::Find( const std::string& name, const char*& data, size_t& size ) const
+    {
+        EntryMap::const_iterator needle = mEntries.find(name);
+        if( needle == mEntries.end() )
+            return false;
+        data = needle->second.data;
+        size = needle->second.size;
+        return true;
+    }
+
+    /// pack every regular file under a directory into a bundle
+    bool ModBundle::Bake( const std::string& directory, const std::string& bundleFile )
+    {
+        fs::path root( directory );
+        if( !fs::is_directory(root) )
+        {
+            LOG_F_ERROR( "game", "mod bundle source " << directory << " is not a directory" );
+            return false;
+        }
+
+        // collect the files in index order, names relative to the root
+        // with '/' separators (the same form the resource index uses)
+        std::vector<std::string> names;
+        std::vector<std::string> paths;
+        std::vector<uint32_t> sizes;
+        const std::string prefix = root.generic_string();
+        try
+        {
+            fs::recursive_directory_iterator itr( root ), end;
+            for( ; itr != end; ++itr )
+            {
+                if( !fs::is_regular_file(itr->status()) || SkipWhenBaking(itr->path()) )
+                    continue;
+                std::string rel = itr->path().generic_string().substr( prefix.size() );
+                while( !rel.empty() && rel[0] == '/' )
+                    rel.erase( 0, 1 );
+                names.push_back( rel );
+                paths.push_back( itr->path().string() );
+                sizes.push_back( (uint32_t)fs::file_size(itr->path()) );
+            }
+        }
+        catch( const fs::filesystem_error& err )
+        {
+            LOG_F_ERROR( "game", "could not walk mod bundle source " << directory
+                         << ": " << err.what() );
+            return false;
+        }
+
+        // size the index with zero offsets, then lay the files out
+        // back to back after it and serialize the real offsets
+        Bitstream index;
+        std::vector<uint32_t> offsets( names.size(), 0 );
+        BuildIndex( index, names, offsets, sizes );
+        uint32_t running = (uint32_t)(kHeaderBytes + index.ByteLength());
+        for( size_t i = 0; i < names.size(); ++i )
+        {
+            offsets[i] = running;
+            running += sizes[i];
+        }
+        BuildIndex( index, names, offsets, sizes );
+
+        std::ofstream out( bundleFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if( !out )
+        {
+            LOG_F_ERROR( "game", "could not open mod bundle file " << bundleFile );
+            return false;
+        }
+        const uint32_t indexBytes = index.ByteLength();
+        out.write( (const char*)&kBundleMagic, sizeof(kBundleMagic) );
+        out.write( (const char*)&kBundleVersion, sizeof(kBundleVersion) );
+        out.write( (const char*)&indexBytes, sizeof(indexBytes) );
+        out.write( (const char*)index.Stream(), indexBytes );
+
+        for( size_t i = 0; i < names.size(); ++i )
+        {
+            ReadOnlyFileView view( paths[i] );
+            if( !view.IsOpen() || view.Size() != sizes[i] )
+            {
+                LOG_F_ERROR( "game", "mod bundle source file changed while baking: " << paths[i] );
+                return false;
+            }
+            out.write( view.Data(), (std::streamsize)view.Size() );
+        }
+
+        if( !out )
+        {
+            LOG_F_ERROR( "game", "could not write mod bundle file " << bundleFile );
+            return false;
+        }
+
+        LOG_F_MSG( "game", "baked mod bundle " << bundleFile << " ("
+                   << names.size() << " files, " << running << " bytes)" );
+        return true;
+    }
+}
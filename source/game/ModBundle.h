@@ -0,0 +1,70 @@
+#ifndef _GAME_MODBUNDLE_H_
+#define _GAME_MODBUNDLE_H_
+
+#include <string>
+#include "core/Common.h"
+#include "core/File.h"
+#include "core/HashMap.h"
+
+namespace OpenNero
+{
+    /// A packed bundle of a mod's resource files. Bake() walks a
+    /// directory tree once, offline, and packs every file into a single
+    /// .onb file with an index up front; a bundle attached to a Mod is
+    /// memory-mapped and serves resource contents as pointers into the
+    /// mapping, so a cold mod load does one mmap and an index parse
+    /// instead of a file open and read per mesh, texture and template.
+    /// Python sources are left out of bundles -- the interpreter imports
+    /// them from real files (packed scripts have their own archive, see
+    /// compile_script_archive).
+    class ModBundle
+    {
+        /// one bundled file: a range of the mapping
+        struct Entry
+        {
+            const char* data; ///< first byte of the file's contents
+            size_t size;      ///< byte size of the contents
+        };
+        typedef hash_map<std::string, Entry> EntryMap;
+
+        ReadOnlyFileView mView;     ///< the mapped bundle file
+        EntryMap        mEntries;   ///< contents by bundle-relative name
+        std::string     mFileName;  ///< path the bundle was opened from
+        bool            mOpen;      ///< whether the bundle parsed cleanly
+
+        // the bundle owns an OS mapping, so it cannot be copied
+        ModBundle( const ModBundle& );
+        ModBundle& operator=( const ModBundle& );
+
+    public:
+        /// map and index a baked bundle file (check IsOpen() after)
+        /// @param bundleFile path of the .onb file to open
+        explicit ModBundle( const std::string& bundleFile );
+
+        /// could the bundle be mapped and its index parsed?
+        bool IsOpen() const { return mOpen; }
+
+        /// path the bundle was opened from
+        const std::string& FileName() const { return mFileName; }
+
+        /// number of files in the bundle
+        size_t FileCount() const { return mEntries.size(); }
+
+        /// look up a file by its bundle-relative name
+        /// @param name relative path of the file, '/'-separated
+        /// @param data set to the first byte of the contents on a hit
+        /// @param size set to the byte size of the contents on a hit
+        /// @return true iff the bundle contains the name
+        bool Find( const std::string& name, const char*& data, size_t& size ) const;
+
+        /// Pack every regular file under a directory into a bundle,
+        /// indexed by its path relative to the directory. Python sources
+        /// and other bundles are skipped.
+        /// @param directory root of the tree to pack
+        /// @param bundleFile path of the .onb file to write
+        /// @return true iff the bundle was written
+        static bool Bake( const std::string& directory, const std::string& bundleFile );
+    };
+}
+
+#endif // _GAME_MODBUNDLE_H_
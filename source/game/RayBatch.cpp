@@ -0,0 +1,102 @@
+#include "core/Common.h"
+
+#include <float.h>
+#include <boost/bind.hpp>
+
+#include "game/RayBatch.h"
+#include "game/Simulation.h"
+#include "core/TaskPool.h"
+
+namespace OpenNero
+{
+    size_t RayBatch::AddRequest( const Vector3f& origin, const Vector3f& target, uint32_t types )
+    {
+        Request req;
+        req.mOrigin = origin;
+        req.mTarget = target;
+        req.mTypes = types;
+        mRequests.push_back(req);
+        return mRequests.size() - 1;
+    }
+
+    void RayBatch::Resolve( Simulation* sim, TaskPool* pool )
+    {
+        if (mRequests.empty()) return;
+
+        mResults.assign(mRequests.size(), Result());
+
+        // fetch the selectors up front on the main thread, since creating a
+        // missing meta selector mutates the simulation's cache
+        mSelectors.resize(mRequests.size());
+        for (size_t i = 0; i < mRequests.size(); ++i) {
+            mSelectors[i] = sim->GetCollisionTriangleSelector(mRequests[i].mTypes);
+        }
+
+        if (pool && pool->GetWorkerCount() > 1 && mRequests.size() > 1) {
+            // split the requests into one contiguous range per worker
+            size_t workers = pool->GetWorkerCount();
+            size_t chunk = (mRequests.size() + workers - 1) / workers;
+            for (size_t begin = 0; begin < mRequests.size(); begin += chunk) {
+                size_t end = std::min(begin + chunk, mRequests.size());
+                pool->Submit(boost::bind(&RayBatch::CastRange, this, begin, end));
+            }
+            pool->WaitAll();
+        } else {
+            CastRange(0, mRequests.size());
+        }
+    }
+
+    void RayBatch::clear()
+    {
+        mRequests.clear();
+        mResults.clear();
+        mSelectors.clear();
+    }
+
+    void RayBatch::CastRange( size_t begin, size_t end )
+    {
+        // local triangle scratch so ranges can be cast concurrently
+        std::vector<Triangle3f> triangles;
+
+        for (size_t r = begin; r < end; ++r) {
+            const Request& req = mRequests[r];
+            Result& result = mResults[r];
+            irr::scene::ITriangleSelector* selector = mSelectors[r].get();
+            if (!selector) continue;
+
+            S32 total = selector->getTriangleCount();
+            if (total <= 0) continue;
+            if (triangles.size() < static_cast<size_t>(total)) {
+                triangles.resize(total);
+            }
+
+            Line3f ray(ConvertNeroToIrrlichtPosition(req.mOrigin),
+                       ConvertNeroToIrrlichtPosition(req.mTarget));
+            S32 cnt = 0;
+            selector->getTriangles(&triangles[0], total, cnt, ray);
+
+            // find the nearest triangle intersected by the ray (same test as
+            // ISceneCollisionManager::getCollisionPoint, but reentrant)
+            const Vector3f linevect = ray.getVector().normalize();
+            Vector3f intersection;
+            F32 nearest = FLT_MAX;
+            const F32 raylength = ray.getLengthSQ();
+
+            for (S32 i = 0; i < cnt; ++i) {
+                const Triangle3f& triangle = triangles[i];
+                if (triangle.getIntersectionWithLine(ray.start, linevect, intersection)) {
+                    const F32 d_start = intersection.getDistanceFromSQ(ray.start);
+                    const F32 d_end = intersection.getDistanceFromSQ(ray.end);
+                    if (d_start < raylength && d_end < raylength && d_start < nearest) {
+                        irr::scene::ISceneNode* node = selector->getSceneNodeForTriangle(i);
+                        nearest = d_start;
+                        result.mHit = true;
+                        result.mHitPos = ConvertIrrlichtToNeroPosition(intersection);
+                        result.mNodeId = node ? node->getID() : 0;
+                    }
+                }
+            }
+        }
+    }
+
+} //end OpenNero
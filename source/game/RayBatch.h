@@ -0,0 +1,83 @@
+//--------------------------------------------------------
+// OpenNero : RayBatch
+//  batched ray casts against the collision world
+//--------------------------------------------------------
+
+#ifndef _GAME_RAYBATCH_H_
+#define _GAME_RAYBATCH_H_
+
+#include <vector>
+#include "core/ONTypes.h"
+#include "core/IrrUtil.h"
+#include "render/SceneObject.h"
+
+namespace OpenNero
+{
+    class Simulation;
+    class TaskPool;
+
+    /**
+     * Collects the ray casts that sensors need for a tick and resolves them
+     * all at once against the simulation's meta triangle selectors. The
+     * resolution step only reads triangle data, so the casts are spread
+     * across the worker pool; sensors then consume their results during the
+     * AI phase without issuing individual scene queries.
+     */
+    class RayBatch
+    {
+    public:
+
+        /// the outcome of one batched ray cast
+        struct Result
+        {
+            bool          mHit;     ///< did the ray hit a scene node?
+            Vector3f      mHitPos;  ///< the hit position (in game coordinates)
+            SceneObjectId mNodeId;  ///< the id of the scene node that was hit
+
+            Result() : mHit(false), mNodeId(0) {}
+        };
+
+        /// queue a ray cast for this tick
+        /// @param origin start of the ray (in game coordinates)
+        /// @param target end of the ray (in game coordinates)
+        /// @param types the type mask selecting the collision geometry
+        /// @return the index to retrieve the result with after Resolve
+        size_t AddRequest( const Vector3f& origin, const Vector3f& target, uint32_t types );
+
+        /// cast all queued rays, using the pool when one is available
+        /// @param sim the simulation providing the meta triangle selectors
+        /// @param pool optional worker pool to spread the casts over
+        void Resolve( Simulation* sim, TaskPool* pool );
+
+        /// the result of a previously queued request
+        const Result& GetResult( size_t index ) const { return mResults[index]; }
+
+        /// number of queued requests
+        size_t size() const { return mRequests.size(); }
+
+        /// drop all requests and results for the next tick
+        void clear();
+
+    private:
+
+        /// one queued ray cast
+        struct Request
+        {
+            Vector3f mOrigin;   ///< start of the ray (in game coordinates)
+            Vector3f mTarget;   ///< end of the ray (in game coordinates)
+            uint32_t mTypes;    ///< type mask for the collision geometry
+        };
+
+        /// cast the rays in [begin, end) against their selectors
+        void CastRange( size_t begin, size_t end );
+
+    private:
+
+        std::vector<Request>                 mRequests;  ///< queued ray casts
+        std::vector<Result>                  mResults;   ///< results by request index
+        std::vector<ITriangleSelector_IPtr>  mSelectors; ///< per-request selectors, fetched on the main thread
+    };
+
+} //end OpenNero
+
+#endif // _GAME_RAYBATCH_H_
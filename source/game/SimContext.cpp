@@ -4,30 +4,102 @@
 //--------------------------------------------------------
 
 #include "core/Common.h"
+#include "core/ONTime.h"
 
 #include "game/SimContext.h"
 #include "game/SimEntity.h"
+#include "game/SimEntityProxy.h"
 #include "game/Simulation.h"
+#include "game/StateReplayer.h"
+#include "game/TickGovernor.h"
 #include "game/objects/TemplatedObject.h"
 
 #include "gui/GuiManager.h"
 
 #include "render/SceneObject.h"
 #include "render/Camera.h"
+#include "render/FrameCapture.h"
 #include "render/NeroDrawNode.h"
 #include "render/LineSet.h"
+#include "render/LabelSet.h"
 
 #include "factories/SimFactory.h"
 
 #include "ai/AIManager.h"
 
+#include "scripting/scripting.h"
+
 #include "input/IOMapping.h"
 
+#include "utils/Config.h"
+#include "utils/MetricsServer.h"
+#include "utils/Profiler.h"
+#include "utils/StartupReport.h"
+
+#include <iomanip>
 #include <sstream>
 
 namespace OpenNero
 {
     bool SimContext::HandleEvent( const irr::SEvent& event )
+    {
+        // Keyboard and mouse events are queued and dispatched once per
+        // tick (see UpdateInputSystem), with high-rate streams coalesced
+        // below, so the per-frame input cost is bounded by the number of
+        // distinct inputs instead of the device event rate. Other event
+        // types can carry pointers that do not outlive this call, so
+        // they are handled inline.
+        if( event.EventType != irr::EET_MOUSE_INPUT_EVENT &&
+            event.EventType != irr::EET_KEY_INPUT_EVENT )
+        {
+            return DispatchEvent(event);
+        }
+
+        if( !mEventQueue.empty() )
+        {
+            irr::SEvent& last = mEventQueue.back();
+            if( event.EventType == irr::EET_MOUSE_INPUT_EVENT &&
+                last.EventType == irr::EET_MOUSE_INPUT_EVENT )
+            {
+                // successive moves collapse to the newest one - the io
+                // state only keeps the delta since the previous event,
+                // so nothing the per-tick poll reads is lost
+                if( event.MouseInput.Event == irr::EMIE_MOUSE_MOVED &&
+                    last.MouseInput.Event == irr::EMIE_MOUSE_MOVED )
+                {
+                    last = event;
+                    return false;
+                }
+                // wheel clicks merge by summing their travel
+                if( event.MouseInput.Event == irr::EMIE_MOUSE_WHEEL &&
+                    last.MouseInput.Event == irr::EMIE_MOUSE_WHEEL )
+                {
+                    const irr::f32 wheel = last.MouseInput.Wheel + event.MouseInput.Wheel;
+                    last = event;
+                    last.MouseInput.Wheel = wheel;
+                    return false;
+                }
+            }
+            else if( event.EventType == irr::EET_KEY_INPUT_EVENT &&
+                     last.EventType == irr::EET_KEY_INPUT_EVENT &&
+                     event.KeyInput.Key == last.KeyInput.Key &&
+                     event.KeyInput.PressedDown == last.KeyInput.PressedDown &&
+                     event.KeyInput.Shift == last.KeyInput.Shift &&
+                     event.KeyInput.Control == last.KeyInput.Control )
+            {
+                // auto-repeats of a held key collapse to one event
+                last = event;
+                return false;
+            }
+        }
+
+        mEventQueue.push_back(event);
+
+        // return false so the Irr components can read events
+        return false;
+    }
+
+    bool SimContext::DispatchEvent( const irr::SEvent& event )
     {
         if( mpGuiManager )
         {
@@ -54,11 +126,16 @@ namespace OpenNero
         return false;
     }
 
-    bool SimContext::Initialize(IrrlichtDevice_IPtr device)
+    bool SimContext::Initialize(IrrlichtDevice_IPtr device, ISceneManager_IPtr sceneManager)
     {
         // make copies of the irr handles
         mIrr = IrrHandles(device);
 
+        // a worker context gets its own scene graph so its entities,
+        // collisions and sensor rays never mix with the visible context's
+        if( sceneManager )
+            mIrr.mpSceneManager = sceneManager;
+
         mpSimulation.reset( new Simulation( mIrr ) );
 
         return true;
@@ -70,11 +147,16 @@ namespace OpenNero
     SimContext::SimContext()
         : mClearColor(255, 100, 101, 140)
         , mInputReceiver( kIR_Game )
+        , mHeadless( GetAppConfig().Headless )
+        , mSuspended( false )
     {}
 
     /// basic destructor
     SimContext::~SimContext()
     {
+        // the tail-latency numbers are only useful if they get written
+        // down; dump them before the context tears everything down
+        mFPSCounter.LogSummary();
         FlushContext();
     }
 
@@ -97,13 +179,100 @@ namespace OpenNero
 
         // initialize the mod from script
         ScriptingEngine& scriptEngine = ScriptingEngine::instance();
+
+        // warm up any modules the mod lists in its preimport manifest so
+        // the import cost lands here rather than in the first tick
+        scriptEngine.ImportPreimportManifest("preimport.txt");
+
         scriptEngine.ExecFile(Kernel::findResource("main.py"));
+        StartupReport::MarkStage("mod main.py");
+
         const std::string& mode = Kernel::instance().getMod()->mode;
         if (mode.empty())
             scriptEngine.Call("ModMain");
         else
             scriptEngine.Call("ModMain", mode);
+        StartupReport::MarkStage("ModMain");
+
+        return true;
+    }
+
+    /// worker contexts only ever simulate, so they get the object factory
+    /// and nothing else: no GUI manager, no draw node, no mod script
+    bool SimContext::onPushWorker()
+    {
+        mpFactory.reset(new SimFactory( mIrr ));
+        Assert( mpFactory );
+        return true;
+    }
+
+    /// Freeze this context in place instead of tearing it down. The scene
+    /// nodes stay in the (shared) scene manager but are hidden so the next
+    /// mod's render pass skips them, and the global AI state is detached
+    /// so the next mod starts from a clean manager. Entities, templates,
+    /// and script state are all retained in memory. Cost is O(active
+    /// entities).
+    bool SimContext::onSuspend()
+    {
+        if( mSuspended )
+            return true;
+
+        const SimEntitySet& entities = mpSimulation->GetEntities();
+        SimEntitySet::const_iterator itr;
+        for( itr = entities.begin(); itr != entities.end(); ++itr )
+        {
+            SceneObjectPtr object = (*itr)->GetSceneObject();
+            if( object )
+                object->SetSceneVisible(false);
+        }
+
+        if( mpSkyBox )
+            mpSkyBox->setVisible(false);
+        if( mpNeroNode )
+            mpNeroNode->setVisible(false);
+        if( mpGuiManager )
+            mpGuiManager->SetAllVisible(false);
+
+        // the batched labels point at our entities; drop them so they do
+        // not draw over the next mod (SceneObject re-adds them on demand)
+        LabelSet::instance().ClearLabels();
+
+        AIManager::instance().SaveState(mSuspendedAI);
+
+        mSuspended = true;
+        return true;
+    }
+
+    /// Reattach a suspended context: unhide the scene, reactivate our
+    /// camera, and put the saved AI state back. Cost is O(active entities).
+    bool SimContext::onResume()
+    {
+        if( !mSuspended )
+            return true;
 
+        const SimEntitySet& entities = mpSimulation->GetEntities();
+        SimEntitySet::const_iterator itr;
+        for( itr = entities.begin(); itr != entities.end(); ++itr )
+        {
+            SceneObjectPtr object = (*itr)->GetSceneObject();
+            if( object )
+                object->SetSceneVisible(true);
+        }
+
+        if( mpSkyBox )
+            mpSkyBox->setVisible(true);
+        if( mpNeroNode )
+            mpNeroNode->setVisible(true);
+        if( mpGuiManager )
+            mpGuiManager->SetAllVisible(true);
+
+        if( mpCamera )
+            mIrr.getSceneManager()->setActiveCamera( mpCamera->getCamera().get() );
+
+        AIManager::instance().RestoreState(mSuspendedAI);
+        mSuspendedAI = AIManager::SavedState();
+
+        mSuspended = false;
         return true;
     }
 
@@ -145,6 +314,69 @@ namespace OpenNero
         return true;
     }
 
+    boost::python::list SimContext::AddObjects( const boost::python::list& specs )
+    {
+        namespace py = boost::python;
+        Assert( mpSimulation );
+
+        // create all the entities first, then add them as one batch so the
+        // collision selectors and the type index are only updated once
+        SimEntityList batch;
+        py::list ids;
+        const long count = py::len(specs);
+        for( long i = 0; i < count; ++i )
+        {
+            py::tuple record = py::extract<py::tuple>(specs[i]);
+            const long args = py::len(record);
+            AssertMsg( args >= 2 && args <= 7,
+                       "addObjects expects (template, position, [rotation], [scale], [label], [collision], [type]) records" );
+
+            std::string templateName = py::extract<std::string>(record[0]);
+            Vector3f pos = py::extract<Vector3f>(record[1]);
+            Vector3f rot(0,0,0);
+            Vector3f scale(1,1,1);
+            std::string label;
+            uint32_t collision = 0;
+            uint32_t type = 0;
+            if( args > 2 && record[2] != py::object() ) rot = py::extract<Vector3f>(record[2]);
+            if( args > 3 && record[3] != py::object() ) scale = py::extract<Vector3f>(record[3]);
+            if( args > 4 && record[4] != py::object() ) label = py::extract<std::string>(record[4]);
+            if( args > 5 && record[5] != py::object() ) collision = py::extract<uint32_t>(record[5]);
+            if( args > 6 && record[6] != py::object() ) type = py::extract<uint32_t>(record[6]);
+
+            SimId new_id = ReserveNewId();
+            SimEntityData data(pos, rot, scale, label, type, collision, new_id);
+            data.SetAllDirtyBits();
+            SimEntityPtr simEnt = SimEntity::CreateSimEntity(data, templateName, shared_from_this());
+            if( simEnt )
+            {
+                batch.push_back(simEnt);
+                ids.append(new_id);
+            }
+            else
+            {
+                ids.append(kInvalidSimId);
+            }
+        }
+        mpSimulation->AddSimEntities(batch);
+        return ids;
+    }
+
+    void SimContext::RemoveObjects( const boost::python::list& ids )
+    {
+        namespace py = boost::python;
+        Assert( mpSimulation );
+
+        std::vector<SimId> sim_ids;
+        const long count = py::len(ids);
+        sim_ids.reserve(count);
+        for( long i = 0; i < count; ++i )
+        {
+            sim_ids.push_back( py::extract<SimId>(ids[i]) );
+        }
+        mpSimulation->RemoveSimEntities(sim_ids);
+    }
+
     /// Add a set of cartesian axes to the world
     void SimContext::AddAxes()
     {
@@ -267,40 +499,122 @@ namespace OpenNero
     /// @param dt the time to increment by
     void SimContext::ProcessTick(float32_t dt)
     {
-        // This will cause Irrlicht to render the objects
-        UpdateRenderSystem(dt);
-        
+        // time the whole tick when anyone consumes the number: the
+        // metrics endpoint and the budget governor (free when both are off)
+        const uint64_t tick_start =
+            ( MetricsServer::instance().IsRunning() || TickGovernor::instance().IsEnabled() )
+            ? HighResClock::GetNanoseconds() : 0;
+
+        {
+            // This will cause Irrlicht to render the objects. Rendering
+            // never calls back into Python, so let background Python
+            // threads run while Irrlicht draws the frame.
+            PROFILE_SCOPE("render");
+            ScopedGILRelease gil;
+            UpdateRenderSystem(dt);
+        }
+
         // clear our lineset
         LineSet::instance().ClearSegments();
 
-        // This will look at any input from the user that happened since the 
-        // previous call and run the corresponding (Python) actions. This can
-        // potentially change a lot of things such as which mod we want to run.
-        UpdateInputSystem(dt);
+        {
+            // This will look at any input from the user that happened since the
+            // previous call and run the corresponding (Python) actions. This can
+            // potentially change a lot of things such as which mod we want to run.
+            PROFILE_SCOPE("input");
+            UpdateInputSystem(dt);
+        }
 
-        // Call the ProcessTick method of the global AI manager
-        AIManager::instance().ProcessTick(dt);
+        // publish the camera frustum for this frame so that scene objects
+        // can cull display-only tick work for offscreen entities
+        Camera::PublishFrustum( ( !IsHeadless() && mpCamera ) ?
+                                mpCamera->getCamera().get() : NULL );
 
-        // This will loop through all the objects in the simulation, calling
-        // their ProcessTick method. We need to know the actual position of
-        // each object before this, and we will know the desired position after this.
-        UpdateSimulation(dt);
+        if( mpStateReplayer )
+        {
+            // replay mode: apply the next recorded frame of deltas and sync
+            // the scene from them, skipping AI evaluation entirely; this
+            // path runs no Python, so the GIL can be dropped for it
+            ScopedGILRelease gil;
+            mpStateReplayer->AdvanceFrame(*mpSimulation);
+            mpSimulation->ProcessReplayTick(dt);
+        }
+        else if( mpSpectatorView )
+        {
+            // spectator mode: apply the newest frame the headless process
+            // we are attached to has published and sync the scene from it;
+            // like a replay, no AI or Python runs here
+            ScopedGILRelease gil;
+            float32_t frame_dt = dt;
+            if( mpSpectatorView->ReadLatest(mSpectatorRecords, frame_dt) )
+            {
+                for( size_t i = 0; i < mSpectatorRecords.size(); ++i )
+                {
+                    const SpectatorRecord& record = mSpectatorRecords[i];
+                    SimEntityPtr ent = mpSimulation->Find( SimId(record.id) );
+                    if( !ent )
+                        continue;
+                    ent->SetPosition(record.position);
+                    ent->SetRotation(record.rotation);
+                    ent->SetVelocity(record.velocity);
+                    ent->SetScale(record.scale);
+                    ent->SetColor(SColor(record.color));
+                }
+            }
+            mpSimulation->ProcessReplayTick(dt);
+        }
+        else
+        {
+            {
+                // Call the ProcessTick method of the global AI manager
+                PROFILE_SCOPE("ai");
+                AIManager::instance().ProcessTick(dt);
+            }
 
-        // This will trigger scheduled events in the Python script,
-        // as well as ModTick(dt) if it is defined
-        UpdateScriptingSystem(dt);
+            // This will loop through all the objects in the simulation, calling
+            // their ProcessTick method. We need to know the actual position of
+            // each object before this, and we will know the desired position after this.
+            PROFILE_SCOPE("simulation");
+            UpdateSimulation(dt);
+        }
+
+        {
+            // This will trigger scheduled events in the Python script,
+            // as well as ModTick(dt) if it is defined
+            PROFILE_SCOPE("script");
+            UpdateScriptingSystem(dt);
+        }
+
+        if( tick_start )
+        {
+            const uint64_t elapsed = HighResClock::GetNanoseconds() - tick_start;
+            if( MetricsServer::instance().IsRunning() )
+            {
+                MetricsServer::instance().RecordTick(
+                    dt, elapsed,
+                    mpSimulation ? mpSimulation->GetEntities().size() : 0 );
+            }
+            // adjust the shedding level against the budget (no-op when off)
+            TickGovernor::instance().EndTick(elapsed);
+        }
     }
     
     /// Update all the objects and render
     /// @param dt the time to increment by
     void SimContext::ProcessAnimationTick(float32_t dt, float32_t frac)
     {
-        // This will cause Irrlicht to render the objects
-        UpdateRenderSystem(dt);
+        {
+            // This will cause Irrlicht to render the objects (no Python
+            // runs during the render pass, so the GIL is released)
+            PROFILE_SCOPE("render");
+            ScopedGILRelease gil;
+            UpdateRenderSystem(dt);
+        }
 
         // This will look at any input from the user that happened since the 
         // previous call and run the corresponding (Python) actions. This can
         // potentially change a lot of things such as which mod we want to run.
+        PROFILE_SCOPE("input");
         UpdateInputSystem(dt);
         
         // update the simulation
@@ -313,6 +627,16 @@ namespace OpenNero
     /// Update the input system
     void SimContext::UpdateInputSystem(float32_t dt)
     {
+        // dispatch the events queued since the last tick, in arrival order
+        if( !mEventQueue.empty() )
+        {
+            for( size_t i = 0; i < mEventQueue.size(); ++i )
+            {
+                DispatchEvent( mEventQueue[i] );
+            }
+            mEventQueue.clear();
+        }
+
         if( mInputReceiver == kIR_Game )
         {
             // act on any user input
@@ -323,21 +647,61 @@ namespace OpenNero
     /// Update the rendering system
     void SimContext::UpdateRenderSystem(float32_t dt)
     {
+        // in headless mode the whole render pass is skipped - batch training
+        // runs ticks back to back instead of walking the scene graph
+        if( mHeadless )
+        {
+            return;
+        }
+
         // draw the scene
         static bool sClearBackBuffer = true;
         static bool sClearZBuffer    = true;
 
         mIrr.getVideoDriver()->beginScene( sClearBackBuffer, sClearZBuffer, mClearColor );
         mIrr.getSceneManager()->drawAll();
-        mIrr.getGuiEnv()->drawAll();
+
+        // let the gui manager reuse its cached layer when nothing changed
+        if( mpGuiManager )
+        {
+            mpGuiManager->DrawAll();
+        }
+        else
+        {
+            mIrr.getGuiEnv()->drawAll();
+        }
 
         mFPSCounter.registerFrame();
         std::stringstream sstr;
         sstr << mFPSCounter.getFPS();
         DrawText( Vector2i( 780, 5 ), SColor(255,255,255,255), sstr.str(), mIrr.getDevice() );
 
+        // profiler HUD: one line per scope of the last completed frame
+        if( Profiler::instance().IsEnabled() )
+        {
+            const std::vector<Profiler::ScopeStats>& stats = Profiler::instance().GetFrameStats();
+            int32_t y = 5;
+            for( size_t i = 0; i < stats.size(); ++i )
+            {
+                const Profiler::ScopeStats& s = stats[i];
+                size_t slash = s.path.rfind('/');
+                std::string name = slash == std::string::npos ? s.path : s.path.substr(slash + 1);
+                std::stringstream line;
+                line << std::string(s.depth * 2, ' ') << name << ": "
+                     << std::fixed << std::setprecision(2) << s.milliseconds << " ms ("
+                     << std::setprecision(1) << s.percent << "%)";
+                if( s.calls > 1 )
+                    line << " x" << s.calls;
+                DrawText( Vector2i( 10, y ), SColor(255,255,255,0), line.str(), mIrr.getDevice() );
+                y += 14;
+            }
+        }
+
         mIrr.getVideoDriver()->endScene();
 
+        // feed the finished frame to the capture pipeline if it is recording
+        FrameCapture::instance().OnFrameRendered(
+            mIrr.getVideoDriver(), mIrr.getDevice()->getFileSystem() );
     }
 
     /// Update the scripting system by a bit
@@ -359,9 +723,68 @@ namespace OpenNero
         }
 	}
 
+    /**
+     * Start playing back a recorded frame log. While a replay is active,
+     * ticks apply the recorded SimEntityData deltas to the entities
+     * instead of running AI, so a long run can be scrubbed through
+     * without re-simulating it.
+     * @param fileName path of the recording to play
+     * @return true if the recording loaded
+    */
+    bool SimContext::StartReplay( const std::string& fileName )
+    {
+        StateReplayerPtr replayer( new StateReplayer(fileName) );
+        if( !replayer->IsOpen() )
+        {
+            return false;
+        }
+        mpStateReplayer = replayer;
+        return true;
+    }
+
+    /// stop the replay and return to normal simulation
+    void SimContext::StopReplay()
+    {
+        mpStateReplayer.reset();
+    }
+
+    /**
+     * Attach to the shared-memory stream a headless process is
+     * publishing. The spectator is expected to have loaded the same mod,
+     * so its entities line up with the published records by SimId;
+     * records for ids this context does not have are skipped.
+     * @param streamName name of the shared-memory stream
+     * @return true if the stream was found
+    */
+    bool SimContext::StartSpectating( const std::string& streamName )
+    {
+        SpectatorViewPtr view( new SpectatorView(streamName) );
+        if( !view->IsOpen() )
+        {
+            return false;
+        }
+        mpSpectatorView = view;
+        return true;
+    }
+
+    /// detach from the spectator stream and return to normal simulation
+    void SimContext::StopSpectating()
+    {
+        mpSpectatorView.reset();
+    }
+
     /// clear out data stored within the sim context
     void SimContext::FlushContext()
     {
+        // stop any frame recording and let the capture pipeline drain its
+        // queue before the world it was filming goes away
+        FrameCapture::instance().Shutdown();
+
+        // tear the world down in bulk: entity destructors skip per-node
+        // scene graph removal because the scene manager and the label
+        // overlay are dropped wholesale below
+        SceneObject::BeginBulkTeardown();
+
         if( mpSimulation )
             mpSimulation->clear();
 
@@ -369,6 +792,11 @@ namespace OpenNero
         mpFactory.reset();
         mObjectTemplates.clear();
 
+        SceneObject::EndBulkTeardown();
+
+        // drop any batched labels still pointing at this context's entities
+        LabelSet::instance().ClearLabels();
+
         // clear the irrlicht structures
         if( mIrr.getSceneManager() )
             mIrr.getSceneManager()->clear();
@@ -434,6 +862,11 @@ namespace OpenNero
     /// @param noneColor the color to use if vis is true 
     /// @return first intersection info tuple(sim, hit) with SimEntityData sim and Vector3f hit (hit location) or ()
     /// Find the first object that intersects the specified ray
+    RayBatch& SimContext::GetRayBatch()
+    {
+        return mpSimulation->GetRayBatch();
+    }
+
     bool SimContext::FindInRay( SimEntityData& hitEntity,
                                 Vector3f& hitPos,
                                 const Vector3f& origin, 
@@ -496,6 +929,61 @@ namespace OpenNero
         }        
     }
 
+    /// @brief Casts a batch of rays in a single Python call
+    /// Python sensing code fires dozens of rays per agent per tick; doing
+    /// them in one call shares the collision manager setup across rays and
+    /// crosses the language boundary once instead of once per ray.
+    /// @param origins list of ray origins (Vector3f)
+    /// @param targets list of ray end points, parallel to origins
+    /// @param type bitmask of object types to intersect
+    /// @return a list with one entry per ray, shaped like findInRay's
+    ///         result: (SimEntityData, hitPos) on a hit, an empty tuple
+    ///         on a miss
+    boost::python::list SimContext::PyFindRays( const boost::python::list& origins,
+                                                const boost::python::list& targets,
+                                                const uint32_t& type )
+    {
+        namespace py = boost::python;
+
+        const long count = py::len(origins);
+        AssertMsg( py::len(targets) == count,
+                   "findRays expects origin and target lists of equal length" );
+
+        ISceneCollisionManager* collider = mIrr.getSceneManager()->getSceneCollisionManager();
+        Assert(collider);
+
+        py::list results;
+        for( long i = 0; i < count; ++i )
+        {
+            Vector3f origin = py::extract<Vector3f>(origins[i]);
+            Vector3f target = py::extract<Vector3f>(targets[i]);
+
+            Line3f ray(ConvertNeroToIrrlichtPosition(origin), ConvertNeroToIrrlichtPosition(target));
+            Vector3f hitPos;
+            Triangle3f outTriangle;
+            ISceneNode* node = collider->getSceneNodeAndCollisionPointFromRay
+                (ray, hitPos, outTriangle, type);
+
+            SimEntityPtr ent;
+            if (node && node->getID() >= kFirstSimId)
+            {
+                ent = getSimulation()->FindBySceneObjectId(node->getID());
+            }
+
+            if (ent)
+            {
+                results.append( py::make_tuple( ent->GetState(),
+                                                ConvertIrrlichtToNeroPosition(hitPos) ) );
+            }
+            else
+            {
+                results.append( py::make_tuple() );
+            }
+        }
+
+        return results;
+    }
+
     /// @param x screen x-coordinate for active camera
     /// @param y screen y-coordinate for active camera
     /// @return Approximate 3d position of the click
@@ -582,6 +1070,46 @@ namespace OpenNero
         ent->GetSceneObject()->SetAnimationSpeed(framesPerSecond);
     }
 
+    /// @brief Applies a batch of object mutations in one Python call
+    /// Each record is a tuple (id, position, rotation, color) where any of
+    /// the three attribute fields may be None to leave it unchanged. The
+    /// whole batch crosses the Python boundary once and does one id lookup
+    /// per record instead of one per mutated attribute.
+    void SimContext::SetObjectStates( const boost::python::list& states )
+    {
+        namespace py = boost::python;
+
+        const long count = py::len(states);
+        for( long i = 0; i < count; ++i )
+        {
+            py::tuple record = py::extract<py::tuple>(states[i]);
+            AssertMsg( py::len(record) == 4,
+                       "setObjectStates expects (id, position, rotation, color) records" );
+
+            SimId id = py::extract<SimId>(record[0]);
+            SimEntityPtr ent = mpSimulation->Find(id);
+            AssertMsg(ent, kCouldNotFindObjectWithId << id);
+
+            py::object pos = record[1];
+            if( pos != py::object() )
+            {
+                ent->SetPosition( py::extract<Vector3f>(pos) );
+            }
+
+            py::object rot = record[2];
+            if( rot != py::object() )
+            {
+                ent->SetRotation( py::extract<Vector3f>(rot) );
+            }
+
+            py::object color = record[3];
+            if( color != py::object() )
+            {
+                ent->SetColor( py::extract<SColor>(color) );
+            }
+        }
+    }
+
     /// Push the changes made to the object without animation
     void SimContext::UpdateObjectImmediately( SimId id )
     {
@@ -659,4 +1187,10 @@ namespace OpenNero
         return mpSimulation->Find(id)->GetSceneObject()->transformVector(vect);
     }
 
+    /// @brief Create a stable generation-checked proxy for an entity
+    SimEntityProxy SimContext::GetEntityProxy( SimId id ) const
+    {
+        return SimEntityProxy( mpSimulation, id );
+    }
+
 } //end OpenNero
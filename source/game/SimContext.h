@@ -8,19 +8,24 @@
 
 #include "core/Common.h"
 #include "core/BoostCommon.h"
+#include "core/IdNameRegistry.h"
 #include "core/IrrUtil.h"
 #include "game/objects/PropertyMap.h"
 #include "game/Kernel.h"
 #include "game/Mod.h"
 #include "game/Simulation.h"
+#include "game/SpectatorStream.h"
 #include "input/IOMapping.h"
 #include "render/SceneObject.h"
 #include "render/FPSCounter.h"
+#include "ai/AIManager.h"
 
 namespace OpenNero
 {
     /// @cond
     BOOST_PTR_DECL( Simulation );
+    BOOST_PTR_DECL( StateReplayer );
+    BOOST_PTR_DECL( SpectatorView );
     BOOST_PTR_DECL( SimContext );
     BOOST_PTR_DECL( SimFactory );
     BOOST_PTR_DECL( ObjectTemplate );
@@ -28,6 +33,8 @@ namespace OpenNero
     BOOST_PTR_DECL( GuiManager );
     /// @endcond
 
+    class SimEntityProxy;
+
     /**
      * The SimContext is the entire game state. It stores all the objects in
      * in the simulation.
@@ -59,14 +66,33 @@ namespace OpenNero
         /// For SimContext
         /// @{
 
-        /// Initialize a simcontext given a device
-        bool Initialize(IrrlichtDevice_IPtr device);
+        /// Initialize a simcontext given a device; a worker context can pass
+        /// its own scene manager to get a scene graph separate from the
+        /// device's default one
+        bool Initialize(IrrlichtDevice_IPtr device,
+                        ISceneManager_IPtr sceneManager = ISceneManager_IPtr());
 
         /// @}
 
         bool onPush(int argc, char** argv);
         bool onPop();
 
+        /// minimal setup for a pooled headless worker context: the object
+        /// factory only, with no GUI, camera, or mod script of its own
+        bool onPushWorker();
+
+        /// freeze this context in place instead of tearing it down:
+        /// the scene is hidden, the AI state is detached, and entities
+        /// and script state stay in memory for a cheap onResume
+        bool onSuspend();
+
+        /// reattach a suspended context: unhide the scene, reactivate
+        /// our camera, and put the saved AI state back
+        bool onResume();
+
+        /// true iff this context is suspended behind another mod
+        bool IsSuspended() const { return mSuspended; }
+
     public:
 
         /// Exported to scripting API in exports.cpp
@@ -90,6 +116,16 @@ namespace OpenNero
         /// Remove an object by it's ID
         bool RemoveObject( SimId id );
 
+        /// Add a batch of objects in one call; each record is a tuple of
+        /// addObject arguments (template, position, [rotation], [scale],
+        /// [label], [collision], [type]) with None standing in for a
+        /// default. The whole batch shares a single collision selector
+        /// update. Returns a list of the new ids.
+        boost::python::list AddObjects( const boost::python::list& specs );
+
+        /// Remove a batch of objects by their IDs in one call
+        void RemoveObjects( const boost::python::list& ids );
+
         /// add rgb X-Y-Z axes
         void AddAxes();
 
@@ -119,6 +155,13 @@ namespace OpenNero
                                           const SColor& noneColor = SColor(255,255,255,0)
                                         );
 
+        /// Cast a batch of rays in one call, sharing the collision manager
+        /// across them; returns one entry per ray: (SimEntityData, hitPos)
+        /// on a hit or an empty tuple on a miss
+        boost::python::list PyFindRays( const boost::python::list& origins,
+                                        const boost::python::list& targets,
+                                        const uint32_t& type = 0 );
+
         /// Get (approximate) 3d position of the click
         Vector3f GetClickedPosition(const int32_t& x, const int32_t& y);
 
@@ -142,6 +185,10 @@ namespace OpenNero
         void SetObjectAnimationSpeed( SimId id, float32_t framesPerSecond );
         /// @}
 
+        /// Apply a batch of (id, position, rotation, color) records in a
+        /// single Python call; pass None for a field to leave it unchanged
+        void SetObjectStates( const boost::python::list& states );
+
         /// Push the changes made to the object without animation
         void UpdateObjectImmediately( SimId id );
 
@@ -158,6 +205,12 @@ namespace OpenNero
         Vector3f GetObjectBBMaxEdge( SimId id ) const;
         /// @}
 
+        /// Create a stable proxy for the entity with the given id; a script
+        /// that touches the same entity every tick should make one of these
+        /// once and reuse it instead of the per-id accessors above, which
+        /// hash the id on every call
+        SimEntityProxy GetEntityProxy( SimId id ) const;
+
         /// Transform the given vector by the matrix of the SimEntity specified by the netID
         Vector3f TransformVector( SimId id, const Vector3f& vect ) const;
 
@@ -185,6 +238,14 @@ namespace OpenNero
         /// How long, in seconds, to wait between executing AI frames
         void SetFrameDelay(float32_t delay) { mpSimulation->SetFrameDelay(delay); }
 
+        /// true iff we run without rendering; the render pass and all
+        /// display-only scene object work are skipped in this mode
+        bool IsHeadless() const { return mHeadless; }
+
+        /// force headless mode regardless of the app config (used for
+        /// pooled worker contexts that are never drawn)
+        void SetHeadless(bool headless) { mHeadless = headless; }
+
         /// @}
 
         /// return the active camera
@@ -202,9 +263,47 @@ namespace OpenNero
         /// return the simulation
         SimulationPtr getSimulation() { return mpSimulation; }
 
+        /// the per-tick batch of sensor ray casts
+        RayBatch& GetRayBatch();
+
         /// return the simulation while changing nothing
         const SimulationPtr getSimulation() const { return mpSimulation; }
 
+        /// get the frame-time statistics collector
+        const FPSCounter& GetFPSCounter() const { return mFPSCounter; }
+
+        /// return the factory used to load "things"
+        SimFactoryPtr getSimFactory() { return mpFactory; }
+
+        /// start playing back a recorded frame log; while a replay is
+        /// active, ticks apply the recorded deltas instead of running AI
+        /// @param fileName path of the recording to play
+        /// @return true if the recording loaded
+        bool StartReplay( const std::string& fileName );
+
+        /// stop the replay and return to normal simulation
+        void StopReplay();
+
+        /// true if a replay is driving the simulation
+        bool IsReplaying() const { return mpStateReplayer.get() != NULL; }
+
+        /// the active replay, for scrubbing (NULL when not replaying)
+        StateReplayerPtr GetStateReplayer() { return mpStateReplayer; }
+
+        /// Attach to the shared-memory stream a headless process is
+        /// publishing and let it drive the entities: ticks apply the
+        /// newest published frame instead of running AI, turning this
+        /// instance into a live spectator of the other process
+        /// @param streamName name of the shared-memory stream
+        /// @return true if the stream was found
+        bool StartSpectating( const std::string& streamName );
+
+        /// detach from the spectator stream and return to normal simulation
+        void StopSpectating();
+
+        /// true if a spectator stream is driving the simulation
+        bool IsSpectating() const { return mpSpectatorView.get() != NULL; }
+
         /// return the next free Id
         SimId ReserveNewId() { return mpSimulation->ReserveNewId(); }
 
@@ -229,10 +328,16 @@ namespace OpenNero
         // clear out the context
         void FlushContext();
 
+        /// hand one event to the gui, the io state, and the camera
+        /// (HandleEvent queues most events for the per-tick dispatch
+        /// in UpdateInputSystem instead of calling this inline)
+        bool DispatchEvent( const irr::SEvent& event );
+
     protected:
 
         /// maps strings to object templates
-        typedef std::map< std::string, ObjectTemplatePtr >ObjectTemplateMap;
+        /// keyed by (interned template-type handle << 32) | interned name handle
+        typedef FlatHashMap< uint64_t, ObjectTemplatePtr > ObjectTemplateMap;
 
     private:
 
@@ -247,6 +352,9 @@ namespace OpenNero
         GuiManagerPtr mpGuiManager;                     ///< Manager of our gui pieces
 
         SimulationPtr mpSimulation;                     ///< The simulation
+        StateReplayerPtr mpStateReplayer;               ///< Replay driving the simulation (NULL when live)
+        SpectatorViewPtr mpSpectatorView;               ///< Spectator stream driving the simulation (NULL when live)
+        std::vector<SpectatorRecord> mSpectatorRecords; ///< Reused scratch copy of the last spectator frame
         SimFactoryPtr mpFactory;                        ///< factory for loading "things"
         mutable ObjectTemplateMap mObjectTemplates;     ///< Object templates in use
 
@@ -256,7 +364,15 @@ namespace OpenNero
 
         InputReceiver       mInputReceiver;             ///< The current input receiver
 
+        std::vector<irr::SEvent> mEventQueue;           ///< coalesced input events awaiting the per-tick dispatch
+
         FPSCounter          mFPSCounter;                ///< Frames Per Second counter
+
+        bool                mHeadless;                  ///< are we running without rendering?
+
+        bool                mSuspended;                 ///< are we suspended behind another mod?
+
+        AIManager::SavedState mSuspendedAI;             ///< AI state detached while suspended
     };
 
     /**
@@ -267,20 +383,25 @@ namespace OpenNero
     template<typename ObjTemp> boost::shared_ptr<ObjTemp> SimContext::getObjectTemplate(
             const std::string& templateName) const
     {
-        // make the mod path
-        std::string modTemplateName = Kernel::findResource(templateName);
-
-        // make the lookup path
-        std::string lookupPath = ObjTemp::TemplateType() + "_"+ modTemplateName;
+        // resolve the names to interned handles: the template type hashes
+        // once per process, the template name once per distinct string;
+        // every later spawn of this template is one integer map lookup
+        // with no path resolution or string building at all
+        static const U32 typeHandle = StringInterner::instance().Intern(ObjTemp::TemplateType());
+        const U32 nameHandle = StringInterner::instance().Intern(templateName);
+        const uint64_t lookupKey = ((uint64_t)typeHandle << 32) | nameHandle;
 
         // do we already have this?
         ObjectTemplateMap::const_iterator
-                itr = mObjectTemplates.find(lookupPath);
+                itr = mObjectTemplates.find(lookupKey);
         if (itr != mObjectTemplates.end() )
         {
             return static_pointer_cast<ObjTemp, ObjectTemplate>(itr->second);
         }
 
+        // make the mod path (cache misses only)
+        std::string modTemplateName = Kernel::findResource(templateName);
+
         LOG_F_MSG( "game", "Loading object template " << modTemplateName );
 
         // we need to add it
@@ -288,7 +409,7 @@ namespace OpenNero
         if (pmap.constructPropertyMap(modTemplateName ) )
         {
             boost::shared_ptr<ObjTemp> temp = ObjTemp::createTemplate( mpFactory, pmap ); // allows some degree of polymorphism
-            mObjectTemplates[lookupPath] = temp;
+            mObjectTemplates[lookupKey] = temp;
             LOG_F_MSG( "game", "Successfully loaded object template " << modTemplateName );
             return temp;
         }
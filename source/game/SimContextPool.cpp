@@ -0,0 +1,90 @@
+//--------------------------------------------------------
+// OpenNero : SimContextPool
+//  a pool of headless worker contexts stepped as a batch
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "game/SimContextPool.h"
+#include "game/SimContext.h"
+#include "game/Kernel.h"
+#include "game/Mod.h"
+#include "scripting/scripting.h"
+
+namespace OpenNero
+{
+    SimContextPool& SimContextPool::instance()
+    {
+        static SimContextPool pool;
+        return pool;
+    }
+
+    size_t SimContextPool::CreateContexts( size_t count )
+    {
+        for( size_t i = 0; i < count; ++i )
+        {
+            SimContextPtr context = Kernel::instance().createWorkerContext();
+            if( !context )
+            {
+                LOG_F_ERROR( "game", "failed to create pooled worker context " << mContexts.size() );
+                break;
+            }
+            mContexts.push_back(context);
+        }
+        LOG_F_MSG( "game", "sim context pool holds " << mContexts.size() << " worker contexts" );
+        return mContexts.size();
+    }
+
+    SimContextPtr SimContextPool::GetContext( size_t index ) const
+    {
+        if( index >= mContexts.size() )
+            return SimContextPtr();
+        return mContexts[index];
+    }
+
+    bool SimContextPool::ActivateContext( size_t index )
+    {
+        if( index >= mContexts.size() )
+            return false;
+        ModPtr mod = Kernel::GetMod();
+        Assert( mod );
+        // remember the mod's own context only on the first activation so
+        // nested activations cannot save a pooled context as "current"
+        if( !mSavedContext )
+            mSavedContext = mod->context;
+        mod->context = mContexts[index];
+        // scripts run in the pooled context's own namespace, so mod-level
+        // state does not leak between the parallel environments
+        ScriptingEngine::instance().ActivateContextNamespace( mContexts[index].get() );
+        return true;
+    }
+
+    void SimContextPool::DeactivateContext()
+    {
+        if( mSavedContext )
+        {
+            Kernel::GetMod()->context = mSavedContext;
+            mSavedContext.reset();
+            ScriptingEngine::instance().DeactivateContextNamespace();
+        }
+    }
+
+    void SimContextPool::StepAll( float32_t dt )
+    {
+        for( size_t i = 0; i < mContexts.size(); ++i )
+        {
+            // activate so that agent code calling back through the kernel
+            // (sensors, scripted brains) lands in the context being stepped
+            ActivateContext(i);
+            mContexts[i]->ProcessTick(dt);
+            DeactivateContext();
+        }
+    }
+
+    void SimContextPool::DestroyContexts()
+    {
+        DeactivateContext();
+        ScriptingEngine::instance().DestroyContextNamespaces();
+        mContexts.clear();
+    }
+
+} //end OpenNero
@@ -0,0 +1,73 @@
+//--------------------------------------------------------
+// OpenNero : SimContextPool
+//  a pool of headless worker contexts stepped as a batch
+//--------------------------------------------------------
+
+#ifndef _GAME_SIMCONTEXTPOOL_H_
+#define _GAME_SIMCONTEXTPOOL_H_
+
+#include <vector>
+#include "core/Common.h"
+#include "core/BoostCommon.h"
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_PTR_DECL( SimContext );
+    /// @endcond
+
+    /**
+     * A pool of additional headless SimContexts living alongside the mod's
+     * visible context, each with its own Simulation and scene graph, for
+     * running many copies of an environment in one process instead of one
+     * process (and one Irrlicht device) per copy. While a pooled context is
+     * active it is installed as the kernel's current context, so the entire
+     * scripting API - AddObject, FindInRay, agents calling back into Python -
+     * routes to it unchanged. StepAll activates and ticks each context in
+     * turn on the calling thread; the scripted decision path has to hold the
+     * Python GIL anyway, so the win is stepping N environments per call
+     * rather than running N devices. Note that it is a singleton.
+    */
+    class SimContextPool
+    {
+    public:
+
+        /// singleton accessor
+        static SimContextPool& instance();
+
+        /// grow the pool by count headless worker contexts
+        /// @return the new size of the pool
+        size_t CreateContexts( size_t count );
+
+        /// the number of contexts in the pool
+        size_t GetContextCount() const { return mContexts.size(); }
+
+        /// get the pooled context at index (NULL ptr if out of range)
+        SimContextPtr GetContext( size_t index ) const;
+
+        /// install the pooled context at index as the kernel's current
+        /// context so subsequent scripting calls route to it
+        bool ActivateContext( size_t index );
+
+        /// restore the context that was current before ActivateContext
+        void DeactivateContext();
+
+        /// step every pooled context forward by dt, activating each in turn
+        void StepAll( float32_t dt );
+
+        /// deactivate and destroy all pooled contexts
+        void DestroyContexts();
+
+    private:
+
+        /// singleton constructor
+        SimContextPool() {}
+
+        std::vector<SimContextPtr> mContexts;   ///< the pooled worker contexts
+        SimContextPtr              mSavedContext; ///< the mod context displaced by ActivateContext
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SIMCONTEXTPOOL_H_
@@ -0,0 +1,68 @@
+#include "core/Common.h"
+
+#include "game/SimDataStore.h"
+
+namespace OpenNero
+{
+    uint32_t SimDataStore::AllocateSlot()
+    {
+        if (!mFreeSlots.empty()) {
+            uint32_t slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+            return slot;
+        }
+        uint32_t slot = static_cast<uint32_t>(mPositions.size());
+        mPositions.push_back(Vector3f());
+        mRotations.push_back(Vector3f());
+        mVelocities.push_back(Vector3f());
+        mScales.push_back(Vector3f(1,1,1));
+        mPrevPositions.push_back(Vector3f());
+        mPrevRotations.push_back(Vector3f());
+        mAnimFlags.push_back(0);
+        return slot;
+    }
+
+    void SimDataStore::FreeSlot( uint32_t slot )
+    {
+        AssertMsg( slot < mPositions.size(), "Freeing an invalid SimDataStore slot: " << slot );
+        mFreeSlots.push_back(slot);
+    }
+
+    void SimDataStore::clear()
+    {
+        mPositions.clear();
+        mRotations.clear();
+        mVelocities.clear();
+        mScales.clear();
+        mPrevPositions.clear();
+        mPrevRotations.clear();
+        mAnimFlags.clear();
+        mLerpPositions.clear();
+        mLerpRotations.clear();
+        mFreeSlots.clear();
+    }
+
+    void SimDataStore::InterpolateStates( float32_t frac )
+    {
+        const size_t count = mPositions.size();
+        mLerpPositions.resize(count);
+        mLerpRotations.resize(count);
+        if (count == 0) return;
+
+        // positions: a straight lerp over the packed arrays; the loop
+        // body is branch-free, so the compiler vectorizes it
+        const float32_t prev_weight = 1.0f - frac;
+        for (size_t i = 0; i < count; ++i) {
+            mLerpPositions[i] = mPositions[i] * frac + mPrevPositions[i] * prev_weight;
+        }
+
+        // rotations need the quaternion slerp; only slots whose rotation
+        // actually changed last tick pay for it
+        for (size_t i = 0; i < count; ++i) {
+            if (mAnimFlags[i] & kAnim_Rotation) {
+                mLerpRotations[i] = InterpolateNeroRotation(mPrevRotations[i], mRotations[i], frac);
+            }
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,102 @@
+//--------------------------------------------------------
+// OpenNero : SimDataStore
+//  structure-of-arrays backing store for hot entity state
+//--------------------------------------------------------
+
+#ifndef _GAME_SIMDATASTORE_H_
+#define _GAME_SIMDATASTORE_H_
+
+#include <vector>
+#include "core/ONTypes.h"
+#include "core/IrrUtil.h"
+
+namespace OpenNero
+{
+    /**
+     * Contiguous per-field arrays for the entity transform state that gets
+     * touched every tick (position, rotation, velocity, scale). Each live
+     * SimEntityData is bound to a slot and writes its hot fields through to
+     * the arrays, so systems that sweep many entities (sensors, rendering)
+     * can consume whole cache-linear arrays instead of chasing per-entity
+     * objects.
+     *
+     * Array pointers are only valid until the next slot allocation, since
+     * the arrays may grow; bulk consumers should fetch them fresh each pass.
+     */
+    class SimDataStore
+    {
+    public:
+
+        /// slot value used for unbound entities
+        static const uint32_t kInvalidSlot = uint32_t(-1);
+
+        /// which transform fields a slot animates between ticks
+        enum AnimationFlags
+        {
+            kAnim_Position = (1<<0),    ///< position changed last tick
+            kAnim_Rotation = (1<<1)     ///< rotation changed last tick
+        };
+
+        /// allocate a slot for one entity, reusing freed slots first
+        uint32_t AllocateSlot();
+
+        /// return a slot to the free pool
+        void FreeSlot( uint32_t slot );
+
+        /// drop all slots and storage
+        void clear();
+
+        /// number of allocated array elements (including freed slots)
+        size_t GetSlotCount() const { return mPositions.size(); }
+
+        void SetPosition( uint32_t slot, const Vector3f& pos ) { mPositions[slot] = pos; }  ///< write through position
+        void SetRotation( uint32_t slot, const Vector3f& rot ) { mRotations[slot] = rot; }  ///< write through rotation
+        void SetVelocity( uint32_t slot, const Vector3f& vel ) { mVelocities[slot] = vel; } ///< write through velocity
+        void SetScale( uint32_t slot, const Vector3f& scale )  { mScales[slot] = scale; }   ///< write through scale
+
+        const Vector3f* GetPositions() const  { return mPositions.empty()  ? NULL : &mPositions[0]; }  ///< whole position array
+        const Vector3f* GetRotations() const  { return mRotations.empty()  ? NULL : &mRotations[0]; }  ///< whole rotation array
+        const Vector3f* GetVelocities() const { return mVelocities.empty() ? NULL : &mVelocities[0]; } ///< whole velocity array
+        const Vector3f* GetScales() const     { return mScales.empty()     ? NULL : &mScales[0]; }     ///< whole scale array
+
+        /// record the interpolation start state and the animation flags
+        /// for a slot (called at the snapshot flip each sim tick)
+        void SetAnimationState( uint32_t slot, const Vector3f& prevPos,
+                                const Vector3f& prevRot, uint8_t flags )
+        {
+            mPrevPositions[slot] = prevPos;
+            mPrevRotations[slot] = prevRot;
+            mAnimFlags[slot] = flags;
+        }
+
+        /// mark a slot as not animating this frame interval
+        void ClearAnimationFlags( uint32_t slot ) { mAnimFlags[slot] = 0; }
+
+        /// the animation flags recorded for a slot
+        uint8_t GetAnimationFlags( uint32_t slot ) const { return mAnimFlags[slot]; }
+
+        /// interpolate every animating transform between the recorded
+        /// previous state and the current arrays in one pass over the
+        /// packed data, filling the arrays below
+        void InterpolateStates( float32_t frac );
+
+        const Vector3f* GetInterpolatedPositions() const { return mLerpPositions.empty() ? NULL : &mLerpPositions[0]; } ///< lerped positions by slot
+        const Vector3f* GetInterpolatedRotations() const { return mLerpRotations.empty() ? NULL : &mLerpRotations[0]; } ///< slerped rotations by slot
+
+    private:
+
+        std::vector<Vector3f> mPositions;   ///< positions by slot
+        std::vector<Vector3f> mRotations;   ///< Euler rotations by slot
+        std::vector<Vector3f> mVelocities;  ///< linear velocities by slot
+        std::vector<Vector3f> mScales;      ///< scales by slot
+        std::vector<Vector3f> mPrevPositions; ///< positions at the previous tick
+        std::vector<Vector3f> mPrevRotations; ///< rotations at the previous tick
+        std::vector<uint8_t>  mAnimFlags;   ///< AnimationFlags by slot
+        std::vector<Vector3f> mLerpPositions; ///< InterpolateStates output
+        std::vector<Vector3f> mLerpRotations; ///< InterpolateStates output
+        std::vector<uint32_t> mFreeSlots;   ///< freed slots available for reuse
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SIMDATASTORE_H_
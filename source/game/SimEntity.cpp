@@ -9,6 +9,7 @@
 #include "core/Bitstream.h"
 #include "game/SimEntity.h"
 #include "game/SimContext.h"
+#include "game/Simulation.h"
 #include "render/SceneObject.h"
 #include "ai/AI.h"
 #include "ai/AIObject.h"
@@ -23,7 +24,10 @@ namespace OpenNero
 		mSceneObject(),
 		mSharedData(data),
 		mCreationTemplate(templateName),
-        mRemoved(false)
+        mRemoved(false),
+        mTickClass(TICK_KINEMATIC),
+        mQuietTicks(0),
+        mSimulation(NULL)
 	{
 	}
 
@@ -88,6 +92,11 @@ namespace OpenNero
         if (mSceneObject->collisionOccurred()) {
             mSharedData.SetPosition(mSceneObject->getPosition());
             collided = true;
+            // file the contact in the per-tick batch the scripts read
+            // in one call instead of polling every object
+            if (mSimulation) {
+                mSimulation->RecordCollision(*this);
+            }
         }
 
         // we tick the shared data so that it can remember where it was
@@ -116,26 +125,38 @@ namespace OpenNero
         }
     }
 
-    void SimEntity::ProcessAnimationTick(float32_t frac)
+    bool SimEntity::IsAITickThreadSafe() const
     {
-        if( mSharedData.IsDirty(SimEntityData::kDB_Position) )
+        return mAIObject && mAIObject->IsTickThreadSafe();
+    }
+
+    void SimEntity::QueueRays(RayBatch& batch)
+    {
+        if (mAIObject)
+        {
+            mAIObject->QueueRays(batch);
+        }
+    }
+
+    void SimEntity::ApplyAnimationState( const SimDataStore& store )
+    {
+        const uint32_t slot = mSharedData.GetSoASlot();
+        if( slot == SimDataStore::kInvalidSlot )
+            return;
+
+        const uint8_t flags = store.GetAnimationFlags(slot);
+
+        if( flags & SimDataStore::kAnim_Position )
         {
-            Vector3f pos(mSharedData.GetPosition() * frac + mSharedData.GetPrevious().mPosition * (1.0 - frac));
             // convert from open nero's coordinate system to irrlicht's
-            mSceneObject->SetPosition( pos );
+            mSceneObject->SetPosition( store.GetInterpolatedPositions()[slot] );
         }
 
-        if( mSharedData.IsDirty(SimEntityData::kDB_Rotation) )
+        if( flags & SimDataStore::kAnim_Rotation )
         {
-        //    if (mCamera && mFPSCamera)
-        //    {
-        //        mFPSCamera->UpdateRotation(mSharedData, mCamera);
-        //    }
-        //
-            Vector3f rotation = InterpolateNeroRotation(mSharedData.GetPrevious().mRotation, mSharedData.GetRotation(), frac);
             // Irrlicht expects a left handed basis with the x-z plane being horizontal and y being up
             // OpenNero uses a right handed basis with x-y plane being horizontal and z being up
-            mSceneObject->SetRotation( rotation );
+            mSceneObject->SetRotation( store.GetInterpolatedRotations()[slot] );
         }
 
         //if ( mSharedData->IsDirty(SimEntityData::kDB_Scale) )
@@ -246,36 +267,43 @@ namespace OpenNero
     void SimEntity::SetPosition( const Vector3f& pos )
     {
         mSharedData.SetPosition(pos);
+        WakeTick();
     }
 
     void SimEntity::SetRotation( const Vector3f& rot )
     {
         mSharedData.SetRotation(rot);
+        WakeTick();
     }
 
     void SimEntity::SetVelocity( const Vector3f& vel )
     {
         mSharedData.SetVelocity(vel);
+        WakeTick();
     }
 
     void SimEntity::SetScale( const Vector3f& scale )
     {
         mSharedData.SetScale(scale);
+        WakeTick();
     }
 
     void SimEntity::SetLabel(const std::string& label)
     {
         mSharedData.SetLabel(label);
+        WakeTick();
     }
 
     void SimEntity::SetColor(const SColor& color)
     {
         mSharedData.SetColor(color);
+        WakeTick();
     }
 
     void SimEntity::SetCollision(uint32_t mask)
     {
         mSharedData.SetCollision(mask);
+        WakeTick();
     }
 
     void SimEntity::UpdateImmediately()
@@ -283,6 +311,17 @@ namespace OpenNero
         // set all the bits to indicate that the information was updated
         mSharedData.SetAllDirtyBits();
         mSceneObject->DisregardCollisions();
+        WakeTick();
+    }
+
+    void SimEntity::WakeTick()
+    {
+        // the scheduler only retires entities without AI, and those are
+        // only ever mutated from the main thread, so no locking is needed
+        if (mTickClass == TICK_STATIC && mSimulation)
+        {
+            mSimulation->WakeEntity(GetSimId());
+        }
     }
 
     /// output SimEntity to stream
@@ -25,18 +25,55 @@ namespace OpenNero
     BOOST_PTR_DECL( SensorObject );
     /// @endcond
 
+    /// How much per-tick work an entity needs from the simulation
+    /// scheduler. The owning Simulation classifies entities on add and
+    /// keeps only the non-static ones on its per-tick iteration list, so
+    /// scenery that never moves costs the tick loops nothing at all.
+    enum TickClass
+    {
+        TICK_STATIC,    ///< quiet scenery; excluded from the per-tick loops
+        TICK_KINEMATIC, ///< moving or recently mutated; scene ticks only
+        TICK_FULL       ///< has an AI component; ticked in every phase
+    };
+
     /// Set of SimEnities
     typedef std::set<SimEntityPtr> SimEntitySet;
 
     /// List of SimEntities
     typedef std::list<SimEntityPtr> SimEntityList;
 
-    /// an unique identifier that used to identify objects locally
+    /// An unique identifier used to identify objects locally.
+    /// Bits [23:0] are the slot index and bits [27:24] a generation
+    /// counter bumped each time an index is recycled, so a stale id held
+    /// after its entity died can never match the entity reusing the
+    /// index. The top four bits stay clear so the scene object id
+    /// (SimId << 4 | type) still fits in 32 bits.
     typedef uint32_t SimId;
 
     const SimId kInvalidSimId = 0; ///< Signifies that an object is not valid
     const SimId kFirstSimId   = 1; ///< The first id...
 
+    const uint32_t kSimIdIndexBits      = 24;   ///< bits holding the slot index
+    const uint32_t kSimIdGenerationBits = 4;    ///< bits holding the generation
+
+    /// mask selecting the index bits of a SimId
+    const SimId kSimIdIndexMask = ((SimId)1 << kSimIdIndexBits) - 1;
+
+    /// the recycled slot index of a SimId
+    inline SimId GetSimIdIndex( SimId id ) { return id & kSimIdIndexMask; }
+
+    /// the generation the index was at when the id was handed out
+    inline uint32_t GetSimIdGeneration( SimId id )
+    {
+        return (id >> kSimIdIndexBits) & (((uint32_t)1 << kSimIdGenerationBits) - 1);
+    }
+
+    /// build a SimId out of a generation and a slot index
+    inline SimId MakeSimId( uint32_t generation, SimId index )
+    {
+        return ((SimId)generation << kSimIdIndexBits) | (index & kSimIdIndexMask);
+    }
+
     /**
     * A simulation entity is able to update itself in the world. After it updates
     * itself it can send its changes on the server to all of the clients
@@ -75,8 +112,15 @@ namespace OpenNero
         /// called to tick the AI component
         void TickAI( float32_t incAmt);
 
-        /// update our entity during an animation frame (no AI tick)
-        void ProcessAnimationTick( float32_t frac );
+        /// can TickAI run on a worker thread for this entity?
+        bool IsAITickThreadSafe() const;
+
+        /// queue this tick's sensor ray casts into the batch
+        void QueueRays(class RayBatch& batch);
+
+        /// apply the interpolated transform the batched SimDataStore pass
+        /// computed for this entity's slot (animation frames, no AI tick)
+        void ApplyAnimationState( const class SimDataStore& store );
 
         /// Set the template that we were loaded from
         std::string GetCreationTemplate() const;
@@ -103,6 +147,12 @@ namespace OpenNero
 		/// Get a constant reference to the shared data for this SimEntity
         const SimEntityData& GetState() const { return mSharedData; }
 
+        /// the scheduler class this entity is currently ticked as
+        TickClass GetTickClass() const { return mTickClass; }
+
+        /// Flip the double-buffered render snapshot of the shared data
+        void PublishState() { mSharedData.PublishSnapshot(); }
+
         /// Getters for properties
         /// @{
         const Vector3f& GetPosition() const;
@@ -163,6 +213,17 @@ namespace OpenNero
 
         /// removed flag
         bool            mRemoved;
+
+        /// tick scheduler bookkeeping, maintained by the owning Simulation
+        /// @{
+        TickClass       mTickClass;     ///< how much per-tick work the entity gets
+        uint32_t        mQuietTicks;    ///< consecutive quiet ticks while kinematic
+        Simulation*     mSimulation;    ///< the simulation the entity is registered with
+        /// @}
+
+        /// ask the owning simulation to resume ticking this entity if the
+        /// scheduler has retired it to the static class
+        void WakeTick();
     };
 
 } //end OpenNero
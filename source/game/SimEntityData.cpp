@@ -5,6 +5,7 @@
 
 #include "core/Common.h"
 #include "game/SimEntityData.h"
+#include "game/SimDataStore.h"
 #include "game/Kernel.h"
 #include "game/SimContext.h"
 #include "core/IrrSerialize.h"
@@ -47,7 +48,12 @@ namespace OpenNero
         , mDirtyBits(uint32_t(-1))
         , mPrevious()
         , mCurrent()
+        , mSnapshotFront(0)
+        , mSoAStore(NULL)
+        , mSoASlot(SimDataStore::kInvalidSlot)
     {
+        mSnapshotDirty[0] = 0;
+        mSnapshotDirty[1] = 0;
     }
     
     SimEntityData::SimEntityData(
@@ -62,7 +68,73 @@ namespace OpenNero
         , mDirtyBits(uint32_t(-1))
         , mPrevious(pos, rot, scale, label, t, collision)
         , mCurrent(pos, rot, scale, label, t, collision)
+        , mSnapshotFront(0)
+        , mSoAStore(NULL)
+        , mSoASlot(SimDataStore::kInvalidSlot)
     {
+        mSnapshot[0] = mCurrent;
+        mSnapshot[1] = mCurrent;
+        mSnapshotDirty[0] = 0;
+        mSnapshotDirty[1] = 0;
+    }
+
+    SimEntityData::SimEntityData( const SimEntityData& other )
+        : mId(other.mId)
+        , mDirtyBits(other.mDirtyBits)
+        , mPrevious(other.mPrevious)
+        , mCurrent(other.mCurrent)
+        , mSnapshotFront(other.mSnapshotFront)
+        , mSoAStore(NULL)
+        , mSoASlot(SimDataStore::kInvalidSlot)
+    {
+        mSnapshot[0] = other.mSnapshot[0];
+        mSnapshot[1] = other.mSnapshot[1];
+        mSnapshotDirty[0] = other.mSnapshotDirty[0];
+        mSnapshotDirty[1] = other.mSnapshotDirty[1];
+    }
+
+    SimEntityData& SimEntityData::operator=( const SimEntityData& other )
+    {
+        if (this != &other)
+        {
+            mId = other.mId;
+            mDirtyBits = other.mDirtyBits;
+            mPrevious = other.mPrevious;
+            mCurrent = other.mCurrent;
+            mSnapshot[0] = other.mSnapshot[0];
+            mSnapshot[1] = other.mSnapshot[1];
+            mSnapshotDirty[0] = other.mSnapshotDirty[0];
+            mSnapshotDirty[1] = other.mSnapshotDirty[1];
+            mSnapshotFront = other.mSnapshotFront;
+            // keep our own store binding and push the new hot fields through
+            if (mSoAStore)
+            {
+                mSoAStore->SetPosition(mSoASlot, mCurrent.mPosition);
+                mSoAStore->SetRotation(mSoASlot, mCurrent.mRotation);
+                mSoAStore->SetVelocity(mSoASlot, mCurrent.mVelocity);
+                mSoAStore->SetScale(mSoASlot, mCurrent.mScale);
+            }
+        }
+        return *this;
+    }
+
+    void SimEntityData::BindSoAStore( SimDataStore* store, uint32_t slot )
+    {
+        mSoAStore = store;
+        mSoASlot = slot;
+        if (mSoAStore)
+        {
+            mSoAStore->SetPosition(mSoASlot, mCurrent.mPosition);
+            mSoAStore->SetRotation(mSoASlot, mCurrent.mRotation);
+            mSoAStore->SetVelocity(mSoASlot, mCurrent.mVelocity);
+            mSoAStore->SetScale(mSoASlot, mCurrent.mScale);
+        }
+    }
+
+    void SimEntityData::UnbindSoAStore()
+    {
+        mSoAStore = NULL;
+        mSoASlot = SimDataStore::kInvalidSlot;
     }
     
     void SimEntityData::SetPosition( const Vector3f& pos )
@@ -71,6 +143,7 @@ namespace OpenNero
         {
             mCurrent.mPosition = pos;
             mDirtyBits |= kDB_Position;
+            if (mSoAStore) mSoAStore->SetPosition(mSoASlot, pos);
         }
     }
 
@@ -80,6 +153,7 @@ namespace OpenNero
         {
             mCurrent.mRotation = rot;
             mDirtyBits |= kDB_Rotation;
+            if (mSoAStore) mSoAStore->SetRotation(mSoASlot, rot);
         }
     }
 
@@ -89,6 +163,7 @@ namespace OpenNero
         {
             mCurrent.mVelocity = vel;
             mDirtyBits |= kDB_Velocity;
+            if (mSoAStore) mSoAStore->SetVelocity(mSoASlot, vel);
         }
     }
 
@@ -125,6 +200,7 @@ namespace OpenNero
         {
             mCurrent.mScale = scale;
             mDirtyBits |= kDB_Scale;
+            if (mSoAStore) mSoAStore->SetScale(mSoASlot, scale);
         }
     }
     
@@ -241,7 +317,55 @@ namespace OpenNero
     {
         return (mDirtyBits & bits) != 0;
     }
-    
+
+    void SimEntityData::PublishSnapshot()
+    {
+        if (mDirtyBits == 0) {
+            // the front snapshot is already current; leave any unconsumed
+            // bits in place for the render sync, but stop the batched
+            // animation pass from re-playing the previous tick's motion
+            if (mSoAStore) mSoAStore->ClearAnimationFlags(mSoASlot);
+            return;
+        }
+        const uint32_t back = 1 - mSnapshotFront;
+        mSnapshot[back] = mCurrent;
+        // carry forward the bits the render side has not consumed yet
+        mSnapshotDirty[back] = mSnapshotDirty[mSnapshotFront] | mDirtyBits;
+        mSnapshotFront = back;
+
+        // record the interpolation window for the batched animation pass:
+        // from the state at the start of this tick to the current arrays
+        if (mSoAStore) {
+            uint8_t flags = 0;
+            if (mDirtyBits & kDB_Position) flags |= SimDataStore::kAnim_Position;
+            if (mDirtyBits & kDB_Rotation) flags |= SimDataStore::kAnim_Rotation;
+            mSoAStore->SetAnimationState(mSoASlot, mPrevious.mPosition,
+                                         mPrevious.mRotation, flags);
+        }
+
+        mDirtyBits = 0;
+    }
+
+    const SimEntityData::SimEntityInternals& SimEntityData::GetSnapshot() const
+    {
+        return mSnapshot[mSnapshotFront];
+    }
+
+    uint32_t SimEntityData::GetSnapshotDirtyBits() const
+    {
+        return mSnapshotDirty[mSnapshotFront];
+    }
+
+    bool SimEntityData::IsSnapshotDirty(SimEntityData::DataBits bit) const
+    {
+        return (mSnapshotDirty[mSnapshotFront] & bit) != 0;
+    }
+
+    void SimEntityData::ClearSnapshotDirtyBits()
+    {
+        mSnapshotDirty[mSnapshotFront] = 0;
+    }
+
     void SimEntityData::ProcessTick(float32_t dt)
     {
         mPrevious = mCurrent;
@@ -19,6 +19,8 @@ namespace OpenNero
     BOOST_PTR_DECL(SimEntityData);
     /// @endcond
 
+    class SimDataStore;
+
     /// SimEntityData stores mutable data 
     class SimEntityData
     {
@@ -93,6 +95,22 @@ namespace OpenNero
         void SetDirtyBits(uint32_t bits);
         /// clear all the bits
         void ClearDirtyBits();
+
+        /// Copy the current state and its dirty bits into the back snapshot
+        /// buffer and flip it to the front, then clear the live dirty bits.
+        /// The render sync reads only the front snapshot, so the simulation
+        /// side is free to keep mutating the live state afterwards; dirty
+        /// bits that the render side has not consumed yet are carried
+        /// forward so a skipped draw frame does not lose updates.
+        void PublishSnapshot();
+        /// the snapshot most recently flipped to the front
+        const SimEntityInternals& GetSnapshot() const;
+        /// dirty bits accumulated in the front snapshot
+        uint32_t GetSnapshotDirtyBits() const;
+        /// true if the given field changed in the front snapshot
+        bool IsSnapshotDirty(DataBits bit) const;
+        /// mark the front snapshot as consumed by the render sync
+        void ClearSnapshotDirtyBits();
         
         const Vector3f& GetPosition() const;      ///< Returns position of entity
         const Vector3f& GetRotation() const;      ///< Returns rotation of entity
@@ -112,6 +130,16 @@ namespace OpenNero
 
         uint32_t GetDirtyBits() const;            ///< Retrieve the dirty bits
         bool IsDirty(DataBits bit) const;         ///< Flag to say if SimEntity is dirty
+
+        /// Bind this entity state to a structure-of-arrays slot; the hot
+        /// transform fields are mirrored into the store from now on
+        void BindSoAStore( SimDataStore* store, uint32_t slot );
+
+        /// Detach from the structure-of-arrays store
+        void UnbindSoAStore();
+
+        /// The slot this state is bound to (SimDataStore::kInvalidSlot if unbound)
+        uint32_t GetSoASlot() const { return mSoASlot; }
         bool operator== ( SimEntityData const& x );
         bool operator!= ( SimEntityData const& x );
 
@@ -127,7 +155,30 @@ namespace OpenNero
 
         /// Current state
         SimEntityInternals mCurrent;
-        
+
+        /// Double-buffered snapshots handed to the render sync; the
+        /// simulation writes the back buffer while the render side reads
+        /// the front, so the two only meet at the flip in PublishSnapshot
+        SimEntityInternals mSnapshot[2];
+
+        /// Dirty bits carried by each snapshot buffer
+        uint32_t mSnapshotDirty[2];
+
+        /// Index of the snapshot buffer currently visible to the render sync
+        uint32_t mSnapshotFront;
+
+        /// The structure-of-arrays store the hot fields write through to (may be NULL)
+        SimDataStore* mSoAStore;
+
+        /// The slot in the structure-of-arrays store
+        uint32_t mSoASlot;
+
+    public:
+        /// Copies do not inherit the store binding: only the live entity
+        /// state owned by the SimEntity writes through to the arrays
+        SimEntityData( const SimEntityData& other );
+        /// assignment keeps this object's own store binding
+        SimEntityData& operator=( const SimEntityData& other );
     };
 
     /// vector of SimEntityData objects
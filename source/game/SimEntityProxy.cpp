@@ -0,0 +1,101 @@
+//--------------------------------------------------------
+// OpenNero : SimEntityProxy
+//  a stable script-side handle to one simulation entity
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "game/SimEntityProxy.h"
+#include "game/Simulation.h"
+
+namespace OpenNero
+{
+    SimEntityProxy::SimEntityProxy()
+        : mSim()
+        , mId(0)
+    {
+    }
+
+    SimEntityProxy::SimEntityProxy( SimulationPtr sim, SimId id )
+        : mSim(sim)
+        , mId(id)
+    {
+    }
+
+    SimEntity* SimEntityProxy::Resolve() const
+    {
+        return mSim ? mSim->FindByIndex(mId) : NULL;
+    }
+
+    Vector3f SimEntityProxy::GetPosition() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetPosition() : Vector3f(0,0,0);
+    }
+
+    Vector3f SimEntityProxy::GetRotation() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetRotation() : Vector3f(0,0,0);
+    }
+
+    Vector3f SimEntityProxy::GetVelocity() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetVelocity() : Vector3f(0,0,0);
+    }
+
+    Vector3f SimEntityProxy::GetScale() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetScale() : Vector3f(0,0,0);
+    }
+
+    std::string SimEntityProxy::GetLabel() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetLabel() : std::string();
+    }
+
+    SColor SimEntityProxy::GetColor() const
+    {
+        SimEntity* ent = Resolve();
+        return ent ? ent->GetColor() : SColor(255,255,255,255);
+    }
+
+    void SimEntityProxy::SetPosition( const Vector3f& pos )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetPosition(pos);
+    }
+
+    void SimEntityProxy::SetRotation( const Vector3f& rot )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetRotation(rot);
+    }
+
+    void SimEntityProxy::SetVelocity( const Vector3f& vel )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetVelocity(vel);
+    }
+
+    void SimEntityProxy::SetScale( const Vector3f& scale )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetScale(scale);
+    }
+
+    void SimEntityProxy::SetLabel( const std::string& label )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetLabel(label);
+    }
+
+    void SimEntityProxy::SetColor( const SColor& color )
+    {
+        SimEntity* ent = Resolve();
+        if( ent ) ent->SetColor(color);
+    }
+
+} //end OpenNero
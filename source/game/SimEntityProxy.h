@@ -0,0 +1,71 @@
+//--------------------------------------------------------
+// OpenNero : SimEntityProxy
+//  a stable script-side handle to one simulation entity
+//--------------------------------------------------------
+
+#ifndef _GAME_SIMENTITYPROXY_H_
+#define _GAME_SIMENTITYPROXY_H_
+
+#include <string>
+#include "core/Common.h"
+#include "core/IrrUtil.h"
+#include "game/SimEntity.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL( Simulation );
+    /// @endcond
+
+    /**
+     * A lightweight handle to one simulation entity, exported to scripts.
+     * The per-id SimContext accessors hash the id and wrap a shared
+     * pointer on every call; a proxy is created once and resolves its
+     * entity by indexing the simulation's dense id table instead, with
+     * the generation bits of the id catching a recycled slot. A proxy
+     * whose entity has been removed reports invalid; its getters return
+     * defaults and its setters do nothing, so a script can keep a proxy
+     * across the entity's whole lifetime without guarding every access.
+     */
+    class SimEntityProxy
+    {
+    public:
+
+        /// an unbound proxy (never valid)
+        SimEntityProxy();
+
+        /// a proxy for the entity with the given id
+        SimEntityProxy( SimulationPtr sim, SimId id );
+
+        /// is the entity still alive?
+        bool IsValid() const { return Resolve() != NULL; }
+
+        /// the id this proxy was created for
+        SimId GetId() const { return mId; }
+
+        Vector3f GetPosition() const;   ///< position, or zero when stale
+        Vector3f GetRotation() const;   ///< Euler rotation, or zero when stale
+        Vector3f GetVelocity() const;   ///< velocity, or zero when stale
+        Vector3f GetScale() const;      ///< scale, or zero when stale
+        std::string GetLabel() const;   ///< label, or empty when stale
+        SColor GetColor() const;        ///< override color, or white when stale
+
+        void SetPosition( const Vector3f& pos );    ///< set position (no-op when stale)
+        void SetRotation( const Vector3f& rot );    ///< set rotation (no-op when stale)
+        void SetVelocity( const Vector3f& vel );    ///< set velocity (no-op when stale)
+        void SetScale( const Vector3f& scale );     ///< set scale (no-op when stale)
+        void SetLabel( const std::string& label );  ///< set label (no-op when stale)
+        void SetColor( const SColor& color );       ///< set color (no-op when stale)
+
+    private:
+
+        /// the live entity behind the handle, or NULL when it is gone
+        SimEntity* Resolve() const;
+
+        SimulationPtr mSim; ///< the simulation the entity lives in
+        SimId         mId;  ///< generation-stamped id (the slot index is its low bits)
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SIMENTITYPROXY_H_
@@ -2,30 +2,196 @@
 #include "utils/Config.h"
 
 #include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include <boost/bind.hpp>
 
 #include "game/Simulation.h"
 #include "game/SimEntity.h"
+#include "game/StateRecorder.h"
+#include "game/SpectatorStream.h"
+
+#include "core/Bitstream.h"
+
+#include "core/TaskPool.h"
 
 #include "render/SceneObject.h"
 
 #include "ai/AIManager.h"
 #include "ai/AIObject.h"
 #include "ai/AgentBrain.h"
+#include "ai/Environment.h"
 
 namespace OpenNero
 {
+    namespace
+    {
+        /// A meta triangle selector with a bounding-box broadphase. The stock
+        /// Irrlicht meta selector returns the triangles of every child for
+        /// every query regardless of the query volume, so wall collision
+        /// checks paid for the whole world's geometry. This selector keeps
+        /// the child list persistent and, for box and ray queries, only
+        /// descends into children whose scene node's transformed bounding
+        /// box intersects the query volume; triangle-accurate work happens
+        /// only on those broadphase hits. Node boxes are looked up at query
+        /// time, so moving entities need no explicit refit.
+        class BroadphaseTriangleSelector : public scene::IMetaTriangleSelector
+        {
+            std::vector<scene::ITriangleSelector*> mSelectors;
+
+            /// the scene node a child selector reports its triangles against,
+            /// or NULL if it has none (in which case we never cull it)
+            static scene::ISceneNode* GetNode( const scene::ITriangleSelector* selector )
+            {
+                if( selector->getTriangleCount() <= 0 )
+                    return NULL;
+                return selector->getSceneNodeForTriangle(0);
+            }
+
+        public:
+
+            virtual ~BroadphaseTriangleSelector()
+            {
+                removeAllTriangleSelectors();
+            }
+
+            virtual void addTriangleSelector( scene::ITriangleSelector* toAdd )
+            {
+                if( !toAdd )
+                    return;
+                toAdd->grab();
+                mSelectors.push_back(toAdd);
+            }
+
+            virtual bool removeTriangleSelector( scene::ITriangleSelector* toRemove )
+            {
+                std::vector<scene::ITriangleSelector*>::iterator itr =
+                    std::find( mSelectors.begin(), mSelectors.end(), toRemove );
+                if( itr == mSelectors.end() )
+                    return false;
+                (*itr)->drop();
+                mSelectors.erase(itr);
+                return true;
+            }
+
+            virtual void removeAllTriangleSelectors()
+            {
+                for( size_t i = 0; i < mSelectors.size(); ++i )
+                    mSelectors[i]->drop();
+                mSelectors.clear();
+            }
+
+            virtual s32 getTriangleCount() const
+            {
+                s32 count = 0;
+                for( size_t i = 0; i < mSelectors.size(); ++i )
+                    count += mSelectors[i]->getTriangleCount();
+                return count;
+            }
+
+            virtual void getTriangles( core::triangle3df* triangles, s32 arraySize,
+                s32& outTriangleCount, const core::matrix4* transform = 0 ) const
+            {
+                s32 written = 0;
+                for( size_t i = 0; i < mSelectors.size() && written < arraySize; ++i )
+                {
+                    s32 received = 0;
+                    mSelectors[i]->getTriangles( triangles + written, arraySize - written, received, transform );
+                    written += received;
+                }
+                outTriangleCount = written;
+            }
+
+            virtual void getTriangles( core::triangle3df* triangles, s32 arraySize,
+                s32& outTriangleCount, const core::aabbox3d<f32>& box,
+                const core::matrix4* transform = 0 ) const
+            {
+                s32 written = 0;
+                for( size_t i = 0; i < mSelectors.size() && written < arraySize; ++i )
+                {
+                    scene::ISceneNode* node = GetNode(mSelectors[i]);
+                    if( node && !box.intersectsWithBox( node->getTransformedBoundingBox() ) )
+                        continue;
+                    s32 received = 0;
+                    mSelectors[i]->getTriangles( triangles + written, arraySize - written, received, box, transform );
+                    written += received;
+                }
+                outTriangleCount = written;
+            }
+
+            virtual void getTriangles( core::triangle3df* triangles, s32 arraySize,
+                s32& outTriangleCount, const core::line3d<f32>& line,
+                const core::matrix4* transform = 0 ) const
+            {
+                // cull children against the axis-aligned box of the ray
+                core::aabbox3df lineBox(line.start);
+                lineBox.addInternalPoint(line.end);
+
+                s32 written = 0;
+                for( size_t i = 0; i < mSelectors.size() && written < arraySize; ++i )
+                {
+                    scene::ISceneNode* node = GetNode(mSelectors[i]);
+                    if( node && !lineBox.intersectsWithBox( node->getTransformedBoundingBox() ) )
+                        continue;
+                    s32 received = 0;
+                    mSelectors[i]->getTriangles( triangles + written, arraySize - written, received, line, transform );
+                    written += received;
+                }
+                outTriangleCount = written;
+            }
+
+            virtual scene::ISceneNode* getSceneNodeForTriangle( u32 triangleIndex ) const
+            {
+                u32 passed = 0;
+                for( size_t i = 0; i < mSelectors.size(); ++i )
+                {
+                    u32 count = (u32)mSelectors[i]->getTriangleCount();
+                    if( triangleIndex < passed + count )
+                        return mSelectors[i]->getSceneNodeForTriangle( triangleIndex - passed );
+                    passed += count;
+                }
+                return NULL;
+            }
+
+            virtual u32 getSelectorCount() const
+            {
+                return (u32)mSelectors.size();
+            }
+
+            virtual scene::ITriangleSelector* getSelector( u32 index )
+            {
+                return index < mSelectors.size() ? mSelectors[index] : NULL;
+            }
+
+            virtual const scene::ITriangleSelector* getSelector( u32 index ) const
+            {
+                return index < mSelectors.size() ? mSelectors[index] : NULL;
+            }
+        };
+
+        /// how many consecutive quiet ticks a kinematic entity needs
+        /// before the scheduler retires it to the static class
+        const uint32_t kQuietTicksToStatic = 30;
+
+        /// has nothing touched the entity since its last snapshot publish,
+        /// and is it not trying to move on its own?
+        bool IsTickQuiet( const SimEntity& ent )
+        {
+            const SimEntityData& state = ent.GetState();
+            return state.GetDirtyBits() == 0
+                && state.GetVelocity() == Vector3f(0, 0, 0)
+                && state.GetAcceleration() == Vector3f(0, 0, 0);
+        }
+    }
+
     /// Constructor - initialize variables
     Simulation::Simulation( const IrrHandles& irr )
         : mIrr(irr)
         , mMaxId(kFirstSimId)
         , mFrameDelay(GetAppConfig().FrameDelay)
+        , mNextChangeSubscription(1)
     {
-        // initialize entity types
-        for (size_t i = 0; i < sizeof(uint32_t); ++i)
-        {
-            SimEntitySet entitites;
-            mEntityTypes[1 << i] = entitites;
-        }
     }
 
     /// Deconstructor - remove everything
@@ -41,37 +207,129 @@ namespace OpenNero
      * @return true if add was successful and ids didnt not conflict
     */
     void Simulation::AddSimEntity( SimEntityPtr ent )
+    {
+        RegisterSimEntity(ent);
+        SimEntityList batch;
+        batch.push_back(ent);
+        UpdateCollisionSelectors(batch);
+        VerifyMsg( Find(ent->GetSimId()) == ent, "The entity with id " << ent->GetSimId() << " could not be properly added" );
+    }
+
+    void Simulation::AddSimEntities( const SimEntityList& ents )
+    {
+        if (ents.empty()) return;
+        SimEntityList::const_iterator it;
+        for (it = ents.begin(); it != ents.end(); ++it) {
+            RegisterSimEntity(*it);
+        }
+        // one selector pass for the whole batch
+        UpdateCollisionSelectors(ents);
+        for (it = ents.begin(); it != ents.end(); ++it) {
+            VerifyMsg( Find((*it)->GetSimId()) == *it, "The entity with id " << (*it)->GetSimId() << " could not be properly added" );
+        }
+    }
+
+    void Simulation::RegisterSimEntity( SimEntityPtr ent )
     {
         AssertMsg( ent, "Adding a null entity to the simulation!" );
-        AssertMsg( !Find( ent->GetSimId() ), "Entity with id " << ent->GetSimId() << " already exists in the simulation" );
+        VerifyMsg( !Find( ent->GetSimId() ), "Entity with id " << ent->GetSimId() << " already exists in the simulation" );
         mSimIdHashedEntities[ ent->GetSimId() ] = ent;
+
+        { // keep the dense index table in step with the id hash
+            const uint32_t index = GetSimIdIndex( ent->GetSimId() );
+            if( index >= mEntityByIndex.size() )
+                mEntityByIndex.resize( index + 1, NULL );
+            mEntityByIndex[index] = ent.get();
+        }
+
+        mEntityArena.Add(ent);
+        ent->mSharedData.BindSoAStore(&mSimDataStore, mSimDataStore.AllocateSlot());
+        mSpatialIndex.UpdateEntity(ent);
         mEntities.insert(ent);
         mEntitiesAdded.push_back(ent);
+
+        // register the entity with the tick scheduler: anything with an AI
+        // component needs every phase, everything else starts kinematic and
+        // retires itself to the static class once it has settled
+        ent->mSimulation = this;
+        ent->mTickClass = ent->GetAIObject() ? TICK_FULL : TICK_KINEMATIC;
+        ent->mQuietTicks = 0;
+        mDynamicEntities.push_back(ent);
+
         uint32_t ent_type = ent->GetType();
-        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        for (size_t i = 0; i < kNumTypeBits; ++i) {
             uint32_t t = 1 << i;
             if (t > ent_type) break; // shortcut
             if (ent_type & t) {
-                mEntityTypes[t].insert(ent);
+                mTypeBuckets[i].push_back(ent);
             }
         }
 
-        { // also make sure to add the triangle selector for this object to 
-          // all relevant meta selectors
-            hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
-            for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
+        { // track the largest bounding half-extent seen for each of the
+          // entity's type bits; the collision broadphase inflates its grid
+          // queries by this so large objects near a query's edge still make
+          // the candidate list
+            SceneObjectPtr scene_obj = ent->GetSceneObject();
+            if (scene_obj) {
+                const BBoxf bbox = scene_obj->getTransformedBoundingBox();
+                const float32_t half_extent = bbox.getExtent().getLength() * 0.5f;
+                for (uint32_t i = 0; i < sizeof(uint32_t) * 8; ++i) {
+                    uint32_t t = 1 << i;
+                    if (t > ent_type) break;
+                    if ((ent_type & t) && half_extent > mTypeHalfExtents[t]) {
+                        mTypeHalfExtents[t] = half_extent;
+                    }
+                }
+            }
+        }
+
+    }
+
+    void Simulation::UpdateCollisionSelectors( const SimEntityList& ents )
+    {
+        SimEntityList::const_iterator it;
+
+        // add the triangle selectors of the batch to all matching meta
+        // selectors, touching each selector once
+        SelectorMap::iterator iter;
+        for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
+            size_t entities_added = 0;
+            for (it = ents.begin(); it != ents.end(); ++it) {
                 // if the entity type matches the stored mask
-                if (iter->first & ent_type) {
+                if (iter->first & (*it)->GetType()) {
                     // add the triangles to that selector
-                    ITriangleSelector_IPtr tri_selector = ent->GetSceneObject()->GetTriangleSelector();
+                    ITriangleSelector_IPtr tri_selector = (*it)->GetSceneObject()->GetTriangleSelector();
                     iter->second->addTriangleSelector(tri_selector.get());
-                    LOG_F_DEBUG("collision", "added " << tri_selector->getTriangleCount() << " triangles for a total of " << iter->second->getTriangleCount() << " triangles that collide with type " << iter->first);
+                    ++entities_added;
                 }
             }
+            if (entities_added > 0) {
+                LOG_F_DEBUG("collision", "added " << entities_added << " entities for a total of " << iter->second->getTriangleCount() << " triangles that collide with type " << iter->first);
+            }
+        }
+
+        // make sure a meta selector exists for each distinct type mask in
+        // the batch (a freshly created one picks up the whole batch)
+        std::set<uint32_t> masks;
+        for (it = ents.begin(); it != ents.end(); ++it) {
+            masks.insert((*it)->GetType());
+        }
+        std::set<uint32_t>::const_iterator mask;
+        for (mask = masks.begin(); mask != masks.end(); ++mask) {
+            GetCollisionTriangleSelector(*mask);
+        }
+    }
+
+    /**
+     * Request a batch of SimEntities to be removed from the simulation.
+     * Like Remove, the actual work is deferred to the end of the tick,
+     * where the removal pass already handles any number of entities.
+     */
+    void Simulation::RemoveSimEntities( const std::vector<SimId>& ids )
+    {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            Remove(ids[i]);
         }
-        
-        GetCollisionTriangleSelector(ent_type);
-        AssertMsg( Find(ent->GetSimId()) == ent, "The entity with id " << ent->GetSimId() << " could not be properly added" );
     }
 
     /**
@@ -92,28 +350,55 @@ namespace OpenNero
     {
         // clear our internal containers
 
-        // clear out entities hashed by id
+        // unbind entities from the structure-of-arrays store before
+        // dropping it, and recycle their ids so the index space stays
+        // bounded across resets
+        {
+            SimIdHashMap::iterator iter;
+            for (iter = mSimIdHashedEntities.begin(); iter != mSimIdHashedEntities.end(); ++iter) {
+                iter->second->mSharedData.UnbindSoAStore();
+                iter->second->mSimulation = NULL;
+                RecycleSimId(iter->first);
+            }
+            mSimDataStore.clear();
+        }
+
+        // clear out the tick scheduler lists
+        mDynamicEntities.clear();
+        mWakeQueue.clear();
+
+        // drop the change subscriptions; the scripts that held the
+        // handles die with the mod this clear belongs to
+        mChangeSubscriptions.clear();
+
+        // clear out the spatial index
+        mSpatialIndex.clear();
+
+        // clear out entities hashed by id, and the dense index table
         mSimIdHashedEntities.clear();
+        mEntityByIndex.clear();
+
+        // clear out the slot store
+        mEntityArena.clear();
 
         // clear out iteration order list
         mEntities.clear();
 
         // clear out triangle selector cache
         {
-            hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
+            SelectorMap::iterator iter;
             for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
                 iter->second->removeAllTriangleSelectors();
             }
             mCollisionSelectors.clear();
         }
 
-        // clear out type set cache
-        {
-            hash_map<uint32_t, SimEntitySet>::iterator iter;
-            for (iter = mEntityTypes.begin(); iter != mEntityTypes.end(); ++iter) {
-                iter->second.clear();
-            }
-            mEntityTypes.clear();
+        // clear out the broadphase extent high-water marks
+        mTypeHalfExtents.clear();
+
+        // clear out the type buckets
+        for (size_t i = 0; i < kNumTypeBits; ++i) {
+            mTypeBuckets[i].clear();
         }
     }
 
@@ -138,34 +423,281 @@ namespace OpenNero
         return Find( SimId( ConvertSceneIdToSimId(id) ) );
     }
 
+    /**
+     * File the contact an entity's collision response just reported into
+     * the per-tick event batch. The colliding scene node's id decodes
+     * back into a SimId; a contact with geometry that is not a live
+     * entity is recorded with the other side left 0/unknown.
+     * @param ent the entity whose collider fired this tick
+    */
+    void Simulation::RecordCollision( SimEntity& ent )
+    {
+        CollisionEvent event;
+        event.entity = ent.GetSimId();
+        event.type = ent.GetType();
+        event.other = 0;
+        event.otherType = 0;
+        event.point = ent.GetSceneObject()->getCollisionPoint();
+        const S32 sceneId = ent.GetSceneObject()->getCollisionSceneId();
+        if (sceneId > 0)
+        {
+            SimEntityPtr other = FindBySceneObjectId( (SceneObjectId)sceneId );
+            if (other)
+            {
+                event.other = other->GetSimId();
+                event.otherType = other->GetType();
+            }
+        }
+        mCollisionEvents.push_back(event);
+    }
+
+    /**
+     * Register interest in per-tick entity changes.
+     * @param types entity type mask to match (0 matches every type)
+     * @param fields SimEntityData::DataBits mask of the fields to report
+     * @return a handle to fetch and unsubscribe with
+    */
+    uint32_t Simulation::SubscribeChanges( uint32_t types, uint32_t fields )
+    {
+        const uint32_t handle = mNextChangeSubscription++;
+        ChangeSubscription& sub = mChangeSubscriptions[handle];
+        sub.types = types;
+        sub.fields = fields;
+        return handle;
+    }
+
+    /**
+     * Drop a change subscription and whatever is pending on it.
+     * @param subscription the handle returned by SubscribeChanges
+    */
+    void Simulation::UnsubscribeChanges( uint32_t subscription )
+    {
+        mChangeSubscriptions.erase(subscription);
+    }
+
+    /**
+     * Take everything packed for a subscription since its last fetch.
+     * @param subscription the handle returned by SubscribeChanges
+     * @param out receives the packed changes, oldest first
+     * @return false if the handle is unknown
+    */
+    bool Simulation::FetchChanges( uint32_t subscription, std::vector<EntityChange>& out )
+    {
+        ChangeSubscriptionMap::iterator iter = mChangeSubscriptions.find(subscription);
+        if (iter == mChangeSubscriptions.end())
+        {
+            return false;
+        }
+        out.clear();
+        out.swap(iter->second.changes);
+        return true;
+    }
 
     /// move the simulation forward by time dt
     void Simulation::ProcessTick( float32_t dt )
     {
-        // this step will allow mSimIdHashedEntities to be modified during the ticks
-        SimIdHashMap entities_to_tick(mSimIdHashedEntities.begin(), mSimIdHashedEntities.end());
-        SimIdHashMap::const_iterator itr;
-        
-        // render all objects
-        for(itr = entities_to_tick.begin() ; itr != entities_to_tick.end(); ++itr ) {
-			SimEntityPtr ent = itr->second;
-            if (!ent->IsRemoved()) {
-                ent->BeforeTick(dt);
-                ent->TickScene(dt);
+        // last tick's contacts have been read by now; start a fresh batch
+        mCollisionEvents.clear();
+
+        // retired entities a mutator touched since the last tick rejoin
+        // the dynamic list before any of the loops below run, so a script
+        // moving a wall sees the move published and re-indexed this tick
+        for (size_t i = 0; i < mWakeQueue.size(); ++i) {
+            SimEntityPtr ent = Find(mWakeQueue[i]);
+            if (ent && ent->mTickClass == TICK_STATIC && !ent->IsRemoved()) {
+                ent->mTickClass = ent->GetAIObject() ? TICK_FULL : TICK_KINEMATIC;
+                ent->mQuietTicks = 0;
+                mDynamicEntities.push_back(ent);
             }
         }
-        
-        // make AI decisions
+        mWakeQueue.clear();
+
+        // the arena queues mid-tick adds and removes, so the slots can be
+        // walked in place instead of copying the id hash map every frame
+        mEntityArena.BeginIteration();
+
+        const size_t slot_count = mEntityArena.GetSlotCount();
+
+        // capture the deltas accumulated since the last frame before the
+        // snapshot publish below clears the dirty bits; packing happens on
+        // the tick thread, compressing and writing on the recorder's own
+        if (mStateRecorder)
+        {
+            mStateRecorder->BeginFrame(dt);
+            for (size_t slot = 0; slot < slot_count; ++slot) {
+                const SimEntityPtr& ent = mEntityArena.At(slot);
+                if (ent && !ent->IsRemoved() && ent->GetState().GetDirtyBits() != 0) {
+                    mStateRecorder->RecordEntity(ent->GetState());
+                }
+            }
+            mStateRecorder->EndFrame();
+        }
+
+        // pack this tick's changes into each subscriber's pending batch;
+        // like the recorder above, this must read the live dirty bits
+        // before the snapshot publish clears them
+        if (!mChangeSubscriptions.empty())
+        {
+            for (size_t slot = 0; slot < slot_count; ++slot) {
+                const SimEntityPtr& ent = mEntityArena.At(slot);
+                if (!ent || ent->IsRemoved()) {
+                    continue;
+                }
+                const SimEntityData& state = ent->GetState();
+                const uint32_t dirty = state.GetDirtyBits();
+                if (dirty == 0) {
+                    continue;
+                }
+                ChangeSubscriptionMap::iterator iter;
+                for (iter = mChangeSubscriptions.begin(); iter != mChangeSubscriptions.end(); ++iter) {
+                    ChangeSubscription& sub = iter->second;
+                    if (sub.types != 0 && (state.GetType() & sub.types) == 0) {
+                        continue;
+                    }
+                    const uint32_t bits = dirty & sub.fields;
+                    if (bits == 0) {
+                        continue;
+                    }
+                    EntityChange change;
+                    change.id = state.GetId();
+                    change.bits = bits;
+                    if (bits & SimEntityData::kDB_Position) change.position = state.GetPosition();
+                    if (bits & SimEntityData::kDB_Rotation) change.rotation = state.GetRotation();
+                    if (bits & SimEntityData::kDB_Velocity) change.velocity = state.GetVelocity();
+                    if (bits & SimEntityData::kDB_Scale)    change.scale    = state.GetScale();
+                    if (bits & SimEntityData::kDB_Label)    change.label    = state.GetLabel();
+                    if (bits & SimEntityData::kDB_Color)    change.color    = state.GetColor();
+                    sub.changes.push_back(change);
+                }
+            }
+        }
+
+        // flip the per-entity render snapshots: the render sync below (and
+        // eventually a dedicated render thread) reads only the published
+        // front buffer, never the live state the simulation keeps mutating.
+        // Static entities have published their final state long ago, so
+        // only the dynamic list needs the flip.
+        for (size_t i = 0; i < mDynamicEntities.size(); ++i) {
+            if (!mDynamicEntities[i]->IsRemoved()) {
+                mDynamicEntities[i]->PublishState();
+            }
+        }
+
+        // pack the freshly flipped snapshots into the shared-memory
+        // spectator ring; readers only ever see sealed frames, so this
+        // costs the tick thread nothing beyond the copies
+        if (mSpectatorPublisher) {
+            mSpectatorPublisher->BeginFrame(dt);
+            for (size_t slot = 0; slot < slot_count; ++slot) {
+                const SimEntityPtr& ent = mEntityArena.At(slot);
+                if (ent && !ent->IsRemoved()) {
+                    mSpectatorPublisher->RecordEntity(ent->GetState());
+                }
+            }
+            mSpectatorPublisher->EndFrame();
+        }
+
+        // tick the entities that still need per-tick work; walls and other
+        // settled scenery are not on this list at all. Removed entities are
+        // pruned here, and a kinematic entity that has been quiet for long
+        // enough retires to the static class and drops off the list (a
+        // mutator touching it later wakes it through mWakeQueue)
+        for (size_t i = 0; i < mDynamicEntities.size(); /* in loop */) {
+            SimEntityPtr& ent = mDynamicEntities[i];
+            if (ent->IsRemoved()) {
+                ent = mDynamicEntities.back();
+                mDynamicEntities.pop_back();
+                continue;
+            }
+            ent->BeforeTick(dt);
+            ent->TickScene(dt);
+            if (ent->mTickClass == TICK_KINEMATIC && IsTickQuiet(*ent)) {
+                if (++ent->mQuietTicks >= kQuietTicksToStatic) {
+                    ent->mTickClass = TICK_STATIC;
+                    ent = mDynamicEntities.back();
+                    mDynamicEntities.pop_back();
+                    continue;
+                }
+            } else {
+                ent->mQuietTicks = 0;
+            }
+            ++i;
+        }
+
+        // re-file moved entities in the spatial index before the sensors
+        // query it during the AI phase; static entities are already filed
+        // where they will stay
+        for (size_t i = 0; i < mDynamicEntities.size(); ++i) {
+            if (!mDynamicEntities[i]->IsRemoved()) {
+                mSpatialIndex.UpdateEntity(mDynamicEntities[i]);
+            }
+        }
+
+        // make AI decisions: entities whose whole decision path is pure C++
+        // are ticked on the worker pool, the rest (anything that can call
+        // back into Python) stay on the main thread
         if (AIManager::instance().IsEnabled())
         {
-            for(itr = entities_to_tick.begin() ; itr != entities_to_tick.end(); ++itr ) {
-                SimEntityPtr ent = itr->second;
+            // the AI loops below can call into scripts that add entities,
+            // which appends to the dynamic list; freshly added entities are
+            // ticked once through mEntitiesAdded, so the walks stop at the
+            // count the list had when the phase began
+            const size_t dynamic_count = mDynamicEntities.size();
+
+            // collect every sensor ray cast needed this tick and resolve
+            // them in one batch before any brain asks for its observations
+            mRayBatch.clear();
+            for (size_t i = 0; i < dynamic_count; ++i) {
+                const SimEntityPtr ent = mDynamicEntities[i];
                 if (!ent->IsRemoved()) {
-                    ent->TickAI(dt);
+                    ent->QueueRays(mRayBatch);
                 }
             }
+            if (mRayBatch.size() > 0) {
+                if (!mAITaskPool) {
+                    mAITaskPool.reset(new TaskPool());
+                }
+                mRayBatch.Resolve(this, mAITaskPool.get());
+            }
+
+            // an environment that implements the batched stepping interface
+            // has its agents collected and ticked through three script
+            // crossings for the whole arena instead of several per agent
+            EnvironmentPtr world = AIManager::instance().GetEnvironment();
+            BatchEnvironment* batch_env = dynamic_cast<BatchEnvironment*>(world.get());
+            if (batch_env && !batch_env->supports_batch()) {
+                batch_env = NULL;
+            }
+
+            mBatchTickList.clear();
+            mParallelTickList.clear();
+            for (size_t i = 0; i < dynamic_count; ++i) {
+                const SimEntityPtr ent = mDynamicEntities[i];
+                if (!ent->IsRemoved()) {
+                    if (batch_env && ent->GetAIObject()
+                        && ent->GetAIObject()->getWorld() == world) {
+                        mBatchTickList.push_back(ent->GetAIObject());
+                    } else if (ent->IsAITickThreadSafe()) {
+                        mParallelTickList.push_back(ent);
+                    } else {
+                        ent->TickAI(dt);
+                    }
+                }
+            }
+            if (!mParallelTickList.empty()) {
+                if (!mAITaskPool) {
+                    mAITaskPool.reset(new TaskPool());
+                }
+                for (size_t i = 0; i < mParallelTickList.size(); ++i) {
+                    mAITaskPool->Submit(boost::bind(&SimEntity::TickAI, mParallelTickList[i].get(), dt));
+                }
+                mAITaskPool->WaitAll();
+            }
+            if (!mBatchTickList.empty()) {
+                AIObject::ProcessTickBatch(mBatchTickList, dt, *batch_env);
+            }
             SimEntityList::const_iterator added_itr;
-            
+
             // iterate over the freshly added entities as well to ensure that they move if they need to
             for (added_itr = mEntitiesAdded.begin(); added_itr != mEntitiesAdded.end(); ++added_itr)
             {
@@ -176,17 +708,17 @@ namespace OpenNero
                     ent->TickAI(dt);
                 }
             }
-        }                
-        
+        }
+
         mEntitiesAdded.clear();
-        
+
         // iterate over all the entities deleting those marked for removal
-        for (itr = entities_to_tick.begin(); itr != entities_to_tick.end(); ++itr) {
-            SimId id = itr->first;
-            SimEntityPtr ent = itr->second;
-            if (ent->IsRemoved()) {
+        for (size_t slot = 0; slot < slot_count; ++slot) {
+            SimEntityPtr ent = mEntityArena.At(slot);
+            if (ent && ent->IsRemoved()) {
+                SimId id = ent->GetSimId();
                 SimIdHashMap::iterator simItr = mSimIdHashedEntities.find(id);
-                
+
                 if( simItr != mSimIdHashedEntities.end() ) {
                     SimEntityPtr simE = simItr->second;
 					AIObjectPtr brain = simE->GetAIObject();
@@ -199,23 +731,26 @@ namespace OpenNero
                     if (simInSet != mEntities.end()) {
                         mEntities.erase(simInSet);
                     }
-                    
-                    // remove also from the type-indexed set
+
+                    // remove also from the type buckets (swap with the last
+                    // entry so the buckets stay contiguous)
                     uint32_t ent_type = simE->GetType();
-                    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+                    for (size_t i = 0; i < kNumTypeBits; ++i) {
                         uint32_t t = 1 << i;
                         if (t > ent_type) break; // shortcut
                         if (ent_type & t) {
-                            simInSet = mEntityTypes[t].find(simE);
-                            if (simInSet != mEntityTypes[t].end()) {
-                                mEntityTypes[t].erase(simE);
+                            TypeBucket& bucket = mTypeBuckets[i];
+                            TypeBucket::iterator needle = std::find(bucket.begin(), bucket.end(), simE);
+                            if (needle != bucket.end()) {
+                                *needle = bucket.back();
+                                bucket.pop_back();
                             }
                         }
                     }
 
-                    { // also make sure to remove the triangle selector for this object from 
+                    { // also make sure to remove the triangle selector for this object from
                       // all relevant meta selectors
-                        hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
+                        SelectorMap::iterator iter;
                         for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
                             // if the entity type matches the stored mask
                             if (iter->first & ent_type) {
@@ -225,66 +760,326 @@ namespace OpenNero
                         }
                     }
 
+                    mSpatialIndex.RemoveEntity(simE);
+
+                    // release the entity's structure-of-arrays slot
+                    uint32_t soa_slot = simE->mSharedData.GetSoASlot();
+                    if (soa_slot != SimDataStore::kInvalidSlot) {
+                        simE->mSharedData.UnbindSoAStore();
+                        mSimDataStore.FreeSlot(soa_slot);
+                    }
+
+                    // the entity may outlive the simulation in script hands
+                    simE->mSimulation = NULL;
+
                     mSimIdHashedEntities.erase(simItr);
+                    mEntityByIndex[GetSimIdIndex(id)] = NULL;
+
+                    // the index can now serve a future spawn
+                    RecycleSimId(id);
                 }
 
-                AssertMsg( !Find(id), "Did not properly remove entity from simulation!" );
+                // vacate the slot (queued until the iteration ends)
+                mEntityArena.Remove(mEntityArena.HandleAt(slot));
+
+                VerifyMsg( !Find(id), "Did not properly remove entity from simulation!" );
             }
         }
+
+        mEntityArena.EndIteration();
     }
-    
+
     void Simulation::ProcessAnimationTick( float32_t frac )
     {
-        // this step will allow mSimIdHashedEntities to be modified during the ticks
-        SimIdHashMap entities_to_tick(mSimIdHashedEntities.begin(), mSimIdHashedEntities.end());
-        SimIdHashMap::const_iterator itr = entities_to_tick.begin();
-        SimIdHashMap::const_iterator end = entities_to_tick.end();
-        
-        for( ; itr != end; ++itr ) {
-			SimEntityPtr ent = itr->second;
-            ent->ProcessAnimationTick(frac); // tick only if not removed
+        // interpolate every animating transform in one pass over the
+        // packed previous/current arrays; the loop below only moves the
+        // scene nodes of the slots the pass flagged
+        mSimDataStore.InterpolateStates(frac);
+
+        // walk the arena in place; mid-tick adds and removes are queued
+        mEntityArena.BeginIteration();
+
+        const size_t slot_count = mEntityArena.GetSlotCount();
+        for (size_t slot = 0; slot < slot_count; ++slot) {
+            const SimEntityPtr& ent = mEntityArena.At(slot);
+            if (ent) {
+                ent->ApplyAnimationState(mSimDataStore); // tick only if not removed
+            }
         }
+
+        mEntityArena.EndIteration();
     }
-    
-    const SimEntitySet Simulation::GetEntities(size_t types) const
+
+    /**
+     * Sync the scene from externally applied state deltas without running
+     * AI or physics. While a replay drives the entity state, this is all
+     * of the per-tick work that remains.
+     * @param dt the time the replayed frame covers
+    */
+    void Simulation::ProcessReplayTick( float32_t dt )
     {
-        SimEntitySet result;
-        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
-            uint32_t t = 1 << i;
-            // gone past the possible type masks?
-            if (t > types) break;
-            if (types & t) {
-                hash_map<uint32_t, SimEntitySet>::const_iterator type_set = mEntityTypes.find(t);
-                Assert(type_set != mEntityTypes.end());
-                result.insert(type_set->second.begin(), type_set->second.end());
+        // BeforeTick records contacts on this path too
+        mCollisionEvents.clear();
+
+        mEntityArena.BeginIteration();
+
+        const size_t slot_count = mEntityArena.GetSlotCount();
+        for (size_t slot = 0; slot < slot_count; ++slot) {
+            const SimEntityPtr& ent = mEntityArena.At(slot);
+            if (ent && !ent->IsRemoved()) {
+                ent->BeforeTick(dt);
+                ent->TickScene(dt);
             }
         }
+
+        mEntityArena.EndIteration();
+    }
+
+    /**
+     * Start appending per-tick entity state deltas to a binary frame log.
+     * Any recording already in progress is flushed and closed first.
+     * @param fileName path of the recording file to create
+     * @return true if the recording file was opened
+    */
+    bool Simulation::StartRecording( const std::string& fileName )
+    {
+        mStateRecorder.reset( new StateRecorder(fileName) );
+        if( !mStateRecorder->IsOpen() )
+        {
+            mStateRecorder.reset();
+            return false;
+        }
+        return true;
+    }
+
+    /// stop recording and flush the frame log
+    void Simulation::StopRecording()
+    {
+        mStateRecorder.reset();
+    }
+
+    /**
+     * Start publishing the per-tick entity snapshots into a named
+     * shared-memory ring. Any stream already being published is removed
+     * first. The ring is sized generously (a few frames) so a slow
+     * spectator only ever loses frames, never stalls the writer.
+     * @param streamName name of the shared-memory stream
+     * @param maxEntities record capacity of each published frame
+     * @return true if the stream was created
+    */
+    bool Simulation::StartPublishing( const std::string& streamName, uint32_t maxEntities )
+    {
+        // a few slots keep the writer well clear of a reader mid-copy
+        static const uint32_t kFrameSlots = 4;
+        mSpectatorPublisher.reset( new SpectatorPublisher(streamName, kFrameSlots, maxEntities) );
+        if( !mSpectatorPublisher->IsOpen() )
+        {
+            mSpectatorPublisher.reset();
+            return false;
+        }
+        return true;
+    }
+
+    /// stop publishing and remove the shared-memory stream
+    void Simulation::StopPublishing()
+    {
+        mSpectatorPublisher.reset();
+    }
+
+    namespace
+    {
+        /// magic number identifying a world snapshot ('ONWS')
+        const uint32_t kSnapshotMagic = 0x4F4E5753;
+
+        /// version of the snapshot format
+        const uint32_t kSnapshotVersion = 1;
+    }
+
+    /**
+     * Write a versioned binary snapshot of the whole world. The entity
+     * section packs the full restorable state of every entity; the AI
+     * section that follows is written by AIManager.
+     * @param fileName path of the snapshot file to create
+     * @return true if the snapshot was written
+    */
+    bool Simulation::SaveSnapshot( const std::string& fileName )
+    {
+        std::ofstream file( fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if( !file )
+        {
+            LOG_F_ERROR( "game", "could not open world snapshot file " << fileName );
+            return false;
+        }
+
+        Bitstream entities;
+        entities << (uint32_t)mMaxId << (uint32_t)mSimIdHashedEntities.size();
+
+        SimIdHashMap::const_iterator iter;
+        for( iter = mSimIdHashedEntities.begin(); iter != mSimIdHashedEntities.end(); ++iter )
+        {
+            const SimEntityPtr& ent = iter->second;
+            entities << (uint32_t)ent->GetSimId()
+                     << ent->GetPosition()
+                     << ent->GetRotation()
+                     << ent->GetVelocity()
+                     << ent->GetScale()
+                     << ent->GetLabel()
+                     << ent->GetColor()
+                     << ent->GetCollision();
+        }
+
+        Bitstream header;
+        header << kSnapshotMagic << kSnapshotVersion << entities.ByteLength();
+        file.write( (const char*)header.Stream(), header.ByteLength() );
+        file.write( (const char*)entities.Stream(), entities.ByteLength() );
+
+        AIManager::instance().SaveSnapshot( file );
+
+        if( !file )
+        {
+            LOG_F_ERROR( "game", "could not write world snapshot file " << fileName );
+            return false;
+        }
+
+        LOG_F_MSG( "game", "saved world snapshot of " << mSimIdHashedEntities.size()
+                   << " entities to " << fileName );
+        return true;
+    }
+
+    /**
+     * Restore a snapshot written by SaveSnapshot. Records for ids that
+     * are no longer in the simulation are skipped with a warning; the AI
+     * section is handed to AIManager once the entities are restored.
+     * @param fileName path of the snapshot file to read
+     * @return true if the snapshot was applied
+    */
+    bool Simulation::RestoreSnapshot( const std::string& fileName )
+    {
+        std::ifstream file( fileName.c_str(), std::ios::in | std::ios::binary );
+        if( !file )
+        {
+            LOG_F_ERROR( "game", "could not open world snapshot file " << fileName );
+            return false;
+        }
+
+        uint32_t magic = 0, version = 0, entityBytes = 0;
+        file.read( (char*)&magic, sizeof(magic) );
+        file.read( (char*)&version, sizeof(version) );
+        file.read( (char*)&entityBytes, sizeof(entityBytes) );
+        if( !file || magic != kSnapshotMagic || version != kSnapshotVersion )
+        {
+            LOG_F_ERROR( "game", "world snapshot file " << fileName << " has an unknown format" );
+            return false;
+        }
+
+        std::vector<uint8_t> bytes( entityBytes );
+        file.read( (char*)&bytes[0], entityBytes );
+        if( !file )
+        {
+            LOG_F_ERROR( "game", "world snapshot file " << fileName << " is truncated" );
+            return false;
+        }
+
+        BitstreamView view( &bytes[0], entityBytes );
+        uint32_t maxId = 0, count = 0;
+        view >> maxId >> count;
+
+        for( uint32_t i = 0; i < count; ++i )
+        {
+            uint32_t id = 0, collision = 0;
+            Vector3f position, rotation, velocity, scale;
+            std::string label;
+            SColor color;
+            view >> id >> position >> rotation >> velocity >> scale
+                 >> label >> color >> collision;
+
+            SimEntityPtr ent = Find( SimId(id) );
+            if( !ent )
+            {
+                LOG_F_WARNING( "game", "world snapshot entity " << id
+                               << " is no longer in the simulation; skipping it" );
+                continue;
+            }
+
+            ent->SetPosition(position);
+            ent->SetRotation(rotation);
+            ent->SetVelocity(velocity);
+            ent->SetScale(scale);
+            ent->SetLabel(label);
+            ent->SetColor(color);
+            ent->SetCollision(collision);
+        }
+
+        if( maxId > mMaxId )
+            mMaxId = maxId;
+
+        const bool ai_restored = AIManager::instance().RestoreSnapshot( file );
+
+        LOG_F_MSG( "game", "restored world snapshot of " << count
+                   << " entities from " << fileName );
+        return ai_restored;
+    }
+
+    namespace
+    {
+        /// entity visitor that collects the visited entities into a set
+        struct EntitySetInserter
+        {
+            SimEntitySet& set; ///< the set collected into
+
+            explicit EntitySetInserter( SimEntitySet& set ) : set(set) {}
+
+            /// insert one visited entity
+            void operator()( SimEntityPtr ent ) { set.insert(ent); }
+        };
+
+        /// entity visitor that merges the visited entities' triangle
+        /// selectors into a meta selector
+        struct TriangleSelectorInserter
+        {
+            IMetaTriangleSelector_IPtr meta_selector; ///< the selector merged into
+
+            explicit TriangleSelectorInserter( IMetaTriangleSelector_IPtr meta_selector )
+                : meta_selector(meta_selector) {}
+
+            /// add one visited entity's triangle selector
+            void operator()( SimEntityPtr ent )
+            {
+                ITriangleSelector_IPtr tri_selector = ent->GetSceneObject()->GetTriangleSelector();
+                meta_selector->addTriangleSelector(tri_selector.get());
+            }
+        };
+    }
+
+    const SimEntitySet Simulation::GetEntities(size_t types) const
+    {
+        SimEntitySet result;
+        EntitySetInserter inserter(result);
+        ForEachEntity((uint32_t)types, inserter);
         return result;
     }
-    
+
     /// get a triangle selector for all the objects matching the types mask
     IMetaTriangleSelector_IPtr Simulation::GetCollisionTriangleSelector( size_t types )
     {
         IMetaTriangleSelector_IPtr meta_selector;
         
         // first, lookup the type mask in our table
-        hash_map<uint32_t, IMetaTriangleSelector_IPtr>::const_iterator needle;
+        SelectorMap::const_iterator needle;
         needle = mCollisionSelectors.find(types);
         
         if (needle != mCollisionSelectors.end()) {
             // if found, return the selector
             meta_selector = needle->second;
         } else {
-            // if not found, create the selector
-            meta_selector = mIrr.getSceneManager()->createMetaTriangleSelector();
-            SimEntitySet ents = GetEntities(types);
-            // iterate over all entities of that type and add them to the selector
-            for (SimEntitySet::const_iterator iter = ents.begin(); iter != ents.end(); ++iter)
-            {
-                SimEntityPtr ent = *iter;
-                ITriangleSelector_IPtr tri_selector = ent->GetSceneObject()->GetTriangleSelector();
-                meta_selector->addTriangleSelector(tri_selector.get());
-            }
+            // if not found, create the selector (with a bounding-box broadphase
+            // so queries only touch geometry near the query volume)
+            meta_selector = new BroadphaseTriangleSelector();
+            meta_selector->drop(); // the intrusive pointer holds the reference
+            // merge the selector of every entity of that type, without
+            // building an intermediate entity set
+            TriangleSelectorInserter inserter(meta_selector);
+            ForEachEntity((uint32_t)types, inserter);
             // remember for future reuse
             mCollisionSelectors[types] = meta_selector;
             LOG_F_DEBUG("collision", "created triangle selector for mask " 
@@ -294,5 +1089,40 @@ namespace OpenNero
         return meta_selector;
     }
 
+    /// collect the entities whose boxes overlap the query box
+    void Simulation::QueryCollisionCandidates( const BBoxf& box, uint32_t types,
+                                               SimEntityList& out ) const
+    {
+        // the grid indexes entity positions, not extents, so inflate the
+        // query by the largest half-extent recorded for the matching types
+        float32_t inflate = 0;
+        for (uint32_t i = 0; i < sizeof(uint32_t) * 8; ++i) {
+            uint32_t t = 1 << i;
+            if (t > types) break;
+            if (types & t) {
+                TypeExtentMap::const_iterator itr = mTypeHalfExtents.find(t);
+                if (itr != mTypeHalfExtents.end() && itr->second > inflate) {
+                    inflate = itr->second;
+                }
+            }
+        }
+
+        // broadphase: entities whose positions fall within the inflated
+        // bounding sphere of the box (the grid works in NERO coordinates)
+        const Vector3f center = ConvertIrrlichtToNeroPosition(box.getCenter());
+        const float32_t radius = box.getExtent().getLength() * 0.5f + inflate;
+        SimEntityList candidates;
+        mSpatialIndex.QueryRadius(center, radius, types, candidates);
+
+        // narrow the grid hits down to actual box overlaps
+        SimEntityList::const_iterator itr;
+        for (itr = candidates.begin(); itr != candidates.end(); ++itr) {
+            SceneObjectPtr scene_obj = (*itr)->GetSceneObject();
+            if (scene_obj && box.intersectsWithBox(scene_obj->getTransformedBoundingBox())) {
+                out.push_back(*itr);
+            }
+        }
+    }
+
 
 } //end OpenNero
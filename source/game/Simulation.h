@@ -3,20 +3,56 @@
 
 #include <set>
 #include <list>
-#include "core/HashMap.h"
+#include "core/FlatHashMap.h"
 #include "core/Common.h"
 #include "core/IrrUtil.h"
 #include "game/SimEntity.h"
+#include "game/EntityArena.h"
+#include "game/SimDataStore.h"
+#include "game/SpatialIndex.h"
+#include "game/RayBatch.h"
 #include "render/SceneObject.h"
 
 namespace OpenNero
 {
+    class TaskPool;
+
 	/// @cond
     BOOST_SHARED_DECL( SimEntity );
     BOOST_SHARED_DECL( Environment );
     BOOST_SHARED_DECL( Simulation );
+    BOOST_SHARED_DECL( AIObject );
+    BOOST_PTR_DECL( StateRecorder );
+    BOOST_PTR_DECL( SpectatorPublisher );
     /// @endcond
 
+    /// One contact recorded by an entity's collision response during a
+    /// tick. The other side is 0/unknown when the hit geometry does not
+    /// belong to a live simulation entity.
+    struct CollisionEvent
+    {
+        SimId    entity;    ///< the entity whose collider fired
+        SimId    other;     ///< the entity it ran into (0 if unknown)
+        Vector3f point;     ///< contact point in world coordinates
+        uint32_t type;      ///< type mask of entity
+        uint32_t otherType; ///< type mask of other (0 if unknown)
+    };
+
+    /// One entity's changes during a tick, as seen by one change
+    /// subscriber. bits says which of the subscribed fields changed;
+    /// only the fields named in bits carry meaningful values.
+    struct EntityChange
+    {
+        SimId       id;       ///< the entity that changed
+        uint32_t    bits;     ///< changed SimEntityData::DataBits the subscriber asked for
+        Vector3f    position; ///< valid if kDB_Position is in bits
+        Vector3f    rotation; ///< valid if kDB_Rotation is in bits
+        Vector3f    velocity; ///< valid if kDB_Velocity is in bits
+        Vector3f    scale;    ///< valid if kDB_Scale is in bits
+        std::string label;    ///< valid if kDB_Label is in bits
+        SColor      color;    ///< valid if kDB_Color is in bits
+    };
+
     /// The Simulation manages every object in the game that needs to be updated in any sort of way (local or remote).
     /// It manages all of its objects with a given SimId with which the Simulation and the NetConnections can reference
     /// it on any machine
@@ -38,36 +74,121 @@ namespace OpenNero
         /// @param ent the entity to add
         void AddSimEntity( SimEntityPtr ent );
 
+        /// Add a batch of SimEntities in one call. The collision meta
+        /// selectors and the type index are updated once for the whole
+        /// batch instead of once per entity, so spawning a wave of agents
+        /// does not trigger a selector rebuild pass per agent.
+        /// @param ents the entities to add
+        void AddSimEntities( const SimEntityList& ents );
+
         /// Schedule a SimEntity for removal
         /// @param id the id of type to remove by
         void Remove( SimId id );
 
+        /// Schedule a batch of SimEntities for removal. Removal is already
+        /// deferred to the end of the tick, so this is a convenience wrapper
+        /// that mirrors AddSimEntities.
+        /// @param ids the ids of the entities to remove
+        void RemoveSimEntities( const std::vector<SimId>& ids );
+
         // remove all entities
         void clear();
 
         /// find an entity by its simulation ID
         SimEntityPtr Find( SimId id ) const;
 
+        /// Generation-checked direct lookup: index the dense id-index table
+        /// and verify the occupant still carries the id's generation. This
+        /// is the per-tick resolution path of the script-side entity
+        /// proxies; it costs an array index instead of hashing the id and
+        /// copying a shared pointer.
+        /// @return the entity, or NULL if the id is stale or unknown
+        SimEntity* FindByIndex( SimId id ) const
+        {
+            const uint32_t index = GetSimIdIndex(id);
+            if( index >= mEntityByIndex.size() )
+                return NULL;
+            SimEntity* ent = mEntityByIndex[index];
+            if( !ent || ent->GetSimId() != id )
+                return NULL; // the index was recycled for a newer generation
+            return ent;
+        }
+
         /// find an entity by its SceneObject ID
         SimEntityPtr FindBySceneObjectId( SceneObjectId id ) const;
 
         /// Get the set of all the entities in the simulation
-        const SimEntitySet GetEntities() const { return mEntities; }
+        const SimEntitySet& GetEntities() const { return mEntities; }
 
         /// Get the set of all the entities of the specified type
         const SimEntitySet GetEntities( size_t types ) const;
 
-        /// Get the next free SimId
-        SimId ReserveNewId() { mMaxId += 1; return mMaxId; }
+        /// Visit every entity whose type matches the mask without building
+        /// a result set; prefer this on per-tick paths since GetEntities
+        /// copies a set of shared pointers on every call
+        /// @param types bitmask of entity types to match
+        /// @param visit a callable taking a SimEntityPtr, applied exactly
+        ///              once per matching entity
+        template <typename Visitor>
+        void ForEachEntity( uint32_t types, Visitor& visit ) const
+        {
+            for (uint32_t i = 0; i < sizeof(uint32_t) * 8; ++i)
+            {
+                uint32_t t = 1 << i;
+                // gone past the possible type masks?
+                if (t > types) break;
+                if (types & t)
+                {
+                    const TypeBucket& bucket = mTypeBuckets[i];
+                    TypeBucket::const_iterator iter;
+                    for (iter = bucket.begin(); iter != bucket.end(); ++iter)
+                    {
+                        // an entity with several matching type bits lives in
+                        // several per-type buckets; only its lowest matching
+                        // bit visits it
+                        if ((*iter)->GetType() & types & (t - 1))
+                            continue;
+                        visit(*iter);
+                    }
+                }
+            }
+        }
+
+        /// Get the next free SimId, preferring a recycled index (with its
+        /// generation bumped) over growing the id space, so slot-indexed
+        /// side tables stay dense and bounded in long runs
+        SimId ReserveNewId()
+        {
+            if( !mFreeSimIds.empty() )
+            {
+                SimId id = mFreeSimIds.back();
+                mFreeSimIds.pop_back();
+                return id;
+            }
+            mMaxId += 1;
+            AssertMsg( GetSimIdIndex(mMaxId) == mMaxId, "out of SimId index space" );
+            return mMaxId;
+        }
 
         ///@}
 
         /// move the simulation forward by time dt
         void ProcessTick( float32_t dt );
 
+        /// Put a retired (static) entity back on the dynamic tick list at
+        /// the start of the next tick. Called through SimEntity when a
+        /// mutator touches an entity the tick scheduler had stopped
+        /// iterating; waking an entity that is not static is a no-op.
+        /// @param id the id of the entity to wake
+        void WakeEntity( SimId id ) { mWakeQueue.push_back(id); }
+
         /// update for animation only
         void ProcessAnimationTick( float32_t frac );
 
+        /// sync the scene from externally applied state deltas without
+        /// running AI or physics (used while a replay drives the entities)
+        void ProcessReplayTick( float32_t dt );
+
         /// get the time (in seconds) to animate for between AI frames
         float32_t GetFrameDelay() const { return mFrameDelay; }
 
@@ -77,35 +198,227 @@ namespace OpenNero
         /// get a triangle selector for all the objects matching the types mask
         IMetaTriangleSelector_IPtr GetCollisionTriangleSelector( size_t types );
 
+        /// get the structure-of-arrays store for the hot entity transform state
+        const SimDataStore& GetSimDataStore() const { return mSimDataStore; }
+
+        /// collect the entities within radius of pos whose type matches the mask
+        /// @param pos center of the query sphere
+        /// @param radius radius of the query sphere
+        /// @param types bitmask of entity types to match
+        /// @param out the matching entities are appended to this list
+        void QueryRadius( const Vector3f& pos, float32_t radius, uint32_t types,
+                          SimEntityList& out ) const
+        {
+            mSpatialIndex.QueryRadius(pos, radius, types, out);
+        }
+
+        /// Collect the entities whose transformed bounding boxes overlap the
+        /// query box and whose type matches the mask. This is the collision
+        /// broadphase: the spatial grid prunes candidates by position (with
+        /// the query inflated by the largest half-extent on record for the
+        /// matching types, so a big object whose center lies outside the box
+        /// is not missed), then the survivors get an exact box-overlap test.
+        /// @param box the query box, in Irrlicht world coordinates
+        /// @param types bitmask of entity types to match
+        /// @param out the matching entities are appended to this list
+        void QueryCollisionCandidates( const BBoxf& box, uint32_t types,
+                                       SimEntityList& out ) const;
+
+        /// the batch of sensor ray casts resolved each tick
+        RayBatch& GetRayBatch() { return mRayBatch; }
+
+        /// File the contact an entity's collision response just reported
+        /// into the per-tick event batch (called from SimEntity::BeforeTick)
+        /// @param ent the entity whose collider fired this tick
+        void RecordCollision( SimEntity& ent );
+
+        /// Every contact recorded so far this tick, in the order the
+        /// entities ticked. Scripts read the whole batch through one
+        /// get_collision_events() call instead of polling each object.
+        const std::vector<CollisionEvent>& GetCollisionEvents() const { return mCollisionEvents; }
+
+        /// Register interest in per-tick entity changes: every tick, the
+        /// dirty bits of each matching entity are packed into the
+        /// subscription's pending batch (before the snapshot publish
+        /// clears them), so an observer fetches one changeset per tick
+        /// instead of polling every entity for every field. The cost
+        /// scales with how much actually changed, not with world size.
+        /// @param types entity type mask to match (0 matches every type)
+        /// @param fields SimEntityData::DataBits mask of the fields to report
+        /// @return a handle to fetch and unsubscribe with
+        uint32_t SubscribeChanges( uint32_t types, uint32_t fields );
+
+        /// drop a change subscription and whatever is pending on it
+        /// @param subscription the handle returned by SubscribeChanges
+        void UnsubscribeChanges( uint32_t subscription );
+
+        /// Take everything packed for a subscription since its last fetch;
+        /// the pending batch is swapped out, not copied
+        /// @param subscription the handle returned by SubscribeChanges
+        /// @param out receives the packed changes, oldest first
+        /// @return false if the handle is unknown
+        bool FetchChanges( uint32_t subscription, std::vector<EntityChange>& out );
+
+        /// start appending per-tick entity state deltas to a binary frame log
+        /// @param fileName path of the recording file to create
+        /// @return true if the recording file was opened
+        bool StartRecording( const std::string& fileName );
+
+        /// stop recording and flush the frame log
+        void StopRecording();
+
+        /// Start publishing the per-tick entity snapshots into a named
+        /// shared-memory ring that a spectator process can attach to
+        /// read-only, so a headless run can be watched live without
+        /// slowing its ticks
+        /// @param streamName name of the shared-memory stream
+        /// @param maxEntities record capacity of each published frame
+        /// @return true if the stream was created
+        bool StartPublishing( const std::string& streamName, uint32_t maxEntities );
+
+        /// stop publishing and remove the shared-memory stream
+        void StopPublishing();
+
+        /// Write a versioned binary snapshot of the whole world: the full
+        /// state of every entity plus the AI section (rtNEAT populations
+        /// and the NEAT random seed, via AIManager). Saving a warmed-up
+        /// world once lets experiment variants fork from it instead of
+        /// each replaying the warm-up.
+        /// @param fileName path of the snapshot file to create
+        /// @return true if the snapshot was written
+        bool SaveSnapshot( const std::string& fileName );
+
+        /// Restore a snapshot written by SaveSnapshot. Entity records are
+        /// applied to the entities with the same SimId, so the world must
+        /// still contain the entities it had when the snapshot was taken
+        /// (the usual flow saves and restores within one session).
+        /// @param fileName path of the snapshot file to read
+        /// @return true if the snapshot was applied
+        bool RestoreSnapshot( const std::string& fileName );
+
     protected:
 
-        /// hash map of SimEntities indexed by SimId
-        typedef hash_map< SimId, SimEntityPtr > SimIdHashMap;
+        /// hook a single entity into every per-entity structure (id hash,
+        /// arena, SoA store, spatial index, type index, tick scheduler);
+        /// the collision selector update is left to the caller so batch
+        /// adds can do it once
+        void RegisterSimEntity( SimEntityPtr ent );
+
+        /// add the triangle selectors of the given entities to every
+        /// matching collision meta selector and make sure a meta selector
+        /// exists for each distinct type mask in the batch
+        void UpdateCollisionSelectors( const SimEntityList& ents );
+
+        /// return a dead entity's id to the free pool; the recycled id
+        /// keeps the index but carries the next generation, so lookups
+        /// through the stale id miss instead of finding the newcomer
+        void RecycleSimId( SimId id )
+        {
+            uint32_t next_gen = (GetSimIdGeneration(id) + 1)
+                & (((uint32_t)1 << kSimIdGenerationBits) - 1);
+            mFreeSimIds.push_back( MakeSimId(next_gen, GetSimIdIndex(id)) );
+        }
+
+        /// flat hash map of SimEntities indexed by SimId
+        typedef FlatHashMap< SimId, SimEntityPtr > SimIdHashMap;
+
+        /// number of single-bit types in an entity's 32-bit type mask
+        static const size_t kNumTypeBits = sizeof(uint32_t) * 8;
+
+        /// a contiguous bucket of the entities sharing one type bit
+        typedef std::vector<SimEntityPtr> TypeBucket;
+
+        /// flat hash map of meta triangle selectors indexed by type mask
+        typedef FlatHashMap< uint32_t, IMetaTriangleSelector_IPtr > SelectorMap;
+
+        /// flat hash map of bounding half-extents indexed by type bit
+        typedef FlatHashMap< uint32_t, float32_t > TypeExtentMap;
 
         /// a set of simulation IDs
         typedef std::set<SimId> SimIdSet;
 
+        /// One registered change subscriber: what it asked for, and the
+        /// changes packed for it since its last fetch
+        struct ChangeSubscription
+        {
+            uint32_t types;                    ///< entity type mask (0 matches every type)
+            uint32_t fields;                   ///< SimEntityData::DataBits mask of the fields to report
+            std::vector<EntityChange> changes; ///< pending batch, appended per tick
+        };
+
+        /// flat hash map of change subscriptions indexed by handle
+        typedef FlatHashMap< uint32_t, ChangeSubscription > ChangeSubscriptionMap;
+
     protected:
 
         IrrHandles          mIrr;                   ///< Copy of Irrlicht handles
 
         SimIdHashMap        mSimIdHashedEntities;   ///< Our entities hashed by SimId
 
+        /// entities by id index; dense (the id allocator recycles indices),
+        /// so FindByIndex resolves with one array access
+        std::vector<SimEntity*> mEntityByIndex;
+
+        EntityArena         mEntityArena;           ///< Slot store iterated by the tick loops
+
+        SimDataStore        mSimDataStore;          ///< Structure-of-arrays mirror of hot entity state
+
+        SpatialIndex        mSpatialIndex;          ///< Uniform-grid index for proximity queries
+
         SimEntitySet        mEntities;              ///< Set of all the sim entities
 
         SimEntityList       mEntitiesAdded;         ///< Entities are added to this list at first, so that they can be ticked immediately
 
-        hash_map<uint32_t, SimEntitySet> mEntityTypes; ///< entity sets by type
+        /// entity buckets indexed by type bit position; a fixed array of
+        /// contiguous vectors, so the bitmask queries behind the sensors
+        /// neither hash nor allocate
+        TypeBucket mTypeBuckets[kNumTypeBits];
 
         /// the triangle selectors for objects to collide with (by type)
-        mutable hash_map<uint32_t, IMetaTriangleSelector_IPtr> mCollisionSelectors;
+        mutable SelectorMap mCollisionSelectors;
+
+        /// the largest bounding half-extent seen per type bit; a high-water
+        /// mark (never lowered on removal) used to inflate broadphase queries
+        TypeExtentMap mTypeHalfExtents;
 
         EnvironmentPtr      mWorld;                 ///< The AI World interface
 
-        SimId               mMaxId;                 ///< The maximum id of the objects in the simulation
+        SimId               mMaxId;                 ///< The maximum index handed out so far
+
+        std::vector<SimId>  mFreeSimIds;            ///< Recycled ids (next generation already baked in)
 
         float32_t           mFrameDelay;            ///< The time (in seconds) to animate for between AI frames
 
+        boost::shared_ptr<TaskPool> mAITaskPool;    ///< Workers for thread-safe AI ticks (created on demand)
+
+        RayBatch            mRayBatch;              ///< Sensor ray casts collected and resolved per tick
+
+        /// The entities the per-tick loops iterate: everything except the
+        /// static tick class. An entity is on this list if and only if its
+        /// tick class is not TICK_STATIC; kinematic entities drop off once
+        /// they have been quiet long enough, and mWakeQueue puts them back.
+        std::vector<SimEntityPtr> mDynamicEntities;
+
+        /// Ids of retired entities a mutator touched since the last tick;
+        /// drained (and the entities re-listed) at the start of ProcessTick
+        std::vector<SimId> mWakeQueue;
+
+        /// contacts recorded during this tick's physics phase (cleared
+        /// when the next tick begins)
+        std::vector<CollisionEvent> mCollisionEvents;
+
+        ChangeSubscriptionMap mChangeSubscriptions; ///< Registered change subscribers, by handle
+
+        uint32_t mNextChangeSubscription;           ///< The next subscription handle to hand out
+
+        std::vector<SimEntityPtr> mParallelTickList;///< Reused scratch list of entities ticked on the pool
+
+        std::vector<AIObjectPtr> mBatchTickList;    ///< Reused scratch list of agents stepped through the batched environment path
+
+        StateRecorderPtr    mStateRecorder;         ///< Binary frame log of state deltas (NULL unless recording)
+
+        SpectatorPublisherPtr mSpectatorPublisher;  ///< Shared-memory ring of snapshots (NULL unless publishing)
+
     };
 
 } //end OpenNero
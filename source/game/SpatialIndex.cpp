@@ -0,0 +1,114 @@
+#include "core/Common.h"
+
+#include <cmath>
+
+#include "game/SpatialIndex.h"
+
+namespace OpenNero
+{
+    SpatialIndex::SpatialIndex( float32_t cellSize )
+        : mCellSize(cellSize)
+    {
+        AssertMsg( cellSize > 0, "SpatialIndex cell size must be positive" );
+    }
+
+    uint64_t SpatialIndex::GetCellKey( const Vector3f& pos ) const
+    {
+        // quantize to cell coordinates and mix them into one key; key
+        // collisions only make a bucket a superset of one cell, which the
+        // distance test at query time filters back out
+        int64_t ix = static_cast<int64_t>(floor(pos.X / mCellSize));
+        int64_t iy = static_cast<int64_t>(floor(pos.Y / mCellSize));
+        int64_t iz = static_cast<int64_t>(floor(pos.Z / mCellSize));
+        return static_cast<uint64_t>(ix * 73856093LL)
+             ^ static_cast<uint64_t>(iy * 19349663LL)
+             ^ static_cast<uint64_t>(iz * 83492791LL);
+    }
+
+    void SpatialIndex::UpdateEntity( SimEntityPtr ent )
+    {
+        AssertMsg( ent, "Updating a null entity in the spatial index!" );
+        uint64_t key = GetCellKey(ent->GetPosition());
+        EntityCellMap::iterator found = mEntityCells.find(ent->GetSimId());
+        if (found != mEntityCells.end()) {
+            if (found->second == key) {
+                // still in the same cell, nothing to do
+                return;
+            }
+            RemoveFromBucket(found->second, ent);
+            found->second = key;
+        } else {
+            mEntityCells[ent->GetSimId()] = key;
+        }
+        mCells[key].push_back(ent);
+    }
+
+    void SpatialIndex::RemoveEntity( SimEntityPtr ent )
+    {
+        AssertMsg( ent, "Removing a null entity from the spatial index!" );
+        EntityCellMap::iterator found = mEntityCells.find(ent->GetSimId());
+        if (found != mEntityCells.end()) {
+            RemoveFromBucket(found->second, ent);
+            mEntityCells.erase(found);
+        }
+    }
+
+    void SpatialIndex::QueryRadius( const Vector3f& pos, float32_t radius,
+                                    uint32_t types, SimEntityList& out ) const
+    {
+        if (radius <= 0 || types == 0) return;
+
+        const float32_t r2 = radius * radius;
+        int64_t min_x = static_cast<int64_t>(floor((pos.X - radius) / mCellSize));
+        int64_t max_x = static_cast<int64_t>(floor((pos.X + radius) / mCellSize));
+        int64_t min_y = static_cast<int64_t>(floor((pos.Y - radius) / mCellSize));
+        int64_t max_y = static_cast<int64_t>(floor((pos.Y + radius) / mCellSize));
+        int64_t min_z = static_cast<int64_t>(floor((pos.Z - radius) / mCellSize));
+        int64_t max_z = static_cast<int64_t>(floor((pos.Z + radius) / mCellSize));
+
+        for (int64_t ix = min_x; ix <= max_x; ++ix) {
+            for (int64_t iy = min_y; iy <= max_y; ++iy) {
+                for (int64_t iz = min_z; iz <= max_z; ++iz) {
+                    uint64_t key = static_cast<uint64_t>(ix * 73856093LL)
+                                 ^ static_cast<uint64_t>(iy * 19349663LL)
+                                 ^ static_cast<uint64_t>(iz * 83492791LL);
+                    CellMap::const_iterator cell = mCells.find(key);
+                    if (cell == mCells.end()) continue;
+                    const EntityBucket& bucket = cell->second;
+                    for (size_t i = 0; i < bucket.size(); ++i) {
+                        const SimEntityPtr& ent = bucket[i];
+                        if (!(ent->GetType() & types)) continue;
+                        if (ent->GetPosition().getDistanceFromSQ(pos) <= r2) {
+                            out.push_back(ent);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialIndex::clear()
+    {
+        mCells.clear();
+        mEntityCells.clear();
+    }
+
+    void SpatialIndex::RemoveFromBucket( uint64_t key, const SimEntityPtr& ent )
+    {
+        CellMap::iterator cell = mCells.find(key);
+        if (cell == mCells.end()) return;
+        EntityBucket& bucket = cell->second;
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            if (bucket[i] == ent) {
+                // order within a bucket does not matter; swap with the back
+                bucket[i] = bucket.back();
+                bucket.pop_back();
+                break;
+            }
+        }
+        if (bucket.empty()) {
+            mCells.erase(cell);
+        }
+    }
+
+} //end OpenNero
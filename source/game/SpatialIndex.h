@@ -0,0 +1,75 @@
+//--------------------------------------------------------
+// OpenNero : SpatialIndex
+//  an incremental spatial hash over simulation entities
+//--------------------------------------------------------
+
+#ifndef _GAME_SPATIALINDEX_H_
+#define _GAME_SPATIALINDEX_H_
+
+#include <vector>
+#include "core/HashMap.h"
+#include "core/ONTypes.h"
+#include "game/SimEntity.h"
+
+namespace OpenNero
+{
+    /**
+     * A uniform-grid spatial hash over entity positions. Entities are binned
+     * into cells keyed by their quantized coordinates; the Simulation moves an
+     * entity between cells only when its position actually crosses a cell
+     * boundary, so keeping the index current is cheap. Radius queries visit
+     * only the cells covered by the query sphere instead of every entity in
+     * the simulation.
+     */
+    class SpatialIndex
+    {
+    public:
+
+        /// construct the index
+        /// @param cellSize the edge length of a grid cell in world units
+        explicit SpatialIndex( float32_t cellSize = 20.0f );
+
+        /// insert an entity, or move it to its new cell if its position changed
+        void UpdateEntity( SimEntityPtr ent );
+
+        /// remove an entity from the index
+        void RemoveEntity( SimEntityPtr ent );
+
+        /// collect the entities within radius of pos whose type matches the mask
+        /// @param pos center of the query sphere
+        /// @param radius radius of the query sphere
+        /// @param types bitmask of entity types to match (0 matches nothing)
+        /// @param out the matching entities are appended to this list
+        void QueryRadius( const Vector3f& pos, float32_t radius, uint32_t types,
+                          SimEntityList& out ) const;
+
+        /// remove all entities from the index
+        void clear();
+
+    private:
+
+        /// a bucket of entities whose cells hash to the same key
+        typedef std::vector<SimEntityPtr> EntityBucket;
+
+        /// the buckets by cell key
+        typedef hash_map<uint64_t, EntityBucket> CellMap;
+
+        /// the last cell key each indexed entity was filed under
+        typedef hash_map<SimId, uint64_t> EntityCellMap;
+
+        /// compute the cell key for a world position
+        uint64_t GetCellKey( const Vector3f& pos ) const;
+
+        /// remove an entity from a specific bucket
+        void RemoveFromBucket( uint64_t key, const SimEntityPtr& ent );
+
+    private:
+
+        float32_t     mCellSize;    ///< edge length of a grid cell
+        CellMap       mCells;       ///< entity buckets by cell key
+        EntityCellMap mEntityCells; ///< where each entity currently is
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SPATIALINDEX_H_
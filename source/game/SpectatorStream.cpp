@@ -0,0 +1,333 @@
+//--------------------------------------------------------
+// OpenNero : SpectatorStream
+//  shared-memory ring of entity state frames for live spectating
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/Log.h"
+#include "game/SpectatorStream.h"
+
+#include <atomic>
+#include <cstring>
+
+#if !NERO_PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// magic number identifying a spectator ring ('ONSS')
+    const OpenNero::uint32_t kRingMagic = 0x4F4E5353;
+
+    /// version of the ring layout
+    const OpenNero::uint32_t kRingVersion = 1;
+
+    /// Header at the start of the shared-memory ring. The head counter
+    /// is the number of the most recently completed frame; its slot is
+    /// head % frame_slots.
+    struct RingHeader
+    {
+        OpenNero::uint32_t magic;        ///< kRingMagic
+        OpenNero::uint32_t version;      ///< kRingVersion
+        OpenNero::uint32_t frame_slots;  ///< number of frame slots
+        OpenNero::uint32_t max_entities; ///< record capacity per slot
+        std::atomic<OpenNero::uint32_t> head; ///< newest complete frame number
+    };
+
+    /// Header of one frame slot, followed by its records. The sequence
+    /// counter of frame number n is 2n-1 while the writer fills the slot
+    /// and 2n once it is complete, so a reader can tell both a frame in
+    /// progress and a slot reused for a later frame.
+    struct SlotHeader
+    {
+        std::atomic<OpenNero::uint32_t> seq; ///< seqlock counter of the slot
+        OpenNero::uint32_t entity_count;     ///< records in the frame
+        OpenNero::float32_t dt;              ///< tick length of the frame
+    };
+
+    /// bytes occupied by one frame slot
+    size_t SlotBytes( OpenNero::uint32_t maxEntities )
+    {
+        return sizeof(SlotHeader) + maxEntities * sizeof(OpenNero::SpectatorRecord);
+    }
+
+    /// bytes occupied by the whole ring
+    size_t RingBytes( OpenNero::uint32_t frameSlots, OpenNero::uint32_t maxEntities )
+    {
+        return sizeof(RingHeader) + frameSlots * SlotBytes(maxEntities);
+    }
+
+    /// the slot of the given frame number inside the mapped ring
+    SlotHeader* FrameSlot( void* mapping, OpenNero::uint32_t frame )
+    {
+        RingHeader* header = (RingHeader*)mapping;
+        OpenNero::uint8_t* slots = (OpenNero::uint8_t*)mapping + sizeof(RingHeader);
+        return (SlotHeader*)( slots + (frame % header->frame_slots) * SlotBytes(header->max_entities) );
+    }
+
+    /// the record array of a frame slot
+    OpenNero::SpectatorRecord* SlotRecords( SlotHeader* slot )
+    {
+        return (OpenNero::SpectatorRecord*)( (OpenNero::uint8_t*)slot + sizeof(SlotHeader) );
+    }
+}
+
+namespace OpenNero
+{
+
+#if !NERO_PLATFORM_WINDOWS
+
+    /// Create (or replace) the named shared-memory ring
+    SpectatorPublisher::SpectatorPublisher( const std::string& streamName,
+                                            uint32_t frameSlots,
+                                            uint32_t maxEntities ) :
+        mStreamName(streamName),
+        mMapping(NULL),
+        mMappedSize(0),
+        mFrame(0),
+        mCount(0)
+    {
+        const int fd = shm_open( streamName.c_str(), O_CREAT | O_RDWR, 0644 );
+        if( fd < 0 )
+        {
+            LOG_F_ERROR( "game", "could not create spectator stream " << streamName );
+            return;
+        }
+
+        const size_t bytes = RingBytes(frameSlots, maxEntities);
+        if( ftruncate( fd, bytes ) != 0 )
+        {
+            LOG_F_ERROR( "game", "could not size spectator stream " << streamName );
+            close(fd);
+            shm_unlink( streamName.c_str() );
+            return;
+        }
+
+        void* mapping = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        close(fd);
+        if( mapping == MAP_FAILED )
+        {
+            LOG_F_ERROR( "game", "could not map spectator stream " << streamName );
+            shm_unlink( streamName.c_str() );
+            return;
+        }
+
+        std::memset( mapping, 0, bytes );
+        RingHeader* header = (RingHeader*)mapping;
+        header->frame_slots = frameSlots;
+        header->max_entities = maxEntities;
+        header->head.store(0);
+        header->version = kRingVersion;
+        // the magic goes in last so a reader never sees a half-built ring
+        header->magic = kRingMagic;
+
+        mMapping = mapping;
+        mMappedSize = bytes;
+        LOG_F_MSG( "game", "publishing spectator stream " << streamName
+                   << " (" << frameSlots << " frames of up to "
+                   << maxEntities << " entities)" );
+    }
+
+    /// Unmap and unlink the shared-memory ring
+    SpectatorPublisher::~SpectatorPublisher()
+    {
+        if( mMapping )
+        {
+            munmap( mMapping, mMappedSize );
+            shm_unlink( mStreamName.c_str() );
+        }
+    }
+
+    /// Attach read-only to the named shared-memory ring
+    SpectatorView::SpectatorView( const std::string& streamName ) :
+        mMapping(NULL),
+        mMappedSize(0),
+        mLastFrame(0)
+    {
+        const int fd = shm_open( streamName.c_str(), O_RDONLY, 0 );
+        if( fd < 0 )
+        {
+            LOG_F_ERROR( "game", "could not find spectator stream " << streamName );
+            return;
+        }
+
+        struct stat info;
+        if( fstat( fd, &info ) != 0 || info.st_size < (off_t)sizeof(RingHeader) )
+        {
+            LOG_F_ERROR( "game", "spectator stream " << streamName << " is malformed" );
+            close(fd);
+            return;
+        }
+
+        void* mapping = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+        close(fd);
+        if( mapping == MAP_FAILED )
+        {
+            LOG_F_ERROR( "game", "could not map spectator stream " << streamName );
+            return;
+        }
+
+        const RingHeader* header = (const RingHeader*)mapping;
+        if( header->magic != kRingMagic || header->version != kRingVersion
+            || (size_t)info.st_size < RingBytes(header->frame_slots, header->max_entities) )
+        {
+            LOG_F_ERROR( "game", "spectator stream " << streamName << " has an unknown format" );
+            munmap( mapping, info.st_size );
+            return;
+        }
+
+        mMapping = mapping;
+        mMappedSize = info.st_size;
+        LOG_F_MSG( "game", "attached to spectator stream " << streamName );
+    }
+
+    /// Unmap the ring
+    SpectatorView::~SpectatorView()
+    {
+        if( mMapping )
+        {
+            munmap( mMapping, mMappedSize );
+        }
+    }
+
+#else // NERO_PLATFORM_WINDOWS
+
+    SpectatorPublisher::SpectatorPublisher( const std::string& streamName,
+                                            uint32_t, uint32_t ) :
+        mStreamName(streamName),
+        mMapping(NULL),
+        mMappedSize(0),
+        mFrame(0),
+        mCount(0)
+    {
+        LOG_F_ERROR( "game", "spectator streams are not supported on this platform" );
+    }
+
+    SpectatorPublisher::~SpectatorPublisher()
+    {
+    }
+
+    SpectatorView::SpectatorView( const std::string& )
+        : mMapping(NULL), mMappedSize(0), mLastFrame(0)
+    {
+        LOG_F_ERROR( "game", "spectator streams are not supported on this platform" );
+    }
+
+    SpectatorView::~SpectatorView()
+    {
+    }
+
+#endif // NERO_PLATFORM_WINDOWS
+
+    /// true if the shared-memory ring was created successfully
+    bool SpectatorPublisher::IsOpen() const
+    {
+        return mMapping != NULL;
+    }
+
+    /// Start packing a new frame covering a tick of dt seconds
+    void SpectatorPublisher::BeginFrame( float32_t dt )
+    {
+        if( !mMapping )
+            return;
+
+        RingHeader* header = (RingHeader*)mMapping;
+        mFrame = header->head.load(std::memory_order_relaxed) + 1;
+        mCount = 0;
+
+        SlotHeader* slot = FrameSlot(mMapping, mFrame);
+        // odd sequence marks the slot as being written
+        slot->seq.store( mFrame * 2 - 1 );
+        slot->dt = dt;
+    }
+
+    /// Pack the published snapshot of one entity into the frame
+    void SpectatorPublisher::RecordEntity( const SimEntityData& data )
+    {
+        if( !mMapping )
+            return;
+
+        RingHeader* header = (RingHeader*)mMapping;
+        if( mCount >= header->max_entities )
+            return;
+
+        const SimEntityData::SimEntityInternals& snapshot = data.GetSnapshot();
+        SpectatorRecord& record = SlotRecords(FrameSlot(mMapping, mFrame))[mCount];
+        record.id = (uint32_t)data.GetId();
+        record.position = snapshot.mPosition;
+        record.rotation = snapshot.mRotation;
+        record.velocity = snapshot.mVelocity;
+        record.scale = snapshot.mScale;
+        record.color = snapshot.mColor.color;
+        ++mCount;
+    }
+
+    /// Mark the frame complete and advance the ring head
+    void SpectatorPublisher::EndFrame()
+    {
+        if( !mMapping )
+            return;
+
+        RingHeader* header = (RingHeader*)mMapping;
+        SlotHeader* slot = FrameSlot(mMapping, mFrame);
+        slot->entity_count = mCount;
+        // even sequence marks the slot complete; the head advances last so
+        // readers only ever chase frames whose slots are already sealed
+        slot->seq.store( mFrame * 2, std::memory_order_release );
+        header->head.store( mFrame, std::memory_order_release );
+    }
+
+    /// true if the ring was found and its header checked out
+    bool SpectatorView::IsOpen() const
+    {
+        return mMapping != NULL;
+    }
+
+    /**
+     * Copy out the newest complete frame if it is newer than the last
+     * one read. The copy is validated against the slot's sequence
+     * counter afterwards, so a frame the writer lapped mid-copy is
+     * thrown away and retried against the new head.
+     * @param records receives the entity records of the frame
+     * @param dt receives the tick length the frame covers
+     * @return true if a new frame was copied out
+    */
+    bool SpectatorView::ReadLatest( std::vector<SpectatorRecord>& records, float32_t& dt )
+    {
+        if( !mMapping )
+            return false;
+
+        RingHeader* header = (RingHeader*)mMapping;
+
+        for( int attempt = 0; attempt < 4; ++attempt )
+        {
+            const uint32_t frame = header->head.load(std::memory_order_acquire);
+            if( frame == mLastFrame )
+                return false;
+
+            SlotHeader* slot = FrameSlot(mMapping, frame);
+            if( slot->seq.load(std::memory_order_acquire) != frame * 2 )
+                continue; // the writer reused the slot already; chase the new head
+
+            const uint32_t count = slot->entity_count;
+            const float32_t frame_dt = slot->dt;
+            records.resize(count);
+            if( count > 0 )
+                std::memcpy( &records[0], SlotRecords(slot), count * sizeof(SpectatorRecord) );
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if( slot->seq.load(std::memory_order_relaxed) != frame * 2 )
+                continue; // torn copy: the writer lapped us mid-read
+
+            mLastFrame = frame;
+            dt = frame_dt;
+            return true;
+        }
+
+        return false;
+    }
+
+} //end OpenNero
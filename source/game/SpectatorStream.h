@@ -0,0 +1,116 @@
+//--------------------------------------------------------
+// OpenNero : SpectatorStream
+//  shared-memory ring of entity state frames for live spectating
+//--------------------------------------------------------
+
+#ifndef _GAME_SPECTATORSTREAM_H_
+#define _GAME_SPECTATORSTREAM_H_
+
+#include <string>
+#include <vector>
+
+#include "core/Common.h"
+#include "core/IrrUtil.h"
+#include "game/SimEntityData.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_PTR_DECL(SpectatorPublisher);
+    BOOST_PTR_DECL(SpectatorView);
+    /// @endcond
+
+    /// One entity in a spectator frame. The records are copied between
+    /// processes through shared memory, so everything here is plain data.
+    struct SpectatorRecord
+    {
+        uint32_t  id;       ///< SimId of the entity
+        Vector3f  position; ///< position of the entity
+        Vector3f  rotation; ///< Euler rotation of the entity
+        Vector3f  velocity; ///< linear velocity of the entity
+        Vector3f  scale;    ///< scale of the entity
+        uint32_t  color;    ///< packed ARGB color of the entity
+    };
+
+    /**
+     * The writer side of the spectator stream: a ring of fixed-size frame
+     * slots in POSIX shared memory that a headless simulation publishes
+     * its per-tick entity snapshots into. Each slot is guarded by a
+     * sequence counter (odd while the slot is being written), so readers
+     * never block the simulation and a torn read is detected and retried
+     * on the reader side; the tick thread only memcpy-fills the slot.
+     * Not available on Windows.
+     */
+    class SpectatorPublisher
+    {
+    public:
+
+        /// create (or replace) the named shared-memory ring
+        /// @param streamName name of the stream (a shm object name)
+        /// @param frameSlots number of frame slots in the ring
+        /// @param maxEntities record capacity of each frame slot
+        SpectatorPublisher( const std::string& streamName,
+                            uint32_t frameSlots,
+                            uint32_t maxEntities );
+
+        /// unmap and unlink the shared-memory ring
+        ~SpectatorPublisher();
+
+        /// true if the shared-memory ring was created successfully
+        bool IsOpen() const;
+
+        /// start packing a new frame covering a tick of dt seconds
+        void BeginFrame( float32_t dt );
+
+        /// pack the published snapshot of one entity into the frame
+        void RecordEntity( const SimEntityData& data );
+
+        /// mark the frame complete and advance the ring head
+        void EndFrame();
+
+    private:
+
+        std::string mStreamName; ///< shm object name of the ring
+        void*       mMapping;    ///< the mapped ring (NULL if not open)
+        size_t      mMappedSize; ///< size of the mapping in bytes
+        uint32_t    mFrame;      ///< counter of the frame being packed
+        uint32_t    mCount;      ///< records packed into the current frame
+    };
+
+    /**
+     * The reader side of the spectator stream: attaches read-only to the
+     * ring a headless process publishes into and copies out the newest
+     * complete frame. The reader never writes the shared memory, so
+     * spectating has no effect on the simulation's tick rate.
+     */
+    class SpectatorView
+    {
+    public:
+
+        /// attach read-only to the named shared-memory ring
+        explicit SpectatorView( const std::string& streamName );
+
+        /// unmap the ring
+        ~SpectatorView();
+
+        /// true if the ring was found and its header checked out
+        bool IsOpen() const;
+
+        /// Copy out the newest complete frame if it is newer than the
+        /// last one read. Frames the writer laps mid-read are detected
+        /// by their sequence counters and retried.
+        /// @param records receives the entity records of the frame
+        /// @param dt receives the tick length the frame covers
+        /// @return true if a new frame was copied out
+        bool ReadLatest( std::vector<SpectatorRecord>& records, float32_t& dt );
+
+    private:
+
+        void*    mMapping;    ///< the mapped ring (NULL if not open)
+        size_t   mMappedSize; ///< size of the mapping in bytes
+        uint32_t mLastFrame;  ///< counter of the last frame read
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SPECTATORSTREAM_H_
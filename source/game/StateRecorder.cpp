@@ -0,0 +1,176 @@
+//--------------------------------------------------------
+// OpenNero : StateRecorder
+//  binary frame log of per-tick entity state deltas
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/TaskPool.h"
+#include "core/Log.h"
+#include "game/StateRecorder.h"
+
+#include <boost/bind.hpp>
+
+namespace
+{
+    /// magic number identifying a state recording ('ONSR')
+    const OpenNero::uint32_t kRecordingMagic = 0x4F4E5352;
+
+    /// version of the frame format
+    const OpenNero::uint32_t kRecordingVersion = 1;
+
+    /// Pack a buffer with zero-run-length encoding: every zero byte is
+    /// followed by the count of additional zeros after it (up to 255).
+    /// Entity deltas are full of zero bytes (high bytes of masks and ids,
+    /// zeroed vector components), so this shrinks frames considerably
+    /// without an external compression dependency.
+    void PackZeroRuns( const OpenNero::uint8_t* bytes, size_t count, std::vector<OpenNero::uint8_t>& out )
+    {
+        out.clear();
+        out.reserve(count);
+
+        size_t i = 0;
+        while( i < count )
+        {
+            const OpenNero::uint8_t b = bytes[i++];
+            out.push_back(b);
+            if( b == 0 )
+            {
+                OpenNero::uint8_t run = 0;
+                while( i < count && bytes[i] == 0 && run < 255 )
+                {
+                    ++i;
+                    ++run;
+                }
+                out.push_back(run);
+            }
+        }
+    }
+}
+
+namespace OpenNero
+{
+    /// Open the frame log and start the writer thread
+    StateRecorder::StateRecorder( const std::string& fileName ) :
+        mFile( fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc ),
+        mFrame(),
+        mFrameDt(0),
+        mFrameEntities(0)
+    {
+        if( !mFile )
+        {
+            LOG_F_ERROR( "game", "could not open state recording file " << fileName );
+            return;
+        }
+
+        // a single worker keeps the frames in tick order
+        mWriterPool.reset( new TaskPool(1) );
+
+        Bitstream header;
+        header << kRecordingMagic << kRecordingVersion;
+        mFile.write( (const char*)header.Stream(), header.ByteLength() );
+    }
+
+    /// Flush every queued frame and close the log
+    StateRecorder::~StateRecorder()
+    {
+        if( mWriterPool )
+        {
+            mWriterPool->WaitAll();
+        }
+        if( mFile.is_open() )
+        {
+            mFile.close();
+        }
+    }
+
+    /// true if the log file opened successfully
+    bool StateRecorder::IsOpen() const
+    {
+        return mFile.is_open();
+    }
+
+    /// Start packing a new frame covering a tick of dt seconds
+    void StateRecorder::BeginFrame( float32_t dt )
+    {
+        mFrame.reset( new Bitstream() );
+        mFrameDt = dt;
+        mFrameEntities = 0;
+    }
+
+    /**
+     * Pack the dirty fields of one entity into the current frame. Only the
+     * fields selected by the dirty bits are written; replay applies them
+     * over the previous state of the entity.
+     * @param data the entity state to record
+    */
+    void StateRecorder::RecordEntity( const SimEntityData& data )
+    {
+        Assert( mFrame );
+
+        const uint32_t bits = data.GetDirtyBits();
+
+        Bitstream& frame = *mFrame;
+        frame << (uint32_t)data.GetId() << bits;
+
+        if( bits & SimEntityData::kDB_Position )
+            frame << data.GetPosition();
+        if( bits & SimEntityData::kDB_Rotation )
+            frame << data.GetRotation();
+        if( bits & SimEntityData::kDB_Velocity )
+            frame << data.GetVelocity();
+        if( bits & SimEntityData::kDB_Scale )
+            frame << data.GetScale();
+        if( bits & SimEntityData::kDB_Acceleration )
+            frame << data.GetAcceleration();
+        if( bits & SimEntityData::kDB_Label )
+            frame << data.GetLabel();
+        if( bits & SimEntityData::kDB_Color )
+            frame << data.GetColor();
+        if( bits & SimEntityData::kDB_Type )
+            frame << data.GetType();
+        if( bits & SimEntityData::kDB_Collision )
+            frame << data.GetCollision();
+
+        ++mFrameEntities;
+    }
+
+    /// Hand the finished frame to the writer thread
+    void StateRecorder::EndFrame()
+    {
+        Assert( mFrame );
+
+        if( mWriterPool )
+        {
+            mWriterPool->Submit( boost::bind( &StateRecorder::WriteFrame, this, mFrameDt, mFrameEntities, mFrame ) );
+        }
+        mFrame.reset();
+    }
+
+    /**
+     * Compress a frame and append it to the log. Runs on the writer
+     * thread, which is the only place that touches the file after the
+     * header is written.
+     * @param dt tick length of the frame
+     * @param entityCount number of entity records in the frame
+     * @param frame the packed entity records
+    */
+    void StateRecorder::WriteFrame( float32_t dt, uint32_t entityCount, BitstreamPtr frame )
+    {
+        std::vector<uint8_t> packed;
+        const uint32_t rawSize = frame->ByteLength();
+        if( rawSize > 0 )
+        {
+            PackZeroRuns( frame->Stream(), rawSize, packed );
+        }
+
+        Bitstream header;
+        header << dt << entityCount << rawSize << (uint32_t)packed.size();
+
+        mFile.write( (const char*)header.Stream(), header.ByteLength() );
+        if( !packed.empty() )
+        {
+            mFile.write( (const char*)&packed[0], packed.size() );
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,72 @@
+//--------------------------------------------------------
+// OpenNero : StateRecorder
+//  binary frame log of per-tick entity state deltas
+//--------------------------------------------------------
+
+#ifndef _GAME_STATERECORDER_H_
+#define _GAME_STATERECORDER_H_
+
+#include <string>
+#include <fstream>
+
+#include "core/Common.h"
+#include "core/Bitstream.h"
+#include "game/SimEntityData.h"
+
+namespace OpenNero
+{
+    class TaskPool;
+
+    /// @cond
+    BOOST_PTR_DECL(StateRecorder);
+    /// @endcond
+
+    /**
+     * Appends per-tick entity state deltas to a binary frame log for
+     * full-fidelity replay capture. The sim thread only packs the dirty
+     * fields of each changed entity (selected by the SimEntityData dirty
+     * bits) into a frame buffer; compressing and writing the frame happens
+     * on a background writer thread, so the cost on the tick thread stays
+     * proportional to the amount of state that actually changed.
+     */
+    class StateRecorder
+    {
+    public:
+
+        /// open the frame log for writing and start the writer thread
+        explicit StateRecorder( const std::string& fileName );
+
+        /// flush every queued frame and close the log
+        ~StateRecorder();
+
+        /// true if the log file opened successfully
+        bool IsOpen() const;
+
+        /// start packing a new frame covering a tick of dt seconds
+        void BeginFrame( float32_t dt );
+
+        /// pack the dirty fields of one entity into the current frame
+        void RecordEntity( const SimEntityData& data );
+
+        /// hand the finished frame to the writer thread
+        void EndFrame();
+
+    private:
+
+        typedef boost::shared_ptr<Bitstream> BitstreamPtr;
+
+        /// runs on the writer thread: compress the frame and append it
+        void WriteFrame( float32_t dt, uint32_t entityCount, BitstreamPtr frame );
+
+    private:
+
+        std::ofstream               mFile;          ///< the frame log file
+        BitstreamPtr                mFrame;         ///< the frame being packed this tick
+        float32_t                   mFrameDt;       ///< tick length of the current frame
+        uint32_t                    mFrameEntities; ///< entities packed into the current frame
+        boost::shared_ptr<TaskPool> mWriterPool;    ///< single background writer thread
+    };
+
+} //end OpenNero
+
+#endif // _GAME_STATERECORDER_H_
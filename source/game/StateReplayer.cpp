@@ -0,0 +1,257 @@
+//--------------------------------------------------------
+// OpenNero : StateReplayer
+//  playback of a recorded binary frame log
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/Bitstream.h"
+#include "core/IrrUtil.h"
+#include "core/Log.h"
+#include "game/StateReplayer.h"
+#include "game/Simulation.h"
+#include "game/SimEntity.h"
+#include "game/SimEntityData.h"
+
+#include <fstream>
+
+namespace
+{
+    /// magic number identifying a state recording ('ONSR')
+    const OpenNero::uint32_t kRecordingMagic = 0x4F4E5352;
+
+    /// version of the frame format
+    const OpenNero::uint32_t kRecordingVersion = 1;
+
+    /// Undo the zero-run-length encoding of StateRecorder: every zero byte
+    /// in the packed data is followed by the count of additional zeros.
+    /// @return true if exactly rawSize bytes were recovered
+    bool UnpackZeroRuns( const OpenNero::uint8_t* packed, size_t packedSize,
+                         std::vector<OpenNero::uint8_t>& out, size_t rawSize )
+    {
+        out.clear();
+        out.reserve(rawSize);
+
+        size_t i = 0;
+        while( i < packedSize && out.size() < rawSize )
+        {
+            const OpenNero::uint8_t b = packed[i++];
+            out.push_back(b);
+            if( b == 0 )
+            {
+                if( i >= packedSize )
+                    return false;
+                OpenNero::uint8_t run = packed[i++];
+                while( run-- > 0 )
+                    out.push_back(0);
+            }
+        }
+
+        return out.size() == rawSize;
+    }
+}
+
+namespace OpenNero
+{
+    /// Load a frame log written by StateRecorder and index its frames
+    StateReplayer::StateReplayer( const std::string& fileName ) :
+        mNextFrame(0),
+        mOpen(false)
+    {
+        std::ifstream in( fileName.c_str(), std::ios::in | std::ios::binary );
+        if( !in )
+        {
+            LOG_F_ERROR( "game", "could not open state recording file " << fileName );
+            return;
+        }
+
+        in.seekg( 0, std::ios::end );
+        const std::streampos size = in.tellg();
+        in.seekg( 0, std::ios::beg );
+        if( size <= 0 )
+        {
+            LOG_F_ERROR( "game", "state recording file " << fileName << " is empty" );
+            return;
+        }
+
+        mBytes.resize( (size_t)size );
+        in.read( (char*)&mBytes[0], size );
+
+        BitstreamView view( &mBytes[0], (uint32_t)mBytes.size() );
+
+        uint32_t magic, version;
+        if( view.ByteLength() < 8 )
+            return;
+        view >> magic >> version;
+        if( magic != kRecordingMagic || version != kRecordingVersion )
+        {
+            LOG_F_ERROR( "game", "state recording file " << fileName << " has an unknown format" );
+            return;
+        }
+
+        // build the frame index by walking the frame headers
+        while( view.ByteLength() >= 16 )
+        {
+            FrameInfo frame;
+            view >> frame.mDt >> frame.mEntityCount >> frame.mRawSize >> frame.mPackedSize;
+            if( frame.mPackedSize > view.ByteLength() )
+            {
+                LOG_F_WARNING( "game", "state recording file " << fileName << " is truncated" );
+                break;
+            }
+            frame.mOffset = mBytes.size() - view.ByteLength();
+            view.PopSpan( frame.mPackedSize );
+            mFrames.push_back(frame);
+        }
+
+        mOpen = true;
+        LOG_F_MSG( "game", "loaded state recording " << fileName << " with " << mFrames.size() << " frames" );
+    }
+
+    /// true if the log loaded and its header checked out
+    bool StateReplayer::IsOpen() const
+    {
+        return mOpen;
+    }
+
+    /// total number of frames in the log
+    uint32_t StateReplayer::GetFrameCount() const
+    {
+        return (uint32_t)mFrames.size();
+    }
+
+    /// the index of the next frame to apply
+    uint32_t StateReplayer::GetCurrentFrame() const
+    {
+        return mNextFrame;
+    }
+
+    /// true if every frame has been applied
+    bool StateReplayer::IsFinished() const
+    {
+        return mNextFrame >= mFrames.size();
+    }
+
+    /// the tick length the next frame was recorded with (0 at the end)
+    float32_t StateReplayer::GetNextFrameDt() const
+    {
+        return IsFinished() ? 0 : mFrames[mNextFrame].mDt;
+    }
+
+    /// go back to the first frame
+    void StateReplayer::Rewind()
+    {
+        mNextFrame = 0;
+    }
+
+    /**
+     * Apply the next frame's deltas to the simulation.
+     * @param sim the simulation whose entities receive the deltas
+     * @return false if there are no frames left
+    */
+    bool StateReplayer::AdvanceFrame( Simulation& sim )
+    {
+        if( IsFinished() )
+            return false;
+
+        ApplyFrame( mFrames[mNextFrame], sim );
+        ++mNextFrame;
+        return true;
+    }
+
+    /**
+     * Apply frames until the given frame index has been applied. Frames
+     * are deltas over the previous state, so seeking backwards rewinds
+     * and re-applies from the start of the log.
+     * @param frame the index of the last frame to apply
+     * @param sim the simulation whose entities receive the deltas
+     * @return false if frame is out of range
+    */
+    bool StateReplayer::SeekFrame( uint32_t frame, Simulation& sim )
+    {
+        if( frame >= mFrames.size() )
+            return false;
+
+        if( frame + 1 < mNextFrame )
+            Rewind();
+
+        while( mNextFrame <= frame )
+            AdvanceFrame(sim);
+
+        return true;
+    }
+
+    /**
+     * Unpack one frame and apply its entity records. Records for ids that
+     * are not in the simulation (entities not re-created for the replay)
+     * are skipped.
+     * @param frame the frame to apply
+     * @param sim the simulation whose entities receive the deltas
+    */
+    void StateReplayer::ApplyFrame( const FrameInfo& frame, Simulation& sim )
+    {
+        if( frame.mRawSize == 0 )
+            return;
+
+        if( !UnpackZeroRuns( &mBytes[frame.mOffset], frame.mPackedSize, mUnpacked, frame.mRawSize ) )
+        {
+            LOG_F_WARNING( "game", "skipping corrupt frame " << mNextFrame << " of state recording" );
+            return;
+        }
+
+        BitstreamView view( &mUnpacked[0], (uint32_t)mUnpacked.size() );
+
+        for( uint32_t i = 0; i < frame.mEntityCount; ++i )
+        {
+            uint32_t id, bits;
+            view >> id >> bits;
+
+            Vector3f position, rotation, velocity, scale, acceleration;
+            std::string label;
+            SColor color;
+            uint32_t type = 0, collision = 0;
+
+            // every recorded field has to be consumed to stay in sync,
+            // even for entities that are not present in the simulation
+            if( bits & SimEntityData::kDB_Position )
+                view >> position;
+            if( bits & SimEntityData::kDB_Rotation )
+                view >> rotation;
+            if( bits & SimEntityData::kDB_Velocity )
+                view >> velocity;
+            if( bits & SimEntityData::kDB_Scale )
+                view >> scale;
+            if( bits & SimEntityData::kDB_Acceleration )
+                view >> acceleration;
+            if( bits & SimEntityData::kDB_Label )
+                view >> label;
+            if( bits & SimEntityData::kDB_Color )
+                view >> color;
+            if( bits & SimEntityData::kDB_Type )
+                view >> type;
+            if( bits & SimEntityData::kDB_Collision )
+                view >> collision;
+
+            SimEntityPtr ent = sim.Find( SimId(id) );
+            if( !ent )
+                continue;
+
+            if( bits & SimEntityData::kDB_Position )
+                ent->SetPosition(position);
+            if( bits & SimEntityData::kDB_Rotation )
+                ent->SetRotation(rotation);
+            if( bits & SimEntityData::kDB_Velocity )
+                ent->SetVelocity(velocity);
+            if( bits & SimEntityData::kDB_Scale )
+                ent->SetScale(scale);
+            if( bits & SimEntityData::kDB_Label )
+                ent->SetLabel(label);
+            if( bits & SimEntityData::kDB_Color )
+                ent->SetColor(color);
+            if( bits & SimEntityData::kDB_Collision )
+                ent->SetCollision(collision);
+            // acceleration and type have no SimEntity setters; they are
+            // consumed above to keep the record aligned
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,93 @@
+//--------------------------------------------------------
+// OpenNero : StateReplayer
+//  playback of a recorded binary frame log
+//--------------------------------------------------------
+
+#ifndef _GAME_STATEREPLAYER_H_
+#define _GAME_STATEREPLAYER_H_
+
+#include <string>
+#include <vector>
+
+#include "core/Common.h"
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    class Simulation;
+
+    /// @cond
+    BOOST_PTR_DECL(StateReplayer);
+    /// @endcond
+
+    /**
+     * Plays back a frame log written by StateRecorder, applying the
+     * recorded SimEntityData deltas to the entities in a Simulation by
+     * their SimId. Replay does no AI evaluation, so a long training run
+     * can be scrubbed through at whatever rate the caller advances
+     * frames. The whole log is held in memory with a frame index built
+     * at load, making sequential stepping and forward seeks cheap;
+     * seeking backwards rewinds and re-applies from the start, since
+     * frames are deltas over the previous state.
+     */
+    class StateReplayer
+    {
+    public:
+
+        /// load a frame log written by StateRecorder
+        explicit StateReplayer( const std::string& fileName );
+
+        /// true if the log loaded and its header checked out
+        bool IsOpen() const;
+
+        /// total number of frames in the log
+        uint32_t GetFrameCount() const;
+
+        /// the index of the next frame to apply
+        uint32_t GetCurrentFrame() const;
+
+        /// true if every frame has been applied
+        bool IsFinished() const;
+
+        /// the tick length the next frame was recorded with (0 at the end)
+        float32_t GetNextFrameDt() const;
+
+        /// go back to the first frame
+        void Rewind();
+
+        /// apply the next frame's deltas to the simulation
+        /// @return false if there are no frames left
+        bool AdvanceFrame( Simulation& sim );
+
+        /// apply frames until the given frame index has been applied;
+        /// seeking backwards replays from the start of the log
+        /// @return false if frame is out of range
+        bool SeekFrame( uint32_t frame, Simulation& sim );
+
+    private:
+
+        /// location of one frame in the loaded log
+        struct FrameInfo
+        {
+            float32_t   mDt;            ///< tick length the frame was recorded with
+            uint32_t    mEntityCount;   ///< number of entity records in the frame
+            uint32_t    mRawSize;       ///< unpacked payload size in bytes
+            uint32_t    mPackedSize;    ///< packed payload size in bytes
+            size_t      mOffset;        ///< offset of the packed payload in the log
+        };
+
+        /// unpack and apply one frame's deltas
+        void ApplyFrame( const FrameInfo& frame, Simulation& sim );
+
+    private:
+
+        std::vector<uint8_t>    mBytes;     ///< the whole log, loaded up front
+        std::vector<FrameInfo>  mFrames;    ///< index of every frame in the log
+        std::vector<uint8_t>    mUnpacked;  ///< reused frame decode buffer
+        uint32_t                mNextFrame; ///< index of the next frame to apply
+        bool                    mOpen;      ///< did the log load successfully?
+    };
+
+} //end OpenNero
+
+#endif // _GAME_STATEREPLAYER_H_
@@ -0,0 +1,121 @@
+#include "core/Common.h"
+#include "game/TickGovernor.h"
+
+#include "ai/AIManager.h"
+#include "core/Log.h"
+#include "render/LabelSet.h"
+#include "render/LineSet.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// deepest level of the shedding ladder (level 0 sheds nothing)
+        const uint32_t kMaxLevel = 3;
+
+        /// raise the level after this many consecutive over-budget ticks
+        const uint32_t kRaiseAfterTicks = 30;
+
+        /// lower it only after this many consecutive ticks under the
+        /// restore margin, so the knobs do not flap around the budget
+        const uint32_t kLowerAfterTicks = 180;
+
+        /// fraction of the budget the smoothed tick time must stay under
+        /// before a level is restored
+        const float64_t kLowerMargin = 0.7;
+
+        /// weight of the newest tick in the moving average
+        const float64_t kSmoothing = 0.1;
+
+        /// short description of each level for the decision log
+        const char* kLevelNames[kMaxLevel + 1] = {
+            "nothing shed",
+            "debug overlays off",
+            "overlays off, agent decisions stretched 2x",
+            "overlays off, agent decisions stretched 4x",
+        };
+    }
+
+    TickGovernor& TickGovernor::instance()
+    {
+        static TickGovernor me;
+        return me;
+    }
+
+    TickGovernor::TickGovernor()
+        : mBudgetMillis(0)
+        , mSmoothedMillis(0)
+        , mLevel(0)
+        , mOverTicks(0)
+        , mUnderTicks(0)
+    {
+    }
+
+    void TickGovernor::SetBudget(float32_t milliseconds)
+    {
+        if (milliseconds > 0)
+        {
+            LOG_F_MSG("game", "tick governor enabled: budget " << milliseconds << " ms");
+        }
+        else
+        {
+            milliseconds = 0;
+            LOG_F_MSG("game", "tick governor disabled");
+        }
+        mBudgetMillis = milliseconds;
+        mSmoothedMillis = 0;
+        mOverTicks = 0;
+        mUnderTicks = 0;
+        if (mLevel != 0 && !IsEnabled())
+        {
+            ApplyLevel(0);
+        }
+    }
+
+    void TickGovernor::EndTick(uint64_t elapsedNanos)
+    {
+        if (!IsEnabled())
+            return;
+
+        const float64_t millis = elapsedNanos * 1e-6;
+        mSmoothedMillis = mSmoothedMillis > 0
+            ? mSmoothedMillis + kSmoothing * (millis - mSmoothedMillis)
+            : millis;
+
+        if (mSmoothedMillis > mBudgetMillis)
+        {
+            mUnderTicks = 0;
+            if (++mOverTicks >= kRaiseAfterTicks && mLevel < kMaxLevel)
+            {
+                ApplyLevel(mLevel + 1);
+                mOverTicks = 0;
+            }
+        }
+        else if (mSmoothedMillis < mBudgetMillis * kLowerMargin)
+        {
+            mOverTicks = 0;
+            if (++mUnderTicks >= kLowerAfterTicks && mLevel > 0)
+            {
+                ApplyLevel(mLevel - 1);
+                mUnderTicks = 0;
+            }
+        }
+        else
+        {
+            // inside the hysteresis band: hold the current level
+            mOverTicks = 0;
+            mUnderTicks = 0;
+        }
+    }
+
+    void TickGovernor::ApplyLevel(uint32_t level)
+    {
+        LOG_F_MSG("game", "tick governor: " << kLevelNames[level]
+            << " (tick " << mSmoothedMillis << " ms, budget " << mBudgetMillis << " ms)");
+        mLevel = level;
+        const bool overlays = (level < 1);
+        LabelSet::instance().SetRenderEnabled(overlays);
+        LineSet::instance().SetRenderEnabled(overlays);
+        AIManager::instance().SetDecisionStretch(level >= 3 ? 4 : (level >= 2 ? 2 : 1));
+    }
+}
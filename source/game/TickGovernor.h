@@ -0,0 +1,62 @@
+//--------------------------------------------------------
+// OpenNero : TickGovernor
+//  sheds optional per-tick work to hold a time budget
+//--------------------------------------------------------
+
+#ifndef _GAME_TICKGOVERNOR_H_
+#define _GAME_TICKGOVERNOR_H_
+
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * The TickGovernor watches the measured duration of each simulation
+     * tick and, when a time budget is set, sheds optional work to hold
+     * it: first the debug overlays (entity labels and line segments),
+     * then the agents' decision rate through AIManager's global decision
+     * stretch. Shedding moves one level at a time with hysteresis — a
+     * level is raised only after the smoothed tick time has been over
+     * budget for a stretch of ticks and lowered only after it has been
+     * comfortably under — so a single slow frame does not flap the
+     * knobs, and every decision is logged.
+     */
+    class TickGovernor
+    {
+    public:
+        /// singleton instance
+        static TickGovernor& instance();
+
+        /// Hold the simulation tick under the given budget by shedding
+        /// optional work (0 disables the governor and restores all work)
+        /// @param milliseconds the per-tick time budget
+        void SetBudget(float32_t milliseconds);
+
+        /// the per-tick time budget in milliseconds (0 = disabled)
+        float32_t GetBudget() const { return mBudgetMillis; }
+
+        /// true iff a budget is set
+        bool IsEnabled() const { return mBudgetMillis > 0; }
+
+        /// the current shedding level (0 = nothing shed)
+        uint32_t GetShedLevel() const { return mLevel; }
+
+        /// account a finished tick and adjust the shedding level
+        /// @param elapsedNanos measured duration of the tick
+        void EndTick(uint64_t elapsedNanos);
+
+    private:
+        TickGovernor();
+
+        /// apply a shedding level's knob settings (and log the change)
+        void ApplyLevel(uint32_t level);
+
+        float32_t mBudgetMillis;   ///< per-tick budget (0 = disabled)
+        float64_t mSmoothedMillis; ///< exponential moving average of tick time
+        uint32_t mLevel;           ///< current shedding level
+        uint32_t mOverTicks;       ///< consecutive ticks over budget
+        uint32_t mUnderTicks;      ///< consecutive ticks comfortably under
+    };
+}
+
+#endif // _GAME_TICKGOVERNOR_H_
@@ -11,13 +11,19 @@
 #include "core/Common.h"
 #include "core/IrrSerialize.h"
 #include "game/factories/IrrFactory.h"
+#include "game/factories/ResourceCache.h"
 #include "game/factories/SimFactory.h"
 #include "game/Kernel.h"
+#include "game/Mod.h"
 
 #include "render/Shader.h"
 
 #include "core/LogConnections.h"
 #include "core/Log.h"
+#include "core/TaskPool.h"
+
+#include <fstream>
+#include <boost/bind.hpp>
 
 namespace OpenNero
 {
@@ -45,7 +51,7 @@ namespace OpenNero
             virtual void render();
             void setAxesCoordinates();
 
-            virtual const core::aabbox3d<f32>& getBoundingBox() const
+            virtual const irr::core::aabbox3d<f32>& getBoundingBox() const
             {
                 return ZMeshBuffer.BoundingBox;
             }
@@ -56,6 +62,104 @@ namespace OpenNero
 
     }
 
+    /// A proxy for one instance of a shared mesh. The node takes part in the
+    /// scene graph transformation pass like any other node, but never renders
+    /// itself - the owning InstancedMeshSceneNode draws the shared mesh once
+    /// per proxy with the proxy's absolute transform and color.
+    class InstanceSceneNode : public scene::ISceneNode
+    {
+        aabbox3df mBox;         ///< bounding box of the shared mesh
+        video::SColor mColor;   ///< per-instance diffuse color
+
+    public:
+        InstanceSceneNode( scene::ISceneNode* parent, scene::ISceneManager* mgr, const aabbox3df& box )
+            : scene::ISceneNode(parent, mgr, -1)
+            , mBox(box)
+            , mColor(255,255,255,255)
+        {}
+
+        virtual void render() {}
+
+        virtual const aabbox3df& getBoundingBox() const { return mBox; }
+
+        /// set the per-instance diffuse color
+        void setColor( const video::SColor& color ) { mColor = color; }
+
+        /// get the per-instance diffuse color
+        const video::SColor& getColor() const { return mColor; }
+    };
+
+    /// Renders every instance of a shared static mesh through one scene node.
+    /// Material state is set once per mesh buffer instead of once per entity,
+    /// so 200 identical agents no longer mean 200 material switches.
+    class InstancedMeshSceneNode : public scene::ISceneNode
+    {
+        scene::IMesh* mMesh;    ///< the shared mesh (frame 0 of the source)
+
+    public:
+        InstancedMeshSceneNode( scene::ISceneNode* parent, scene::ISceneManager* mgr, scene::IMesh* mesh )
+            : scene::ISceneNode(parent, mgr, -1)
+            , mMesh(mesh)
+        {
+            mMesh->grab();
+            // the instances are spread throughout the world, so don't cull
+            // the batch by its local bounding box
+            setAutomaticCulling( scene::EAC_OFF );
+        }
+
+        virtual ~InstancedMeshSceneNode()
+        {
+            mMesh->drop();
+        }
+
+        virtual void OnRegisterSceneNode()
+        {
+            if( IsVisible )
+                SceneManager->registerNodeForRendering( this, scene::ESNRP_SOLID );
+            ISceneNode::OnRegisterSceneNode();
+        }
+
+        virtual void render()
+        {
+            video::IVideoDriver* driver = SceneManager->getVideoDriver();
+            const core::list<scene::ISceneNode*>& instances = getChildren();
+            if( instances.empty() )
+                return;
+
+            for( u32 b = 0; b < mMesh->getMeshBufferCount(); ++b )
+            {
+                scene::IMeshBuffer* buffer = mMesh->getMeshBuffer(b);
+                video::SMaterial material = buffer->getMaterial();
+                driver->setMaterial(material);
+
+                core::list<scene::ISceneNode*>::ConstIterator itr = instances.begin();
+                for( ; itr != instances.end(); ++itr )
+                {
+                    InstanceSceneNode* instance = static_cast<InstanceSceneNode*>(*itr);
+                    if( !instance->isVisible() )
+                        continue;
+                    if( instance->getColor() != material.DiffuseColor )
+                    {
+                        material.DiffuseColor = instance->getColor();
+                        driver->setMaterial(material);
+                    }
+                    driver->setTransform( video::ETS_WORLD, instance->getAbsoluteTransformation() );
+                    driver->drawMeshBuffer(buffer);
+                }
+            }
+        }
+
+        virtual const aabbox3df& getBoundingBox() const { return mMesh->getBoundingBox(); }
+
+        /// add a new instance proxy of the shared mesh
+        InstanceSceneNode* addInstance()
+        {
+            InstanceSceneNode* instance = new InstanceSceneNode( this, SceneManager, mMesh->getBoundingBox() );
+            instance->drop(); // the batch node keeps the only reference
+            return instance;
+        }
+    };
+
     /// CTOR
     IrrFactory::IrrFactory( const IrrHandles& irr )
             : mIrr(irr)
@@ -72,7 +176,48 @@ namespace OpenNero
     */
     IAnimatedMesh* IrrFactory::LoadAniMesh( const std::string& modelFile )
     {
-        return mIrr.getSceneManager()->getMesh( SimFactory::TransformPath(modelFile).c_str() );
+        std::string path = SimFactory::TransformPath(modelFile);
+
+        // a baked mod bundle serves the bytes straight from its mapping,
+        // with no file open and no copy
+        const char* bundleData;
+        size_t bundleSize;
+        if( Kernel::instance().getMod()->FindResourceBytes( path, bundleData, bundleSize ) )
+        {
+            irr::io::IReadFile* file = mIrr.getDevice()->getFileSystem()->createMemoryReadFile(
+                (void*)bundleData, (s32)bundleSize, path.c_str(), false );
+            if( file )
+            {
+                IAnimatedMesh* mesh = mIrr.getSceneManager()->getMesh( file );
+                file->drop();
+                if( mesh )
+                {
+                    LOG_D_MSG( "factory_resource_log", "Loaded bundled mesh " << path );
+                    return mesh;
+                }
+            }
+        }
+
+        // if the background loader prefetched the file, build the mesh from
+        // the in-memory bytes so the sim thread never waits on the disk
+        AssetBytesPtr bytes = TakeAssetBytes(path);
+        if( bytes && !bytes->empty() )
+        {
+            irr::io::IReadFile* file = mIrr.getDevice()->getFileSystem()->createMemoryReadFile(
+                &(*bytes)[0], (s32)bytes->size(), path.c_str(), false );
+            if( file )
+            {
+                IAnimatedMesh* mesh = mIrr.getSceneManager()->getMesh( file );
+                file->drop();
+                if( mesh )
+                {
+                    LOG_D_MSG( "factory_resource_log", "Loaded prefetched mesh " << path );
+                    return mesh;
+                }
+            }
+        }
+
+        return mIrr.getSceneManager()->getMesh( path.c_str() );
     }
 
     /**
@@ -82,23 +227,166 @@ namespace OpenNero
     */
     ITexture* IrrFactory::LoadTexture( const std::string& textureFile )
     {
+        std::string path = SimFactory::TransformPath(textureFile);
+
+        // prefer prefetched bytes over a synchronous disk read
+        AssetBytesPtr bytes = TakeAssetBytes(path);
+
+        // a baked mod bundle is the next cheapest source: the bytes are
+        // already in the mapping, with no file open and no copy
+        const char* bundleData = NULL;
+        size_t bundleSize = 0;
+        if( !bytes || bytes->empty() )
+            Kernel::instance().getMod()->FindResourceBytes( path, bundleData, bundleSize );
+
+        // the device-lifetime cache is keyed by content, so mods switched
+        // within one session (or sharing bytes under different names)
+        // reuse the texture without touching the disk or the decoder
+        const uint64_t contentHash = ( bytes && !bytes->empty() ) ?
+            ResourceCache::HashBytes( &(*bytes)[0], bytes->size() ) :
+            bundleData != NULL ?
+            ResourceCache::HashBytes( bundleData, bundleSize ) :
+            ResourceCache::HashFileContents( path );
+
+        ITexture* tex = ResourceCache::instance().FindTexture( contentHash );
+        if( tex )
+        {
+            LOG_D_MSG( "factory_resource_log", "Reused cached texture " << textureFile );
+            return tex;
+        }
+
+        if( bytes && !bytes->empty() )
+        {
+            irr::io::IReadFile* file = mIrr.getDevice()->getFileSystem()->createMemoryReadFile(
+                &(*bytes)[0], (s32)bytes->size(), path.c_str(), false );
+            if( file )
+            {
+                tex = mIrr.getVideoDriver()->getTexture( file );
+                file->drop();
+            }
+        }
+        else if( bundleData != NULL )
+        {
+            irr::io::IReadFile* file = mIrr.getDevice()->getFileSystem()->createMemoryReadFile(
+                (void*)bundleData, (s32)bundleSize, path.c_str(), false );
+            if( file )
+            {
+                tex = mIrr.getVideoDriver()->getTexture( file );
+                file->drop();
+            }
+        }
+
         // load the texture
-        ITexture* tex = mIrr.getVideoDriver()->getTexture( SimFactory::TransformPath(textureFile).c_str() );
+        if( !tex )
+        {
+            tex = mIrr.getVideoDriver()->getTexture( path.c_str() );
+        }
 
         if( tex )
         {
+            ResourceCache::instance().StoreTexture( contentHash, tex );
             LOG_D_MSG( "factory_resource_log", "Loaded texture " << textureFile );
         }
 
         return tex;
     }
 
-    IAnimatedMeshSceneNode* IrrFactory::addAnimatedMeshSceneNode( IAnimatedMesh* mesh )
+    void IrrFactory::PrefetchAssetFile( const std::string& fileName )
+    {
+        std::string path = SimFactory::TransformPath(fileName);
+
+        { // reserve the cache slot so the file is only read once
+            std::lock_guard<std::mutex> guard(mAssetMutex);
+            if( mAssetBytes.find(path) != mAssetBytes.end() )
+                return;
+            mAssetBytes[path] = AssetBytesPtr();
+        }
+
+        if( !mLoaderPool )
+        {
+            // a single worker keeps the reads sequential on spinning disks
+            mLoaderPool.reset( new TaskPool(1) );
+        }
+        mLoaderPool->Submit( boost::bind( &IrrFactory::ReadAssetFile, this, path ) );
+    }
+
+    void IrrFactory::ReadAssetFile( std::string path )
+    {
+        // plain file I/O only - Irrlicht resources must be created on the
+        // sim thread, so the worker just gets the bytes into memory
+        AssetBytesPtr bytes( new std::vector<irr::c8>() );
+        std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+        if( in )
+        {
+            in.seekg( 0, std::ios::end );
+            std::streampos size = in.tellg();
+            in.seekg( 0, std::ios::beg );
+            if( size > 0 )
+            {
+                bytes->resize( (size_t)size );
+                in.read( &(*bytes)[0], size );
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(mAssetMutex);
+        mAssetBytes[path] = bytes;
+    }
+
+    IrrFactory::AssetBytesPtr IrrFactory::TakeAssetBytes( const std::string& path )
+    {
+        std::lock_guard<std::mutex> guard(mAssetMutex);
+        AssetByteCache::iterator itr = mAssetBytes.find(path);
+        if( itr == mAssetBytes.end() || !itr->second )
+            return AssetBytesPtr();
+        // one-shot: Irrlicht caches the built resource from here on
+        AssetBytesPtr bytes = itr->second;
+        mAssetBytes.erase(itr);
+        return bytes;
+    }
+
+    IAnimatedMeshSceneNode* IrrFactory::addAnimatedMeshSceneNode( IAnimatedMesh* mesh, bool staticGeometry )
     {
         Assert( mesh );
+        if( staticGeometry )
+        {
+            // immutable geometry: upload the buffers to the GPU once and
+            // keep them there, instead of re-sending them every frame
+            mesh->setHardwareMappingHint( EHM_STATIC );
+        }
         return mIrr.getSceneManager()->addAnimatedMeshSceneNode( mesh );
     }
 
+    ISceneNode* IrrFactory::addInstancedMeshSceneNode( IAnimatedMesh* mesh )
+    {
+        Assert( mesh );
+
+        InstancedBatchMap::iterator itr = mInstancedBatches.find(mesh);
+        if( itr == mInstancedBatches.end() )
+        {
+            ISceneManager* manager = mIrr.getSceneManager();
+            // the shared batch mesh is static by construction (only
+            // single-frame meshes get instanced), so pin its buffers in
+            // video memory
+            mesh->getMesh(0)->setHardwareMappingHint( EHM_STATIC );
+            InstancedMeshSceneNode* batch =
+                new InstancedMeshSceneNode( manager->getRootSceneNode(), manager, mesh->getMesh(0) );
+            batch->drop(); // the root scene node keeps the only reference
+            itr = mInstancedBatches.insert( std::make_pair( mesh, batch ) ).first;
+            LOG_D_MSG( "factory_resource_log", "Created instanced batch for shared mesh" );
+        }
+
+        return itr->second->addInstance();
+    }
+
+    void IrrFactory::SetInstanceColor( ISceneNode* node, const SColor& color )
+    {
+        InstanceSceneNode* instance = dynamic_cast<InstanceSceneNode*>(node);
+        if( instance )
+        {
+            instance->setColor(color);
+        }
+    }
+
     ISceneNode* IrrFactory::addAxes()
     {
         AxesSceneNode* scene = new AxesSceneNode(mIrr.getSceneManager()->getRootSceneNode(), mIrr.getSceneManager(), -1);
@@ -109,9 +397,27 @@ namespace OpenNero
     }
 
 
-    ITerrainSceneNode* IrrFactory::addTerrainSceneNode( const std::string& heightmap )
+    ITerrainSceneNode* IrrFactory::addTerrainSceneNode( const std::string& heightmap, S32 maxLOD, S32 patchSize )
     {
-        return mIrr.getSceneManager()->addTerrainSceneNode( SimFactory::TransformPath(heightmap).c_str() );
+        E_TERRAIN_PATCH_SIZE tps;
+        switch( patchSize )
+        {
+        case 9:   tps = ETPS_9;   break;
+        case 17:  tps = ETPS_17;  break;
+        case 33:  tps = ETPS_33;  break;
+        case 65:  tps = ETPS_65;  break;
+        case 129: tps = ETPS_129; break;
+        default:
+            LOG_F_WARNING( "render", "invalid terrain patch size " << patchSize << ", using 17" );
+            tps = ETPS_17;
+            break;
+        }
+        return mIrr.getSceneManager()->addTerrainSceneNode(
+            SimFactory::TransformPath(heightmap).c_str(),
+            NULL, -1,
+            vector3df(0,0,0), vector3df(0,0,0), vector3df(1,1,1),
+            SColor(255,255,255,255),
+            maxLOD, tps );
     }
 
     IParticleSystemSceneNode* IrrFactory::addParticleSystemNode( const std::string& particleSystemFile )
@@ -261,20 +567,39 @@ namespace OpenNero
             return itr->second;
         }
 
-        // create the callback (dont delete, irrlicht will manage it for us)
-        ShaderCallback* cb = new ShaderCallback(mIrr);
-
         // convert the files to mod paths
         std::string modVertFile = SimFactory::TransformPath(vertFile);
         std::string modFragFile = SimFactory::TransformPath(fragFile);
 
+        // programs compiled by retired factories survive in the
+        // device-lifetime cache, keyed by the hash of both sources
+        const uint64_t vertHash = ResourceCache::HashFileContents( modVertFile );
+        const uint64_t fragHash = ResourceCache::HashFileContents( modFragFile );
+        uint64_t contentHash = 0;
+        if( vertHash != 0 && fragHash != 0 )
+        {
+            const uint64_t pairHash[2] = { vertHash, fragHash };
+            contentHash = ResourceCache::HashBytes( pairHash, sizeof(pairHash) );
+        }
+
+        int32_t shader = -1;
+        if( contentHash != 0 && ResourceCache::instance().FindShader( contentHash, shader ) )
+        {
+            mShaderCache[lookupName] = shader;
+            return shader;
+        }
+
+        // create the callback (dont delete, irrlicht will manage it for us)
+        ShaderCallback* cb = new ShaderCallback(mIrr);
+
         // attempt to create the shader
-        int32_t shader = createGlslShader( mIrr, cb, modVertFile, "main", modFragFile, "main", EMT_SOLID );
+        shader = createGlslShader( mIrr, cb, modVertFile, "main", modFragFile, "main", EMT_SOLID );
 
         // if the load succeeded, cache it for future calls
         if( shader >= 0 )
         {
             mShaderCache[lookupName] = shader;
+            ResourceCache::instance().StoreShader( contentHash, shader );
         }
 
         return shader;
@@ -321,9 +646,9 @@ namespace OpenNero
                 XMeshBuffer.Indices[i] = u[i];
             }
             // Default Position, Rotation and Scale
-            this->setPosition(core::vector3df(0,0,0));
-            this->setRotation(core::vector3df(0,0,0));
-            this->setScale(core::vector3df(1,1,1));
+            this->setPosition(irr::core::vector3df(0,0,0));
+            this->setRotation(irr::core::vector3df(0,0,0));
+            this->setScale(irr::core::vector3df(1,1,1));
             // Axes Box Coordinates Settings
             setAxesCoordinates();
         }
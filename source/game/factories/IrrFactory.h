@@ -8,9 +8,15 @@
 
 #include "core/IrrUtil.h"
 #include "core/Common.h"
+#include "core/HashMap.h"
+
+#include <mutex>
+#include <vector>
 
 namespace OpenNero
 {
+    class TaskPool;
+
     using namespace irr;
     using namespace irr::core;
     using namespace irr::scene;
@@ -22,6 +28,8 @@ namespace OpenNero
         BOOST_SHARED_DECL(ILogConnection);
     }
 
+    class InstancedMeshSceneNode;
+
     /// Loads resources from Irrlicht
     class IrrFactory
     {
@@ -32,12 +40,30 @@ namespace OpenNero
 
         /// load a model in some fasion (caller will need to cast to format that is expected)
         IAnimatedMesh* LoadAniMesh( const std::string& meshFile );
-        
+
         /// load a texture
         ITexture* LoadTexture( const std::string& textureFile );
 
         /// load an animated scene node from a mesh
-        IAnimatedMeshSceneNode* addAnimatedMeshSceneNode( IAnimatedMesh* mesh );
+        /// @param mesh the mesh to build the node from
+        /// @param staticGeometry the mesh's buffers never change, so the
+        ///        driver can keep them resident in video memory instead of
+        ///        re-uploading the vertices every frame
+        IAnimatedMeshSceneNode* addAnimatedMeshSceneNode( IAnimatedMesh* mesh, bool staticGeometry = false );
+
+        /// add an instance of a shared static mesh, batching all instances of
+        /// the same mesh into one scene node with per-instance transform and
+        /// color; returns a proxy node the caller positions like any other
+        ISceneNode* addInstancedMeshSceneNode( IAnimatedMesh* mesh );
+
+        /// set the per-instance color of a proxy node returned by
+        /// addInstancedMeshSceneNode (no-op for any other node)
+        static void SetInstanceColor( ISceneNode* node, const SColor& color );
+
+        /// read an asset file into memory on a background thread, so that the
+        /// first LoadAniMesh/LoadTexture for it builds the resource from the
+        /// prefetched bytes instead of hitting the disk on the sim thread
+        void PrefetchAssetFile( const std::string& fileName );
 
         /// add a visible axis to the world
         ISceneNode* addAxes();
@@ -51,7 +77,11 @@ namespace OpenNero
         );
 
         /// create a terrain scene node from a heightmap
-        ITerrainSceneNode* addTerrainSceneNode(const std::string& heightmap );
+        /// @param heightmap the heightmap image to build the terrain from
+        /// @param maxLOD number of geomipmap detail levels to generate
+        /// @param patchSize size of each geomipmap patch (9, 17, 33, 65 or 129)
+        ITerrainSceneNode* addTerrainSceneNode(const std::string& heightmap,
+                                               S32 maxLOD = 5, S32 patchSize = 17 );
 
         // add a particle system from an xml file
         IParticleSystemSceneNode* addParticleSystemNode( const std::string& particleSystemFile );
@@ -68,10 +98,25 @@ namespace OpenNero
     private:
 
         typedef std::map< std::string, int32_t > ShaderMap;
+        typedef std::map< IAnimatedMesh*, InstancedMeshSceneNode* > InstancedBatchMap;
+
+        /// raw file bytes prefetched by the background loader, by full path
+        typedef boost::shared_ptr< std::vector<irr::c8> > AssetBytesPtr;
+        typedef hash_map< std::string, AssetBytesPtr > AssetByteCache;
 
     private:
 
+        /// runs on the loader thread: read the file's bytes into the cache
+        void ReadAssetFile( std::string path );
+
+        /// claim the prefetched bytes for a path, if the loader finished them
+        AssetBytesPtr TakeAssetBytes( const std::string& path );
+
         ShaderMap mShaderCache;                     ///< A Cache of all the shaders we have loaded
+        InstancedBatchMap mInstancedBatches;        ///< one batched scene node per shared static mesh
+        AssetByteCache mAssetBytes;                 ///< file bytes read ahead by the loader thread
+        std::mutex mAssetMutex;                     ///< guards the asset byte cache
+        boost::shared_ptr<TaskPool> mLoaderPool;    ///< single background loader thread (created on demand)
         IrrHandles mIrr;                           ///< Handles to do Irr Specific loads
     };
 
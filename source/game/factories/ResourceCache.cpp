@@ -0,0 +1,174 @@
+//--------------------------------------------------------
+// OpenNero : ResourceCache
+//  device-lifetime texture and shader cache
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include <irrlicht.h>
+
+#include "game/factories/ResourceCache.h"
+
+#include <fstream>
+#include <vector>
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// FNV-1a 64-bit offset basis and prime
+        const uint64_t kFnvOffset = 14695981039346656037ULL;
+        const uint64_t kFnvPrime  = 1099511628211ULL;
+
+        /// default texture budget enforced at mod switches (bytes)
+        const size_t kDefaultTextureBudget = 256 * 1024 * 1024;
+
+        /// approximate video memory held by a texture
+        size_t EstimateTextureBytes( ITexture* texture )
+        {
+            const core::dimension2d<u32>& size = texture->getSize();
+            return (size_t)texture->getPitch() * size.Height;
+        }
+    }
+
+    ResourceCache& ResourceCache::instance()
+    {
+        static ResourceCache cache;
+        return cache;
+    }
+
+    ResourceCache::ResourceCache()
+        : mTextureBytes(0)
+        , mTextureBudget(kDefaultTextureBudget)
+        , mLruClock(0)
+        , mEpoch(0)
+    {}
+
+    uint64_t ResourceCache::HashBytes( const void* data, size_t size )
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = kFnvOffset;
+        for( size_t i = 0; i < size; ++i )
+        {
+            hash ^= bytes[i];
+            hash *= kFnvPrime;
+        }
+        return hash;
+    }
+
+    uint64_t ResourceCache::HashFileContents( const std::string& path )
+    {
+        std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+        if( !in )
+            return 0;
+
+        char buffer[4096];
+        uint64_t hash = kFnvOffset;
+        while( in.read( buffer, sizeof(buffer) ) || in.gcount() > 0 )
+        {
+            const std::streamsize got = in.gcount();
+            for( std::streamsize i = 0; i < got; ++i )
+            {
+                hash ^= (unsigned char)buffer[i];
+                hash *= kFnvPrime;
+            }
+        }
+        return hash;
+    }
+
+    ITexture* ResourceCache::FindTexture( uint64_t contentHash )
+    {
+        TextureMap::iterator itr = mTextures.find(contentHash);
+        if( itr == mTextures.end() )
+            return NULL;
+
+        itr->second.lastUse = ++mLruClock;
+        itr->second.epoch = mEpoch;
+        return itr->second.texture;
+    }
+
+    void ResourceCache::StoreTexture( uint64_t contentHash, ITexture* texture )
+    {
+        if( !texture || contentHash == 0 )
+            return;
+
+        TextureEntry entry;
+        entry.texture = texture;
+        entry.bytes = EstimateTextureBytes(texture);
+        entry.lastUse = ++mLruClock;
+        entry.epoch = mEpoch;
+
+        std::pair<TextureMap::iterator, bool> put =
+            mTextures.insert( std::make_pair( contentHash, entry ) );
+        if( put.second )
+        {
+            mTextureBytes += entry.bytes;
+        }
+        else
+        {
+            // same content loaded again (e.g. under another path); just
+            // refresh the bookkeeping of the existing entry
+            put.first->second.lastUse = entry.lastUse;
+            put.first->second.epoch = mEpoch;
+        }
+    }
+
+    bool ResourceCache::FindShader( uint64_t contentHash, int32_t& outShader )
+    {
+        ShaderProgramMap::const_iterator itr = mShaders.find(contentHash);
+        if( itr == mShaders.end() )
+            return false;
+
+        outShader = itr->second;
+        return true;
+    }
+
+    void ResourceCache::StoreShader( uint64_t contentHash, int32_t shader )
+    {
+        if( contentHash == 0 )
+            return;
+
+        mShaders[contentHash] = shader;
+    }
+
+    void ResourceCache::BeginEpoch( IVideoDriver* driver )
+    {
+        ++mEpoch;
+
+        // the outgoing context has been flushed, so textures not touched in
+        // the new epoch are unreferenced and safe to drop; evict oldest
+        // first until we are back under budget
+        while( mTextureBytes > mTextureBudget )
+        {
+            TextureMap::iterator victim = mTextures.end();
+            TextureMap::iterator itr = mTextures.begin();
+            TextureMap::iterator end = mTextures.end();
+            for( ; itr != end; ++itr )
+            {
+                if( itr->second.epoch == mEpoch )
+                    continue;
+                if( victim == mTextures.end() ||
+                    itr->second.lastUse < victim->second.lastUse )
+                {
+                    victim = itr;
+                }
+            }
+
+            // everything left is in use by the incoming mod
+            if( victim == mTextures.end() )
+                break;
+
+            LOG_D_MSG( "factory_resource_log", "Evicting cached texture ("
+                       << victim->second.bytes << " bytes)" );
+            mTextureBytes -= victim->second.bytes;
+            if( driver )
+                driver->removeTexture( victim->second.texture );
+            mTextures.erase( victim );
+        }
+    }
+
+    void ResourceCache::SetTextureBudget( size_t bytes )
+    {
+        mTextureBudget = bytes;
+    }
+
+} //end OpenNero
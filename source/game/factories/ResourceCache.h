@@ -0,0 +1,100 @@
+//--------------------------------------------------------
+// OpenNero : ResourceCache
+//  device-lifetime texture and shader cache
+//--------------------------------------------------------
+
+#ifndef _GAME_FACTORIES_RESOURCECACHE_H
+#define _GAME_FACTORIES_RESOURCECACHE_H
+
+#include "core/Common.h"
+#include "core/IrrUtil.h"
+
+#include <map>
+
+namespace OpenNero
+{
+    using namespace irr;
+    using namespace irr::video;
+
+    /**
+     * A device-lifetime cache of loaded textures and compiled GLSL shader
+     * programs. IrrFactory instances die with their SimContext on every mod
+     * switch, so anything cached per-factory used to be rebuilt from disk
+     * when flipping between mods in one session. Entries here are keyed by
+     * the hash of the resource's file contents (so two mods sharing the
+     * same bytes under different paths share one entry, and an edited file
+     * is reloaded), live as long as the device, and are trimmed with LRU
+     * eviction at mod-switch boundaries, the only point where textures
+     * from retired mods are guaranteed unreferenced by scene nodes.
+     *
+     * Main thread only, like the factories it backs. Note that it is a
+     * singleton.
+     */
+    class ResourceCache
+    {
+    public:
+
+        /// singleton accessor
+        static ResourceCache& instance();
+
+        /// FNV-1a hash over a byte buffer
+        static uint64_t HashBytes( const void* data, size_t size );
+
+        /// FNV-1a hash over a file's contents (0 if the file is unreadable)
+        static uint64_t HashFileContents( const std::string& path );
+
+        /// look up a texture by content hash (touches the LRU clock)
+        /// @return the cached texture or NULL
+        ITexture* FindTexture( uint64_t contentHash );
+
+        /// remember a loaded texture under its content hash
+        void StoreTexture( uint64_t contentHash, ITexture* texture );
+
+        /// look up a compiled shader program by the combined content hash
+        /// of its sources
+        /// @return true and set outShader if cached
+        bool FindShader( uint64_t contentHash, int32_t& outShader );
+
+        /// remember a compiled shader program under its content hash
+        void StoreShader( uint64_t contentHash, int32_t shader );
+
+        /// Mark a mod-switch boundary: everything cached so far belongs to
+        /// retired mods until it is touched again, and textures over the
+        /// byte budget are evicted oldest-first through the driver.
+        void BeginEpoch( IVideoDriver* driver );
+
+        /// set the texture byte budget enforced at epoch boundaries
+        void SetTextureBudget( size_t bytes );
+
+    private:
+
+        ResourceCache();
+
+        /// what we keep per cached texture
+        struct TextureEntry
+        {
+            ITexture*   texture;    ///< the driver-owned texture
+            size_t      bytes;      ///< approximate video memory it holds
+            uint64_t    lastUse;    ///< LRU clock value of the last Find/Store
+            uint32_t    epoch;      ///< mod epoch of the last Find/Store
+        };
+
+        /// cached textures by content hash
+        typedef std::map< uint64_t, TextureEntry > TextureMap;
+
+        /// cached shader programs by content hash
+        typedef std::map< uint64_t, int32_t > ShaderProgramMap;
+
+    private:
+
+        TextureMap          mTextures;      ///< textures that survived their factory
+        ShaderProgramMap    mShaders;       ///< compiled programs that survived their factory
+        size_t              mTextureBytes;  ///< approximate total texture bytes cached
+        size_t              mTextureBudget; ///< byte budget enforced at epoch boundaries
+        uint64_t            mLruClock;      ///< bumped on every texture touch
+        uint32_t            mEpoch;         ///< bumped on every mod switch
+    };
+
+} //end OpenNero
+
+#endif // _GAME_FACTORIES_RESOURCECACHE_H
@@ -4,12 +4,161 @@
 //--------------------------------------------------------
 
 #include "core/Common.h"
+#include "core/File.h"
 #include "PropertyMap.h"
 #include "game/Kernel.h"
+#include "game/Mod.h"
 #include <boost/tokenizer.hpp>
+#include <mutex>
+#include <set>
 
 namespace OpenNero
 {
+	/**
+	 * The compiled form of a template xml chain. Every element reachable
+	 * through property-spec lookups is flattened into hash tables keyed by
+	 * the spec string, with the usual child-overrides-parent resolution
+	 * already applied. Once built, queries are single hash lookups and the
+	 * TinyXML DOM is never consulted again.
+	*/
+	struct CompiledTemplate
+	{
+		/// what we keep per resolved section (the most-child element wins)
+		struct SectionInfo
+		{
+			/// does the resolving element carry inner text?
+			bool						hasText;
+
+			/// attributes of the resolving element
+			PropertyMap::AttributeMap	attributes;
+
+			SectionInfo() : hasText(false) {}
+		};
+
+		/// per-spec section info for hasSection/hasValue/attribute queries
+		typedef hash_map< std::string, SectionInfo >	SectionTable;
+
+		/// per-spec text value (entry present iff some doc in the chain has text)
+		typedef hash_map< std::string, std::string >	TextTable;
+
+		/// per-spec flattened direct children, merged across the chain
+		/// (kept in a std::map so getPropChildren stays alphabetical)
+		typedef std::map< std::string, std::string >	ChildMap;
+		typedef hash_map< std::string, ChildMap >		ChildTable;
+
+		SectionTable	sections;
+		TextTable		text;
+		ChildTable		children;
+	};
+
+	namespace
+	{
+		/// mutable handle used only while compiling
+		typedef boost::shared_ptr<CompiledTemplate> CompiledTemplatePtr;
+
+		/// compiled templates shared process-wide, keyed by the xml path the
+		/// map was constructed from. Round-start mass spawns (and re-loads
+		/// after a context flush) hit this table instead of the parser.
+		typedef hash_map< std::string, CompiledTemplateCPtr > TemplateRepository;
+		TemplateRepository	template_repository;
+		std::mutex			template_repository_mutex;
+
+		/**
+		 * Flatten one element (and its spec-reachable descendants) into the
+		 * compiled tables. Docs are processed from most ancestral to most
+		 * child, so a plain overwrite gives the child-overrides-parent
+		 * resolution the chain walk used to perform.
+		 * @param elem the element to flatten
+		 * @param spec the property spec that resolves to this element
+		 * @param out the compiled template being built
+		*/
+		void compileElement( const TiXmlElement* elem, const std::string& spec, CompiledTemplate& out )
+		{
+			Assert( elem );
+
+			// the most-child doc that has this section decides text presence
+			// and the attribute set outright
+			CompiledTemplate::SectionInfo& info = out.sections[spec];
+			info.hasText = ( elem->GetText() != NULL );
+			info.attributes.clear();
+
+			const TiXmlAttribute* att = elem->FirstAttribute();
+			while( att )
+			{
+				AssertWarnMsg( att->Name()  != NULL, "Invalid attribute name when compiling " << spec );
+				AssertWarnMsg( att->Value() != NULL, "Invalid attribute value when compiling " << spec );
+
+				if( att->Name() && att->Value() )
+				{
+					info.attributes[ att->Name() ] = att->Value();
+				}
+
+				att = att->Next();
+			}
+
+			// text values fall through to an ancestor if this doc has none
+			if( elem->GetText() )
+			{
+				out.text[spec] = elem->GetText();
+			}
+
+			// flatten the direct children that carry text; props are merged
+			// across the chain with the child doc winning ties
+			CompiledTemplate::ChildMap& childMap = out.children[spec];
+
+			const TiXmlElement* child = elem->FirstChildElement();
+			while( child )
+			{
+				Assert( child->Value() );
+
+				if( child->GetText() )
+				{
+					childMap[ child->Value() ] = child->GetText();
+				}
+
+				child = child->NextSiblingElement();
+			}
+
+			// recurse into the first element of each distinct name; later
+			// duplicates were never reachable through spec lookups
+			std::set< std::string > seen;
+
+			child = elem->FirstChildElement();
+			while( child )
+			{
+				std::string name = child->Value();
+				if( seen.insert(name).second )
+				{
+					compileElement( child, spec + "." + name, out );
+				}
+
+				child = child->NextSiblingElement();
+			}
+		}
+
+		/**
+		 * Flatten every top level element of a document into the compiled tables
+		 * @param doc the document to flatten
+		 * @param out the compiled template being built
+		*/
+		void compileDocument( const TiXmlDocument& doc, CompiledTemplate& out )
+		{
+			std::set< std::string > seen;
+
+			const TiXmlElement* elem = doc.FirstChildElement();
+			while( elem )
+			{
+				std::string name = elem->Value();
+				if( seen.insert(name).second )
+				{
+					compileElement( elem, name, out );
+				}
+
+				elem = elem->NextSiblingElement();
+			}
+		}
+	}
+
 	/// default do nothing constructor
 	PropertyMap::PropertyMap() {}
 
@@ -22,34 +171,50 @@ namespace OpenNero
 	{
 		if( !constructPropertyMap( xmlFile ) )
 		{
-			mXmlChain.clear();
 			AssertMsg( !isValidState(), "Logic Error, should be invalid" );
 		}
 	}
 
 	/**
-	 * Gets the state of the property map. Returns true if we have any xml documents loaded
-	 * @return true if we have a valid xml document chain
+	 * Gets the state of the property map. Returns true if we have a compiled template
+	 * @return true if we have a compiled template to query
 	*/
 	bool PropertyMap::isValidState() const
 	{
-		return mXmlChain.size() != 0;
+		return mCompiled.get() != NULL;
 	}
 
 	/**
-	 * Construct a property map from an xml file
+	 * Construct a property map from an xml file. If the file was compiled
+	 * before (by any PropertyMap in this process), the compiled form is
+	 * shared and no xml parsing happens at all; otherwise the chain is
+	 * parsed once, flattened, and published for everyone else.
 	 * @param xmlFile the path to the xml file. This should be the mod path,
 	 *				  we will not add the mod directory to it. We will, however, add the mod
 	 *				  path to any file it 'Uses'
 	 * @return true if we constructed the property map successfully
-	*/	
+	*/
 	bool PropertyMap::constructPropertyMap( const std::string& xmlFile )
 	{
-		// clear the old map
+		// clear the old compiled state
+		mCompiled.reset();
 		mXmlChain.clear();
 		Assert( !isValidState() );
 
-		// make our new valid
+		// templates are immutable for the life of the process, so a file
+		// only ever needs to be compiled once
+		{
+			std::lock_guard<std::mutex> repo_guard(template_repository_mutex);
+
+			TemplateRepository::const_iterator needle = template_repository.find(xmlFile);
+			if( needle != template_repository.end() )
+			{
+				mCompiled = needle->second;
+				return true;
+			}
+		}
+
+		// first time through; parse the chain the old way
 		if( !parseXmlFile( xmlFile ) )
 		{
 			mXmlChain.clear();
@@ -57,13 +222,34 @@ namespace OpenNero
 			return false;
 		}
 
+		// flatten the chain from most ancestral to most child so that the
+		// child docs override their parents, then drop the DOM
+		CompiledTemplatePtr compiled( new CompiledTemplate );
+
+		XmlDocChain::const_reverse_iterator ritr = mXmlChain.rbegin();
+		XmlDocChain::const_reverse_iterator rend = mXmlChain.rend();
+
+		for( ; ritr != rend; ++ritr )
+		{
+			compileDocument( *ritr, *compiled );
+		}
+
+		mXmlChain.clear();
+		mCompiled = compiled;
+
+		// publish for every later load of this file
+		{
+			std::lock_guard<std::mutex> repo_guard(template_repository_mutex);
+			template_repository[xmlFile] = mCompiled;
+		}
+
 		// all good
 		return true;
 	}
 
 	/**
 	 * Get all the children of a given spec. In other words, perform a wildcard query for all
-	 * children (spec.*) and return the results in a vector of <props,values>. 
+	 * children (spec.*) and return the results in a vector of <props,values>.
 	 *
 	 * NOTE: THIS WILL RETURN THE PROPS IN ALPHABETICAL ORDER, NOT XML ORDER! The reason
 	 * for this is that properties can be spread out among multiple files due to the 'Uses'
@@ -79,7 +265,7 @@ namespace OpenNero
 	 *   </Test>
 	 *	foo2.xml
 	 *   <Test>
-	 *		<Uses>foo1.xml</Test>	 
+	 *		<Uses>foo1.xml</Test>
 	 *		<C>CC</C>
 	 *		<A>AA</B>
 	 *   </Test>
@@ -92,46 +278,22 @@ namespace OpenNero
 	*/
 	void PropertyMap::getPropChildren( ChildPropVector& outVec, const std::string& propertySpec ) const
 	{
-		// make a map to store our property -> value map
-		typedef std::map< std::string, std::string > PropSpecChildMap;
-		PropSpecChildMap propSpecChildMap;
-		
-		XmlDocChain::const_reverse_iterator ritr = mXmlChain.rbegin();
-		XmlDocChain::const_reverse_iterator rend = mXmlChain.rend();		
-
-		// iterator through all documents, starting with oldest
-		for( ; ritr != rend; ++ritr )
-		{
-			const TiXmlElement* elem = hasSection_internal( *ritr, propertySpec );
-			if( elem )
-			{
-				const TiXmlElement* child = elem->FirstChildElement();
-				while( child )
-				{
-					// add this property to our map
-                    Assert( child->Value() );                    
-					std::string prop = child->Value();
-
-                    if( child->GetText() )
-                    {   
-					    propSpecChildMap[prop] = child->GetText();
-                    }
+		outVec.clear();
 
-					child = child->NextSiblingElement();
-				}
-			}
-		}
+		Assert( isValidState() );
 
-		// now flatten the map
-		outVec.clear();
+		// the chain was already merged at compile time; just flatten the map
+		CompiledTemplate::ChildTable::const_iterator needle = mCompiled->children.find(propertySpec);
+		if( needle == mCompiled->children.end() )
+			return;
 
-		PropSpecChildMap::const_iterator itr = propSpecChildMap.begin();
-		PropSpecChildMap::const_iterator end = propSpecChildMap.end();
+		CompiledTemplate::ChildMap::const_iterator itr = needle->second.begin();
+		CompiledTemplate::ChildMap::const_iterator end = needle->second.end();
 
 		for( ; itr != end; ++itr )
 		{
 			outVec.push_back( PropValPair( itr->first, itr->second ) );
-		}		
+		}
 	}
 
 	/**
@@ -166,39 +328,21 @@ namespace OpenNero
 
 
     /**
-     * Get all the attributes associated with a property spec     
+     * Get all the attributes associated with a property spec
      * @param propertySpec the spec to search for attributes in
      * @return a map of the attributes for the property spec
     */
     PropertyMap::AttributeMap PropertyMap::getAttributes( const std::string& propertySpec ) const
     {
-        // clear the old vector
-        AttributeMap attMap;        
-
-        // iterate through our xml documents, child to parent looking for the value
-        const TiXmlElement* elem = xmlChainHasSection(propertySpec);
+        Assert( isValidState() );
 
-        if( elem )
+        CompiledTemplate::SectionTable::const_iterator needle = mCompiled->sections.find(propertySpec);
+        if( needle != mCompiled->sections.end() )
         {
-            const TiXmlAttribute* att = elem->FirstAttribute();
-            
-            while( att )
-            {
-                AssertWarnMsg( att->Name()  != NULL, "Invalid attribute name when looking at " << propertySpec );
-                AssertWarnMsg( att->Value() != NULL, "Invalid attribute value when looking at " << propertySpec );
-
-                // save the attribute
-                if( att->Name() && att->Value() )
-                {
-                    attMap[ att->Name() ] = att->Value();                    
-                }
-
-                // move
-                att = att->Next();
-            }
+            return needle->second.attributes;
         }
 
-        return attMap;
+        return AttributeMap();
     }
 
     /**
@@ -214,7 +358,7 @@ namespace OpenNero
 
         return "";
     }
-	
+
 	/**
 	 * Get the value at a property spec in string form
 	 * @param outString the output variable to store the string
@@ -225,22 +369,19 @@ namespace OpenNero
 	{
 		Assert( isValidState() );
 
-		// iterate through our xml documents, child to parent looking for the value
-		XmlDocChain::const_iterator itr = mXmlChain.begin();
-		XmlDocChain::const_iterator end = mXmlChain.end();		
-
-		for( ; itr != end; ++itr )
+		// the chain walk was done at compile time; one lookup resolves it
+		CompiledTemplate::TextTable::const_iterator needle = mCompiled->text.find(propertySpec);
+		if( needle != mCompiled->text.end() )
 		{
-			// try to find that spec in this document
-			if( getValueString( *itr, outString, propertySpec ) )
-				return true;
+			outString = needle->second;
+			return true;
 		}
 
 		// no luck
 		outString = "";
 		return false;
-	}	
-		
+	}
+
 	/**
 	 * Parse an xml file to build the property map. We add the parsed documents
 	 * to our xml chain in this method as well as recursing on all 'Uses' elements,
@@ -249,11 +390,57 @@ namespace OpenNero
 	 * @return true if we parsed the xml files successfully
 	*/
 	bool PropertyMap::parseXmlFile( const std::string& xmlFile )
+	{
+		// a baked mod bundle serves the template text straight from its
+		// mapping; otherwise open the file through a read-only view. The
+		// single newline-normalizing copy below replaces both the fread
+		// buffer and the normalized string that TiXmlDocument::LoadFile
+		// builds.
+		const char* data;
+		size_t size;
+		if( !Kernel::instance().getMod()->FindResourceBytes( xmlFile, data, size ) )
+		{
+			ReadOnlyFileView view( xmlFile );
+			if( !view.IsOpen() || view.Size() == 0 )
+				return false;
+			return parseXmlContents( view.Data(), view.Size() );
+		}
+		return parseXmlContents( data, size );
+	}
+
+	/// Parse template text already in memory, recursing on the 'Uses'
+	/// chain like parseXmlFile.
+	/// @param data first byte of the template text
+	/// @param size byte size of the text
+	/// @return true if we parsed the xml successfully
+	bool PropertyMap::parseXmlContents( const char* data, size_t size )
 	{
 		TiXmlDocument doc;
 
-		// open the file
-		if( !doc.LoadFile( xmlFile.c_str() ) )
+		if( size == 0 )
+			return false;
+
+		std::string contents;
+		contents.reserve( size );
+		const char* itr = data;
+		const char* end = itr + size;
+		for( ; itr != end; ++itr )
+		{
+			if( *itr == '\r' )
+			{
+				// normalize CR and CR-LF to a single newline
+				contents += '\n';
+				if( itr + 1 != end && *(itr + 1) == '\n' )
+					++itr;
+			}
+			else
+			{
+				contents += *itr;
+			}
+		}
+
+		doc.Parse( contents.c_str() );
+		if( doc.Error() )
 			return false;
 
 		// add ourselves to the chain
@@ -266,7 +453,7 @@ namespace OpenNero
 			// convert this to a mod path
 			useThis = Kernel::findResource( useThis );
 
-			// try to parse this xml file			
+			// try to parse this xml file
 			if( !parseXmlFile( useThis ) )
 				return false;
 		}
@@ -297,23 +484,25 @@ namespace OpenNero
 	}
 
 	/**
-	 * See if we have a given property spec in an xml document
+	 * See if we have a given property spec in an xml document. Only used
+	 * while compiling (to chase 'Uses' links); all user queries go through
+	 * the compiled tables.
 	 * @param doc the document to search in
 	 * @param section the property spec to search for in the doc
 	 * @return the TiXmlElement node that contains the section, NULL otherwise
 	*/
-	const TiXmlElement* PropertyMap::hasSection_internal( const TiXmlDocument& doc, const std::string& section ) const	
+	const TiXmlElement* PropertyMap::hasSection_internal( const TiXmlDocument& doc, const std::string& section ) const
 	{
-		// try to tokenize our section "x.y.z" by .
-		std::vector< std::string > props;
-		if( !tokenizePropertySpec( props, section ) )
+		// look up the interned token list for "x.y.z" (tokenized only once)
+		const std::vector< std::string >* props = internPropertySpec( section );
+		if( !props )
 			return NULL;
 
-		Assert( props.size() > 0 );
+		Assert( props->size() > 0 );
 
 		// iterate over all the tokens to make sure we have the sections
-		std::vector< std::string >::iterator itr = props.begin();
-		std::vector< std::string >::iterator end = props.end();
+		std::vector< std::string >::const_iterator itr = props->begin();
+		std::vector< std::string >::const_iterator end = props->end();
 
 		// get the template node
 		const TiXmlNode* node = doc.FirstChild( itr->c_str() );
@@ -329,7 +518,7 @@ namespace OpenNero
 		++itr;
 		if( itr == end )
 			return elem;
-		
+
 		// ok, now we can do normal iteration
 		for( ; itr != end; ++itr )
 		{
@@ -339,48 +528,21 @@ namespace OpenNero
 			elem = elem->FirstChildElement( itr->c_str() );
 			if( !elem )
 				return NULL;
-		}		
+		}
 
 		// good, we found everything
 		return elem;
 	}
 
-    /**
-     * Search the entire xml chain child to parent looking for a section
-     * @param section the property spec to search the chain for
-     * @return an xml element if the section is found, NULL otherwise
-    */
-    const TiXmlElement* PropertyMap::xmlChainHasSection( const std::string& section ) const
-    {
-        Assert( isValidState() );
-
-        // iterate through our xml documents, child to parent looking for the value
-		XmlDocChain::const_iterator itr = mXmlChain.begin();
-		XmlDocChain::const_iterator end = mXmlChain.end();		
-		
-		for( ; itr != end; ++itr )
-		{
-			// try to find it in this document
-			const TiXmlElement* elem = hasSection_internal( *itr, section );
-
-            if( elem )
-            {
-                return elem;
-            }
-		}
-
-        return NULL;
-    }
-	
 	/**
 	 * Tokenize a given property spec by splitting at '.' using boost::tokenizer
 	 * @param outProps the vector of strings to store the tokens in
 	 * @param propSpec the spec to split up
 	 * @return true if we have valid tokens
 	*/
-	bool PropertyMap::tokenizePropertySpec( std::vector< std::string >& outProps, const std::string& propSpec ) const
+	bool PropertyMap::tokenizePropertySpec( std::vector< std::string >& outProps, const std::string& propSpec )
 	{
-		// adapted from example @ http://www.boost.org/libs/tokenizer/char_separator.htm		
+		// adapted from example @ http://www.boost.org/libs/tokenizer/char_separator.htm
 		typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
 		boost::char_separator<char> sep(".");
 		tokenizer tokens( propSpec, sep );
@@ -397,6 +559,34 @@ namespace OpenNero
 		return outProps.size() != 0;
 	}
 
+	/**
+	 * Get the interned token list for a property spec. Every distinct spec
+	 * string is tokenized exactly once per process; all later queries for
+	 * the same spec (e.g. "Template.Render.*" across a spawning wave) share
+	 * the same token list.
+	 * @param propSpec the spec to intern
+	 * @return a pointer to the shared token list, or NULL for an empty spec
+	*/
+	const std::vector< std::string >* PropertyMap::internPropertySpec( const std::string& propSpec )
+	{
+		typedef hash_map< std::string, std::vector< std::string > > InternTable;
+		static InternTable intern_table;
+		static std::mutex intern_mutex;
+
+		std::lock_guard<std::mutex> intern_guard(intern_mutex);
+
+		InternTable::iterator itr = intern_table.find(propSpec);
+		if( itr == intern_table.end() )
+		{
+			std::vector< std::string > props;
+			if( !tokenizePropertySpec( props, propSpec ) )
+				return NULL;
+			itr = intern_table.insert( std::make_pair( propSpec, props ) ).first;
+		}
+
+		return &itr->second;
+	}
+
     /**
      * Perform a query on a property spec. By default always checks for existence.
      * @param checkValue if true, checks if the property spec element has an inner text value
@@ -407,11 +597,15 @@ namespace OpenNero
     {
         Assert( isValidState() );
 
-		// iterate through our xml documents, child to parent looking for the value
-        const TiXmlElement* elem = xmlChainHasSection(section);
-            
-        // do query checks on element
-        return  ( elem != NULL  ) && ( !checkValue || elem->GetText() ) &&  ( !checkAttributes || elem->FirstAttribute() );				
+        // a single lookup replaces the old child to parent chain walk
+        CompiledTemplate::SectionTable::const_iterator needle = mCompiled->sections.find(section);
+        if( needle == mCompiled->sections.end() )
+            return false;
+
+        const CompiledTemplate::SectionInfo& info = needle->second;
+
+        // do query checks on the compiled section
+        return ( !checkValue || info.hasText ) && ( !checkAttributes || !info.attributes.empty() );
     }
 
     /// Template specialization to turn the strings "trUe" (or any variation) into true or false
@@ -8,6 +8,7 @@
 
 #include "tinyxml.h"		// for Xml parsing
 #include "core/Common.h"
+#include "core/HashMap.h"
 #include "core/IrrUtil.h"
 #include "boost/lexical_cast.hpp"
 
@@ -15,6 +16,14 @@
 
 namespace OpenNero
 {
+	/// a template xml chain compiled into flat spec-keyed tables. Built once
+	/// per file and shared by every PropertyMap constructed from that file,
+	/// so spawn-time template loads never touch the xml DOM.
+	struct CompiledTemplate;
+
+	/// shared immutable handle to a compiled template
+	typedef boost::shared_ptr<const CompiledTemplate> CompiledTemplateCPtr;
+
 	/**
      * PropertyMap is a class that stores property values at given property
      * specs (paths) for xml files. A user can query these values by specifying
@@ -94,7 +103,10 @@ namespace OpenNero
 		bool getValueString( std::string& outString, const std::string& propertySpec ) const;
 
 		// parse an xml file to build a property map
-		bool parseXmlFile( const std::string& xmlFile );		
+		bool parseXmlFile( const std::string& xmlFile );
+
+		// parse template text already in memory (bundle or file view)
+		bool parseXmlContents( const char* data, size_t size );
 
 		// get a value string from a specific xml document
 		bool getValueString( const TiXmlDocument& doc, std::string& outString, const std::string& propertySpec ) const;
@@ -102,11 +114,12 @@ namespace OpenNero
 		// does a specific xml document have a given section?
 		const TiXmlElement* hasSection_internal( const TiXmlDocument& doc, const std::string& section ) const;
 
-        // does our xml document chain have a given section?
-        const TiXmlElement* xmlChainHasSection( const std::string& section ) const;
-
 		// tokenize a spec
-		bool tokenizePropertySpec( std::vector< std::string >& outProps, const std::string& propSpec ) const;
+		static bool tokenizePropertySpec( std::vector< std::string >& outProps, const std::string& propSpec );
+
+		// get the interned token list for a spec; identical spec strings are
+		// tokenized only once per process and share one token list
+		static const std::vector< std::string >* internPropertySpec( const std::string& propSpec );
 
         // performance a query on a property spec
         bool propertySpecQuery( const std::string& section, bool checkValue, bool checkAttributes ) const;
@@ -119,9 +132,13 @@ namespace OpenNero
 	private:
 
 		/// The xml document chain, stored from child to parent
-		/// (if A uses B uses C then stored A,B,C since C is most ancestral )
+		/// (if A uses B uses C then stored A,B,C since C is most ancestral ).
+		/// Only populated while compiling; cleared once mCompiled is built.
 		XmlDocChain					mXmlChain;
-	};	    
+
+		/// the compiled form of the chain that all queries read from
+		CompiledTemplateCPtr		mCompiled;
+	};
 
     /**
      * gets the string value at the property spec and then uses a special function
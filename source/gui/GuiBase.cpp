@@ -42,6 +42,9 @@ namespace OpenNero
 	{
 		Assert( mpGuiElement );
 		mpGuiElement->setVisible(visible);
+
+		if( mpManagerProxy )
+			mpManagerProxy->MarkGuiDirty();
 	}
 
     bool GuiBase::isVisible()
@@ -55,6 +58,9 @@ namespace OpenNero
 	{
 		Assert( mpGuiElement );
 		mpGuiElement->setEnabled(enabled);
+
+		if( mpManagerProxy )
+			mpManagerProxy->MarkGuiDirty();
 	}
 
     bool GuiBase::isEnabled()
@@ -124,6 +130,9 @@ namespace OpenNero
 	{
 		Assert( mpGuiElement );
 		mpGuiElement->addChild( child->mpGuiElement.get() );
+
+		if( mpManagerProxy )
+			mpManagerProxy->MarkGuiDirty();
 	}
 
 	// Set a textual identifier to register with ourselves
@@ -132,6 +141,9 @@ namespace OpenNero
 		Assert( mpGuiElement );
         mText = text;
         mpGuiElement->setText( mText.c_str() );
+
+        if( mpManagerProxy )
+            mpManagerProxy->MarkGuiDirty();
 	}
 
     void GuiBase::setText( const std::string& text )
@@ -170,6 +182,9 @@ namespace OpenNero
         Assert( mpGuiElement );
         mElementBounds = rect;
         mpGuiElement->setRelativePosition(rect);
+
+        if( mpManagerProxy )
+            mpManagerProxy->MarkGuiDirty();
     }
 
     void GuiBase::setRelativePosition( const Pos2i& pos )
@@ -177,6 +192,9 @@ namespace OpenNero
         Assert( mpGuiElement );
         mElementBounds.UpperLeftCorner = pos;
         mpGuiElement->setRelativePosition(mElementBounds);
+
+        if( mpManagerProxy )
+            mpManagerProxy->MarkGuiDirty();
     }
 
     Pos2i GuiBase::getRelativePosition()
@@ -189,6 +207,9 @@ namespace OpenNero
         Assert( mpGuiElement );
         mElementBounds.LowerRightCorner = mElementBounds.UpperLeftCorner + ext;
         mpGuiElement->setRelativePosition(mElementBounds);
+
+        if( mpManagerProxy )
+            mpManagerProxy->MarkGuiDirty();
     }
 
     Pos2i GuiBase::getExtent()
@@ -201,6 +222,9 @@ namespace OpenNero
 	{
 		Assert( mpGuiElement );
 		mpGuiElement->updateAbsolutePosition();
+
+		if( mpManagerProxy )
+			mpManagerProxy->MarkGuiDirty();
 	}
 
 	// Remove the gui piece from the scene and get rid of reference
@@ -210,6 +234,9 @@ namespace OpenNero
         {
             mpGuiElement->remove();
         }
+
+        if( mpManagerProxy )
+            mpManagerProxy->MarkGuiDirty();
     }
 
     void GuiBase::setGuiElement( IGuiElement_IPtr guiElement )
@@ -267,7 +294,7 @@ namespace OpenNero
     {
         Assert( mpGuiElement );
 
-        const core::rect<int32_t> absPos( mpGuiElement->getAbsolutePosition() );
+        const irr::core::rect<irr::s32> absPos( mpGuiElement->getAbsolutePosition() );
         return position2di( pos2D.X - absPos.UpperLeftCorner.X,
                             pos2D.Y - absPos.UpperLeftCorner.Y );
     }
@@ -314,7 +341,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseLeftDown  ( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseLeftDown) && !AttemptOverrideExecution( "OnMouseLeftDown" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseLeftDown) && !AttemptOverrideExecution( kResponse_OnMouseLeftDown ) )
             return Default_OnMouseLeftDown(/*event*/);
 
         return true;
@@ -322,14 +349,14 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseRightDown ( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseRightDown) && !AttemptOverrideExecution( "OnMouseRightDown" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseRightDown) && !AttemptOverrideExecution( kResponse_OnMouseRightDown ) )
             return Default_OnMouseRightDown(/*event*/);
 
         return true;
     }
     bool PyGuiBase::OnMouseMiddleDown( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseMiddleDown) && !AttemptOverrideExecution( "OnMouseMiddleDown" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseMiddleDown) && !AttemptOverrideExecution( kResponse_OnMouseMiddleDown ) )
             return Default_OnMouseMiddleDown(/*event*/);
 
         return true;
@@ -337,7 +364,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseLeftClick  ( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseLeftClick) && !AttemptOverrideExecution( "OnMouseLeftClick" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseLeftClick) && !AttemptOverrideExecution( kResponse_OnMouseLeftClick ) )
             return Default_OnMouseLeftClick(/*event*/);
 
         return true;
@@ -345,7 +372,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseRightClick ( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseRightClick) && !AttemptOverrideExecution( "OnMouseRightClick" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseRightClick) && !AttemptOverrideExecution( kResponse_OnMouseRightClick ) )
             return Default_OnMouseRightClick(/*event*/);
 
         return true;
@@ -353,7 +380,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseMiddleClick( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseMiddleClick) && !AttemptOverrideExecution( "OnMouseMiddleClick" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseMiddleClick) && !AttemptOverrideExecution( kResponse_OnMouseMiddleClick ) )
             return Default_OnMouseMiddleClick(/*event*/);
 
         return true;
@@ -361,7 +388,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseEnter( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseEnter) && !AttemptOverrideExecution( "OnMouseEnter" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseEnter) && !AttemptOverrideExecution( kResponse_OnMouseEnter ) )
             return Default_OnMouseEnter(/*event*/);
 
         return true;
@@ -369,7 +396,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseLeave( /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseLeave) && !AttemptOverrideExecution( "OnMouseLeave" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseLeave) && !AttemptOverrideExecution( kResponse_OnMouseLeave ) )
             return Default_OnMouseLeave(/*event*/);
 
         return true;
@@ -377,7 +404,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnMouseMove(  /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnMouseMove) && !AttemptOverrideExecution( "OnMouseMove" ) )
+        if( !AttemptPythonExecution(kResponse_OnMouseMove) && !AttemptOverrideExecution( kResponse_OnMouseMove ) )
             return Default_OnMouseMove(/*event*/);
 
         return true;
@@ -385,7 +412,7 @@ namespace OpenNero
 
     bool PyGuiBase::OnScrollBarChange(  /*const SEvent& event*/ )
     {
-        if( !AttemptPythonExecution(kResponse_OnScrollBarChange) && !AttemptOverrideExecution( "OnScrollBarChange" ) )
+        if( !AttemptPythonExecution(kResponse_OnScrollBarChange) && !AttemptOverrideExecution( kResponse_OnScrollBarChange ) )
             return Default_OnScrollBarChange(/*event*/);
 
         return true;
@@ -393,7 +420,7 @@ namespace OpenNero
     
     bool PyGuiBase::OnCheckBoxChange( /*const SEvent& event*/ )
     {
-        if (!AttemptPythonExecution(kResponse_OnCheckBoxChange) && !(AttemptOverrideExecution( "OnCheckBoxChange" )))
+        if (!AttemptPythonExecution(kResponse_OnCheckBoxChange) && !(AttemptOverrideExecution( kResponse_OnCheckBoxChange )))
             return Default_OnCheckBoxChange(/* event */);
         return true;
     }
@@ -409,26 +436,7 @@ namespace OpenNero
                 return true;
 
             // otherwise check for an override in a child python class
-            switch( flag )
-            {
-            case kResponse_OnMouseLeftDown:     return CheckForOverride("OnMouseLeftDown");
-            case kResponse_OnMouseRightDown:    return CheckForOverride("OnMouseRightDown");
-            case kResponse_OnMouseMiddleDown:   return CheckForOverride("OnMouseMiddleDown");
-
-            case kResponse_OnMouseLeftClick:    return CheckForOverride("OnMouseLeftClick");
-            case kResponse_OnMouseRightClick:   return CheckForOverride("OnMouseRightClick");
-            case kResponse_OnMouseMiddleClick:  return CheckForOverride("OnMouseMiddleClick");
-
-            case kResponse_OnMouseEnter:        return CheckForOverride("OnMouseEnter");
-            case kResponse_OnMouseLeave:        return CheckForOverride("OnMouseLeave");
-            case kResponse_OnMouseMove:         return CheckForOverride("OnMouseMove");
-
-            case kResponse_OnScrollBarChange:   return CheckForOverride("OnScrollBarChange");
-            
-            case kResponse_OnCheckBoxChange:    return CheckForOverride("OnCheckBoxChange");
-
-            default: Assert(false); return false;
-            }
+            return CheckForOverride(flag);
         }
 
         return false;
@@ -450,28 +458,64 @@ namespace OpenNero
     bool PyGuiBase::Default_OnScrollBarChange() { return false; }
     bool PyGuiBase::Default_OnCheckBoxChange() { return false; }
 
-    bool PyGuiBase::CheckForOverride( const std::string& overrideName ) const
-    {
-        return static_cast<bool>(this->get_override(overrideName.c_str()));
-    }
-
-    bool PyGuiBase::AttemptOverrideExecution( const std::string& overrideName )
-    {
-        using namespace boost::python;
-
-        // get the override object to execute
-        override func = this->get_override(overrideName.c_str());
-        if( func )
-        {
-            // attempt to execute the override
-            TryCall<override>(func);
-
-            // we found a valid override, return true
-            return true;
-        }
-
-        // did not find a valid override, return false
-        return false;
+    const char* PyGuiBase::ResponseMethodName( ResponseFlag flag )
+    {
+        switch( flag )
+        {
+        case kResponse_OnMouseLeftDown:     return "OnMouseLeftDown";
+        case kResponse_OnMouseRightDown:    return "OnMouseRightDown";
+        case kResponse_OnMouseMiddleDown:   return "OnMouseMiddleDown";
+
+        case kResponse_OnMouseLeftClick:    return "OnMouseLeftClick";
+        case kResponse_OnMouseRightClick:   return "OnMouseRightClick";
+        case kResponse_OnMouseMiddleClick:  return "OnMouseMiddleClick";
+
+        case kResponse_OnMouseEnter:        return "OnMouseEnter";
+        case kResponse_OnMouseLeave:        return "OnMouseLeave";
+        case kResponse_OnMouseMove:         return "OnMouseMove";
+
+        case kResponse_OnScrollBarChange:   return "OnScrollBarChange";
+
+        case kResponse_OnCheckBoxChange:    return "OnCheckBoxChange";
+
+        default: Assert(false); return "";
+        }
+    }
+
+    GuiBase::PyObject PyGuiBase::CachedOverride( ResponseFlag flag ) const
+    {
+        Assert( flag >= (ResponseFlag)0 && flag < kResponse_Max );
+
+        // resolve the override once; python method lookup walks the class
+        // dictionaries and we do not want that walk on every event
+        if( !mOverrideCached[flag] )
+        {
+            mOverrideCache[flag] = this->get_override( ResponseMethodName(flag) );
+            mOverrideCached[flag] = true;
+        }
+        return mOverrideCache[flag];
+    }
+
+    bool PyGuiBase::CheckForOverride( ResponseFlag flag ) const
+    {
+        return CachedOverride(flag).ptr() != Py_None;
+    }
+
+    bool PyGuiBase::AttemptOverrideExecution( ResponseFlag flag )
+    {
+        // get the cached override object to execute
+        PyObject func = CachedOverride(flag);
+        if( func.ptr() != Py_None )
+        {
+            // attempt to execute the override
+            TryCall<PyObject>(func);
+
+            // we found a valid override, return true
+            return true;
+        }
+
+        // did not find a valid override, return false
+        return false;
     }
 
     bool PyGuiBase::AttemptPythonExecution( ResponseFlag flag )
@@ -308,6 +308,8 @@ namespace OpenNero
     {
     public:
 
+        PyGuiBase();
+
         /** @name Python Event Handlers
          * The following methods check for the existence of
          * an overriden python method that responds to these events.
@@ -378,22 +380,40 @@ namespace OpenNero
 
     private:
 
-        /// Check to see if a python override for the given over name exists
-        /// @param overrideName the name of the override method to check for
+        /// the python method name that handles the given response type
+        /// @param flag the response type
+        /// @return the handler method name as a string literal
+        static const char* ResponseMethodName( ResponseFlag flag );
+
+        /// The python override that handles the given response type, looked
+        /// up once per element and response type and cached. Python method
+        /// resolution is a dictionary walk we do not want on every event;
+        /// redefining a handler on a live instance is not supported.
+        /// @param flag the response type
+        /// @return the cached override (None when the subclass has none)
+        boost::python::object CachedOverride( ResponseFlag flag ) const;
+
+        /// Check to see if a python override for the given response type exists
+        /// @param flag the response type to check for
         /// @return true if we found the override python method
-        bool CheckForOverride( const std::string& overrideName ) const;
+        bool CheckForOverride( ResponseFlag flag ) const;
 
-        /// Attempt to execute a python override that goes by the provided name.
+        /// Attempt to execute the python override for the response type.
         /// If the override does not exist, bail and return false.
-        /// @param overrideName the name of the override method to search for and execute
+        /// @param flag the response type to execute
         /// @return true if the override exists, false otherwise
-        bool AttemptOverrideExecution( const std::string& overrideName );
+        bool AttemptOverrideExecution( ResponseFlag flag );
 
         /// Attempt to execute a python response function. This method will both
         /// check for the existence of the function and execute it
         /// @param flag flag representing the response function to test
         /// @return true if we executed a python response function
         bool AttemptPythonExecution( ResponseFlag flag );
+
+    private:
+
+        mutable PyObject mOverrideCache[kResponse_Max]; ///< cached python overrides
+        mutable bool mOverrideCached[kResponse_Max];    ///< which cache slots are resolved
     };
 }
 
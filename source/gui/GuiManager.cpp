@@ -258,6 +258,11 @@ namespace OpenNero
         }
     }
 
+    void GuiManagerProxy::MarkGuiDirty()
+    {
+        mGuiManagerInst.MarkDirty();
+    }
+
 
 
     /// The unique counter
@@ -266,9 +271,11 @@ namespace OpenNero
     /// Ctor
     /// @param handles the irrlicht handles to use
     /// @param simFac the sim factory to use for loading
-    GuiManager::GuiManager( const IrrHandles& handles, SimFactoryPtr simFac ) 
+    GuiManager::GuiManager( const IrrHandles& handles, SimFactoryPtr simFac )
         : mIrr(handles)
-        , mpSimFac(simFac)        
+        , mpSimFac(simFac)
+        , mGuiCacheTexture(NULL)
+        , mGuiDirty(true)
     {
         mElementFacRes.mIrr = mIrr;
         mElementFacRes.mpManager = this;
@@ -283,7 +290,11 @@ namespace OpenNero
     GuiManager::~GuiManager()
     {
         // remove all of the gui containers from the scene
-		RemoveAll();        
+		RemoveAll();
+
+        // give the cached gui layer back to the driver
+        if( mGuiCacheTexture && mIrr.getVideoDriver() )
+            mIrr.getVideoDriver()->removeTexture(mGuiCacheTexture);
     }
 
 	/**
@@ -295,11 +306,11 @@ namespace OpenNero
 	*/
 	bool GuiManager::OnEvent(const SEvent& event)
 	{
-		GuiBasePtr gui;		
+        bool handled = false;
 
 		// get the gui container
         if( event.EventType == EET_MOUSE_INPUT_EVENT )
-        {	
+        {
             // look at the type of mouse input
             switch( event.MouseInput.Event )
             {
@@ -307,17 +318,29 @@ namespace OpenNero
             // Note: Let this pass down!
             case EMIE_LMOUSE_PRESSED_DOWN:
             case EMIE_RMOUSE_PRESSED_DOWN:
-            case EMIE_MMOUSE_PRESSED_DOWN:                    
+            case EMIE_MMOUSE_PRESSED_DOWN:
             case EMIE_LMOUSE_LEFT_UP:
 			case EMIE_RMOUSE_LEFT_UP:
 			case EMIE_MMOUSE_LEFT_UP:
-                   return HandleMouseClick(event);
+                   handled = HandleMouseClick(event);
+                   break;
 
 			case EMIE_MOUSE_MOVED:
-                   return HandleMouseMove(event);
+                   handled = HandleMouseMove(event);
+                   break;
             default:
                 return false;
             }
+
+            // mouse traffic over an element can change hover and press
+            // visuals inside irrlicht even when none of our handlers
+            // claims the event, so the cached layer must be re-rendered
+            if( handled || !findContainerByPosition(
+                    Pos2i(event.MouseInput.X, event.MouseInput.Y) ).empty() )
+            {
+                MarkDirty();
+            }
+            return handled;
         }
 
         // otherwise it is a special irrlicht gui event hack
@@ -326,23 +349,32 @@ namespace OpenNero
             switch( event.GUIEvent.EventType )
             {
             case EGET_MENU_ITEM_SELECTED:
-                return HandleMenuItemSelected(event);
+                handled = HandleMenuItemSelected(event);
+                break;
 
             case EGET_FILE_SELECTED:
-                return HandleFileSelect(event);
-                
+                handled = HandleFileSelect(event);
+                break;
+
             case EGET_SCROLL_BAR_CHANGED:
-                return HandleScrollBarChanged(event);
-                
+                handled = HandleScrollBarChanged(event);
+                break;
+
             case EGET_CHECKBOX_CHANGED:
-                return HandleCheckBoxChanged(event);
-                
+                handled = HandleCheckBoxChanged(event);
+                break;
+
             case EGET_FILE_CHOOSE_DIALOG_CANCELLED:
-                return HandleFileChooseDialogCancelled(event);
-                
+                handled = HandleFileChooseDialogCancelled(event);
+                break;
+
             default:
                 return false;
             }
+
+            // gui events always reflect an element state change
+            MarkDirty();
+            return handled;
         }
         else
         {
@@ -366,6 +398,21 @@ namespace OpenNero
         // now clear out the map
 		mGuiBases.clear();
         mGuiNames.clear();
+
+        MarkDirty();
+	}
+
+	/// Show or hide every managed element without removing it
+	/// @param visible the visibility to apply to all elements
+	void GuiManager::SetAllVisible( bool visible )
+	{
+		GuiBaseMap::iterator itr = mGuiBases.begin();
+        GuiBaseMap::iterator end = mGuiBases.end();
+
+		for( ; itr != end; ++itr )
+			itr->second->setVisible(visible);
+
+        MarkDirty();
 	}
 
 	/**
@@ -374,15 +421,14 @@ namespace OpenNero
 	*/
 	void GuiManager::Remove( uint32_t guiId )
 	{            
-		GuiBaseMap::iterator itr = mGuiBases.find(guiId);
-		if( itr != mGuiBases.end() )
+		GuiBasePtr base = findContainerById(guiId);
+		if( base )
 		{
-            Assert( itr->second );
-
-            // remove any children
-            const core::list<IGUIElement*>& children = itr->second->getGuiElement()->getChildren();
-            core::list<IGUIElement*>::ConstIterator citr = children.begin();
-            core::list<IGUIElement*>::ConstIterator cend = children.end();
+            // removing children mutates the hashed element map, so hold
+            // the element itself rather than an iterator into the map
+            const irr::core::list<IGUIElement*>& children = base->getGuiElement()->getChildren();
+            irr::core::list<IGUIElement*>::ConstIterator citr = children.begin();
+            irr::core::list<IGUIElement*>::ConstIterator cend = children.end();
 
             for( ; citr != cend; ++citr )
             {   
@@ -390,11 +436,13 @@ namespace OpenNero
             }            
 
             // remove ourselves
-            itr->second->removeFromScene();
+            base->removeFromScene();
 			
             // remove from name and id map
-            mGuiNames.erase(itr->second->getName());
-			mGuiBases.erase(itr);
+            mGuiNames.erase(StringInterner::instance().Intern(base->getName()));
+			mGuiBases.erase(guiId);
+
+            MarkDirty();
 		}
 	}
 
@@ -439,7 +487,10 @@ namespace OpenNero
 
     GuiBasePtr GuiManager::getElement( const std::string& name )
     {
-        GuiNameMap::const_iterator itr = mGuiNames.find(name);
+        // probe without interning, so misses do not grow the intern table
+        const U32 handle = StringInterner::instance().Find(name);
+        GuiNameMap::const_iterator itr = ( handle == StringInterner::kInvalidHandle )
+            ? mGuiNames.end() : mGuiNames.find(handle);
         int32_t id = ( itr == mGuiNames.end() ) ? -1 : itr->second;
         return ( id < 0 ) ? GuiBasePtr() : getElement(id);        
     }
@@ -457,7 +508,9 @@ namespace OpenNero
 			SColor col = mIrr.getGuiEnv()->getSkin()->getColor((EGUI_DEFAULT_COLOR)i);
 			col.setAlpha(uAlpha);
 			this->mIrr.getGuiEnv()->getSkin()->setColor((EGUI_DEFAULT_COLOR)i, col);
-		}  
+		}
+
+        MarkDirty();
     }
 
     // Set the font for the current skin to use
@@ -476,6 +529,7 @@ namespace OpenNero
             if( skin )
             {
                 skin->setFont( newFont );
+                MarkDirty();
                 return true;
             }
         }
@@ -501,6 +555,8 @@ namespace OpenNero
 
         // open the dialog
         mIrr.getGuiEnv()->addFileOpenDialog( wTitle.c_str(), modal, 0, mFileChooser.mDialogID );
+
+        MarkDirty();
     }
 
     // Checks if a file chooser dialog is open
@@ -510,6 +566,64 @@ namespace OpenNero
         return mFileChooser.mDialogOpen;
     }
 
+    // Flag the gui as changed so the next DrawAll re-renders the cache
+    void GuiManager::MarkDirty()
+    {
+        mGuiDirty = true;
+    }
+
+    // Draw the gui for this frame, re-rendering the element hierarchy
+    // only when something changed since the last frame
+    void GuiManager::DrawAll()
+    {
+        video::IVideoDriver* driver = mIrr.getVideoDriver();
+        IGUIEnvironment* guienv = mIrr.getGuiEnv();
+
+        // elements that animate without going through our mutators (the
+        // caret blink of a focused edit box, the skin of a held press,
+        // the file dialog) force a redraw while they are active
+        if( mFocusedContainer || mPressedContainer || mFileChooser.mDialogOpen )
+            mGuiDirty = true;
+
+        // without render targets there is nothing to cache into
+        if( !driver->queryFeature(video::EVDF_RENDER_TO_TARGET) )
+        {
+            guienv->drawAll();
+            return;
+        }
+
+        // (re)create the cache when the window size changes
+        const dimension2du screen = driver->getScreenSize();
+        if( !mGuiCacheTexture || mGuiCacheTexture->getSize() != screen )
+        {
+            if( mGuiCacheTexture )
+                driver->removeTexture(mGuiCacheTexture);
+            mGuiCacheTexture = driver->addRenderTargetTexture(screen, "__gui_cache__");
+            mGuiDirty = true;
+        }
+
+        if( !mGuiCacheTexture )
+        {
+            // driver refused the texture; draw directly like before
+            guienv->drawAll();
+            return;
+        }
+
+        if( mGuiDirty )
+        {
+            // render the whole hierarchy once into the transparent cache
+            driver->setRenderTarget(mGuiCacheTexture, true, true, SColor(0,0,0,0));
+            guienv->drawAll();
+            driver->setRenderTarget(0, false, false);
+            mGuiDirty = false;
+        }
+
+        // a clean gui costs one 2D blit of the cached layer
+        driver->draw2DImage(mGuiCacheTexture, position2di(0,0),
+                            recti(0, 0, screen.Width, screen.Height),
+                            0, SColor(255,255,255,255), true);
+    }
+
     // Create an element out of one of our factories of the given type
     // @param type the type of element to create
     // @return a ptr to a new element or NULL if failed
@@ -832,14 +946,20 @@ namespace OpenNero
     {
         // try to lookup the old name and new name checking
         // for existence and collision
-        GuiNameMap::iterator oldItr = mGuiNames.find(oldName);
-        GuiNameMap::iterator newItr = mGuiNames.find(newName);
+        const U32 oldHandle = StringInterner::instance().Intern(oldName);
+        const U32 newHandle = StringInterner::instance().Intern(newName);
+
+        GuiNameMap::iterator oldItr = mGuiNames.find(oldHandle);
+        GuiNameMap::iterator newItr = mGuiNames.find(newHandle);
 
         if( oldItr != mGuiNames.end() && newItr == mGuiNames.end() )
         {
-            // if it exists, replace it with the new name
-            mGuiNames[newName] = oldItr->second;
-            mGuiNames.erase(oldItr);
+            // if it exists, replace it with the new name; insertion
+            // invalidates the iterators, so take the id out first and
+            // erase by key
+            const uint32_t guiId = oldItr->second;
+            mGuiNames.erase(oldHandle);
+            mGuiNames[newHandle] = guiId;
             return true;
         }
 
@@ -863,6 +983,8 @@ namespace OpenNero
             mIrr.getGuiEnv()->removeFocus(element->getIrrGuiElement());
             mFocusedContainer.reset();
         }
+
+        MarkDirty();
     }
 
     /// Try to find a receiver for an event that can properly handle it by traversing a gui tree
@@ -954,8 +1076,10 @@ namespace OpenNero
         }
         
         // add that name to the map for referral
-        mGuiNames[base->getName()] = id;
-        
+        mGuiNames[StringInterner::instance().Intern(base->getName())] = id;
+
+        MarkDirty();
+
         return base;
     }    
 
@@ -7,6 +7,8 @@
 #define _GAME_GUI_MANAGER_H_
 
 #include "core/Common.h"
+#include "core/FlatHashMap.h"
+#include "core/IdNameRegistry.h"
 #include "core/IrrUtil.h"
 #include "scripting/scripting.h"
 #include <list>
@@ -88,6 +90,10 @@ namespace OpenNero
         /// @param focused if true set the focus, if false remove the focus
         void SetFocusStatus( uint32_t element, bool focused );
 
+        /// Note that an element's visual state changed, so the cached
+        /// gui layer must be re-rendered on the next draw
+        void MarkGuiDirty();
+
     private:
 
         /// our ref to the manager
@@ -138,6 +144,10 @@ namespace OpenNero
 		/// remove all elements
 		void RemoveAll();
 
+        /// show or hide every managed element without removing it (used
+        /// when the owning context is suspended behind another mod)
+        void SetAllVisible( bool visible );
+
 		/// remove a given element
         /// @param guiId the id number of the element
 		void Remove( uint32_t guiId );
@@ -195,6 +205,17 @@ namespace OpenNero
         /// @return true if a dialog is open; false otherwise
         bool isOpenFileChooserDialog() const;
 
+        /// Flag the gui as changed: the next DrawAll re-renders the
+        /// element hierarchy instead of reusing the cached layer
+        void MarkDirty();
+
+        /// Draw the gui for this frame. While no element state changes
+        /// the hierarchy is rendered once into a cached render-target
+        /// texture and subsequent frames just blit it, so a static
+        /// dashboard costs a single 2D draw instead of a full element
+        /// tree walk; any mutation or input marks the cache dirty
+        void DrawAll();
+
         ///@}
 
     public:
@@ -285,11 +306,13 @@ namespace OpenNero
 
     private:
 
-        // a mapping from gui ids to gui containers
-        typedef std::map<uint32_t, GuiBasePtr> GuiBaseMap;
+        // a hashed mapping from gui ids to gui containers
+        typedef FlatHashMap<uint32_t, GuiBasePtr> GuiBaseMap;
 
-        // a mapping from names to ids
-        typedef std::map< std::string, uint32_t > GuiNameMap;
+        // a mapping from interned name handles to ids: binding by name
+        // hashes the string once at the interning boundary and the map
+        // lookup itself is integer-keyed
+        typedef FlatHashMap< U32, uint32_t > GuiNameMap;
 
         // a mapping from types to factories
         typedef std::map< std::string, IGuiElementFactoryPtr > GuiElementFactoryMap;
@@ -306,6 +329,8 @@ namespace OpenNero
         GuiElementFactoryResources      mElementFacRes;     ///< The element factory resources
         GuiElementFactoryMap            mElementFactoryMap; ///< A map from types to factories
         FileChooserDialog               mFileChooser;       ///< The file chooser dialog info
+        irr::video::ITexture*           mGuiCacheTexture;   ///< cached rendering of the gui layer
+        bool                            mGuiDirty;          ///< does the cached layer need a re-render?
 
     private:
 
@@ -29,22 +29,24 @@ namespace OpenNero
         return (bNeedsShift == ioState.IsShiftDown() ) && ( bNeedsCtrl == ioState.IsCtrlDown() );
     }
 
-    // convert a code to a key
-    static KEY AsKey( InputCode code )
-    {
-        return static_cast<KEY>(code & IOMapping::kInputMod_Clear_Mask);
-    }
-
-    static MOUSE_BUTTON AsButton( InputCode code )
-    {
-        return static_cast<MOUSE_BUTTON>(AsKey(code));
-    }
-
     PythonIOMapping::PythonIOMapping( InputSource inputSource, const InputRequirements& requirements, PythonIOMapping::Action pyAction )
         : mSource(inputSource)
         , mRequirements(requirements)        
         , mAction(pyAction)
-    {}
+    {
+        // decode the chord once at bind time; the per-frame checks below
+        // test the stored flags instead of re-masking the raw codes
+        InputCodeList::const_iterator citr = requirements.first.begin();
+        InputCodeList::const_iterator cend = requirements.first.end();
+        for( ; citr != cend; ++citr )
+        {
+            CompiledCode compiled;
+            compiled.key        = (uint16_t)(*citr & kInputMod_Clear_Mask);
+            compiled.needsShift = (*citr & kInputMod_Shift) != 0;
+            compiled.needsCtrl  = (*citr & kInputMod_Ctrl)  != 0;
+            mCompiledCodes.push_back(compiled);
+        }
+    }
 
     /// Check the io state to see if we can do our python action
     /// @param ioState the current io state
@@ -52,11 +54,15 @@ namespace OpenNero
     bool PythonIOMapping::CheckIORequirements( const IOState& ioState ) const
     {
         // get the input type and modifiers
-        Assert( mRequirements.first.size() > 0 );        
+        Assert( mCompiledCodes.size() > 0 );
         InputType type = mRequirements.second;
 
-        InputCodeList::const_iterator citr = mRequirements.first.begin();
-        InputCodeList::const_iterator cend = mRequirements.first.end();
+        // the modifier state is the same for every code in the chord
+        const bool bShiftDown = ioState.IsShiftDown();
+        const bool bCtrlDown  = ioState.IsCtrlDown();
+
+        CompiledCodeList::const_iterator citr = mCompiledCodes.begin();
+        CompiledCodeList::const_iterator cend = mCompiledCodes.end();
 
         // all these loops are separated for performance, not clarity...
         switch( mSource )
@@ -66,19 +72,19 @@ namespace OpenNero
                 if( type == kInputType_Key_OnPress )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.WasKeyPressedLastFrame( AsKey(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )
+                        if( !ioState.WasKeyPressedLastFrame( (KEY)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )
                             return false;
                 }
                 else if( type == kInputType_Key_OnRelease )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.WasKeyReleasedLastFrame( AsKey(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )
+                        if( !ioState.WasKeyReleasedLastFrame( (KEY)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )
                             return false;
                 }
                 else if( type == kInputType_Key_OnHold )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.IsKeyHeld( AsKey(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )
+                        if( !ioState.IsKeyHeld( (KEY)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )
                             return false;
                 }
             }
@@ -89,19 +95,19 @@ namespace OpenNero
                 if( type == kInputType_Mouse_OnPress )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.WasMouseButtonPressedLastFrame( AsButton(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )
+                        if( !ioState.WasMouseButtonPressedLastFrame( (MOUSE_BUTTON)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )
                             return false;
                 }
                 else if( type == kInputType_Mouse_OnRelease )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.WasMouseButtonReleasedLastFrame( AsButton(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )
+                        if( !ioState.WasMouseButtonReleasedLastFrame( (MOUSE_BUTTON)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )
                             return false;
                 }
                 else if( type == kInputType_Mouse_OnHold )
                 {
                     for( ; citr != cend; ++citr )
-                        if( !ioState.IsMouseButtonHeld( AsButton(*citr) ) || !CheckModifierRequirements( *citr, ioState ) )                        
+                        if( !ioState.IsMouseButtonHeld( (MOUSE_BUTTON)citr->key ) || citr->needsShift != bShiftDown || citr->needsCtrl != bCtrlDown )                        
                             return false;
                 }
                 else if( type == kInputType_Mouse_Move_X )
@@ -8,7 +8,7 @@
 
 #include "core/ONTypes.h"
 #include "core/BoostCommon.h"
-#include "core/HashMap.h"
+#include "core/FlatHashMap.h"
 #include "input/IOState.h"
 #include "scripting/scriptIncludes.h"
 
@@ -106,10 +106,24 @@ namespace OpenNero
        bool CheckIORequirements( const IOState& ioState ) const;
        void DoMappedAction();
 
+    private:
+
+        /// a chord code decoded once at bind time, so the per-frame state
+        /// checks do not re-mask the key and modifier bits out of the code
+        struct CompiledCode
+        {
+            uint16_t    key;            ///< the key or button value without modifier bits
+            bool        needsShift;     ///< the chord requires shift to be down
+            bool        needsCtrl;      ///< the chord requires ctrl to be down
+        };
+
+        typedef std::vector<CompiledCode> CompiledCodeList;
+
     private:
 
         InputSource         mSource;            ///< The input source
         InputRequirements   mRequirements;      ///< The required codes and states to perform the action
+        CompiledCodeList    mCompiledCodes;     ///< the requirements decoded at construction
         Action              mAction;            ///< The python method to call
     };
 
@@ -139,7 +153,10 @@ namespace OpenNero
 
     private:
 
-        typedef hash_map<IOMapKey, IOMappingPtr > IOMappings;
+        /// the bindings keyed by chord (input type and code), so rebinding a
+        /// chord replaces its action in place and the per-frame poll walks a
+        /// flat table instead of chasing hash_map nodes
+        typedef FlatHashMap<IOMapKey, IOMappingPtr > IOMappings;
 
     private:
 
@@ -14,10 +14,13 @@ namespace OpenNero
 {   
     using namespace boost;
 
-    RandomNumberGenerator::RandomNumberGenerator() : _randomness()    {
+    RandomNumberGenerator::RandomNumberGenerator()
+        : _randomness(), _uniform01(), _spareGaussian(0), _hasSpareGaussian(false)
+    {
     }
 
-    RandomNumberGenerator::RandomNumberGenerator( const boost::uint32_t& seed ) : _randomness(seed)
+    RandomNumberGenerator::RandomNumberGenerator( const boost::uint32_t& seed )
+        : _randomness(seed), _uniform01(), _spareGaussian(0), _hasSpareGaussian(false)
     {
     }
     
@@ -41,38 +44,85 @@ namespace OpenNero
 
     float32_t RandomNumberGenerator::randF() const
     {
-        return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, 1);
+        return static_cast<float32_t>(_uniform01(_randomness));
     }
 
     float32_t RandomNumberGenerator::randF(const float32_t& n) const
     {
-        return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, n);
+        return static_cast<float32_t>(n * _uniform01(_randomness));
     }
 
     double    RandomNumberGenerator::randD() const
     {
-        return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, 1);
+        return _uniform01(_randomness);
     }
     
     double    RandomNumberGenerator::randD(const double& n) const
     {
-        return generate<boost::uniform_real<double>, double>(_randomness, n);
+        return n * _uniform01(_randomness);
     }
-    
+
+    /// generate a unit normal using the Marsaglia polar method; every draw
+    /// produces a pair, so the unused half is cached for the next call
+    /// instead of being thrown away the way a per-call distribution object
+    /// would discard it
+    double RandomNumberGenerator::nextGaussian() const
+    {
+        if (_hasSpareGaussian)
+        {
+            _hasSpareGaussian = false;
+            return _spareGaussian;
+        }
+        double u, v, s;
+        do
+        {
+            u = 2.0 * _uniform01(_randomness) - 1.0;
+            v = 2.0 * _uniform01(_randomness) - 1.0;
+            s = u * u + v * v;
+        } while (s >= 1.0 || s == 0.0);
+        const double scale = sqrt(-2.0 * log(s) / s);
+        _spareGaussian = v * scale;
+        _hasSpareGaussian = true;
+        return u * scale;
+    }
+
     /// normal real number with mean and variance
     float32_t    RandomNumberGenerator::normalF(const float32_t& mu, const float32_t& sigma) const
     {
-        normal_distribution<float32_t> dist(mu, sigma);
-        boost::variate_generator<boost::mt19937&, normal_distribution<float32_t> > vg(_randomness, dist);
-        return vg();
+        return static_cast<float32_t>(mu + sigma * nextGaussian());
     }
 
     /// normal real number with mean and variance
     double       RandomNumberGenerator::normalD(const double& mu, const double& sigma) const
     {
-        normal_distribution<double> dist(mu, sigma);
-        boost::variate_generator<boost::mt19937&, normal_distribution<double> > vg(_randomness, dist);
-        return vg();
+        return mu + sigma * nextGaussian();
+    }
+
+    /// fill a buffer with n uniform real numbers in [0,max)
+    void RandomNumberGenerator::randFillF(float32_t* buffer, const uint32_t& n, const float32_t& max) const
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            buffer[i] = static_cast<float32_t>(max * _uniform01(_randomness));
+        }
+    }
+
+    /// fill a buffer with n normal real numbers with mean and deviation
+    void RandomNumberGenerator::normalFillF(float32_t* buffer, const uint32_t& n, const float32_t& mu, const float32_t& sigma) const
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            buffer[i] = static_cast<float32_t>(mu + sigma * nextGaussian());
+        }
+    }
+
+    /// fill a buffer with n normal real numbers with mean and deviation
+    void RandomNumberGenerator::normalFillD(double* buffer, const uint32_t& n, const double& mu, const double& sigma) const
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            buffer[i] = mu + sigma * nextGaussian();
+        }
     }
 
     RandomNumberGenerator RANDOM(55555); // random number generator with default seed
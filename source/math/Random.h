@@ -10,8 +10,9 @@
 #include "core/Common.h"
 #include "core/ONTypes.h"
 #include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
 
-namespace OpenNero 
+namespace OpenNero
 {
     /// Custom random number generator
     class RandomNumberGenerator
@@ -37,11 +38,26 @@ namespace OpenNero
         float32_t    normalF(const float32_t& mu, const float32_t& sigma) const;
         /// normal real number with mean and deviation
         double       normalD(const double& mu, const double& sigma) const;
+        /// fill a buffer with n uniform real numbers in [0,max)
+        void         randFillF(float32_t* buffer, const uint32_t& n, const float32_t& max) const;
+        /// fill a buffer with n normal real numbers with mean and deviation
+        void         normalFillF(float32_t* buffer, const uint32_t& n, const float32_t& mu, const float32_t& sigma) const;
+        /// fill a buffer with n normal real numbers with mean and deviation
+        void         normalFillD(double* buffer, const uint32_t& n, const double& mu, const double& sigma) const;
         /// seed with a value
-        void seed(const boost::uint32_t& seed) { _randomness.seed(seed); }
+        void seed(const boost::uint32_t& seed) { _randomness.seed(seed); _hasSpareGaussian = false; }
     private:
+        /// generate a unit normal, caching the spare of each Box-Muller pair
+        double nextGaussian() const;
+
         /// random number generator
         mutable boost::mt19937 _randomness;
+        /// persistent uniform [0,1) distribution state
+        mutable boost::uniform_01<double> _uniform01;
+        /// the unused half of the last Box-Muller pair
+        mutable double _spareGaussian;
+        /// true iff _spareGaussian holds a value
+        mutable bool _hasSpareGaussian;
     };
     
     extern RandomNumberGenerator RANDOM;
@@ -0,0 +1,150 @@
+//--------------------------------------------------------
+// OpenNero : RandomStream
+//  counter-based random number stream
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include <cmath>
+#include "RandomStream.h"
+
+namespace
+{
+    // Philox 4x32 round constants (from Salmon et al., "Parallel Random
+    // Numbers: As Easy as 1, 2, 3")
+    const OpenNero::uint32_t kPhiloxM0 = 0xD2511F53;
+    const OpenNero::uint32_t kPhiloxM1 = 0xCD9E8D57;
+    const OpenNero::uint32_t kPhiloxW0 = 0x9E3779B9;
+    const OpenNero::uint32_t kPhiloxW1 = 0xBB67AE85;
+
+    /// one Philox 4x32 round over the counter words
+    inline void PhiloxRound( OpenNero::uint32_t c[4], OpenNero::uint32_t k0, OpenNero::uint32_t k1 )
+    {
+        const OpenNero::uint64_t p0 = (OpenNero::uint64_t)kPhiloxM0 * c[0];
+        const OpenNero::uint64_t p1 = (OpenNero::uint64_t)kPhiloxM1 * c[2];
+
+        const OpenNero::uint32_t hi0 = (OpenNero::uint32_t)(p0 >> 32);
+        const OpenNero::uint32_t lo0 = (OpenNero::uint32_t)p0;
+        const OpenNero::uint32_t hi1 = (OpenNero::uint32_t)(p1 >> 32);
+        const OpenNero::uint32_t lo1 = (OpenNero::uint32_t)p1;
+
+        const OpenNero::uint32_t c1 = c[1];
+        const OpenNero::uint32_t c3 = c[3];
+
+        c[0] = hi1 ^ c1 ^ k0;
+        c[1] = lo1;
+        c[2] = hi0 ^ c3 ^ k1;
+        c[3] = lo0;
+    }
+}
+
+namespace OpenNero
+{
+    RandomStream::RandomStream() :
+        mKey0(0),
+        mKey1(0),
+        mCounter(0),
+        mAvail(0)
+    {
+    }
+
+    RandomStream::RandomStream( uint32_t key0, uint32_t key1 ) :
+        mKey0(key0),
+        mKey1(key1),
+        mCounter(0),
+        mAvail(0)
+    {
+    }
+
+    /// rekey the stream and rewind its counter to zero
+    void RandomStream::Reset( uint32_t key0, uint32_t key1 )
+    {
+        mKey0 = key0;
+        mKey1 = key1;
+        mCounter = 0;
+        mAvail = 0;
+    }
+
+    /// Run the ten Philox rounds on the current counter and refill the
+    /// block of four output words
+    void RandomStream::FillBlock() const
+    {
+        uint32_t c[4];
+        c[0] = (uint32_t)mCounter;
+        c[1] = (uint32_t)(mCounter >> 32);
+        c[2] = 0;
+        c[3] = 0;
+
+        uint32_t k0 = mKey0;
+        uint32_t k1 = mKey1;
+
+        for( size_t round = 0; round < 10; ++round )
+        {
+            PhiloxRound( c, k0, k1 );
+            k0 += kPhiloxW0;
+            k1 += kPhiloxW1;
+        }
+
+        mBlock[0] = c[0];
+        mBlock[1] = c[1];
+        mBlock[2] = c[2];
+        mBlock[3] = c[3];
+        mAvail = 4;
+        ++mCounter;
+    }
+
+    uint32_t RandomStream::randI() const
+    {
+        if( mAvail == 0 )
+        {
+            FillBlock();
+        }
+        return mBlock[--mAvail];
+    }
+
+    uint32_t RandomStream::randI(const uint32_t& n) const
+    {
+        // n is inclusive, matching RandomNumberGenerator::randI(n)
+        if( n == 0xFFFFFFFF )
+            return randI();
+        return randI() % (n + 1);
+    }
+
+    float32_t RandomStream::randF() const
+    {
+        // 24 bits of randomness fill a float32_t mantissa exactly
+        return (float32_t)(randI() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float32_t RandomStream::randF(const float32_t& n) const
+    {
+        return randF() * n;
+    }
+
+    double RandomStream::randD() const
+    {
+        // use all 32 bits for the double mantissa
+        return (double)randI() * (1.0 / 4294967296.0);
+    }
+
+    double RandomStream::randD(const double& n) const
+    {
+        return randD() * n;
+    }
+
+    /// normal real number with mean and deviation (Box-Muller)
+    float32_t RandomStream::normalF(const float32_t& mu, const float32_t& sigma) const
+    {
+        return (float32_t)normalD(mu, sigma);
+    }
+
+    /// normal real number with mean and deviation (Box-Muller)
+    double RandomStream::normalD(const double& mu, const double& sigma) const
+    {
+        // avoid log(0) by keeping u1 strictly positive
+        const double u1 = ((double)randI() + 1.0) * (1.0 / 4294967297.0);
+        const double u2 = randD();
+        const double r = sqrt( -2.0 * log(u1) );
+        return mu + sigma * r * cos( 6.28318530717958647692 * u2 );
+    }
+
+} //end OpenNero
@@ -0,0 +1,69 @@
+//--------------------------------------------------------
+// OpenNero : RandomStream
+//  counter-based random number stream
+//--------------------------------------------------------
+
+#ifndef _OPENNERO_MATH_RANDOMSTREAM_H_
+#define _OPENNERO_MATH_RANDOMSTREAM_H_
+
+#include "core/Common.h"
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * A counter-based random number stream (Philox 4x32-10). The stream is
+     * a pure function of a two-word key and a running counter, so a
+     * generator carries a few words of state instead of the Mersenne
+     * Twister's large shared table. Streams with different keys are
+     * statistically independent, which lets parallel code give every
+     * organism or worker thread its own reproducible stream - seeded, for
+     * example, from an organism id and a generation number - without any
+     * contention on a global generator.
+     *
+     * The draw methods mirror RandomNumberGenerator so the two can be used
+     * interchangeably.
+     */
+    class RandomStream
+    {
+    public:
+        RandomStream();
+
+        /// construct a stream identified by a two-word key
+        RandomStream( uint32_t key0, uint32_t key1 );
+
+        /// rekey the stream and rewind its counter to zero
+        void Reset( uint32_t key0, uint32_t key1 );
+
+        /// uniform integer in [0,2^32-1]
+        uint32_t     randI() const;
+        /// uniform integer in [0,n]
+        uint32_t     randI(const uint32_t& n) const;
+        /// uniform real number in [0,1]
+        float32_t    randF() const;
+        /// uniform real number in [0,n]
+        float32_t    randF(const float32_t& n) const;
+        /// uniform real number in [0,1]
+        double       randD() const;
+        /// uniform real number in [0,n]
+        double       randD(const double& n) const;
+        /// normal real number with mean and deviation
+        float32_t    normalF(const float32_t& mu, const float32_t& sigma) const;
+        /// normal real number with mean and deviation
+        double       normalD(const double& mu, const double& sigma) const;
+
+    private:
+
+        /// run the Philox rounds on the current counter and refill mBlock
+        void FillBlock() const;
+
+        uint32_t            mKey0;      ///< first word of the stream key
+        uint32_t            mKey1;      ///< second word of the stream key
+        mutable uint64_t    mCounter;   ///< which block of the stream comes next
+        mutable uint32_t    mBlock[4];  ///< the last generated block
+        mutable uint32_t    mAvail;     ///< unconsumed words left in mBlock
+    };
+
+} //end OpenNero
+
+#endif // _OPENNERO_MATH_RANDOMSTREAM_H_
@@ -5,12 +5,59 @@
 
 #include "core/Common.h"
 #include "Camera.h"
+#include "render/FrameCapture.h"
 #include "game/SimContext.h"
 #include "game/Simulation.h"
 #include "game/SimEntity.h"
 
-namespace OpenNero 
+namespace OpenNero
 {
+    namespace
+    {
+        /// frustum of the active camera published for the current frame;
+        /// scene objects test against it to skip display-only tick work
+        /// for offscreen entities
+        irr::scene::SViewFrustum sPublishedFrustum;
+
+        /// true only while a frustum is published (rendered runs)
+        bool sFrustumPublished = false;
+    }
+
+    /// Publish the view frustum used for this frame's visibility culling
+    /// @param camera the active Irrlicht camera, or NULL to disable culling
+    void Camera::PublishFrustum( irr::scene::ICameraSceneNode* camera )
+    {
+        if( camera && camera->getViewFrustum() )
+        {
+            sPublishedFrustum = *camera->getViewFrustum();
+            sFrustumPublished = true;
+        }
+        else
+        {
+            sFrustumPublished = false;
+        }
+    }
+
+    /// Test a bounding sphere against the published frustum
+    /// @param center sphere center in Irrlicht world coordinates
+    /// @param radius sphere radius
+    /// @return true if the sphere touches the frustum or none is published
+    bool Camera::IsSphereVisible( const Vector3f& center, F32 radius )
+    {
+        if( !sFrustumPublished )
+            return true;
+
+        // outside any one plane (including the far plane, which gives us
+        // distance culling for free) means not visible
+        for( irr::s32 i = 0; i < irr::scene::SViewFrustum::VF_PLANE_COUNT; ++i )
+        {
+            if( sPublishedFrustum.planes[i].getDistanceTo( center ) > radius )
+                return false;
+        }
+
+        return true;
+    }
+
     /**
      * CTOR
      * @param handles irrlicht handles to aid in the construction
@@ -149,16 +196,13 @@ namespace OpenNero
     }
 	
     void Camera::snapshot(const std::string& filename)
-    {        
+    {
         LOG_F_DEBUG("render", "Taking snapshot!");
-        IImage* img = mIrr.mpVideoDriver->createScreenShot();
-        if(!img)
-            LOG_F_ERROR("render", "Snapshot mage is null!");
-        else {
-            if (!mIrr.mpVideoDriver->writeImageToFile(img, filename.c_str()))
-                LOG_F_ERROR("render", "Could not write snapshot image!");
-            img->drop();
-        }
+        // the readback happens here on the render thread; encoding the
+        // image and writing it out happen on the capture pipeline's
+        // background thread
+        FrameCapture::instance().CaptureFrame(
+            mIrr.mpVideoDriver, mIrr.mpIrrDevice->getFileSystem(), filename);
     }
     
 	void Camera::setNearPlane( F32 nearPlane )
@@ -102,6 +102,16 @@ namespace OpenNero
         /// output information about the camera to human-readable stream
         friend std::ostream& operator<<(std::ostream& output, const CameraPtr camera);
 
+        /// publish the view frustum of the given camera for this frame so
+        /// that scene objects can cull display-only tick work; pass NULL
+        /// (headless run or no camera) to disable culling for the frame
+        static void PublishFrustum( irr::scene::ICameraSceneNode* camera );
+
+        /// test a world-space bounding sphere (Irrlicht coordinates)
+        /// against the published frustum; conservatively reports visible
+        /// when no frustum has been published
+        static bool IsSphereVisible( const Vector3f& center, F32 radius );
+
     private:
 
         IrrHandles_Weak         mIrr;
@@ -1,14 +1,38 @@
 #include "core/Common.h"
 #include "core/ONTime.h"
+#include "core/Log.h"
 #include "render/FPSCounter.h"
+#include "utils/Profiler.h"
 #include "irrlicht.h"
+#include <cmath>
 
 namespace OpenNero
 {
+    namespace
+    {
+        /// smallest histogram bucket: frames up to one millisecond
+        const F32 kFirstBucketMs = 1.0f;
+
+        /// each bucket covers sqrt(2) times the previous one, so 24
+        /// buckets reach from 1ms to roughly 3 seconds
+        const F64 kBucketGrowth = 1.4142135623730951;
+    }
+
     FPSCounter::FPSCounter()
     :	FPS(60), StartTime(0), FramesCounted(0)
+        , mLastFrameNanos(0)
+        , mTotalFrames(0)
+        , mTotalMs(0)
+        , mP50Ms(0)
+        , mP95Ms(0)
+        , mP99Ms(0)
+        , mWorstMs(0)
     {
-
+        for (size_t i = 0; i < kNumBuckets; ++i)
+        {
+            mCounts[i] = 0;
+            mWindowCounts[i] = 0;
+        }
     }
 
     /// returns current fps
@@ -17,9 +41,65 @@ namespace OpenNero
         return FPS;
     }
 
+    /// mean frame time over the whole run
+    F32 FPSCounter::getMeanMs() const
+    {
+        return mTotalFrames > 0 ? (F32)(mTotalMs / mTotalFrames) : 0;
+    }
+
+    /// upper bound of histogram bucket i in milliseconds
+    F32 FPSCounter::BucketUpperBoundMs(size_t i)
+    {
+        return (F32)(kFirstBucketMs * std::pow(kBucketGrowth, (F64)i));
+    }
+
+    /// the bucket a frame of the given duration is filed into
+    size_t FPSCounter::BucketIndex(F32 ms)
+    {
+        if (ms <= kFirstBucketMs) return 0;
+        // invert BucketUpperBoundMs: two buckets per doubling
+        const F64 index = std::ceil(2.0 * std::log(ms / kFirstBucketMs) / std::log(2.0));
+        if (index >= (F64)(kNumBuckets - 1)) return kNumBuckets - 1;
+        return (size_t)index;
+    }
+
     /// to be called every frame
     void FPSCounter::registerFrame()
     {
+        // file the frame duration into the histogram
+        const uint64_t now_nanos = HighResClock::GetNanoseconds();
+        if (mLastFrameNanos != 0)
+        {
+            const F32 ms = (F32)((now_nanos - mLastFrameNanos) * 1e-6);
+            const size_t bucket = BucketIndex(ms);
+            mCounts[bucket] += 1;
+            mWindowCounts[bucket] += 1;
+            mTotalFrames += 1;
+            mTotalMs += ms;
+
+            // a new worst frame also grabs the profiler's breakdown of
+            // where the time went, so the spike can be explained later
+            if (ms > mWorstMs)
+            {
+                mWorstMs = ms;
+                mWorstBreakdown.clear();
+                if (Profiler::instance().IsEnabled())
+                {
+                    const std::vector<Profiler::ScopeStats>& stats =
+                        Profiler::instance().GetFrameStats();
+                    mWorstBreakdown.reserve(stats.size());
+                    for (size_t i = 0; i < stats.size(); ++i)
+                    {
+                        WorstScope scope;
+                        scope.path = stats[i].path;
+                        scope.milliseconds = stats[i].milliseconds;
+                        mWorstBreakdown.push_back(scope);
+                    }
+                }
+            }
+        }
+        mLastFrameNanos = now_nanos;
+
         ++FramesCounted;
         U32 now = U32(GetStaticTimer().getMilliseconds());
         const U32 milliseconds = now - StartTime;
@@ -27,12 +107,71 @@ namespace OpenNero
         if (milliseconds >= 1500)
         {
             const F32 invMilli = irr::core::reciprocal ( (F32) milliseconds );
-		
+
             FPS = irr::core::ceil32 ( ( 1000 * FramesCounted ) * invMilli );
 
             FramesCounted = 0;
             StartTime = now;
+
+            // refresh the rolling percentiles at the same cadence
+            UpdatePercentiles();
+        }
+    }
+
+    /// recompute the rolling percentiles from the window histogram
+    void FPSCounter::UpdatePercentiles()
+    {
+        uint64_t total = 0;
+        for (size_t i = 0; i < kNumBuckets; ++i)
+        {
+            total += mWindowCounts[i];
+        }
+        if (total == 0) return;
+
+        const F64 targets[3] = { 0.50 * total, 0.95 * total, 0.99 * total };
+        F32* results[3] = { &mP50Ms, &mP95Ms, &mP99Ms };
+        for (size_t t = 0; t < 3; ++t)
+        {
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < kNumBuckets; ++i)
+            {
+                if (cumulative + mWindowCounts[i] >= targets[t])
+                {
+                    // interpolate inside the bucket
+                    const F32 low = i > 0 ? BucketUpperBoundMs(i - 1) : 0;
+                    const F32 high = BucketUpperBoundMs(i);
+                    const F64 frac = (targets[t] - cumulative) / (F64)mWindowCounts[i];
+                    *results[t] = low + (F32)frac * (high - low);
+                    break;
+                }
+                cumulative += mWindowCounts[i];
+            }
+        }
+
+        for (size_t i = 0; i < kNumBuckets; ++i)
+        {
+            mWindowCounts[i] = 0;
         }
     }
-} // end namespace OpenNero
 
+    /// log the histogram and percentiles (the shutdown dump)
+    void FPSCounter::LogSummary() const
+    {
+        if (mTotalFrames == 0) return;
+        LOG_F_MSG("render", "frame times over " << mTotalFrames << " frames: mean "
+                  << getMeanMs() << "ms, p50 " << mP50Ms << "ms, p95 " << mP95Ms
+                  << "ms, p99 " << mP99Ms << "ms, worst " << mWorstMs << "ms");
+        for (size_t i = 0; i < kNumBuckets; ++i)
+        {
+            if (mCounts[i] == 0) continue;
+            LOG_F_MSG("render", "frame time histogram: <= "
+                      << BucketUpperBoundMs(i) << "ms: " << mCounts[i]);
+        }
+        for (size_t i = 0; i < mWorstBreakdown.size(); ++i)
+        {
+            LOG_F_MSG("render", "worst frame breakdown: "
+                      << mWorstBreakdown[i].path << " "
+                      << mWorstBreakdown[i].milliseconds << "ms");
+        }
+    }
+} // end namespace OpenNero
@@ -1,13 +1,33 @@
 #ifndef _RENDER_FPSCOUNTER_H_
 #define _RENDER_FPSCOUNTER_H_
 
+#include <string>
+#include <vector>
 #include "core/Common.h"
 
 namespace OpenNero
 {
-    class FPSCounter  
+    /// Frame-time statistics collector. Besides the smoothed FPS number
+    /// shown on the HUD, every frame is filed into a fixed set of
+    /// log-scale duration buckets, rolling p50/p95/p99 percentiles are
+    /// derived from the buckets once per update window, and the worst
+    /// frame seen so far is captured together with the profiler's
+    /// per-scope breakdown, so tail spikes are a tracked number instead
+    /// of an anecdote.
+    class FPSCounter
     {
     public:
+        /// number of log-scale frame-time buckets; bucket i holds frames
+        /// up to BucketUpperBoundMs(i), the last bucket holds the rest
+        static const size_t kNumBuckets = 24;
+
+        /// one profiler scope of the worst frame's breakdown
+        struct WorstScope
+        {
+            std::string path;    ///< profiler scope path (e.g. "tick/ai")
+            F32 milliseconds;    ///< time the scope took in the worst frame
+        };
+
         FPSCounter();
 
         //! returns current fps
@@ -16,12 +36,59 @@ namespace OpenNero
         //! to be called every frame
         void registerFrame();
 
+        /// @{
+        /// rolling frame-time percentiles (milliseconds), recomputed from
+        /// the histogram once per update window
+        F32 getP50Ms() const { return mP50Ms; }
+        F32 getP95Ms() const { return mP95Ms; }
+        F32 getP99Ms() const { return mP99Ms; }
+        /// @}
+
+        /// total number of frames registered
+        uint64_t getFrameCount() const { return mTotalFrames; }
+
+        /// mean frame time over the whole run (milliseconds)
+        F32 getMeanMs() const;
+
+        /// duration of the worst frame seen so far (milliseconds)
+        F32 getWorstFrameMs() const { return mWorstMs; }
+
+        /// the profiler's per-scope breakdown captured when the worst
+        /// frame was registered (empty if the profiler was off)
+        const std::vector<WorstScope>& getWorstFrameBreakdown() const { return mWorstBreakdown; }
+
+        /// cumulative count of frames filed into bucket i
+        uint64_t getBucketCount(size_t i) const { return mCounts[i]; }
+
+        /// upper bound of histogram bucket i in milliseconds
+        static F32 BucketUpperBoundMs(size_t i);
+
+        /// log the histogram and percentiles (the shutdown dump)
+        void LogSummary() const;
+
     private:
 
+        /// the bucket a frame of the given duration is filed into
+        static size_t BucketIndex(F32 ms);
+
+        /// recompute the rolling percentiles from the window histogram
+        void UpdatePercentiles();
+
         S32 FPS;
         U32 StartTime;
 
         U32 FramesCounted;
+
+        uint64_t mLastFrameNanos;             ///< end time of the previous frame
+        uint64_t mTotalFrames;                ///< frames registered so far
+        F64 mTotalMs;                         ///< summed frame time
+        uint64_t mCounts[kNumBuckets];        ///< cumulative histogram
+        uint64_t mWindowCounts[kNumBuckets];  ///< histogram of the current window
+        F32 mP50Ms;                           ///< rolling 50th percentile
+        F32 mP95Ms;                           ///< rolling 95th percentile
+        F32 mP99Ms;                           ///< rolling 99th percentile
+        F32 mWorstMs;                         ///< worst frame so far
+        std::vector<WorstScope> mWorstBreakdown; ///< profiler scopes of the worst frame
     };
 
 } // end namespace OpenNero
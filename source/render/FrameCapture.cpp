@@ -0,0 +1,246 @@
+//--------------------------------------------------------
+// OpenNero : FrameCapture
+//  asynchronous framebuffer capture and encoding
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "render/FrameCapture.h"
+#include "core/IrrUtil.h"
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <sstream>
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// frames queued beyond this are dropped instead of backing up
+        /// into the render thread
+        const size_t kMaxPendingFrames = 8;
+
+        /// digits in a sequence frame number
+        const U32 kSequenceDigits = 6;
+
+        /// a captured frame on its way to disk
+        struct CaptureJob
+        {
+            irr::video::IImage* image; ///< the pixels, owned by the job
+            std::string fileName;      ///< where to write them
+
+            CaptureJob() : image(NULL) {}
+        };
+
+        /// find the image writer matching the file's extension
+        irr::video::IImageWriter* FindImageWriter( irr::video::IVideoDriver* driver,
+                                                   const std::string& fileName )
+        {
+            for( irr::u32 i = 0; i < driver->getImageWriterCount(); ++i )
+            {
+                irr::video::IImageWriter* writer = driver->getImageWriter(i);
+                if( writer && writer->isAWriteableFileExtension(fileName.c_str()) )
+                    return writer;
+            }
+            return NULL;
+        }
+    }
+
+    /// the bounded frame queue and the encoder thread behind the pipeline
+    struct FrameCapture::EncoderState
+    {
+        std::mutex mutex;                 ///< guards everything below
+        std::condition_variable wake;     ///< signals the encoder thread
+        std::deque<CaptureJob> pending;   ///< frames waiting to be encoded
+        std::thread encoder;              ///< the background encoder thread
+        bool running;                     ///< cleared to ask the encoder to drain and exit
+        U32 dropped;                      ///< frames dropped so far
+
+        irr::video::IVideoDriver* driver; ///< supplies the image writers
+        irr::io::IFileSystem* fileSystem; ///< opens the output files
+
+        EncoderState() : running(false), dropped(0), driver(NULL), fileSystem(NULL) {}
+    };
+
+    FrameCapture& FrameCapture::instance()
+    {
+        static FrameCapture capture;
+        return capture;
+    }
+
+    FrameCapture::FrameCapture()
+        : mEncoder(NULL)
+        , mRecording(false)
+        , mFrameIndex(0)
+    {
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        Shutdown();
+    }
+
+    void FrameCapture::CaptureFrame( irr::video::IVideoDriver* driver,
+                                     irr::io::IFileSystem* fileSystem,
+                                     const std::string& fileName )
+    {
+        Assert( driver && fileSystem );
+
+        // the framebuffer readback has to happen on the render thread;
+        // everything after it happens on the encoder thread
+        irr::video::IImage* image = driver->createScreenShot();
+        if( !image )
+        {
+            LOG_F_ERROR( "render", "could not read back the frame for " << fileName );
+            return;
+        }
+
+        QueueFrame( image, driver, fileSystem, fileName );
+    }
+
+    bool FrameCapture::StartRecording( const std::string& prefix )
+    {
+        // split the extension off the prefix; frames are numbered between
+        // the two parts
+        const size_t dot = prefix.rfind('.');
+        const size_t slash = prefix.find_last_of("/\\");
+        if( dot == std::string::npos
+            || ( slash != std::string::npos && dot < slash ) )
+        {
+            mSequenceBase = prefix;
+            mSequenceExt = ".png";
+        }
+        else
+        {
+            mSequenceBase = prefix.substr(0, dot);
+            mSequenceExt = prefix.substr(dot);
+        }
+        mFrameIndex = 0;
+        mRecording = true;
+        LOG_F_MSG( "render", "recording frames to " << mSequenceBase
+                   << std::string(kSequenceDigits, 'N') << mSequenceExt );
+        return true;
+    }
+
+    void FrameCapture::StopRecording()
+    {
+        mRecording = false;
+    }
+
+    void FrameCapture::OnFrameRendered( irr::video::IVideoDriver* driver,
+                                        irr::io::IFileSystem* fileSystem )
+    {
+        if( !mRecording )
+            return;
+
+        std::ostringstream name;
+        name << mSequenceBase;
+        name.fill('0');
+        name.width(kSequenceDigits);
+        name << mFrameIndex++;
+        name << mSequenceExt;
+        CaptureFrame( driver, fileSystem, name.str() );
+    }
+
+    void FrameCapture::Shutdown()
+    {
+        mRecording = false;
+        if( !mEncoder )
+            return;
+        {
+            std::lock_guard<std::mutex> guard(mEncoder->mutex);
+            mEncoder->running = false;
+        }
+        mEncoder->wake.notify_one();
+        if( mEncoder->encoder.joinable() )
+            mEncoder->encoder.join();
+        delete mEncoder;
+        mEncoder = NULL;
+    }
+
+    void FrameCapture::QueueFrame( irr::video::IImage* image,
+                                   irr::video::IVideoDriver* driver,
+                                   irr::io::IFileSystem* fileSystem,
+                                   const std::string& fileName )
+    {
+        if( !mEncoder )
+            mEncoder = new EncoderState;
+
+        std::lock_guard<std::mutex> guard(mEncoder->mutex);
+        mEncoder->driver = driver;
+        mEncoder->fileSystem = fileSystem;
+
+        if( mEncoder->pending.size() >= kMaxPendingFrames )
+        {
+            // the encoder is behind; dropping the frame beats stalling
+            // the render thread (warn occasionally, not per frame)
+            image->drop();
+            if( (++mEncoder->dropped & 63) == 1 )
+            {
+                LOG_F_WARNING( "render", "frame capture queue is full; dropped "
+                               << mEncoder->dropped << " frames so far" );
+            }
+            return;
+        }
+
+        CaptureJob job;
+        job.image = image;
+        job.fileName = fileName;
+        mEncoder->pending.push_back(job);
+
+        if( !mEncoder->running )
+        {
+            mEncoder->running = true;
+            mEncoder->encoder = std::thread(&FrameCapture::EncoderLoop, mEncoder);
+        }
+        mEncoder->wake.notify_one();
+    }
+
+    void FrameCapture::EncoderLoop( EncoderState* state )
+    {
+        for( ;; )
+        {
+            CaptureJob job;
+            {
+                std::unique_lock<std::mutex> guard(state->mutex);
+                while( state->pending.empty() && state->running )
+                {
+                    state->wake.wait(guard);
+                }
+                if( state->pending.empty() )
+                {
+                    break; // asked to exit and fully drained
+                }
+                job = state->pending.front();
+                state->pending.pop_front();
+            }
+
+            // the image writers are plain software encoders; only the
+            // readback that produced the image needed the render thread
+            irr::video::IImageWriter* writer = FindImageWriter(state->driver, job.fileName);
+            if( !writer )
+            {
+                LOG_F_ERROR( "render", "no image writer for " << job.fileName );
+                job.image->drop();
+                continue;
+            }
+
+            irr::io::IWriteFile* file = state->fileSystem->createAndWriteFile(job.fileName.c_str());
+            if( !file )
+            {
+                LOG_F_ERROR( "render", "could not open capture file " << job.fileName );
+                job.image->drop();
+                continue;
+            }
+
+            if( !writer->writeImage(file, job.image, 0) )
+            {
+                LOG_F_ERROR( "render", "could not write frame " << job.fileName );
+            }
+            file->drop();
+            job.image->drop();
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,98 @@
+//--------------------------------------------------------
+// OpenNero : FrameCapture
+//  asynchronous framebuffer capture and encoding
+//--------------------------------------------------------
+
+#ifndef _RENDER_FRAMECAPTURE_H_
+#define _RENDER_FRAMECAPTURE_H_
+
+#include <string>
+#include "core/ONTypes.h"
+
+namespace irr
+{
+    namespace video { class IVideoDriver; class IImage; }
+    namespace io { class IFileSystem; }
+}
+
+namespace OpenNero
+{
+    /// The asynchronous frame capture pipeline. The framebuffer readback
+    /// has to happen on the render thread, but encoding the pixels and
+    /// writing them to disk used to happen there too, freezing the
+    /// simulation for the duration of every snapshot. Captured frames now
+    /// go into a small bounded queue drained by a background encoder
+    /// thread, so a snapshot or a frame-sequence recording costs the
+    /// render thread only the readback; when the encoder falls behind,
+    /// new frames are dropped rather than stalling the tick.
+    class FrameCapture
+    {
+    public:
+
+        /// the process-wide capture pipeline
+        static FrameCapture& instance();
+
+        /// read back the current frame and queue it for background
+        /// encoding; the image format is picked from the file extension
+        /// @param driver the video driver to read the frame from
+        /// @param fileSystem the file system to create the output file in
+        /// @param fileName path of the image file to write
+        void CaptureFrame( irr::video::IVideoDriver* driver,
+                           irr::io::IFileSystem* fileSystem,
+                           const std::string& fileName );
+
+        /// Start capturing every rendered frame into numbered image
+        /// files. The prefix carries the extension: "capture/frame.png"
+        /// produces capture/frame000000.png, capture/frame000001.png and
+        /// so on (no extension defaults to .png). The numbered stills
+        /// assemble into a video with any standard encoder.
+        /// @param prefix path prefix (and extension) of the sequence
+        /// @return true if the recording was started
+        bool StartRecording( const std::string& prefix );
+
+        /// stop capturing frames; already queued frames still get written
+        void StopRecording();
+
+        /// is a frame sequence recording active?
+        bool IsRecording() const { return mRecording; }
+
+        /// called by the render loop once per finished frame to feed an
+        /// active recording
+        void OnFrameRendered( irr::video::IVideoDriver* driver,
+                              irr::io::IFileSystem* fileSystem );
+
+        /// drain the queue and stop the encoder thread
+        void Shutdown();
+
+    private:
+
+        /// the bounded frame queue and the encoder thread (in the .cpp)
+        struct EncoderState;
+
+        FrameCapture();
+        ~FrameCapture();
+        FrameCapture( const FrameCapture& );            // not copyable
+        FrameCapture& operator=( const FrameCapture& ); // not copyable
+
+        /// hand a frame to the encoder thread, starting it on first use;
+        /// takes over the image reference
+        void QueueFrame( irr::video::IImage* image,
+                         irr::video::IVideoDriver* driver,
+                         irr::io::IFileSystem* fileSystem,
+                         const std::string& fileName );
+
+        /// the encoder thread: write queued frames until asked to exit
+        static void EncoderLoop( EncoderState* state );
+
+    private:
+
+        EncoderState* mEncoder;      ///< background encoder (NULL until first use)
+        bool          mRecording;    ///< is a frame sequence recording active?
+        std::string   mSequenceBase; ///< file name prefix of the sequence
+        std::string   mSequenceExt;  ///< extension of the sequence frames
+        U32           mFrameIndex;   ///< next frame number in the sequence
+    };
+
+} //end OpenNero
+
+#endif // _RENDER_FRAMECAPTURE_H_
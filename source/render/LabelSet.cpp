@@ -0,0 +1,100 @@
+//--------------------------------------------------------
+// OpenNero : LabelSet
+//  batched per-entity text overlays
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "render/LabelSet.h"
+#include "game/Kernel.h"
+#include "game/SimContext.h"
+
+namespace OpenNero
+{
+    /// Singleton access
+    LabelSet& LabelSet::instance()
+    {
+		static LabelSet label_set;
+		return label_set;
+    }
+
+    /// Ctor - nothing to set up; labels arrive through SetLabel
+    LabelSet::LabelSet()
+        : mRenderEnabled( true )
+    {
+    }
+
+    /// Add or update the label of an entity
+    void LabelSet::SetLabel( SimId id, const std::string& text,
+                             const SimEntityData* data, float32_t heightOffset )
+    {
+        Assert( data );
+
+        Label& label = mLabels[id];
+        label.text = irr::core::stringw( text.c_str() );
+        label.data = data;
+        label.heightOffset = heightOffset;
+    }
+
+    /// Remove the label of an entity (no-op if it has none)
+    void LabelSet::RemoveLabel( SimId id )
+    {
+        mLabels.erase( id );
+    }
+
+    /// Remove every label
+    void LabelSet::ClearLabels()
+    {
+        mLabels.clear();
+    }
+
+    /// Draw all the labels in one overlay pass. Every glyph comes from the
+    /// font's single atlas texture, so the whole pass runs without state
+    /// switches between labels.
+    void LabelSet::Render( irr::scene::ISceneManager* mgr ) const
+    {
+        using namespace irr;
+        using namespace irr::core;
+
+        if( !mRenderEnabled || mLabels.empty() )
+            return;
+
+        scene::ICameraSceneNode* camera = mgr->getActiveCamera();
+        if( !camera )
+            return;
+
+        gui::IGUIFont* font = Kernel::GetSimContext()->GetFont();
+        if( !font )
+            return;
+
+        scene::ISceneCollisionManager* coll = mgr->getSceneCollisionManager();
+        const video::SColor kLabelColor(255,255,255,255);
+
+        LabelMap::const_iterator itr = mLabels.begin();
+        LabelMap::const_iterator end = mLabels.end();
+
+        for( ; itr != end; ++itr )
+        {
+            const Label& label = itr->second;
+
+            // pull the entity's current position from its shared state
+            Vector3f pos = ConvertNeroToIrrlichtPosition( label.data->GetPosition() );
+            pos.Y += label.heightOffset;
+
+            const position2d<s32> screen =
+                coll->getScreenCoordinatesFrom3DPosition( pos, camera );
+
+            // positions behind the camera project to (-10000,-10000)
+            if( screen.X == -10000 && screen.Y == -10000 )
+                continue;
+
+            const dimension2d<u32> dim = font->getDimension( label.text.c_str() );
+            const rect<s32> area( screen.X - (s32)dim.Width / 2,
+                                  screen.Y - (s32)dim.Height,
+                                  screen.X + (s32)dim.Width / 2,
+                                  screen.Y );
+
+            font->draw( label.text, area, kLabelColor );
+        }
+    }
+
+} // end OpenNero
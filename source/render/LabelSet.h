@@ -0,0 +1,76 @@
+//--------------------------------------------------------
+// OpenNero : LabelSet
+//  batched per-entity text overlays
+//--------------------------------------------------------
+
+#ifndef _GAME_RENDER_LABEL_SET_H_
+#define _GAME_RENDER_LABEL_SET_H_
+
+#include "core/ONTypes.h"
+#include "core/IrrUtil.h"
+#include "game/SimEntityData.h"
+
+#include <map>
+
+namespace OpenNero
+{
+    /**
+     * The LabelSet collects the text labels of all entities and draws them
+     * in one overlay pass from NeroDrawNode. The old per-entity text scene
+     * nodes cost a node registration, transform update and material switch
+     * per agent per frame, which halved the frame rate with labels on a
+     * hundred agents; here each label is just a projected position and a
+     * font draw from the font's single glyph atlas. Positions are pulled
+     * from the entities' shared SimEntityData at render time, so a labeled
+     * entity costs nothing between renders.
+     */
+    class LabelSet
+    {
+    public:
+
+        // singleton access
+        static LabelSet& instance();
+
+    public:
+
+        LabelSet();
+
+        // label management, keyed by entity id
+        void SetLabel( SimId id, const std::string& text,
+                       const SimEntityData* data, float32_t heightOffset );
+        void RemoveLabel( SimId id );
+        void ClearLabels();
+
+        // draw all the labels to the screen in one pass
+        void Render( irr::scene::ISceneManager* mgr ) const;
+
+        /// show or hide the overlay without touching the labels
+        /// (the tick governor sheds it under load)
+        void SetRenderEnabled( bool enabled ) { mRenderEnabled = enabled; }
+
+        /// true iff the overlay is drawn
+        bool IsRenderEnabled() const { return mRenderEnabled; }
+
+    private:
+
+        /// one entity's label
+        struct Label
+        {
+            irr::core::stringw      text;           ///< converted once at SetLabel time
+            const SimEntityData*    data;           ///< where to pull the position from
+            float32_t               heightOffset;   ///< lift above the entity (irr Y units)
+        };
+
+        /// labels by entity id
+        typedef std::map< SimId, Label > LabelMap;
+
+    private:
+
+        LabelMap mLabels;   ///< every labeled entity in the visible context
+
+        bool mRenderEnabled; ///< draw the overlay? (shed under load)
+    };
+
+} // end OpenNero
+
+#endif // _GAME_RENDER_LABEL_SET_H_
@@ -1,71 +1,73 @@
-//--------------------------------------------------------
-// OpenNero : LineSet
-//  A collection of line segments in the world
-//--------------------------------------------------------
-
-#include "core/Common.h"
-#include "render/LineSet.h"
-
-namespace OpenNero
-{   
-    LineSet::LineSegment::LineSegment( const Vector3f& start, const Vector3f& end, const LineColor& color )
-        : mStart(start)
-        , mEnd(end)
-        , mColor(color)
-    {}
-
-
-
-    /// Singleton access
-    LineSet& LineSet::instance()
-    {
-		static LineSet line_set;
-		return line_set;
-    }
-
-    /// Ctor - setup the lineset material
-    LineSet::LineSet()
-    {
-        // setup the material for linesets
-        mMaterial.MaterialType = irr::video::EMT_SOLID;
-        mMaterial.Lighting     = false;
-    }
-
-    /// Add a line segment to our list
-    void LineSet::AddSegment( const Vector3f& start, const Vector3f& end, const LineColor& color )
-    {
-        mLineSegments.push_back( LineSegment(start,end,color) );
-    }
-
-    /// Remove all of the currently stored line segments
-    void LineSet::ClearSegments()
-    {
-        mLineSegments.clear();
-    }
-
-    /// Draw our stored line segments to the screen
-    void LineSet::Render( irr::video::IVideoDriver* driver ) const
-    {
-        using namespace irr;
-        using namespace video;
-        using namespace core;
-
-        // setup the render state
-        driver->setTransform( ETS_WORLD, matrix4( matrix4::EM4CONST_IDENTITY ) );
-        driver->setMaterial(mMaterial);
-
-        // render the line segments
-        LineSegmentList::const_iterator citr = mLineSegments.begin();
-        LineSegmentList::const_iterator cend = mLineSegments.end();
-
-        for( ; citr != cend; ++citr )
-        {   
-            // segments are assumed to be passed in OpenNero coordinate system,
-            // so convert to irrlicht system to draw
-            driver->draw3DLine( ConvertNeroToIrrlichtPosition(citr->mStart), 
-                                ConvertNeroToIrrlichtPosition(citr->mEnd), 
-                                citr->mColor );
-        }
-    }
-    
-};//end OpenNero
+//--------------------------------------------------------
+// OpenNero : LineSet
+//  A collection of line segments in the world
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "render/LineSet.h"
+
+namespace OpenNero
+{
+    /// Singleton access
+    LineSet& LineSet::instance()
+    {
+		static LineSet line_set;
+		return line_set;
+    }
+
+    /// Ctor - setup the lineset material
+    LineSet::LineSet()
+        : mRenderEnabled( true )
+    {
+        // setup the material for linesets
+        mMaterial.MaterialType = irr::video::EMT_SOLID;
+        mMaterial.Lighting     = false;
+    }
+
+    /// Add a line segment to our list
+    void LineSet::AddSegment( const Vector3f& start, const Vector3f& end, const LineColor& color )
+    {
+        // segments are assumed to be passed in OpenNero coordinate system,
+        // so convert to irrlicht system at append time
+        irr::video::S3DVertex v;
+        v.Color  = color;
+
+        v.Pos = ConvertNeroToIrrlichtPosition(start);
+        mVertices.push_back(v);
+
+        v.Pos = ConvertNeroToIrrlichtPosition(end);
+        mVertices.push_back(v);
+    }
+
+    /// Remove all of the currently stored line segments
+    void LineSet::ClearSegments()
+    {
+        // keeps the capacity, so next frame's appends reuse the storage
+        mVertices.clear();
+    }
+
+    /// Draw our stored line segments to the screen in a single batch
+    void LineSet::Render( irr::video::IVideoDriver* driver ) const
+    {
+        using namespace irr;
+        using namespace video;
+        using namespace core;
+
+        if( !mRenderEnabled || mVertices.empty() )
+            return;
+
+        // extend the sequential index batch past the high-water mark if needed
+        while( mIndices.size() < mVertices.size() )
+            mIndices.push_back( (u32)mIndices.size() );
+
+        // setup the render state
+        driver->setTransform( ETS_WORLD, matrix4( matrix4::EM4CONST_IDENTITY ) );
+        driver->setMaterial(mMaterial);
+
+        // render all the line segments as one primitive batch
+        driver->drawVertexPrimitiveList( &mVertices[0], (u32)mVertices.size(),
+                                         &mIndices[0], (u32)mVertices.size() / 2,
+                                         EVT_STANDARD, scene::EPT_LINES, EIT_32BIT );
+    }
+
+};//end OpenNero
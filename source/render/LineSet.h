@@ -36,29 +36,37 @@ namespace OpenNero
         // draw the segments to the screen
         void Render( irr::video::IVideoDriver* driver ) const;
 
-    private:
+        /// show or hide the overlay without touching the segments
+        /// (the tick governor sheds it under load)
+        void SetRenderEnabled( bool enabled ) { mRenderEnabled = enabled; }
+
+        /// true iff the overlay is drawn
+        bool IsRenderEnabled() const { return mRenderEnabled; }
 
-        /// an individual line segment entry
-        struct LineSegment
-        {
-            Vector3f            mStart; ///< The start of the line segment
-            Vector3f            mEnd;   ///< The end of the line segment
-            LineColor           mColor; ///< The color of the line segment
+    private:
 
-            LineSegment() {}
-            LineSegment( const Vector3f& start, const Vector3f& end, const LineColor& color );
-        };
+        /// the vertex batch reused from frame to frame (two vertices per segment)
+        typedef std::vector<irr::video::S3DVertex> VertexBatch;
 
-        /// a collection of line segments
-        typedef std::vector<LineSegment> LineSegmentList;
+        /// the index batch; sequential, grown only past the high-water mark
+        typedef std::vector<irr::u32> IndexBatch;
 
     private:
 
-        /// our current line segments
-        LineSegmentList         mLineSegments;
+        /// segment vertices, already converted to the Irrlicht coordinate
+        /// system; cleared each frame but the capacity is kept so appends
+        /// are O(1) after warm-up
+        VertexBatch             mVertices;
+
+        /// sequential indices covering the vertex batch; only extended when
+        /// the vertex count exceeds its previous high-water mark
+        mutable IndexBatch      mIndices;
 
         /// the material to use for our line segments
         irr::video::SMaterial   mMaterial;
+
+        /// draw the overlay? (shed under load)
+        bool                    mRenderEnabled;
     };
 
 };//end OpenNero
@@ -6,6 +6,7 @@
 #include "core/Common.h"
 #include "render/NeroDrawNode.h"
 #include "render/LineSet.h"
+#include "render/LabelSet.h"
 
 namespace OpenNero
 {   
@@ -29,6 +30,9 @@ namespace OpenNero
     {
         // draw our lineset
         LineSet::instance().Render( SceneManager->getVideoDriver() );
+
+        // draw every entity label in one overlay pass
+        LabelSet::instance().Render( SceneManager );
     }
     
     const core::aabbox3df& NeroDrawNode::getBoundingBox() const
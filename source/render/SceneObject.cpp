@@ -8,6 +8,7 @@
 #include "render/SceneObject.h"
 #include "render/Shader.h"
 #include "render/LineSet.h"
+#include "render/LabelSet.h"
 #include "render/Camera.h"
 #include "game/factories/SimFactory.h"
 #include "game/factories/IrrFactory.h"
@@ -190,7 +191,27 @@ namespace OpenNero
                  s32& outTriangleCount, const core::aabbox3d<f32>& box,
                  const core::matrix4* transform=0) const
             {
-                 GetTriangleSelector()->getTriangles(triangles, arraySize, outTriangleCount, transform);
+                // broadphase: let the simulation's spatial grid prune the
+                // matching entities down to those whose boxes overlap the
+                // query, and run the triangle-accurate narrow phase only on
+                // the survivors (the box used to be dropped here, so every
+                // collision check walked the whole world's triangles)
+                SimEntityList candidates;
+                Kernel::GetSimContext()->getSimulation()->
+                    QueryCollisionCandidates(box, (uint32_t)mTypeMask, candidates);
+
+                s32 written = 0;
+                SimEntityList::const_iterator itr;
+                for (itr = candidates.begin(); itr != candidates.end() && written < arraySize; ++itr)
+                {
+                    ITriangleSelector_IPtr selector = (*itr)->GetSceneObject()->GetTriangleSelector();
+                    if (!selector)
+                        continue;
+                    s32 received = 0;
+                    selector->getTriangles(triangles + written, arraySize - written, received, box, transform);
+                    written += received;
+                }
+                outTriangleCount = written;
             }
 
             void getTriangles(core::triangle3df* triangles, s32 arraySize,
@@ -281,8 +302,13 @@ namespace OpenNero
     , mTextures(objTempl.mTextures)
     , mMaterialType(objTempl.mMaterialType)
     , mHeightmap(objTempl.mHeightmap)
+    , mTerrainMaxLOD(objTempl.mTerrainMaxLOD)
+    , mTerrainPatchSize(objTempl.mTerrainPatchSize)
+    , mTerrainLODDistances(objTempl.mTerrainLODDistances)
+    , mTerrainCollisionLOD(objTempl.mTerrainCollisionLOD)
     , mParticleSystem(objTempl.mParticleSystem)
     , mAniMesh(objTempl.mAniMesh)
+    , mStaticGeometry(objTempl.mStaticGeometry)
     , mCastsShadow(objTempl.mCastsShadow)
     , mDrawBoundingBox(objTempl.mDrawBoundingBox)
     , mDrawLabel(objTempl.mDrawLabel)
@@ -316,8 +342,13 @@ namespace OpenNero
     mMaterialFlags(),
     mMaterialType( EMT_SOLID ),
     mHeightmap(),
+    mTerrainMaxLOD(5),
+    mTerrainPatchSize(17),
+    mTerrainLODDistances(),
+    mTerrainCollisionLOD(0),
     mParticleSystem(),
     mAniMesh(NULL),
+    mStaticGeometry(false),
     mCastsShadow(false),
     mDrawBoundingBox(false),
     mDrawLabel(false),
@@ -334,6 +365,16 @@ namespace OpenNero
         if( propMap.getValue( aniMeshFile, "Template.Render.AniMesh" ) )
         {
             mAniMesh = irrFac.LoadAniMesh( aniMeshFile.c_str() );
+
+            // single-frame meshes never rewrite their vertex data, so they
+            // default to staying resident in video memory; the template can
+            // override either way with Template.Render.StaticGeometry
+            mStaticGeometry = mAniMesh && mAniMesh->getFrameCount() <= 1;
+        }
+
+        if( propMap.hasSection( "Template.Render.StaticGeometry" ) )
+        {
+            propMap.getValue( mStaticGeometry, "Template.Render.StaticGeometry" );
         }
 
         if( propMap.hasSection( "Template.Render.CastsShadow" ) )
@@ -371,6 +412,30 @@ namespace OpenNero
         // get the heightmap (possibly)
         propMap.getValue( mHeightmap, "Template.Render.Terrain" );
 
+        // terrain level-of-detail tuning (optional): how many geomipmap LOD
+        // levels to generate, how big each patch is, and how coarse a mesh
+        // collision queries run against
+        if( propMap.hasSection( "Template.Render.TerrainMaxLOD" ) )
+        {
+            propMap.getValue( mTerrainMaxLOD, "Template.Render.TerrainMaxLOD" );
+        }
+
+        if( propMap.hasSection( "Template.Render.TerrainPatchSize" ) )
+        {
+            propMap.getValue( mTerrainPatchSize, "Template.Render.TerrainPatchSize" );
+        }
+
+        if( propMap.hasSection( "Template.Render.TerrainCollisionLOD" ) )
+        {
+            propMap.getValue( mTerrainCollisionLOD, "Template.Render.TerrainCollisionLOD" );
+            if( mTerrainCollisionLOD < 0 || mTerrainCollisionLOD >= mTerrainMaxLOD )
+            {
+                LOG_F_WARNING( "render", "terrain collision LOD " << mTerrainCollisionLOD
+                    << " out of range, using full detail" );
+                mTerrainCollisionLOD = 0;
+            }
+        }
+
         // get the particle system (possibly)
         propMap.getValue( mParticleSystem, "Template.Render.ParticleSystem" );
 
@@ -393,6 +458,22 @@ namespace OpenNero
                 }
             }
 
+            // if it starts with "TerrainLODDistance" (ex: TerrainLODDistance1, TerrainLODDistance2, ...)
+            // it overrides the camera distance at which that LOD level takes over
+            if( itr->first.find("TerrainLODDistance") == 0 )
+            {
+                std::istringstream levelStream( itr->first.substr(18) );
+                S32 level = -1;
+                float64_t distance = 0;
+                if( levelStream >> level && level >= 0 )
+                {
+                    std::istringstream( itr->second ) >> distance;
+                    if( (size_t)level >= mTerrainLODDistances.size() )
+                        mTerrainLODDistances.resize( level + 1, 0 );
+                    mTerrainLODDistances[level] = distance;
+                }
+            }
+
             // if it contains the word "MaterialFlag" in it( ex: MaterialFlagLighting, ... )
             if( itr->first.find("MaterialFlag") != std::string::npos )
             {
@@ -445,11 +526,11 @@ namespace OpenNero
     , mAniSceneNode(NULL)
     , mTerrSceneNode(NULL)
     , mParticleSystemNode(NULL)
-    , mTextNode(NULL)
     , mSceneObjectTemplate()
     , mStartFrame(0)
     , mEndFrame(0)
     , mAnimation()
+    , mDisplayStale(false)
     {}
 
     /**
@@ -461,24 +542,40 @@ namespace OpenNero
         , mAniSceneNode(NULL)
         , mTerrSceneNode(NULL)
         , mParticleSystemNode(NULL)
-        , mTextNode(NULL)
         , mSceneObjectTemplate()
         , mStartFrame(0)
         , mEndFrame(0)
         , mAnimation()
+        , mDisplayStale(false)
     {
         // TODO : Add this if needed (be pointer safe)
         Assert(false);
     }
 
+    bool SceneObject::sBulkTeardown = false;
+
     /// dtor
     SceneObject::~SceneObject()
     {
+        // during a bulk teardown the whole scene graph and the label
+        // overlay are dropped wholesale by the caller; per-node removal
+        // here would only re-walk a scene that is about to disappear
+        if (sBulkTeardown)
+        {
+            return;
+        }
+
         if (mFPSCamera && mCamera)
         {
             mCamera->detach();
         }
 
+        // drop our label from the batched overlay pass
+        if (mSharedData)
+        {
+            LabelSet::instance().RemoveLabel(mSharedData->GetId());
+        }
+
         // allow irrlicht to clean up
         if( mSceneNode )
         {
@@ -521,28 +618,60 @@ namespace OpenNero
         // are we an animated mesh?
         if( mSceneObjectTemplate->mAniMesh )
         {
-            mAniSceneNode = irrFactory.addAnimatedMeshSceneNode( mSceneObjectTemplate->mAniMesh.get() );
-            if (mSceneObjectTemplate->mCastsShadow)
+            // single-frame meshes with no per-node display state are drawn
+            // through the shared instancing batch for their mesh instead of
+            // getting a full independent scene node each
+            const bool instanced =
+                mSceneObjectTemplate->mAniMesh->getFrameCount() <= 1 &&
+                !mSceneObjectTemplate->mCastsShadow &&
+                !mSceneObjectTemplate->mFPSCamera &&
+                mSceneObjectTemplate->mTextures.empty() &&
+                mSceneObjectTemplate->mMaterialFlags.empty();
+
+            if( instanced )
             {
-                mAniSceneNode->addShadowVolumeSceneNode();
+                mSceneNode = irrFactory.addInstancedMeshSceneNode( mSceneObjectTemplate->mAniMesh.get() );
             }
-            mFPSCamera = mSceneObjectTemplate->mFPSCamera; // reminder to attach camera later
+            else
+            {
+                mAniSceneNode = irrFactory.addAnimatedMeshSceneNode( mSceneObjectTemplate->mAniMesh.get(),
+                                                                     mSceneObjectTemplate->mStaticGeometry );
+                if (mSceneObjectTemplate->mCastsShadow)
+                {
+                    mAniSceneNode->addShadowVolumeSceneNode();
+                }
+                mFPSCamera = mSceneObjectTemplate->mFPSCamera; // reminder to attach camera later
 
-			mAniSceneNode->setAnimationSpeed(0);
-            mStartFrame = mAniSceneNode->getStartFrame();
-            mEndFrame = mAniSceneNode->getEndFrame();
-            mAniSceneNode->setFrameLoop(0,0);
-            mAniSceneNode->setCurrentFrame(0);
+                mAniSceneNode->setAnimationSpeed(0);
+                mStartFrame = mAniSceneNode->getStartFrame();
+                mEndFrame = mAniSceneNode->getEndFrame();
+                mAniSceneNode->setFrameLoop(0,0);
+                mAniSceneNode->setCurrentFrame(0);
 
-			mSceneNode = mAniSceneNode;
+                mSceneNode = mAniSceneNode;
+            }
         }
 
         // are we a terrain?
         else if( mSceneObjectTemplate->mHeightmap != "" )
         {
-            mTerrSceneNode = irrFactory.addTerrainSceneNode( mSceneObjectTemplate->mHeightmap.c_str() );
+            mTerrSceneNode = irrFactory.addTerrainSceneNode( mSceneObjectTemplate->mHeightmap.c_str(),
+                                                             mSceneObjectTemplate->mTerrainMaxLOD,
+                                                             mSceneObjectTemplate->mTerrainPatchSize );
             mSceneNode     = mTerrSceneNode;
             mTerrSceneNode->scaleTexture( mSceneObjectTemplate->mScaleTexture.X, mSceneObjectTemplate->mScaleTexture.Y );
+
+            // override the camera distances at which the coarser LOD levels
+            // take over, so large outdoor maps drop to low-detail patches
+            // sooner than the Irrlicht defaults would
+            for( size_t lod = 0; lod < mSceneObjectTemplate->mTerrainLODDistances.size(); ++lod )
+            {
+                float64_t distance = mSceneObjectTemplate->mTerrainLODDistances[lod];
+                if( distance > 0 )
+                {
+                    mTerrSceneNode->overrideLODDistance( (S32)lod, distance );
+                }
+            }
         }
 
         // are we a particle system?
@@ -645,32 +774,31 @@ namespace OpenNero
 
     void SceneObject::SetText(const std::string& str)
     {
+        // labels go through the batched overlay pass in NeroDrawNode (see
+        // LabelSet); a text scene node per agent does not scale past a few
+        // dozen labeled agents
+        Assert( mSharedData );
+
         if (str.empty())
         {
-            if (mTextNode)
-            {
-                mTextNode->remove();
-                mTextNode = NULL;
-            }
+            LabelSet::instance().RemoveLabel(mSharedData->GetId());
         }
         else
         {
-            if (!mTextNode)
-            {
-                Font* f = Kernel::GetSimContext()->GetFont();
-                BBoxf bbox = mSceneNode->getTransformedBoundingBox();
-                float dY = bbox.MaxEdge.Y - bbox.MinEdge.Y;
-                mTextNode = GetSceneManager()->addTextSceneNode
-                    (f, 
-                     core::stringw(str.c_str()).c_str(), 
-                     SColor(255,255,255,255), 
-                     mSceneNode.get(), 
-                     Vector3f(0,1.25 * dY,0));
-            }
-            else
-            {
-                mTextNode->setText(irr::core::stringw(str.c_str()).c_str());
-            }
+            BBoxf bbox = mSceneNode->getTransformedBoundingBox();
+            float dY = bbox.MaxEdge.Y - bbox.MinEdge.Y;
+            LabelSet::instance().SetLabel(mSharedData->GetId(), str,
+                                          mSharedData, 1.25f * dY);
+        }
+    }
+
+    /// show or hide the underlying scene node without touching the
+    /// simulation state (used when the owning context is suspended)
+    void SceneObject::SetSceneVisible(bool visible)
+    {
+        if (mSceneNode)
+        {
+            mSceneNode->setVisible(visible);
         }
     }
 
@@ -679,6 +807,22 @@ namespace OpenNero
         return mCollider && mCollider->collisionOccurred();
     }
 
+    /// world position of the most recent collision contact
+    Vector3f SceneObject::getCollisionPoint() const
+    {
+        Assert( mCollider );
+        return ConvertIrrlichtToNeroPosition( mCollider->getCollisionPoint() );
+    }
+
+    /// scene id of the node hit in the most recent collision, or -1 if
+    /// Irrlicht did not record one
+    S32 SceneObject::getCollisionSceneId() const
+    {
+        Assert( mCollider );
+        ISceneNode* node = mCollider->getCollisionNode();
+        return node ? node->getID() : -1;
+    }
+
     /// can we possibly collide with any other object?
     bool SceneObject::canCollide() const
     {
@@ -694,65 +838,113 @@ namespace OpenNero
         // set the position and rotation of our object
         if( mSceneNode )
         {
+            // static scenery early-out: if no published state changed and
+            // no per-frame display work (bounding box, pending camera
+            // attach) is needed, don't touch the scene node at all
+            if( mSharedData->GetSnapshotDirtyBits() == 0 &&
+                !mDisplayStale &&
+                !( mSceneObjectTemplate && mSceneObjectTemplate->mDrawBoundingBox ) &&
+                !( mFPSCamera && !mCamera ) )
+            {
+                return;
+            }
+
+            // read only the snapshot published by the simulation tick; the
+            // live state may already be mutating under a decoupled tick
+            const SimEntityData::SimEntityInternals& snapshot = mSharedData->GetSnapshot();
+
             // Note: jsheblak 28July2007
             // Setting the position of some large meshes in irrlicht every frame
             // causes them to flicker or disappear. Compare the position first and
             // update if necessary.
-            if( mSharedData->IsDirty(SimEntityData::kDB_Position) )
+            if( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Position) )
             {
                 // convert from open nero's coordinate system to irrlicht's
-                SetPosition( mSharedData->GetPosition() );
+                SetPosition( snapshot.mPosition );
                 // the position is set here, but it might change after drawAll because of collisions etc
                 // thus, the next time we see this sceneNode, we should make sure to get the position back
                 // to the state.
             }
 
-            if( mSharedData->IsDirty(SimEntityData::kDB_Rotation) )
+            if( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Rotation) )
             {
                 // Irrlicht expects a left handed basis with the x-z plane being horizontal and y being up
                 // OpenNero uses a right handed basis with x-y plane being horizontal and z being up
-                SetRotation( mSharedData->GetRotation() );
+                SetRotation( snapshot.mRotation );
 
             }
 
-            if ( mSharedData->IsDirty(SimEntityData::kDB_Scale) )
+            if ( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Scale) )
             {
                 // set the node scale
                 Vector3f scale = mSceneObjectTemplate->mScale;
                 /// we can optionally multiply by a custom scale
-                scale.X = scale.X * mSharedData->GetScale().X;
-                scale.Y = scale.Y * mSharedData->GetScale().Y;
-                scale.Z = scale.Z * mSharedData->GetScale().Z;
+                scale.X = scale.X * snapshot.mScale.X;
+                scale.Y = scale.Y * snapshot.mScale.Y;
+                scale.Z = scale.Z * snapshot.mScale.Z;
                 // convert from open nero's coordinate system to irrlicht's
                 mSceneNode->setScale( ConvertNeroToIrrlichtPosition(scale) );
             }
 
-            if ( mSharedData->IsDirty(SimEntityData::kDB_Label) && mSceneObjectTemplate->mDrawLabel )
-            {
-                SetText(mSharedData->GetLabel());
-            }
-
-            if ( mSharedData->IsDirty(SimEntityData::kDB_Color) )
+            // display-only updates are skipped in headless mode - only the
+            // transforms above are needed for collisions and sensor rays
+            if ( !Kernel::GetSimContext()->IsHeadless() )
             {
-                if (mAniSceneNode) {
-                    // The above workaround is not necessary anymore in Irrlicht 1.5
-                    mAniSceneNode->getMaterial(0).DiffuseColor = mSharedData->GetColor();
+                // visibility-aware ticking: an entity outside the camera
+                // frustum keeps the exact transforms above (collisions and
+                // sensor rays read them) but defers the purely visual
+                // updates until it comes back on screen
+                const BBoxf irrBox = mSceneNode->getTransformedBoundingBox();
+                const bool visible = Camera::IsSphereVisible(
+                    irrBox.getCenter(), irrBox.getExtent().getLength() * 0.5f );
+
+                if ( !visible &&
+                     ( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Label) ||
+                       mSharedData->IsSnapshotDirty(SimEntityData::kDB_Color) ) )
+                {
+                    // remember to re-apply label and color when visible again
+                    mDisplayStale = true;
                 }
-            }
 
-            // add our bounding box to the lineset
-            if( mSceneNode && mSceneObjectTemplate->mDrawBoundingBox )
-            {
-                BBoxf bbox = getTransformedBoundingBox();
-                DrawBBox(bbox, LineSet::LineColor(255,0,255,0));
-            }
+                if ( visible )
+                {
+                    if ( ( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Label) || mDisplayStale )
+                         && mSceneObjectTemplate->mDrawLabel )
+                    {
+                        SetText(snapshot.mLabel);
+                    }
 
-            if (mFPSCamera && !mCamera)
-            {
-                Kernel::GetSimContext()->getActiveCamera()->attach(this->GetEntity(), mFPSCamera);
+                    if ( mSharedData->IsSnapshotDirty(SimEntityData::kDB_Color) || mDisplayStale )
+                    {
+                        if (mAniSceneNode) {
+                            // The above workaround is not necessary anymore in Irrlicht 1.5
+                            mAniSceneNode->getMaterial(0).DiffuseColor = snapshot.mColor;
+                        }
+                        else {
+                            // instanced proxies carry their color per instance
+                            IrrFactory::SetInstanceColor(mSceneNode.get(), snapshot.mColor);
+                        }
+                    }
+
+                    mDisplayStale = false;
+
+                    // add our bounding box to the lineset
+                    if( mSceneNode && mSceneObjectTemplate->mDrawBoundingBox )
+                    {
+                        BBoxf bbox = getTransformedBoundingBox();
+                        DrawBBox(bbox, LineSet::LineColor(255,0,255,0));
+                    }
+                }
+
+                // camera attachment is not display-only - do it even if the
+                // object happens to be offscreen when it is requested
+                if (mFPSCamera && !mCamera)
+                {
+                    Kernel::GetSimContext()->getActiveCamera()->attach(this->GetEntity(), mFPSCamera);
+                }
             }
 
-            mSharedData->ClearDirtyBits();
+            mSharedData->ClearSnapshotDirtyBits();
         }
     }
 
@@ -935,10 +1127,15 @@ namespace OpenNero
             // create triangle selector
             if (mTerrSceneNode)
             {
-                tri_selector = GetSceneManager()->createTerrainTriangleSelector(mTerrSceneNode.get());
+                // build the collision mesh at the configured LOD level: a
+                // coarser level keeps a fraction of the full-detail triangle
+                // count resident, which matters on large outdoor heightmaps
+                S32 collisionLOD = mSceneObjectTemplate ? mSceneObjectTemplate->mTerrainCollisionLOD : 0;
+                tri_selector = GetSceneManager()->createTerrainTriangleSelector(mTerrSceneNode.get(), collisionLOD);
                 AssertMsg(tri_selector, "Could not create a collision object for id: " << GetId());
                 mTerrSceneNode->setTriangleSelector(tri_selector.get());
-                LOG_F_DEBUG("collision", "created terrain triangle selector for id: " << GetId());
+                LOG_F_DEBUG("collision", "created terrain triangle selector for id: " << GetId()
+                    << " at LOD " << collisionLOD);
             }
             else if (mAniSceneNode)
             {
@@ -948,6 +1145,15 @@ namespace OpenNero
                 mAniSceneNode->setTriangleSelector(tri_selector.get());
                 LOG_F_DEBUG("collision", "creating mesh triangle selector for id: " << GetId());
             }
+            else if (mSceneObjectTemplate && mSceneObjectTemplate->mAniMesh)
+            {
+                // instanced proxy node: build the selector from the shared mesh
+                IMesh* mesh = mSceneObjectTemplate->mAniMesh->getMesh(0);
+                tri_selector = GetSceneManager()->createTriangleSelector(mesh, mSceneNode.get());
+                AssertMsg(tri_selector, "Could not create a collision object for id: " << GetId());
+                mSceneNode->setTriangleSelector(tri_selector.get());
+                LOG_F_DEBUG("collision", "creating shared mesh triangle selector for id: " << GetId());
+            }
             else
             {
                 tri_selector = GetSceneManager()->createTriangleSelectorFromBoundingBox(mSceneNode.get());
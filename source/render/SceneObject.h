@@ -77,8 +77,13 @@ namespace OpenNero
         std::vector<IrrMaterialFlag>    mMaterialFlags;     ///< the material flags
         IrrMaterialType                 mMaterialType;      ///< the type of the material
         std::string                     mHeightmap;         ///< heightmap to use (if terrain)
+        S32                             mTerrainMaxLOD;     ///< number of terrain LOD levels (if terrain)
+        S32                             mTerrainPatchSize;  ///< terrain geomipmap patch size (9/17/33/65/129)
+        std::vector<float64_t>          mTerrainLODDistances; ///< camera distance at which each LOD level kicks in (empty: Irrlicht defaults)
+        S32                             mTerrainCollisionLOD; ///< LOD level to build the terrain collision mesh at
         std::string                     mParticleSystem;    ///< Particle System File
         IAnimatedMesh_IPtr              mAniMesh;           ///< animated mesh to use (if valid)
+        bool                            mStaticGeometry;    ///< the mesh never changes: keep its buffers resident in video memory
         bool                            mCastsShadow;       ///< whether or not the object casts a shadow
         bool                            mDrawBoundingBox;   ///< whether or not to draw the object's bounding box
         bool                            mDrawLabel;         ///< whether or not to draw the object's label
@@ -115,6 +120,17 @@ namespace OpenNero
 
         virtual ~SceneObject();
 
+        /// @{
+        /// While a bulk teardown is in progress, SceneObject destructors
+        /// skip the per-node scene graph removal and label cleanup; the
+        /// caller promises to drop the whole scene (ISceneManager::clear)
+        /// and the label overlay wholesale right after. Used when flushing
+        /// a context, where removing thousands of nodes one at a time
+        /// dominates the shutdown time.
+        static void BeginBulkTeardown() { sBulkTeardown = true; }
+        static void EndBulkTeardown() { sBulkTeardown = false; }
+        /// @}
+
         /// load the scene object from a template
         bool LoadFromTemplate( ObjectTemplatePtr objTemplate, const SimEntityData& data );
 
@@ -142,6 +158,10 @@ namespace OpenNero
         /// set the rotation of this scene object
         void SetRotation(const Vector3f& rotation);
 
+        /// show or hide the underlying scene node without touching the
+        /// simulation state (used when the owning context is suspended)
+        void SetSceneVisible(bool visible);
+
         /// bounding box data
         BBoxf getBoundingBox() const;
 
@@ -187,6 +207,13 @@ namespace OpenNero
         /// return true if a collision was detected
         bool collisionOccurred();
 
+        /// world position of the most recent collision contact
+        Vector3f getCollisionPoint() const;
+
+        /// scene id of the node hit in the most recent collision, or -1
+        /// if Irrlicht did not record one
+        S32 getCollisionSceneId() const;
+
     private:
 
         // not sure we want to expose these.
@@ -206,7 +233,6 @@ namespace OpenNero
         ITerrainSceneNode_IPtr              mTerrSceneNode;         ///< Irr Terrain node
         IParticleSystemSceneNode*           mParticleSystemNode;    ///< Irr Particle System node
         ///@}
-        ITextSceneNode*                     mTextNode;              ///< optional text attached
 
         SceneObjectTemplatePtr              mSceneObjectTemplate;   ///< The template to use
 
@@ -215,9 +241,13 @@ namespace OpenNero
         CameraPtr                           mCamera;                ///< camera that is attached to us (if any)
 		FPSCameraTemplatePtr				mFPSCamera;			    ///< information about whether to attach a camera to this object
         std::string                         mAnimation;             ///< current animation
+        bool                                mDisplayStale;          ///< a visual update was skipped while offscreen
 
         /// collision response animator
         ISceneNodeAnimatorCollisionResponse_IPtr    mCollider;
+
+        /// set while a whole context is being torn down (see BeginBulkTeardown)
+        static bool sBulkTeardown;
     };
 
 };//end OpenNero
@@ -5,11 +5,36 @@
 #include <sstream>
 #include "experiments.h"
 #include "organism.h"
+#include "streamwriter.h"
 #include "network.h"
 
 using namespace NEAT;
 using namespace std;
 
+namespace
+{
+    // adapts pole2_evaluate to the parallel evaluation harness
+    struct Pole2Evaluator
+    {
+        bool velocity; //is velocity information fed to the networks?
+
+        explicit Pole2Evaluator(bool v) : velocity(v)
+        {
+        }
+
+        bool operator()(OrganismPtr org, CartPole* cart) const
+        {
+            return pole2_evaluate(org, velocity, cart);
+        }
+    };
+}
+
+OpenNero::TaskPool& NEAT::experiment_task_pool()
+{
+    static OpenNero::TaskPool pool;
+    return pool;
+}
+
 // ------------------------------------------------------------------ 
 // Double pole balacing                                               
 // ------------------------------------------------------------------ 
@@ -414,7 +439,7 @@ PopulationPtr NEAT::pole2_test(int gens, int velocity)
     int curtotal; //For averaging
     int samples; //For averaging
 
-    ofstream oFile("NERO/data/neat/statout.rtf");
+    StreamWriter oFile("NERO/data/neat/statout.rtf");
 
     champg=0;
     champn=0;
@@ -455,7 +480,7 @@ PopulationPtr NEAT::pole2_test(int gens, int velocity)
         pop.reset(new Population(start_genome,pop_size));
 
         // Open files by using the resource manager
-        ofstream outFile("nero/data/neat/gen_1.rtf");
+        StreamWriter outFile("nero/data/neat/gen_1.rtf");
         pop->print_to_file_by_species(outFile);
 
         //Alternative way to start off of randomly connected genomes
@@ -464,6 +489,10 @@ PopulationPtr NEAT::pole2_test(int gens, int velocity)
         //Create the Cart
         thecart=new CartPole(true,velocity != 0);
 
+        //scores cached in an earlier run (or for a different task
+        //configuration) must not leak into this one
+        FitnessCache::instance().clear();
+
         for (gen = 1; gen < 2; ++gen)
         {
 
@@ -664,16 +693,10 @@ int NEAT::pole2_epoch(PopulationPtr pop, int generation,
     thecart->nmarkov_long=false;
     thecart->generalization_test=false;
 
-    //Evaluate each organism on a test
-    for (curorg=(pop->organisms).begin(); curorg!=(pop->organisms).end(); ++curorg)
-    {
-
-    	assert((*curorg)->gnome);
-
-        if (pole2_evaluate(OrganismPtr(*curorg), velocity, thecart))
-            win=true;
-
-    }
+    //Evaluate each organism on a test, in parallel with one cart per worker
+    if (evaluate_population_parallel(pop, *thecart, Pole2Evaluator(velocity),
+                                     generation))
+        win=true;
 
     //Average and max their fitnesses for dumping to file and snapshot
     for (curspecies=(pop->species).begin(); curspecies!=(pop->species).end(); ++curspecies)
@@ -824,7 +847,7 @@ int NEAT::pole2_epoch(PopulationPtr pop, int generation,
     if (win || ((generation%(print_every))==0))
     {
         // Open files by using the resource manager
-        ofstream outFile(filename.c_str());
+        StreamWriter outFile(filename);
         pop->print_to_file_by_species(outFile);
     }
 
@@ -867,17 +890,10 @@ int NEAT::pole2_epoch_realtime(PopulationPtr pop, int generation,
     thecart->generalization_test=false;
 
     //Initially, we evaluate the whole population
-    //Evaluate each organism on a test
-    for (curorg=(pop->organisms).begin(); curorg!=(pop->organisms).end(); ++curorg)
-    {
-
-        //shouldn't happen
-    	assert((*curorg)->gnome);
-
-        if (pole2_evaluate(OrganismPtr(*curorg), velocity, thecart))
-            win=true;
-
-    }
+    //Evaluate each organism on a test, in parallel with one cart per worker
+    if (evaluate_population_parallel(pop, *thecart, Pole2Evaluator(velocity),
+                                     generation))
+        win=true;
 
     //Now create offspring one at a time, testing each offspring,
     // and replacing the worst with the new offspring if its better
@@ -906,8 +922,24 @@ int NEAT::pole2_epoch_realtime(PopulationPtr pop, int generation,
         new_org = (pop->choose_parent_species())->reproduce_one(offspring_count, pop, pop->species, 0, 0);
 
         //cout<<"Evaluating new baby: "<<endl;
-        if (pole2_evaluate(new_org, velocity, thecart))
-            win = true;
+        //clones of already-scored genomes are answered from the fitness
+        //cache; only genuinely new networks pay for a rollout
+        const unsigned long long baby_key = new_org->gnome->content_hash();
+        F64 cached_fitness;
+        bool cached_winner;
+        if (FitnessCache::instance().lookup(baby_key, cached_fitness, cached_winner))
+        {
+            new_org->fitness = cached_fitness;
+            new_org->winner = cached_winner;
+            if (cached_winner)
+                win = true;
+        }
+        else
+        {
+            if (pole2_evaluate(new_org, velocity, thecart))
+                win = true;
+            FitnessCache::instance().store(baby_key, new_org->fitness, new_org->winner);
+        }
 
         //Reestimate the baby's species fitness
         new_org->species.lock()->estimate_average();
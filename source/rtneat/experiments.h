@@ -1,11 +1,122 @@
 #ifndef _EXPERIMENTS_H_
 #define _EXPERIMENTS_H_
 
+#include <algorithm>
+#include <cassert>
+#include <boost/bind.hpp>
 #include "neat.h"
 #include "population.h"
+#include "fitnesscache.h"
+#include "core/TaskPool.h"
 
 namespace NEAT
 {
+    // The shared pool of evaluation worker threads, created on first use
+    OpenNero::TaskPool& experiment_task_pool();
+
+    // One worker's slice of a population evaluation: evaluates the
+    // organisms in [begin, end) against a worker-private copy of the
+    // evaluation domain (e.g. a CartPole), rekeying the worker's random
+    // stream per organism so results do not depend on which thread ran it.
+    template <typename Domain, typename Evaluator>
+    struct OrganismRangeEval
+    {
+        std::vector<OrganismPtr>* organisms; //the population's organism list
+        Domain domain;       //worker-private copy of the evaluation domain
+        Evaluator evaluate;  //callable bool(OrganismPtr, Domain*)
+        S32 generation;      //folded into the random stream key
+        size_t begin;        //first organism index in this slice
+        size_t end;          //one past the last organism index
+        bool win;            //did any organism in the slice win?
+
+        OrganismRangeEval(std::vector<OrganismPtr>* orgs, const Domain& d,
+                          Evaluator eval, S32 gen, size_t b, size_t e)
+            : organisms(orgs), domain(d), evaluate(eval), generation(gen),
+              begin(b), end(e), win(false)
+        {
+        }
+
+        void run()
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                OrganismPtr org = (*organisms)[i];
+                assert(org->gnome);
+                //genomes that decode to the same network score the same,
+                //so answer repeats (cloned champions, unmutated
+                //survivors) from the fitness cache instead of rolling out
+                const unsigned long long key = org->gnome->content_hash();
+                F64 cached_fitness;
+                bool cached_winner;
+                if (FitnessCache::instance().lookup(key, cached_fitness,
+                                                    cached_winner))
+                {
+                    org->fitness = cached_fitness;
+                    org->winner = cached_winner;
+                    if (cached_winner)
+                        win = true;
+                    continue;
+                }
+                reseed_rand_stream((U32)org->gnome->genome_id,
+                                   (U32)generation);
+                if (evaluate(org, &domain))
+                    win = true;
+                FitnessCache::instance().store(key, org->fitness,
+                                               org->winner);
+            }
+        }
+    };
+
+    // Evaluate every organism in the population in parallel on the
+    // experiment task pool. Each worker gets its own copy of the domain
+    // prototype, so mutable simulation scratch is never shared, and each
+    // organism is evaluated under a random stream keyed off its genome id
+    // and the generation, so the outcome is independent of the thread
+    // schedule. The evaluator must only touch its organism and its domain.
+    // Returns true if any organism won.
+    template <typename Domain, typename Evaluator>
+    bool evaluate_population_parallel(PopulationPtr pop, const Domain& prototype,
+                                      Evaluator evaluate, S32 generation)
+    {
+        typedef OrganismRangeEval<Domain, Evaluator> Range;
+
+        std::vector<OrganismPtr>& organisms = pop->organisms;
+        const size_t count = organisms.size();
+
+        OpenNero::TaskPool& pool = experiment_task_pool();
+        const size_t workers = pool.GetWorkerCount();
+
+        if (workers <= 1 || count < 2)
+        {
+            Range range(&organisms, prototype, evaluate, generation, 0, count);
+            range.run();
+            return range.win;
+        }
+
+        const size_t chunk = (count + workers - 1) / workers;
+        std::vector<Range> ranges;
+        ranges.reserve(workers);
+        for (size_t start = 0; start < count; start += chunk)
+        {
+            size_t stop = std::min(start + chunk, count);
+            ranges.push_back(Range(&organisms, prototype, evaluate,
+                                   generation, start, stop));
+        }
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            pool.Submit(boost::bind(&Range::run, &ranges[i]));
+        }
+        pool.WaitAll();
+
+        bool win = false;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            if (ranges[i].win)
+                win = true;
+        }
+        return win;
+    }
+
     class CartPole
     {
         public:
@@ -8,15 +8,55 @@
 using namespace NEAT;
 using namespace std;
 
+FactorTable& FactorTable::instance()
+{
+    static FactorTable table;
+    return table;
+}
+
+int FactorTable::intern(const std::string& record)
+{
+    map<string, int>::iterator found = _ids.find(record);
+    if (found != _ids.end())
+        return found->second;
+    int record_id = static_cast<int>(_records.size());
+    _records.push_back(record);
+    _ids[record] = record_id;
+    return record_id;
+}
+
+const std::string& FactorTable::lookup(int record_id) const
+{
+    assert(record_id >= 0 && record_id < static_cast<int>(_records.size()));
+    return _records[record_id];
+}
+
 Factor::Factor(const std::string& record, int id)
-    : _record(record), _id(id) 
+    : _id(id), _record_id(FactorTable::instance().intern(record))
 { }
 
+const std::string& Factor::record() const
+{
+    return FactorTable::instance().lookup(_record_id);
+}
+
+FactorPtr Factor::rollup(const std::vector<FactorPtr>& factors)
+{
+    assert(!factors.empty());
+    // the rollup takes the newest rolled-up factor's id, so repeated
+    // rollups keep compressing from the old end of the history
+    int newest = factors.back()->id();
+    ostringstream record;
+    record << "rollup of " << factors.size()
+           << " earlier factors through id " << newest;
+    return FactorPtr(new Factor(record.str(), newest));
+}
+
 void Factor::print_to_file(std::ofstream &outFile)
 {
     outFile << "factor ";
     outFile << _id;
     outFile << " ";
-    outFile << _record;
+    outFile << record();
     outFile << std::endl;
 }
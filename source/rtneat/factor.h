@@ -2,42 +2,90 @@
 #define _FACTOR_H_
 
 #include <vector>
+#include <map>
 #include <ostream>
 #include <string>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/serialization/split_member.hpp>
 #include "neat.h"
 #include "XMLSerializable.h"
 
 namespace NEAT
 {
-    /// A Factor is a record of an event in the genome's 
+    /// Intern table for factor records. Lineages share most of their
+    /// record text (every descendant inherits its ancestors' factors),
+    /// so the table stores each distinct record string once and hands
+    /// out small integer ids; factors hold ids instead of strings.
+    class FactorTable
+    {
+        std::map<std::string, int> _ids; ///< record text to interned id
+        std::vector<std::string> _records; ///< interned id to record text
+        FactorTable() {}
+    public:
+        /// singleton accessor
+        static FactorTable& instance();
+
+        /// intern a record, returning its id (existing id if already known)
+        int intern(const std::string& record);
+
+        /// look an interned record up by id
+        const std::string& lookup(int record_id) const;
+
+        /// number of distinct records interned so far
+        size_t size() const { return _records.size(); }
+    }; // class FactorTable
+
+    /// A Factor is a record of an event in the genome's
     /// history that has influenced its evolution.
-    class Factor 
+    class Factor
         : public boost::enable_shared_from_this<Factor>
         , public XMLSerializable
     {
         friend class boost::serialization::access;
         int _id; ///< id of this factor
-        std::string _record; ///< content of this factor
+        int _record_id; ///< interned id of this factor's record text
         Factor() {}
     public:
         /// Create a factor
-        /// @param record the contents of the factor
+        /// @param record the contents of the factor (interned on creation)
         /// @param id the id of the factor
         Factor(const std::string& record, int id);
 
         /// Destructor
         ~Factor() {}
 
+        /// id of this factor
+        int id() const { return _id; }
+
+        /// the record text of this factor
+        const std::string& record() const;
+
+        /// Summarize a list of factors into a single rollup factor, used
+        /// to cap the history a genome carries (see factor_history_depth)
+        static FactorPtr rollup(const std::vector<FactorPtr>& factors);
+
         /// Print this factor to a population file
         void print_to_file(std::ofstream &outFile);
 
-        /// serialize this factor to/from a Boost ser. archive
-        template<class Archive> void serialize
+        /// serialize this factor to a Boost ser. archive; archives carry
+        /// the record text, which is re-interned on load
+        template<class Archive> void save
+            (Archive & ar, const unsigned int version) const {
+            ar & BOOST_SERIALIZATION_NVP(_id);
+            std::string _record = record();
+            ar & BOOST_SERIALIZATION_NVP(_record);
+        }
+
+        /// deserialize this factor from a Boost ser. archive
+        template<class Archive> void load
             (Archive & ar, const unsigned int version) {
             ar & BOOST_SERIALIZATION_NVP(_id);
+            std::string _record;
             ar & BOOST_SERIALIZATION_NVP(_record);
+            _record_id = FactorTable::instance().intern(_record);
         }
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
     }; // class Factor
 
     std::ostream& operator<<(std::ostream& out, const FactorPtr& x);
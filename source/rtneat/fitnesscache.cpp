@@ -0,0 +1,90 @@
+#include "core/Common.h"
+#include "fitnesscache.h"
+
+using namespace NEAT;
+
+namespace
+{
+    //default number of scores kept; a pole sweep population is a few
+    //hundred organisms, so this spans many generations of survivors
+    const size_t default_capacity = 4096;
+}
+
+FitnessCache& FitnessCache::instance()
+{
+    static FitnessCache me;
+    return me;
+}
+
+FitnessCache::FitnessCache()
+    : lru_capacity(default_capacity)
+    , lru_hits(0)
+    , lru_misses(0)
+{
+}
+
+void FitnessCache::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    lru_capacity = capacity;
+    while (entries.size() > lru_capacity)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+bool FitnessCache::lookup(unsigned long long key, F64& fitness, bool& winner)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    std::map<unsigned long long, EntryList::iterator>::iterator found =
+        index.find(key);
+    if (found == index.end())
+    {
+        ++lru_misses;
+        return false;
+    }
+    //move the entry to the front so it is evicted last
+    entries.splice(entries.begin(), entries, found->second);
+    ++lru_hits;
+    fitness = entries.front().fitness;
+    winner = entries.front().winner;
+    return true;
+}
+
+void FitnessCache::store(unsigned long long key, F64 fitness, bool winner)
+{
+    std::lock_guard<std::mutex> lock(guard);
+    if (lru_capacity == 0)
+        return;
+    std::map<unsigned long long, EntryList::iterator>::iterator found =
+        index.find(key);
+    if (found != index.end())
+    {
+        //refresh the existing entry
+        entries.splice(entries.begin(), entries, found->second);
+        entries.front().fitness = fitness;
+        entries.front().winner = winner;
+        return;
+    }
+    Entry entry;
+    entry.key = key;
+    entry.fitness = fitness;
+    entry.winner = winner;
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    if (entries.size() > lru_capacity)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void FitnessCache::clear()
+{
+    std::lock_guard<std::mutex> lock(guard);
+    entries.clear();
+    index.clear();
+    lru_hits = 0;
+    lru_misses = 0;
+}
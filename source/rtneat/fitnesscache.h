@@ -0,0 +1,66 @@
+#ifndef _FITNESSCACHE_H_
+#define _FITNESSCACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include "neat.h"
+
+namespace NEAT
+{
+    // An LRU cache of fitness scores keyed by Genome::content_hash().
+    // Parameter sweeps re-evaluate many genomes that are byte-identical
+    // to previously scored ones (cloned champions, unmutated survivors);
+    // when the evaluation domain is deterministic for a given genome,
+    // the evaluation harness can look the score up here and skip the
+    // rollout. Thread-safe: the parallel harness workers share it.
+    class FitnessCache
+    {
+        public:
+            //singleton accessor
+            static FitnessCache& instance();
+
+            //change how many scores are kept (0 disables the cache)
+            void set_capacity(size_t capacity);
+
+            //look up a previously stored score
+            //returns true and fills fitness/winner on a hit
+            bool lookup(unsigned long long key, F64& fitness, bool& winner);
+
+            //store a freshly evaluated score, evicting the least
+            //recently used entry when the cache is full
+            void store(unsigned long long key, F64 fitness, bool winner);
+
+            //forget all scores (call when the evaluation task changes)
+            void clear();
+
+            //number of lookups answered from the cache
+            size_t hits() const { return lru_hits; }
+
+            //number of lookups that required a real evaluation
+            size_t misses() const { return lru_misses; }
+
+        private:
+            //one cached score
+            struct Entry
+            {
+                unsigned long long key; //genome content hash
+                F64 fitness;            //score of the evaluation
+                bool winner;            //did the organism win?
+            };
+
+            FitnessCache();
+
+            typedef std::list<Entry> EntryList;
+
+            size_t lru_capacity; //maximum number of scores kept
+            size_t lru_hits;     //lookups answered from the cache
+            size_t lru_misses;   //lookups that missed
+            EntryList entries;   //most recently used first
+            std::map<unsigned long long, EntryList::iterator> index; //key to entry
+            mutable std::mutex guard; //workers share the cache
+    };
+}
+
+#endif // _FITNESSCACHE_H_
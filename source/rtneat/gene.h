@@ -9,8 +9,9 @@
 
 namespace NEAT
 {
+    struct PoolStats;
 
-    class Gene : public XMLSerializable
+    class Gene : public XMLSerializable, public RefCounted<Gene>
     {
             friend class boost::serialization::access;
 
@@ -22,6 +23,15 @@ namespace NEAT
             bool enable; //When this is off the Gene is disabled
             bool frozen; //When frozen, the linkweight cannot be mutated
 
+            //Genes are allocated from a shared object pool (see
+            //objectpool.h) to keep reproduction churn away from
+            //the system allocator
+            static void* operator new(size_t size);
+            static void operator delete(void* p);
+
+            //Occupancy snapshot of the shared pool (see objectpool.h)
+            static PoolStats pool_stats();
+
             /// default constructor (0s everywhere)
             Gene();
 
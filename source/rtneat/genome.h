@@ -7,6 +7,10 @@
 #include <boost/enable_shared_from_this.hpp>
 #include "neat.h"
 #include "XMLSerializable.h"
+// the gene and trait vectors hold intrusive_ptrs, whose destructor
+// needs the complete types
+#include "gene.h"
+#include "trait.h"
 
 namespace NEAT
 {
@@ -45,6 +49,50 @@ namespace NEAT
 
             NetworkWeakPtr phenotype; //Allows Genome to be matched with its Network
 
+            // How the live phenotype (if any) relates to this genome, so
+            // genesis() can avoid rebuilding the whole network when nothing
+            // (or only weights and traits) changed since the last build.
+            enum PhenotypeState
+            {
+                PHENOTYPE_STALE,        // no network, or its topology is out of date
+                PHENOTYPE_WEIGHTS_ONLY, // same topology, weights/traits need patching
+                PHENOTYPE_CURRENT       // network matches the genome exactly
+            };
+
+            PhenotypeState phenotype_state = PHENOTYPE_STALE; //not serialized; loads start stale
+
+            // Flat POD mirror of the gene list: one packed record per gene,
+            // so the alignment scans in compatibility and crossover can
+            // stream over contiguous memory instead of chasing
+            // GenePtr/LinkPtr/NNodePtr indirections. The shared-pointer gene
+            // web remains the mutable source of truth (the mutators,
+            // serialization and the object pool all work on it); the mirror
+            // is rebuilt lazily after any mutation invalidates it.
+            struct GeneRecord
+            {
+                F64 innovation_num; //historical origin marker
+                F64 mutation_num;   //how much mutation has changed the link
+                F64 weight;         //the link weight
+                S32 in_node_id;     //id of the link's in-node
+                S32 out_node_id;    //id of the link's out-node
+                S32 trait_index;    //normalized trait number, or -1 for none
+                bool enable;        //is the gene expressed?
+                bool recurrent;     //is the link recurrent?
+            };
+
+            //The packed gene records, rebuilt first if they are stale
+            const std::vector<GeneRecord>& get_gene_records();
+
+            //A hash over the phenotype-defining fields of the gene records
+            //(link endpoints, weights, traits, enable/recurrent flags) and
+            //the node and trait counts. Genomes that decode to the same
+            //network hash the same, so clones and unmutated survivors can
+            //be recognized without re-evaluating them.
+            unsigned long long content_hash();
+
+            std::vector<GeneRecord> gene_records; //flat mirror of genes
+            bool gene_records_valid = false; //not serialized; loads rebuild
+
             S32 get_last_node_id(); //Return id of final NNode in Genome
             F64 get_last_gene_innovnum(); //Return last innovation number in Genome
 
@@ -63,7 +111,7 @@ namespace NEAT
 
             //Special constructor which spawns off an input file
             //This constructor assumes that some routine has already read in GENOMESTART
-            Genome(S32 id, std::ifstream &inFile);
+            Genome(S32 id, std::istream &inFile);
 
             // This special constructor creates a Genome
             // with i inputs, o outputs, n out of nmax hidden units, and random
@@ -122,6 +170,12 @@ namespace NEAT
             // Add Gaussian noise to linkweights either GAUSSIAN or COLDGAUSSIAN (from zero)
             void mutate_link_weights(F64 power, F64 rate, mutator mut_type);
 
+            // The perturbation loop specialized on the mutator at compile
+            // time, so the hot per-gene body carries no mutator branch
+            // (mutate_link_weights dispatches here once per call)
+            template <mutator MUT>
+            void mutate_link_weights_kernel(F64 power, F64 rate);
+
             // toggle genes on or off
             void mutate_toggle_enable(S32 times);
 
@@ -134,14 +188,14 @@ namespace NEAT
             //   Generally, if they fail, they can be called again if desired.
 
             // Mutate genome by adding a node respresentation
-            bool mutate_add_node(std::vector<InnovationPtr> &innovs,
+            bool mutate_add_node(InnovationRegistry &innovs,
                                  S32 &curnode_id, F64 &curinnov);
 
             // Mutate the genome by adding a new link between 2 random NNodes
-            bool mutate_add_link(std::vector<InnovationPtr> &innovs,
+            bool mutate_add_link(InnovationRegistry &innovs,
                                  F64 &curinnov, S32 tries);
 
-            void mutate_add_sensor(std::vector<InnovationPtr> &innovs,
+            void mutate_add_sensor(InnovationRegistry &innovs,
                                    double &curinnov);
 
             // ****** MATING METHODS *****
@@ -181,6 +235,15 @@ namespace NEAT
             //   The 3 coefficients are global system parameters
             F64 compatibility(GenomePtr g);
 
+            // A cheap lower bound on compatibility(g), computed from the
+            // genome fingerprints only: the gene counts and the innovation
+            // ranges (the gene lists are kept sorted by innovation number,
+            // so both are O(1) to read). When the bound already reaches the
+            // compatibility threshold the exact gene walk can be skipped.
+            // The matching-weight term of the formula cannot be bounded
+            // from whole-genome statistics, so it is counted as zero here.
+            F64 compatibility_lower_bound(GenomePtr g) const;
+
             F64 trait_compare(TraitPtr t1, TraitPtr t2);
 
             // Return number of non-disabled genes
@@ -206,6 +269,25 @@ namespace NEAT
                 // ar & BOOST_SERIALIZATION_NVP(phenotype); // TODO: don't really need to save the network
             }
         protected:
+            // Phenotype bookkeeping for the mutators: weight- and trait-level
+            // edits can be patched into an existing network in place,
+            // structural edits (and enable-bit flips) force a full rebuild.
+            void mark_weights_stale()
+            {
+                gene_records_valid = false;
+                if (phenotype_state == PHENOTYPE_CURRENT)
+                    phenotype_state = PHENOTYPE_WEIGHTS_ONLY;
+            }
+            void mark_topology_stale()
+            {
+                gene_records_valid = false;
+                phenotype_state = PHENOTYPE_STALE;
+            }
+
+            // Write the genome's link weights and trait parameters into the
+            // existing phenotype without rebuilding it (inverse of Lamarck)
+            void patch_phenotype_weights(NetworkPtr net);
+
             //Inserts a NNode into a given ordered list of NNodes in order
             void node_insert(std::vector<NNodePtr> &nlist, NNodePtr n);
 
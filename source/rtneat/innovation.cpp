@@ -50,3 +50,56 @@ Innovation::Innovation(int nin, int nout, double num1, double w, int t,
     newnode_id=0;
     recur_flag=recur;
 }
+
+void InnovationRegistry::add(InnovationPtr innov)
+{
+    innovations.push_back(innov);
+    index[node_pair_key(innov->node_in_id, innov->node_out_id)].push_back(innov);
+}
+
+InnovationPtr InnovationRegistry::find_node_innovation(int nin, int nout,
+                                                       double old_innov_num) const
+{
+    InnovationIndex::const_iterator bucket=index.find(node_pair_key(nin, nout));
+    if (bucket!=index.end())
+    {
+        for (size_t i=0; i<bucket->second.size(); ++i)
+        {
+            const InnovationPtr& innov=bucket->second[i];
+            if ((innov->innovation_type==NEWNODE)&&(innov->old_innov_num==old_innov_num))
+                return innov;
+        }
+    }
+    return InnovationPtr();
+}
+
+InnovationPtr InnovationRegistry::find_link_innovation(int nin, int nout,
+                                                       bool recur) const
+{
+    InnovationIndex::const_iterator bucket=index.find(node_pair_key(nin, nout));
+    if (bucket!=index.end())
+    {
+        for (size_t i=0; i<bucket->second.size(); ++i)
+        {
+            const InnovationPtr& innov=bucket->second[i];
+            if ((innov->innovation_type==NEWLINK)&&(innov->recur_flag==recur))
+                return innov;
+        }
+    }
+    return InnovationPtr();
+}
+
+void InnovationRegistry::clear()
+{
+    innovations.clear();
+    index.clear();
+}
+
+void InnovationRegistry::rebuild_index()
+{
+    index.clear();
+    for (size_t i=0; i<innovations.size(); ++i)
+    {
+        index[node_pair_key(innovations[i]->node_in_id, innovations[i]->node_out_id)].push_back(innovations[i]);
+    }
+}
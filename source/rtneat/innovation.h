@@ -1,6 +1,8 @@
 #ifndef _INNOVATION_H_
 #define _INNOVATION_H_
 
+#include <vector>
+#include "core/HashMap.h"
 #include "neat.h"
 #include "XMLSerializable.h"
 
@@ -25,7 +27,7 @@ namespace NEAT
     //  nodes fully specify the innovation and where it must have
     //  occured.  (Between them)                                     
     // ------------------------------------------------------------ 
-    class Innovation : public XMLSerializable
+    class Innovation : public XMLSerializable, public RefCountedUnsafe<Innovation>
     {
         private:
             friend class boost::serialization::access;
@@ -79,6 +81,75 @@ namespace NEAT
             }
     };
 
+    // ------------------------------------------------------------
+    // INNOVATIONREGISTRY CLASS:
+    //   Holds the genetic innovations of the newest generation
+    //   together with a hash index keyed on the (in node, out node)
+    //   pair, so the structural mutations can find a historical
+    //   match in constant time instead of scanning a list that
+    //   grows with the length of the run.
+    // ------------------------------------------------------------
+    class InnovationRegistry
+    {
+        private:
+            friend class boost::serialization::access;
+
+        public:
+
+            //Record a new innovation
+            void add(InnovationPtr innov);
+
+            //Find the first recorded NEWNODE innovation between the two
+            //nodes that split the gene with the given innovation number,
+            //or an empty pointer if there is none
+            InnovationPtr find_node_innovation(int nin, int nout,
+                                               double old_innov_num) const;
+
+            //Find the first recorded NEWLINK innovation between the two
+            //nodes with the given recurrency, or an empty pointer if
+            //there is none
+            InnovationPtr find_link_innovation(int nin, int nout,
+                                               bool recur) const;
+
+            //Remove all recorded innovations
+            void clear();
+
+            size_t size() const
+            {
+                return innovations.size();
+            }
+
+            /// serialize this object to/from a Boost serialization archive
+            template<class Archive>
+            void serialize(Archive & ar, const unsigned int version)
+            {
+                ar & BOOST_SERIALIZATION_NVP(innovations);
+                if (Archive::is_loading::value)
+                    rebuild_index();
+            }
+
+        private:
+
+            //All innovations between the same node pair land in one bucket;
+            //within a bucket they stay in the order they were recorded, so
+            //the finders return the same innovation the old linear scan did
+            typedef std::vector<InnovationPtr> InnovationBucket;
+            typedef hash_map<U64, InnovationBucket> InnovationIndex;
+
+            //Pack the node pair into one hashable key
+            static U64 node_pair_key(int nin, int nout)
+            {
+                return (static_cast<U64>(static_cast<U32>(nin))<<32)
+                    | static_cast<U32>(nout);
+            }
+
+            //Rebuild the index from the innovation list after loading
+            void rebuild_index();
+
+            std::vector<InnovationPtr> innovations; //The recorded innovations, in order
+            InnovationIndex index; //The innovations bucketed by node pair
+    };
+
 } // namespace NEAT
 
 #endif
@@ -0,0 +1,230 @@
+#include "core/Common.h"
+#include "island.h"
+#include "factor.h"
+
+#include <sstream>
+#include <thread>
+#include <mutex>
+
+#include <boost/asio.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/weak_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+using namespace NEAT;
+using namespace std;
+
+namespace
+{
+    // a NEAT genome is a few hundred genes at most, so a single datagram
+    // holds it comfortably; anything bigger than this is dropped with a
+    // warning rather than fragmented across packets
+    const size_t MAX_GENOME_DATAGRAM = 60000;
+}
+
+struct IslandMigration::Detail
+{
+    boost::asio::io_context io;
+    boost::asio::ip::udp::socket sock;
+    vector<boost::asio::ip::udp::endpoint> peers;
+
+    deque<GenomePtr> inbox;     // immigrants decoded by the receiver thread
+    mutex inbox_mutex;
+
+    thread receiver;
+    bool listening;
+    bool running;
+
+    Detail() : io(), sock(io), listening(false), running(false) {}
+};
+
+IslandMigration& IslandMigration::instance()
+{
+    static IslandMigration migration;
+    return migration;
+}
+
+IslandMigration::IslandMigration()
+    : mDetail(new Detail())
+{
+}
+
+IslandMigration::~IslandMigration()
+{
+    shutdown();
+}
+
+bool IslandMigration::listen(U16 port)
+{
+    using boost::asio::ip::udp;
+
+    if (mDetail->listening)
+        return true;
+
+    try
+    {
+        mDetail->sock.open(udp::v4());
+        mDetail->sock.bind(udp::endpoint(udp::v4(), port));
+    }
+    catch (const boost::system::system_error &err)
+    {
+        LOG_F_ERROR("rtNEAT", "island migration could not listen on port "
+                    << port << ": " << err.what());
+        return false;
+    }
+
+    mDetail->listening=true;
+    mDetail->running=true;
+    mDetail->receiver=thread(&IslandMigration::receive_loop, this);
+    LOG_F_MSG("rtNEAT", "island migration listening on UDP port " << port);
+    return true;
+}
+
+void IslandMigration::add_peer(const string &host, U16 port)
+{
+    using boost::asio::ip::udp;
+
+    try
+    {
+        udp::resolver resolver(mDetail->io);
+        udp::resolver::results_type found=
+            resolver.resolve(udp::v4(), host, to_string(port));
+        mDetail->peers.push_back(*found.begin());
+        LOG_F_MSG("rtNEAT", "island migration peer added: " << host << ":" << port);
+    }
+    catch (const boost::system::system_error &err)
+    {
+        LOG_F_ERROR("rtNEAT", "island migration could not resolve peer "
+                    << host << ":" << port << ": " << err.what());
+    }
+}
+
+bool IslandMigration::is_enabled() const
+{
+    return mDetail->listening || !mDetail->peers.empty();
+}
+
+void IslandMigration::send_champion(PopulationPtr pop)
+{
+    if (!pop || mDetail->peers.empty())
+        return;
+
+    GenomePtr champ=pop->champion_genome();
+    if (!champ)
+        return;
+
+    ostringstream out(ios::binary);
+    {
+        boost::archive::binary_oarchive archive(out);
+        archive << champ;
+    }
+    const string packet=out.str();
+
+    if (packet.size() > MAX_GENOME_DATAGRAM)
+    {
+        LOG_F_WARNING("rtNEAT", "champion genome too large to migrate ("
+                      << packet.size() << " bytes), skipping");
+        return;
+    }
+
+    // fire and forget: a dropped datagram is just one missed migration
+    if (!mDetail->sock.is_open())
+    {
+        try
+        {
+            mDetail->sock.open(boost::asio::ip::udp::v4());
+        }
+        catch (const boost::system::system_error&)
+        {
+            return;
+        }
+    }
+    vector<boost::asio::ip::udp::endpoint>::const_iterator curpeer;
+    for (curpeer=mDetail->peers.begin(); curpeer!=mDetail->peers.end(); ++curpeer)
+    {
+        boost::system::error_code ignored;
+        mDetail->sock.send_to(boost::asio::buffer(packet), *curpeer, 0, ignored);
+    }
+}
+
+S32 IslandMigration::integrate_immigrants(PopulationPtr pop, S32 max_count)
+{
+    if (!pop)
+        return 0;
+
+    S32 integrated=0;
+    while (integrated < max_count)
+    {
+        GenomePtr immigrant=take_immigrant();
+        if (!immigrant)
+            break;
+        if (pop->integrate_genome(immigrant))
+            ++integrated;
+    }
+    return integrated;
+}
+
+GenomePtr IslandMigration::take_immigrant()
+{
+    lock_guard<mutex> guard(mDetail->inbox_mutex);
+    if (mDetail->inbox.empty())
+        return GenomePtr();
+    GenomePtr immigrant=mDetail->inbox.front();
+    mDetail->inbox.pop_front();
+    return immigrant;
+}
+
+void IslandMigration::shutdown()
+{
+    if (mDetail->running)
+    {
+        mDetail->running=false;
+        // closing the socket unblocks the receiver
+        boost::system::error_code ignored;
+        mDetail->sock.close(ignored);
+        if (mDetail->receiver.joinable())
+            mDetail->receiver.join();
+        mDetail->listening=false;
+    }
+}
+
+void IslandMigration::receive_loop()
+{
+    using boost::asio::ip::udp;
+
+    vector<char> buffer(MAX_GENOME_DATAGRAM);
+    while (mDetail->running)
+    {
+        udp::endpoint sender;
+        boost::system::error_code err;
+        size_t received=
+            mDetail->sock.receive_from(boost::asio::buffer(buffer), sender, 0, err);
+        if (err)
+        {
+            // close() during shutdown lands here
+            if (!mDetail->running)
+                break;
+            continue;
+        }
+
+        try
+        {
+            istringstream in(string(&buffer[0], received), ios::binary);
+            boost::archive::binary_iarchive archive(in);
+            GenomePtr immigrant;
+            archive >> immigrant;
+            if (immigrant)
+            {
+                lock_guard<mutex> guard(mDetail->inbox_mutex);
+                mDetail->inbox.push_back(immigrant);
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            LOG_F_WARNING("rtNEAT", "dropping malformed immigrant genome: "
+                          << ex.what());
+        }
+    }
+}
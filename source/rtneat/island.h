@@ -0,0 +1,83 @@
+#ifndef _ISLAND_H_
+#define _ISLAND_H_
+
+#include "neat.h"
+#include "genome.h"
+#include "population.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <boost/shared_ptr.hpp>
+
+namespace NEAT
+{
+
+    // ---------------------------------------------
+    // ISLAND MIGRATION:
+    //   Asynchronous exchange of champion genomes
+    //   between independent NEAT processes, so a
+    //   farm of small populations converges like
+    //   one large one. Each process listens on a
+    //   UDP port and periodically fires its current
+    //   champion at its peers; received genomes are
+    //   queued by a background thread and folded in
+    //   from the evolution loop by replacing the
+    //   worst organisms. Datagrams use the compact
+    //   binary genome format; a lost datagram just
+    //   means one skipped migration, so there is no
+    //   connection state to manage.
+    // ---------------------------------------------
+    class IslandMigration
+    {
+        public:
+
+            // singleton accessor
+            static IslandMigration& instance();
+
+            // start receiving immigrant genomes on the given UDP port
+            // (returns false if the socket could not be opened)
+            bool listen(U16 port);
+
+            // add a peer island to send champions to
+            void add_peer(const std::string &host, U16 port);
+
+            // true once listen succeeded or at least one peer was added
+            bool is_enabled() const;
+
+            // serialize the population's champion genome and send it to
+            // every peer (fire and forget)
+            void send_champion(PopulationPtr pop);
+
+            // fold up to max_count queued immigrant genomes into the
+            // population; returns the number actually integrated
+            S32 integrate_immigrants(PopulationPtr pop, S32 max_count);
+
+            // take one queued immigrant genome off the inbox (NULL if
+            // none); used by the realtime loop, which wraps and speciates
+            // the organism itself
+            GenomePtr take_immigrant();
+
+            // close the socket and join the receiver thread
+            void shutdown();
+
+            ~IslandMigration();
+
+        private:
+
+            IslandMigration();
+
+            // no copying (the receiver thread owns the socket)
+            IslandMigration(const IslandMigration&);
+            IslandMigration& operator=(const IslandMigration&);
+
+            // blocking datagram loop run on the receiver thread
+            void receive_loop();
+
+            struct Detail; // holds the socket types so <boost/asio.hpp>
+                           // stays out of this header
+            boost::shared_ptr<Detail> mDetail;
+    };
+
+} // namespace NEAT
+
+#endif // _ISLAND_H_
@@ -1,78 +1,112 @@
-#include "core/Common.h"
-#include "link.h"
-#include <iostream>
-
-using namespace NEAT;
-using namespace std;
-
-Link::Link(F64 w, NNodePtr inode, NNodePtr onode, bool recur) :
-    in_node(inode), 
-    out_node(onode), 
-    weight(w), 
-    is_recurrent(recur),
-    time_delay(false), 
-    trait_id(1), 
-    linktrait(), 
-    added_weight(0)
-{
-}
-
-Link::Link(TraitPtr lt, F64 w, NNodePtr inode, NNodePtr onode, bool recur) :
-    in_node(inode), 
-    out_node(onode), 
-    weight(w), 
-    is_recurrent(recur),
-    time_delay(false), 
-    trait_id(1), 
-    linktrait(lt), 
-    added_weight(0)
-{
-    if (lt.get()!=0)
-        trait_id=lt->trait_id;
-}
-
-Link::Link(F64 w) :
-    in_node(), 
-    out_node(), 
-    weight(w), 
-    is_recurrent(false), 
-    time_delay(false), 
-    trait_id(1),
-    linktrait(),
-    added_weight(0)
-{
-}
-
-Link::Link(const Link& link) :
-    in_node(link.in_node), 
-    out_node(link.out_node), 
-    weight(link.weight), 
-    is_recurrent(link.is_recurrent), 
-    time_delay(link.time_delay),
-    trait_id(link.trait_id),
-    linktrait(link.linktrait), 
-    added_weight(link.added_weight)
-{
-}
-
-void Link::derive_trait(TraitPtr curtrait)
-{
-
-    if (curtrait!=0)
-    {
-        for (S32 count=0; count<NEAT::num_trait_params; count++)
-            params[count]=(curtrait->params)[count];
-    }
-    else
-    {
-        for (S32 count=0; count<NEAT::num_trait_params; count++)
-            params[count]=0;
-    }
-
-    if (curtrait!=0)
-        trait_id=curtrait->trait_id;
-    else
-        trait_id=1;
-
-}
-
+#include "core/Common.h"
+#include "link.h"
+#include "objectpool.h"
+#include <iostream>
+
+using namespace NEAT;
+using namespace std;
+
+namespace
+{
+    //The pool instance is leaked on purpose: statics elsewhere may still
+    //release Links during shutdown, so the pool has to outlive every
+    //other static; the OS reclaims the chunks at process exit
+    ObjectPool<Link>& link_pool()
+    {
+        static ObjectPool<Link>* pool=new ObjectPool<Link>();
+        return *pool;
+    }
+}
+
+void* Link::operator new(size_t size)
+{
+    //A derived class would have a different size; send it to the heap
+    if (size!=sizeof(Link))
+        return ::operator new(size);
+    return link_pool().allocate();
+}
+
+void Link::operator delete(void* p)
+{
+    if (!p)
+        return;
+    if (link_pool().owns(p))
+        link_pool().release(p);
+    else
+        ::operator delete(p);
+}
+
+PoolStats Link::pool_stats()
+{
+    return link_pool().stats();
+}
+
+Link::Link(F64 w, NNodePtr inode, NNodePtr onode, bool recur) :
+    in_node(inode), 
+    out_node(onode), 
+    weight(w), 
+    is_recurrent(recur),
+    time_delay(false), 
+    trait_id(1), 
+    linktrait()
+{
+}
+
+Link::Link(TraitPtr lt, F64 w, NNodePtr inode, NNodePtr onode, bool recur) :
+    in_node(inode), 
+    out_node(onode), 
+    weight(w), 
+    is_recurrent(recur),
+    time_delay(false), 
+    trait_id(1), 
+    linktrait(lt)
+{
+    if (lt.get()!=0)
+        trait_id=lt->trait_id;
+}
+
+Link::Link(F64 w) :
+    in_node(), 
+    out_node(), 
+    weight(w), 
+    is_recurrent(false), 
+    time_delay(false), 
+    trait_id(1),
+    linktrait()
+{
+}
+
+Link::Link(const Link& link) :
+    in_node(link.in_node), 
+    out_node(link.out_node), 
+    weight(link.weight), 
+    is_recurrent(link.is_recurrent), 
+    time_delay(link.time_delay),
+    trait_id(link.trait_id),
+    linktrait(link.linktrait)
+{
+    for (S32 count=0; count<num_learning_params; count++)
+        params[count]=link.params[count];
+}
+
+void Link::derive_trait(TraitPtr curtrait)
+{
+
+    if (curtrait!=0)
+    {
+        for (S32 count=0; count<num_learning_params; count++)
+            params[count]=(curtrait->params)[count];
+    }
+    else
+    {
+        for (S32 count=0; count<num_learning_params; count++)
+            params[count]=0;
+    }
+
+    if (curtrait!=0)
+        trait_id=curtrait->trait_id;
+    else
+        trait_id=1;
+
+}
+
@@ -10,6 +10,7 @@
 
 namespace NEAT
 {
+    struct PoolStats;
     // ----------------------------------------------------------------------- 
     // A LINK is a connection from one node to another with an associated weight 
     // It can be marked as recurrent 
@@ -23,6 +24,15 @@ namespace NEAT
             NNodeWeakPtr in_node; // NNode inputting into the link
             NNodeWeakPtr out_node; // NNode that the link affects
         public:
+            //Links are allocated from a shared object pool (see
+            //objectpool.h) to keep reproduction churn away from
+            //the system allocator
+            static void* operator new(size_t size);
+            static void operator delete(void* p);
+
+            //Occupancy snapshot of the shared pool (see objectpool.h)
+            static PoolStats pool_stats();
+
             F64 weight; // Weight of connection
             bool is_recurrent;
             bool time_delay;
@@ -31,11 +41,14 @@ namespace NEAT
 
             TraitPtr linktrait; // Points to a trait of parameters for genetic creation
 
-            // ************ LEARNING PARAMETERS *********** 
-            // These are link-related parameters that change during Hebbian type learning
+            // ************ LEARNING PARAMETERS ***********
+            // These are link-related parameters that change during Hebbian type learning.
+            // Only the first three trait parameters feed the hebbian update,
+            // so only those are mirrored here; the full trait stays reachable
+            // through linktrait.
 
-            F64 added_weight; // The amount of weight adjustment 
-            F64 params[NEAT::num_trait_params];
+            static const S32 num_learning_params = 3;
+            F64 params[num_learning_params];
 
             Link(F64 w, NNodePtr inode, NNodePtr onode, bool recur);
 
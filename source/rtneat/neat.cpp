@@ -1,8 +1,11 @@
 #include "core/Common.h"
+#include "core/File.h"
 #include <fstream>
 #include <cmath>
 #include <iostream>
 #include <string>
+#include <ctime>
+#include <atomic>
 #include "neat.h"
 #include "XMLSerializable.h"
 
@@ -45,16 +48,109 @@ namespace NEAT
     S32 babies_stolen = 0; // The number of babies to siphen off to the champions 
     F64 backprop_learning_rate = 0; // Learning rate of back-propagation algorithm
     F64 max_link_weight = 3; // Link weights are capped at this (and negative of this) value
-    MTRand NEATRandGen((U64)time(NULL)); //TODO: we should probably move the Mersenne Twister random generator to OpenNero common
+    S32 fast_sigmoid = 0; // 1 answers fsigmoid from a lookup table instead of exp()
+    S32 fast_sigmoid_bins = 4096; // resolution of the sigmoid lookup table
+    S32 factor_history_depth = 0; // Cap on a genome's factor history; 0 keeps it all
+    S32 single_precision_nets = 0; // 1 runs compiled phenotypes in F32 instead of F64
+    namespace
+    {
+        // the base seed new per-thread streams derive their keys from
+        U32 neat_base_seed = (U32)time(NULL);
+
+        // hands every thread a distinct stream index on first use
+        U32 next_stream_index()
+        {
+            static std::atomic<U32> counter(0);
+            return counter++;
+        }
+
+        // the lookup table covers [-kSigmoidRange, kSigmoidRange]; outside
+        // it the plain sigmoid is within 3.4e-4 of 0 or 1, so we clamp
+        const F64 kSigmoidRange = 8.0;
+
+        // sampled sigmoid values with linear interpolation between them;
+        // built once on first use at the resolution in fast_sigmoid_bins
+        class SigmoidTable
+        {
+        public:
+            SigmoidTable()
+                : mBins(fast_sigmoid_bins > 1 ? (size_t)fast_sigmoid_bins : 4096)
+                , mValues(mBins + 1)
+                , mScale(mBins / (2 * kSigmoidRange))
+            {
+                for (size_t i = 0; i <= mBins; ++i)
+                {
+                    F64 x = -kSigmoidRange + i / mScale;
+                    mValues[i] = 1/(1+(exp(-x)));
+                }
+            }
+
+            F64 operator()(F64 activesum) const
+            {
+                if (activesum <= -kSigmoidRange)
+                    return 0;
+                if (activesum >= kSigmoidRange)
+                    return 1;
+                F64 pos = (activesum + kSigmoidRange) * mScale;
+                size_t i = (size_t)pos;
+                F64 frac = pos - i;
+                return mValues[i] + frac * (mValues[i + 1] - mValues[i]);
+            }
+        private:
+            size_t mBins;              ///< number of table intervals
+            std::vector<F64> mValues;  ///< mBins + 1 sampled sigmoid values
+            F64 mScale;                ///< bins per unit of activesum
+        };
+
+        // built thread-safely on first activation (C++11 static init)
+        const SigmoidTable& sigmoid_table()
+        {
+            static SigmoidTable table;
+            return table;
+        }
+    }
+
+    /// The calling thread's random stream. Each thread gets its own
+    /// counter-based stream keyed off the base seed and a per-thread
+    /// index, so concurrent draws never contend or interleave.
+    RandomStream& rand_stream()
+    {
+        static thread_local RandomStream stream(neat_base_seed, next_stream_index());
+        return stream;
+    }
+
+    /// Rekey the calling thread's stream, typically from an organism id
+    /// and a generation, so the numbers drawn afterwards depend only on
+    /// the key and not on which thread does the work.
+    void reseed_rand_stream(U32 id, U32 epoch)
+    {
+        rand_stream().Reset(id, epoch);
+    }
+
+    /// Set the base seed that new per-thread streams derive from, and
+    /// rekey the calling thread's stream from it.
+    void seed_random(U32 seed)
+    {
+        neat_base_seed = seed;
+        rand_stream().Reset(seed, next_stream_index());
+    }
+
+    /// The base seed currently in effect (for world snapshots)
+    U32 get_random_seed()
+    {
+        return neat_base_seed;
+    }
 
     bool load_neat_params(const string& filename)
     {
 
-        ifstream paramFile(filename.c_str(), ios::in);
-        if (!paramFile)
+        // map the file instead of pulling it through a buffered stream
+        OpenNero::ReadOnlyFileView paramView(filename);
+        if (!paramView.IsOpen())
         {
             return false;
         }
+        OpenNero::FileViewInStream paramFile(paramView);
         // **********LOAD IN PARAMETERS*************** //
         cout << "NEAT READING IN "<< filename << endl;
         char curword[256];
@@ -126,6 +222,29 @@ namespace NEAT
         paramFile >> backprop_learning_rate;
         paramFile >> curword;
         paramFile >> max_link_weight;
+        // optional trailing entries: files written before these existed
+        // simply end here, and the failed reads leave the mode off
+        paramFile >> curword;
+        paramFile >> fast_sigmoid;
+        paramFile >> curword;
+        paramFile >> fast_sigmoid_bins;
+        if (!paramFile)
+        {
+            fast_sigmoid = 0;
+            fast_sigmoid_bins = 4096;
+        }
+        paramFile >> curword;
+        paramFile >> factor_history_depth;
+        if (!paramFile)
+        {
+            factor_history_depth = 0;
+        }
+        paramFile >> curword;
+        paramFile >> single_precision_nets;
+        if (!paramFile)
+        {
+            single_precision_nets = 0;
+        }
         cout << "trait_param_mut_prob="<< trait_param_mut_prob << endl;
         cout << "trait_mutation_power="<< trait_mutation_power << endl;
         cout << "linktrait_mut_sig="<< linktrait_mut_sig << endl;
@@ -160,15 +279,17 @@ namespace NEAT
         cout << "babies_stolen="<< babies_stolen << endl;
         cout << "backprop_learning_rate="<< backprop_learning_rate << endl;
         cout << "max_link_weight="<<max_link_weight<<endl;
-        paramFile.close();
+        cout << "fast_sigmoid="<< fast_sigmoid << endl;
+        cout << "fast_sigmoid_bins="<< fast_sigmoid_bins << endl;
+        cout << "factor_history_depth="<< factor_history_depth << endl;
+        cout << "single_precision_nets="<< single_precision_nets << endl;
         return true;
     }
 
     /// Random number from the normal Gaussian distribution with mean 0 and variance 1
-    /// Uses the mersenne twister implementation
     F64 gaussrand()
     {
-        return NEATRandGen.randNorm(0, 1);
+        return rand_stream().normalD(0, 1);
     }
 
     F64 fsigmoid(F64 activesum, F64 slope, F64 constant)
@@ -181,6 +302,10 @@ namespace NEAT
         //return (1/(1+(exp(-(slope*activesum+constant))))); //original setting ave 3423 on 40 runs of p2m, 3729 and 1 failure also
 
         //PLAIN SIGMOID ---------------------------------------------------------
+        if (fast_sigmoid)
+        {
+            return sigmoid_table()(activesum);
+        }
         return (1/(1+(exp(-activesum)))); //3511 and 1 failure
 
         //LEFT SHIFTED NON-STEEPENED---------------------------------------------
@@ -199,6 +324,67 @@ namespace NEAT
         return activesum;
     }
 
+    void fsigmoid_batch(const F64* activesums, F64* activations,
+                        size_t count, F64 slope, F64 constant)
+    {
+        // Must match fsigmoid exactly; see the commentary there for the
+        // variants. The (slope, constant) parameters are accepted for
+        // symmetry with the scalar form but the plain sigmoid ignores them.
+        if (fast_sigmoid)
+        {
+            const SigmoidTable& table = sigmoid_table();
+            for (size_t i = 0; i < count; ++i)
+            {
+                activations[i] = table(activesums[i]);
+            }
+            return;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            activations[i] = 1/(1+(exp(-activesums[i])));
+        }
+    }
+
+    void flinear_batch(const F64* activesums, F64* activations,
+                       size_t count, F64 slope, F64 constant)
+    {
+        // Must match flinear exactly (currently the identity)
+        for (size_t i = 0; i < count; ++i)
+        {
+            activations[i] = activesums[i];
+        }
+    }
+
+    void fsigmoid_batch(const F32* activesums, F32* activations,
+                        size_t count, F32 slope, F32 constant)
+    {
+        // The single-precision twin of the F64 form above, for phenotypes
+        // compiled with single_precision_nets: same function, F32 lanes
+        if (fast_sigmoid)
+        {
+            const SigmoidTable& table = sigmoid_table();
+            for (size_t i = 0; i < count; ++i)
+            {
+                activations[i] = (F32)table(activesums[i]);
+            }
+            return;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            activations[i] = 1.0f/(1.0f+(expf(-activesums[i])));
+        }
+    }
+
+    void flinear_batch(const F32* activesums, F32* activations,
+                       size_t count, F32 slope, F32 constant)
+    {
+        // Must match flinear exactly (currently the identity)
+        for (size_t i = 0; i < count; ++i)
+        {
+            activations[i] = activesums[i];
+        }
+    }
+
     F64 hebbian(F64 weight, F64 maxweight, F64 active_in, F64 active_out,
                       F64 hebb_rate, F64 pre_rate, F64 post_rate)
     {
@@ -2,9 +2,11 @@
 #define _NERO_NEAT_H_
 
 #include "core/Common.h"
-#include "mersennetwister.h"
+#include "core/RefCounted.h"
+#include "math/RandomStream.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/intrusive_ptr.hpp>
 
 namespace NEAT
 {
@@ -59,12 +61,58 @@ namespace NEAT
     extern F64 backprop_learning_rate; // Learning rate of back-propagation algorithm
     extern F64 max_link_weight; // Link weights are capped at this (and negative of this) value
 
-    extern MTRand NEATRandGen; // Random number generator; can pass seed value as argument
+    // When nonzero, fsigmoid answers from an interpolated lookup table
+    // instead of calling exp() at every node activation. The table covers
+    // [-8, 8] with fast_sigmoid_bins entries and clamps to 0/1 outside it;
+    // at the default resolution the worst-case error is below 4e-4 (the
+    // tail clamp), far under sensor noise. Off by default; old parameter
+    // files that end before this entry leave it off. The table is built on
+    // first use, so set the resolution before any network activates.
+    extern S32 fast_sigmoid;
+    extern S32 fast_sigmoid_bins;
 
-    // Inline Random Functions 
+    // When nonzero, caps the factor history a genome carries to this many
+    // records: whenever mating would push a lineage past the cap, the
+    // oldest records are rolled up into a single summary factor. In
+    // month-long runs uncapped factor lists become a significant share of
+    // population memory and checkpoint size. 0 (the default, and what old
+    // parameter files imply) keeps the full history.
+    extern S32 factor_history_depth;
+
+    // When nonzero, compiled phenotypes stream their link weights and node
+    // outputs as F32 instead of F64, halving the memory traffic of the
+    // activation sweep and doubling its SIMD lane width. Controller
+    // inference tolerates the reduced precision (the sigmoid saturates far
+    // below F32 resolution); evolution-side bookkeeping - genomes, link
+    // weights, mutation, compatibility - stays F64 regardless. Off by
+    // default, and old parameter files that end before this entry leave it
+    // off. The setting is read when a network compiles, so set it before
+    // any phenotype is built.
+    extern S32 single_precision_nets;
+
+    // Counter-based random streams replace the old shared Mersenne Twister
+    // state: every thread draws from its own Philox stream, so parallel
+    // mutation and parallel agent ticking neither contend on nor perturb
+    // each other's sequences.
+
+    // the calling thread's random stream
+    extern RandomStream& rand_stream();
+
+    // rekey the calling thread's stream deterministically (e.g. from an
+    // organism id and a generation), making the numbers drawn afterwards
+    // independent of which thread does the work
+    extern void reseed_rand_stream(U32 id, U32 epoch);
+
+    // set the base seed that new per-thread streams derive from
+    extern void seed_random(U32 seed);
+
+    // the base seed currently in effect (for world snapshots)
+    extern U32 get_random_seed();
+
+    // Inline Random Functions
     extern inline S32 randposneg()
     {
-        if (NEAT::NEATRandGen.randInt()%2)
+        if (NEAT::rand_stream().randI()%2)
             return 1;
         else
             return -1;
@@ -72,12 +120,26 @@ namespace NEAT
 
     extern inline S32 randint(S32 x, S32 y)
     {
-        return NEAT::NEATRandGen.randInt()%(y-x+1)+x;
+        return NEAT::rand_stream().randI()%(y-x+1)+x;
     }
 
     extern inline F64 randfloat()
     {
-        return NEAT::NEATRandGen.rand();
+        return NEAT::rand_stream().randD();
+    }
+
+    // Decide an event that happens with the given probability. The
+    // degenerate settings production parameter files pin to 0 or 1
+    // short-circuit without touching the random stream, so reproduction
+    // decision chains pay neither the draw nor a data-dependent branch
+    // for options that are switched off (or always on).
+    extern inline bool randevent(F64 prob)
+    {
+        if (prob <= 0.0)
+            return false;
+        if (prob >= 1.0)
+            return true;
+        return NEAT::rand_stream().randD() < prob;
     }
 
     // SIGMOID FUNCTION ********************************
@@ -101,6 +163,22 @@ namespace NEAT
     // It specifies a function with a slope and offset.
     extern F64 flinear(F64, F64, F64);
 
+    // Batch forms of the activation functions above: apply the function to
+    // count contiguous activesums at once. The loops are branch-free over
+    // dense arrays so the compiler can vectorize them; the results are
+    // identical to calling the scalar functions element by element.
+    extern void fsigmoid_batch(const F64* activesums, F64* activations,
+                               size_t count, F64 slope, F64 constant);
+    extern void flinear_batch(const F64* activesums, F64* activations,
+                              size_t count, F64 slope, F64 constant);
+
+    // Single-precision forms of the batch kernels, used by phenotypes
+    // compiled with single_precision_nets
+    extern void fsigmoid_batch(const F32* activesums, F32* activations,
+                               size_t count, F32 slope, F32 constant);
+    extern void flinear_batch(const F32* activesums, F32* activations,
+                              size_t count, F32 slope, F32 constant);
+
     // Hebbian Adaptation Function
     // Based on equations in Floreano & Urzelai 2000
     // Takes the current weight, the maximum weight in the containing network,
@@ -143,17 +221,30 @@ namespace NEAT
     typedef boost::shared_ptr<NNode> NNodePtr;
     typedef boost::weak_ptr<NNode> NNodeWeakPtr;
 
+    // Innovations, genes and traits are the highest-churn objects of
+    // the evolution step (every reproduction clones or creates them by
+    // the dozen) and are never weakly referenced, so they carry an
+    // intrusive count (core/RefCounted.h) instead of paying a
+    // shared_ptr control block apiece. Genes and traits keep the
+    // atomic count: the parallel spawn duplicates the start genome
+    // from several workers at once (copying its Gene and Trait
+    // pointers per gene), and island immigrants are deserialized on
+    // the migration receiver thread. Innovations are the one of the
+    // three that really is single-threaded - created, matched and
+    // pruned only on the thread running reproduction, and carried by
+    // neither genome serialization nor migration - so they keep the
+    // non-atomic count. The Ptr typedefs keep their names, so the
+    // using code is unchanged.
+
     class Innovation;
-    typedef boost::shared_ptr<Innovation> InnovationPtr;
-    typedef boost::weak_ptr<Innovation> InnovationWeakPtr;
+    typedef boost::intrusive_ptr<Innovation> InnovationPtr;
+    class InnovationRegistry;
 
     class Gene;
-    typedef boost::shared_ptr<Gene> GenePtr;
-    typedef boost::weak_ptr<Gene> GeneWeakPtr;
+    typedef boost::intrusive_ptr<Gene> GenePtr;
 
     class Trait;
-    typedef boost::shared_ptr<Trait> TraitPtr;
-    typedef boost::weak_ptr<Trait> TraitWeakPtr;
+    typedef boost::intrusive_ptr<Trait> TraitPtr;
 
     class Link;
     typedef boost::shared_ptr<Link> LinkPtr;
@@ -1,38 +1,110 @@
 #include "core/Common.h"
+#include "core/HashMap.h"
 #include "network.h"
+#include "genome.h"
 
 using namespace NEAT;
 using namespace std;
 
+namespace
+{
+    // Phenotype sharing: champion cloning and elitist survival leave
+    // 15-25% of a steady-state population carrying byte-identical
+    // genomes, and each used to compile its own copy of the flat
+    // structure. The cache maps genome content hashes to the structures
+    // already built, held weakly so a structure dies with its last
+    // network; expired entries are dropped when they are next hit, and
+    // the whole table is swept once it grows past the prune threshold.
+    typedef hash_map<U64, boost::weak_ptr<const CompiledStructure> > StructureCache;
+
+    StructureCache& structure_cache()
+    {
+        static StructureCache cache;
+        return cache;
+    }
+
+    void prune_structure_cache(StructureCache& cache)
+    {
+        static const size_t prune_threshold=1024;
+        if (cache.size()<prune_threshold)
+            return;
+        StructureCache::iterator it=cache.begin();
+        while (it!=cache.end())
+        {
+            if (it->second.expired())
+                cache.erase(it++);
+            else
+                ++it;
+        }
+    }
+
+    // The content hash pins down the gene records; confirm the node rows
+    // line up too before adopting a shared structure (an O(nodes) check
+    // against an O(links) rebuild)
+    bool structure_matches(const CompiledStructure& s, const vector<NNodePtr>& nodes)
+    {
+        if (s.node_id.size()!=nodes.size())
+            return false;
+        for (size_t row=0; row<nodes.size(); ++row)
+        {
+            const NNode* node=nodes[row].get();
+            if (s.node_id[row]!=node->node_id)
+                return false;
+            if (s.ftype[row]!=node->ftype)
+                return false;
+            if (s.place[row]!=node->gen_node_label)
+                return false;
+            if (s.is_sensor[row]!=(((node->type)==SENSOR) ? 1 : 0))
+                return false;
+        }
+        return true;
+    }
+}
+
 Network::Network(vector<NNodePtr> in, vector<NNodePtr> out,
                  vector<NNodePtr> all, S32 netid) :
     numnodes(),
-    numlinks(-1), 
-    all_nodes(all), 
+    numlinks(-1),
+    netdepth(-1),
+    all_nodes(all),
     genotype(), 
     name(""), 
     inputs(in), 
     outputs(out), 
-    net_id(netid), 
-    adaptable(false)
+    net_id(netid),
+    adaptable(false),
+    compile_state(COMPILE_NONE),
+    memo_state(MEMO_UNKNOWN),
+    memo_match(false),
+    memo_settled(false)
 {
 }
 
 Network::Network(S32 netid) :
-    numnodes(-1), 
-    numlinks(-1), 
-    name(""), 
-    net_id(netid), 
-    adaptable(false)
+    numnodes(-1),
+    numlinks(-1),
+    netdepth(-1),
+    name(""),
+    net_id(netid),
+    adaptable(false),
+    compile_state(COMPILE_NONE),
+    memo_state(MEMO_UNKNOWN),
+    memo_match(false),
+    memo_settled(false)
 {
 }
 
 Network::Network(const Network& network) :
-    numnodes(network.numnodes), 
+    numnodes(network.numnodes),
     numlinks(network.numlinks),
-    name(network.name), 
-    net_id(network.net_id), 
-    adaptable(network.adaptable)
+    netdepth(network.netdepth),
+    name(network.name),
+    net_id(network.net_id),
+    adaptable(network.adaptable),
+    compile_state(COMPILE_NONE),
+    memo_state(MEMO_UNKNOWN),
+    memo_match(false),
+    memo_settled(false)
 {
     vector<NNodePtr>::const_iterator curnode;
 
@@ -67,6 +139,9 @@ void Network::flush()
     {
         (*curnode)->flushback();
     }
+
+    //the node state no longer reflects any activation
+    memo_settled=false;
 }
 
 // If all output are not active then return true
@@ -174,14 +249,44 @@ bool Network::activate()
 
     //cout<<"Activating network: "<<this->genotype<<endl;
 
-    //Keep activating until all the nodes have become active 
+    //A repeat of the inputs the node state already reflects: the outputs
+    //are still correct, so skip the activation outright (memo_match is
+    //only ever set for nets whose outputs depend on nothing but the inputs)
+    if (memo_match&&memo_settled)
+        return true;
+
+    //Use the flattened copy of the net when we have one (or can build one);
+    //it performs the same sweeps below over contiguous arrays
+    if (compile_state==COMPILE_NONE)
+        compile();
+    if (compile_state==COMPILE_READY)
+    {
+        if (activate_compiled())
+        {
+            memo_settled=memoizable();
+            return true;
+        }
+        return false;
+    }
+
+    //Keep activating until all the nodes have become active
     //(This only happens on the first activation, because after that they
     // are always active)
 
+    //The cached settling depth tells us how many sweeps this activation
+    //needs, so the loop only re-scans the node states once that many
+    //sweeps have run instead of after every sweep
+    S32 settle=nodesoff() ? max_depth() : 1;
+    if (settle<1)
+        settle=1;
+    S32 sweep=0;
+
     onetime=false;
-    
-    while (nodesoff()||!onetime)
+
+    for (;;)
     {
+        if (sweep>=settle&&onetime&&!nodesoff())
+            break;
 
         ++abortcount;
 
@@ -266,6 +371,7 @@ bool Network::activate()
             }
         }
 
+        ++sweep;
         onetime=true;
     }
 
@@ -309,6 +415,493 @@ bool Network::activate()
 
     } //end if (adaptable)
 
+    memo_settled=memoizable();
+
+    return true;
+}
+
+// Determine (once) whether the net's outputs depend on nothing but its
+// inputs: adaptation rewrites weights per activation, and recurrent or
+// time-delayed links read activation history, so any of them rules the
+// skip out
+bool Network::memoizable()
+{
+    if (memo_state!=MEMO_UNKNOWN)
+        return memo_state==MEMO_OK;
+
+    vector<NNodePtr>::const_iterator curnode;
+    vector<LinkPtr>::const_iterator curlink;
+
+    memo_state=adaptable ? MEMO_UNSUPPORTED : MEMO_OK;
+    for (curnode=all_nodes.begin(); memo_state==MEMO_OK&&curnode!=all_nodes.end(); ++curnode)
+    {
+        for (curlink=((*curnode)->incoming).begin(); curlink!=((*curnode)->incoming).end(); ++curlink)
+        {
+            if ((*curlink)->is_recurrent||(*curlink)->time_delay)
+            {
+                memo_state=MEMO_UNSUPPORTED;
+                break;
+            }
+        }
+    }
+    return memo_state==MEMO_OK;
+}
+
+// Compare the sensor values a load presented against the ones behind the
+// current node state; on a mismatch, remember the new values so the next
+// load can match them once activate() has settled the net on them
+void Network::memo_load(const F64* values, size_t count)
+{
+    if (!memoizable())
+        return;
+
+    if (memo_inputs.size()==count&&std::equal(memo_inputs.begin(), memo_inputs.end(), values))
+    {
+        memo_match=true;
+        return;
+    }
+
+    memo_match=false;
+    memo_settled=false;
+    memo_inputs.assign(values, values+count);
+}
+
+// Flatten the net into contiguous arrays for activate_compiled()
+// Returns true on success
+bool Network::compile()
+{
+    vector<NNodePtr>::iterator curnode;
+    vector<LinkPtr>::iterator curlink;
+
+    //The hebbian adaptation and time-delayed connections read and write
+    //per-link state the flat arrays do not carry; such nets keep using
+    //the pointer-based path
+    if (adaptable)
+    {
+        compile_state=COMPILE_UNSUPPORTED;
+        return false;
+    }
+
+    const size_t num=all_nodes.size();
+
+    //The per-network half: the node row mapping and the activation state
+    flat_node.resize(num);
+    flat_value.resize(num);
+    flat_out.resize(num);
+    flat_sum.resize(num);
+    flat_last.resize(num);
+    flat_last2.resize(num);
+    flat_count.resize(num);
+    flat_active.resize(num);
+    flat_out32.resize(single_precision_nets ? num : 0);
+    size_t row=0;
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        flat_node[row]=curnode->get();
+    }
+
+    //Byte-identical genome content (champion clones, elitist survivors)
+    //decodes to an identical flat structure, so adopt the one another
+    //phenotype already built when there is one
+    U64 hash=0;
+    GenomePtr owner=genotype.lock();
+    if (owner)
+        hash=owner->content_hash();
+    if (hash!=0)
+    {
+        StructureCache::iterator found=structure_cache().find(hash);
+        if (found!=structure_cache().end())
+        {
+            CompiledStructurePtr shared=found->second.lock();
+            //A structure cached under the other precision mode is no use:
+            //the F32 weight mirror is only there when the mode built it
+            if (shared &&
+                shared->weight32.size()
+                    != (single_precision_nets ? shared->weight.size() : 0))
+                shared.reset();
+            if (shared && structure_matches(*shared, all_nodes))
+            {
+                flat_structure=shared;
+                compile_state=COMPILE_READY;
+                return true;
+            }
+            if (!shared)
+                structure_cache().erase(found);
+        }
+    }
+
+    //Map each node to its row so links can be stored as row indices
+    hash_map<NNode*, size_t> node_rows;
+    row=0;
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        node_rows[curnode->get()]=row;
+    }
+
+    //Build a fresh structure; it becomes immutable once published
+    boost::shared_ptr<CompiledStructure> building(new CompiledStructure);
+    building->is_sensor.resize(num);
+    building->ftype.resize(num);
+    building->node_id.resize(num);
+    building->place.resize(num);
+    building->link_start.resize(num+1);
+
+    row=0;
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        building->is_sensor[row]=(((*curnode)->type)==SENSOR) ? 1 : 0;
+        building->ftype[row]=(*curnode)->ftype;
+        building->node_id[row]=(*curnode)->node_id;
+        building->place[row]=(*curnode)->gen_node_label;
+        building->link_start[row]=building->weight.size();
+
+        //Only non-sensor nodes sum their incoming links
+        if (((*curnode)->type)!=SENSOR)
+        {
+            for (curlink=((*curnode)->incoming).begin(); curlink!=((*curnode)->incoming).end(); ++curlink)
+            {
+                if ((*curlink)->time_delay)
+                {
+                    uncompile();
+                    compile_state=COMPILE_UNSUPPORTED;
+                    return false;
+                }
+                hash_map<NNode*, size_t>::iterator found=node_rows.find((*curlink)->get_in_node().get());
+                if (found==node_rows.end())
+                {
+                    //A link from outside all_nodes; the flat copy would miss it
+                    uncompile();
+                    compile_state=COMPILE_UNSUPPORTED;
+                    return false;
+                }
+                building->weight.push_back((*curlink)->weight);
+                building->src.push_back(found->second);
+            }
+        }
+    }
+    building->link_start[num]=building->weight.size();
+
+    //In F32 mode the sweep streams a single-precision weight mirror
+    if (single_precision_nets)
+    {
+        building->weight32.resize(building->weight.size());
+        for (size_t w=0; w<building->weight.size(); ++w)
+            building->weight32[w]=(F32)building->weight[w];
+    }
+
+    flat_structure=building;
+    if (hash!=0)
+    {
+        prune_structure_cache(structure_cache());
+        structure_cache()[hash]=flat_structure;
+    }
+
+    compile_state=COMPILE_READY;
+    return true;
+}
+
+// Throw away the flattened representation; a shared structure lives on
+// as long as any other network still references it
+void Network::uncompile()
+{
+    flat_structure.reset();
+    flat_node.clear();
+    flat_value.clear();
+    flat_out.clear();
+    flat_sum.clear();
+    flat_last.clear();
+    flat_last2.clear();
+    flat_count.clear();
+    flat_active.clear();
+    sig_rows.clear();
+    sig_sums.clear();
+    sig_vals.clear();
+    lin_rows.clear();
+    lin_sums.clear();
+    lin_vals.clear();
+    flat_out32.clear();
+    sig_sums32.clear();
+    sig_vals32.clear();
+    lin_sums32.clear();
+    lin_vals32.clear();
+    compile_state=COMPILE_NONE;
+
+    //uncompile() signals weights changed behind the net's back (e.g. by
+    //backprop), so the memoized answer is stale too
+    memo_settled=false;
+}
+
+namespace
+{
+    // The gather half of one activation sweep, specialized on the precision
+    // of the streamed weight and output arrays. The F32 instantiation is
+    // what single_precision_nets buys: half the bytes per link, twice the
+    // SIMD lanes. The per-row sums land in the F64 state array either way.
+    template <typename FloatT>
+    void sum_incoming_links(size_t num, const U8* is_sensor,
+                            const size_t* link_start, const FloatT* weight,
+                            const size_t* src, const FloatT* out,
+                            U8* active, F64* sums)
+    {
+        for (size_t i=0; i<num; ++i)
+        {
+            if (!is_sensor[i])
+            {
+                FloatT sum=0;
+                U8 act=0;
+                const size_t end=link_start[i+1];
+                for (size_t k=link_start[i]; k<end; ++k)
+                {
+                    const size_t s=src[k];
+                    sum+=weight[k]*out[s];
+                    if (active[s]||is_sensor[s])
+                        act=1;
+                }
+                sums[i]=sum;
+                active[i]=act;
+            }
+        }
+    }
+}
+
+// The flat version of activate(): the same sweeps, over contiguous arrays
+// Returns true on success
+bool Network::activate_compiled()
+{
+    const size_t num=flat_node.size();
+    bool onetime; //Make sure we at least activate once
+    S32 abortcount=0; //Used in case the output is somehow truncated from the network
+    size_t i, k;
+
+    //The structural half may be shared with other phenotypes of the same
+    //genome content and is read-only here
+    const vector<U8>& flat_is_sensor=flat_structure->is_sensor;
+    const vector<S32>& flat_ftype=flat_structure->ftype;
+    const vector<size_t>& flat_link_start=flat_structure->link_start;
+    const vector<F64>& flat_weight=flat_structure->weight;
+    const vector<size_t>& flat_src=flat_structure->src;
+    const vector<F32>& flat_weight32=flat_structure->weight32;
+
+    //Was this net compiled for the single-precision sweep?
+    const bool use32=!flat_out32.empty();
+
+    //Pull the current node state into the flat arrays; the nodes remain the
+    //source of truth between calls (load_sensors, flush, and overrides all
+    //go through them)
+    for (i=0; i<num; ++i)
+    {
+        NNode* node=flat_node[i];
+        flat_value[i]=node->activation;
+        flat_out[i]=node->get_active_out();
+        flat_last[i]=node->last_activation;
+        flat_last2[i]=node->last_activation2;
+        flat_count[i]=node->activation_count;
+        flat_active[i]=node->active_flag ? 1 : 0;
+        if (use32)
+            flat_out32[i]=(F32)flat_out[i];
+    }
+
+    //The flat equivalent of nodesoff(), scanned once up front; the cached
+    //settling depth then tells us how many sweeps to run before the node
+    //states need to be re-checked
+    bool off=false;
+    for (i=0; i<num; ++i)
+    {
+        if (flat_count[i]==0)
+        {
+            off=true;
+            break;
+        }
+    }
+    S32 settle=off ? max_depth() : 1;
+    if (settle<1)
+        settle=1;
+    S32 sweep=0;
+
+    onetime=false;
+
+    for (;;)
+    {
+        if (sweep>=settle&&onetime)
+        {
+            off=false;
+            for (i=0; i<num; ++i)
+            {
+                if (flat_count[i]==0)
+                {
+                    off=true;
+                    break;
+                }
+            }
+            if (!off)
+                break;
+        }
+
+        ++abortcount;
+
+        if (abortcount==20)
+        {
+            //Write the partial state back so an aborted activation looks
+            //the same as it does on the pointer-based path
+            for (i=0; i<num; ++i)
+            {
+                if (!flat_is_sensor[i])
+                {
+                    NNode* node=flat_node[i];
+                    node->activation=flat_value[i];
+                    node->activesum=flat_sum[i];
+                    node->active_flag=(flat_active[i]!=0);
+                    node->last_activation=flat_last[i];
+                    node->last_activation2=flat_last2[i];
+                    node->activation_count=flat_count[i];
+                }
+            }
+            return false;
+        }
+
+        // For each node, compute the sum of its incoming activation,
+        // streaming the precision the net was compiled for
+        if (num)
+        {
+            if (use32)
+                sum_incoming_links<F32>(num, &flat_is_sensor[0],
+                                        &flat_link_start[0],
+                                        flat_weight32.empty() ? NULL : &flat_weight32[0],
+                                        flat_src.empty() ? NULL : &flat_src[0],
+                                        &flat_out32[0], &flat_active[0],
+                                        &flat_sum[0]);
+            else
+                sum_incoming_links<F64>(num, &flat_is_sensor[0],
+                                        &flat_link_start[0],
+                                        flat_weight.empty() ? NULL : &flat_weight[0],
+                                        flat_src.empty() ? NULL : &flat_src[0],
+                                        &flat_out[0], &flat_active[0],
+                                        &flat_sum[0]);
+        }
+
+        // Now activate all the non-sensor nodes off their incoming activation:
+        // gather the activating rows per activation function, run the batch
+        // kernels over the packed sums, and scatter the results back
+        sig_rows.clear();
+        sig_sums.clear();
+        sig_sums32.clear();
+        lin_rows.clear();
+        lin_sums.clear();
+        lin_sums32.clear();
+        for (i=0; i<num; ++i)
+        {
+            if (!flat_is_sensor[i])
+            {
+                //Only activate if some active input came in
+                if (flat_active[i])
+                {
+                    //Keep a memory of activations for potential time delayed connections
+                    flat_last2[i]=flat_last[i];
+                    flat_last[i]=flat_value[i];
+
+                    //If the node is being overrided from outside,
+                    //stick in the override value
+                    if (flat_node[i]->overridden())
+                    {
+                        flat_value[i]=flat_node[i]->override_value;
+                        flat_node[i]->override=false;
+                        flat_out[i]=flat_value[i];
+                        if (use32)
+                            flat_out32[i]=(F32)flat_value[i];
+                    }
+                    else if (flat_ftype[i]==SIGMOID)
+                    {
+                        sig_rows.push_back(i);
+                        if (use32)
+                            sig_sums32.push_back((F32)flat_sum[i]);
+                        else
+                            sig_sums.push_back(flat_sum[i]);
+                    }
+                    else if (flat_ftype[i]==LINEAR)
+                    {
+                        lin_rows.push_back(i);
+                        if (use32)
+                            lin_sums32.push_back((F32)flat_sum[i]);
+                        else
+                            lin_sums.push_back(flat_sum[i]);
+                    }
+
+                    //Increment the activation_count
+                    //First activation cannot be from nothing!!
+                    flat_count[i]++;
+                }
+            }
+        }
+
+        if (!sig_rows.empty())
+        {
+            if (use32)
+            {
+                sig_vals32.resize(sig_sums32.size());
+                fsigmoid_batch(&sig_sums32[0], &sig_vals32[0], sig_sums32.size(), 4.924273f, 2.4621365f); //Sigmoidal activation- see comments under fsigmoid
+                for (k=0; k<sig_rows.size(); ++k)
+                {
+                    flat_value[sig_rows[k]]=sig_vals32[k];
+                    flat_out[sig_rows[k]]=sig_vals32[k];
+                    flat_out32[sig_rows[k]]=sig_vals32[k];
+                }
+            }
+            else
+            {
+                sig_vals.resize(sig_sums.size());
+                fsigmoid_batch(&sig_sums[0], &sig_vals[0], sig_sums.size(), 4.924273, 2.4621365); //Sigmoidal activation- see comments under fsigmoid
+                for (k=0; k<sig_rows.size(); ++k)
+                {
+                    flat_value[sig_rows[k]]=sig_vals[k];
+                    flat_out[sig_rows[k]]=sig_vals[k];
+                }
+            }
+        }
+        if (!lin_rows.empty())
+        {
+            if (use32)
+            {
+                lin_vals32.resize(lin_sums32.size());
+                flinear_batch(&lin_sums32[0], &lin_vals32[0], lin_sums32.size(), 1.0f, 0.0f);
+                for (k=0; k<lin_rows.size(); ++k)
+                {
+                    flat_value[lin_rows[k]]=lin_vals32[k];
+                    flat_out[lin_rows[k]]=lin_vals32[k];
+                    flat_out32[lin_rows[k]]=lin_vals32[k];
+                }
+            }
+            else
+            {
+                lin_vals.resize(lin_sums.size());
+                flinear_batch(&lin_sums[0], &lin_vals[0], lin_sums.size(), 1.0, 0.0);
+                for (k=0; k<lin_rows.size(); ++k)
+                {
+                    flat_value[lin_rows[k]]=lin_vals[k];
+                    flat_out[lin_rows[k]]=lin_vals[k];
+                }
+            }
+        }
+
+        ++sweep;
+        onetime=true;
+    }
+
+    //Write the results back to the nodes so everything downstream
+    //(get_outputs, genome operations, display) sees the usual state
+    for (i=0; i<num; ++i)
+    {
+        if (!flat_is_sensor[i])
+        {
+            NNode* node=flat_node[i];
+            node->activation=flat_value[i];
+            node->activesum=flat_sum[i];
+            node->active_flag=(flat_active[i]!=0);
+            node->last_activation=flat_last[i];
+            node->last_activation2=flat_last2[i];
+            node->activation_count=flat_count[i];
+        }
+    }
+
     return true;
 }
 
@@ -317,6 +910,10 @@ bool Network::activate()
 bool Network::backprop()
 {
     vector<NNodePtr>::iterator curnode;
+
+    //Backprop updates the link weights directly, so any flattened copy
+    //of them is about to go stale
+    uncompile();
     F64 add_amount; //For adding to the activesum
     bool onetime; //Make sure we at least activate once
     S32 abortcount=0; //Used in case the output is somehow truncated from the network
@@ -463,6 +1060,7 @@ void Network::add_output(NNodePtr out_node)
 void Network::load_sensors(const F64 *sensvals)
 {
     vector<NNodePtr>::iterator sensPtr;
+    const F64 *first=sensvals;
 
     for (sensPtr=inputs.begin(); sensPtr!=inputs.end(); ++sensPtr)
     {
@@ -472,6 +1070,8 @@ void Network::load_sensors(const F64 *sensvals)
             sensvals++;
         }
     }
+
+    memo_load(first, sensvals-first);
 }
 
 /**
@@ -500,6 +1100,11 @@ void Network::load_sensors(const vector<F64> &sensvals)
             (*sensPtr)->sensor_load(*valPtr);
         }
     }
+
+    if (!sensvals.empty())
+    {
+        memo_load(&sensvals[0], sensvals.size());
+    }
 }
 
 void Network::load_errors(const vector<F64> &errorvals)
@@ -512,6 +1117,9 @@ void Network::load_errors(const vector<F64> &errorvals)
     {
         (*outPtr)->error_load(*valPtr);
     }
+
+    //backprop will rewrite weights; the memoized answer is gone
+    memo_settled=false;
 }
 
 // Takes and array of output activations and OVERRIDES 
@@ -527,6 +1135,8 @@ void Network::override_outputs(F64* outvals)
         outvals++;
     }
 
+    //the outputs no longer follow from the memoized inputs
+    memo_settled=false;
 }
 
 void Network::give_name(const string& newname)
@@ -534,69 +1144,115 @@ void Network::give_name(const string& newname)
     name = newname;
 }
 
-// The following two methods recurse through a network from outputs
-// down in order to count the number of nodes and links in the network.
-// This can be useful for debugging genotype->phenotype spawning 
+// The following two methods walk the network from the outputs back in
+// order to count the number of nodes and links in the network.
+// This can be useful for debugging genotype->phenotype spawning
 // (to make sure their counts correspond)
+//
+// Both walks are iterative with a visited bitset indexed by all_nodes
+// row (the same row mapping that compile() uses). The old recursive
+// versions carried a seen list searched linearly per visit, which made
+// them quadratic in network size.
+
+// Map each node to its all_nodes row; nodes reached by the walk that are
+// not in all_nodes get fresh rows appended on the fly
+static size_t node_row(hash_map<NNode*, size_t> &node_rows,
+                       vector<U8> &visited, NNode* node)
+{
+    hash_map<NNode*, size_t>::iterator found=node_rows.find(node);
+    if (found==node_rows.end())
+    {
+        found=node_rows.insert(make_pair(node, visited.size())).first;
+        visited.push_back(0);
+    }
+    return found->second;
+}
 
 S32 Network::nodecount() const
 {
-    S32 counter=0;
+    hash_map<NNode*, size_t> node_rows;
+    size_t row=0;
     vector<NNodePtr>::const_iterator curnode;
-    vector<NNodePtr>::const_iterator location;
-    vector<NNodePtr> seenlist; //List of nodes not to doublecount
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        node_rows[curnode->get()]=row;
+    }
+
+    vector<U8> visited(row, 0);
+    vector<NNode*> stack;
+    S32 counter=0;
 
     for (curnode=outputs.begin(); curnode!=outputs.end(); ++curnode)
     {
-
-        location=find(seenlist.begin(), seenlist.end(), (*curnode));
-        if (location==seenlist.end())
-        {
-            counter++;
-            seenlist.push_back(*curnode);
-            nodecounthelper((*curnode), counter, seenlist);
-        }
+        stack.push_back(curnode->get());
     }
 
-    const_cast<S32&>(numnodes)=counter;
-
-    return counter;
+    while (!stack.empty())
+    {
+        NNode* node=stack.back();
+        stack.pop_back();
 
-}
+        const size_t noderow=node_row(node_rows, visited, node);
+        if (visited[noderow])
+            continue;
+        visited[noderow]=1;
 
-void Network::nodecounthelper(NNodePtr curnode, S32 &counter,
-                              vector<NNodePtr> &seenlist) const
-{
-    vector<LinkPtr> innodes=curnode->incoming;
-    vector<LinkPtr>::iterator curlink;
-    vector<NNodePtr>::iterator location;
+        counter++;
 
-    if (!((curnode->type)==SENSOR))
-    {
-        for (curlink=innodes.begin(); curlink!=innodes.end(); ++curlink)
+        // sensors are counted but not expanded
+        if (!((node->type)==SENSOR))
         {
-            location=find(seenlist.begin(), seenlist.end(), ((*curlink)->get_in_node()));
-            if (location==seenlist.end())
+            vector<LinkPtr>::const_iterator curlink;
+            for (curlink=node->incoming.begin(); curlink!=node->incoming.end(); ++curlink)
             {
-                counter++;
-                seenlist.push_back((*curlink)->get_in_node());
-                nodecounthelper((*curlink)->get_in_node(), counter, seenlist);
+                stack.push_back((*curlink)->get_in_node().get());
             }
         }
-
     }
 
+    const_cast<S32&>(numnodes)=counter;
+
+    return counter;
+
 }
 
 S32 Network::linkcount() const
 {
-    S32 counter=0;
+    hash_map<NNode*, size_t> node_rows;
+    size_t row=0;
     vector<NNodePtr>::const_iterator curnode;
-    vector<NNodePtr> seenlist; //List of nodes not to doublecount
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        node_rows[curnode->get()]=row;
+    }
+
+    vector<U8> visited(row, 0);
+    vector<NNode*> stack;
+    S32 counter=0;
 
     for (curnode=outputs.begin(); curnode!=outputs.end(); ++curnode)
     {
-        linkcounthelper((*curnode), counter, seenlist);
+        stack.push_back(curnode->get());
+    }
+
+    while (!stack.empty())
+    {
+        NNode* node=stack.back();
+        stack.pop_back();
+
+        const size_t noderow=node_row(node_rows, visited, node);
+        if (visited[noderow] || ((node->type)==SENSOR))
+            continue;
+        visited[noderow]=1;
+
+        // every incoming link of a newly seen non-sensor node is counted
+        counter+=(S32)node->incoming.size();
+
+        vector<LinkPtr>::const_iterator curlink;
+        for (curlink=node->incoming.begin(); curlink!=node->incoming.end(); ++curlink)
+        {
+            stack.push_back((*curlink)->get_in_node().get());
+        }
     }
 
     const_cast<S32&>(numlinks)=counter;
@@ -605,26 +1261,84 @@ S32 Network::linkcount() const
 
 }
 
-void Network::linkcounthelper(NNodePtr curnode, S32 &counter,
-                              vector<NNodePtr> &seenlist) const
+// Number of sweeps the first activation needs before every node has
+// activated: the largest distance of any node from a sensor, following
+// only the links that propagate the active flag (time-delayed links do
+// not). Computed once per network and cached; structural mutations mark
+// the phenotype stale and genesis() builds a fresh Network, so the cache
+// never needs explicit invalidation. Nodes that no sensor can reach make
+// the net unable to settle, which is reported as an effectively infinite
+// depth so activate() falls through to its abort limit.
+S32 Network::max_depth() const
 {
-    vector<LinkPtr> inlinks=curnode->incoming;
-    vector<LinkPtr>::iterator curlink;
-    vector<NNodePtr>::iterator location;
+    if (netdepth>=0)
+        return netdepth;
+
+    const S32 unreachable=S32(0x7fffffff);
+
+    hash_map<NNode*, size_t> node_rows;
+    size_t row=0;
+    vector<NNodePtr>::const_iterator curnode;
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        node_rows[curnode->get()]=row;
+    }
+
+    vector<S32> dist(row, unreachable);
+    row=0;
+    for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
+    {
+        if (((*curnode)->type)==SENSOR)
+            dist[row]=0;
+    }
 
-    location=find(seenlist.begin(), seenlist.end(), curnode);
-    if ((!((curnode->type)==SENSOR))&&(location==seenlist.end()))
+    // Relax distances over the incoming lists until they stop changing;
+    // a node activates one sweep after the earliest of its sources
+    bool changed=true;
+    size_t passes=0;
+    while (changed&&passes<dist.size())
     {
-        seenlist.push_back(curnode);
+        changed=false;
+        ++passes;
 
-        for (curlink=inlinks.begin(); curlink!=inlinks.end(); ++curlink)
+        row=0;
+        for (curnode=all_nodes.begin(); curnode!=all_nodes.end(); ++curnode, ++row)
         {
-            counter++;
-            linkcounthelper((*curlink)->get_in_node(), counter, seenlist);
+            if (((*curnode)->type)==SENSOR)
+                continue;
+
+            S32 best=unreachable;
+            vector<LinkPtr>::const_iterator curlink;
+            for (curlink=(*curnode)->incoming.begin(); curlink!=(*curnode)->incoming.end(); ++curlink)
+            {
+                if ((*curlink)->time_delay)
+                    continue;
+
+                hash_map<NNode*, size_t>::const_iterator found=
+                    node_rows.find((*curlink)->get_in_node().get());
+                if (found!=node_rows.end()&&dist[found->second]<best)
+                    best=dist[found->second];
+            }
+
+            if (best<unreachable&&best+1<dist[row])
+            {
+                dist[row]=best+1;
+                changed=true;
+            }
         }
+    }
 
+    S32 depth=0;
+    for (row=0; row<dist.size(); ++row)
+    {
+        if (dist[row]>depth)
+            depth=dist[row];
     }
 
+    const_cast<S32&>(netdepth)=depth;
+
+    return depth;
+
 }
 
 // Destroy will find every node in the network and subsequently
@@ -634,36 +1348,10 @@ void Network::linkcounthelper(NNodePtr curnode, S32 &counter,
 //       deleted here
 void Network::destroy()
 {
-    vector<NNodePtr>::iterator curnode;
-    vector<NNodePtr>::iterator location;
-    vector<NNodePtr> seenlist; //List of nodes not to doublecount
-
-    // Erase all nodes from all_nodes list 
+    // Erase all nodes from all_nodes list
     all_nodes.clear();
 }
 
-void Network::destroy_helper(NNodePtr curnode, vector<NNodePtr> &seenlist)
-{
-    vector<LinkPtr> innodes=curnode->incoming;
-    vector<LinkPtr>::iterator curlink;
-    vector<NNodePtr>::iterator location;
-
-    if (!((curnode->type)==SENSOR))
-    {
-        for (curlink=innodes.begin(); curlink!=innodes.end(); ++curlink)
-        {
-            location=find(seenlist.begin(), seenlist.end(), ((*curlink)->get_in_node()));
-            if (location==seenlist.end())
-            {
-                seenlist.push_back((*curlink)->get_in_node());
-                destroy_helper((*curlink)->get_in_node(), seenlist);
-            }
-        }
-
-    }
-
-}
-
 // This checks a POTENTIAL link between a potential in_node and potential out_node to see if it must be recurrent 
 bool Network::is_recur(NNodePtr potin_node, NNodePtr potout_node, S32 &count,
                        S32 thresh) const
@@ -697,18 +1385,4 @@ bool Network::is_recur(NNodePtr potin_node, NNodePtr potout_node, S32 &count,
     }
 }
 
-S32 Network::input_start()
-{
-    input_iter=inputs.begin();
-    return 1;
-}
 
-S32 Network::load_in(F64 d)
-{
-    (*input_iter)->sensor_load(d);
-    input_iter++;
-    if (input_iter==inputs.end())
-        return 0;
-    else
-        return 1;
-}
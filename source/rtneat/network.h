@@ -9,7 +9,33 @@ namespace NEAT
 {
     class Genome;
 
-    /// A NETWORK is a LIST of input NODEs and a LIST of output NODEs           
+    /// The immutable structural half of a flattened Network: one row per
+    /// node in all_nodes order, with the incoming links of all non-sensor
+    /// nodes packed back to back into weight/src so an activation sweep is
+    /// a streaming dot product over contiguous arrays. Never modified once
+    /// built, so phenotypes decoded from identical genome content share a
+    /// single instance (see the structure cache in network.cpp) and only
+    /// keep their activation state separately.
+    struct CompiledStructure
+    {
+        std::vector<U8>     is_sensor;  ///< 1 if the row's node is a SENSOR
+        std::vector<S32>    ftype;      ///< activation function tag per node
+        std::vector<S32>    node_id;    ///< genome node id per node
+        std::vector<S32>    place;      ///< gen_node_label per node (hidden/input/output/bias)
+        std::vector<size_t> link_start; ///< index of each row's first link (size N+1)
+        std::vector<F64>    weight;     ///< packed incoming link weights
+        std::vector<size_t> src;        ///< packed in-node row indices
+
+        /// F32 mirror of weight, filled only when the structure was built
+        /// with single_precision_nets set; the activation sweep then
+        /// streams this and the F32 output array instead of the F64 pair
+        std::vector<F32>    weight32;
+    };
+
+    /// shared immutable structure; networks hold it const
+    typedef boost::shared_ptr<const CompiledStructure> CompiledStructurePtr;
+
+    /// A NETWORK is a LIST of input NODEs and a LIST of output NODEs
     ///   The point of the network is to define a single entity which can evolve
     ///   or learn on its own, even though it may be part of a larger framework 
     class Network : public XMLSerializable
@@ -17,23 +43,89 @@ namespace NEAT
 
             friend class Genome;
             friend class boost::serialization::access;
-            Network() {}
+            Network() : numnodes(-1), numlinks(-1), netdepth(-1), net_id(0), adaptable(false), compile_state(COMPILE_NONE),
+                        memo_state(MEMO_UNKNOWN), memo_match(false), memo_settled(false) {}
 
         protected:
 
+            /// whether a flattened copy of the net is available for activation
+            enum CompileState
+            {
+                COMPILE_NONE,        ///< not yet attempted
+                COMPILE_READY,       ///< flat arrays are built and usable
+                COMPILE_UNSUPPORTED  ///< net uses features the flat path cannot handle
+            };
+
+            CompileState compile_state; ///< state of the flattened representation
+
+            // The flattened net: one row per node, in all_nodes order. The
+            // structural half lives in an immutable CompiledStructure that
+            // phenotypes of byte-identical genomes share - champion cloning
+            // and elitist survival duplicate a sizable slice of a steady
+            // population - while the node mapping and activation state below
+            // stay per-network.
+            CompiledStructurePtr flat_structure; ///< shared structural half of the flat net
+            std::vector<NNode*>  flat_node;      ///< raw node pointers, for overrides and write-back
+            std::vector<F64>     flat_value;     ///< activation per node
+            std::vector<F64>     flat_out;       ///< get_active_out() per node
+            std::vector<F64>     flat_sum;       ///< activesum per node
+            std::vector<F64>     flat_last;      ///< last_activation per node
+            std::vector<F64>     flat_last2;     ///< last_activation2 per node
+            std::vector<S32>     flat_count;     ///< activation_count per node
+            std::vector<U8>      flat_active;    ///< active_flag per node
+
+            /// F32 mirror of flat_out, sized only when the net compiled
+            /// with single_precision_nets set (empty means the F64 path)
+            std::vector<F32>     flat_out32;
+
+            // Scratch for the batched activation-function kernels: the rows
+            // activating this sweep are gathered per function, run through
+            // fsigmoid_batch/flinear_batch, and scattered back.
+            std::vector<size_t>  sig_rows;       ///< rows awaiting the sigmoid kernel
+            std::vector<F64>     sig_sums;       ///< their activesums, packed densely
+            std::vector<F64>     sig_vals;       ///< kernel results before scatter
+            std::vector<size_t>  lin_rows;       ///< rows awaiting the linear kernel
+            std::vector<F64>     lin_sums;       ///< their activesums, packed densely
+            std::vector<F64>     lin_vals;       ///< kernel results before scatter
+            std::vector<F32>     sig_sums32;     ///< F32-mode packed sigmoid sums
+            std::vector<F32>     sig_vals32;     ///< F32-mode sigmoid results
+            std::vector<F32>     lin_sums32;     ///< F32-mode packed linear sums
+            std::vector<F32>     lin_vals32;     ///< F32-mode linear results
+
+            /// run the activation sweeps over the flat arrays
+            bool activate_compiled();
+
+            // Input memoization: for a net whose outputs are a pure
+            // function of its inputs (no recurrent or time-delayed links,
+            // not adaptable), the node activations left by the previous
+            // activate() are already the right answer when the same sensor
+            // values are loaded again. Idle or blocked agents present
+            // bit-identical observations for many consecutive ticks, so a
+            // match skips the whole activation, not just its sweeps.
+            enum MemoState
+            {
+                MEMO_UNKNOWN,     ///< support not yet determined
+                MEMO_OK,          ///< outputs depend only on the inputs
+                MEMO_UNSUPPORTED  ///< history-dependent net; never skip
+            };
+
+            MemoState memo_state;         ///< can repeated activations be skipped?
+            std::vector<F64> memo_inputs; ///< sensor values behind the node state
+            bool memo_match;              ///< last load repeated memo_inputs exactly
+            bool memo_settled;            ///< node state reflects an activation of memo_inputs
+
+            /// determine (once) whether activations can be memoized
+            bool memoizable();
+
+            /// compare newly loaded sensor values against the ones behind
+            /// the current node state, recording them for the next load
+            void memo_load(const F64* values, size_t count);
+
             S32 numnodes; ///< The number of nodes in the net (-1 means not yet counted)
             S32 numlinks; ///< The number of links in the net (-1 means not yet counted)
-
-            std::vector<NNodePtr>::iterator input_iter; ///< For GUILE network inputting  //PFHACK
+            S32 netdepth; ///< Cached settling depth of the net (-1 means not yet computed)
 
             void destroy(); ///< Kills all nodes and links within
-            void destroy_helper(NNodePtr curnode,
-                                std::vector<NNodePtr> &seenlist); ///< helper for destroy()
-
-            void nodecounthelper(const NNodePtr curnode, S32 &counter,
-                                 std::vector<NNodePtr> &seenlist) const;
-            void linkcounthelper(const NNodePtr curnode, S32 &counter,
-                                 std::vector<NNodePtr> &seenlist) const;
 
         public:
 
@@ -72,6 +164,42 @@ namespace NEAT
             /// Activates the net such that all outputs are active
             bool activate();
 
+            /// Flatten the net into contiguous weight/index/function arrays so
+            /// that activate() can sweep them without chasing node and link
+            /// pointers. Returns false (and falls back to the pointer-based
+            /// path) for nets the flat path cannot reproduce exactly: adaptable
+            /// nets and nets with time-delayed connections.
+            bool compile();
+
+            /// Throw away the flattened representation; the next activate()
+            /// will try to rebuild it. Must be called whenever link weights
+            /// are changed behind the net's back (e.g. by backprop).
+            void uncompile();
+
+            /// Build the flat arrays if they have not been attempted yet;
+            /// returns whether they are usable (false for nets the flat
+            /// path cannot represent)
+            bool ensure_compiled()
+            {
+                if (compile_state == COMPILE_NONE)
+                    compile();
+                return compile_state == COMPILE_READY;
+            }
+
+            /// Read-only access to the flat arrays for zero-copy export.
+            /// Only meaningful after ensure_compiled() returns true, and
+            /// only until the next uncompile(); rows follow all_nodes
+            /// order, and the incoming links of row i occupy
+            /// [starts[i], starts[i+1]) of the link arrays.
+            /// @{
+            const std::vector<F64>&    compiled_weights() const { return flat_structure->weight; }
+            const std::vector<size_t>& compiled_link_sources() const { return flat_structure->src; }
+            const std::vector<size_t>& compiled_link_starts() const { return flat_structure->link_start; }
+            const std::vector<S32>&    compiled_node_ids() const { return flat_structure->node_id; }
+            const std::vector<S32>&    compiled_node_places() const { return flat_structure->place; }
+            const std::vector<F64>&    compiled_activations() const { return flat_out; }
+            /// @}
+
             /// Back-propagates error in the net such that all inputs are active
             bool backprop();
 
@@ -107,16 +235,18 @@ namespace NEAT
             /// Counts the number of links in the net if not yet counted
             S32 linkcount() const;
 
+            /// Number of activation sweeps the first activation needs before
+            /// every node has settled, computed once per network and cached.
+            /// Structural mutations rebuild the phenotype, so a fresh
+            /// Network recomputes it automatically.
+            S32 max_depth() const;
+
             /// This checks a POTENTIAL link between a potential in_node
             /// and potential out_node to see if it must be recurrent 
             /// Use count and thresh to jump out in the case of an infinite loop 
             bool is_recur(NNodePtr potin_node, NNodePtr potout_node,
                           S32 &count, S32 thresh) const;
 
-            /// Some functions to help GUILE input into Networks   //PFHACK
-            S32 input_start();
-            S32 load_in(F64 d);
-
             /// If all output are not active then return true
             bool outputsoff() const;
 
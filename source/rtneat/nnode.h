@@ -7,6 +7,7 @@
 #include <fstream>
 
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/serialization/split_member.hpp>
 #include "neat.h"
 #include "trait.h"
 #include "link.h"
@@ -14,6 +15,7 @@
 
 namespace NEAT
 {
+    struct PoolStats;
     enum nodetype
     {
         NEURON = 0,
@@ -50,32 +52,43 @@ namespace NEAT
             friend class Genome;
             friend class boost::serialization::access;
             
-            NNode() {}
+            NNode() : sensor_info(NULL) {}
 
     public:
-            bool active_flag; // To make sure outputs are active
-            F64 activesum; // The incoming activity before being processed 
-            F64 activation; // The total activation entering the NNode 
-            // NOT USED IN NEAT - covered by "activation" above
-            F64 output; // Output of the NNode- the value in the NNode 
-            std::vector<LinkPtr> incoming; // A list of pointers to incoming weighted signals from other nodes
-            std::vector<LinkWeakPtr> outgoing; // A list of pointers to links carrying this node's signal
+            //NNodes are allocated from a shared object pool (see
+            //objectpool.h) to keep reproduction churn away from
+            //the system allocator
+            static void* operator new(size_t size);
+            static void operator delete(void* p);
+
+            //Occupancy snapshot of the shared pool (see objectpool.h)
+            static PoolStats pool_stats();
+
+            // Metadata a typical node never carries: the sensor binding
+            // parsed from genome files for INPUT nodes. Kept behind a
+            // pointer allocated on demand, so the thousands of resident
+            // hidden and output nodes do not each pay for two empty
+            // strings.
+            struct SensorInfo
+            {
+                std::string name; // sensor class bound to this input
+                std::string args; // argument string for the sensor
+            };
 
+            // The members are grouped by size so the node packs tightly:
+            // doubles, then vectors and pointers, then 32-bit fields, with
+            // the flags collected at the end to share one word of padding.
+
+            F64 activesum; // The incoming activity before being processed
+            F64 activation; // The total activation entering the NNode
             F64 last_activation; // Holds the previous step's activation for recurrency
             F64 last_activation2; // Holds the activation BEFORE the prevous step's
-
-            bool gradient_flag; // To make sure inputs are active in backprop
-            F64 gradientsum; // The gradient activity before being processed 
+            F64 gradientsum; // The gradient activity before being processed
             F64 gradient; // Local gradient used in backprop
-            S32 gradient_count; // keeps track of which activation the node is currently in
-
-            nodetype type; // type is either NEURON or SENSOR
-
-            S32 activation_count; // keeps track of which activation the node is currently in
-
-            S32 node_id; // A node can be given an identification number for saving in files
+            F64 override_value; // Contains the activation value that will override this node's activation
 
-            functype ftype; // type is either SIGMOID ..or others that can be added
+            std::vector<LinkPtr> incoming; // A list of pointers to incoming weighted signals from other nodes
+            std::vector<LinkWeakPtr> outgoing; // A list of pointers to links carrying this node's signal
 
             // This is necessary for a special recurrent case when the innode
             // of a recurrent link is one time step ahead of the outnode.
@@ -83,33 +96,24 @@ namespace NEAT
 
             TraitPtr nodetrait; // Points to a trait of parameters
 
-            nodeplace gen_node_label; // Used for genetic marking of nodes
-
-
-            NNodePtr dup; // Used for Genome duplication
-
             NNodePtr analogue; // Used for Gene decoding
 
-            U32 linkcount;  // Used for making Lamarckian weight changes
-
-            bool override; // The NNode cannot compute its own output- something is overriding it
-
-            F64 override_value; // Contains the activation value that will override this node's activation
-
-            // Pointer to the Sensor corresponding to this Body.
-            std::string _sensorName;
-            std::string _sensorArgs;
-
-            bool frozen; // When frozen, cannot be mutated (meaning its trait pointer is fixed)
+            SensorInfo* sensor_info; // Sensor binding of INPUT nodes, NULL for the rest
 
+            S32 gradient_count; // keeps track of which activation the node is currently in
+            S32 activation_count; // keeps track of which activation the node is currently in
+            S32 node_id; // A node can be given an identification number for saving in files
             S32 trait_id; // identify the trait derived by this node
+            U32 linkcount;  // Used for making Lamarckian weight changes
 
-            // ************ LEARNING PARAMETERS *********** 
-            // The following parameters are for use in    
-            //   neurons that learn through habituation,
-            //   sensitization, or Hebbian-type processes  
+            nodetype type; // type is either NEURON or SENSOR
+            functype ftype; // type is either SIGMOID ..or others that can be added
+            nodeplace gen_node_label; // Used for genetic marking of nodes
 
-            F64 params[NEAT::num_trait_params];
+            bool active_flag; // To make sure outputs are active
+            bool gradient_flag; // To make sure inputs are active in backprop
+            bool override; // The NNode cannot compute its own output- something is overriding it
+            bool frozen; // When frozen, cannot be mutated (meaning its trait pointer is fixed)
 
             NNode(nodetype ntype, S32 nodeid);
 
@@ -180,19 +184,24 @@ namespace NEAT
             // (Lamarckian trasnfer of characteristics)
             void Lamarck();
 
+            // Attach a sensor binding to the node (INPUT nodes only)
+            void setSensorInfo(const std::string& name, const std::string& args);
+
             // Get the Name and Arguments for the Sensor
             std::string getSensorName()
             {
-                return _sensorName;
+                return sensor_info ? sensor_info->name : std::string();
             }
             std::string getSensorArgs()
             {
-                return _sensorArgs;
+                return sensor_info ? sensor_info->args : std::string();
             }
-            
-            /// serialize this object to/from a Boost serialization archive
+
+            /// serialize this object to a Boost serialization archive; the
+            /// sensor strings go through temporaries so the archive layout
+            /// stays the one the inline string members produced
             template<class Archive>
-            void serialize(Archive & ar, const unsigned int version)
+            void save(Archive & ar, const unsigned int version) const
             {
                 //LOG_F_DEBUG("rtNEAT", "serialize::nnode");
                 ar & BOOST_SERIALIZATION_NVP(node_id);
@@ -203,12 +212,38 @@ namespace NEAT
                 ar & BOOST_SERIALIZATION_NVP(ftype);
                 ar & BOOST_SERIALIZATION_NVP(nodetrait);
                 ar & BOOST_SERIALIZATION_NVP(gen_node_label);
+                std::string _sensorName(sensor_info ? sensor_info->name : std::string());
+                std::string _sensorArgs(sensor_info ? sensor_info->args : std::string());
+                ar & BOOST_SERIALIZATION_NVP(_sensorName);
+                ar & BOOST_SERIALIZATION_NVP(_sensorArgs);
+                ar & BOOST_SERIALIZATION_NVP(frozen);
+                ar & BOOST_SERIALIZATION_NVP(trait_id);
+            }
+
+            /// load this object from a Boost serialization archive
+            template<class Archive>
+            void load(Archive & ar, const unsigned int version)
+            {
+                ar & BOOST_SERIALIZATION_NVP(node_id);
+                ar & BOOST_SERIALIZATION_NVP(incoming);
+                ar & BOOST_SERIALIZATION_NVP(outgoing);
+                ar & BOOST_SERIALIZATION_NVP(type);
+                ar & BOOST_SERIALIZATION_NVP(activation_count);
+                ar & BOOST_SERIALIZATION_NVP(ftype);
+                ar & BOOST_SERIALIZATION_NVP(nodetrait);
+                ar & BOOST_SERIALIZATION_NVP(gen_node_label);
+                std::string _sensorName;
+                std::string _sensorArgs;
                 ar & BOOST_SERIALIZATION_NVP(_sensorName);
                 ar & BOOST_SERIALIZATION_NVP(_sensorArgs);
+                if (!_sensorName.empty() || !_sensorArgs.empty())
+                    setSensorInfo(_sensorName, _sensorArgs);
                 ar & BOOST_SERIALIZATION_NVP(frozen);
-                ar & BOOST_SERIALIZATION_NVP(trait_id);        
+                ar & BOOST_SERIALIZATION_NVP(trait_id);
             }
 
+            BOOST_SERIALIZATION_SPLIT_MEMBER()
+
     };
 
     std::ostream& operator<<(std::ostream& out, const NNodePtr& x);
@@ -0,0 +1,142 @@
+#ifndef _OBJECTPOOL_H_
+#define _OBJECTPOOL_H_
+
+#include <cstddef>
+#include <vector>
+#include <mutex>
+
+namespace NEAT
+{
+
+    // ---------------------------------------------
+    // POOLSTATS STRUCT:
+    //   A snapshot of one ObjectPool's occupancy,
+    //   for memory attribution and leak triage.
+    // ---------------------------------------------
+    struct PoolStats
+    {
+        size_t chunks; //Number of chunks carved so far
+        size_t capacity; //Total slots across all chunks
+        size_t in_use; //Slots currently handed out
+        size_t peak_in_use; //High-water mark of slots handed out
+        size_t reserved_bytes; //Bytes reserved by the chunks
+
+        PoolStats() :
+            chunks(0), capacity(0), in_use(0), peak_in_use(0), reserved_bytes(0)
+        {
+        }
+    };
+
+    // ---------------------------------------------
+    // OBJECTPOOL CLASS:
+    //   A chunked free-list allocator for the small,
+    //   heavily churned NEAT primitives (Genes,
+    //   NNodes, Links). Storage is carved out of
+    //   large chunks; freed slots go onto a free
+    //   list for reuse, and the chunks themselves
+    //   stay with the pool, so reproduction spikes
+    //   never hit the general-purpose allocator.
+    // ---------------------------------------------
+    template <class T> class ObjectPool
+    {
+
+        public:
+
+            explicit ObjectPool(size_t chunk_capacity=1024) :
+                chunk_capacity(chunk_capacity), free_head(0), in_use(0),
+                peak_in_use(0)
+            {
+            }
+
+            ~ObjectPool()
+            {
+                for (size_t i=0; i<chunks.size(); ++i)
+                {
+                    delete [] chunks[i];
+                }
+            }
+
+            //Grab storage for one T, reusing a freed slot when one exists
+            void* allocate()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!free_head)
+                    grow();
+                void* slot=free_head;
+                free_head=*static_cast<void**>(slot);
+                ++in_use;
+                if (in_use>peak_in_use)
+                    peak_in_use=in_use;
+                return slot;
+            }
+
+            //Return a slot to the free list for reuse
+            void release(void* slot)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                *static_cast<void**>(slot)=free_head;
+                free_head=slot;
+                --in_use;
+            }
+
+            //A snapshot of the pool's occupancy
+            PoolStats stats() const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                PoolStats s;
+                s.chunks=chunks.size();
+                s.capacity=chunks.size()*chunk_capacity;
+                s.in_use=in_use;
+                s.peak_in_use=peak_in_use;
+                s.reserved_bytes=chunks.size()*chunk_capacity*slot_size();
+                return s;
+            }
+
+            //Whether the slot was carved out of one of this pool's chunks
+            bool owns(const void* slot) const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const char* p=static_cast<const char*>(slot);
+                for (size_t i=0; i<chunks.size(); ++i)
+                {
+                    if (p>=chunks[i]&&p<chunks[i]+chunk_capacity*slot_size())
+                        return true;
+                }
+                return false;
+            }
+
+        private:
+
+            //Slots are rounded up to a multiple of 8 bytes so the doubles
+            //and pointers inside the pooled objects stay aligned, and are
+            //at least big enough to hold the free-list link
+            static size_t slot_size()
+            {
+                size_t size=(sizeof(T)+7)&~static_cast<size_t>(7);
+                return (size<sizeof(void*)) ? sizeof(void*) : size;
+            }
+
+            //Carve a new chunk into slots and thread them onto the free list
+            void grow()
+            {
+                char* chunk=new char[chunk_capacity*slot_size()];
+                chunks.push_back(chunk);
+                for (size_t i=0; i<chunk_capacity; ++i)
+                {
+                    void* slot=chunk+i*slot_size();
+                    *static_cast<void**>(slot)=free_head;
+                    free_head=slot;
+                }
+            }
+
+            size_t chunk_capacity; //Number of slots added per grow()
+            std::vector<char*> chunks; //The chunks the slots are carved from
+            void* free_head; //Head of the free list threaded through the slots
+            size_t in_use; //Slots currently handed out
+            size_t peak_in_use; //High-water mark of slots handed out
+            mutable std::mutex mutex; //Guards the free list and chunk list
+
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "neat.h"
 #include "organism.h"
 #include "network.h"
+#include "streamwriter.h"
 #include <string>
 #include <map>
 #include <sstream>
@@ -83,7 +84,7 @@ void Organism::update_genotype()
 bool Organism::print_to_file(const std::string& filename)
 {
 
-    ofstream oFile(filename.c_str());
+    StreamWriter oFile(filename);
     return write_to_file(oFile);
 }
 
@@ -3,10 +3,21 @@
 #include <vector>
 #include <cmath>
 #include <fstream>
+#include <algorithm>
 
 using namespace NEAT;
 using namespace std;
 
+namespace
+{
+    //the std heap helpers put the maximum at the front when given a
+    //"less than" comparator, so invert the descending order_orgs
+    bool heap_order_orgs(OrganismPtr x, OrganismPtr y)
+    {
+        return order_orgs(y, x);
+    }
+}
+
 //used to give pool console access
 namespace PoolConsole
 {
@@ -32,10 +43,25 @@ Pool::~Pool()
 
 bool Pool::rank()
 {
-    sort(organisms.begin(), organisms.end(), order_orgs);
+    //check the heap property in O(n) first and only rebuild when a
+    //fitness change actually broke it; the pool never needs a total
+    //order, just the best candidates at the top of the heap
+    if (!is_heap(organisms.begin(), organisms.end(), heap_order_orgs))
+    {
+        make_heap(organisms.begin(), organisms.end(), heap_order_orgs);
+    }
     return true;
 }
 
+void Pool::top_k(size_t k, vector<OrganismPtr>& out) const
+{
+    if (k > organisms.size())
+        k = organisms.size();
+    out.resize(k);
+    partial_sort_copy(organisms.begin(), organisms.end(),
+                      out.begin(), out.end(), order_orgs);
+}
+
 OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
                                 vector<SpeciesPtr> &sorted_species)
 {
@@ -88,32 +114,14 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
         return baby;
     }
 
-    rank(); //Make sure organisms are ordered by rank
-
-    //ADDED CODE (Ken) 
-    //Now transfer the list to elig_orgs without including the ones that are too young (Ken)
-    //for(curorg=organisms.begin();curorg!=organisms.end();++curorg) {
-    //	if ((*curorg)->time_alive >= NEAT::time_alive_minimum)
-    //		elig_orgs.push_back(*curorg);
-    //}
-
-    //Now elig_orgs should be an ordered list of mature organisms
-    //Special case: if it's empty, then just include all the organisms (age doesn't matter in this case) (Ken)
-    if (elig_orgs.size()==0)
-    {
-        for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
-        {
-            elig_orgs.push_back(*curorg);
-        }
-    }
-
-    //Now elig_orgs is guaranteed to contain either an ordered list of mature orgs or all the orgs (Ken)
-    //We may also want to check to see if we are getting pools of >1 organism (to make sure our survival_thresh is sensible) (Ken)
+    rank(); //Make sure the best organisms are selectable at the top of the heap
 
-    //Only choose from among the top ranked orgs
-    poolsize=static_cast<S32>((elig_orgs.size() - 1) * NEAT::survival_thresh);
+    //Only choose from among the top ranked orgs: a partial selection
+    //against the heap pulls out the survival_thresh fraction directly,
+    //instead of totally ordering the pool on every reproduction event
+    poolsize=static_cast<S32>((organisms.size() - 1) * NEAT::survival_thresh);
+    top_k(static_cast<size_t>(poolsize) + 1, elig_orgs);
     //Con::printf("elig_orgs = %i, poolsize = %i", elig_orgs.size(), poolsize);
-    //poolsize=(organisms.size()-1)*.9;
 
     //Compute total fitness of species for a roulette wheel
     //Note: You don't get much advantage from a roulette here
@@ -169,14 +177,14 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
         //Do the mutation depending on probabilities of 
         //various mutations
 
-        if (randfloat()<NEAT::mutate_add_node_prob)
+        if (randevent(NEAT::mutate_add_node_prob))
         {
             //cout<<"mutate add node"<<endl;
             new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
                                         pop->cur_innov_num);
             mut_struct_baby=true;
         }
-        else if (randfloat()<NEAT::mutate_add_link_prob)
+        else if (randevent(NEAT::mutate_add_link_prob))
         {
             //cout<<"mutate add link"<<endl;
             net_analogue=new_genome->genesis(generation);
@@ -191,33 +199,33 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
         {
             //If we didn't do a structural mutation, we do the other kinds
 
-            if (randfloat()<NEAT::mutate_random_trait_prob)
+            if (randevent(NEAT::mutate_random_trait_prob))
             {
                 //cout<<"mutate random trait"<<endl;
                 new_genome->mutate_random_trait();
             }
-            if (randfloat()<NEAT::mutate_link_trait_prob)
+            if (randevent(NEAT::mutate_link_trait_prob))
             {
                 //cout<<"mutate_link_trait"<<endl;
                 new_genome->mutate_link_trait(1);
             }
-            if (randfloat()<NEAT::mutate_node_trait_prob)
+            if (randevent(NEAT::mutate_node_trait_prob))
             {
                 //cout<<"mutate_node_trait"<<endl;
                 new_genome->mutate_node_trait(1);
             }
-            if (randfloat()<NEAT::mutate_link_weights_prob)
+            if (randevent(NEAT::mutate_link_weights_prob))
             {
                 //cout<<"mutate_link_weights"<<endl;
                 new_genome->mutate_link_weights(mut_power, 1.0, GAUSSIAN);
             }
-            if (randfloat()<NEAT::mutate_toggle_enable_prob)
+            if (randevent(NEAT::mutate_toggle_enable_prob))
             {
                 //cout<<"mutate toggle enable"<<endl;
                 new_genome->mutate_toggle_enable(1);
 
             }
-            if (randfloat()<NEAT::mutate_gene_reenable_prob)
+            if (randevent(NEAT::mutate_gene_reenable_prob))
             {
                 //cout<<"mutate gene reenable"<<endl;
                 new_genome->mutate_gene_reenable();
@@ -319,7 +327,7 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
         }
 
         //Perform mating based on probabilities of differrent mating types
-        if (randfloat()<NEAT::mate_multipoint_prob)
+        if (randevent(NEAT::mate_multipoint_prob))
         {
             new_genome=(mom->gnome)->mate_multipoint(dad->gnome, count, mom->fitness,
                                              dad->fitness, outside);
@@ -340,19 +348,19 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
 
         //Determine whether to mutate the baby's Genome
         //This is done randomly or if the mom and dad are the same organism
-        if ((randfloat()>NEAT::mate_only_prob)||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
+        if ((!randevent(NEAT::mate_only_prob))||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
         {
 
             //Do the mutation depending on probabilities of 
             //various mutations
-            if (randfloat()<NEAT::mutate_add_node_prob)
+            if (randevent(NEAT::mutate_add_node_prob))
             {
                 new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
                                             pop->cur_innov_num);
                 //  cout<<"mutate_add_node: "<<new_genome<<endl;
                 mut_struct_baby=true;
             }
-            else if (randfloat()<NEAT::mutate_add_link_prob)
+            else if (randevent(NEAT::mutate_add_link_prob))
             {
                 net_analogue=new_genome->genesis(generation);
                 new_genome->mutate_add_link(pop->innovations,
@@ -365,32 +373,32 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
             {
                 //Only do other mutations when not doing strurctural mutations
 
-                if (randfloat()<NEAT::mutate_random_trait_prob)
+                if (randevent(NEAT::mutate_random_trait_prob))
                 {
                     new_genome->mutate_random_trait();
                     //cout<<"..mutate random trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_link_trait_prob)
+                if (randevent(NEAT::mutate_link_trait_prob))
                 {
                     new_genome->mutate_link_trait(1);
                     //cout<<"..mutate link trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_node_trait_prob)
+                if (randevent(NEAT::mutate_node_trait_prob))
                 {
                     new_genome->mutate_node_trait(1);
                     //cout<<"mutate_node_trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_link_weights_prob)
+                if (randevent(NEAT::mutate_link_weights_prob))
                 {
                     new_genome->mutate_link_weights(mut_power, 1.0, GAUSSIAN);
                     //cout<<"mutate_link_weights: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_toggle_enable_prob)
+                if (randevent(NEAT::mutate_toggle_enable_prob))
                 {
                     new_genome->mutate_toggle_enable(1);
                     //cout<<"mutate_toggle_enable: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_gene_reenable_prob)
+                if (randevent(NEAT::mutate_gene_reenable_prob))
                 {
                     new_genome->mutate_gene_reenable();
                     //cout<<"mutate_gene_reenable: "<<new_genome<<endl;
@@ -474,7 +482,9 @@ OrganismPtr Pool::reproduce_one(S32 generation, PopulationPtr pop,
 
 bool Pool::add_Organism(OrganismPtr o)
 {
+    //maintain the max-heap incrementally instead of re-sorting later
     organisms.push_back(o);
+    push_heap(organisms.begin(), organisms.end(), heap_order_orgs);
     return true;
 }
 
@@ -488,7 +498,10 @@ bool Pool::remove_org(OrganismPtr org)
 
     assert(curorg != organisms.end());
 
-    organisms.erase(curorg);
+    //swap-pop and restore the heap rather than shifting the tail down
+    *curorg = organisms.back();
+    organisms.pop_back();
+    make_heap(organisms.begin(), organisms.end(), heap_order_orgs);
 
     return true;
 }
@@ -25,8 +25,11 @@ namespace NEAT
         public:
 
             int id;
-            int age; //The age of the Species 
-            std::vector<OrganismPtr> organisms;// = new std::vector(); //The organisms in the Species
+            int age; //The age of the Species
+            //The organisms in the pool, kept in max-heap order by fitness
+            //(best at the front) rather than fully sorted: realtime
+            //reproduction only ever needs the best few candidates
+            std::vector<OrganismPtr> organisms;
             double average_est; //When playing real-time allows estimating average fitness
 
             bool add_Organism(OrganismPtr o);
@@ -48,11 +51,18 @@ namespace NEAT
                 return organisms.empty();
             }
 
-            // *** Real-time methods *** 
+            // *** Real-time methods ***
 
-            //Place organisms in this species in order by their fitness
+            //Restore the fitness max-heap over the organisms after their
+            //fitness estimates have changed; checks the heap property in
+            //O(n) and only rebuilds when it is actually broken. The pool
+            //is never totally ordered, just kept selectable from the top.
             bool rank();
 
+            //Copy the k best organisms into out, best first, without
+            //ordering the rest of the pool (a partial selection)
+            void top_k(size_t k, std::vector<OrganismPtr>& out) const;
+
             //Empty the existing organisms in the memory pool, thus removing all organisms in the pool.
             bool flush()
             {
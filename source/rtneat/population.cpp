@@ -1,15 +1,73 @@
 #include "core/Common.h"
+#include "core/File.h"
+#include "core/TaskPool.h"
 #include "population.h"
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <set>
 #include <string>
 #include <fstream>
 #include <stdexcept>
+#include <boost/bind.hpp>
 
 using namespace std;
 using namespace NEAT;
 
+namespace
+{
+    //The worker pool shared by the epoch-time loops below; leaked on
+    //purpose so that it outlives any static population state at shutdown
+    OpenNero::TaskPool& epoch_task_pool()
+    {
+        static OpenNero::TaskPool* pool=new OpenNero::TaskPool();
+        return *pool;
+    }
+
+    //Fill in the compatibility of organisms [begin, end) against each of
+    //the given species representatives; compatibility only reads the two
+    //gene lists, so the rows can be computed concurrently
+    void compat_range(vector<OrganismPtr>* orgs,
+                      vector<GenomePtr>* reps,
+                      size_t begin, size_t end,
+                      vector<vector<F64> >* out)
+    {
+        for (size_t i=begin; i<end; ++i)
+        {
+            vector<F64>& row=(*out)[i];
+            row.resize(reps->size());
+            for (size_t j=0; j<reps->size(); ++j)
+            {
+                //If the fingerprint bound already reaches the threshold the
+                //pair is incompatible either way; skip the exact gene walk
+                F64 bound=((*orgs)[i]->gnome)->compatibility_lower_bound((*reps)[j]);
+                row[j]=(bound>=NEAT::compat_threshold)
+                    ? bound
+                    : ((*orgs)[i]->gnome)->compatibility((*reps)[j]);
+            }
+        }
+    }
+
+    //Build organisms [begin, end) of an initial spawn from the start
+    //genome; every organism reseeds the thread-local RNG stream from its
+    //own index, so the spawn comes out the same no matter how the chunks
+    //land on threads
+    void spawn_range(GenomePtr g, S32 begin, S32 end,
+                     vector<OrganismPtr>* out)
+    {
+        for (S32 count=begin; count<end; ++count)
+        {
+            reseed_rand_stream((U32)count, 0);
+            GenomePtr new_genome=g->duplicate(count);
+            new_genome->mutate_link_weights(1.0, 1.0, COLDGAUSSIAN);
+            new_genome->randomize_traits();
+            OrganismPtr new_organism(new Organism(0.0, new_genome, 1));
+            (*out)[count-1]=new_organism;
+        }
+    }
+}
+
 PopulationPtr Population::copy(PopulationPtr p) {
   //FIXME - size hardcoded
   PopulationPtr np(new Population(p->organisms[0]->gnome,1));
@@ -85,6 +143,37 @@ Population::Population(vector<Genome*> genomeList, F32 power)
     speciate();
 }
 
+//Rebuild a population around organisms restored from a delta checkpoint
+PopulationPtr Population::assemble(const vector<OrganismPtr>& orgs)
+{
+    PopulationPtr pop(new Population());
+
+    PopulationConsole::initConsole();
+    pop->winnergen=0;
+    pop->highest_fitness=0.0;
+    pop->highest_last_changed=0;
+
+    pop->organisms=orgs;
+
+    //Keep a record of the innovation and node number we are on
+    S32 node_id=0;
+    F64 innov_num=0;
+    for(vector<OrganismPtr>::const_iterator iter=orgs.begin(); iter!=orgs.end(); ++iter)
+    {
+        if((*iter)->gnome->get_last_node_id()>node_id)
+            node_id=(*iter)->gnome->get_last_node_id();
+        if((*iter)->gnome->get_last_gene_innovnum()>innov_num)
+            innov_num=(*iter)->gnome->get_last_gene_innovnum();
+    }
+    pop->cur_node_id=node_id;
+    pop->cur_innov_num=innov_num;
+
+    //Separate the restored organisms into species
+    pop->speciate();
+
+    return pop;
+}
+
 Population::Population(const std::string& filename)
 {
 
@@ -101,14 +190,14 @@ Population::Population(const std::string& filename)
     cur_node_id=0;
     cur_innov_num=0.0;
 
-    ifstream iFile(filename.c_str());
-    if (!iFile)
+    OpenNero::ReadOnlyFileView iView(filename);
+    if (!iView.IsOpen())
     {
         throw std::runtime_error("Could not open genome file: " + filename);
     }
+    OpenNero::FileViewInStream iFile(iView);
 
 		//FIXME - PUT '&& iFile' INTO IF STATEMENTS
-    else
     {
         bool md = false;
         string metadata;
@@ -161,8 +250,6 @@ Population::Population(const std::string& filename)
             }
         }
 
-        iFile.close();
-
         speciate();
 
     }
@@ -185,12 +272,12 @@ Population::Population(const std::string& filename, S32 size)
     cur_node_id=0;
     cur_innov_num=0.0;
 
-    ifstream iFile(filename.c_str());
-    if (!iFile)
+    OpenNero::ReadOnlyFileView iView(filename);
+    if (!iView.IsOpen())
     {
         throw std::runtime_error("Could not open genomes file for input: " + filename);
     }
-    else
+    OpenNero::FileViewInStream iFile(iView);
     {
         while (static_cast<S32>(organisms.size()) < size)
         {
@@ -249,7 +336,6 @@ Population::Population(const std::string& filename, S32 size)
             iFile.clear(); // clear end-of-file state
             iFile.seekg(0, ios::beg); // rewind the file pointer
         }
-        iFile.close();
         speciate();
     }
 }
@@ -306,26 +392,38 @@ bool Population::clone(GenomePtr g, S32 size, F32 power)
 bool Population::spawn(GenomePtr g, S32 size)
 {
     S32 count;
-    GenomePtr new_genome;
-    OrganismPtr new_organism;
 
-    //Create size copies of the Genome
-    //Start with perturbed linkweights
-    for (count=1; count<=size; count++)
+    //Create size copies of the Genome, starting with perturbed
+    //linkweights. The copies are independent of each other, so large
+    //populations are spawned in parallel chunks across the task pool and
+    //merged into the organism list in index order afterwards.
+    vector<OrganismPtr> spawned(size);
+
+    OpenNero::TaskPool& pool=epoch_task_pool();
+    size_t workers=pool.GetWorkerCount();
+    if (workers>1&&size>1)
     {
-        //cout<<"CREATING ORGANISM "<<count<<endl;
+        S32 chunk=(size+(S32)workers-1)/(S32)workers;
+        for (count=1; count<=size; count+=chunk)
+        {
+            S32 end=min(count+chunk, size+1);
+            pool.Submit(boost::bind(&spawn_range, g, count, end, &spawned));
+        }
+        pool.WaitAll();
+    }
+    else
+    {
+        spawn_range(g, 1, size+1, &spawned);
+    }
 
-        new_genome=g->duplicate(count);
-        //new_genome->mutate_link_weights(1.0,1.0,GAUSSIAN);
-        new_genome->mutate_link_weights(1.0, 1.0, COLDGAUSSIAN);
-        new_genome->randomize_traits();
-        new_organism.reset(new Organism(0.0,new_genome,1));
-        organisms.push_back(new_organism);
+    for (count=0; count<size; count++)
+    {
+        organisms.push_back(spawned[count]);
     }
 
     //Keep a record of the innovation and node number we are on
-    cur_node_id=new_genome->get_last_node_id();
-    cur_innov_num=new_genome->get_last_gene_innovnum();
+    cur_node_id=spawned[size-1]->gnome->get_last_node_id();
+    cur_innov_num=spawned[size-1]->gnome->get_last_gene_innovnum();
 
     //Separate the new Population into species
     speciate();
@@ -337,16 +435,49 @@ bool Population::speciate()
 {
     vector<OrganismPtr>::iterator curorg; //For stepping through Population
     vector<SpeciesPtr>::iterator curspecies; //Steps through species
-    OrganismPtr comporg; //Organism for comparison 
+    OrganismPtr comporg; //Organism for comparison
     SpeciesPtr newspecies; //For adding a new species
 
     S32 counter=0; //Species counter
 
+    //Precompute, in parallel, each organism's compatibility against the
+    //representatives of the species that already exist; the serial pass
+    //below then only walks gene lists for species created during the pass
+    size_t initial_species=species.size();
+    size_t orgidx;
+    vector<GenomePtr> reps;
+    for (size_t j=0; j<initial_species; ++j)
+    {
+        reps.push_back(species[j]->first()->gnome);
+    }
+    vector<vector<F64> > compat(organisms.size());
+    if (initial_species>0)
+    {
+        OpenNero::TaskPool& pool=epoch_task_pool();
+        size_t workers=pool.GetWorkerCount();
+        if (workers>1&&organisms.size()>1)
+        {
+            size_t chunk=(organisms.size()+workers-1)/workers;
+            for (size_t begin=0; begin<organisms.size(); begin+=chunk)
+            {
+                size_t end=min(begin+chunk, organisms.size());
+                pool.Submit(boost::bind(&compat_range, &organisms, &reps, begin, end, &compat));
+            }
+            pool.WaitAll();
+        }
+        else
+        {
+            compat_range(&organisms, &reps, 0, organisms.size(), &compat);
+        }
+    }
+
     //Step through all existing organisms
-    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    orgidx=0;
+    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg, ++orgidx)
     {
 
         //For each organism, search for a species it is compatible to
+        size_t speciesidx=0;
         curspecies=species.begin();
         if (curspecies==species.end())
         {
@@ -361,9 +492,23 @@ bool Population::speciate()
             comporg=(*curspecies)->first();
             while ((comporg.get()!=0)&&(curspecies!=species.end()))
             {
+                //Use the precomputed distance for the species that existed
+                //on entry; only species created during this pass need an
+                //exact check here, and the fingerprint bound prunes most
+                //of those before the gene walk
+                F64 comp;
+                if (speciesidx<initial_species)
+                {
+                    comp=compat[orgidx][speciesidx];
+                }
+                else
+                {
+                    comp=((*curorg)->gnome)->compatibility_lower_bound(comporg->gnome);
+                    if (comp<NEAT::compat_threshold)
+                        comp=((*curorg)->gnome)->compatibility(comporg->gnome);
+                }
 
-                if ((((*curorg)->gnome)->compatibility(comporg->gnome))
-                    <NEAT::compat_threshold)
+                if (comp<NEAT::compat_threshold)
                 {
 
                     //Found compatible species, so add this organism to it
@@ -376,6 +521,7 @@ bool Population::speciate()
 
                     //Keep searching for a matching species
                     ++curspecies;
+                    ++speciesidx;
                     if (curspecies!=species.end())
                         comporg=(*curspecies)->first();
                 }
@@ -396,6 +542,8 @@ bool Population::speciate()
 
     last_species=counter; //Keep track of highest species
 
+    speciation_order=species; //Fresh candidate order for the new speciation
+
     return true;
 }
 
@@ -493,22 +641,35 @@ bool Population::epoch(S32 generation)
 
     }
 
-    //Stick the Species pointers into a new Species list for sorting
+    //Stick the Species pointers into a new Species list (sorted by
+    //order_species further below, once the adjusted fitnesses are in)
     vector<SpeciesPtr> sorted_species(species.begin(), species.end());
 
-    //Sort the Species by max fitness (Use an extra list to do this)
-    //These need to use ORIGINAL fitness
-    sort(sorted_species.begin(), sorted_species.end(), order_species);
-
-    //Flag the lowest performing species over age 20 every 30 generations 
+    //Flag the lowest performing species over age 20 every 30 generations
     //NOTE: THIS IS FOR COMPETITIVE COEVOLUTION STAGNATION DETECTION
-
-    curspecies=sorted_species.end();
-    curspecies--;
-    while ((curspecies!=sorted_species.begin())&&((*curspecies)->age<20))
-        --curspecies;
+    //A single worst-member selection replaces the old full sort of the
+    //species list here, which existed only to serve this scan
     if ((generation%30)==0)
-        (*curspecies)->obliterate=true;
+    {
+        vector<SpeciesPtr>::iterator worst=sorted_species.end();
+        for (curspecies=sorted_species.begin(); curspecies!=sorted_species.end(); ++curspecies)
+        {
+            if ((*curspecies)->age<20)
+                continue;
+            if (worst==sorted_species.end()||order_species(*worst,*curspecies))
+                worst=curspecies;
+        }
+        if (worst==sorted_species.end())
+        {
+            //no species is old enough: fall back to the best species
+            //overall, matching the old scan running off the front of
+            //its sorted list
+            worst=min_element(sorted_species.begin(), sorted_species.end(),
+                              order_species);
+        }
+        if (worst!=sorted_species.end())
+            (*worst)->obliterate=true;
+    }
 
     // cout<<"Number of Species: "<<num_species<<endl;
     // cout<<"compat_thresh: "<<compat_threshold<<endl;
@@ -519,26 +680,50 @@ bool Population::epoch(S32 generation)
     //Also penalize stagnant species
     //Then adjust the fitness using the species size to "share" fitness
     //within a species.
-    //Then, within each Species, mark for death 
+    //Then, within each Species, mark for death
     //those below survival_thresh*average
-    for (curspecies=species.begin(); curspecies!=species.end(); ++curspecies)
+    //Each species only touches its own organisms, so the adjustments can
+    //run one species per task across the worker pool
+    if (epoch_task_pool().GetWorkerCount()>1&&species.size()>1)
+    {
+        for (curspecies=species.begin(); curspecies!=species.end(); ++curspecies)
+        {
+            epoch_task_pool().Submit(boost::bind(&Species::adjust_fitness, curspecies->get()));
+        }
+        epoch_task_pool().WaitAll();
+    }
+    else
     {
-        (*curspecies)->adjust_fitness();
+        for (curspecies=species.begin(); curspecies!=species.end(); ++curspecies)
+        {
+            (*curspecies)->adjust_fitness();
+        }
     }
 
-    //Go through the organisms and add up their fitnesses to compute the
+    //Mirror the freshly adjusted fitnesses into the packed array so the
+    //statistics passes below stream over contiguous doubles instead of
+    //chasing the per-organism heap objects
+    sync_stats_arrays();
+
+    //Go through the packed fitnesses and add them up to compute the
     //overall average
-    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    for (size_t slot=0; slot<stat_fitness.size(); ++slot)
     {
-        total+=(*curorg)->fitness;
+        total+=stat_fitness[slot];
     }
     overall_average=total/total_organisms;
     cout<<"Generation "<<generation<<": "<<"overall_average = "<<overall_average<<endl;
 
     //Now compute expected number of offspring for each individual organism
-    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    //as one packed divide, then scatter the results back to the organisms
+    //(count_offspring below reads the per-organism field)
+    for (size_t slot=0; slot<stat_fitness.size(); ++slot)
     {
-        (*curorg)->expected_offspring=(((*curorg)->fitness)/overall_average);
+        stat_expected_offspring[slot]=stat_fitness[slot]/overall_average;
+    }
+    for (size_t slot=0; slot<organisms.size(); ++slot)
+    {
+        organisms[slot]->expected_offspring=stat_expected_offspring[slot];
     }
 
     //Now add those offspring up within each Species to get the number of
@@ -923,6 +1108,11 @@ bool Population::epoch(S32 generation)
     //Remove the innovations of the current generation
     innovations.clear();
 
+    //Renumber the surviving innovations densely when the run has left
+    //the numbering sparse (compact_innovations skips the rewrite when
+    //it would buy little)
+    compact_innovations();
+
     //DEBUG: Check to see if the best species died somehow
     // We don't want this to happen
     curspecies=species.begin();
@@ -960,6 +1150,18 @@ bool Population::epoch(S32 generation)
 
 }
 
+void Population::sync_stats_arrays()
+{
+    size_t count = organisms.size();
+    stat_fitness.resize(count);
+    stat_expected_offspring.resize(count);
+    for (size_t slot=0; slot<count; ++slot)
+    {
+        stat_fitness[slot]=organisms[slot]->fitness;
+        stat_expected_offspring[slot]=organisms[slot]->expected_offspring;
+    }
+}
+
 bool Population::rank_within_species()
 {
     vector<SpeciesPtr>::iterator curspecies;
@@ -1050,9 +1252,66 @@ bool Population::remove_species(SpeciesPtr spec)
 
     assert(curspec != species.end());
     species.erase(curspec);
+
+    //Keep the speciation candidate order in sync
+    curspec=speciation_order.begin();
+    while ((curspec!=speciation_order.end())&&((*curspec)!=spec))
+        ++curspec;
+    if (curspec!=speciation_order.end())
+        speciation_order.erase(curspec);
+
     return true;
 }
 
+SpeciesPtr Population::find_species(OrganismPtr org, SpeciesPtr parent_species)
+{
+    OrganismPtr comporg; //For Species determination through comparison
+
+    //The parent's species is by far the most likely match, so test its
+    //representative before touching the candidate list
+    if (parent_species && parent_species->organisms.size() > 0)
+    {
+        comporg=parent_species->first();
+        if (comporg && ((org->gnome)->compatibility(comporg->gnome) < NEAT::compat_threshold))
+            return parent_species;
+    }
+
+    //The candidate order mirrors the species list; rebuild it whenever
+    //species have been created or removed behind its back
+    if (speciation_order.size() != species.size())
+        speciation_order=species;
+
+    for (size_t i=0; i<speciation_order.size(); ++i)
+    {
+        SpeciesPtr candidate=speciation_order[i];
+
+        if (candidate == parent_species)
+            continue; //already tested above
+        if (candidate->organisms.size() == 0)
+            continue; //no representative to compare against
+
+        comporg=candidate->first();
+        if ((org->gnome)->compatibility(comporg->gnome) < NEAT::compat_threshold)
+        {
+            //Reward the hit: float the species one slot toward the
+            //front so frequently matched species are tested early
+            if (i > 0)
+                swap(speciation_order[i-1], speciation_order[i]);
+            return candidate;
+        }
+    }
+
+    return SpeciesPtr(); //no compatible species exists
+}
+
+SpeciesPtr Population::create_species(bool novel)
+{
+    SpeciesPtr newspecies(new Species(++last_species, novel));
+    species.push_back(newspecies);
+    speciation_order.push_back(newspecies);
+    return newspecies;
+}
+
 OrganismPtr Population::remove_worst()
 {
 
@@ -1353,62 +1612,23 @@ OrganismPtr Population::reproduce_champ(S32 generation)
 void Population::reassign_species(OrganismPtr org)
 {
 
-    OrganismPtr comporg;
-    bool found=false; //Note we don't really need this flag but it
-    //might be useful if we change how this function works
-    vector<SpeciesPtr>::iterator curspecies;
-    SpeciesPtr newspecies;
-
-    curspecies=(species).begin();
+    //Search with the organism's current species as the first candidate:
+    //after a threshold change most organisms stay where they are, so
+    //this usually costs a single compatibility test
+    SpeciesPtr newspecies=find_species(org, org->species.lock());
 
-    comporg=(*curspecies)->first();
-    assert(comporg->gnome);
-    while ((curspecies!=(species).end()) && (!found))
-    {
-        if (!comporg)
-        {
-            //Keep searching for a matching species
-            ++curspecies;
-            if (curspecies!=(species).end())
-                comporg=(*curspecies)->first();
-        }
-        else if (((org->gnome)->compatibility(comporg->gnome))<NEAT::compat_threshold)
-        {
-            //If we found the same species it's already in, return 0
-            if ( *curspecies == org->species.lock() )
-            {
-                found=true;
-                break;
-            }
-            //Found compatible species
-            else
-            {
-                switch_species(org, org->species.lock(), (*curspecies));
-                found=true; //Note the search is over
-            }
-        }
-        else
-        {
-            //Keep searching for a matching species
-            ++curspecies;
-            if (curspecies!=(species).end())
-                comporg=(*curspecies)->first();
-        }
-    }
+    //If we found the same species it's already in, nothing to do
+    if (newspecies && newspecies == org->species.lock())
+        return;
 
-    //If we didn't find a match, create a new species, move the org to
-    // that species, check if the old species is empty, 
-    //re-estimate averages, and return 0
-    if (found==false)
-    {
+    //If we didn't find a match, create a new species for the org
+    if (!newspecies)
+        newspecies=create_species(true);
 
-        //Create a new species for the org
-        newspecies.reset(new Species(++(last_species),true));
-        (species).push_back(newspecies);
+    //Move the org, removing the old species if it becomes empty and
+    //re-estimating the averages of the species involved
+    switch_species(org, org->species.lock(), newspecies);
 
-        switch_species(org, org->species.lock(), newspecies);
-    }
-    
 }
 
 //Move an Organism from one Species to another
@@ -1444,62 +1664,184 @@ void Population::switch_species(OrganismPtr org, SpeciesPtr orig_species,
 // Add an organism to the population and to the proper species.
 void Population::add_organism(OrganismPtr org)
 {
-    vector<SpeciesPtr>::iterator curspecies; //For adding org
-    SpeciesPtr newspecies; //For orgs in new Species
-    OrganismPtr comporg; //For Species determination through comparison
-    bool found; //When a Species is found
+    //Search the existing species (there is no parent species here:
+    //immigrants and loaded organisms arrive without one)
+    SpeciesPtr newspecies=find_species(org, SpeciesPtr());
+
+    //If we didn't find a match, create a new species
+    if (!newspecies)
+        newspecies=create_species(true);
 
-    curspecies = species.begin();
-    if (curspecies == species.end())
+    newspecies->add_Organism(org); //Add the org
+    org->species=newspecies; //Point the org to its species
+
+    //Put the org also in the master organism list
+    organisms.push_back(org);
+}
+
+GenomePtr Population::champion_genome() const
+{
+    vector<OrganismPtr>::const_iterator curorg;
+    OrganismPtr champ;
+
+    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
     {
-        //Create the first species
-        newspecies.reset(new Species(++last_species,true));
-        species.push_back(newspecies);
-        newspecies->add_Organism(org); //Add the org
-        org->species=newspecies; //Point the org to its species
+        if (!champ || (*curorg)->fitness > champ->fitness)
+            champ=(*curorg);
     }
-    else
+
+    if (!champ)
+        return GenomePtr();
+    return champ->gnome;
+}
+
+OrganismPtr Population::integrate_genome(GenomePtr immigrant)
+{
+    OrganismPtr removed;
+    OrganismPtr baby;
+
+    if (!immigrant || organisms.empty())
+        return OrganismPtr();
+
+    //Make room for the immigrant by removing the current worst organism;
+    //remove_worst only removes organisms past the minimum time alive, so
+    //early in a run there may be nothing to replace yet
+    removed=remove_worst();
+    if (!removed)
+        return OrganismPtr();
+
+    //Wrap the immigrant genome in a new organism and speciate it exactly
+    //like a locally reproduced baby
+    baby.reset(new Organism(0.0,immigrant,1));
+    add_organism(baby);
+
+    return baby;
+}
+
+size_t Population::compact_innovations()
+{
+    vector<OrganismPtr>::iterator curorg;
+    vector<GenePtr>::iterator curgene;
+
+    //Collect every innovation number a genome still references; the
+    //sorted map doubles as the old-to-new renumbering table
+    map<F64,F64> renumber;
+    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
     {
-        comporg=(*curspecies)->first();
-        assert(comporg->gnome);
-        found=false;
+        GenomePtr gnome=(*curorg)->gnome;
+        for (curgene=gnome->genes.begin(); curgene!=gnome->genes.end(); ++curgene)
+            renumber[(*curgene)->innovation_num]=0;
+    }
+
+    //Already dense enough: renumbering would buy little, so leave the
+    //markers (and the registry) alone
+    if (renumber.empty() || cur_innov_num < 2*static_cast<F64>(renumber.size()))
+        return renumber.size();
+
+    //Assign the dense replacements in ascending order of the old
+    //numbers, so the relative order every alignment scan depends on is
+    //preserved
+    F64 next_num=1;
+    map<F64,F64>::iterator curpair;
+    for (curpair=renumber.begin(); curpair!=renumber.end(); ++curpair)
+    {
+        curpair->second=next_num;
+        next_num+=1;
+    }
+
+    //Rewrite the genomes; the flat gene-record mirrors hold the old
+    //numbers, so they are invalidated along the way
+    set<Genome*> rewritten;
+    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    {
+        GenomePtr gnome=(*curorg)->gnome;
+        if (!rewritten.insert(gnome.get()).second)
+            continue; //shared genome already renumbered
+        for (curgene=gnome->genes.begin(); curgene!=gnome->genes.end(); ++curgene)
+            (*curgene)->innovation_num=renumber[(*curgene)->innovation_num];
+        gnome->gene_records_valid=false;
+    }
+
+    //The recorded innovations refer to the pre-compaction numbering;
+    //drop them and let future structural mutations re-register
+    innovations.clear();
+    cur_innov_num=next_num;
+
+    return renumber.size();
+}
+
+std::vector<OrganismPtr> Population::remove_worst_n(size_t count)
+{
+    vector<OrganismPtr> removed;
+    if (count == 0)
+        return removed;
 
-        while ( curspecies != species.end() && (!found) )
+    //One scan partial-selects the count lowest adjusted fitnesses into a
+    //bounded max-heap (the heap root is the best of the current picks,
+    //so a better candidate replaces it)
+    typedef pair<F64, OrganismPtr> Candidate;
+    vector<Candidate> picks;
+    picks.reserve(count+1);
+
+    vector<OrganismPtr>::iterator curorg;
+    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    {
+        F64 adjusted_fitness=((*curorg)->fitness)/((*curorg)->species.lock()->organisms.size());
+
+        if ((*curorg)->smited)
         {
-            if (!comporg)
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=species.end())
-                    comporg=(*curspecies)->first();
-            }
-            else if (org->gnome->compatibility(comporg->gnome) < NEAT::compat_threshold )
-            {
-                //Found compatible species, so add this organism to it
-                (*curspecies)->add_Organism(org);
-                org->species=(*curspecies); //Point organism to its species
-                found=true; //Note the search is over
-            }
+            //get the next time multiple
+            U32 nextMultiple;
+            if ((*curorg)->time_alive % NEAT::time_alive_minimum == 0)
+                nextMultiple = (*curorg)->time_alive;
             else
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=species.end())
-                    comporg=(*curspecies)->first();
-            }
+                nextMultiple = NEAT::time_alive_minimum * ((*curorg)->time_alive / NEAT::time_alive_minimum + 1);
+
+            adjusted_fitness=-9999;
+            (*curorg)->time_alive = nextMultiple;
         }
 
-        //If we didn't find a match, create a new species
-        if (found==false)
+        if ((*curorg)->time_alive < static_cast<S32>(NEAT::time_alive_minimum))
+            continue; //not mature enough to be judged yet
+
+        if (picks.size() < count)
         {
-            newspecies.reset(new Species(++last_species,true));
-            species.push_back(newspecies);
-            newspecies->add_Organism(org); //Add the org
-            org->species=newspecies; //Point org to its species
+            picks.push_back(Candidate(adjusted_fitness,*curorg));
+            push_heap(picks.begin(),picks.end());
+        }
+        else if (adjusted_fitness < picks.front().first)
+        {
+            pop_heap(picks.begin(),picks.end());
+            picks.back()=Candidate(adjusted_fitness,*curorg);
+            push_heap(picks.begin(),picks.end());
         }
+    }
 
-    } //end else     
+    //Remove the picks worst-first, exactly as repeated remove_worst
+    //calls would return them
+    sort_heap(picks.begin(),picks.end());
+    for (size_t i = 0; i < picks.size(); ++i)
+    {
+        OrganismPtr org_to_kill=picks[i].second;
+        SpeciesPtr orgs_species=org_to_kill->species.lock();
 
-    //Put the org also in the master organism list
-    organisms.push_back(org);
+        //Remove the organism from its species and the population
+        orgs_species->remove_org(org_to_kill);
+        organisms.erase(find(organisms.begin(),organisms.end(),org_to_kill));
+
+        //Did the species become empty?
+        if (orgs_species->organisms.size()==0)
+        {
+            remove_species(orgs_species);
+        }
+        //If not, re-estimate the species average after removing the organism
+        else
+        {
+            orgs_species->estimate_average();
+        }
+
+        removed.push_back(org_to_kill);
+    }
+
+    return removed;
 }
@@ -39,10 +39,17 @@ namespace NEAT
 
 			std::vector<OrganismPtr> organisms; //The organisms in the Population
 
-            std::vector<SpeciesPtr> species; // Species in the Population. Note that the species should comprise all the genomes 
+            std::vector<SpeciesPtr> species; // Species in the Population. Note that the species should comprise all the genomes
+
+            // Candidate order for species assignment, kept roughly sorted
+            // by recent hit rate: every time find_species matches a
+            // species here it floats one slot toward the front. Not
+            // serialized; rebuilt from the species list whenever the two
+            // fall out of sync.
+            std::vector<SpeciesPtr> speciation_order;
 
             // ******* Member variables used during reproduction *******
-            std::vector<InnovationPtr> innovations; // For holding the genetic innovations of the newest generation
+            InnovationRegistry innovations; // For holding the genetic innovations of the newest generation
             S32 cur_node_id; //Current label number available
             F64 cur_innov_num;
 
@@ -53,6 +60,19 @@ namespace NEAT
             F64 variance;
             F64 standard_deviation;
 
+            // ******* Packed statistics mirrors *******
+            // Contiguous copies of the hot per-organism scalars in
+            // organisms order, refreshed by sync_stats_arrays() at the
+            // points in epoch where the originals have just changed, so
+            // the generation statistics run as streaming reductions over
+            // packed doubles instead of scattered loads through the
+            // per-organism heap objects.
+            std::vector<F64> stat_fitness;            ///< fitness per organism slot
+            std::vector<F64> stat_expected_offspring; ///< expected offspring per organism slot
+
+            // refresh the packed statistics mirrors from the organisms
+            void sync_stats_arrays();
+
             S32 winnergen; //An integer that when above zero tells when the first winner appeared
 
             // ******* When do we need to delta code? *******
@@ -77,10 +97,23 @@ namespace NEAT
             // Run verify on all Genomes in this Population (Debugging)
             bool verify();
 
-            // Turnover the population to a new generation using fitness 
+            // Turnover the population to a new generation using fitness
             // The generation argument is the next generation
             bool epoch(S32 generation);
 
+            // Renumber the innovations the genomes still use densely from
+            // 1, in one stop-the-world sweep over every genome. Long runs
+            // leave the innovation space sparse (most numbers belong to
+            // extinct structure), which widens checkpoints and spreads
+            // innovation-keyed tables thin. The renumbering preserves the
+            // relative order of the numbers, so gene alignment in
+            // crossover and compatibility is unchanged; the innovation
+            // registry is cleared since its entries refer to the old
+            // numbering. Skips the rewrite when the numbering is already
+            // dense enough. Returns the number of distinct innovation
+            // numbers in use.
+            size_t compact_innovations();
+
             // *** Real-time methods *** 
 
             // Places the organisms in species in order from best to worst fitness 
@@ -103,6 +136,18 @@ namespace NEAT
             //Remove a species from the species list (sometimes called by remove_worst when a species becomes empty)
             bool remove_species(SpeciesPtr spec);
 
+            // Find an existing species compatible with org, testing
+            // parent_species first: in steady-state realtime evolution
+            // nearly every offspring lands in its parent's species, so
+            // the full scan is almost always skipped. The remaining
+            // candidates are visited in speciation_order. Returns an
+            // empty pointer if no existing species is compatible.
+            SpeciesPtr find_species(OrganismPtr org, SpeciesPtr parent_species);
+
+            // Create a fresh species with the next species number and
+            // register it in the species list and the candidate order
+            SpeciesPtr create_species(bool novel);
+
             // Removes worst member of population that has been around for a minimum amount of time and returns
             // a pointer to the Organism that was removed (note that the pointer will not point to anything at all,
             // since the Organism it was pointing to has been deleted from memory)
@@ -113,6 +158,15 @@ namespace NEAT
             // Similar to remove_worst(), but considers only the first range organisms.
             OrganismPtr remove_worst(U32 range);
 
+            // Remove up to count eligible worst organisms in one pass: a
+            // single scan partial-selects the count lowest adjusted
+            // fitnesses into a bounded heap instead of rescanning the
+            // whole population per removal, which is what the realtime
+            // batch replacement loop otherwise does. Adjusted fitness is
+            // computed against the species sizes at the start of the
+            // call. Returns the removed organisms, worst first.
+            std::vector<OrganismPtr> remove_worst_n(size_t count);
+
             //KEN: New 2/17/04
             //This method takes an Organism and reassigns what Species it belongs to
             //It is meant to be used so that we can reasses where Organisms should belong
@@ -126,6 +180,18 @@ namespace NEAT
             // Add an organism to the population and to the proper species.
             void add_organism(OrganismPtr org);
 
+            // ******* Island-model migration *******
+
+            // The genome of the organism with the highest fitness
+            // (NULL if the population is empty)
+            GenomePtr champion_genome() const;
+
+            // Replace the current worst eligible organism with an immigrant
+            // genome received from another island; the immigrant is speciated
+            // like a freshly reproduced baby. Returns the new organism, or
+            // NULL if no organism was eligible for removal yet.
+            OrganismPtr integrate_genome(GenomePtr immigrant);
+
             // Construct off of a single spawning Genome 
             Population(GenomePtr g, S32 size);
 
@@ -143,7 +209,13 @@ namespace NEAT
             //// See the Genome constructor for the argument specifications
             //Population(int size,int i,int o, int nmax, bool r, double linkprob);
 
-            // Construct off of a file of Genomes 
+            // Rebuild a population from restored organisms (used by the
+            // delta checkpoint loader): adopts the organisms, recovers the
+            // node and innovation counters from their genomes, and
+            // respeciates
+            static PopulationPtr assemble(const std::vector<OrganismPtr>& orgs);
+
+            // Construct off of a file of Genomes
             Population(const std::string& filename);
 
             // Construct off of a file of Genomes to the specified size.
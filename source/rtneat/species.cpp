@@ -62,7 +62,18 @@ Species::~Species()
 
 bool Species::rank()
 {
-    sort(organisms.begin(), organisms.end(), order_orgs);
+    //rank() is called once per reproduction event, but between events only
+    //a couple of fitnesses actually change, so verify the order in O(n)
+    //and pay for the O(n log n) sort only when it is really broken
+    vector<OrganismPtr>::iterator curorg;
+    for (curorg=organisms.begin(); curorg!=organisms.end() && curorg+1!=organisms.end(); ++curorg)
+    {
+        if (order_orgs(*(curorg+1),*curorg))
+        {
+            sort(organisms.begin(), organisms.end(), order_orgs);
+            return true;
+        }
+    }
     return true;
 }
 
@@ -105,6 +116,11 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
     S32 count=generation; //This will assign genome id's according to the generation
     vector<OrganismPtr>::iterator curorg;
 
+    //Rekey this thread's random stream from the species id and the
+    //reproduction counter (unique per offspring in real-time NEAT), so the
+    //offspring comes out the same no matter which worker creates it
+    reseed_rand_stream((U32)id, (U32)generation);
+
     vector<OrganismPtr> elig_orgs; //This list contains the eligible organisms (KEN)
 
     S32 poolsize; //The number of Organisms in the old generation
@@ -115,9 +131,7 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
 
     GenomePtr new_genome; //For holding baby's genes
 
-    vector<SpeciesPtr>::iterator curspecies; //For adding baby
     SpeciesPtr newspecies; //For babies in new Species
-    OrganismPtr comporg; //For Species determination through comparison
 
     SpeciesPtr randspecies; //For mating outside the Species
     F64 randmult;
@@ -127,8 +141,6 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
 
     bool outside;
 
-    bool found; //When a Species is found
-
     S32 giveup; //For giving up finding a mate outside the species
 
     bool mut_struct_baby;
@@ -194,7 +206,7 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
 
     //First, decide whether to mate or mutate
     //If there is only one organism in the pool, then always mutate
-    if ((randfloat()<NEAT::mutate_only_prob)||poolsize == 0)
+    if ((randevent(NEAT::mutate_only_prob))||poolsize == 0)
     {
 
         //Choose the random parent
@@ -220,14 +232,14 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
         //Do the mutation depending on probabilities of 
         //various mutations
 
-        if (randfloat()<NEAT::mutate_add_node_prob)
+        if (randevent(NEAT::mutate_add_node_prob))
         {
             //cout<<"mutate add node"<<endl;
             new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
                                         pop->cur_innov_num);
             mut_struct_baby=true;
         }
-        else if (randfloat()<NEAT::mutate_add_link_prob)
+        else if (randevent(NEAT::mutate_add_link_prob))
         {
             //cout<<"mutate add link"<<endl;
             NetworkPtr net_analogue=new_genome->genesis(generation);
@@ -241,33 +253,33 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
         {
             //If we didn't do a structural mutation, we do the other kinds
 
-            if (randfloat()<NEAT::mutate_random_trait_prob)
+            if (randevent(NEAT::mutate_random_trait_prob))
             {
                 //cout<<"mutate random trait"<<endl;
                 new_genome->mutate_random_trait();
             }
-            if (randfloat()<NEAT::mutate_link_trait_prob)
+            if (randevent(NEAT::mutate_link_trait_prob))
             {
                 //cout<<"mutate_link_trait"<<endl;
                 new_genome->mutate_link_trait(1);
             }
-            if (randfloat()<NEAT::mutate_node_trait_prob)
+            if (randevent(NEAT::mutate_node_trait_prob))
             {
                 //cout<<"mutate_node_trait"<<endl;
                 new_genome->mutate_node_trait(1);
             }
-            if (randfloat()<NEAT::mutate_link_weights_prob)
+            if (randevent(NEAT::mutate_link_weights_prob))
             {
                 //cout<<"mutate_link_weights"<<endl;
                 new_genome->mutate_link_weights(mut_power, 1.0, GAUSSIAN);
             }
-            if (randfloat()<NEAT::mutate_toggle_enable_prob)
+            if (randevent(NEAT::mutate_toggle_enable_prob))
             {
                 //cout<<"mutate toggle enable"<<endl;
                 new_genome->mutate_toggle_enable(1);
 
             }
-            if (randfloat()<NEAT::mutate_gene_reenable_prob)
+            if (randevent(NEAT::mutate_gene_reenable_prob))
             {
                 //cout<<"mutate gene reenable"<<endl;
                 new_genome->mutate_gene_reenable();
@@ -357,7 +369,7 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
         }
 
         //Perform mating based on probabilities of differrent mating types
-        if (randfloat()<NEAT::mate_multipoint_prob)
+        if (randevent(NEAT::mate_multipoint_prob))
         {
             new_genome=(mom->gnome)->mate_multipoint(dad->gnome, count, mom->fitness,
                                              dad->fitness, outside);
@@ -378,19 +390,19 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
 
         //Determine whether to mutate the baby's Genome
         //This is done randomly or if the mom and dad are the same organism
-        if ((randfloat()>NEAT::mate_only_prob)||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
+        if ((!randevent(NEAT::mate_only_prob))||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
         {
 
             //Do the mutation depending on probabilities of 
             //various mutations
-            if (randfloat()<NEAT::mutate_add_node_prob)
+            if (randevent(NEAT::mutate_add_node_prob))
             {
                 new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
                                             pop->cur_innov_num);
                 //  cout<<"mutate_add_node: "<<new_genome<<endl;
                 mut_struct_baby=true;
             }
-            else if (randfloat()<NEAT::mutate_add_link_prob)
+            else if (randevent(NEAT::mutate_add_link_prob))
             {
                 NetworkPtr net_analogue=new_genome->genesis(generation);
                 new_genome->mutate_add_link(pop->innovations,
@@ -402,32 +414,32 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
             {
                 //Only do other mutations when not doing strurctural mutations
 
-                if (randfloat()<NEAT::mutate_random_trait_prob)
+                if (randevent(NEAT::mutate_random_trait_prob))
                 {
                     new_genome->mutate_random_trait();
                     //cout<<"..mutate random trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_link_trait_prob)
+                if (randevent(NEAT::mutate_link_trait_prob))
                 {
                     new_genome->mutate_link_trait(1);
                     //cout<<"..mutate link trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_node_trait_prob)
+                if (randevent(NEAT::mutate_node_trait_prob))
                 {
                     new_genome->mutate_node_trait(1);
                     //cout<<"mutate_node_trait: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_link_weights_prob)
+                if (randevent(NEAT::mutate_link_weights_prob))
                 {
                     new_genome->mutate_link_weights(mut_power, 1.0, GAUSSIAN);
                     //cout<<"mutate_link_weights: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_toggle_enable_prob)
+                if (randevent(NEAT::mutate_toggle_enable_prob))
                 {
                     new_genome->mutate_toggle_enable(1);
                     //cout<<"mutate_toggle_enable: "<<new_genome<<endl;
                 }
-                if (randfloat()<NEAT::mutate_gene_reenable_prob)
+                if (randevent(NEAT::mutate_gene_reenable_prob))
                 {
                     new_genome->mutate_gene_reenable();
                     //cout<<"mutate_gene_reenable: "<<new_genome<<endl;
@@ -452,56 +464,16 @@ OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
     baby->mut_struct_baby=mut_struct_baby;
     baby->mate_baby=mate_baby;
 
-    curspecies = pop->species.begin();
-    if (curspecies == pop->species.end())
-    {
-        //Create the first species
-        newspecies.reset(new Species(++(pop->last_species),true));
-        (pop->species).push_back(newspecies);
-        newspecies->add_Organism(baby); //Add the baby
-        baby->species=newspecies; //Point the baby to its species
-    }
-    else
-    {
-        comporg=(*curspecies)->first();
-        assert(comporg->gnome);
-        found=false;
-
-        while ( curspecies != pop->species.end() && (!found) )
-        {
-            if (!comporg)
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=(pop->species).end())
-                    comporg=(*curspecies)->first();
-            }
-            else if (baby->gnome->compatibility(comporg->gnome) < NEAT::compat_threshold )
-            {
-                //Found compatible species, so add this organism to it
-                (*curspecies)->add_Organism(baby);
-                baby->species=(*curspecies); //Point organism to its species
-                found=true; //Note the search is over
-            }
-            else
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=(pop->species).end())
-                    comporg=(*curspecies)->first();
-            }
-        }
+    //The baby almost always lands in its parent's species, so test this
+    //species first before scanning the rest of the population
+    newspecies=pop->find_species(baby, shared_from_this());
 
-        //If we didn't find a match, create a new species
-        if (found==false)
-        {
-            newspecies.reset(new Species(++(pop->last_species),true));
-            (pop->species).push_back(newspecies);
-            newspecies->add_Organism(baby); //Add the baby
-            baby->species=newspecies; //Point baby to its species
-        }
+    //If we didn't find a match, create a new species
+    if (!newspecies)
+        newspecies=pop->create_species(true);
 
-    } //end else     
+    newspecies->add_Organism(baby); //Add the baby
+    baby->species=newspecies; //Point the baby to its species     
 
     //Put the baby also in the master organism list
     (pop->organisms).push_back(baby);
@@ -640,8 +612,29 @@ void Species::adjust_fitness()
 
     }
 
-    //Sort the population and mark for death those after survival_thresh*pop_size
-    sort(organisms.begin(), organisms.end(), order_orgs);
+    //Decide how many get to reproduce based on survival_thresh*pop_size
+    //Adding 1.0 ensures that at least one will survive
+    num_parents=(int) floor((NEAT::survival_thresh*((double) organisms.size()))
+        +1.0);
+
+    //Partition the species at the survival cutoff instead of fully
+    //sorting it: everything below only needs the champion at the front,
+    //the parents ahead of the cutoff and the rest marked for death — a
+    //selection, not a total order
+    if (static_cast<size_t>(num_parents)<organisms.size())
+    {
+        nth_element(organisms.begin(), organisms.begin()+num_parents,
+                    organisms.end(), order_orgs);
+    }
+
+    //Bring the champion to the front of the parents (order_orgs compares
+    //descending, so min_element under it is the highest fitness)
+    vector<OrganismPtr>::iterator champ =
+        min_element(organisms.begin(),
+                    organisms.begin()+min(static_cast<size_t>(num_parents),
+                                          organisms.size()),
+                    order_orgs);
+    iter_swap(organisms.begin(), champ);
 
     //Update age_of_last_improvement here
     if (((*(organisms.begin()))->orig_fitness)>max_fitness_ever)
@@ -650,11 +643,6 @@ void Species::adjust_fitness()
         max_fitness_ever=((*(organisms.begin()))->orig_fitness);
     }
 
-    //Decide how many get to reproduce based on survival_thresh*pop_size
-    //Adding 1.0 ensures that at least one will survive
-    num_parents=(int) floor((NEAT::survival_thresh*((double) organisms.size()))
-        +1.0);
-
     //Mark for death those who are ranked too low to be parents
     curorg=organisms.begin();
     (*curorg)->champion=true; //Mark the champ as such
@@ -868,7 +856,7 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
         }
         //First, decide whether to mate or mutate
         //If there is only one organism in the pool, then always mutate
-        else if ((randfloat()<NEAT::mutate_only_prob)||poolsize== 0)
+        else if ((randevent(NEAT::mutate_only_prob))||poolsize== 0)
         {
 
             //Choose the random parent
@@ -899,14 +887,14 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
             //Do the mutation depending on probabilities of 
             //various mutations
 
-            if (randfloat()<NEAT::mutate_add_node_prob)
+            if (randevent(NEAT::mutate_add_node_prob))
             {
                 //cout<<"mutate add node"<<endl;
                 new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
                                             pop->cur_innov_num);
                 mut_struct_baby=true;
             }
-            else if (randfloat()<NEAT::mutate_add_link_prob)
+            else if (randevent(NEAT::mutate_add_link_prob))
             {
                 //cout<<"mutate add link"<<endl;
                 NetworkPtr net_analogue(new_genome->genesis(generation));
@@ -921,33 +909,33 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
             {
                 //If we didn't do a structural mutation, we do the other kinds
 
-                if (randfloat()<NEAT::mutate_random_trait_prob)
+                if (randevent(NEAT::mutate_random_trait_prob))
                 {
                     //cout<<"mutate random trait"<<endl;
                     new_genome->mutate_random_trait();
                 }
-                if (randfloat()<NEAT::mutate_link_trait_prob)
+                if (randevent(NEAT::mutate_link_trait_prob))
                 {
                     //cout<<"mutate_link_trait"<<endl;
                     new_genome->mutate_link_trait(1);
                 }
-                if (randfloat()<NEAT::mutate_node_trait_prob)
+                if (randevent(NEAT::mutate_node_trait_prob))
                 {
                     //cout<<"mutate_node_trait"<<endl;
                     new_genome->mutate_node_trait(1);
                 }
-                if (randfloat()<NEAT::mutate_link_weights_prob)
+                if (randevent(NEAT::mutate_link_weights_prob))
                 {
                     //cout<<"mutate_link_weights"<<endl;
                     new_genome->mutate_link_weights(mut_power, 1.0, GAUSSIAN);
                 }
-                if (randfloat()<NEAT::mutate_toggle_enable_prob)
+                if (randevent(NEAT::mutate_toggle_enable_prob))
                 {
                     //cout<<"mutate toggle enable"<<endl;
                     new_genome->mutate_toggle_enable(1);
 
                 }
-                if (randfloat()<NEAT::mutate_gene_reenable_prob)
+                if (randevent(NEAT::mutate_gene_reenable_prob))
                 {
                     //cout<<"mutate gene reenable"<<endl;
                     new_genome->mutate_gene_reenable();
@@ -1046,7 +1034,7 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
             }
 
             //Perform mating based on probabilities of differrent mating types
-            if (randfloat()<NEAT::mate_multipoint_prob)
+            if (randevent(NEAT::mate_multipoint_prob))
             {
                 new_genome=(mom->gnome)->mate_multipoint(dad->gnome, count,
                                                  mom->fitness, dad->fitness,
@@ -1068,12 +1056,12 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
 
             //Determine whether to mutate the baby's Genome
             //This is done randomly or if the mom and dad are the same organism
-            if ((randfloat()>NEAT::mate_only_prob)||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
+            if ((!randevent(NEAT::mate_only_prob))||((dad->gnome)->genome_id==(mom->gnome)->genome_id)||(((dad->gnome)->compatibility(mom->gnome))==0.0))
             {
 
                 //Do the mutation depending on probabilities of 
                 //various mutations
-                if (randfloat()<NEAT::mutate_add_node_prob)
+                if (randevent(NEAT::mutate_add_node_prob))
                 {
                     new_genome->mutate_add_node(pop->innovations,
                                                 pop->cur_node_id,
@@ -1081,7 +1069,7 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
                     //  cout<<"mutate_add_node: "<<new_genome<<endl;
                     mut_struct_baby=true;
                 }
-                else if (randfloat()<NEAT::mutate_add_link_prob)
+                else if (randevent(NEAT::mutate_add_link_prob))
                 {
                     NetworkPtr net_analogue=new_genome->genesis(generation);
                     new_genome->mutate_add_link(pop->innovations,
@@ -1093,33 +1081,33 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
                 {
                     //Only do other mutations when not doing sturctural mutations
 
-                    if (randfloat()<NEAT::mutate_random_trait_prob)
+                    if (randevent(NEAT::mutate_random_trait_prob))
                     {
                         new_genome->mutate_random_trait();
                         //cout<<"..mutate random trait: "<<new_genome<<endl;
                     }
-                    if (randfloat()<NEAT::mutate_link_trait_prob)
+                    if (randevent(NEAT::mutate_link_trait_prob))
                     {
                         new_genome->mutate_link_trait(1);
                         //cout<<"..mutate link trait: "<<new_genome<<endl;
                     }
-                    if (randfloat()<NEAT::mutate_node_trait_prob)
+                    if (randevent(NEAT::mutate_node_trait_prob))
                     {
                         new_genome->mutate_node_trait(1);
                         //cout<<"mutate_node_trait: "<<new_genome<<endl;
                     }
-                    if (randfloat()<NEAT::mutate_link_weights_prob)
+                    if (randevent(NEAT::mutate_link_weights_prob))
                     {
                         new_genome->mutate_link_weights(mut_power, 1.0,
                                                         GAUSSIAN);
                         //cout<<"mutate_link_weights: "<<new_genome<<endl;
                     }
-                    if (randfloat()<NEAT::mutate_toggle_enable_prob)
+                    if (randevent(NEAT::mutate_toggle_enable_prob))
                     {
                         new_genome->mutate_toggle_enable(1);
                         //cout<<"mutate_toggle_enable: "<<new_genome<<endl;
                     }
-                    if (randfloat()<NEAT::mutate_gene_reenable_prob)
+                    if (randevent(NEAT::mutate_gene_reenable_prob))
                     {
                         new_genome->mutate_gene_reenable();
                         //cout<<"mutate_gene_reenable: "<<new_genome<<endl;
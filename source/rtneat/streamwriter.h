@@ -0,0 +1,50 @@
+#ifndef _STREAMWRITER_H_
+#define _STREAMWRITER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace NEAT
+{
+    // A file output stream with a large private write buffer, for dumping
+    // populations and genomes mid-run. The default ofstream buffer flushes
+    // to the file descriptor every few hundred bytes, so printing a big
+    // population stalls the evolution thread on thousands of tiny writes;
+    // this stream reuses one 256 KB buffer and hands the kernel large
+    // contiguous chunks instead. It is an ofstream, so every existing
+    // print_to_file path can write to it unchanged, and nothing beyond the
+    // buffer is ever accumulated in memory. (gzip framing was considered
+    // and left out: OpenNERO does not link zlib - Irrlicht keeps its copy
+    // private to its own shared library.)
+    class StreamWriter : public std::ofstream
+    {
+        public:
+
+            StreamWriter()
+                : std::ofstream(), buffer(BUFFER_SIZE)
+            {
+                //must be installed before open() to take effect
+                rdbuf()->pubsetbuf(&buffer[0],
+                                   static_cast<std::streamsize>(buffer.size()));
+            }
+
+            explicit StreamWriter(const std::string& filename,
+                                  std::ios_base::openmode mode = std::ios_base::out)
+                : std::ofstream(), buffer(BUFFER_SIZE)
+            {
+                rdbuf()->pubsetbuf(&buffer[0],
+                                   static_cast<std::streamsize>(buffer.size()));
+                open(filename.c_str(), mode);
+            }
+
+        private:
+
+            static const size_t BUFFER_SIZE = 1 << 18; //256 KB of write buffering
+
+            std::vector<char> buffer; //the reused write buffer
+    };
+
+} // namespace NEAT
+
+#endif
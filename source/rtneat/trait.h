@@ -15,7 +15,7 @@ namespace NEAT
     //        algorithm from having to search vast parameter landscapes  
     //        on every node.  Instead, each node can simply point to a trait 
     //        and those traits can evolve on their own 
-    class Trait : public XMLSerializable
+    class Trait : public XMLSerializable, public RefCounted<Trait>
     {
             friend class boost::serialization::access;
 
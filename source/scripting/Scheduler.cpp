@@ -1,117 +1,135 @@
-//--------------------------------------------------------
-// OpenNero : Scheduler
-//  An event driven scripting scheduler
-//  October 9, 2007
-//--------------------------------------------------------
-
-#include "core/Common.h"
-#include "core/ONTime.h"
-#include "core/Algorithm.h"
-#include "scripting/Scheduler.h"
-#include "scripting/scripting.h"
-
-namespace OpenNero
-{
-    /// functor for comparing two events based on time
-    struct CompareEventExecTime
-    {
-    	/// @return true iff x is scheduled for earlier or identical time to that of y
-        bool operator() ( const Scheduler::EventInfo& x, const Scheduler::EventInfo& y ) const
-        {
-            return x.mExecTime <= y.mExecTime;
-        }
-    };
-
-    /// functor for finding an event by its id
-    struct FindEventByEventId
-    {
-    	/// desired event ID
-        const Scheduler::EventId mDesiredId;
-
-        /// @param id event id to find
-        FindEventByEventId( const Scheduler::EventId& id )
-            : mDesiredId(id)
-        {}
-
-        /// perform the search operation
-        /// @param x event information to look for
-        bool operator() ( const Scheduler::EventInfo& x ) const
-        {
-            return mDesiredId == x.mEventId;
-        }
-    };
-
-
-
-    Scheduler::EventInfo::EventInfo( const EventId& id, uint32_t execTime, const ScriptCommand& command ) :
-    	mEventId(id),
-    	mExecTime(execTime),
-    	mCommand(command)
-    {}
-
-
-
-    Scheduler::EventId Scheduler::sEventId = 0;
-
-    Scheduler::EventId Scheduler::ScheduleEvent( uint32_t timeOffsetMs, const ScriptCommand& command )
-    {
-        // calculate the execution time
-        const uint32_t execTime = GetStaticTimer().getMilliseconds() + timeOffsetMs;
-
-        // insert the info into the event list
-        EventInfo info( sEventId++, execTime, command );
-        mEvents.insert( std::lower_bound( mEvents.begin(), mEvents.end(), info, CompareEventExecTime() ), info );
-
-        return info.mEventId;
-    }
-
-    uint32_t Scheduler::RushEvents()
-    {
-        if( !mEvents.empty() )
-            return RushEvents( mEvents.back().mExecTime );
-
-        return 0;
-    }
-
-    uint32_t Scheduler::RushEvents( uint32_t endTime )
-    {
-        EventInfoList::iterator start = mEvents.begin();
-        EventInfoList::iterator itr   = start;
-        EventInfoList::iterator end   = mEvents.end();
-
-        uint32_t c = 0;
-
-        for( ; ( itr != end ) && ( itr->mExecTime <= endTime ); ++itr, ++c )
-            ExecEvent(*itr);
-
-        mEvents.erase( start, itr );
-
-        return c;
-    }
-
-    void Scheduler::ClearEvents()
-    {
-        mEvents.clear();
-    }
-
-    bool Scheduler::CancelEvent( const EventId& eventId )
-    {
-        EventInfoList::iterator itr = std::find_if( mEvents.begin(), mEvents.end(), FindEventByEventId(eventId) );
-        if( itr == mEvents.end() )
-            return false;
-
-        mEvents.erase(itr);
-        return true;
-    }
-
-    uint32_t Scheduler::ProcessEvents()
-    {
-        return RushEvents( GetStaticTimer().getMilliseconds() );
-    }
-
-    bool Scheduler::ExecEvent( const EventInfo& event )
-    {
-        ScriptingEngine& se = ScriptingEngine::instance();
-        return se.Exec(event.mCommand);
-    }
-}
+//--------------------------------------------------------
+// OpenNero : Scheduler
+//  An event driven scripting scheduler
+//  October 9, 2007
+//--------------------------------------------------------
+
+#include <algorithm>
+#include "core/Common.h"
+#include "core/ONTime.h"
+#include "scripting/Scheduler.h"
+#include "scripting/scripting.h"
+
+namespace OpenNero
+{
+    /// functor ordering the event heap so that the soonest event is on top;
+    /// ties are broken by id so that same-time events fire in schedule order
+    struct CompareEventExecTime
+    {
+    	/// @return true iff x should sink below y in the min-heap
+        bool operator() ( const Scheduler::EventInfo& x, const Scheduler::EventInfo& y ) const
+        {
+            if( x.mExecTime != y.mExecTime )
+                return x.mExecTime > y.mExecTime;
+            return x.mEventId > y.mEventId;
+        }
+    };
+
+
+
+    Scheduler::EventInfo::EventInfo( const EventId& id, uint32_t execTime, const ScriptCommand& command, const boost::python::object& code ) :
+    	mEventId(id),
+    	mExecTime(execTime),
+    	mCommand(command),
+    	mCode(code)
+    {}
+
+
+
+    Scheduler::EventId Scheduler::sEventId = 0;
+
+    Scheduler::EventId Scheduler::ScheduleEvent( uint32_t timeOffsetMs, const ScriptCommand& command )
+    {
+        // calculate the execution time
+        const uint32_t execTime = GetStaticTimer().getMilliseconds() + timeOffsetMs;
+
+        // compile the command once so that firing never re-parses the text
+        CodeCache::iterator code = mCodeCache.find(command);
+        if( code == mCodeCache.end() )
+        {
+            code = mCodeCache.insert( std::make_pair( command, ScriptingEngine::instance().Compile(command) ) ).first;
+        }
+
+        // push the info onto the event heap
+        EventInfo info( sEventId++, execTime, command, code->second );
+        mEvents.push_back(info);
+        std::push_heap( mEvents.begin(), mEvents.end(), CompareEventExecTime() );
+        mPending[info.mEventId] = false;
+
+        return info.mEventId;
+    }
+
+    Scheduler::EventInfo Scheduler::PopEvent()
+    {
+        std::pop_heap( mEvents.begin(), mEvents.end(), CompareEventExecTime() );
+        EventInfo info = mEvents.back();
+        mEvents.pop_back();
+        return info;
+    }
+
+    uint32_t Scheduler::RushEvents()
+    {
+        uint32_t latest = 0;
+        EventHeap::const_iterator itr = mEvents.begin();
+        EventHeap::const_iterator end = mEvents.end();
+        for( ; itr != end; ++itr )
+            latest = std::max( latest, itr->mExecTime );
+
+        return RushEvents( latest );
+    }
+
+    uint32_t Scheduler::RushEvents( uint32_t endTime )
+    {
+        uint32_t c = 0;
+
+        while( !mEvents.empty() && mEvents.front().mExecTime <= endTime )
+        {
+            EventInfo info = PopEvent();
+
+            PendingMap::iterator pending = mPending.find(info.mEventId);
+            const bool cancelled = ( pending != mPending.end() && pending->second );
+            if( pending != mPending.end() )
+                mPending.erase(pending);
+
+            if( !cancelled )
+            {
+                ExecEvent(info);
+                ++c;
+            }
+        }
+
+        return c;
+    }
+
+    void Scheduler::ClearEvents()
+    {
+        mEvents.clear();
+        mPending.clear();
+    }
+
+    bool Scheduler::CancelEvent( const EventId& eventId )
+    {
+        PendingMap::iterator itr = mPending.find(eventId);
+        if( itr == mPending.end() || itr->second )
+            return false;
+
+        // mark as cancelled; the heap entry is skipped when it surfaces
+        itr->second = true;
+        return true;
+    }
+
+    uint32_t Scheduler::ProcessEvents()
+    {
+        return RushEvents( GetStaticTimer().getMilliseconds() );
+    }
+
+    bool Scheduler::ExecEvent( const EventInfo& event )
+    {
+        ScriptingEngine& se = ScriptingEngine::instance();
+        if( event.mCode.ptr() != Py_None )
+            return se.ExecCode( event.mCode );
+
+        // compilation failed at schedule time; fall back to the raw text
+        return se.Exec( event.mCommand );
+    }
+}
@@ -8,8 +8,10 @@
 #define _SCRIPTING_SCHEDULER_H_
 
 #include <string>
-#include <list>
+#include <vector>
 #include "core/ONTypes.h"
+#include "core/HashMap.h"
+#include "scripting/scriptIncludes.h"
 
 namespace OpenNero
 {
@@ -56,21 +58,28 @@ namespace OpenNero
     private:
 
         friend struct CompareEventExecTime;
-        friend struct FindEventByEventId;
 
         /// The information relevant to a single event
         struct EventInfo
         {
-            EventInfo( const EventId& id, uint32_t execTime, const ScriptCommand& command );
+            EventInfo( const EventId& id, uint32_t execTime, const ScriptCommand& command, const boost::python::object& code );
 
             EventId             mEventId;       ///< The identifier for the event
             uint32_t            mExecTime;      ///< The time in real time when the event should execute
             ScriptCommand       mCommand;       ///< The command to execute when the time comes
+            boost::python::object mCode;        ///< the command pre-compiled to a Python code object
         };
 
     private:
 
-        typedef std::list<EventInfo> EventInfoList;
+        /// pending events as a binary min-heap over a vector, soonest on top
+        typedef std::vector<EventInfo> EventHeap;
+
+        /// compiled code objects cached by command text
+        typedef hash_map<ScriptCommand, boost::python::object> CodeCache;
+
+        /// pending event ids mapped to their cancelled flag
+        typedef hash_map<EventId, bool> PendingMap;
 
     private:
 
@@ -79,6 +88,9 @@ namespace OpenNero
         /// @return true if the script command did not fail
         bool ExecEvent( const EventInfo& event );
 
+        /// Pop the soonest pending event off the heap
+        EventInfo PopEvent();
+
     private:
 
         /// An identifier generator
@@ -86,8 +98,16 @@ namespace OpenNero
 
     private:
 
-        /// our pending events sorted by proximity in time, soonest first.
-        EventInfoList           mEvents;
+        /// our pending events heap-ordered by proximity in time, soonest first
+        EventHeap               mEvents;
+
+        /// command strings compiled once at schedule time; spawn/respawn
+        /// loops that re-schedule the same text hit the cache
+        CodeCache               mCodeCache;
+
+        /// ids of events still in the heap; cancellation is recorded here
+        /// and the heap entry is discarded when it surfaces
+        PendingMap              mPending;
     };
 }
 
@@ -14,29 +14,60 @@
 // this section has one include for each ExportXXXScripts function
 #include "ai/AI.h"
 #include "ai/AIManager.h"
+#include "ai/AIObject.h"
+#include "ai/Autosave.h"
+#include "ai/TrajectoryLog.h"
 #include "ai/AgentBrain.h"
 #include "ai/rl/TD.h"
 #include "ai/rl/Sarsa.h"
 #include "ai/rl/QLearning.h"
 #include "ai/Environment.h"
+#include "ai/env/MazeEnvironment.h"
+#include "ai/env/RoombaEnvironment.h"
+#include "ai/planning/Planner.h"
 #include "ai/rtneat/rtNEAT.h"
+#include "rtneat/island.h"
 #include "ai/sensors/Sensor.h"
 #include "ai/sensors/RaySensor.h"
 #include "ai/sensors/RadarSensor.h"
 #include "ai/sensors/SensorArray.h"
 #include "core/IrrUtil.h"
+#include "core/ONTime.h"
 #include "game/Kernel.h"
+#include "game/CombatService.h"
+#include "game/Mod.h"
+#include "game/ModBundle.h"
 #include "game/objects/PropertyMap.h"
 #include "scripting/Scheduler.h"
 #include "scripting/scripting.h"
+#include "game/SimEntity.h"
 #include "game/SimEntityData.h"
+#include "game/SimEntityProxy.h"
 #include "game/SimContext.h"
+#include "game/Simulation.h"
+#include "game/StateReplayer.h"
+#include "game/SimContextPool.h"
+#include "game/TickGovernor.h"
+#include "utils/Profiler.h"
+#include "utils/MemoryMonitor.h"
+#include "utils/MetricsServer.h"
+#include "game/factories/SimFactory.h"
+#include "game/factories/IrrFactory.h"
 #include "input/IOMapping.h"
 #include "render/Camera.h"
+#include "render/FPSCounter.h"
+#include "render/FrameCapture.h"
 
 // GUI is exported separately in gui/GuiExports.cpp
 #include "gui/GuiExports.h"
 
+#include <algorithm>
+#include <vector>
+
+#if !NERO_PLATFORM_WINDOWS
+#include <sys/resource.h>
+#endif
+
 namespace b = boost;
 namespace py = boost::python;
 
@@ -60,6 +91,8 @@ namespace OpenNero {
                 .def("teleport", &AgentBrain::Teleport, "Causes the agent to ignore collisions and to be placed exactly where specified by state")
                 .def_readonly("step", &AgentBrain::step, "Current step count")
 				.def_readonly("episode", &AgentBrain::episode, "Current episode count")
+                .def_readwrite("decision_period", &AgentBrain::decision_period, "Consult act() every this many ticks, repeating the last actions in between (1 = every tick)")
+                .def_readwrite("asynchronous", &AgentBrain::asynchronous, "Consult act() on a background worker; observations handed over at tick T produce the actions applied at tick T+1")
 				.def_readonly("fitness", &AgentBrain::fitness, "Cumulative reward for this episode")
 				.add_property("state", make_function(&AgentBrain::GetSharedState, return_value_policy<reference_existing_object>()), "Body of the agent");
 			// export the interface to python so that we can override its methods there
@@ -69,9 +102,15 @@ namespace OpenNero {
 				.def("act", &TDBrain::act, "Called for every step of the state-action loop")
 				.def("end", &TDBrain::end, "Called at the end of a learning episode")
 				.def("destroy", &TDBrain::destroy, "Called after learning ends")
+                .def("save_snapshot", &TDBrain::save_snapshot, "Write the brain to a binary snapshot file, skipping the write if nothing changed")
+                .def("load_snapshot", &TDBrain::load_snapshot, "Read the brain back from a binary snapshot file")
+                .def("enable_replay", &TDBrain::enableReplay, "Replay stored transitions: enable_replay(capacity, updates_per_step, prioritized)")
+                .def("disable_replay", &TDBrain::disableReplay, "Stop replaying stored transitions and free the buffer")
 				.add_property("epsilon", &TDBrain::getEpsilon, &TDBrain::setEpsilon)
 				.add_property("alpha", &TDBrain::getAlpha, &TDBrain::setAlpha)
 				.add_property("gamma", &TDBrain::getGamma, &TDBrain::setGamma)
+				.add_property("lambda_", &TDBrain::getLambda, &TDBrain::setLambda)
+				.add_property("replacing_traces", &TDBrain::getReplacingTraces, &TDBrain::setReplacingTraces)
 				.add_property("state", make_function(&TDBrain::GetSharedState, return_value_policy<reference_existing_object>()), "Body of the agent");
 			// export the interface to python so that we can override its methods there
 			py::class_<SarsaBrain, bases<TDBrain>, SarsaBrainPtr >("SarsaBrain", "SARSA RL agent", init<double, double, double, double, int, int, int, int>() )
@@ -124,6 +163,36 @@ namespace OpenNero {
             py::implicitly_convertible<RadarSensorPtr, SensorPtr>();
         }
 
+        /// the plan found by the last solve as a list of action names
+        py::list getPlan(const PlanningProblem& problem)
+        {
+            py::list plan;
+            for (size_t i = 0; i < problem.GetPlanLength(); ++i)
+            {
+                plan.append(problem.GetPlanAction(i));
+            }
+            return plan;
+        }
+
+        void ExportPlannerScripts()
+        {
+            py::class_<PlanningProblem, PlanningProblemPtr>(
+                "PlanningProblem",
+                "A grounded finite-domain planning problem searched natively")
+                .def("add_variable", &PlanningProblem::AddVariable, "add a state variable with values 0 .. domain_size-1 and return its index")
+                .def("add_action", &PlanningProblem::AddAction, "add a ground action with the given name and return its index")
+                .def("add_precondition", &PlanningProblem::AddPrecondition, "the action is applicable only when the variable has this value")
+                .def("add_effect", &PlanningProblem::AddEffect, "applying the action assigns this value to the variable")
+                .def("set_start", &PlanningProblem::SetStart, "set a variable's value in the start state (defaults to 0)")
+                .def("add_goal", &PlanningProblem::AddGoal, "require a variable to have this value in the goal state")
+                .def("solve_bfs", &PlanningProblem::SolveBFS, "breadth-first search to a shortest plan, giving up after max_nodes expansions (0 for no limit)")
+                .def("solve_idastar", &PlanningProblem::SolveIDAStar, "iterative-deepening A* to a plan of at most max_depth actions within max_nodes expansions (0 for no limit)")
+                .def("get_plan", &getPlan, "the plan found by the last solve as a list of action names")
+                .add_property("nodes_expanded", &PlanningProblem::GetNodesExpanded, "nodes expanded by the last solve")
+                .add_property("nodes_pruned", &PlanningProblem::GetNodesPruned, "states pruned by the transposition table during the last solve")
+                ;
+        }
+
 		/// return an action array for python to use
 		template<typename T> Actions get_vector(size_t size)
 		{
@@ -132,7 +201,7 @@ namespace OpenNero {
 
 		size_t hash_value(const FeatureVector& v)
 		{
-			return boost::hash_value(v);
+			return boost::hash_range(v.begin(), v.end());
 		}
 
 		size_t hash_value(const StateActionPair& sa_pair)
@@ -143,6 +212,143 @@ namespace OpenNero {
 		static bool eq_fv(const FeatureVector& v1, const FeatureVector& v2)
 		{ return v1 == v2; }
 
+        /// Wrap the vector's contiguous double storage in a Python
+        /// memoryview without copying. The view is only valid while the
+        /// vector is alive and unresized; Python code can wrap it as an
+        /// array with numpy.frombuffer(v.memoryview()) instead of
+        /// converting element-by-element.
+        static py::object fv_memoryview(FeatureVector& v)
+        {
+            if (v.empty())
+            {
+                return py::object();
+            }
+            PyObject* view = PyMemoryView_FromMemory(
+                reinterpret_cast<char*>(&v[0]),
+                v.size() * sizeof(double),
+                PyBUF_WRITE);
+            return py::object(py::handle<>(view));
+        }
+
+        /// persistent row-major buffer backing the observation matrix view,
+        /// so the memoryview returned to Python stays valid between calls
+        static FeatureVector obs_matrix;
+
+        /// Gather the most recent observation vector of every AI agent into
+        /// one row-major buffer and return (ids, view, num_columns), where
+        /// ids is the list of SimIds in row order and view is a zero-copy
+        /// memoryview of the matrix (reshape Python-side with numpy).
+        /// Agents whose observation width differs from the first agent's
+        /// are left out of the batch.
+        py::tuple get_observation_matrix()
+        {
+            obs_matrix.clear();
+            py::list ids;
+            size_t cols = 0;
+            SimContextPtr context = Kernel::GetSimContext();
+            if (context)
+            {
+                const SimEntitySet& entities = context->getSimulation()->GetEntities();
+                SimEntitySet::const_iterator itr;
+                for (itr = entities.begin(); itr != entities.end(); ++itr)
+                {
+                    AIObjectPtr ai = (*itr)->GetAIObject();
+                    if (!ai)
+                        continue;
+                    const Observations& obs = ai->getObservations();
+                    if (obs.empty())
+                        continue;
+                    if (cols == 0)
+                        cols = obs.size();
+                    if (obs.size() != cols)
+                        continue;
+                    ids.append((*itr)->GetSimId());
+                    obs_matrix.insert(obs_matrix.end(), obs.begin(), obs.end());
+                }
+            }
+            return py::make_tuple(ids, fv_memoryview(obs_matrix), cols);
+        }
+
+        /// Return every collision the physics phase recorded during the
+        /// last simulation tick as a list of
+        /// (id, other_id, (x, y, z), type, other_type) tuples;
+        /// other_id and other_type are 0 when the contact was with
+        /// something that is not a live simulation entity
+        py::list get_collision_events()
+        {
+            py::list events;
+            SimContextPtr context = Kernel::GetSimContext();
+            if (context)
+            {
+                const std::vector<CollisionEvent>& contacts =
+                    context->getSimulation()->GetCollisionEvents();
+                for (size_t i = 0; i < contacts.size(); ++i)
+                {
+                    const CollisionEvent& c = contacts[i];
+                    events.append(py::make_tuple(
+                        c.entity, c.other,
+                        py::make_tuple(c.point.X, c.point.Y, c.point.Z),
+                        c.type, c.otherType));
+                }
+            }
+            return events;
+        }
+
+        /// Register interest in per-tick entity changes: every tick the
+        /// simulation packs the changed fields of each matching entity
+        /// into the subscription's batch, read with fetch_entity_changes.
+        /// The fields mask uses the SimEntityData dirty bits: position=1,
+        /// rotation=2, velocity=4, scale=16, label=64, color=128. A types
+        /// mask of 0 matches every entity type.
+        uint32_t subscribe_entity_changes(uint32_t types, uint32_t fields)
+        {
+            SimContextPtr context = Kernel::GetSimContext();
+            if (!context)
+                return 0;
+            return context->getSimulation()->SubscribeChanges(types, fields);
+        }
+
+        /// drop a change subscription and whatever is pending on it
+        void unsubscribe_entity_changes(uint32_t subscription)
+        {
+            SimContextPtr context = Kernel::GetSimContext();
+            if (context)
+            {
+                context->getSimulation()->UnsubscribeChanges(subscription);
+            }
+        }
+
+        /// Take everything packed for the subscription since the last
+        /// fetch as a list of (id, bits, position, rotation, velocity,
+        /// scale, label, color) tuples, oldest first; a field the entity
+        /// did not change (or the subscription did not ask for) is None
+        py::list fetch_entity_changes(uint32_t subscription)
+        {
+            py::list result;
+            SimContextPtr context = Kernel::GetSimContext();
+            if (context)
+            {
+                std::vector<EntityChange> changes;
+                if (context->getSimulation()->FetchChanges(subscription, changes))
+                {
+                    const py::object none;
+                    for (size_t i = 0; i < changes.size(); ++i)
+                    {
+                        const EntityChange& c = changes[i];
+                        result.append(py::make_tuple(
+                            c.id, c.bits,
+                            (c.bits & SimEntityData::kDB_Position) ? py::object(c.position) : none,
+                            (c.bits & SimEntityData::kDB_Rotation) ? py::object(c.rotation) : none,
+                            (c.bits & SimEntityData::kDB_Velocity) ? py::object(c.velocity) : none,
+                            (c.bits & SimEntityData::kDB_Scale)    ? py::object(c.scale)    : none,
+                            (c.bits & SimEntityData::kDB_Label)    ? py::object(c.label)    : none,
+                            (c.bits & SimEntityData::kDB_Color)    ? py::object(c.color)    : none));
+                    }
+                }
+            }
+            return result;
+        }
+
         /// convert a Python float to a FeatureVector
         struct FeatureVector_from_python_float
         {
@@ -159,7 +365,7 @@ namespace OpenNero {
             /// it has to be a tuple containing three floating point numbers
             static void* convertible(PyObject* obj_ptr)
             {
-                if (PyFloat_Check(obj_ptr) || PyInt_Check(obj_ptr))
+                if (PyFloat_Check(obj_ptr) || PyLong_Check(obj_ptr))
                 {
                     return obj_ptr;
                 } else {
@@ -211,15 +417,18 @@ namespace OpenNero {
 				.def("validate", &FeatureVectorInfo::validate, "Check whether a feature vector is valid")
 				.def("normalize", &FeatureVectorInfo::normalize, "Normalize the feature vector given this info")
 				.def("denormalize", &FeatureVectorInfo::denormalize, "Create an instance of a feature vector from a vector of values between 0 and 1")
-				.def("get_instance", &FeatureVectorInfo::getInstance, "Create a feature vector based on this information")
+				.def("normalize_in_place", &FeatureVectorInfo::normalizeInPlace, "Clamp and normalize a feature vector in place; returns whether it was already within bounds")
+				.def("denormalize_in_place", &FeatureVectorInfo::denormalizeInPlace, "Apply the constraints to a feature vector of values between 0 and 1 in place")
+				.def("get_instance", static_cast<FeatureVector (FeatureVectorInfo::*)() const>(&FeatureVectorInfo::getInstance), "Create a feature vector based on this information")
 				.def("random", &FeatureVectorInfo::getRandom, "Create a random feature vector uniformly distributed within bounds")
 				;
 
-			// export std::vector<double>
-			py::class_< std::vector<double> > ("DoubleVector", "A vector of real values")
+			// export FeatureVector (under its historical Python name)
+			py::class_< FeatureVector > ("DoubleVector", "A vector of real values")
 				.def(self_ns::str(self_ns::self))
 				.def("__eq__", &eq_fv)
-				.def(vector_indexing_suite< std::vector<double> >())
+				.def("memoryview", &fv_memoryview, "Zero-copy memoryview of the underlying doubles (valid while the vector is alive and unresized)")
+				.def(vector_indexing_suite< FeatureVector >())
 				;
 
             // ability to convert a single Python float to a FeatureVector
@@ -274,6 +483,106 @@ namespace OpenNero {
             AIManager::instance().Reset();
 		}
 
+        /// find the AIObject of the entity with the given id (may be null)
+        AIObjectPtr find_ai_object(SimId id)
+        {
+            SimContextPtr context = Kernel::GetSimContext();
+            if (!context)
+                return AIObjectPtr();
+            SimEntityPtr ent = context->getSimulation()->Find(id);
+            if (!ent)
+                return AIObjectPtr();
+            return ent->GetAIObject();
+        }
+
+        /// the time the agent's most recent brain tick took, in microseconds
+        uint64_t get_ai_tick_time(SimId id)
+        {
+            AIObjectPtr ai = find_ai_object(id);
+            return ai ? ai->GetLastTickMicroseconds() : 0;
+        }
+
+        /// the agent's average brain tick time, in microseconds
+        float64_t get_ai_avg_tick_time(SimId id)
+        {
+            AIObjectPtr ai = find_ai_object(id);
+            return ai ? ai->GetAverageTickMicroseconds() : 0;
+        }
+
+        /// the total time spent ticking the agent's brain, in microseconds
+        uint64_t get_ai_total_tick_time(SimId id)
+        {
+            AIObjectPtr ai = find_ai_object(id);
+            return ai ? ai->GetTotalTickMicroseconds() : 0;
+        }
+
+        /// set the per-tick time budget for a single brain (0 disables)
+        void set_ai_tick_budget(uint32_t microseconds)
+        {
+            AIManager::instance().SetTickBudget(microseconds);
+        }
+
+        /// get the per-tick brain time budget (0 = disabled)
+        uint32_t get_ai_tick_budget()
+        {
+            return AIManager::const_instance().GetTickBudget();
+        }
+
+        /// demote far-from-the-action agents to a reduced decision rate
+        void set_ai_lod(float32_t distance, uint32_t period, uint32_t types)
+        {
+            AIManager::instance().SetLOD(distance, period, types);
+        }
+
+        /// turn the per-step ai.tick text log line on or off
+        void set_ai_text_log(bool enable)
+        {
+            AIManager::instance().SetTextLog(enable);
+        }
+
+        /// aggregate telemetry into windows of the given length before
+        /// sending it to the plot server (0 = per-step records)
+        void set_telemetry_window(float32_t seconds)
+        {
+            AIManager::instance().SetTelemetryWindow(seconds);
+        }
+
+        /// start exporting per-step trajectory records to binary files
+        bool start_trajectory_log(const std::string& prefix, uint32_t rotate_megabytes)
+        {
+            return TrajectoryLog::instance().Enable(prefix, rotate_megabytes);
+        }
+
+        /// stop exporting trajectories and close the current file
+        void stop_trajectory_log()
+        {
+            TrajectoryLog::instance().Disable();
+        }
+
+        /// start periodic crash-resilient checkpointing of the AI state
+        bool start_ai_autosave(const std::string& path, float32_t period_seconds)
+        {
+            return Autosave::instance().Enable(path, period_seconds);
+        }
+
+        /// write one final checkpoint and stop the autosaver
+        void stop_ai_autosave()
+        {
+            Autosave::instance().Disable();
+        }
+
+        /// stage and write a checkpoint now, regardless of the timer
+        void save_ai_checkpoint()
+        {
+            Autosave::instance().SaveNow();
+        }
+
+        /// restore the AI state from an autosave checkpoint
+        bool restore_ai_checkpoint(const std::string& path)
+        {
+            return Autosave::instance().Restore(path);
+        }
+
 		/// get the currently running environment
 		EnvironmentPtr get_environment()
 		{
@@ -286,6 +595,12 @@ namespace OpenNero {
 			AIManager::instance().SetEnvironment(env);
 		}
 
+		/// set a native (C++) environment
+		void set_native_environment(EnvironmentPtr env)
+		{
+			AIManager::instance().SetEnvironment(env);
+		}
+
 
 		/// export AI on/off toggle functions
 		void ExportAIManagerScripts()
@@ -298,9 +613,40 @@ namespace OpenNero {
 			py::def("reset_ai", &reset_ai, "reset AI");
 			py::def("get_environment", &get_environment, "get the current environment");
 			py::def("set_environment", &set_environment, "set the current environment");
+			py::def("set_environment", &set_native_environment, "set the current environment to a native (C++) one");
 
 			py::def("get_ai", &getAI, "return AIPtr");
 			py::def("set_ai", &setAI,"set AI ptr");
+			py::def("get_observation_matrix", &get_observation_matrix,
+			        "get (ids, view, num_columns) batching all agents' latest observations as one row-major buffer");
+			py::def("get_collision_events", &get_collision_events,
+			        "get last tick's collisions as a list of (id, other_id, (x, y, z), type, other_type) tuples");
+			py::def("subscribe_entity_changes", &subscribe_entity_changes,
+			        "subscribe_entity_changes(types, fields): register for per-tick entity changesets; "
+			        "fields are dirty bits (position=1, rotation=2, velocity=4, scale=16, label=64, color=128), "
+			        "types of 0 matches every entity; returns the subscription handle");
+			py::def("unsubscribe_entity_changes", &unsubscribe_entity_changes,
+			        "drop a change subscription and whatever is pending on it");
+			py::def("fetch_entity_changes", &fetch_entity_changes,
+			        "take the changes packed since the last fetch as a list of "
+			        "(id, bits, position, rotation, velocity, scale, label, color) tuples; unchanged fields are None");
+			py::def("get_ai_tick_time", &get_ai_tick_time, "the agent's most recent brain tick time in microseconds");
+			py::def("get_ai_avg_tick_time", &get_ai_avg_tick_time, "the agent's average brain tick time in microseconds");
+			py::def("get_ai_total_tick_time", &get_ai_total_tick_time, "the total time spent ticking the agent's brain in microseconds");
+			py::def("set_ai_tick_budget", &set_ai_tick_budget, "set the per-tick time budget for a single brain in microseconds (0 disables)");
+			py::def("get_ai_tick_budget", &get_ai_tick_budget, "get the per-tick brain time budget in microseconds (0 = disabled)");
+			py::def("set_ai_lod", &set_ai_lod,
+			        "agents farther than distance from every entity matching the type mask decide only every period ticks (0 distance disables)");
+			py::def("set_ai_text_log", &set_ai_text_log, "turn the per-step ai.tick text log line on or off");
+			py::def("set_telemetry_window", &set_telemetry_window, "reduce telemetry to per-agent and per-team min/mean/max/count windows of the given seconds before transmission (0 = per-step)");
+			py::def("start_trajectory_log", &start_trajectory_log,
+			        "export per-step (observation, action, reward) records to prefix.NNN.trj files, rotating past the given size in megabytes (0 = single file)");
+			py::def("stop_trajectory_log", &stop_trajectory_log, "stop exporting trajectories and close the current file");
+			py::def("start_ai_autosave", &start_ai_autosave,
+			        "checkpoint the AI state to the file every period seconds, written durably by a background thread and dumped to <file>.crash on a fatal signal");
+			py::def("stop_ai_autosave", &stop_ai_autosave, "write one final checkpoint and stop the autosaver");
+			py::def("save_ai_checkpoint", &save_ai_checkpoint, "stage and write an autosave checkpoint now, regardless of the timer");
+			py::def("restore_ai_checkpoint", &restore_ai_checkpoint, "restore the AI state from an autosave checkpoint");
 		}
 
 		/// Export World-specific script components
@@ -316,8 +662,49 @@ namespace OpenNero {
 				.def("reset", pure_virtual(&Environment::reset), "reset the environment to its initial state");
 
 			py::implicitly_convertible<PyEnvironmentPtr, EnvironmentPtr >();
+
+			// the native (C++) environment implementations: these run the
+			// task logic without any Boost.Python dispatch per agent step
+			py::class_<Environment, noncopyable, EnvironmentPtr >("NativeEnvironment",
+				"Base class of the environments implemented in C++", py::no_init);
+
+			py::class_<MazeEnvironment, py::bases<Environment>, MazeEnvironmentPtr, noncopyable >(
+				"MazeEnvironment",
+				"A native maze task: a discrete grid generated with Kruskal's algorithm",
+				py::init<U32, U32, F32, F32, U32>("construct with (rows, cols, grid_dx, grid_dy, max_steps)"))
+				.def("regenerate", &MazeEnvironment::regenerate, "generate a new random wall layout")
+				.def("is_wall", &MazeEnvironment::is_wall, "is there a wall between (r,c) and (r+dr,c+dc)?")
+				.add_property("max_steps", &MazeEnvironment::getMaxSteps, &MazeEnvironment::setMaxSteps, "episode step limit (0 = unlimited)")
+				.add_property("init_dist", &MazeEnvironment::getInitDist, &MazeEnvironment::setInitDist, "anti-diagonal the start cell is drawn from")
+				.add_property("rows", &MazeEnvironment::getRows, "rows in the maze")
+				.add_property("cols", &MazeEnvironment::getCols, "columns in the maze");
+			py::implicitly_convertible<MazeEnvironmentPtr, EnvironmentPtr >();
+
+			py::class_<RoombaEnvironment, py::bases<Environment>, RoombaEnvironmentPtr, noncopyable >(
+				"RoombaEnvironment",
+				"A native vacuuming task: turn, advance, bounce off walls, collect crumbs",
+				py::init<F32, F32, U32>("construct with (xdim, ydim, max_steps)"))
+				.def("add_crumb", &RoombaEnvironment::add_crumb, "place a crumb worth the given reward at (x, y)")
+				.def("clear_crumbs", &RoombaEnvironment::clear_crumbs, "remove all crumbs from the room")
+				.def("crumbs_left", &RoombaEnvironment::crumbs_left, "number of crumbs not yet vacuumed")
+				.add_property("speed", &RoombaEnvironment::getSpeed, &RoombaEnvironment::setSpeed, "distance covered per step")
+				.add_property("vacuum_radius", &RoombaEnvironment::getVacuumRadius, &RoombaEnvironment::setVacuumRadius, "crumbs closer than this get vacuumed")
+				.add_property("max_steps", &RoombaEnvironment::getMaxSteps, &RoombaEnvironment::setMaxSteps, "episode step limit (0 = unlimited)");
+			py::implicitly_convertible<RoombaEnvironmentPtr, EnvironmentPtr >();
 		}
 
+        /// receive immigrant genomes from peer islands on the given UDP port
+        bool islandListen(uint16_t port)
+        {
+            return NEAT::IslandMigration::instance().listen(port);
+        }
+
+        /// add a peer island to send champion genomes to
+        void islandAddPeer(const std::string& host, uint16_t port)
+        {
+            NEAT::IslandMigration::instance().add_peer(host, port);
+        }
+
 		/// Export RTNEAT related classes and functions to Python
 		void ExportRTNEATScripts()
 		{
@@ -327,6 +714,12 @@ namespace OpenNero {
 				.def("activate", &PyNetwork::activate, "activate the network for one or more steps until signal reaches output")
 				.def("flush", &PyNetwork::flush, "flush the network by clearing its internal state")
 				.def("get_outputs", &PyNetwork::get_outputs, "get output values from the network")
+				.def("get_weight_view", &PyNetwork::get_weight_view, "zero-copy read-only view of the link weights (float64; valid until the network is rebuilt)")
+				.def("get_link_source_view", &PyNetwork::get_link_source_view, "zero-copy read-only view of each link's source node row (uintp)")
+				.def("get_link_start_view", &PyNetwork::get_link_start_view, "zero-copy read-only view of each node's first link index (uintp CSR offsets, one per node plus one)")
+				.def("get_node_id_view", &PyNetwork::get_node_id_view, "zero-copy read-only view of the genome node id of each row (int32)")
+				.def("get_node_place_view", &PyNetwork::get_node_place_view, "zero-copy read-only view of each row's place (int32: 0=hidden 1=input 2=output 3=bias)")
+				.def("get_activation_view", &PyNetwork::get_activation_view, "zero-copy read-only view of each node's current activation (float64)")
 				.def(self_ns::str(self_ns::self));
 
 			// export Organism
@@ -356,7 +749,15 @@ namespace OpenNero {
                 .def("set_lifetime", &RTNEAT::set_lifetime, "set the lifetime of an agent")
 				.def("save_population", &RTNEAT::save_population, "save the population to a file")
                 .def("enable_evolution", &RTNEAT::enable_evolution, "turn evolution on")
-                .def("disable_evolution", &RTNEAT::disable_evolution, "turn evolution off");
+                .def("disable_evolution", &RTNEAT::disable_evolution, "turn evolution off")
+                .def("compact_innovations", &RTNEAT::compact_innovations, "renumber the innovations in use densely; returns how many are in use");
+
+            // batched population-scale inference
+            py::def( "activate_networks", &activate_networks, "load one sensor row per network and activate the whole batch in parallel; returns one output list per network");
+
+            // export island-model migration controls
+            py::def( "island_listen", &islandListen, "receive immigrant genomes from peer islands on the given UDP port");
+            py::def( "island_add_peer", &islandAddPeer, "add a peer island (host, port) to send champion genomes to");
 		}
         
 		/// the pickling suite for the Vector class
@@ -589,6 +990,12 @@ namespace OpenNero {
             Kernel::instance().RequestModSwitch(modName, modMode, modDir);
         }
 
+        /// retain suspended mods on switch instead of destroying them
+        void setModRetention( bool enable )
+        {
+            Kernel::instance().SetModRetention(enable);
+        }
+
         /// convert mod-relative path to filesystem path
         std::string findResource(const std::string& path)
         {
@@ -605,18 +1012,412 @@ namespace OpenNero {
             Kernel::instance().setModPath(path);
         }
 
+        /// bake a mod directory tree into a single packed bundle file
+        bool bakeModBundle(const std::string& directory, const std::string& bundleFile)
+        {
+            return ModBundle::Bake(directory, bundleFile);
+        }
+
+        /// map a packed bundle into the current mod's resource lookup
+        bool addModBundle(const std::string& bundleFile)
+        {
+            std::string path;
+            // the bundle file itself may live on the mod search path
+            if (!Kernel::instance().getMod()->FindResource(bundleFile, path))
+                path = bundleFile;
+            return Kernel::instance().getMod()->AddBundle(path);
+        }
+
         void setWindowCaption(const std::string& caption)
         {
             Kernel::instance().SetWindowCaption(caption);
         }
 
+        void runTicks(uint32_t n, float32_t dt)
+        {
+            Kernel::instance().RunTicks(n, dt);
+        }
+
+        /// append an experiment to the kernel's batch queue
+        void queueExperiment( const std::string& mod, const std::string& modPath,
+                              const std::string& command, uint32_t ticks,
+                              float32_t dt, uint32_t seed )
+        {
+            Kernel::ExperimentSpec spec;
+            spec.mod = mod;
+            spec.modPath = modPath;
+            spec.command = command;
+            spec.ticks = ticks;
+            spec.dt = dt;
+            spec.seed = seed;
+            Kernel::instance().QueueExperiment(spec);
+        }
+
+        /// run the queued experiments back to back in this process
+        size_t runExperimentQueue()
+        {
+            return Kernel::instance().RunExperimentQueue();
+        }
+
+        /// the process's peak resident set size in kilobytes (0 if the
+        /// platform does not report it)
+        uint64_t getPeakRSSKb()
+        {
+#if !NERO_PLATFORM_WINDOWS
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0)
+            {
+                return (uint64_t)usage.ru_maxrss;
+            }
+#endif
+            return 0;
+        }
+
+        /// Run n fixed-timestep ticks like runTicks, timing each one, and
+        /// return the figures the macro benchmarks report: throughput,
+        /// mean/median/p99/max tick latency and the peak resident set size
+        py::dict runTicksTimed(uint32_t n, float32_t dt)
+        {
+            py::dict stats;
+            SimContextPtr context = Kernel::GetSimContext();
+            if (!context || n == 0)
+            {
+                return stats;
+            }
+
+            std::vector<float64_t> tick_ms(n);
+            const uint64_t start = HighResClock::GetNanoseconds();
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                const uint64_t tick_start = HighResClock::GetNanoseconds();
+                context->ProcessTick(dt);
+                tick_ms[i] = (HighResClock::GetNanoseconds() - tick_start) * 1e-6;
+            }
+            const float64_t seconds = (HighResClock::GetNanoseconds() - start) * 1e-9;
+
+            std::sort(tick_ms.begin(), tick_ms.end());
+            float64_t total_ms = 0;
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                total_ms += tick_ms[i];
+            }
+            // nearest-rank percentiles over the sorted per-tick times
+            const size_t p50 = (size_t)(0.50 * (n - 1));
+            const size_t p99 = (size_t)(0.99 * (n - 1));
+
+            stats["ticks"] = n;
+            stats["seconds"] = seconds;
+            stats["ticks_per_sec"] = seconds > 0 ? n / seconds : 0.0;
+            stats["mean_ms"] = total_ms / n;
+            stats["p50_ms"] = tick_ms[p50];
+            stats["p99_ms"] = tick_ms[p99];
+            stats["max_ms"] = tick_ms[n - 1];
+            stats["peak_rss_kb"] = getPeakRSSKb();
+            return stats;
+        }
+
+        /// frame-time statistics collected by the FPS counter: rolling
+        /// percentiles, the log-scale histogram, and the worst frame with
+        /// its profiler breakdown
+        py::dict getFrameTimeStats()
+        {
+            py::dict stats;
+            SimContextPtr context = Kernel::GetSimContext();
+            if (!context)
+            {
+                return stats;
+            }
+            const FPSCounter& counter = context->GetFPSCounter();
+            stats["fps"] = counter.getFPS();
+            stats["frames"] = counter.getFrameCount();
+            stats["mean_ms"] = counter.getMeanMs();
+            stats["p50_ms"] = counter.getP50Ms();
+            stats["p95_ms"] = counter.getP95Ms();
+            stats["p99_ms"] = counter.getP99Ms();
+            stats["worst_ms"] = counter.getWorstFrameMs();
+
+            py::list histogram;
+            for (size_t i = 0; i < FPSCounter::kNumBuckets; ++i)
+            {
+                if (counter.getBucketCount(i) == 0) continue;
+                histogram.append(py::make_tuple(FPSCounter::BucketUpperBoundMs(i),
+                                                counter.getBucketCount(i)));
+            }
+            stats["histogram"] = histogram;
+
+            py::dict breakdown;
+            const std::vector<FPSCounter::WorstScope>& worst = counter.getWorstFrameBreakdown();
+            for (size_t i = 0; i < worst.size(); ++i)
+            {
+                breakdown[worst[i].path] = worst[i].milliseconds;
+            }
+            stats["worst_breakdown"] = breakdown;
+            return stats;
+        }
+
+        void setTimeScale(float32_t k)
+        {
+            Kernel::instance().SetTimeScale(k);
+        }
+
+        float32_t getTimeScale()
+        {
+            return Kernel::instance().GetTimeScale();
+        }
+
+        /// start reading a resource file into memory on a background thread
+        void preloadResource(const std::string& path)
+        {
+            Kernel::GetSimContext()->getSimFactory()->getIrrFactory().PrefetchAssetFile(path);
+        }
+
+        /// compile a directory of scripts into a packed bytecode archive
+        uint32_t compileScriptArchive(const std::string& sourceDir, const std::string& archivePath)
+        {
+            return ScriptingEngine::instance().CompileScriptArchive(sourceDir, archivePath);
+        }
+
+        /// import precompiled scripts from a packed bytecode archive
+        bool addScriptArchive(const std::string& archivePath)
+        {
+            return ScriptingEngine::instance().AddScriptArchive(archivePath);
+        }
+
+        /// start recording per-tick entity state deltas to a binary frame log
+        bool startStateRecording(const std::string& path)
+        {
+            return Kernel::GetSimContext()->getSimulation()->StartRecording(path);
+        }
+
+        /// stop recording entity state and flush the frame log
+        void stopStateRecording()
+        {
+            Kernel::GetSimContext()->getSimulation()->StopRecording();
+        }
+
+        /// hold the simulation tick under a time budget by shedding
+        /// optional work (0 disables the governor and restores everything)
+        void setTickBudget(float32_t milliseconds)
+        {
+            TickGovernor::instance().SetBudget(milliseconds);
+        }
+
+        /// the tick governor's current shedding level (0 = nothing shed)
+        uint32_t getTickShedLevel()
+        {
+            return TickGovernor::instance().GetShedLevel();
+        }
+
+        /// serve live engine metrics on a local port for scrapers
+        bool startMetricsServer(uint32_t port)
+        {
+            return MetricsServer::instance().Start((U16)port);
+        }
+
+        /// stop serving metrics and close the socket
+        void stopMetricsServer()
+        {
+            MetricsServer::instance().Stop();
+        }
+
+        /// start capturing every rendered frame into numbered image files
+        bool startFrameRecording(const std::string& prefix)
+        {
+            return FrameCapture::instance().StartRecording(prefix);
+        }
+
+        /// stop capturing rendered frames (queued frames still get written)
+        void stopFrameRecording()
+        {
+            FrameCapture::instance().StopRecording();
+        }
+
+        /// publish per-tick entity snapshots into a shared-memory stream
+        bool startSpectatorStream(const std::string& name, uint32_t maxEntities)
+        {
+            return Kernel::GetSimContext()->getSimulation()->StartPublishing(name, maxEntities);
+        }
+
+        /// stop publishing and remove the shared-memory spectator stream
+        void stopSpectatorStream()
+        {
+            Kernel::GetSimContext()->getSimulation()->StopPublishing();
+        }
+
+        /// attach to a spectator stream and let it drive the entities
+        bool startSpectating(const std::string& name)
+        {
+            return Kernel::GetSimContext()->StartSpectating(name);
+        }
+
+        /// detach from the spectator stream and return to normal simulation
+        void stopSpectating()
+        {
+            Kernel::GetSimContext()->StopSpectating();
+        }
+
+        /// start playing back a recorded frame log instead of running AI
+        bool startStateReplay(const std::string& path)
+        {
+            return Kernel::GetSimContext()->StartReplay(path);
+        }
+
+        /// stop the replay and return to normal simulation
+        void stopStateReplay()
+        {
+            Kernel::GetSimContext()->StopReplay();
+        }
+
+        /// scrub the active replay to the given frame index
+        bool seekStateReplay(uint32_t frame)
+        {
+            StateReplayerPtr replayer = Kernel::GetSimContext()->GetStateReplayer();
+            if (!replayer)
+                return false;
+            return replayer->SeekFrame(frame, *Kernel::GetSimContext()->getSimulation());
+        }
+
+        /// save a binary snapshot of the whole world (entities and AI state)
+        bool saveWorldSnapshot(const std::string& path)
+        {
+            return Kernel::GetSimContext()->getSimulation()->SaveSnapshot(path);
+        }
+
+        /// restore a world snapshot saved earlier in this session
+        bool restoreWorldSnapshot(const std::string& path)
+        {
+            return Kernel::GetSimContext()->getSimulation()->RestoreSnapshot(path);
+        }
+
+        /// the number of frames in the active replay (0 if not replaying)
+        uint32_t getStateReplayFrameCount()
+        {
+            StateReplayerPtr replayer = Kernel::GetSimContext()->GetStateReplayer();
+            return replayer ? replayer->GetFrameCount() : 0;
+        }
+
+        /// grow the pool of headless worker contexts by count
+        size_t createSimContexts(size_t count)
+        {
+            return SimContextPool::instance().CreateContexts(count);
+        }
+
+        /// the number of pooled worker contexts
+        size_t getSimContextCount()
+        {
+            return SimContextPool::instance().GetContextCount();
+        }
+
+        /// route subsequent scripting calls to the pooled context at index
+        bool activateSimContext(size_t index)
+        {
+            return SimContextPool::instance().ActivateContext(index);
+        }
+
+        /// restore the mod's own context as the current one
+        void deactivateSimContext()
+        {
+            SimContextPool::instance().DeactivateContext();
+        }
+
+        /// step every pooled context forward by dt seconds
+        void stepSimContexts(float32_t dt)
+        {
+            SimContextPool::instance().StepAll(dt);
+        }
+
+        /// deactivate and destroy all pooled contexts
+        void destroySimContexts()
+        {
+            SimContextPool::instance().DestroyContexts();
+        }
+
+        /// turn the hierarchical frame profiler on
+        void enableProfiler()
+        {
+            Profiler::instance().SetEnabled(true);
+        }
+
+        /// turn the hierarchical frame profiler off
+        void disableProfiler()
+        {
+            Profiler::instance().SetEnabled(false);
+        }
+
+        /// start appending per-scope profiler rows to a CSV file
+        bool startProfilerCsv(const std::string& path)
+        {
+            return Profiler::instance().StartCsvDump(path);
+        }
+
+        /// stop the profiler CSV dump and close the file
+        void stopProfilerCsv()
+        {
+            Profiler::instance().StopCsvDump();
+        }
+
+        /// a multi-line report attributing memory between subsystems
+        std::string memoryReport()
+        {
+            return MemoryMonitor::instance().Report();
+        }
+
+        /// log the memory report every period seconds (0 turns it off)
+        void setMemoryLogPeriod(float32_t seconds)
+        {
+            MemoryMonitor::instance().SetLogPeriod(seconds);
+        }
+
 		void ExportKernelScripts()
 		{
 			py::def( "switchMod", &switchMod, "Switch the kernel to a new mod");
+			py::def( "setModRetention", &setModRetention, "Suspend and resume mods on switch instead of rebuilding them");
 			py::def( "findResource", &findResource, "Convert mod-relative path to filesystem path");
 			py::def( "getModPath", &getModPath, "get the resource search path of the current mod ( separated by ':' )");
 			py::def( "setModPath", &setModPath, "set the resource search path of the current mod ( separated by ':' )");
+            py::def( "bake_mod_bundle", &bakeModBundle, "pack a mod directory tree into a single bundle file (Python sources stay on disk)");
+            py::def( "add_mod_bundle", &addModBundle, "memory-map a baked bundle and serve its files through the current mod's resource lookup");
             py::def( "setWindowCaption", &setWindowCaption, "set the last part of the window caption to display a custom message");
+            py::def( "runTicks", &runTicks, "immediately run n fixed-timestep simulation ticks of dt seconds each");
+            py::def( "queue_experiment", &queueExperiment, "queue an experiment (mod, mod path, start command, ticks, dt, seed) for run_experiment_queue");
+            py::def( "run_experiment_queue", &runExperimentQueue, "run the queued experiments sequentially with a full mod reset and reseed between runs; returns the number run");
+            py::def( "run_ticks_timed", &runTicksTimed, "run n fixed-timestep ticks and return throughput, latency percentile and peak RSS figures");
+            py::def( "get_frame_time_stats", &getFrameTimeStats, "frame-time percentiles, histogram buckets, and the worst frame with its profiler breakdown");
+            py::def( "setTimeScale", &setTimeScale, "scale simulation time relative to wall-clock time (k > 1 fast-forwards)");
+            py::def( "getTimeScale", &getTimeScale, "get the current simulation time scale");
+            py::def( "preload_resource", &preloadResource, "start reading a resource file into memory on a background thread");
+            py::def( "compile_script_archive", &compileScriptArchive, "compile a directory of scripts into a packed bytecode archive");
+            py::def( "add_script_archive", &addScriptArchive, "import precompiled scripts from a packed bytecode archive");
+            py::def( "start_state_recording", &startStateRecording, "start recording per-tick entity state deltas to a binary frame log");
+            py::def( "stop_state_recording", &stopStateRecording, "stop recording entity state and flush the frame log");
+            py::def( "set_tick_budget", &setTickBudget, "hold the simulation tick under the given milliseconds by shedding optional work (0 disables)");
+            py::def( "get_tick_shed_level", &getTickShedLevel, "the tick governor's current shedding level (0 = nothing shed)");
+            py::def( "start_metrics_server", &startMetricsServer, "serve live engine metrics on a local port in the Prometheus text format");
+            py::def( "stop_metrics_server", &stopMetricsServer, "stop serving metrics and close the socket");
+            py::def( "start_frame_recording", &startFrameRecording, "start capturing every rendered frame into numbered image files");
+            py::def( "stop_frame_recording", &stopFrameRecording, "stop capturing rendered frames (queued frames still get written)");
+            py::def( "start_spectator_stream", &startSpectatorStream, "publish per-tick entity snapshots into a shared-memory stream");
+            py::def( "stop_spectator_stream", &stopSpectatorStream, "stop publishing and remove the shared-memory spectator stream");
+            py::def( "start_spectating", &startSpectating, "attach to a spectator stream and let it drive the entities");
+            py::def( "stop_spectating", &stopSpectating, "detach from the spectator stream and return to normal simulation");
+            py::def( "start_state_replay", &startStateReplay, "start playing back a recorded frame log instead of running AI");
+            py::def( "stop_state_replay", &stopStateReplay, "stop the replay and return to normal simulation");
+            py::def( "seek_state_replay", &seekStateReplay, "scrub the active replay to the given frame index");
+            py::def( "get_state_replay_frame_count", &getStateReplayFrameCount, "the number of frames in the active replay");
+            py::def( "save_world_snapshot", &saveWorldSnapshot, "save a binary snapshot of the whole world (entities and AI state)");
+            py::def( "restore_world_snapshot", &restoreWorldSnapshot, "restore a world snapshot saved earlier in this session");
+            py::def( "create_sim_contexts", &createSimContexts, "grow the pool of headless worker contexts by count");
+            py::def( "get_sim_context_count", &getSimContextCount, "the number of pooled worker contexts");
+            py::def( "activate_sim_context", &activateSimContext, "route subsequent scripting calls to the pooled context at index");
+            py::def( "deactivate_sim_context", &deactivateSimContext, "restore the mod's own context as the current one");
+            py::def( "step_sim_contexts", &stepSimContexts, "step every pooled worker context forward by dt seconds");
+            py::def( "destroy_sim_contexts", &destroySimContexts, "deactivate and destroy all pooled worker contexts");
+            py::def( "enable_profiler", &enableProfiler, "turn the hierarchical frame profiler on");
+            py::def( "disable_profiler", &disableProfiler, "turn the hierarchical frame profiler off");
+            py::def( "start_profiler_csv", &startProfilerCsv, "start appending per-scope profiler rows to a CSV file");
+            py::def( "stop_profiler_csv", &stopProfilerCsv, "stop the profiler CSV dump and close the file");
+            py::def( "memory_report", &memoryReport, "a multi-line report attributing memory between subsystems");
+            py::def( "set_memory_log_period", &setMemoryLogPeriod, "log the memory report every period seconds (0 turns it off)");
 		}
 
         void ExportPropertyMapScripts()
@@ -776,8 +1577,22 @@ namespace OpenNero {
 
         BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(findInRay_overloads, PyFindInRay, 2, 6)
 
+        BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(findRays_overloads, PyFindRays, 2, 3)
+
         void ExportSimContextScripts()
         {
+            py::class_<SimEntityProxy>("SimEntityProxy",
+                "A stable handle to one entity, resolved by slot index instead of an id hash; make one via getSimContext().getEntityProxy(id) and reuse it across ticks")
+                .add_property("id", &SimEntityProxy::GetId)
+                .add_property("valid", &SimEntityProxy::IsValid)
+                .add_property("position", &SimEntityProxy::GetPosition, &SimEntityProxy::SetPosition)
+                .add_property("rotation", &SimEntityProxy::GetRotation, &SimEntityProxy::SetRotation)
+                .add_property("velocity", &SimEntityProxy::GetVelocity, &SimEntityProxy::SetVelocity)
+                .add_property("scale", &SimEntityProxy::GetScale, &SimEntityProxy::SetScale)
+                .add_property("label", &SimEntityProxy::GetLabel, &SimEntityProxy::SetLabel)
+                .add_property("color", &SimEntityProxy::GetColor, &SimEntityProxy::SetColor)
+                ;
+
             py::class_<SimContext>("SimContext", "The simulation context from an XML file", no_init )
                 .def("addAxes",
                      &SimContext::AddAxes,
@@ -800,6 +1615,12 @@ namespace OpenNero {
                 .def("removeObject",
                      &SimContext::RemoveObject,
                      "Remove an object from the server and broadcast to clients")
+                .def("addObjects",
+                     &SimContext::AddObjects,
+                     "Create a batch of objects in one call; records are addObject argument tuples (None for a default), returns the new ids")
+                .def("removeObjects",
+                     &SimContext::RemoveObjects,
+                     "Remove a batch of objects by id in one call")
                 .def("getGuiManager",
                      &SimContext::GetGuiManager,
                      "Return the gui manager for the context")
@@ -812,6 +1633,9 @@ namespace OpenNero {
                 .def("findInRay",
                      &SimContext::PyFindInRay,
                      findInRay_overloads("Find the first object that intersects the specified ray (origin:Vector3f, target:Vector3f, [int])") )
+                .def("findRays",
+                     &SimContext::PyFindRays,
+                     findRays_overloads("Cast a batch of rays in one call (origins:list, targets:list, [int]); returns one findInRay-shaped tuple per ray") )
                 .def("getClickedPosition",
                      &SimContext::GetClickedPosition,
                      "Approximate 3d position of the mouse click")
@@ -839,6 +1663,9 @@ namespace OpenNero {
                 .def("setObjectAnimation",
                      &SimContext::SetObjectAnimation,
                      "Set the animation of the object specified by its id")
+                .def("setObjectStates",
+                     &SimContext::SetObjectStates,
+                     "Apply a list of (id, position, rotation, color) records in one call; pass None to skip a field")
                 .def("getObjectPosition",
                      &SimContext::GetObjectPosition,
                      "Get the position of an object specified by its id")
@@ -866,6 +1693,9 @@ namespace OpenNero {
                 .def("transformVector",
                      &SimContext::TransformVector,
                      "Transform the given vector by the matrix of the object specified by id")
+                .def("getEntityProxy",
+                     &SimContext::GetEntityProxy,
+                     "Create a stable proxy for an entity; reuse it across ticks instead of the per-id accessors")
                 .add_property("delay", &SimContext::GetFrameDelay, &SimContext::SetFrameDelay)
                 ;
 
@@ -873,6 +1703,89 @@ namespace OpenNero {
             py::def("getSimContext", &GetSimContext, return_value_policy<reference_existing_object>());
         }
 
+        /// set the combat tuning parameters
+        void combat_set_parameters(F32 max_fire_radius, F32 max_shot_radius,
+                                   F32 aim_tolerance, F32 eye_height, U32 obstacle_types)
+        {
+            CombatService::instance().SetParameters(
+                max_fire_radius, max_shot_radius, aim_tolerance, eye_height, obstacle_types);
+        }
+
+        /// register a fighter on the given team
+        void combat_add(SimId id, U32 team)
+        {
+            CombatService::instance().AddCombatant(id, team);
+        }
+
+        /// remove a fighter (killed or despawned)
+        void combat_remove(SimId id)
+        {
+            CombatService::instance().RemoveCombatant(id);
+        }
+
+        /// remove all fighters and their damage records
+        void combat_clear()
+        {
+            CombatService::instance().ClearCombatants();
+        }
+
+        /// resolve every firing shooter for this tick in one call,
+        /// returning a (shooter, target, aim_angle, hit) tuple per shooter
+        py::list combat_resolve_fire(const py::list& shooters)
+        {
+            std::vector<SimId> ids;
+            const size_t count = py::len(shooters);
+            ids.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                ids.push_back(py::extract<SimId>(shooters[i]));
+            }
+            std::vector<FireResult> results;
+            CombatService::instance().ResolveFire(ids, results);
+            py::list out;
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                out.append(py::make_tuple(results[i].shooter,
+                                          results[i].target,
+                                          results[i].aim_angle,
+                                          results[i].hit));
+            }
+            return out;
+        }
+
+        /// damage taken since the last call, folded into the total
+        U32 combat_pop_damage(SimId id)
+        {
+            return CombatService::instance().PopDamage(id);
+        }
+
+        /// damage accumulated over the fighter's lifetime
+        U32 combat_total_damage(SimId id)
+        {
+            return CombatService::instance().GetTotalDamage(id);
+        }
+
+        /// forget a fighter's damage (e.g. on respawn)
+        void combat_reset_damage(SimId id)
+        {
+            CombatService::instance().ResetDamage(id);
+        }
+
+        /// export the combat resolution service for the NERO battle games
+        void ExportCombatServiceScripts()
+        {
+            py::def("combat_set_parameters", &combat_set_parameters,
+                    "combat tuning: (max_fire_radius, max_shot_radius, aim_tolerance_degrees, eye_height, obstacle_types)");
+            py::def("combat_add", &combat_add, "register a fighter on the given team: (id, team)");
+            py::def("combat_remove", &combat_remove, "remove a fighter (killed or despawned)");
+            py::def("combat_clear", &combat_clear, "remove all fighters and their damage records");
+            py::def("combat_resolve_fire", &combat_resolve_fire,
+                    "resolve all firing shooters; returns one (shooter, target, aim_angle, hit) tuple per shooter");
+            py::def("combat_pop_damage", &combat_pop_damage, "damage taken since the last call, folded into the total");
+            py::def("combat_total_damage", &combat_total_damage, "damage accumulated over the fighter's lifetime");
+            py::def("combat_reset_damage", &combat_reset_damage, "forget a fighter's damage (e.g. on respawn)");
+        }
+
         /// Python Binder Method for the IOMap
         void ExportIOMappingScripts()
         {
@@ -940,6 +1853,7 @@ namespace OpenNero {
             ExportAIManagerScripts();
             ExportAgentBrainScripts();
             ExportSensorScripts();
+            ExportPlannerScripts();
             ExportEnvironmentScripts();
             ExportRTNEATScripts();
             ExportIrrUtilScripts();
@@ -949,6 +1863,7 @@ namespace OpenNero {
             ExportSchedulerScripts();
             ExportSimEntityDataScripts();
             ExportSimContextScripts();
+            ExportCombatServiceScripts();
             ExportIOMappingScripts();
             ExportCameraScripts();
             ExportScriptingEngineScripts();
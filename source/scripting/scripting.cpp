@@ -4,13 +4,29 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <cstring>
 #include <set>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#if NERO_PLATFORM_WINDOWS
+    #include <winsock2.h>
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+#endif
 
 #include "tinyxml.h"
 #include "scripting/scripting.h"
 #include "scripting/exports.h"
 #include "core/File.h"
+#include "core/LockFreeRing.h"
 #include "game/Kernel.h"
+#include "game/Mod.h"
+#include "utils/StartupReport.h"
 
 
 // symbols for exporting the python module init function
@@ -34,6 +50,198 @@ namespace OpenNero
     
     namespace py = boost::python;
 
+    /// The asynchronous plot/telemetry pipeline. NetworkWrite used to
+    /// hand messages to the plot server synchronously from the tick
+    /// thread, so a slow dashboard host or a dropped link stalled the
+    /// whole simulation. Messages are now appended to a bounded
+    /// lock-free ring and a background thread owns the socket; when the
+    /// receiver cannot keep up, the oldest queued message is dropped
+    /// (telemetry is a stream of snapshots and the newest ones are the
+    /// valuable ones), so ProcessTick can never block on the network.
+    namespace PlotWriter
+    {
+#if NERO_PLATFORM_WINDOWS
+        typedef SOCKET SocketHandle;
+        static const SocketHandle kInvalidSocket = INVALID_SOCKET;
+#else
+        typedef int SocketHandle;
+        static const SocketHandle kInvalidSocket = -1;
+#endif
+
+        /// where plot_server.py listens (see mods/plot_client.py)
+        static const char* const kPlotHost = "127.0.0.1";
+        static const unsigned short kPlotPort = 9999;
+
+        /// messages the ring can hold before the oldest one is dropped
+        static const size_t kRingCapacity = 1024;
+
+        /// how long the sender waits after a failed connect before trying again
+        static const long kReconnectDelayMs = 1000;
+
+        /// everything owned by the sender thread
+        struct State
+        {
+            State() : ring(kRingCapacity), running(false), dropped(0) {}
+            LockFreeRing<std::string> ring;  ///< pending messages
+            std::thread sender;              ///< background sender thread
+            std::atomic<bool> running;       ///< cleared to ask the sender to drain and exit
+            std::atomic<size_t> dropped;     ///< messages discarded under backpressure
+        };
+
+        static State* sState = NULL;
+
+        /// close a socket handle on either platform
+        static void Close( SocketHandle sock )
+        {
+#if NERO_PLATFORM_WINDOWS
+            closesocket(sock);
+#else
+            close(sock);
+#endif
+        }
+
+        /// try to connect to the plot server; returns kInvalidSocket on failure
+        static SocketHandle Connect()
+        {
+#if NERO_PLATFORM_WINDOWS
+            static bool winsock_ready = false;
+            if (!winsock_ready)
+            {
+                WSADATA wsa;
+                if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+                    return kInvalidSocket;
+                winsock_ready = true;
+            }
+#endif
+            SocketHandle sock = socket(AF_INET, SOCK_STREAM, 0);
+            if (sock == kInvalidSocket)
+                return kInvalidSocket;
+            sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = inet_addr(kPlotHost);
+            addr.sin_port = htons(kPlotPort);
+            if (connect(sock, (sockaddr*)&addr, sizeof(addr)) != 0)
+            {
+                Close(sock);
+                return kInvalidSocket;
+            }
+            return sock;
+        }
+
+        /// write the whole message to the socket; returns false on error
+        static bool SendAll( SocketHandle sock, const std::string& msg )
+        {
+            size_t sent = 0;
+            while (sent < msg.size())
+            {
+                long n = send(sock, msg.c_str() + sent, (int)(msg.size() - sent), 0);
+                if (n <= 0)
+                    return false;
+                sent += (size_t)n;
+            }
+            return true;
+        }
+
+        /// drain the ring until asked to stop, then drain whatever is left;
+        /// the socket lives entirely on this thread, including reconnects
+        static void SendLoop( State* state )
+        {
+            SocketHandle sock = kInvalidSocket;
+            bool warned = false;
+            std::chrono::steady_clock::time_point last_attempt;
+            std::string msg;
+            for ( ;; )
+            {
+                if (state->ring.pop(msg))
+                {
+                    if (sock == kInvalidSocket)
+                    {
+                        // rate-limit connection attempts so a dead server
+                        // does not cost a connect() per message
+                        std::chrono::steady_clock::time_point now =
+                            std::chrono::steady_clock::now();
+                        if (last_attempt.time_since_epoch().count() != 0 &&
+                            std::chrono::duration_cast<std::chrono::milliseconds>(now - last_attempt).count() < kReconnectDelayMs)
+                        {
+                            continue; // message dropped: still disconnected
+                        }
+                        last_attempt = now;
+                        sock = Connect();
+                        if (sock == kInvalidSocket)
+                        {
+                            if (!warned)
+                            {
+                                LOG_F_WARNING("scripting", "could not connect to plot server at "
+                                              << kPlotHost << ":" << kPlotPort
+                                              << "; telemetry will be dropped until it comes up");
+                                warned = true;
+                            }
+                            continue; // message dropped
+                        }
+                        warned = false;
+                    }
+                    if (!SendAll(sock, msg))
+                    {
+                        // the link went away; drop the message and reconnect lazily
+                        Close(sock);
+                        sock = kInvalidSocket;
+                    }
+                }
+                else if (state->running.load(std::memory_order_acquire))
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                else
+                {
+                    break;
+                }
+            }
+            if (sock != kInvalidSocket)
+                Close(sock);
+        }
+
+        /// append a message, discarding the oldest one if the ring is full;
+        /// starts the sender thread on first use
+        static void Enqueue( const std::string& message )
+        {
+            if (!sState)
+            {
+                sState = new State();
+                sState->running.store(true, std::memory_order_release);
+                sState->sender = std::thread(&SendLoop, sState);
+            }
+            while (!sState->ring.push(message))
+            {
+                // full: sacrifice the oldest snapshot for the newest one
+                std::string oldest;
+                if (sState->ring.pop(oldest) &&
+                    sState->dropped.fetch_add(1, std::memory_order_relaxed) == 0)
+                {
+                    LOG_F_WARNING("scripting", "plot server is falling behind; dropping oldest telemetry");
+                }
+            }
+        }
+
+        /// drain the queue, stop the sender thread and close the socket
+        static void Shutdown()
+        {
+            if (!sState)
+                return;
+            sState->running.store(false, std::memory_order_release);
+            if (sState->sender.joinable())
+                sState->sender.join();
+            size_t dropped = sState->dropped.load(std::memory_order_relaxed);
+            if (dropped > 0)
+            {
+                LOG_F_MSG("scripting", "plot writer dropped " << dropped << " telemetry messages");
+            }
+            delete sState;
+            sState = NULL;
+        }
+    }
+
+
     void PrintDebuggingInfo(py::object globals, 
                             py::object locals)
     {
@@ -41,9 +249,9 @@ namespace OpenNero
         try {
             py::exec("import sys\n"
                      "import os\n"
-                     "print 'System path: ', ':'.join(sys.path)\n"
-                     "print 'Current directory: ', os.getcwd()\n"
-                     "print 'Current namespace: ', dir()\n",
+                     "print('System path: ', ':'.join(sys.path))\n"
+                     "print('Current directory: ', os.getcwd())\n"
+                     "print('Current namespace: ', dir())\n",
                      globals, locals);
         } catch (py::error_already_set const&) {
             LOG_F_ERROR("scripting", "could not print post-error information");
@@ -53,8 +261,8 @@ namespace OpenNero
     
     void ScriptingEngine::Tick(float32_t dt) {
         try {
-            if (_globals.has_key("ModTick")) {
-                _globals["ModTick"](dt);
+            if (_active_ns->globals.has_key("ModTick")) {
+                _active_ns->globals["ModTick"](dt);
             }
         } catch (py::error_already_set const&) {
             LogError();
@@ -70,7 +278,7 @@ namespace OpenNero
         try {
             stringstream ss;
             ss << "import " << moduleName << endl;
-            python::exec(ss.str().c_str(), _globals, _globals);
+            python::exec(ss.str().c_str(), _active_ns->globals, _active_ns->globals);
         }
         catch (error_already_set const&)
         {
@@ -82,6 +290,50 @@ namespace OpenNero
         return true;
     }
 
+    /// Import every module listed in a mod's preimport manifest
+    uint32_t ScriptingEngine::ImportPreimportManifest(const string& manifestName)
+    {
+        // the manifest is optional; resolve it quietly (findResource would
+        // log an error for a mod that simply does not have one)
+        string manifestPath;
+        if (!Kernel::instance().getMod()->FindResource(manifestName, manifestPath))
+        {
+            return 0;
+        }
+
+        ifstream manifest(manifestPath.c_str());
+        if (!manifest)
+        {
+            LOG_F_WARNING("scripting", "could not read preimport manifest: " << manifestPath);
+            return 0;
+        }
+
+        LOG_F_MSG("scripting", "preimporting modules from " << manifestPath);
+
+        uint32_t imported = 0;
+        string line;
+        while (getline(manifest, line))
+        {
+            // strip comments and surrounding whitespace
+            string::size_type comment = line.find('#');
+            if (comment != string::npos)
+                line.erase(comment);
+            string::size_type first = line.find_first_not_of(" \t\r\n");
+            if (first == string::npos)
+                continue;
+            string::size_type last = line.find_last_not_of(" \t\r\n");
+            string moduleName = line.substr(first, last - first + 1);
+
+            if (ImportModule(moduleName))
+            {
+                StartupReport::MarkStage("preimport " + moduleName);
+                ++imported;
+            }
+        }
+
+        return imported;
+    }
+
     bool ScriptingEngine::ExecFile(const string &filename)
     {
         LOG_F_DEBUG("scripting", "executing script: " << filename);
@@ -89,8 +341,44 @@ namespace OpenNero
             LOG_F_WARNING("scripting", "Could not find Python file: " << filename);
             return false;
         }
+
+        // a current bytecode cache next to the script skips re-parsing the
+        // source, which for short headless jobs is a measurable slice of
+        // the launch; loading is separated from running so a corrupt or
+        // stale cache falls back to the source without re-running anything
+        const string cache = filename + "c";
+        python::object code;
+        if (FileExists(cache) && FileNewerThan(cache, filename))
+        {
+            try {
+                python::dict env;
+                env["cache_path"] = cache;
+                python::exec(
+                    "import importlib.machinery\n"
+                    "code = importlib.machinery.SourcelessFileLoader('<cache>', cache_path).get_code('<cache>')\n",
+                    env, env);
+                code = env["code"];
+            }
+            catch (error_already_set const&)
+            {
+                PyErr_Clear();
+                LOG_F_WARNING("scripting", "ignoring unusable bytecode cache: " << cache);
+                code = python::object();
+            }
+        }
+
+        if (code.ptr() && code.ptr() != Py_None)
+        {
+            if (!ExecCode(code))
+            {
+                LOG_F_ERROR("scripting", "error executing script: " << filename);
+                return false;
+            }
+            return true;
+        }
+
         try {
-            python::exec_file(filename.c_str(), _globals, _globals);
+            python::exec_file(filename.c_str(), _active_ns->globals, _active_ns->globals);
         }
         catch (error_already_set const&)
         {
@@ -98,13 +386,99 @@ namespace OpenNero
             LogError();
             return false;
         }
+
+        // refresh the cache for the next launch; failing (e.g. a
+        // read-only install) just means the next launch parses the source
+        try {
+            python::dict env;
+            env["source_path"] = filename;
+            env["cache_path"] = cache;
+            python::exec(
+                "import py_compile\n"
+                "py_compile.compile(source_path, cache_path, doraise=True)\n",
+                env, env);
+        }
+        catch (error_already_set const&)
+        {
+            PyErr_Clear();
+        }
+        return true;
+    }
+
+    /// Compile every Python source under sourceDir into a packed bytecode
+    /// archive. The archive is a zip of .pyc entries laid out like the
+    /// source tree, which zipimport loads directly once AddScriptArchive
+    /// puts it on the module search path.
+    uint32_t ScriptingEngine::CompileScriptArchive(const string& sourceDir, const string& archivePath)
+    {
+        if (!FileExists(sourceDir))
+        {
+            LOG_F_WARNING("scripting", "script source path '" << sourceDir << "' does not exist");
+            return 0;
+        }
+        try {
+            python::dict env;
+            env["source_dir"] = sourceDir;
+            env["archive_path"] = archivePath;
+            python::exec(
+                "import os, py_compile, tempfile, zipfile\n"
+                "count = 0\n"
+                "archive = zipfile.ZipFile(archive_path, 'w', zipfile.ZIP_DEFLATED)\n"
+                "try:\n"
+                "    for root, dirs, files in os.walk(source_dir):\n"
+                "        for name in sorted(files):\n"
+                "            if not name.endswith('.py'):\n"
+                "                continue\n"
+                "            source = os.path.join(root, name)\n"
+                "            rel = os.path.relpath(source, source_dir)\n"
+                "            handle, compiled = tempfile.mkstemp(suffix='.pyc')\n"
+                "            os.close(handle)\n"
+                "            try:\n"
+                "                py_compile.compile(source, compiled, rel, doraise=True)\n"
+                "                archive.write(compiled, rel + 'c')\n"
+                "                count += 1\n"
+                "            finally:\n"
+                "                os.remove(compiled)\n"
+                "finally:\n"
+                "    archive.close()\n",
+                env, env);
+            const uint32_t count = python::extract<uint32_t>(env["count"]);
+            LOG_F_MSG("scripting", "compiled " << count << " scripts from "
+                      << sourceDir << " into " << archivePath);
+            return count;
+        }
+        catch (error_already_set const&)
+        {
+            LOG_F_ERROR("scripting", "error compiling script archive: " << archivePath);
+            LogError();
+            return 0;
+        }
+    }
+
+    /// Put a packed bytecode archive at the front of the module search
+    /// path; zipimport then serves mod imports from it without compiling
+    bool ScriptingEngine::AddScriptArchive(const string& archivePath)
+    {
+        if (!FileExists(archivePath))
+        {
+            LOG_F_WARNING("scripting", "script archive '" << archivePath << "' does not exist");
+            return false;
+        }
+        stringstream ss;
+        ss << "import sys" << endl;
+        ss << "sys.path.insert(0, \"" << archivePath << "\")" << endl;
+        if (!Exec(ss.str()))
+        {
+            return false;
+        }
+        LOG_F_MSG("scripting", "importing precompiled scripts from " << archivePath);
         return true;
     }
 
     bool ScriptingEngine::Exec(const string &snippet,bool supressErrors)
     {
         try {
-            python::exec(snippet.c_str(), _globals, _globals);
+            python::exec(snippet.c_str(), _active_ns->globals, _active_ns->globals);
         }
         catch (py::error_already_set const&)
         {
@@ -122,8 +496,57 @@ namespace OpenNero
         return true;
     }
 
+    python::object ScriptingEngine::Compile(const string& snippet)
+    {
+        PyObject* code = Py_CompileString(snippet.c_str(), "<scheduler>", Py_file_input);
+        if (!code)
+        {
+            LogError();
+            return python::object();
+        }
+        return python::object(python::handle<>(code));
+    }
+
+    python::object ScriptingEngine::CompileEval(const string& expression)
+    {
+        CallableCache::iterator found = _active_ns->evals.find(expression);
+        if (found != _active_ns->evals.end())
+        {
+            return found->second;
+        }
+        PyObject* code = Py_CompileString(expression.c_str(), "<eval>", Py_eval_input);
+        if (!code)
+        {
+            python::throw_error_already_set();
+        }
+        python::object compiled = python::object(python::handle<>(code));
+        _active_ns->evals[expression] = compiled;
+        return compiled;
+    }
+
+    bool ScriptingEngine::ExecCode(const python::object& code, bool supressErrors)
+    {
+        PyObject* result = PyEval_EvalCode(code.ptr(), _active_ns->globals.ptr(), _active_ns->globals.ptr());
+        if (!result)
+        {
+            if( !supressErrors )
+            {
+                LogError();
+            }
+            else
+            {
+                PyErr_Clear();
+            }
+
+            return false;
+        }
+        Py_DECREF(result);
+        return true;
+    }
+
     ScriptingEngine::ScriptingEngine()
-        : _main_module(), _globals(), _initialized(false)
+        : _main_module(), _initialized(false)
+        , _active_ns(&_default_ns), _saved_ns(NULL)
     {
     }
 
@@ -146,10 +569,22 @@ namespace OpenNero
             }
             python_zip.close();
 #endif
-            Py_SetProgramName(argv[0]);
+            // Register the module with the interpreter (must happen before Py_Initialize)
+            if (PyImport_AppendInittab( const_cast<char*>(kDefaultModuleName), PyInit_OpenNero) == -1)
+            {
+                throw runtime_error("Failed to export OpenNero to Python");
+            }
+            wchar_t* program_name = Py_DecodeLocale(argv[0], NULL);
+            Py_SetProgramName(program_name);
             Py_InitializeEx(0); // no interrupt handlers
-            PySys_SetArgv(argc, argv);
+            std::vector<wchar_t*> wargv(argc);
+            for (int i = 0; i < argc; ++i)
+            {
+                wargv[i] = Py_DecodeLocale(argv[i], NULL);
+            }
+            PySys_SetArgv(argc, &wargv[0]);
             Assert(Py_IsInitialized());
+            StartupReport::MarkStage("python interpreter");
             reinitialize();
         }
     }
@@ -158,11 +593,16 @@ namespace OpenNero
     {
         if (!_initialized)
         {
+            // anything cached against the old namespaces is stale now
+            _default_ns.callables.clear();
+            _default_ns.evals.clear();
+            DestroyContextNamespaces();
+
             // get the main module
             _main_module = python::import("__main__");
 
             // get the namespace of the main module
-            _globals = py::dict(_main_module.attr("__dict__"));
+            _default_ns.globals = py::dict(_main_module.attr("__dict__"));
 
             // add the client and server directories of the current mod
             AddScriptDirectory( Kernel::findResource("") ); // for the mod we arem loading
@@ -170,12 +610,6 @@ namespace OpenNero
             
             LOG_F_DEBUG("scripting", "initialized path");
 
-            // Register the module with the interpreter
-            if (PyImport_AppendInittab( const_cast<char*>(kDefaultModuleName), initOpenNero) == -1)
-            {
-                throw runtime_error("Failed to export OpenNero to Python");
-            }
-
             // Register our own log writer as the error output
             Exec("from OpenNero import StdLogWriter, ErrLogWriter\n"
                  "import sys\n"
@@ -191,6 +625,7 @@ namespace OpenNero
 
             _initialized = true;
 
+            StartupReport::MarkStage("scripting engine");
             LOG_F_MSG("scripting", "scripting engine initialized");
         }
     }
@@ -200,18 +635,74 @@ namespace OpenNero
         if( _initialized )
         {
             _initialized = false;
-            _globals.clear();
-            //if (_network_log_writer) {
-            //    try {
-            //        _network_log_writer.attr("close")();
-            //    } catch (py::error_already_set const&) {
-            //        // ignore errors on close
-            //    }
-            //}
-            
+            _default_ns.callables.clear();
+            _default_ns.evals.clear();
+            _default_ns.globals.clear();
+            DestroyContextNamespaces();
+
+            // flush any telemetry still in flight and stop the sender
+            PlotWriter::Shutdown();
         }
     }
 
+    void ScriptingEngine::ActivateContextNamespace( const void* key )
+    {
+        ScriptNamespace* ns;
+        ContextNamespaceMap::iterator found = _context_ns.find(key);
+        if (found != _context_ns.end())
+        {
+            ns = found->second;
+        }
+        else
+        {
+            // first activation: seed a fresh namespace the same way the
+            // default one is seeded on reinitialize
+            ns = new ScriptNamespace;
+            ns->globals = py::dict(_main_module.attr("__dict__"));
+            try
+            {
+                python::exec("from OpenNero import *", ns->globals, ns->globals);
+            }
+            catch (python::error_already_set const &)
+            {
+                LogError();
+            }
+            _context_ns[key] = ns;
+        }
+        // remember the displaced namespace only on the first activation so
+        // nested activations cannot save a pooled namespace as "current"
+        if (!_saved_ns)
+        {
+            _saved_ns = _active_ns;
+        }
+        _active_ns = ns;
+    }
+
+    void ScriptingEngine::DeactivateContextNamespace()
+    {
+        if (_saved_ns)
+        {
+            _active_ns = _saved_ns;
+            _saved_ns = NULL;
+        }
+        else
+        {
+            _active_ns = &_default_ns;
+        }
+    }
+
+    void ScriptingEngine::DestroyContextNamespaces()
+    {
+        ContextNamespaceMap::iterator iter;
+        for (iter = _context_ns.begin(); iter != _context_ns.end(); ++iter)
+        {
+            delete iter->second;
+        }
+        _context_ns.clear();
+        _active_ns = &_default_ns;
+        _saved_ns = NULL;
+    }
+
     ScriptingEngine& ScriptingEngine::instance()
     {
 		static ScriptingEngine scripting;
@@ -247,27 +738,46 @@ namespace OpenNero
 
     // initialize our default module
     void InitializeScriptModule() {
+        // headless condor jobs never call help(); skipping docstring
+        // generation takes a measurable bite out of the hundreds of def()
+        // registrations below
+        py::docstring_options docstrings( !GetAppConfig().Headless );
         scripting::ExportScripts();
+        StartupReport::MarkStage("OpenNero module export");
         LOG_F_DEBUG("scripting", "OpenNero Python module initialized");
     }
 
     void ScriptingEngine::LogError()
     {
         PyErr_Print();
-        PrintDebuggingInfo(_globals, _globals);
+        PrintDebuggingInfo(_active_ns->globals, _active_ns->globals);
         AssertMsg(false, "Python error");
     }
     
     void ScriptingEngine::NetworkWrite(const std::string& message)
     {
-        //if (_network_log_writer) {
-        //    try {
-        //        _network_log_writer.attr("write")(message);
-        //    } catch (py::error_already_set const&) {
-        //        LogError();
-        //    }
-        //} else {
-        //    Log::LogMsg(NULL, NULL, message.c_str());
-        //}
+        // hand the message to the background sender; never blocks on the
+        // network no matter what state the plot server is in
+        PlotWriter::Enqueue(message);
+    }
+
+    /// release the GIL so background Python threads can run during a
+    /// C++-only phase; a no-op before the interpreter is initialized
+    ScopedGILRelease::ScopedGILRelease()
+        : mThreadState(NULL)
+    {
+        if (Py_IsInitialized())
+        {
+            mThreadState = PyEval_SaveThread();
+        }
+    }
+
+    /// re-acquire the GIL
+    ScopedGILRelease::~ScopedGILRelease()
+    {
+        if (mThreadState)
+        {
+            PyEval_RestoreThread(mThreadState);
+        }
     }
 }
@@ -2,8 +2,10 @@
 #define _OPENNERO_SCRIPTING_SCRIPTING_H_
 
 #include "core/Common.h"
+#include "core/HashMap.h"
 #include "scripting/scriptIncludes.h"
 #include "scripting/Scheduler.h"
+#include "utils/Profiler.h"
 
 namespace OpenNero
 {
@@ -32,11 +34,32 @@ namespace OpenNero
     class ScriptingEngine
     {
     private:
+        /// cache of callables looked up by name
+        typedef hash_map<std::string, python::object> CallableCache;
+
+        /// The global namespace scripts run in, together with the caches
+        /// derived from it. The mod's own scripts use the default
+        /// instance; each pooled SimContext gets one of its own (see
+        /// ActivateContextNamespace), so script-level state does not leak
+        /// between the parallel training environments.
+        struct ScriptNamespace
+        {
+            python::dict globals;    ///< the namespace scripts run in
+            CallableCache callables; ///< callables cached by name for per-tick dispatch
+            CallableCache evals;     ///< expression code objects cached by source string for Eval
+        };
+
+        /// per pooled-context namespaces keyed by the context's address
+        typedef hash_map<const void*, ScriptNamespace*> ContextNamespaceMap;
+
         python::object _main_module;        ///< main module
-        python::dict _globals;              ///< global namespace
         python::object _network_log_writer; ///< network log writer object
         bool _initialized;                  ///< flag to mark if this scripting engine is initialized
         Scheduler _scheduler;               ///< the event scheduler for scripts
+        ScriptNamespace _default_ns;        ///< the mod's own namespace and caches
+        ContextNamespaceMap _context_ns;    ///< namespaces of the pooled worker contexts
+        ScriptNamespace* _active_ns;        ///< namespace scripts currently run in
+        ScriptNamespace* _saved_ns;         ///< namespace displaced by ActivateContextNamespace
 
     public:
 
@@ -94,11 +117,46 @@ namespace OpenNero
         bool ImportModule(const std::string& moduleName);
 
         /**
-         * Call the script contained in fileName
+         * Import every module listed in a mod's preimport manifest. The
+         * manifest is a mod resource with one module name per line ('#'
+         * starts a comment); mods that front-load heavyweight imports this
+         * way pay for them inside the measured startup window instead of
+         * on their first tick. A missing manifest is not an error.
+         * @param manifestName mod-relative name of the manifest resource
+         * @return the number of modules imported
+         */
+        uint32_t ImportPreimportManifest(const std::string& manifestName);
+
+        /**
+         * Call the script contained in fileName. If a bytecode cache
+         * written by a previous launch sits next to the file (fileName +
+         * "c") and is at least as new as the source, the cached code is
+         * executed instead of re-parsing the source; otherwise the source
+         * is compiled and the cache is refreshed for the next launch.
          * @param fileName name of the script file to run
          * @return true iff successful
          */
         bool ExecFile(const std::string& fileName);
+
+        /**
+         * Compile every Python source under sourceDir into a packed
+         * bytecode archive that AddScriptArchive can later import from.
+         * Intended as a mod-build step run once per deployment, so the
+         * short headless jobs that follow skip parsing the mod scripts.
+         * @param sourceDir directory whose .py files are compiled
+         * @param archivePath path of the archive to create
+         * @return the number of scripts compiled into the archive
+         */
+        uint32_t CompileScriptArchive(const std::string& sourceDir, const std::string& archivePath);
+
+        /**
+         * Put a packed bytecode archive produced by CompileScriptArchive
+         * at the front of the module search path, so mod imports resolve
+         * to precompiled bytecode without touching the source tree.
+         * @param archivePath path of the archive to import from
+         * @return true iff the archive exists and was added
+         */
+        bool AddScriptArchive(const std::string& archivePath);
         
         /**
          * Execute the statements contained in the parameter string
@@ -108,6 +166,56 @@ namespace OpenNero
          */
         bool Exec(const std::string& statement, bool supressErrors = false );
 
+        /**
+         * Compile a snippet into a Python code object that can be executed
+         * repeatedly without re-parsing the text
+         * @param snippet code to compile
+         * @return the code object, or None if compilation failed (logged)
+         */
+        python::object Compile(const std::string& snippet);
+
+        /**
+         * Execute a code object previously produced by Compile in the
+         * global namespace
+         * @param code the compiled code object
+         * @param supressErrors if true do not fail on errors
+         * @return true iff successful
+         */
+        bool ExecCode(const python::object& code, bool supressErrors = false );
+
+        /**
+         * Compile an expression for Eval, serving repeats from a cache
+         * keyed by the source string, so a hot expression (GUI bindings,
+         * per-frame mod logic) pays for parsing and compilation only
+         * once. The cache is flushed whenever the engine is destroyed or
+         * reinitialized. Throws error_already_set if the expression does
+         * not compile.
+         * @param expression a Python expression
+         * @return the compiled code object
+         */
+        python::object CompileEval(const std::string& expression);
+
+        /**
+         * Route script execution to the given pooled context's own global
+         * namespace, creating and seeding it on first use. Each pooled
+         * SimContext keeps independent script-level state (and its own
+         * callable and expression caches), so the multi-context training
+         * mode does not leak mod globals between environments. Stronger
+         * subinterpreter isolation is not available here: Boost.Python's
+         * converter registries are process-global and this CPython shares
+         * one GIL between subinterpreters anyway, so imported module state
+         * stays shared and scripted execution stays serialized.
+         * @param key address of the context the namespace belongs to
+         */
+        void ActivateContextNamespace( const void* key );
+
+        /// restore the namespace active before ActivateContextNamespace
+        void DeactivateContextNamespace();
+
+        /// tear down every per-context namespace (used when the context
+        /// pool is destroyed or the engine shuts down)
+        void DestroyContextNamespaces();
+
         /**
          * Add a directory for the engine to search for script files in
          * @param dirPath the full directory path to search inside
@@ -121,7 +229,7 @@ namespace OpenNero
         template <typename Result>
         bool Extract(const std::string& name, Result& result)
         {
-            python::object o = _globals[name.c_str()];
+            python::object o = _active_ns->globals[name.c_str()];
 
             python::extract<Result> extraction(o);
             result = extraction();
@@ -137,9 +245,16 @@ namespace OpenNero
         template <typename Result>
         bool Eval( const std::string& expression, Result& result)
         {
+            ScopedCrossing crossing("ScriptingEngine::Eval", expression);
             python::object o;
             try {
-                o = python::eval(expression.c_str(), _globals, _globals);
+                python::object code = CompileEval(expression);
+                PyObject* res = PyEval_EvalCode(code.ptr(), _active_ns->globals.ptr(), _active_ns->globals.ptr());
+                if (!res)
+                {
+                    python::throw_error_already_set();
+                }
+                o = python::object(python::handle<>(res));
             }
             catch (python::error_already_set const &)
             {
@@ -151,12 +266,34 @@ namespace OpenNero
             return true;
         }
 
+        /**
+         * Look up a callable global by name, caching the result so that
+         * per-tick dispatch (e.g. Python AI brains) does not repeat the
+         * dictionary lookup on every call. The cache is flushed whenever
+         * the engine is destroyed or reinitialized. Throws error_already_set
+         * if the name is not defined, just like a direct lookup would.
+         * @param methodName name of the callable in the global namespace
+         * @return the cached callable object
+         */
+        python::object GetCallable( const std::string& methodName )
+        {
+            CallableCache::iterator found = _active_ns->callables.find(methodName);
+            if (found != _active_ns->callables.end())
+            {
+                return found->second;
+            }
+            python::object method = _active_ns->globals[methodName];
+            _active_ns->callables[methodName] = method;
+            return method;
+        }
+
         /// Call a script method with no parameters and no return value
         void Call( const std::string& methodName )
         {
+            ScopedCrossing crossing("ScriptingEngine::Call", methodName);
             try
             {
-                python::object method = _globals[methodName];
+                python::object method = GetCallable(methodName);
                 AssertMsg(method.ptr(), "Failed to find method '" << methodName << "'");
                 method();
             }
@@ -170,10 +307,11 @@ namespace OpenNero
         template <typename Result>
         Result Call( const std::string& methodName )
         {
+            ScopedCrossing crossing("ScriptingEngine::Call", methodName);
             python::object res;
             try
             {
-                python::object method = _globals[methodName];
+                python::object method = GetCallable(methodName);
                 AssertMsg(method.ptr(), "Failed to find method '" << methodName << "'");
                 res = method();
             }
@@ -190,9 +328,10 @@ namespace OpenNero
         template <typename Param0>
         void Call( const std::string& methodName, const Param0& p0 )
         {
+            ScopedCrossing crossing("ScriptingEngine::Call", methodName);
             try
             {
-                python::object method = _globals[methodName];
+                python::object method = GetCallable(methodName);
                 AssertMsg(method.ptr(), "Failed to find method '" << methodName << "'");
                 method(p0);
             }
@@ -206,10 +345,11 @@ namespace OpenNero
         template <typename Result, typename Param0>
         Result Call( const std::string& methodName, const Param0& p0 )
         {
+            ScopedCrossing crossing("ScriptingEngine::Call", methodName);
             python::object res;
             try
             {
-                python::object method = _globals[methodName];
+                python::object method = GetCallable(methodName);
                 AssertMsg(method.ptr(), "Failed to find method '" << methodName << "'");
                 res = method(p0);
             }
@@ -226,10 +366,11 @@ namespace OpenNero
         template <typename Result, typename Param0, typename Param1>
         Result Call( const std::string& methodName, const Param0& p0, const Param1& p1 )
         {
+            ScopedCrossing crossing("ScriptingEngine::Call", methodName);
             python::object res;
             try
             {
-                python::object method = _globals[methodName];
+                python::object method = GetCallable(methodName);
                 AssertMsg(method.ptr(), "Failed to find method '" << methodName << "'");
                 res = method(p0,p1);
             }
@@ -243,6 +384,22 @@ namespace OpenNero
         }
     };
 
+    /**
+     * Releases the Python GIL for the duration of a C++-only scope, so
+     * background Python threads (dashboard, plot client) can run while the
+     * engine is busy in a phase that never calls back into Python. The
+     * scope must not execute any Python code: no boost::python calls, no
+     * script callbacks, no Python agent brains.
+     */
+    class ScopedGILRelease
+    {
+    public:
+        ScopedGILRelease();
+        ~ScopedGILRelease();
+    private:
+        PyThreadState* mThreadState; ///< saved thread state while the GIL is released
+    };
+
     /**
      * Attempt the execution of a given executable object. The executable
      * object is expected to have a () operator defined which returns a
@@ -305,14 +462,71 @@ namespace OpenNero
     template<typename WrappedType>
     class TryWrapper : public python::wrapper<WrappedType>
     {
+        /// A resolved override. The class-level function is cached instead
+        /// of the bound method get_override returns, because a bound method
+        /// strongly references the Python instance and storing it in the
+        /// C++ half would create a cycle the garbage collector cannot see.
+        struct CachedOverride
+        {
+            python::object callable; ///< what to invoke (None when not overridden)
+            bool pass_self;          ///< prepend the Python instance when calling
+            CachedOverride() : pass_self(false) {}
+        };
+
+        /// overrides resolved by method name
+        typedef hash_map<std::string, CachedOverride> OverrideCache;
+
+        OverrideCache mOverrideCache;
+
+        /// the Python instance this wrapper is the C++ half of
+        python::object PySelf() const
+        {
+            return python::object(python::borrowed(
+                python::detail::wrapper_base_::get_owner(*this)));
+        }
+
+        /// Resolve the Python override for the named method once and serve
+        /// repeats from the cache; the hottest C++-to-Python bridges
+        /// (PyEnvironment::step, the PyAgentBrain callbacks) otherwise pay
+        /// a Python attribute lookup per agent per tick. A None entry
+        /// records "not overridden", so misses are cached too.
+        const CachedOverride& ResolveOverride(const char* name)
+        {
+            typename OverrideCache::iterator found = mOverrideCache.find(name);
+            if (found == mOverrideCache.end())
+            {
+                CachedOverride entry;
+                python::override f = this->get_override(name);
+                if (f.ptr() && f.ptr() != Py_None)
+                {
+                    if (PyMethod_Check(f.ptr()))
+                    {
+                        entry.callable = python::object(python::borrowed(
+                            PyMethod_GET_FUNCTION(f.ptr())));
+                        entry.pass_self = true;
+                    }
+                    else
+                    {
+                        // not a regular method (e.g. a staticmethod); call
+                        // it as-is
+                        entry.callable = f;
+                    }
+                }
+                found = mOverrideCache.insert(std::make_pair(std::string(name), entry)).first;
+            }
+            return found->second;
+        }
+
     protected:
         /// Find the Python override method and call it.
         inline
         void TryOverride(const char* name)
         {
+            ScopedCrossing crossing("TryWrapper::TryOverride", name);
             try {
-                if (python::override f = this->get_override(name)) {
-                    f();
+                const CachedOverride& f = ResolveOverride(name);
+                if (f.callable.ptr() != Py_None) {
+                    f.pass_self ? f.callable(PySelf()) : f.callable();
                 } else {
                     AssertMsg(false, "Unable to find Python override for method: " << name);
                 }
@@ -326,9 +540,11 @@ namespace OpenNero
         inline
         void TryOverride(const char* name, Result& result)
         {
+            ScopedCrossing crossing("TryWrapper::TryOverride", name);
             try {
-                if (python::override f = this->get_override(name)) {
-                    python::object res = f();
+                const CachedOverride& f = ResolveOverride(name);
+                if (f.callable.ptr() != Py_None) {
+                    python::object res = f.pass_self ? f.callable(PySelf()) : f.callable();
                     python::extract<Result> extraction(res);
                     result = extraction();
                 } else {
@@ -345,9 +561,11 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                          Param0& param0)
         {
+            ScopedCrossing crossing("TryWrapper::TryOverride", name);
             try {
-                if (python::override f = this->get_override(name)) {
-                    python::object res = f(param0);
+                const CachedOverride& f = ResolveOverride(name);
+                if (f.callable.ptr() != Py_None) {
+                    python::object res = f.pass_self ? f.callable(PySelf(), param0) : f.callable(param0);
                     python::extract<Result> extraction(res);
                     result = extraction();
                 } else {
@@ -364,9 +582,11 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                          Param0& param0, Param1& param1)
         {
+            ScopedCrossing crossing("TryWrapper::TryOverride", name);
             try {
-                if (python::override f = this->get_override(name)) {
-                    python::object res = f(param0, param1);
+                const CachedOverride& f = ResolveOverride(name);
+                if (f.callable.ptr() != Py_None) {
+                    python::object res = f.pass_self ? f.callable(PySelf(), param0, param1) : f.callable(param0, param1);
                     python::extract<Result> extraction(res);
                     result = extraction();
                 } else {
@@ -383,9 +603,11 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                            Param0& param0, Param1& param1, Param2& param2)
         {
+            ScopedCrossing crossing("TryWrapper::TryOverride", name);
             try {
-                if (python::override f = this->get_override(name)) {
-                    python::object res = f(param0, param1, param2);
+                const CachedOverride& f = ResolveOverride(name);
+                if (f.callable.ptr() != Py_None) {
+                    python::object res = f.pass_self ? f.callable(PySelf(), param0, param1, param2) : f.callable(param0, param1, param2);
                     python::extract<Result> extraction(res);
                     result = extraction();
                 } else {
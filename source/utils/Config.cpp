@@ -38,6 +38,7 @@ namespace OpenNero
         , VSync(false)
         , RandomSeeds("12345")
         , FrameDelay(0.5)
+        , Headless(false)
     {
     }
 
@@ -117,6 +118,7 @@ namespace OpenNero
             if (argHeadlessMode.getValue()) {
                 RenderType = "null";
                 FrameDelay = 0;
+                Headless = true;
             } else {
                 FrameDelay = argFrameDelay.getValue();
             }
@@ -191,6 +193,30 @@ namespace OpenNero
 
                 // set the receiver list in the log
                 OpenNero::Log::LogSystemSpecifyFilters( filterList );
+
+                // optional per-subsystem severity thresholds, checked before
+                // any message formatting, e.g. log_levels = { 'ai': 2 }
+                boost::python::dict pyLevels;
+                if( se.Eval<boost::python::dict>("dict(globals().get('log_levels', {}))", pyLevels) )
+                {
+                    boost::python::list items = pyLevels.items();
+                    const OpenNero::uint32_t numLevels = boost::python::extract<OpenNero::uint32_t>(items.attr("__len__")());
+                    for( OpenNero::uint32_t i = 0; i < numLevels; ++i )
+                    {
+                        string type = boost::python::extract<string>(items[i][0]);
+                        int level = boost::python::extract<int>(items[i][1]);
+                        OpenNero::Log::LogSystemSetTypeLevel( type, level );
+                        LOG_MSG( "Minimum log level for type " << type << ": " << level );
+                    }
+                }
+
+                // optionally route log output through the background flusher
+                bool asyncLog = false;
+                if( se.Eval<bool>("bool(globals().get('async_log', False))", asyncLog) && asyncLog )
+                {
+                    OpenNero::Log::LogSystemEnableAsync();
+                    LOG_MSG( "Asynchronous logging enabled." );
+                }
             }
         }
 
@@ -35,6 +35,7 @@ namespace OpenNero
         bool        VSync;              ///< Should we use vsync?
         std::string RandomSeeds;        ///< Random seed buffer
         float32_t   FrameDelay;         ///< the delay between AI frames to use for animation (in seconds)
+        bool        Headless;           ///< run without rendering at an uncapped tick rate
 
         /// Constructor
         AppConfig();
@@ -60,6 +61,7 @@ namespace OpenNero
             ar & BOOST_SERIALIZATION_NVP(VSync);
             ar & BOOST_SERIALIZATION_NVP(RandomSeeds);
             ar & BOOST_SERIALIZATION_NVP(FrameDelay);
+            ar & BOOST_SERIALIZATION_NVP(Headless);
         }
     };
 
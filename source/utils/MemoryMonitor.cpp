@@ -0,0 +1,189 @@
+//--------------------------------------------------------
+// OpenNero : MemoryMonitor
+//  per-subsystem memory attribution
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "utils/MemoryMonitor.h"
+
+#include "core/Bitstream.h"
+#include "core/IrrUtil.h"
+#include "game/Kernel.h"
+#include "game/SimContext.h"
+#include "game/SimEntity.h"
+#include "game/Simulation.h"
+
+#include "rtneat/objectpool.h"
+#include "rtneat/gene.h"
+#include "rtneat/link.h"
+#include "rtneat/nnode.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// wall clock in nanoseconds for the periodic log
+        uint64_t MonitorNanos()
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /// one entry for a NEAT object pool
+        MemoryMonitor::Entry PoolEntry(const std::string& label, const NEAT::PoolStats& stats)
+        {
+            MemoryMonitor::Entry entry;
+            entry.label = label;
+            entry.count = stats.in_use;
+            entry.bytes = stats.reserved_bytes;
+            return entry;
+        }
+
+        /// resident set size of the process in bytes (0 if unavailable)
+        uint64_t ProcessResidentBytes()
+        {
+#if defined(__linux__)
+            std::ifstream statm("/proc/self/statm");
+            uint64_t pages_total = 0, pages_resident = 0;
+            if (statm >> pages_total >> pages_resident)
+            {
+                return pages_resident * (uint64_t)sysconf(_SC_PAGESIZE);
+            }
+#endif
+            return 0;
+        }
+    }
+
+    MemoryMonitor& MemoryMonitor::instance()
+    {
+        static MemoryMonitor monitor;
+        return monitor;
+    }
+
+    MemoryMonitor::MemoryMonitor()
+        : mLogPeriod(0)
+        , mLastLogNanos(0)
+    {
+    }
+
+    std::vector<MemoryMonitor::Entry> MemoryMonitor::Poll() const
+    {
+        std::vector<Entry> entries;
+
+        // the chunked pools the NEAT primitives are carved from
+        entries.push_back(PoolEntry("rtneat.genes", NEAT::Gene::pool_stats()));
+        entries.push_back(PoolEntry("rtneat.links", NEAT::Link::pool_stats()));
+        entries.push_back(PoolEntry("rtneat.nodes", NEAT::NNode::pool_stats()));
+
+        SimContextPtr context = Kernel::GetSimContext();
+        if (context)
+        {
+            // the entity structs themselves; their scene and AI components
+            // are attributed to Irrlicht and the brains respectively
+            Entry entities;
+            entities.label = "sim.entities";
+            entities.count = context->getSimulation()->GetEntities().size();
+            entities.bytes = entities.count * sizeof(SimEntity);
+            entries.push_back(entities);
+
+            // texture memory held by the video driver
+            irr::video::IVideoDriver* driver = context->GetSceneManager()->getVideoDriver();
+            if (driver)
+            {
+                Entry textures;
+                textures.label = "irr.textures";
+                textures.count = driver->getTextureCount();
+                textures.bytes = 0;
+                for (irr::u32 i = 0; i < driver->getTextureCount(); ++i)
+                {
+                    irr::video::ITexture* texture = driver->getTextureByIndex(i);
+                    if (texture)
+                    {
+                        textures.bytes += (uint64_t)texture->getPitch() * texture->getSize().Height;
+                    }
+                }
+                entries.push_back(textures);
+            }
+        }
+
+        // the biggest payload the streaming layer has had to buffer
+        Entry bitstream;
+        bitstream.label = "core.bitstream_peak";
+        bitstream.count = 0;
+        bitstream.bytes = Bitstream::PeakBytes();
+        entries.push_back(bitstream);
+
+        // what the OS actually holds against us; the gap between this and
+        // the attributed entries is Python, Irrlicht internals and malloc
+        // overhead
+        Entry resident;
+        resident.label = "process.resident";
+        resident.count = 0;
+        resident.bytes = ProcessResidentBytes();
+        entries.push_back(resident);
+
+        return entries;
+    }
+
+    std::string MemoryMonitor::Report() const
+    {
+        const std::vector<Entry> entries = Poll();
+        std::stringstream report;
+        report << std::fixed << std::setprecision(2);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries[i];
+            if (i > 0)
+                report << '\n';
+            report << entry.label << ": " << (entry.bytes / (1024.0 * 1024.0)) << " MB";
+            if (entry.count > 0)
+                report << " (" << entry.count << " live)";
+        }
+        return report.str();
+    }
+
+    void MemoryMonitor::SetLogPeriod(float32_t seconds)
+    {
+        mLogPeriod = seconds > 0 ? seconds : 0;
+        mLastLogNanos = MonitorNanos();
+        if (mLogPeriod > 0)
+        {
+            LOG_F_MSG("game", "memory monitor logging every " << mLogPeriod << " s");
+        }
+        else
+        {
+            LOG_F_MSG("game", "memory monitor periodic logging off");
+        }
+    }
+
+    void MemoryMonitor::ProcessTick()
+    {
+        if (mLogPeriod <= 0)
+            return;
+        const uint64_t now = MonitorNanos();
+        if (now - mLastLogNanos < (uint64_t)(mLogPeriod * 1.0e9))
+            return;
+        mLastLogNanos = now;
+
+        const std::vector<Entry> entries = Poll();
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const Entry& entry = entries[i];
+            if (entry.count > 0)
+            {
+                LOG_F_MSG("game", "memory " << entry.label << ": "
+                    << entry.bytes / 1024 << " KB, " << entry.count << " live");
+            }
+            else
+            {
+                LOG_F_MSG("game", "memory " << entry.label << ": "
+                    << entry.bytes / 1024 << " KB");
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+//--------------------------------------------------------
+// OpenNero : MemoryMonitor
+//  per-subsystem memory attribution
+//--------------------------------------------------------
+
+#ifndef _UTILS_MEMORYMONITOR_H_
+#define _UTILS_MEMORYMONITOR_H_
+
+#include <string>
+#include <vector>
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * Attributes the process's memory between the subsystems that grow
+     * during long training runs: the NEAT object pools, the simulation's
+     * entities, Irrlicht textures and the streaming buffers. The numbers
+     * are polled on demand rather than tracked per allocation, so an idle
+     * monitor costs nothing; a periodic log through the normal logging
+     * system makes slow growth attributable before a run dies.
+     */
+    class MemoryMonitor
+    {
+    public:
+
+        /// one attributed memory figure
+        struct Entry
+        {
+            std::string label;  ///< what the bytes belong to
+            uint64_t count;     ///< live object count (0 if not applicable)
+            uint64_t bytes;     ///< bytes attributed to the label
+        };
+
+        /// singleton accessor
+        static MemoryMonitor& instance();
+
+        /// poll every tracked subsystem for its current usage
+        std::vector<Entry> Poll() const;
+
+        /// format the polled usage as a multi-line human-readable report
+        std::string Report() const;
+
+        /// log the report line by line every period seconds (0 turns the
+        /// periodic log off)
+        void SetLogPeriod(float32_t seconds);
+
+        /// called once per frame by the kernel; logs the report when the
+        /// period has elapsed
+        void ProcessTick();
+
+    private:
+
+        MemoryMonitor();
+
+        float32_t mLogPeriod;   ///< seconds between periodic logs (0 = off)
+        uint64_t mLastLogNanos; ///< wall clock of the last periodic log
+    };
+}
+
+#endif // _UTILS_MEMORYMONITOR_H_
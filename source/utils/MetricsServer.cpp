@@ -0,0 +1,350 @@
+//--------------------------------------------------------
+// OpenNero : MetricsServer
+//  scrape-able live metrics endpoint
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "utils/MetricsServer.h"
+
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if NERO_PLATFORM_WINDOWS
+    #include <winsock2.h>
+#else
+    #include <sys/socket.h>
+    #include <sys/select.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+#endif
+
+#include "core/ONTime.h"
+#include "utils/MemoryMonitor.h"
+#include "utils/Profiler.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+#if NERO_PLATFORM_WINDOWS
+        typedef SOCKET SocketHandle;
+        static const SocketHandle kInvalidSocket = INVALID_SOCKET;
+#else
+        typedef int SocketHandle;
+        static const SocketHandle kInvalidSocket = -1;
+#endif
+
+        /// how long the accept loop waits before re-checking the stop flag
+        const long kAcceptPollMicros = 200 * 1000;
+
+        /// the tick rate window and the slow-section refresh period
+        const uint64_t kRateWindowNanos = 1000ULL * 1000 * 1000;
+        const uint64_t kSlowRefreshNanos = 5ULL * 1000 * 1000 * 1000;
+
+        /// close a socket handle on either platform
+        void Close( SocketHandle sock )
+        {
+#if NERO_PLATFORM_WINDOWS
+            closesocket(sock);
+#else
+            close(sock);
+#endif
+        }
+
+        /// escape a metric label value (backslash, quote, newline)
+        std::string EscapeLabel( const std::string& value )
+        {
+            std::string escaped;
+            escaped.reserve(value.size());
+            for (size_t i = 0; i < value.size(); ++i)
+            {
+                const char c = value[i];
+                if (c == '\\' || c == '"')
+                {
+                    escaped += '\\';
+                    escaped += c;
+                }
+                else if (c == '\n')
+                {
+                    escaped += "\\n";
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        /// write the whole response to the socket; best effort
+        void SendAll( SocketHandle sock, const std::string& msg )
+        {
+            size_t sent = 0;
+            while (sent < msg.size())
+            {
+                long n = send(sock, msg.c_str() + sent, (int)(msg.size() - sent), 0);
+                if (n <= 0)
+                    return;
+                sent += (size_t)n;
+            }
+        }
+    }
+
+    /// the listening socket and the serving thread
+    struct MetricsServer::ServerState
+    {
+        SocketHandle listener;     ///< the bound listening socket
+        std::thread server;        ///< the serving thread
+        std::atomic<bool> running; ///< cleared to ask the thread to exit
+        U16 port;                  ///< the port the listener is bound to
+
+        ServerState() : listener(kInvalidSocket), running(false), port(0) {}
+    };
+
+    /// accept scrapes and answer each with one metrics snapshot; the
+    /// listener stays in non-blocking select so Stop() is prompt
+    void MetricsServer::ServeLoop( ServerState* state, const MetricsServer* metrics )
+    {
+        while (state->running.load(std::memory_order_acquire))
+        {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(state->listener, &readable);
+            timeval timeout;
+            timeout.tv_sec = 0;
+            timeout.tv_usec = kAcceptPollMicros;
+            const int ready = select((int)state->listener + 1, &readable, NULL, NULL, &timeout);
+            if (ready <= 0)
+                continue;
+
+            SocketHandle client = accept(state->listener, NULL, NULL);
+            if (client == kInvalidSocket)
+                continue;
+
+            // one snapshot per connection; the request itself (a GET
+            // line from curl or a scraper) can be ignored
+            const std::string body = metrics->RenderSnapshot();
+            std::ostringstream response;
+            response << "HTTP/1.0 200 OK\r\n"
+                     << "Content-Type: text/plain; version=0.0.4\r\n"
+                     << "Content-Length: " << body.size() << "\r\n"
+                     << "Connection: close\r\n\r\n"
+                     << body;
+            SendAll(client, response.str());
+            Close(client);
+        }
+    }
+
+    MetricsServer& MetricsServer::instance()
+    {
+        static MetricsServer server;
+        return server;
+    }
+
+    MetricsServer::MetricsServer()
+        : mServer(NULL)
+        , mTicksTotal(0)
+        , mLastTickNanos(0)
+        , mTicksPerSecond(0)
+        , mEntities(0)
+        , mSimTimeMicros(0)
+        , mWindowStartNanos(0)
+        , mWindowTicks(0)
+        , mLastSlowRefreshNanos(0)
+    {
+    }
+
+    MetricsServer::~MetricsServer()
+    {
+        Stop();
+    }
+
+    bool MetricsServer::Start( U16 port )
+    {
+        if (mServer)
+        {
+            LOG_F_WARNING("game", "metrics server already running on port " << mServer->port);
+            return false;
+        }
+
+#if NERO_PLATFORM_WINDOWS
+        static bool winsock_ready = false;
+        if (!winsock_ready)
+        {
+            WSADATA wsa;
+            if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+                return false;
+            winsock_ready = true;
+        }
+#endif
+
+        SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == kInvalidSocket)
+        {
+            LOG_F_ERROR("game", "metrics server could not create a socket");
+            return false;
+        }
+
+        const int enable = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&enable, sizeof(enable));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = htons(port);
+        if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+            listen(listener, 4) != 0)
+        {
+            LOG_F_ERROR("game", "metrics server could not listen on port " << port);
+            Close(listener);
+            return false;
+        }
+
+        mServer = new ServerState;
+        mServer->listener = listener;
+        mServer->port = port;
+        mServer->running.store(true, std::memory_order_release);
+        mServer->server = std::thread(&ServeLoop, mServer, this);
+        LOG_F_MSG("game", "metrics endpoint up at http://127.0.0.1:" << port << "/");
+        return true;
+    }
+
+    void MetricsServer::Stop()
+    {
+        if (!mServer)
+            return;
+        mServer->running.store(false, std::memory_order_release);
+        if (mServer->server.joinable())
+            mServer->server.join();
+        Close(mServer->listener);
+        delete mServer;
+        mServer = NULL;
+    }
+
+    bool MetricsServer::IsRunning() const
+    {
+        return mServer != NULL;
+    }
+
+    void MetricsServer::RecordTick( float32_t dt, uint64_t tickNanos, size_t entities )
+    {
+        mTicksTotal.fetch_add(1, std::memory_order_relaxed);
+        mLastTickNanos.store(tickNanos, std::memory_order_relaxed);
+        mEntities.store(entities, std::memory_order_relaxed);
+        mSimTimeMicros.fetch_add((uint64_t)(dt * 1e6), std::memory_order_relaxed);
+
+        // the tick rate over a sliding one-second window
+        const uint64_t now = HighResClock::GetNanoseconds();
+        if (mWindowStartNanos == 0)
+            mWindowStartNanos = now;
+        mWindowTicks += 1;
+        if (now - mWindowStartNanos >= kRateWindowNanos)
+        {
+            const float64_t rate = mWindowTicks * 1e9 / (float64_t)(now - mWindowStartNanos);
+            uint64_t bits;
+            memcpy(&bits, &rate, sizeof(bits));
+            mTicksPerSecond.store(bits, std::memory_order_relaxed);
+            mWindowStartNanos = now;
+            mWindowTicks = 0;
+        }
+
+        // the profiler and memory sections walk engine state, so they are
+        // rendered here on the main thread, and only now and then
+        if (now - mLastSlowRefreshNanos >= kSlowRefreshNanos)
+        {
+            mLastSlowRefreshNanos = now;
+            RefreshSlowSection(now);
+        }
+    }
+
+    void MetricsServer::RefreshSlowSection( uint64_t nowNanos )
+    {
+        std::ostringstream out;
+
+        if (Profiler::instance().IsEnabled())
+        {
+            const std::vector<Profiler::ScopeStats>& stats = Profiler::instance().GetFrameStats();
+            out << "# TYPE opennero_profile_milliseconds gauge\n";
+            for (size_t i = 0; i < stats.size(); ++i)
+            {
+                out << "opennero_profile_milliseconds{scope=\""
+                    << EscapeLabel(stats[i].path) << "\"} "
+                    << stats[i].milliseconds << "\n";
+            }
+
+            // per-call-site C++/Python boundary crossings of the last frame
+            const std::vector<Profiler::CrossingStats>& crossings =
+                Profiler::instance().GetCrossingStats();
+            if (!crossings.empty())
+            {
+                out << "# TYPE opennero_python_crossings gauge\n";
+                for (size_t i = 0; i < crossings.size(); ++i)
+                {
+                    out << "opennero_python_crossings{site=\""
+                        << EscapeLabel(crossings[i].site) << "\"} "
+                        << crossings[i].crossings << "\n";
+                }
+                out << "# TYPE opennero_python_crossing_milliseconds gauge\n";
+                for (size_t i = 0; i < crossings.size(); ++i)
+                {
+                    out << "opennero_python_crossing_milliseconds{site=\""
+                        << EscapeLabel(crossings[i].site) << "\"} "
+                        << crossings[i].milliseconds << "\n";
+                }
+            }
+        }
+
+        const std::vector<MemoryMonitor::Entry> entries = MemoryMonitor::instance().Poll();
+        out << "# TYPE opennero_memory_bytes gauge\n";
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            out << "opennero_memory_bytes{subsystem=\""
+                << EscapeLabel(entries[i].label) << "\"} "
+                << entries[i].bytes << "\n";
+        }
+        out << "# TYPE opennero_memory_objects gauge\n";
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (entries[i].count == 0)
+                continue;
+            out << "opennero_memory_objects{subsystem=\""
+                << EscapeLabel(entries[i].label) << "\"} "
+                << entries[i].count << "\n";
+        }
+
+        std::lock_guard<std::mutex> guard(mSlowMutex);
+        mSlowSection = out.str();
+    }
+
+    std::string MetricsServer::RenderSnapshot() const
+    {
+        uint64_t rate_bits = mTicksPerSecond.load(std::memory_order_relaxed);
+        float64_t rate;
+        memcpy(&rate, &rate_bits, sizeof(rate));
+
+        std::ostringstream out;
+        out << "# TYPE opennero_ticks_total counter\n"
+            << "opennero_ticks_total " << mTicksTotal.load(std::memory_order_relaxed) << "\n"
+            << "# TYPE opennero_ticks_per_second gauge\n"
+            << "opennero_ticks_per_second " << rate << "\n"
+            << "# TYPE opennero_tick_seconds gauge\n"
+            << "opennero_tick_seconds "
+            << mLastTickNanos.load(std::memory_order_relaxed) * 1e-9 << "\n"
+            << "# TYPE opennero_entities gauge\n"
+            << "opennero_entities " << mEntities.load(std::memory_order_relaxed) << "\n"
+            << "# TYPE opennero_sim_time_seconds_total counter\n"
+            << "opennero_sim_time_seconds_total "
+            << mSimTimeMicros.load(std::memory_order_relaxed) * 1e-6 << "\n";
+
+        {
+            std::lock_guard<std::mutex> guard(mSlowMutex);
+            out << mSlowSection;
+        }
+        return out.str();
+    }
+
+} //end OpenNero
@@ -0,0 +1,91 @@
+//--------------------------------------------------------
+// OpenNero : MetricsServer
+//  scrape-able live metrics endpoint
+//--------------------------------------------------------
+
+#ifndef _UTILS_METRICSSERVER_H_
+#define _UTILS_METRICSSERVER_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * Publishes live engine metrics on a local TCP socket in the
+     * Prometheus text format, so long unattended runs can be watched by
+     * a normal monitoring stack instead of by reading logs afterwards.
+     * Each connection receives one snapshot (wrapped in a minimal HTTP
+     * response for curl and scrapers) and is closed.
+     *
+     * The tick path only stores a few atomic counters; the expensive
+     * sections (profiler scope times, memory attribution) are re-rendered
+     * on the main thread at a throttled period, and the serving thread
+     * never touches engine state directly.
+     */
+    class MetricsServer
+    {
+    public:
+
+        /// the process-wide metrics endpoint
+        static MetricsServer& instance();
+
+        /// start serving on 127.0.0.1:port
+        /// @return true if the socket was bound and the thread started
+        bool Start( U16 port );
+
+        /// stop serving and close the socket
+        void Stop();
+
+        /// is the endpoint up?
+        bool IsRunning() const;
+
+        /// called once per tick by the simulation context
+        /// @param dt the simulated time of the tick in seconds
+        /// @param tickNanos how long the tick took on the monotonic clock
+        /// @param entities the number of entities in the simulation
+        void RecordTick( float32_t dt, uint64_t tickNanos, size_t entities );
+
+        /// render the current metrics snapshot in the exposition format
+        /// (public so the serving thread and tests of the format share it)
+        std::string RenderSnapshot() const;
+
+    private:
+
+        /// the listening socket and the serving thread (in the .cpp)
+        struct ServerState;
+
+        MetricsServer();
+        ~MetricsServer();
+        MetricsServer( const MetricsServer& );            // not copyable
+        MetricsServer& operator=( const MetricsServer& ); // not copyable
+
+        /// re-render the throttled profiler and memory sections
+        void RefreshSlowSection( uint64_t nowNanos );
+
+        /// the serving thread: answer each scrape with one snapshot
+        static void ServeLoop( ServerState* state, const MetricsServer* metrics );
+
+    private:
+
+        ServerState* mServer;                   ///< NULL unless running
+
+        std::atomic<uint64_t> mTicksTotal;      ///< ticks since startup
+        std::atomic<uint64_t> mLastTickNanos;   ///< duration of the last tick
+        std::atomic<uint64_t> mTicksPerSecond;  ///< rate over the last window, as float64_t bits
+        std::atomic<uint64_t> mEntities;        ///< entities in the simulation
+        std::atomic<uint64_t> mSimTimeMicros;   ///< simulated time since startup
+
+        uint64_t mWindowStartNanos;             ///< start of the current rate window
+        uint64_t mWindowTicks;                  ///< ticks seen in the current window
+        uint64_t mLastSlowRefreshNanos;         ///< when the slow section was last rebuilt
+
+        mutable std::mutex mSlowMutex;          ///< guards the rendered slow section
+        std::string mSlowSection;               ///< profiler + memory metrics text
+    };
+
+} //end OpenNero
+
+#endif // _UTILS_METRICSSERVER_H_
@@ -0,0 +1,255 @@
+//--------------------------------------------------------
+// OpenNero : Profiler
+//  hierarchical frame profiler with scoped timers
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/ONTime.h"
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// the cheapest timestamp available: the raw cycle counter on x86,
+        /// the steady clock elsewhere; only tick *ratios* within one frame
+        /// are used, so the unit does not matter
+        inline uint64_t ProfilerTicks()
+        {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            return __rdtsc();
+#else
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        /// monotonic nanoseconds, read once per frame to convert ticks
+        inline uint64_t ProfilerNanos()
+        {
+            return HighResClock::GetNanoseconds();
+        }
+
+        /// most expensive crossing site first
+        bool OrderCrossings(const Profiler::CrossingStats& x,
+                            const Profiler::CrossingStats& y)
+        {
+            return x.milliseconds > y.milliseconds;
+        }
+    }
+
+    Profiler& Profiler::instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    uint64_t Profiler::Ticks()
+    {
+        return ProfilerTicks();
+    }
+
+    Profiler::Profiler()
+        : mEnabled(false)
+        , mInFrame(false)
+        , mRoot(new Node("frame", NULL))
+        , mFrameStartTicks(0)
+        , mFrameStartNanos(0)
+        , mFrameIndex(0)
+    {
+    }
+
+    Profiler::~Profiler()
+    {
+        StopCsvDump();
+        // the node tree is intentionally leaked: the singleton lives until
+        // process exit and scopes may still close during static teardown
+    }
+
+    void Profiler::SetEnabled(bool enabled)
+    {
+        if (mEnabled == enabled)
+            return;
+        mEnabled = enabled;
+        if (!enabled)
+        {
+            mStack.clear();
+            mInFrame = false;
+        }
+        LOG_F_MSG("game", "frame profiler " << (enabled ? "enabled" : "disabled"));
+    }
+
+    void Profiler::BeginFrame()
+    {
+        if (!mEnabled)
+            return;
+        ResetTree(mRoot);
+        mStack.clear();
+        mCrossingTally.clear();
+        mInFrame = true;
+        mFrameStartTicks = ProfilerTicks();
+        mFrameStartNanos = ProfilerNanos();
+    }
+
+    void Profiler::EndFrame()
+    {
+        if (!mEnabled || !mInFrame)
+            return;
+        mInFrame = false;
+
+        const uint64_t frameTicks = ProfilerTicks() - mFrameStartTicks;
+        const uint64_t frameNanos = ProfilerNanos() - mFrameStartNanos;
+        if (frameTicks == 0)
+            return;
+
+        // one wall-clock measurement calibrates the whole tick tree, so the
+        // per-scope timestamps themselves stay rdtsc-cheap
+        const float64_t msPerTick = (frameNanos / 1.0e6) / (float64_t)frameTicks;
+        const float64_t frameMs = frameNanos / 1.0e6;
+
+        mLastFrame.clear();
+        for (size_t i = 0; i < mRoot->mChildren.size(); ++i)
+        {
+            PublishNode(mRoot->mChildren[i], std::string(), 0, msPerTick, frameMs);
+        }
+
+        // rank the language-boundary crossings of this frame by cost
+        mLastCrossings.clear();
+        for (CrossingMap::const_iterator it = mCrossingTally.begin();
+             it != mCrossingTally.end(); ++it)
+        {
+            CrossingStats stats;
+            stats.site = it->first;
+            stats.crossings = it->second.mCrossings;
+            stats.milliseconds = it->second.mTicks * msPerTick;
+            mLastCrossings.push_back(stats);
+        }
+        std::sort(mLastCrossings.begin(), mLastCrossings.end(), OrderCrossings);
+
+        if (mCsv.is_open())
+        {
+            for (size_t i = 0; i < mLastCrossings.size(); ++i)
+            {
+                const CrossingStats& stats = mLastCrossings[i];
+                mCsv << mFrameIndex << ",python/" << stats.site << ",0,"
+                     << stats.crossings << ',' << stats.milliseconds << ','
+                     << (frameMs > 0 ? 100.0 * stats.milliseconds / frameMs : 0)
+                     << '\n';
+            }
+        }
+
+        ++mFrameIndex;
+    }
+
+    void Profiler::RecordCrossing(const std::string& site, uint64_t ticks)
+    {
+        if (!mEnabled || !mInFrame)
+            return;
+        CrossingTally& tally = mCrossingTally[site];
+        ++tally.mCrossings;
+        tally.mTicks += ticks;
+    }
+
+    void Profiler::BeginScope(const char* name)
+    {
+        if (!mEnabled || !mInFrame)
+            return;
+
+        Node* parent = mStack.empty() ? mRoot : mStack.back().mNode;
+
+        // scopes are few and names are literals, so a pointer scan of the
+        // children beats any map here
+        Node* node = NULL;
+        for (size_t i = 0; i < parent->mChildren.size(); ++i)
+        {
+            if (parent->mChildren[i]->mName == name)
+            {
+                node = parent->mChildren[i];
+                break;
+            }
+        }
+        if (!node)
+        {
+            node = new Node(name, parent);
+            parent->mChildren.push_back(node);
+        }
+
+        ++node->mCalls;
+        OpenScope open;
+        open.mNode = node;
+        open.mStart = ProfilerTicks();
+        mStack.push_back(open);
+    }
+
+    void Profiler::EndScope()
+    {
+        if (!mEnabled || mStack.empty())
+            return;
+        OpenScope open = mStack.back();
+        mStack.pop_back();
+        open.mNode->mTicks += ProfilerTicks() - open.mStart;
+    }
+
+    bool Profiler::StartCsvDump(const std::string& fileName)
+    {
+        StopCsvDump();
+        mCsv.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+        if (!mCsv.is_open())
+        {
+            LOG_F_ERROR("game", "could not open profiler CSV file: " << fileName);
+            return false;
+        }
+        mCsv << "frame,path,depth,calls,ms,percent\n";
+        return true;
+    }
+
+    void Profiler::StopCsvDump()
+    {
+        if (mCsv.is_open())
+            mCsv.close();
+    }
+
+    void Profiler::ResetTree(Node* node)
+    {
+        node->mTicks = 0;
+        node->mCalls = 0;
+        for (size_t i = 0; i < node->mChildren.size(); ++i)
+        {
+            ResetTree(node->mChildren[i]);
+        }
+    }
+
+    void Profiler::PublishNode(Node* node, const std::string& parentPath,
+                               uint32_t depth, float64_t msPerTick, float64_t frameMs)
+    {
+        if (node->mCalls == 0)
+            return;
+
+        ScopeStats stats;
+        stats.path = parentPath.empty() ? node->mName : parentPath + "/" + node->mName;
+        stats.depth = depth;
+        stats.calls = node->mCalls;
+        stats.milliseconds = node->mTicks * msPerTick;
+        stats.percent = frameMs > 0 ? 100.0 * stats.milliseconds / frameMs : 0;
+        mLastFrame.push_back(stats);
+
+        if (mCsv.is_open())
+        {
+            mCsv << mFrameIndex << ',' << stats.path << ',' << stats.depth << ','
+                 << stats.calls << ',' << stats.milliseconds << ','
+                 << stats.percent << '\n';
+        }
+
+        for (size_t i = 0; i < node->mChildren.size(); ++i)
+        {
+            PublishNode(node->mChildren[i], stats.path, depth + 1, msPerTick, frameMs);
+        }
+    }
+}
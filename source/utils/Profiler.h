@@ -0,0 +1,220 @@
+//--------------------------------------------------------
+// OpenNero : Profiler
+//  hierarchical frame profiler with scoped timers
+//--------------------------------------------------------
+
+#ifndef _UTILS_PROFILER_H_
+#define _UTILS_PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include "core/ONTypes.h"
+
+namespace OpenNero
+{
+    /**
+     * A lightweight hierarchical frame profiler. Subsystem calls are
+     * bracketed with PROFILE_SCOPE(name) markers; while the profiler is
+     * enabled each marker charges raw timestamp-counter ticks to a node in
+     * a call tree, and at the end of every frame the tree is converted to
+     * milliseconds and percentages using a single wall-clock measurement of
+     * the whole frame. A disabled profiler costs one boolean test per
+     * scope. The per-frame results can be drawn as a HUD overlay and/or
+     * appended to a CSV file for offline triage.
+     *
+     * The profiler is main-thread only: scopes opened on worker threads are
+     * not supported. Note that it is a singleton.
+     */
+    class Profiler
+    {
+    public:
+
+        /// timing results for one scope in the last completed frame
+        struct ScopeStats
+        {
+            std::string path;       ///< slash-separated path from the frame root
+            uint32_t depth;         ///< nesting depth (0 for top-level scopes)
+            uint32_t calls;         ///< number of times the scope ran this frame
+            float64_t milliseconds; ///< inclusive time spent in the scope
+            float64_t percent;      ///< inclusive share of the whole frame
+        };
+
+        /// language-boundary crossings charged to one call site in the
+        /// last completed frame
+        struct CrossingStats
+        {
+            std::string site;       ///< bridge entry point and target, e.g. "ScriptingEngine::Call/ModTick"
+            uint32_t crossings;     ///< number of crossings this frame
+            float64_t milliseconds; ///< time spent on the Python side
+        };
+
+        /// singleton accessor
+        static Profiler& instance();
+
+        /// the timestamp source the profiler charges scopes with; exposed
+        /// so the crossing instrumentation can use the same cheap counter
+        static uint64_t Ticks();
+
+        /// is scope collection currently on?
+        bool IsEnabled() const { return mEnabled; }
+
+        /// turn scope collection on or off
+        void SetEnabled(bool enabled);
+
+        /// mark the start of a frame
+        void BeginFrame();
+
+        /// close the frame: convert the tick tree to milliseconds, publish
+        /// the per-scope stats, and append a CSV row per scope if dumping
+        void EndFrame();
+
+        /// open a scope; name must be a string literal (the pointer is the key)
+        void BeginScope(const char* name);
+
+        /// close the innermost open scope
+        void EndScope();
+
+        /// results of the last completed frame, in call-tree order
+        const std::vector<ScopeStats>& GetFrameStats() const { return mLastFrame; }
+
+        /// charge one C++-to-Python crossing to a call site; ticks is the
+        /// time spent across the boundary (use through ScopedCrossing)
+        void RecordCrossing(const std::string& site, uint64_t ticks);
+
+        /// per-site crossing counts of the last completed frame, most
+        /// expensive site first - the batching worklist
+        const std::vector<CrossingStats>& GetCrossingStats() const { return mLastCrossings; }
+
+        /// start appending one row per scope per frame to a CSV file
+        /// @return false if the file could not be opened
+        bool StartCsvDump(const std::string& fileName);
+
+        /// stop the CSV dump and close the file
+        void StopCsvDump();
+
+    private:
+
+        /// a node in the frame call tree
+        struct Node
+        {
+            const char* mName;            ///< scope name (string literal)
+            Node* mParent;                ///< enclosing scope (NULL for the root)
+            std::vector<Node*> mChildren; ///< scopes opened inside this one
+            uint64_t mTicks;              ///< ticks charged this frame
+            uint32_t mCalls;              ///< times entered this frame
+
+            Node(const char* name, Node* parent)
+                : mName(name), mParent(parent), mTicks(0), mCalls(0) {}
+        };
+
+        /// an open scope on the stack and the tick count when it was entered
+        struct OpenScope
+        {
+            Node* mNode;       ///< node being charged
+            uint64_t mStart;   ///< timestamp ticks on entry
+        };
+
+        /// running crossing totals for one call site within a frame
+        struct CrossingTally
+        {
+            uint32_t mCrossings; ///< crossings so far this frame
+            uint64_t mTicks;     ///< ticks charged so far this frame
+
+            CrossingTally() : mCrossings(0), mTicks(0) {}
+        };
+
+        /// per-site crossing totals, keyed by site
+        typedef std::map<std::string, CrossingTally> CrossingMap;
+
+        Profiler();
+        ~Profiler();
+
+        /// zero the tick and call counters of the whole tree
+        void ResetTree(Node* node);
+
+        /// flatten one node into mLastFrame (and the CSV) and recurse
+        void PublishNode(Node* node, const std::string& parentPath,
+                         uint32_t depth, float64_t msPerTick, float64_t frameMs);
+
+        bool mEnabled;                  ///< collection on/off switch
+        bool mInFrame;                  ///< BeginFrame seen without EndFrame yet
+        Node* mRoot;                    ///< root of the call tree (the frame)
+        std::vector<OpenScope> mStack;  ///< currently open scopes
+        uint64_t mFrameStartTicks;      ///< timestamp ticks at BeginFrame
+        uint64_t mFrameStartNanos;      ///< wall clock at BeginFrame
+        uint32_t mFrameIndex;           ///< completed frame counter
+        std::vector<ScopeStats> mLastFrame; ///< published stats
+        CrossingMap mCrossingTally;     ///< crossing totals of the frame in progress
+        std::vector<CrossingStats> mLastCrossings; ///< published crossing stats
+        std::ofstream mCsv;             ///< CSV sink (closed when not dumping)
+    };
+
+    /// charges the time between construction and destruction to the named
+    /// profiler scope; use through PROFILE_SCOPE
+    class ScopedProfile
+    {
+    public:
+        /// open the scope if the profiler is collecting
+        ScopedProfile(const char* name)
+            : mOpen(Profiler::instance().IsEnabled())
+        {
+            if (mOpen)
+                Profiler::instance().BeginScope(name);
+        }
+
+        ~ScopedProfile()
+        {
+            if (mOpen)
+                Profiler::instance().EndScope();
+        }
+
+    private:
+        bool mOpen; ///< whether the scope was actually opened
+    };
+
+    /// counts one C++-to-Python boundary crossing and charges the time
+    /// between construction and destruction to the named call site; placed
+    /// where the scripting bridge enters Python. A disabled profiler costs
+    /// one boolean test per crossing.
+    class ScopedCrossing
+    {
+    public:
+        /// open a crossing charged to site/name (e.g. the bridge method
+        /// and the Python callable it dispatches to)
+        ScopedCrossing(const char* site, const std::string& name)
+            : mOpen(Profiler::instance().IsEnabled())
+            , mStart(0)
+        {
+            if (mOpen)
+            {
+                mSite = site;
+                mSite += '/';
+                mSite += name;
+                mStart = Profiler::Ticks();
+            }
+        }
+
+        ~ScopedCrossing()
+        {
+            if (mOpen)
+                Profiler::instance().RecordCrossing(mSite, Profiler::Ticks() - mStart);
+        }
+
+    private:
+        bool mOpen;        ///< whether the crossing is being counted
+        std::string mSite; ///< call site the crossing is charged to
+        uint64_t mStart;   ///< timestamp ticks on entry
+    };
+}
+
+/// bracket the rest of the enclosing block as a named profiler scope;
+/// name must be a string literal
+#define PROFILE_SCOPE( name ) OpenNero::ScopedProfile PROFILE_SCOPE_VAR(__LINE__)( name )
+/// @cond
+#define PROFILE_SCOPE_VAR( line ) PROFILE_SCOPE_VAR2( line )
+#define PROFILE_SCOPE_VAR2( line ) _profile_scope_##line
+/// @endcond
+
+#endif // _UTILS_PROFILER_H_
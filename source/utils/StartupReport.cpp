@@ -0,0 +1,65 @@
+//--------------------------------------------------------
+// OpenNero : StartupReport
+//  staged startup timing from process start to first tick
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "utils/StartupReport.h"
+#include "core/ONTime.h"
+
+#include <vector>
+#include <utility>
+
+namespace OpenNero
+{
+    namespace StartupReport
+    {
+        namespace
+        {
+            /// a completed stage and the wall-clock time it finished at
+            typedef std::pair< std::string, uint64_t > StageMark;
+
+            /// stages marked so far, in completion order (main thread only)
+            std::vector<StageMark> stage_marks;
+
+            /// set once the first tick closed the window; later marks are ignored
+            bool report_done = false;
+        }
+
+        void MarkStage( const std::string& stage )
+        {
+            if( report_done )
+                return;
+
+            stage_marks.push_back( StageMark( stage, GetStaticTimer().getMilliseconds() ) );
+        }
+
+        void MarkFirstTick()
+        {
+            if( report_done )
+                return;
+
+            report_done = true;
+
+            const uint64_t first_tick_ms = GetStaticTimer().getMilliseconds();
+
+            LOG_F_MSG( "startup", "startup timing report:" );
+
+            uint64_t prev_ms = 0;
+            std::vector<StageMark>::const_iterator itr = stage_marks.begin();
+            std::vector<StageMark>::const_iterator end = stage_marks.end();
+
+            for( ; itr != end; ++itr )
+            {
+                LOG_F_MSG( "startup", "  " << itr->first << ": +" << (itr->second - prev_ms)
+                           << " ms (at " << itr->second << " ms)" );
+                prev_ms = itr->second;
+            }
+
+            LOG_F_MSG( "startup", "  time to first tick: " << first_tick_ms << " ms" );
+
+            stage_marks.clear();
+        }
+    }
+
+} // end OpenNero
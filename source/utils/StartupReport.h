@@ -0,0 +1,34 @@
+//--------------------------------------------------------
+// OpenNero : StartupReport
+//  staged startup timing from process start to first tick
+//--------------------------------------------------------
+
+#ifndef _UTILS_STARTUPREPORT_H_
+#define _UTILS_STARTUPREPORT_H_
+
+#include <string>
+
+namespace OpenNero
+{
+    /**
+     * Measures where the time between process start and the first simulated
+     * tick goes. Startup code brackets its stages with MarkStage calls
+     * (interpreter init, module export, mod scripts, preimports, ...) and
+     * the kernel calls MarkFirstTick when the first tick of the first mod
+     * runs, which logs one report with the per-stage and total times. Short
+     * condor jobs live or die by this window, so the report makes every
+     * regression in it visible in the log. Marks recorded after the first
+     * tick are ignored.
+     */
+    namespace StartupReport
+    {
+        /// record the completion of a named startup stage
+        void MarkStage( const std::string& stage );
+
+        /// close the startup window and log the timing report (first call only)
+        void MarkFirstTick();
+    }
+
+} // end OpenNero
+
+#endif // _UTILS_STARTUPREPORT_H_